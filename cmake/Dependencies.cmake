@@ -82,7 +82,8 @@ message(STATUS "Found LLVM ${LLVM_PACKAGE_VERSION}")
 if (${LLVM_PACKAGE_VERSION} VERSION_LESS "3.7")
     message( FATAL_ERROR "LLVM 3.7 or newer is required." )
 endif()
-llvm_map_components_to_libnames(LLVM_LIBRARIES core mcjit nativecodegen native)
+llvm_map_components_to_libnames(LLVM_LIBRARIES core mcjit nativecodegen native
+    bitreader bitwriter linker transformutils)
 include_directories(SYSTEM ${LLVM_INCLUDE_DIRS})
 list(APPEND Peloton_LINKER_LIBS ${LLVM_LIBRARIES})
 
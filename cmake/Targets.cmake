@@ -108,6 +108,91 @@ function(peloton_pickup_peloton_sources root)
   set(srcs ${srcs} PARENT_SCOPE)
 endfunction()
 
+################################################################################################
+# Compiles the given runtime sources to LLVM bitcode, links them into a single module and
+# embeds it into the library, so that the codegen can inline runtime functions into queries.
+# If there is no clang++ and llvm-link of the LLVM version we link against, the embedded
+# bitcode is empty and generated code calls the runtime functions instead.
+# Usage:
+#   peloton_embed_runtime_bitcode(<srcs_variable> <source> [<source> ...])
+function(peloton_embed_runtime_bitcode variable)
+  set(bitcode_dir ${PROJECT_BINARY_DIR}/runtime_bitcode)
+  set(RUNTIME_BITCODE_FILE ${bitcode_dir}/runtime.bc)
+  set(embed_src ${bitcode_dir}/runtime_bitcode.cpp)
+  file(MAKE_DIRECTORY ${bitcode_dir})
+
+  set(llvm_version ${LLVM_VERSION_MAJOR}.${LLVM_VERSION_MINOR})
+  find_program(PELOTON_BITCODE_CXX
+    NAMES clang++-${llvm_version} clang++-${LLVM_VERSION_MAJOR} clang++
+    HINTS ${LLVM_TOOLS_BINARY_DIR})
+  find_program(PELOTON_LLVM_LINK
+    NAMES llvm-link-${llvm_version} llvm-link-${LLVM_VERSION_MAJOR} llvm-link
+    HINTS ${LLVM_TOOLS_BINARY_DIR})
+
+  # The bitcode must be readable by the LLVM we link against, and sanitized
+  # code must not be mixed with uninstrumented copies of itself
+  set(bitcode_available FALSE)
+  if (PELOTON_BITCODE_CXX AND PELOTON_LLVM_LINK AND NOT USE_SANITIZER)
+    execute_process(COMMAND ${PELOTON_BITCODE_CXX} --version
+      OUTPUT_VARIABLE bitcode_cxx_version ERROR_QUIET)
+    if ("${bitcode_cxx_version}" MATCHES "version ${LLVM_VERSION_MAJOR}\\.${LLVM_VERSION_MINOR}")
+      set(bitcode_available TRUE)
+    endif()
+  endif()
+
+  if (NOT bitcode_available)
+    message(STATUS "No clang++ ${llvm_version} found, runtime functions will not be inlined into generated code")
+    file(WRITE ${RUNTIME_BITCODE_FILE} "")
+  else()
+    message(STATUS "Compiling runtime bitcode with ${PELOTON_BITCODE_CXX}")
+
+    # Mirror the flags of the library, minus the warnings
+    set(flags -std=c++11 -O2 -march=native -mcx16 -fPIC -w -emit-llvm
+        -D_GLIBCXX_USE_C99=1 -D_GLIBCXX_USE_C99_MATH=1)
+    string(TOUPPER "${CMAKE_BUILD_TYPE}" build_type)
+    if ("${CMAKE_CXX_FLAGS_${build_type}}" MATCHES "-DNDEBUG")
+      list(APPEND flags -DNDEBUG)
+    endif()
+    get_property(include_dirs DIRECTORY PROPERTY INCLUDE_DIRECTORIES)
+    foreach(dir ${include_dirs})
+      list(APPEND flags -I${dir})
+    endforeach()
+    get_property(definitions DIRECTORY PROPERTY COMPILE_DEFINITIONS)
+    foreach(definition ${definitions})
+      list(APPEND flags -D${definition})
+    endforeach()
+
+    set(bitcode_files)
+    foreach(src ${ARGN})
+      get_filename_component(name ${src} NAME_WE)
+      file(RELATIVE_PATH rel_src ${PROJECT_SOURCE_DIR} ${src})
+      set(bitcode_file ${bitcode_dir}/${name}.bc)
+      add_custom_command(
+        OUTPUT ${bitcode_file}
+        COMMAND ${PELOTON_BITCODE_CXX} ${flags} "-D__PELOTONFILE__=\"${rel_src}\""
+                -c ${src} -o ${bitcode_file}
+        DEPENDS ${src} peloton-proto
+        IMPLICIT_DEPENDS CXX ${src}
+        COMMENT "Compiling ${rel_src} to LLVM bitcode"
+        VERBATIM)
+      list(APPEND bitcode_files ${bitcode_file})
+    endforeach()
+
+    add_custom_command(
+      OUTPUT ${RUNTIME_BITCODE_FILE}
+      COMMAND ${PELOTON_LLVM_LINK} ${bitcode_files} -o ${RUNTIME_BITCODE_FILE}
+      DEPENDS ${bitcode_files}
+      COMMENT "Linking runtime bitcode"
+      VERBATIM)
+    set_source_files_properties(${embed_src} PROPERTIES
+      OBJECT_DEPENDS ${RUNTIME_BITCODE_FILE})
+  endif()
+
+  configure_file(${PROJECT_SOURCE_DIR}/cmake/Templates/runtime_bitcode.cpp.in
+                 ${embed_src} @ONLY)
+  set(${variable} ${${variable}} ${embed_src} PARENT_SCOPE)
+endfunction()
+
 ################################################################################################
 # Short command for setting defeault target properties
 # Usage:
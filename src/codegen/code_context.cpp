@@ -12,17 +12,29 @@
 
 #include "codegen/code_context.h"
 
+#include <unordered_set>
+
+#include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/CallSite.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_os_ostream.h"
+#include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Vectorize.h"
 #if LLVM_VERSION_GE(3, 9)
 #include "llvm/Transforms/Scalar/GVN.h"
 #endif
 
+#include "codegen/compiled_code_cache.h"
+#include "codegen/runtime_library.h"
 #include "common/exception.h"
 #include "common/logger.h"
 #include "settings/settings_manager.h"
@@ -35,6 +47,49 @@ static std::atomic<uint64_t> kIdCounter{0};
 
 namespace {
 
+// The maximum number of runtime function calls inlined into a module
+constexpr uint32_t kMaxInlinedCalls = 1024;
+
+// Turn a call through a cast of the given function into a direct call. The
+// linker casts runtime functions whose type differs from the declaration of
+// the builtin, e.g., because the proxy's struct types have other names.
+// Returns NULL if the types differ in more than the pointer types.
+llvm::CallInst *CallDirectly(llvm::CallInst *call, llvm::Function *func) {
+  llvm::FunctionType *func_type = func->getFunctionType();
+  if (func_type->isVarArg() ||
+      func_type->getNumParams() != call->getNumArgOperands()) {
+    return nullptr;
+  }
+  auto compatible = [](llvm::Type *a, llvm::Type *b) {
+    return a == b || (a->isPointerTy() && b->isPointerTy());
+  };
+  if (!compatible(call->getType(), func_type->getReturnType())) {
+    return nullptr;
+  }
+  for (uint32_t i = 0; i < func_type->getNumParams(); i++) {
+    if (!compatible(call->getArgOperand(i)->getType(),
+                    func_type->getParamType(i))) {
+      return nullptr;
+    }
+  }
+
+  llvm::IRBuilder<> builder{call};
+  std::vector<llvm::Value *> args;
+  for (uint32_t i = 0; i < func_type->getNumParams(); i++) {
+    args.push_back(builder.CreateBitCast(call->getArgOperand(i),
+                                         func_type->getParamType(i)));
+  }
+  llvm::CallInst *direct_call = builder.CreateCall(func, args);
+  direct_call->setCallingConv(func->getCallingConv());
+  direct_call->setAttributes(func->getAttributes());
+  if (!call->getType()->isVoidTy()) {
+    call->replaceAllUsesWith(
+        builder.CreateBitCast(direct_call, call->getType()));
+  }
+  call->eraseFromParent();
+  return direct_call;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 /// Peloton Memory Manager
@@ -43,10 +98,11 @@ namespace {
 
 class PelotonMemoryManager : public llvm::SectionMemoryManager {
  public:
-  explicit PelotonMemoryManager(
+  PelotonMemoryManager(
       const std::unordered_map<std::string,
-                               std::pair<llvm::Function *, CodeContext::FuncPtr>> &builtins)
-      : builtins_(builtins) {}
+                               std::pair<llvm::Function *, CodeContext::FuncPtr>> &builtins,
+      const std::unordered_map<std::string, const void *> &external_ptrs)
+      : builtins_(builtins), external_ptrs_(external_ptrs) {}
 
 #if LLVM_VERSION_GE(4, 0)
 #define RET_TYPE llvm::JITSymbol
@@ -86,6 +142,12 @@ class PelotonMemoryManager : public llvm::SectionMemoryManager {
       }
     }
 
+    // Check for the storage of an external pointer
+    auto ptr_iter = external_ptrs_.find(name);
+    if (ptr_iter != external_ptrs_.end()) {
+      return const_cast<void *>(ptr_iter->second);
+    }
+
     // Nothing
     return nullptr;
   }
@@ -95,6 +157,8 @@ class PelotonMemoryManager : public llvm::SectionMemoryManager {
   const std::unordered_map<std::string,
                            std::pair<llvm::Function *, CodeContext::FuncPtr>>
       &builtins_;
+  // The storage of the external pointers of the code context
+  const std::unordered_map<std::string, const void *> &external_ptrs_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -178,6 +242,7 @@ CodeContext::CodeContext()
       udf_func_ptr_(nullptr),
       pass_manager_(nullptr),
       engine_(nullptr),
+      opt_level_(OptimizationLevel::None),
       is_verified_(false) {
   // Initialize JIT stuff
   llvm::InitializeNativeTarget();
@@ -201,21 +266,13 @@ CodeContext::CodeContext()
   engine_.reset(
       llvm::EngineBuilder(std::move(m))
           .setEngineKind(llvm::EngineKind::JIT)
-          .setMCJITMemoryManager(llvm::make_unique<PelotonMemoryManager>(builtins_))
+          .setMCJITMemoryManager(llvm::make_unique<PelotonMemoryManager>(
+              builtins_, external_ptr_slots_))
           .setMCPU(llvm::sys::getHostCPUName())
           .setErrorStr(&err_str_)
           .create());
   PELOTON_ASSERT(engine_ != nullptr);
 
-  // The set of optimization passes we include
-  pass_manager_.reset(new llvm::legacy::FunctionPassManager(module_));
-  pass_manager_->add(llvm::createInstructionCombiningPass());
-  pass_manager_->add(llvm::createReassociatePass());
-  pass_manager_->add(llvm::createGVNPass());
-  pass_manager_->add(llvm::createCFGSimplificationPass());
-  pass_manager_->add(llvm::createAggressiveDCEPass());
-  pass_manager_->add(llvm::createCFGSimplificationPass());
-
   // Setup the common types we need once
   bool_type_ = llvm::Type::getInt1Ty(*context_);
   int8_type_ = llvm::Type::getInt8Ty(*context_);
@@ -277,6 +334,23 @@ std::pair<llvm::Function *, CodeContext::FuncPtr> CodeContext::LookupBuiltin(con
   return (iter == builtins_.end() ? std::make_pair<llvm::Function *, CodeContext::FuncPtr>(nullptr, nullptr) : iter->second);
 }
 
+llvm::GlobalVariable *CodeContext::RegisterExternalPointer(const void *ptr) {
+  std::string name = "_peloton_ptr_" + std::to_string(external_ptrs_.size());
+  external_ptrs_.push_back(ptr);
+  external_ptr_slots_[name] = &external_ptrs_.back();
+
+  // The global is only declared here. Its address, i.e., where the pointer is
+  // stored, is resolved by the memory manager when the code is loaded.
+  return new llvm::GlobalVariable(*module_, void_ptr_type_, true,
+                                  llvm::GlobalValue::ExternalLinkage, nullptr,
+                                  name);
+}
+
+const void *CodeContext::LookupExternalPointer(const std::string &name) const {
+  auto iter = external_ptr_slots_.find(name);
+  return iter == external_ptr_slots_.end() ? nullptr : iter->second;
+}
+
 /// Verify all the functions that were created in this context
 void CodeContext::Verify() {
   // Verify the module is okay
@@ -294,11 +368,36 @@ void CodeContext::Verify() {
 }
 
 /// Optimize all the functions that were created in this context
-void CodeContext::Optimize() {
+void CodeContext::Optimize(OptimizationLevel level) {
   // make sure the code is verified
   if (!is_verified_) Verify();
 
+  // The level is part of the key in the cache of compiled code
+  opt_level_ = level;
+
+  // Code in the cache of compiled code has been optimized before
+  auto &code_cache = CompiledCodeCache::Instance();
+  if (code_cache.IsEnabled() && code_cache.Contains(GetCacheKey())) {
+    LOG_DEBUG("Skipping optimization of cached module %s",
+              GetCacheKey().c_str());
+    return;
+  }
+
+  if (level == OptimizationLevel::None) {
+    return;
+  }
+
+  // Bring in the code of the runtime functions we call. The interpreter calls
+  // the compiled runtime functions instead.
+  if (settings::SettingsManager::GetBool(
+          settings::SettingId::codegen_inline_runtime) &&
+      !settings::SettingsManager::GetBool(
+          settings::SettingId::codegen_interpreter)) {
+    LinkRuntimeLibrary();
+  }
+
   // Run the optimization passes over each function in this module
+  AddOptimizationPasses(level);
   pass_manager_->doInitialization();
   for (auto &func_iter : functions_) {
     pass_manager_->run(*func_iter.first);
@@ -306,6 +405,41 @@ void CodeContext::Optimize() {
   pass_manager_->doFinalization();
 }
 
+void CodeContext::AddOptimizationPasses(OptimizationLevel level) {
+  bool aggressive = level == OptimizationLevel::Aggressive;
+  pass_manager_.reset(new llvm::legacy::FunctionPassManager(module_));
+
+  if (aggressive) {
+    // The loop passes and the vectorizers need to know the target's costs and
+    // vector width
+    pass_manager_->add(llvm::createTargetTransformInfoWrapperPass(
+        engine_->getTargetMachine()->getTargetIRAnalysis()));
+    pass_manager_->add(llvm::createSROAPass());
+    pass_manager_->add(llvm::createEarlyCSEPass());
+  }
+
+  pass_manager_->add(llvm::createInstructionCombiningPass());
+  pass_manager_->add(llvm::createReassociatePass());
+  pass_manager_->add(llvm::createGVNPass());
+  pass_manager_->add(llvm::createCFGSimplificationPass());
+
+  if (aggressive) {
+    pass_manager_->add(llvm::createLoopRotatePass());
+    pass_manager_->add(llvm::createLICMPass());
+    pass_manager_->add(llvm::createIndVarSimplifyPass());
+    pass_manager_->add(llvm::createLoopDeletionPass());
+    pass_manager_->add(llvm::createLoopVectorizePass());
+    pass_manager_->add(llvm::createInstructionCombiningPass());
+    pass_manager_->add(llvm::createLoopUnrollPass());
+    pass_manager_->add(llvm::createSLPVectorizerPass());
+    pass_manager_->add(llvm::createInstructionCombiningPass());
+    pass_manager_->add(llvm::createGVNPass());
+  }
+
+  pass_manager_->add(llvm::createAggressiveDCEPass());
+  pass_manager_->add(llvm::createCFGSimplificationPass());
+}
+
 /// JIT compile all the functions that were created in this context
 void CodeContext::Compile() {
   // make sure the code is verified
@@ -319,6 +453,14 @@ void CodeContext::Compile() {
     inst_count.DumpStats();
   }
 
+  // Let the JIT use the object code from the cache of compiled code, if it
+  // has any for the module, and add the code it generates otherwise
+  auto &code_cache = CompiledCodeCache::Instance();
+  if (code_cache.IsEnabled()) {
+    module_->setModuleIdentifier(GetCacheKey());
+    engine_->setObjectCache(&code_cache);
+  }
+
   // JIT compile the module
   engine_->finalizeObject();
 
@@ -373,6 +515,196 @@ const llvm::DataLayout &CodeContext::GetDataLayout() const {
   return module_->getDataLayout();
 }
 
+const std::string &CodeContext::GetCacheKey() {
+  if (!cache_key_.empty()) {
+    return cache_key_;
+  }
+
+  // The names of the functions we generate start with the ID of this context,
+  // which differs between processes. Strip it, so the same plan always results
+  // in the same code. There is one module per context, so names stay unique.
+  const std::string id_prefix = "_" + std::to_string(id_) + "_";
+  for (auto &func : GetModule()) {
+    std::string name = func.getName().str();
+    if (!func.isDeclaration() &&
+        name.compare(0, id_prefix.size(), id_prefix) == 0) {
+      func.setName("_query_" + name.substr(id_prefix.size()));
+    }
+  }
+  module_->setModuleIdentifier("query");
+
+  // The machine code depends on the IR, the optimization level, the target
+  // CPU and, through the layout of the runtime's data structures, on the build
+  llvm::MD5 hash;
+  hash.update(CompiledCodeCache::GetBuildId());
+  hash.update(llvm::sys::getHostCPUName());
+  hash.update(std::to_string(static_cast<uint32_t>(opt_level_)));
+  hash.update(GetIR());
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+
+  llvm::SmallString<32> key;
+  llvm::MD5::stringifyResult(result, key);
+  cache_key_ = std::string{key.begin(), key.end()};
+  return cache_key_;
+}
+
+void CodeContext::LinkRuntimeLibrary() {
+#if LLVM_VERSION_GE(3, 9)
+  auto &runtime = RuntimeLibrary::Instance();
+  if (!runtime.IsAvailable()) {
+    return;
+  }
+
+  // Give the declarations of the builtins that have bitcode the name of the
+  // symbol it defines, so the linker replaces them with its definitions
+  std::vector<std::pair<std::string, std::string>> linked_builtins;
+  for (auto &iter : builtins_) {
+    llvm::Function *func_decl = iter.second.first;
+    const std::string *symbol = runtime.LookupFunction(iter.second.second);
+    if (symbol == nullptr || func_decl == nullptr || func_decl->use_empty() ||
+        !func_decl->isDeclaration()) {
+      continue;
+    }
+    func_decl->setName(*symbol);
+    if (func_decl->getName() != *symbol) {
+      // Some other declaration has the symbol's name already
+      func_decl->setName(iter.first);
+      continue;
+    }
+    linked_builtins.emplace_back(iter.first, *symbol);
+  }
+  if (linked_builtins.empty()) {
+    return;
+  }
+
+  std::unique_ptr<llvm::Module> runtime_module = runtime.LoadModule(*context_);
+  if (runtime_module == nullptr) {
+    // The renamed declarations resolve to the runtime's symbols
+    return;
+  }
+  runtime_module->setDataLayout(module_->getDataLayout());
+  runtime_module->setTargetTriple(module_->getTargetTriple());
+
+  // Everything that is defined after linking, but not before, is runtime code
+  std::unordered_set<std::string> query_symbols;
+  for (const auto &func : *module_) {
+    if (!func.isDeclaration()) {
+      query_symbols.insert(func.getName().str());
+    }
+  }
+  for (const auto &global : module_->globals()) {
+    if (!global.isDeclaration()) {
+      query_symbols.insert(global.getName().str());
+    }
+  }
+
+  if (llvm::Linker::linkModules(*module_, std::move(runtime_module),
+                                llvm::Linker::Flags::LinkOnlyNeeded)) {
+    throw Exception("Cannot link the runtime bitcode into the query module");
+  }
+
+  // The runtime code is private to this module
+  std::unordered_set<llvm::Function *> runtime_funcs;
+  for (auto &func : *module_) {
+    if (!func.isDeclaration() &&
+        query_symbols.count(func.getName().str()) == 0) {
+      func.setLinkage(llvm::GlobalValue::InternalLinkage);
+      func.setComdat(nullptr);
+      runtime_funcs.insert(&func);
+    }
+  }
+  for (auto &global : module_->globals()) {
+    if (!global.isDeclaration() &&
+        query_symbols.count(global.getName().str()) == 0) {
+      global.setLinkage(llvm::GlobalValue::InternalLinkage);
+      global.setComdat(nullptr);
+    }
+  }
+  for (auto &alias : module_->aliases()) {
+    alias.setLinkage(llvm::GlobalValue::InternalLinkage);
+  }
+
+  // Recursive functions are not inlined
+  std::unordered_set<llvm::Function *> recursive_funcs;
+  for (auto *func : runtime_funcs) {
+    for (auto *user : func->users()) {
+      auto *inst = llvm::dyn_cast<llvm::Instruction>(user);
+      if (inst != nullptr && inst->getParent()->getParent() == func) {
+        recursive_funcs.insert(func);
+      }
+    }
+  }
+
+  // Inline the calls of our functions to the runtime, including the calls the
+  // inlined code makes
+  uint32_t num_inlined = 0;
+  for (auto &func_iter : functions_) {
+    llvm::Function *func = func_iter.first;
+    if (func->isDeclaration()) {
+      continue;
+    }
+    bool inlined = true;
+    while (inlined && num_inlined < kMaxInlinedCalls) {
+      inlined = false;
+      std::vector<llvm::CallInst *> calls;
+      for (auto &block : *func) {
+        for (auto &inst : block) {
+          auto *call = llvm::dyn_cast<llvm::CallInst>(&inst);
+          if (call == nullptr) {
+            continue;
+          }
+          auto *callee = llvm::dyn_cast<llvm::Function>(
+              call->getCalledValue()->stripPointerCasts());
+          if (callee != nullptr && runtime_funcs.count(callee) != 0 &&
+              recursive_funcs.count(callee) == 0) {
+            calls.push_back(call);
+          }
+        }
+      }
+      for (auto *call : calls) {
+        auto *callee = llvm::cast<llvm::Function>(
+            call->getCalledValue()->stripPointerCasts());
+        if (call->getCalledFunction() != callee) {
+          call = CallDirectly(call, callee);
+        }
+        llvm::InlineFunctionInfo inline_info;
+        if (call != nullptr && num_inlined < kMaxInlinedCalls &&
+            llvm::InlineFunction(llvm::CallSite{call}, inline_info)) {
+          num_inlined++;
+          inlined = true;
+        }
+      }
+    }
+  }
+
+  // Drop the runtime functions that are no longer called
+  bool erased = true;
+  while (erased) {
+    erased = false;
+    for (auto iter = runtime_funcs.begin(); iter != runtime_funcs.end();) {
+      llvm::Function *func = *iter;
+      func->removeDeadConstantUsers();
+      if (func->use_empty()) {
+        func->eraseFromParent();
+        iter = runtime_funcs.erase(iter);
+        erased = true;
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+  // The declarations of the linked builtins are gone
+  for (const auto &iter : linked_builtins) {
+    builtins_[iter.first].first = module_->getFunction(iter.second);
+  }
+
+  LOG_DEBUG("Inlined %u calls to the runtime, %zu runtime functions remain",
+            num_inlined, runtime_funcs.size());
+#endif
+}
+
 void CodeContext::DumpContents() const {
   std::error_code error_code;
 
@@ -93,6 +93,15 @@ llvm::Constant *CodeGen::NullPtr(llvm::PointerType *type) const {
   return llvm::ConstantPointerNull::get(type);
 }
 
+llvm::Value *CodeGen::RelocatablePtr(const void *ptr,
+                                     llvm::PointerType *type) const {
+  if (ptr == nullptr) {
+    return NullPtr(type);
+  }
+  llvm::Value *slot = code_context_.RegisterExternalPointer(ptr);
+  return GetBuilder().CreateBitCast(GetBuilder().CreateLoad(slot), type);
+}
+
 llvm::Value *CodeGen::AllocateVariable(llvm::Type *type,
                                        const std::string &name) {
   // To allocate a variable, a function must be under construction
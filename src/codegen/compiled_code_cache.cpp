@@ -0,0 +1,472 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// compiled_code_cache.cpp
+//
+// Identification: src/codegen/compiled_code_cache.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "codegen/compiled_code_cache.h"
+
+#include <elf.h>
+#include <link.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "common/logger.h"
+#include "settings/settings_manager.h"
+
+namespace peloton {
+namespace codegen {
+
+namespace {
+
+// The name of the index file in the cache directory
+constexpr char kIndexFileName[] = "index";
+
+// The number of stale records tolerated in the index before it is rewritten
+constexpr uint64_t kMinStaleIndexRecords = 64;
+
+struct BuildIdSearch {
+  // An address in the binary whose build ID we're looking for
+  uintptr_t addr;
+  // The build ID, in hex
+  std::string build_id;
+};
+
+// Callback for dl_iterate_phdr(). Reads the GNU build ID note of the loaded
+// object that contains the address we're looking for.
+int FindBuildId(struct dl_phdr_info *info, UNUSED_ATTRIBUTE size_t size,
+                void *data) {
+  auto *search = static_cast<BuildIdSearch *>(data);
+
+  // Is this the object we're looking for?
+  bool contains_addr = false;
+  for (uint32_t i = 0; i < info->dlpi_phnum; i++) {
+    const auto &phdr = info->dlpi_phdr[i];
+    uintptr_t start = info->dlpi_addr + phdr.p_vaddr;
+    if (phdr.p_type == PT_LOAD && search->addr >= start &&
+        search->addr < start + phdr.p_memsz) {
+      contains_addr = true;
+      break;
+    }
+  }
+  if (!contains_addr) {
+    return 0;
+  }
+
+  // Find the build ID in the notes
+  for (uint32_t i = 0; i < info->dlpi_phnum; i++) {
+    const auto &phdr = info->dlpi_phdr[i];
+    if (phdr.p_type != PT_NOTE) {
+      continue;
+    }
+    auto *pos = reinterpret_cast<const char *>(info->dlpi_addr + phdr.p_vaddr);
+    auto *end = pos + phdr.p_memsz;
+    while (pos + sizeof(ElfW(Nhdr)) <= end) {
+      auto *note = reinterpret_cast<const ElfW(Nhdr) *>(pos);
+      const char *name = pos + sizeof(ElfW(Nhdr));
+      const auto *desc = reinterpret_cast<const uint8_t *>(
+          name + ((note->n_namesz + 3) & ~3u));
+      if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 &&
+          std::memcmp(name, "GNU", 4) == 0) {
+        static const char kHexDigits[] = "0123456789abcdef";
+        for (uint32_t j = 0; j < note->n_descsz; j++) {
+          search->build_id += kHexDigits[desc[j] >> 4];
+          search->build_id += kHexDigits[desc[j] & 0xf];
+        }
+        return 1;
+      }
+      pos = reinterpret_cast<const char *>(desc) +
+            ((note->n_descsz + 3) & ~3u);
+    }
+  }
+  return 1;
+}
+
+}  // namespace
+
+CompiledCodeCache::CompiledCodeCache()
+    : enabled_(false),
+      memory_size_(0),
+      max_entries_(settings::SettingsManager::GetInt(
+          settings::SettingId::codegen_cache_max_entries)),
+      max_memory_size_(static_cast<uint64_t>(settings::SettingsManager::GetInt(
+                           settings::SettingId::codegen_cache_memory_size))
+                       << 20),
+      num_index_records_(0),
+      num_hits_(0),
+      num_misses_(0) {}
+
+CompiledCodeCache::~CompiledCodeCache() {
+  // Persist the usage counts collected since the last index update
+  if (IsEnabled()) {
+    WriteIndex();
+  }
+}
+
+void CompiledCodeCache::SetDirectory(const std::string &directory) {
+  std::lock_guard<std::mutex> guard{lock_};
+  if (enabled_) {
+    WriteIndexLocked();
+  }
+
+  ResetLocked();
+  directory_ = directory;
+  enabled_ = false;
+  if (directory_.empty()) {
+    return;
+  }
+
+  // Create the directory, if necessary
+  if (::mkdir(directory_.c_str(), 0700) != 0 && errno != EEXIST) {
+    LOG_ERROR("Cannot create compiled code cache directory '%s': %s",
+              directory_.c_str(), strerror(errno));
+    return;
+  }
+
+  ReadIndex();
+  enabled_ = true;
+  LOG_INFO("Compiled code cache in '%s' with %zu entries", directory_.c_str(),
+           entries_.size());
+}
+
+void CompiledCodeCache::SetCapacity(uint32_t max_entries,
+                                    uint64_t max_memory_size) {
+  std::lock_guard<std::mutex> guard{lock_};
+  max_entries_ = max_entries;
+  max_memory_size_ = max_memory_size;
+  EvictLocked();
+}
+
+bool CompiledCodeCache::Contains(const std::string &key) {
+  std::lock_guard<std::mutex> guard{lock_};
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    return false;
+  }
+
+  // The object file may have been removed since the index was read. Callers
+  // skip optimizing the module when we report a hit, so make sure getObject()
+  // can actually provide its code.
+  if (iter->second.object == nullptr && !ObjectExists(key)) {
+    RemoveEntry(key);
+    return false;
+  }
+
+  // Keep the entry from being evicted before the JIT asks for it
+  UseEntry(key);
+  return true;
+}
+
+uint32_t CompiledCodeCache::Warmup(uint32_t num_entries) {
+  std::lock_guard<std::mutex> guard{lock_};
+
+  // Order the entries by decreasing popularity
+  std::vector<std::pair<uint64_t, std::string>> by_uses;
+  for (const auto &iter : entries_) {
+    by_uses.emplace_back(iter.second.num_uses, iter.first);
+  }
+  std::sort(by_uses.begin(), by_uses.end(),
+            [](const std::pair<uint64_t, std::string> &a,
+               const std::pair<uint64_t, std::string> &b) {
+              return a.first > b.first;
+            });
+
+  uint32_t num_loaded = 0;
+  for (const auto &iter : by_uses) {
+    if (num_loaded == num_entries || memory_size_ >= max_memory_size_) {
+      break;
+    }
+    auto &entry = entries_[iter.second];
+    if (entry.object != nullptr || LoadObject(iter.second, entry)) {
+      num_loaded++;
+    }
+  }
+  EvictLocked();
+
+  LOG_INFO("Preloaded %u compiled queries from '%s'", num_loaded,
+           directory_.c_str());
+  return num_loaded;
+}
+
+void CompiledCodeCache::Clear() {
+  std::lock_guard<std::mutex> guard{lock_};
+  for (const auto &iter : entries_) {
+    std::remove(ObjectPath(iter.first).c_str());
+  }
+  ResetLocked();
+  if (enabled_) {
+    WriteIndexLocked();
+  }
+}
+
+void CompiledCodeCache::WriteIndex() {
+  std::lock_guard<std::mutex> guard{lock_};
+  WriteIndexLocked();
+}
+
+std::string CompiledCodeCache::GetBuildId() {
+  static const std::string build_id = []() {
+    BuildIdSearch search{reinterpret_cast<uintptr_t>(&FindBuildId), ""};
+    dl_iterate_phdr(FindBuildId, &search);
+    if (search.build_id.empty()) {
+      // Binaries linked without a build ID note fall back to the time this
+      // file was compiled
+      search.build_id = __DATE__ " " __TIME__;
+    }
+    return search.build_id;
+  }();
+  return build_id;
+}
+
+void CompiledCodeCache::notifyObjectCompiled(const llvm::Module *module,
+                                             llvm::MemoryBufferRef object) {
+  const std::string &key = module->getModuleIdentifier();
+  num_misses_++;
+
+  std::lock_guard<std::mutex> guard{lock_};
+  if (!enabled_) {
+    return;
+  }
+
+  // Write the object file under a temporary name first, so that concurrent
+  // readers (or a crash) never see a partial file
+  std::string path = ObjectPath(key);
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream out{tmp_path, std::ios::binary | std::ios::trunc};
+    out.write(object.getBufferStart(), object.getBufferSize());
+    if (!out) {
+      LOG_ERROR("Cannot write compiled code to '%s'", tmp_path.c_str());
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG_ERROR("Cannot move compiled code to '%s': %s", path.c_str(),
+              strerror(errno));
+    std::remove(tmp_path.c_str());
+    return;
+  }
+
+  auto &entry = UseEntry(key);
+  entry.num_uses++;
+  SetObject(key, entry,
+            llvm::MemoryBuffer::getMemBufferCopy(object.getBuffer(), key));
+  AppendIndexLocked(key, entry);
+  EvictLocked();
+
+  LOG_DEBUG("Cached compiled code of module %s (%zu bytes)", key.c_str(),
+            object.getBufferSize());
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CompiledCodeCache::getObject(
+    const llvm::Module *module) {
+  const std::string &key = module->getModuleIdentifier();
+
+  std::lock_guard<std::mutex> guard{lock_};
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    return nullptr;
+  }
+
+  auto &entry = iter->second;
+  if (entry.object == nullptr && !LoadObject(key, entry)) {
+    // The file is gone, forget about it
+    RemoveEntry(key);
+    return nullptr;
+  }
+
+  UseEntry(key);
+  entry.num_uses++;
+  num_hits_++;
+
+  // MCJIT takes ownership of the buffer it is given
+  auto copy =
+      llvm::MemoryBuffer::getMemBufferCopy(entry.object->getBuffer(), key);
+  EvictLocked();
+  return copy;
+}
+
+size_t CompiledCodeCache::GetNumEntries() {
+  std::lock_guard<std::mutex> guard{lock_};
+  return entries_.size();
+}
+
+uint64_t CompiledCodeCache::GetMemorySize() {
+  std::lock_guard<std::mutex> guard{lock_};
+  return memory_size_;
+}
+
+std::string CompiledCodeCache::ObjectPath(const std::string &key) const {
+  return directory_ + "/" + key + ".o";
+}
+
+std::string CompiledCodeCache::IndexPath() const {
+  return directory_ + "/" + kIndexFileName;
+}
+
+bool CompiledCodeCache::ObjectExists(const std::string &key) const {
+  struct stat st;
+  return ::stat(ObjectPath(key).c_str(), &st) == 0;
+}
+
+void CompiledCodeCache::ReadIndex() {
+  // Later records of an entry supersede earlier ones, and are more recent
+  std::ifstream in{IndexPath()};
+  std::string key;
+  uint64_t num_uses;
+  while (in >> key >> num_uses) {
+    UseEntry(key).num_uses = num_uses;
+    num_index_records_++;
+  }
+
+  // Forget the entries whose object file is gone, e.g. because they were
+  // evicted after their record was written
+  std::vector<std::string> missing;
+  for (const auto &iter : entries_) {
+    if (!ObjectExists(iter.first)) {
+      missing.push_back(iter.first);
+    }
+  }
+  for (const auto &key : missing) {
+    RemoveEntry(key);
+  }
+
+  EvictLocked();
+}
+
+bool CompiledCodeCache::LoadObject(const std::string &key, Entry &entry) {
+  auto buffer = llvm::MemoryBuffer::getFile(ObjectPath(key));
+  if (!buffer) {
+    LOG_WARN("Cannot read compiled code of module %s: %s", key.c_str(),
+             buffer.getError().message().c_str());
+    return false;
+  }
+  SetObject(key, entry, std::move(buffer.get()));
+  return true;
+}
+
+void CompiledCodeCache::WriteIndexLocked() {
+  if (directory_.empty()) {
+    return;
+  }
+
+  // Write the entries from the least to the most recently used one, so that
+  // reading the index restores their order
+  std::string path = IndexPath();
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream out{tmp_path, std::ios::trunc};
+    for (auto iter = lru_.rbegin(); iter != lru_.rend(); ++iter) {
+      out << *iter << ' ' << entries_[*iter].num_uses << '\n';
+    }
+    if (!out) {
+      LOG_ERROR("Cannot write compiled code index '%s'", tmp_path.c_str());
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  std::rename(tmp_path.c_str(), path.c_str());
+  num_index_records_ = entries_.size();
+}
+
+void CompiledCodeCache::AppendIndexLocked(const std::string &key,
+                                          const Entry &entry) {
+  // Once most records are stale, compact the index instead
+  if (num_index_records_ >= 2 * entries_.size() + kMinStaleIndexRecords) {
+    WriteIndexLocked();
+    return;
+  }
+
+  std::ofstream out{IndexPath(), std::ios::app};
+  out << key << ' ' << entry.num_uses << '\n';
+  if (!out) {
+    LOG_ERROR("Cannot append to compiled code index '%s'",
+              IndexPath().c_str());
+    return;
+  }
+  num_index_records_++;
+}
+
+CompiledCodeCache::Entry &CompiledCodeCache::UseEntry(const std::string &key) {
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    auto &entry = entries_[key];
+    lru_.push_front(key);
+    entry.lru_pos = lru_.begin();
+    return entry;
+  }
+
+  auto &entry = iter->second;
+  lru_.splice(lru_.begin(), lru_, entry.lru_pos);
+  if (entry.object != nullptr) {
+    loaded_.splice(loaded_.begin(), loaded_, entry.loaded_pos);
+  }
+  return entry;
+}
+
+void CompiledCodeCache::SetObject(const std::string &key, Entry &entry,
+                                  std::unique_ptr<llvm::MemoryBuffer> object) {
+  DropObject(entry);
+  memory_size_ += object->getBufferSize();
+  entry.object = std::move(object);
+  loaded_.push_front(key);
+  entry.loaded_pos = loaded_.begin();
+}
+
+void CompiledCodeCache::DropObject(Entry &entry) {
+  if (entry.object == nullptr) {
+    return;
+  }
+  memory_size_ -= entry.object->getBufferSize();
+  entry.object.reset();
+  loaded_.erase(entry.loaded_pos);
+}
+
+void CompiledCodeCache::RemoveEntry(const std::string &key) {
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    return;
+  }
+  std::remove(ObjectPath(key).c_str());
+  DropObject(iter->second);
+  lru_.erase(iter->second.lru_pos);
+  entries_.erase(iter);
+}
+
+void CompiledCodeCache::ResetLocked() {
+  entries_.clear();
+  lru_.clear();
+  loaded_.clear();
+  memory_size_ = 0;
+  num_index_records_ = 0;
+}
+
+void CompiledCodeCache::EvictLocked() {
+  while (entries_.size() > max_entries_) {
+    // Copy the key, removing the entry frees the list node it lives in
+    std::string key = lru_.back();
+    LOG_DEBUG("Evicting compiled code of module %s", key.c_str());
+    RemoveEntry(key);
+  }
+  while (memory_size_ > max_memory_size_) {
+    DropObject(entries_[loaded_.back()]);
+  }
+}
+
+}  // namespace codegen
+}  // namespace peloton
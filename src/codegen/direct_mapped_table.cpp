@@ -0,0 +1,251 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// direct_mapped_table.cpp
+//
+// Identification: src/codegen/direct_mapped_table.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "codegen/direct_mapped_table.h"
+
+#include <limits>
+
+#include "codegen/lang/if.h"
+#include "codegen/lang/loop.h"
+#include "codegen/lang/vectorized_loop.h"
+#include "codegen/type/sql_type.h"
+
+namespace peloton {
+namespace codegen {
+
+namespace {
+
+// The size of the header of every slot. This keeps the value area aligned.
+constexpr uint64_t kSlotHeaderSize = sizeof(uint64_t);
+
+// The number of distinct values in the given range, or 0 if there are 2^64
+uint64_t RangeSize(const DirectMappedTable::KeyRange &range) {
+  return static_cast<uint64_t>(range.max) - static_cast<uint64_t>(range.min) +
+         1;
+}
+
+}  // namespace
+
+DirectMappedTable::DirectMappedTable() : num_slots_(0), slot_size_(0) {}
+
+DirectMappedTable::DirectMappedTable(const std::vector<type::Type> &key_type,
+                                     const std::vector<KeyRange> &key_ranges,
+                                     uint64_t value_size)
+    : key_type_(key_type), key_ranges_(key_ranges) {
+  PELOTON_ASSERT(key_type.size() == key_ranges.size());
+  num_slots_ = NumSlots(key_ranges);
+  PELOTON_ASSERT(num_slots_ <= std::numeric_limits<int32_t>::max());
+
+  // Round the value area up to the alignment of the header
+  slot_size_ = kSlotHeaderSize + (value_size + kSlotHeaderSize - 1) /
+                                     kSlotHeaderSize * kSlotHeaderSize;
+}
+
+uint64_t DirectMappedTable::NumSlots(const std::vector<KeyRange> &key_ranges) {
+  uint64_t num_slots = 1;
+  for (const auto &range : key_ranges) {
+    uint64_t range_size = RangeSize(range);
+    if (range.min > range.max || range_size == 0 ||
+        num_slots > std::numeric_limits<uint64_t>::max() / range_size) {
+      return std::numeric_limits<uint64_t>::max();
+    }
+    num_slots *= range_size;
+  }
+  return num_slots;
+}
+
+llvm::Type *DirectMappedTable::GetStateType(CodeGen &codegen) const {
+  return codegen.ArrayType(codegen.Int64Type(),
+                           num_slots_ * slot_size_ / sizeof(uint64_t));
+}
+
+void DirectMappedTable::Init(CodeGen &codegen, llvm::Value *table_ptr) const {
+  llvm::Value *byte_ptr =
+      codegen->CreateBitCast(table_ptr, codegen.CharPtrType());
+  codegen->CreateMemSet(byte_ptr, codegen.Const8(0),
+                        codegen.Const64(num_slots_ * slot_size_),
+                        sizeof(uint64_t));
+}
+
+llvm::Value *DirectMappedTable::GetSlot(CodeGen &codegen,
+                                        llvm::Value *table_ptr,
+                                        llvm::Value *index) const {
+  llvm::Value *byte_ptr =
+      codegen->CreateBitCast(table_ptr, codegen.CharPtrType());
+  llvm::Value *byte_offset = codegen->CreateMul(
+      codegen->CreateZExtOrBitCast(index, codegen.Int64Type()),
+      codegen.Const64(slot_size_));
+  return codegen->CreateInBoundsGEP(codegen.ByteType(), byte_ptr, byte_offset);
+}
+
+llvm::Value *DirectMappedTable::GetSlotHeader(CodeGen &codegen,
+                                              llvm::Value *slot_ptr) const {
+  return codegen->CreateBitCast(slot_ptr,
+                                codegen.Int64Type()->getPointerTo());
+}
+
+llvm::Value *DirectMappedTable::GetSlotValue(CodeGen &codegen,
+                                             llvm::Value *slot_ptr) const {
+  return codegen->CreateInBoundsGEP(codegen.ByteType(), slot_ptr,
+                                    codegen.Const64(kSlotHeaderSize));
+}
+
+void DirectMappedTable::ProbeOrInsert(
+    CodeGen &codegen, llvm::Value *table_ptr,
+    const std::vector<codegen::Value> &key,
+    HashTable::ProbeCallback &probe_callback,
+    HashTable::InsertCallback &insert_callback,
+    const std::function<void()> &no_slot) const {
+  PELOTON_ASSERT(key.size() == key_ranges_.size());
+
+  // The slot is at the position of the key in the (row-major) array of all
+  // keys in the ranges. A key is in its range if its offset from the start of
+  // the range, as an unsigned number, doesn't exceed the size of the range.
+  llvm::Value *has_slot = codegen.ConstBool(true);
+  llvm::Value *index = codegen.Const64(0);
+  uint64_t stride = 1;
+  for (uint32_t i = 0; i < key.size(); i++) {
+    const auto &range = key_ranges_[i];
+    llvm::Value *val = key[i].GetValue();
+    if (key_type_[i].type_id == peloton::type::TypeId::BOOLEAN) {
+      val = codegen->CreateZExt(val, codegen.Int64Type());
+    } else {
+      val = codegen->CreateSExtOrBitCast(val, codegen.Int64Type());
+    }
+
+    llvm::Value *offset = codegen->CreateSub(val, codegen.Const64(range.min));
+    llvm::Value *in_range = codegen->CreateICmpULE(
+        offset, codegen.Const64(RangeSize(range) - 1));
+    if (key[i].IsNullable()) {
+      in_range = codegen->CreateAnd(in_range, key[i].IsNotNull(codegen));
+    }
+    has_slot = codegen->CreateAnd(has_slot, in_range);
+
+    index = codegen->CreateAdd(
+        index, codegen->CreateMul(offset, codegen.Const64(stride)));
+    stride *= RangeSize(range);
+  }
+
+  lang::If key_has_slot{codegen, has_slot, "hasSlot"};
+  {
+    llvm::Value *slot_ptr = GetSlot(codegen, table_ptr, index);
+    llvm::Value *header_ptr = GetSlotHeader(codegen, slot_ptr);
+    llvm::Value *value_ptr = GetSlotValue(codegen, slot_ptr);
+
+    llvm::Value *occupied = codegen->CreateICmpNE(
+        codegen->CreateLoad(header_ptr), codegen.Const64(0));
+    lang::If slot_occupied{codegen, occupied, "slotOccupied"};
+    {
+      probe_callback.ProcessEntry(codegen, value_ptr);
+    }
+    slot_occupied.ElseBlock("slotFree");
+    {
+      codegen->CreateStore(codegen.Const64(1), header_ptr);
+      insert_callback.StoreValue(codegen, value_ptr);
+    }
+    slot_occupied.EndIf();
+  }
+  key_has_slot.ElseBlock("noSlot");
+  {
+    no_slot();
+  }
+  key_has_slot.EndIf();
+}
+
+void DirectMappedTable::VectorizedIterate(
+    CodeGen &codegen, llvm::Value *table_ptr, Vector &selection_vector,
+    HashTable::VectorizedIterateCallback &callback) const {
+  // Like OAHashTable::VectorizedIterate(), a first pass collects the positions
+  // of occupied slots in the selection vector. The second pass, done by the
+  // callback, reads them.
+  uint32_t size = selection_vector.GetCapacity();
+  PELOTON_ASSERT((size & (size - 1)) == 0);
+
+  llvm::Value *num_slots = codegen.Const32(num_slots_);
+  lang::VectorizedLoop vector_loop{codegen, num_slots, size, {}};
+  {
+    auto curr_range = vector_loop.GetCurrentRange();
+    llvm::Value *start = curr_range.start;
+    llvm::Value *end = curr_range.end;
+
+    std::vector<lang::Loop::LoopVariable> loop_vars = {
+        {"directMapPos", start}, {"directMapSelPos", codegen.Const32(0)}};
+    lang::Loop filter_loop{codegen, codegen.ConstBool(true), loop_vars};
+    {
+      llvm::Value *pos = filter_loop.GetLoopVar(0);
+      llvm::Value *sel_pos = filter_loop.GetLoopVar(1);
+
+      // sel[sel_pos] = pos
+      selection_vector.SetValue(codegen, sel_pos, pos);
+
+      // sel_pos += slot->occupied
+      llvm::Value *slot_ptr = GetSlot(codegen, table_ptr, pos);
+      llvm::Value *occupied = codegen->CreateICmpNE(
+          codegen->CreateLoad(GetSlotHeader(codegen, slot_ptr)),
+          codegen.Const64(0));
+      sel_pos = codegen->CreateAdd(
+          sel_pos, codegen->CreateZExt(occupied, codegen.Int32Type()));
+
+      pos = codegen->CreateAdd(pos, codegen.Const32(1));
+      filter_loop.LoopEnd(codegen->CreateICmpULT(pos, end), {pos, sel_pos});
+    }
+
+    std::vector<llvm::Value *> final_vars;
+    filter_loop.CollectFinalLoopVariables(final_vars);
+    selection_vector.SetNumElements(final_vars[1]);
+
+    // Selection vector is filled, deliver vector to callback
+    DirectMappedTableAccess access{*this, table_ptr};
+    callback.ProcessEntries(codegen, start, end, selection_vector, access);
+
+    vector_loop.LoopEnd(codegen, {});
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// DIRECT MAPPED TABLE ACCESS
+//===----------------------------------------------------------------------===//
+
+void DirectMappedTable::DirectMappedTableAccess::ExtractBucketKeys(
+    CodeGen &codegen, llvm::Value *index,
+    std::vector<codegen::Value> &keys) const {
+  // Undo the computation of the position in ProbeOrInsert()
+  llvm::Value *rest = codegen->CreateZExtOrBitCast(index, codegen.Int64Type());
+  for (uint32_t i = 0; i < table_.key_type_.size(); i++) {
+    const auto &col_type = table_.key_type_[i];
+    const auto &range = table_.key_ranges_[i];
+
+    llvm::Value *range_size = codegen.Const64(RangeSize(range));
+    llvm::Value *offset = codegen->CreateURem(rest, range_size);
+    rest = codegen->CreateUDiv(rest, range_size);
+
+    llvm::Type *val_type = nullptr, *len_type = nullptr;
+    col_type.GetSqlType().GetTypeForMaterialization(codegen, val_type,
+                                                    len_type);
+    llvm::Value *val = codegen->CreateTruncOrBitCast(
+        codegen->CreateAdd(offset, codegen.Const64(range.min)), val_type);
+
+    // Keys with NULL columns have no slot
+    llvm::Value *is_null =
+        col_type.nullable ? codegen.ConstBool(false) : nullptr;
+    keys.emplace_back(col_type, val, nullptr, is_null);
+  }
+}
+
+llvm::Value *DirectMappedTable::DirectMappedTableAccess::BucketValue(
+    CodeGen &codegen, llvm::Value *index) const {
+  llvm::Value *slot_ptr = table_.GetSlot(codegen, table_ptr_, index);
+  return table_.GetSlotValue(codegen, slot_ptr);
+}
+
+}  // namespace codegen
+}  // namespace peloton
@@ -29,6 +29,8 @@ void Inserter::Init(storage::DataTable *table,
   PELOTON_ASSERT(table && executor_context);
   table_ = table;
   executor_context_ = executor_context;
+  pending_ = new std::vector<ItemPointer>();
+  pending_->reserve(kBatchSize);
 }
 
 char *Inserter::AllocateTupleStorage() {
@@ -51,24 +53,51 @@ peloton::type::AbstractPool *Inserter::GetPool() {
 
 void Inserter::Insert() {
   PELOTON_ASSERT(table_ && executor_context_ && tile_);
+  pending_->push_back(location_);
+  if (pending_->size() >= kBatchSize) {
+    Flush();
+  }
+}
+
+void Inserter::Flush() {
+  PELOTON_ASSERT(table_ && executor_context_);
+  if (pending_->empty()) {
+    return;
+  }
   auto *txn = executor_context_->GetTransaction();
   auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
 
-  ContainerTuple<storage::TileGroup> tuple(
-      table_->GetTileGroupById(location_.block).get(), location_.offset);
-  ItemPointer *index_entry_ptr = nullptr;
-  bool result = table_->InsertTuple(&tuple, location_, txn, &index_entry_ptr);
+  // The tuples are already in place, so they are read from the tile groups
+  std::vector<ContainerTuple<storage::TileGroup>> tuples;
+  std::vector<const AbstractTuple *> tuple_ptrs;
+  tuples.reserve(pending_->size());
+  tuple_ptrs.reserve(pending_->size());
+  std::shared_ptr<storage::TileGroup> tile_group;
+  for (const auto &location : *pending_) {
+    if (tile_group == nullptr ||
+        tile_group->GetTileGroupId() != location.block) {
+      tile_group = table_->GetTileGroupById(location.block);
+    }
+    tuples.emplace_back(tile_group.get(), location.offset);
+    tuple_ptrs.push_back(&tuples.back());
+  }
+
+  std::vector<ItemPointer *> index_entry_ptrs;
+  bool result =
+      table_->InsertTuples(tuple_ptrs, *pending_, txn, index_entry_ptrs);
   if (result == false) {
     txn_manager.SetTransactionResult(txn, ResultType::FAILURE);
-    return;
+  } else {
+    executor_context_->num_processed += pending_->size();
   }
-  txn_manager.PerformInsert(txn, location_, index_entry_ptr);
-  executor_context_->num_processed++;
+  pending_->clear();
 }
 
 void Inserter::TearDown() {
   // Updater object does not destruct its own data structures
   tile_.reset();
+  delete pending_;
+  pending_ = nullptr;
 }
 
 }  // namespace codegen
@@ -14,6 +14,7 @@
 
 #include <llvm/IR/InstIterator.h>
 #include <fstream>
+#include <unordered_set>
 
 #include "codegen/codegen.h"
 #include "common/exception.h"
@@ -302,6 +303,15 @@ value_t BytecodeBuilder::GetConstantValue(
       }
 
       case llvm::Type::PointerTyID: {
+        // External pointers live in slots owned by the code context
+        if (auto *global = llvm::dyn_cast<llvm::GlobalVariable>(constant)) {
+          const void *slot =
+              code_context_.LookupExternalPointer(global->getName().str());
+          if (slot != nullptr) {
+            return reinterpret_cast<value_t>(slot);
+          }
+        }
+
         if (constant->getNumOperands() > 0) {
           if (auto *constant_int =
                   llvm::dyn_cast<llvm::ConstantInt>(constant->getOperand(0))) {
@@ -426,6 +436,32 @@ ffi_type *BytecodeBuilder::GetFFIType(llvm::Type *type) const {
   }
 }
 
+bool BytecodeBuilder::IsNativeCall(
+    UNUSED_ATTRIBUTE const llvm::CallInst *call_instruction) const {
+#if defined(__x86_64__) || defined(__aarch64__)
+  // On these platforms, the first integer arguments are passed in registers,
+  // and integers are returned in a register
+  auto is_integer = [](llvm::Type *type) {
+    return type->isPointerTy() ||
+           (type->isIntegerTy() && type->getIntegerBitWidth() <= 64);
+  };
+
+  if (call_instruction->getNumArgOperands() > kMaxNativeCallArgs ||
+      !(call_instruction->getType()->isVoidTy() ||
+        is_integer(call_instruction->getType()))) {
+    return false;
+  }
+  for (unsigned int i = 0; i < call_instruction->getNumArgOperands(); i++) {
+    if (!is_integer(call_instruction->getArgOperand(i)->getType())) {
+      return false;
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
 bool BytecodeBuilder::IsConstantValue(const llvm::Value *value) const {
   auto *constant = llvm::dyn_cast<llvm::Constant>(value);
   return (constant != nullptr);
@@ -949,6 +985,125 @@ void BytecodeBuilder::TranslateFunction() {
         &bytecode_function_.bytecode_[relocation.instruction_slot])
         ->args[relocation.argument] = bb_mapping[relocation.bb];
   }
+
+  FuseInstructions(bb_mapping);
+}
+
+void BytecodeBuilder::FuseInstructions(
+    const std::unordered_map<const llvm::BasicBlock *, index_t> &bb_mapping) {
+  // Instructions that start a basic block may be jumped to, so they can't
+  // become the second half of a superinstruction
+  std::unordered_set<index_t> bb_starts;
+  for (const auto &bb_iter : bb_mapping) {
+    bb_starts.insert(bb_iter.second);
+  }
+
+  auto &bytecode = bytecode_function_.bytecode_;
+  size_t index = 0;
+  while (index < bytecode.size()) {
+    auto *first = reinterpret_cast<Instruction *>(&bytecode[index]);
+    size_t next = index + BytecodeFunction::GetInstructionSlotSize(first);
+
+    // All fused pairs consist of two single slot instructions
+    if (next != index + 1 || next >= bytecode.size() ||
+        bb_starts.count(next) != 0) {
+      index = next;
+      continue;
+    }
+
+    const auto *second = reinterpret_cast<const Instruction *>(&bytecode[next]);
+    bool fused = BytecodeFunction::GetInstructionSlotSize(second) == 1 &&
+                 (FuseCompareAndBranch(first, second) ||
+                  FuseGEPAndLoad(first, second));
+    if (fused) {
+      index = next + 1;
+    } else {
+      index = next;
+    }
+  }
+}
+
+bool BytecodeBuilder::FuseCompareAndBranch(Instruction *first,
+                                           const Instruction *second) {
+  // The compare opcodes and their superinstructions, for all their types
+  struct CompareFusion {
+    Opcode compare;
+    Opcode fused;
+    index_t number_types;
+  };
+  static const CompareFusion compare_fusions[] = {
+      {Opcode::cmp_eq_i8, Opcode::cmp_eq_branch_i8, 6},
+      {Opcode::cmp_ne_i8, Opcode::cmp_ne_branch_i8, 6},
+      {Opcode::cmp_gt_i8, Opcode::cmp_gt_branch_i8, 6},
+      {Opcode::cmp_lt_i8, Opcode::cmp_lt_branch_i8, 6},
+      {Opcode::cmp_ge_i8, Opcode::cmp_ge_branch_i8, 6},
+      {Opcode::cmp_le_i8, Opcode::cmp_le_branch_i8, 6},
+      {Opcode::cmp_sgt_i8, Opcode::cmp_sgt_branch_i8, 4},
+      {Opcode::cmp_slt_i8, Opcode::cmp_slt_branch_i8, 4},
+      {Opcode::cmp_sge_i8, Opcode::cmp_sge_branch_i8, 4},
+      {Opcode::cmp_sle_i8, Opcode::cmp_sle_branch_i8, 4}};
+
+  index_t id = BytecodeFunction::GetOpcodeId(first->op);
+  Opcode fused = Opcode::undefined;
+  for (const auto &fusion : compare_fusions) {
+    index_t compare_id = BytecodeFunction::GetOpcodeId(fusion.compare);
+    if (id >= compare_id && id < compare_id + fusion.number_types) {
+      fused = BytecodeFunction::GetOpcodeFromId(
+          BytecodeFunction::GetOpcodeId(fusion.fused) + (id - compare_id));
+      break;
+    }
+  }
+  if (fused == Opcode::undefined) {
+    return false;
+  }
+
+  // The branch must depend on the result of the compare
+  if (second->args[0] != first->args[0]) {
+    return false;
+  }
+
+  index_t true_target;
+  index_t false_target;
+  if (second->op == Opcode::branch_cond_ft) {
+    true_target = second->args[1];
+    false_target = bytecode_function_.GetIndexFromIP(second) + 1;
+  } else if (second->op == Opcode::branch_cond) {
+    true_target = second->args[2];
+    false_target = second->args[1];
+  } else {
+    return false;
+  }
+
+  // The superinstruction overwrites the branch
+  first->op = fused;
+  first->args[3] = true_target;
+  first->args[4] = false_target;
+  return true;
+}
+
+bool BytecodeBuilder::FuseGEPAndLoad(Instruction *first,
+                                     const Instruction *second) {
+  index_t load_id = BytecodeFunction::GetOpcodeId(second->op);
+  index_t first_load_id = BytecodeFunction::GetOpcodeId(Opcode::load_i8);
+  if (first->op != Opcode::gep_offset || load_id < first_load_id ||
+      load_id > BytecodeFunction::GetOpcodeId(Opcode::load_i64)) {
+    return false;
+  }
+
+  // The load must read the member the GEP computed the address of
+  if (second->args[1] != first->args[0]) {
+    return false;
+  }
+
+  // The superinstruction overwrites the load
+  index_t gep_dest = first->args[0];
+  index_t load_dest = second->args[0];
+  first->op = BytecodeFunction::GetOpcodeFromId(
+      BytecodeFunction::GetOpcodeId(Opcode::gep_offset_load_i8) +
+      (load_id - first_load_id));
+  first->args[0] = load_dest;
+  first->args[3] = gep_dest;
+  return true;
 }
 
 void BytecodeBuilder::Finalize() {
@@ -1730,15 +1885,21 @@ void BytecodeBuilder::TranslateCall(const llvm::Instruction *instruction) {
                                       function_name);
         }
 
-        // libffi is used for external function calls
+        // libffi is used for external function calls, unless the function
+        // takes and returns only integers and can be called directly.
         // Here we collect all the information that will be needed at runtime
         // (function activation time) to create the libffi call interface.
+        bool native_call = IsNativeCall(call_instruction);
 
         // Show a hint, that an explicit wrapper could be created for this
         // function
-        LOG_DEBUG("The interpreter will call the C++ function '%s' per libffi. "
-                  "Consider adding an explicit wrapper for this function in "
-                  "bytecode_instructions.def\n", function_name.c_str());
+        if (!native_call) {
+          LOG_DEBUG(
+              "The interpreter will call the C++ function '%s' per libffi. "
+              "Consider adding an explicit wrapper for this function in "
+              "bytecode_instructions.def\n",
+              function_name.c_str());
+        }
 
         index_t dest_slot = 0;
         if (!instruction->getType()->isVoidTy()) {
@@ -1749,7 +1910,7 @@ void BytecodeBuilder::TranslateCall(const llvm::Instruction *instruction) {
         ExternalCallContext call_context{
             dest_slot, GetFFIType(instruction->getType()),
             std::vector<index_t>(arguments_num),
-            std::vector<ffi_type *>(arguments_num)};
+            std::vector<ffi_type *>(arguments_num), native_call};
 
         for (unsigned int i = 0; i < call_instruction->getNumArgOperands();
              i++) {
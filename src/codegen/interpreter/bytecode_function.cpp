@@ -104,6 +104,9 @@ size_t BytecodeFunction::GetInstructionSlotSize(
 #define HANDLE_OVERFLOW_TYPED_INST(op, type) \
   case Opcode::op##_##type:                  \
     return 2;
+#define HANDLE_FUSED_TYPED_INST(op, type) \
+  case Opcode::op##_##type:               \
+    return 2;
 #define HANDLE_EXPLICIT_CALL_INST(op, func)    \
   case Opcode::op:                             \
     return GetExplicitCallInstructionSlotSize( \
@@ -276,6 +279,15 @@ std::string BytecodeFunction::Dump(const Instruction *instruction) const {
     output << "[" << std::setw(3) << instruction->args[3] << "] "; \
     break;
 
+#define HANDLE_FUSED_TYPED_INST(op, type)                          \
+  case Opcode::op##_##type:                                        \
+    output << "[" << std::setw(3) << instruction->args[0] << "] "; \
+    output << "[" << std::setw(3) << instruction->args[1] << "] "; \
+    output << "[" << std::setw(3) << instruction->args[2] << "] "; \
+    output << "[" << std::setw(3) << instruction->args[3] << "] "; \
+    output << "[" << std::setw(3) << instruction->args[4] << "] "; \
+    break;
+
 #define HANDLE_EXPLICIT_CALL_INST(opcode, func)                        \
   case Opcode::opcode:                                                 \
     for (size_t i = 0; i < GetFunctionRequiredArgSlotsNum(&func); i++) \
@@ -157,6 +157,11 @@ void BytecodeInterpreter::InitializeActivationRecord(
     auto &call_context = bytecode_function_.external_call_contexts_[i];
     auto &call_activation = call_activations_[i];
 
+    // direct calls don't need libffi
+    if (call_context.native_call) {
+      continue;
+    }
+
     // initialize libffi call interface
     if (ffi_prep_cif(&call_activation.call_interface, FFI_DEFAULT_ABI,
                      call_context.args.size(), call_context.dest_type,
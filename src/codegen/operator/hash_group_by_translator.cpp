@@ -12,18 +12,65 @@
 
 #include "codegen/operator/hash_group_by_translator.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "codegen/compilation_context.h"
 #include "codegen/lang/if.h"
 #include "codegen/proxy/oa_hash_table_proxy.h"
 #include "codegen/operator/projection_translator.h"
 #include "codegen/lang/vectorized_loop.h"
 #include "codegen/type/integer_type.h"
+#include "optimizer/stats/column_stats.h"
+#include "optimizer/stats/stats_storage.h"
+#include "planner/abstract_scan_plan.h"
+#include "settings/settings_manager.h"
+#include "storage/data_table.h"
 
 namespace peloton {
 namespace codegen {
 
 std::atomic<bool> HashGroupByTranslator::kUsePrefetch{false};
 
+namespace {
+
+// Find the range of values of the given grouping attribute in the statistics
+// of the table column it is read from. The statistics are collected from a
+// sample and may be stale, so the range is only a hint.
+bool LookupColumnRange(const planner::AggregatePlan &plan,
+                       const planner::AttributeInfo *ai,
+                       DirectMappedTable::KeyRange &range) {
+  const auto *scan =
+      dynamic_cast<const planner::AbstractScan *>(plan.GetChild(0));
+  if (scan == nullptr || scan->GetTable() == nullptr) {
+    return false;
+  }
+  std::vector<const planner::AttributeInfo *> scan_ais;
+  scan->GetAttributes(scan_ais);
+  if (std::find(scan_ais.begin(), scan_ais.end(), ai) == scan_ais.end()) {
+    return false;
+  }
+
+  const auto *table = scan->GetTable();
+  auto stats = optimizer::StatsStorage::GetInstance()->GetColumnStatsByID(
+      table->GetDatabaseOid(), table->GetOid(), ai->attribute_id);
+  if (stats == nullptr) {
+    return false;
+  }
+  std::vector<double> values = stats->histogram_bounds;
+  values.insert(values.end(), stats->most_common_vals.begin(),
+                stats->most_common_vals.end());
+  if (values.empty()) {
+    return false;
+  }
+  auto min_max = std::minmax_element(values.begin(), values.end());
+  range.min = static_cast<int64_t>(std::floor(*min_max.first));
+  range.max = static_cast<int64_t>(std::ceil(*min_max.second));
+  return true;
+}
+
+}  // namespace
+
 //===----------------------------------------------------------------------===//
 // HASH GROUP BY TRANSLATOR
 //===----------------------------------------------------------------------===//
@@ -82,14 +129,37 @@ HashGroupByTranslator::HashGroupByTranslator(
   // Setup the aggregation logic for this group by
   aggregation_.Setup(codegen, aggregates, false, key_type);
 
+  // Keys of small integral columns are packed into a single integer, which
+  // is all the hash table stores and compares
+  std::vector<type::Type> hash_key_type = key_type;
+  if (packed_key_.Setup(codegen, key_type)) {
+    hash_key_type = {packed_key_.GetPackedType()};
+  }
+
   // Create the hash table
-  hash_table_ =
-      OAHashTable{codegen, key_type, aggregation_.GetAggregatesStorageSize()};
+  hash_table_ = OAHashTable{codegen, hash_key_type,
+                            aggregation_.GetAggregatesStorageSize()};
+
+  // If the keys come from a small domain, groups are stored in an array with
+  // a slot for every key instead. The hash table only gets the keys outside
+  // of the domain the statistics predicted.
+  std::vector<DirectMappedTable::KeyRange> key_ranges;
+  if (CollectKeyRanges(key_ranges)) {
+    direct_map_ = DirectMappedTable{key_type, key_ranges,
+                                    aggregation_.GetAggregatesStorageSize()};
+    direct_map_id_ = query_state.RegisterState(
+        "groupByDirectMap", direct_map_.GetStateType(codegen));
+    LOG_DEBUG("Aggregation uses a direct-mapped table with %llu slots",
+              (unsigned long long)direct_map_.GetNumSlots());
+  }
 }
 
 // Initialize the hash table instance
 void HashGroupByTranslator::InitializeQueryState() {
   hash_table_.Init(GetCodeGen(), LoadStatePtr(hash_table_id_));
+  if (UseDirectMapping()) {
+    direct_map_.Init(GetCodeGen(), LoadStatePtr(direct_map_id_));
+  }
   aggregation_.InitializeQueryState(GetCodeGen());
 }
 
@@ -108,9 +178,17 @@ void HashGroupByTranslator::Produce() const {
     auto *raw_vec = codegen.AllocateBuffer(i32_type, vec_size, "hgbSelVector");
     Vector selection_vec{raw_vec, vec_size, i32_type};
 
-    // Iterate
+    // Iterate the groups in the direct-mapped table, then those in the hash
+    // table
     const auto &plan = GetPlanAs<planner::AggregatePlan>();
-    ProduceResults produce_results{ctx, plan, aggregation_};
+    if (UseDirectMapping()) {
+      ProduceResults direct_map_results{ctx, plan, aggregation_, nullptr};
+      direct_map_.VectorizedIterate(codegen, LoadStatePtr(direct_map_id_),
+                                    selection_vec, direct_map_results);
+    }
+    const PackedKey *packed_key =
+        packed_key_.IsPacked() ? &packed_key_ : nullptr;
+    ProduceResults produce_results{ctx, plan, aggregation_, packed_key};
     hash_table_.VectorizedIterate(codegen, LoadStatePtr(hash_table_id_),
                                   selection_vec, produce_results);
   };
@@ -154,7 +232,8 @@ void HashGroupByTranslator::Consume(ConsumerContext &context,
       CollectHashKeys(row, key);
 
       // Hash the key and store in prefetch vector
-      llvm::Value *hash_val = hash_table_.HashKey(codegen, key);
+      llvm::Value *hash_val =
+          hash_table_.HashKey(codegen, GetHashTableKey(codegen, key));
 
       // StoreValue hashed val in prefetch vector
       hashes.SetValue(codegen, p, hash_val);
@@ -223,18 +302,31 @@ void HashGroupByTranslator::Consume(ConsumerContext &,
     }
   }
 
-  // If the hash value is available, use it
-  llvm::Value *hash = nullptr;
-  if (row.HasAttribute(&OAHashTable::kHashAI)) {
-    codegen::Value hash_val = row.DeriveValue(codegen, &OAHashTable::kHashAI);
-    hash = hash_val.GetValue();
-  }
-
-  // Perform the insertion into the hash table
-  llvm::Value *hash_table = LoadStatePtr(hash_table_id_);
+  // The callbacks updating or creating the aggregates of the group
   ConsumerProbe probe{GetCompilationContext(), aggregation_, vals, key};
   ConsumerInsert insert{aggregation_, vals, key};
-  hash_table_.ProbeOrInsert(codegen, hash_table, hash, key, probe, insert);
+
+  auto insert_into_hash_table = [&]() {
+    // If the hash value is available, use it
+    llvm::Value *hash = nullptr;
+    if (row.HasAttribute(&OAHashTable::kHashAI)) {
+      codegen::Value hash_val =
+          row.DeriveValue(codegen, &OAHashTable::kHashAI);
+      hash = hash_val.GetValue();
+    }
+
+    // Perform the insertion into the hash table
+    llvm::Value *hash_table = LoadStatePtr(hash_table_id_);
+    hash_table_.ProbeOrInsert(codegen, hash_table, hash,
+                              GetHashTableKey(codegen, key), probe, insert);
+  };
+
+  if (UseDirectMapping()) {
+    direct_map_.ProbeOrInsert(codegen, LoadStatePtr(direct_map_id_), key,
+                              probe, insert, insert_into_hash_table);
+  } else {
+    insert_into_hash_table();
+  }
 }
 
 // Cleanup by destroying the aggregation hash-table
@@ -264,6 +356,49 @@ void HashGroupByTranslator::CollectHashKeys(
   }
 }
 
+std::vector<codegen::Value> HashGroupByTranslator::GetHashTableKey(
+    CodeGen &codegen, const std::vector<codegen::Value> &key) const {
+  if (!packed_key_.IsPacked()) {
+    return key;
+  }
+  return {packed_key_.Pack(codegen, key)};
+}
+
+bool HashGroupByTranslator::CollectKeyRanges(
+    std::vector<DirectMappedTable::KeyRange> &key_ranges) const {
+  auto max_slots = static_cast<uint64_t>(settings::SettingsManager::GetInt(
+      settings::SettingId::codegen_direct_map_slots));
+  if (max_slots == 0) {
+    return false;
+  }
+
+  const auto &plan = GetPlanAs<planner::AggregatePlan>();
+  for (const auto *gb_ai : plan.GetGroupbyAIs()) {
+    DirectMappedTable::KeyRange range;
+    switch (gb_ai->type.type_id) {
+      case peloton::type::TypeId::BOOLEAN: {
+        range = {0, 1};
+        break;
+      }
+      case peloton::type::TypeId::TINYINT: {
+        range = {INT8_MIN, INT8_MAX};
+        break;
+      }
+      case peloton::type::TypeId::SMALLINT:
+      case peloton::type::TypeId::INTEGER:
+      case peloton::type::TypeId::BIGINT: {
+        if (!LookupColumnRange(plan, gb_ai, range)) {
+          return false;
+        }
+        break;
+      }
+      default: { return false; }
+    }
+    key_ranges.push_back(range);
+  }
+  return DirectMappedTable::NumSlots(key_ranges) <= max_slots;
+}
+
 //===----------------------------------------------------------------------===//
 // AGGREGATE FINALIZER
 //===----------------------------------------------------------------------===//
@@ -313,8 +448,11 @@ codegen::Value HashGroupByTranslator::AggregateAccess::Access(
 
 HashGroupByTranslator::ProduceResults::ProduceResults(
     ConsumerContext &ctx, const planner::AggregatePlan &plan,
-    const Aggregation &aggregation)
-    : ctx_(ctx), plan_(plan), aggregation_(aggregation) {}
+    const Aggregation &aggregation, const PackedKey *packed_key)
+    : ctx_(ctx),
+      plan_(plan),
+      aggregation_(aggregation),
+      packed_key_(packed_key) {}
 
 void HashGroupByTranslator::ProduceResults::ProcessEntries(
     CodeGen &codegen, llvm::Value *start, llvm::Value *end,
@@ -322,7 +460,14 @@ void HashGroupByTranslator::ProduceResults::ProcessEntries(
   RowBatch batch{ctx_.GetCompilationContext(), start, end, selection_vector,
                  true};
 
-  AggregateFinalizer finalizer{aggregation_, access};
+  // Restore the grouping columns of packed keys
+  std::unique_ptr<PackedKey::UnpackingAccess> unpacking_access;
+  if (packed_key_ != nullptr) {
+    unpacking_access.reset(
+        new PackedKey::UnpackingAccess(*packed_key_, access));
+  }
+  AggregateFinalizer finalizer{
+      aggregation_, unpacking_access != nullptr ? *unpacking_access : access};
 
   auto &grouping_ais = plan_.GetGroupbyAIs();
   auto &aggregates = plan_.GetUniqueAggTerms();
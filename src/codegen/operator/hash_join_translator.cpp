@@ -17,6 +17,7 @@
 #include "codegen/lang/vectorized_loop.h"
 #include "codegen/proxy/bloom_filter_proxy.h"
 #include "codegen/proxy/hash_table_proxy.h"
+#include "codegen/type/sql_type.h"
 #include "expression/tuple_value_expression.h"
 #include "planner/hash_join_plan.h"
 
@@ -38,10 +39,13 @@ class HashJoinTranslator::ProbeRight : public HashTable::IterateCallback {
    * @param context The context reference
    * @param row A reference to the row from the right side of the join
    * @param right_key A reference to the key from the right side of the join
+   * @param probe_matched Pointer to a boolean that is set when the row finds
+   * a join partner, or NULL if the join doesn't need to know
    */
   ProbeRight(const HashJoinTranslator &join_translator,
              ConsumerContext &context, RowBatch::Row &row,
-             const std::vector<codegen::Value> &right_key);
+             const std::vector<codegen::Value> &right_key,
+             llvm::Value *probe_matched);
 
   /**
    * The callback function called to process each matching tuple found in the
@@ -55,6 +59,11 @@ class HashJoinTranslator::ProbeRight : public HashTable::IterateCallback {
   void ProcessEntry(CodeGen &codegen, const std::vector<codegen::Value> &key,
                     llvm::Value *data_area) const override;
 
+ private:
+  // Handle a build-side tuple that satisfies the join predicate
+  void ProcessMatch(CodeGen &codegen, RowBatch::Row &row,
+                    llvm::Value *data_area) const;
+
  private:
   // The translator (we need lots of its state)
   const HashJoinTranslator &join_translator_;
@@ -65,6 +74,9 @@ class HashJoinTranslator::ProbeRight : public HashTable::IterateCallback {
 
   // The value of the key used during the probe
   const std::vector<codegen::Value> &right_key_;
+
+  // Whether the probe row found a join partner
+  llvm::Value *probe_matched_;
 };
 
 /**
@@ -78,10 +90,11 @@ class HashJoinTranslator::InsertLeft : public HashTable::InsertCallback {
    *
    * @param storage The storage format to serialize values into the table
    * @param values The actual values to store in the table
+   * @param match_flag Should a cleared match flag precede the values?
    */
   InsertLeft(const CompactStorage &storage,
-             const std::vector<codegen::Value> &values)
-      : storage_(storage), values_(values) {}
+             const std::vector<codegen::Value> &values, bool match_flag)
+      : storage_(storage), values_(values), match_flag_(match_flag) {}
 
   /**
    * Callback used to serialize a set of values into the table.
@@ -90,6 +103,11 @@ class HashJoinTranslator::InsertLeft : public HashTable::InsertCallback {
    * @param data_space Memory space where the value can be stored.
    */
   void StoreValue(CodeGen &codegen, llvm::Value *space) const override {
+    if (match_flag_) {
+      codegen->CreateStore(codegen.Const8(0), space);
+      space = codegen->CreateConstInBoundsGEP1_32(codegen.ByteType(), space,
+                                                  sizeof(int8_t));
+    }
     storage_.StoreValues(codegen, space, values_);
   }
 
@@ -100,7 +118,8 @@ class HashJoinTranslator::InsertLeft : public HashTable::InsertCallback {
    * @return The number of bytes needed to store the value
    */
   llvm::Value *GetValueSize(CodeGen &codegen) const override {
-    return codegen.Const32(storage_.MaxStorageSize());
+    uint32_t flag_size = match_flag_ ? sizeof(int8_t) : 0;
+    return codegen.Const32(storage_.MaxStorageSize() + flag_size);
   }
 
  private:
@@ -109,6 +128,50 @@ class HashJoinTranslator::InsertLeft : public HashTable::InsertCallback {
 
   // The attribute values from the left side
   const std::vector<codegen::Value> &values_;
+
+  // Whether the values are preceded by a match flag
+  bool match_flag_;
+};
+
+/**
+ * The callback used to scan the hash table once the probe phase is over. For
+ * outer and anti joins, it sends up the build-side tuples that never found a
+ * join partner. For semi joins, it sends up those that did.
+ */
+class HashJoinTranslator::ProduceLeft : public HashTable::IterateCallback {
+ public:
+  /**
+   * Constructor.
+   *
+   * @param join_translator The translator reference
+   * @param context The context of the pipeline we're producing into
+   * @param selection_vector The selection vector for single-row batches
+   */
+  ProduceLeft(const HashJoinTranslator &join_translator,
+              ConsumerContext &context, Vector &selection_vector)
+      : join_translator_(join_translator),
+        context_(context),
+        selection_vector_(selection_vector) {}
+
+  /**
+   * Check the match flag of the entry and send the tuple up if needed.
+   *
+   * @param codegen The codegen instance
+   * @param key The key stored in the table
+   * @param data_area Memory space where the value is stored
+   */
+  void ProcessEntry(CodeGen &codegen, const std::vector<codegen::Value> &key,
+                    llvm::Value *data_area) const override;
+
+ private:
+  // The translator (we need lots of its state)
+  const HashJoinTranslator &join_translator_;
+
+  // The context we send the tuples to
+  ConsumerContext &context_;
+
+  // The selection vector of the single-row batches we produce
+  Vector &selection_vector_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -212,9 +275,13 @@ HashJoinTranslator::HashJoinTranslator(const planner::HashJoinPlan &join,
   }
   needs_output_vector_ = false;
 
-  // Create the hash table
-  hash_table_ =
-      HashTable{codegen, left_key_type, left_value_storage_.MaxStorageSize()};
+  // Create the hash table. Joins that need to know which build-side tuples
+  // found a partner keep a match flag in front of the values of each entry.
+  uint32_t value_size = left_value_storage_.MaxStorageSize();
+  if (TracksBuildMatches()) {
+    value_size += sizeof(int8_t);
+  }
+  hash_table_ = HashTable{codegen, left_key_type, value_size};
 }
 
 // Initialize the hash-table instance
@@ -235,6 +302,13 @@ void HashJoinTranslator::Produce() const {
   // Let the right child produce tuples, which we use to probe the hash table
   GetCompilationContext().Produce(*GetJoinPlan().GetChild(1)->GetChild(0));
 
+  // Some joins still have to send up build-side tuples, depending on whether
+  // they found a join partner during the probe
+  if (TracksBuildMatches()) {
+    auto producer = [this](ConsumerContext &ctx) { ProduceBuildTuples(ctx); };
+    GetPipeline().RunSerial(producer);
+  }
+
   // That's it, we've produced all the tuples
 }
 
@@ -371,7 +445,7 @@ void HashJoinTranslator::ConsumeFromLeft(ConsumerContext &ctx,
   }
 
   // Insert tuples from the left side into the hash table
-  InsertLeft insert_left{left_value_storage_, vals};
+  InsertLeft insert_left{left_value_storage_, vals, TracksBuildMatches()};
   hash_table_.InsertLazy(codegen, ht_ptr, hash, key, insert_left);
 
   // Update bloom filter, if enabled
@@ -448,6 +522,13 @@ void HashJoinTranslator::ConsumeFromRight(ConsumerContext &context,
       // to eliminate the false positives.
       CodegenHashProbe(context, row, key);
     }
+    if (EmitsUnmatchedProbes()) {
+      is_valid_row.ElseBlock();
+      {
+        // The tuple definitely has no join partner
+        ConsumeUnmatchedProbe(context, row);
+      }
+    }
     is_valid_row.EndIf();
   } else {
     // Bloom filter is not enabled. Directly probe the hash table
@@ -458,12 +539,113 @@ void HashJoinTranslator::ConsumeFromRight(ConsumerContext &context,
 void HashJoinTranslator::CodegenHashProbe(
     ConsumerContext &context, RowBatch::Row &row,
     std::vector<codegen::Value> &key) const {
-  if (GetJoinPlan().GetJoinType() == JoinType::INNER) {
-    // For inner joins, find all join partners
-    ProbeRight probe_right{*this, context, row, key};
-    hash_table_.FindAll(GetCodeGen(), LoadStatePtr(hash_table_id_), key,
-                        probe_right);
+  CodeGen &codegen = GetCodeGen();
+  llvm::Value *ht_ptr = LoadStatePtr(hash_table_id_);
+
+  if (!EmitsUnmatchedProbes()) {
+    // Find all join partners. Depending on the join type, each partner is
+    // either sent up along with the row, marked as matched, or both.
+    ProbeRight probe_right{*this, context, row, key, nullptr};
+    hash_table_.FindAll(codegen, ht_ptr, key, probe_right);
+    return;
+  }
+
+  // Right and full outer joins also need to know whether the row found any
+  // join partner at all
+  llvm::Value *matched =
+      codegen.AllocateVariable(codegen.BoolType(), "probeMatched");
+  codegen->CreateStore(codegen.ConstBool(false), matched);
+
+  ProbeRight probe_right{*this, context, row, key, matched};
+  hash_table_.FindAll(codegen, ht_ptr, key, probe_right);
+
+  lang::If no_match{codegen, codegen->CreateNot(codegen->CreateLoad(matched))};
+  {
+    ConsumeUnmatchedProbe(context, row);
   }
+  no_match.EndIf();
+}
+
+void HashJoinTranslator::ConsumeUnmatchedProbe(ConsumerContext &context,
+                                               RowBatch::Row &row) const {
+  // Use a copy of the row, so the NULLs we register don't leak into the row
+  RowBatch::Row null_row = row;
+  RegisterNullAttributes(GetCodeGen(), null_row,
+                         GetJoinPlan().GetLeftAttributes());
+  context.Consume(null_row);
+}
+
+void HashJoinTranslator::ProduceBuildTuples(ConsumerContext &context) const {
+  CodeGen &codegen = GetCodeGen();
+
+  // Every tuple we find is sent up in its own single-row batch
+  auto *raw_vec =
+      codegen.AllocateBuffer(codegen.Int32Type(), 1, "hjBuildSelVector");
+  Vector selection_vector{raw_vec, 1, codegen.Int32Type()};
+  selection_vector.SetValue(codegen, codegen.Const32(0), codegen.Const32(0));
+
+  ProduceLeft produce_left{*this, context, selection_vector};
+  hash_table_.Iterate(codegen, LoadStatePtr(hash_table_id_), produce_left);
+}
+
+void HashJoinTranslator::RegisterBuildAttributes(
+    CodeGen &codegen, RowBatch::Row &row,
+    const std::vector<codegen::Value> &key, llvm::Value *data_area) const {
+  // Skip the match flag
+  if (TracksBuildMatches()) {
+    data_area = codegen->CreateConstInBoundsGEP1_32(codegen.ByteType(),
+                                                    data_area, sizeof(int8_t));
+  }
+
+  // LoadValues all the values from the hash entry
+  std::vector<codegen::Value> left_vals;
+  left_value_storage_.LoadValues(codegen, data_area, left_vals);
+
+  // Put the values directly into the row
+  for (uint32_t i = 0; i < left_val_ais_.size(); i++) {
+    row.RegisterAttributeValue(left_val_ais_[i], left_vals[i]);
+  }
+
+  for (uint32_t i = 0; i < left_key_exprs_.size(); i++) {
+    const auto *exp = left_key_exprs_[i];
+    if (exp->GetExpressionType() == ExpressionType::VALUE_TUPLE) {
+      auto *tve = static_cast<const expression::TupleValueExpression *>(exp);
+      codegen::Value v = key[i];
+      LOG_DEBUG("Putting AI %s (%p) into row",
+                tve->GetAttributeRef()->name.c_str(), tve->GetAttributeRef());
+      row.RegisterAttributeValue(tve->GetAttributeRef(), v);
+    }
+  }
+}
+
+void HashJoinTranslator::RegisterNullAttributes(
+    CodeGen &codegen, RowBatch::Row &row,
+    const std::vector<const planner::AttributeInfo *> &ais) const {
+  for (const auto *ai : ais) {
+    row.RegisterAttributeValue(ai, ai->type.GetSqlType().GetNullValue(codegen));
+  }
+}
+
+bool HashJoinTranslator::TracksBuildMatches() const {
+  switch (GetJoinPlan().GetJoinType()) {
+    case JoinType::LEFT:
+    case JoinType::OUTER:
+    case JoinType::SEMI:
+    case JoinType::ANTI:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool HashJoinTranslator::EmitsUnmatchedProbes() const {
+  auto join_type = GetJoinPlan().GetJoinType();
+  return join_type == JoinType::RIGHT || join_type == JoinType::OUTER;
+}
+
+bool HashJoinTranslator::EmitsJoinedRows() const {
+  auto join_type = GetJoinPlan().GetJoinType();
+  return join_type != JoinType::SEMI && join_type != JoinType::ANTI;
 }
 
 // Cleanup by destroying the hash-table instance
@@ -524,59 +706,109 @@ const planner::HashJoinPlan &HashJoinTranslator::GetJoinPlan() const {
 
 HashJoinTranslator::ProbeRight::ProbeRight(
     const HashJoinTranslator &join_translator, ConsumerContext &context,
-    RowBatch::Row &row, const std::vector<codegen::Value> &right_key)
+    RowBatch::Row &row, const std::vector<codegen::Value> &right_key,
+    llvm::Value *probe_matched)
     : join_translator_(join_translator),
       context_(context),
       row_(row),
-      right_key_(right_key) {}
+      right_key_(right_key),
+      probe_matched_(probe_matched) {}
 
 void HashJoinTranslator::ProbeRight::ProcessEntry(
     CodeGen &codegen, const std::vector<codegen::Value> &key,
     llvm::Value *data_area) const {
-  const auto &storage = join_translator_.left_value_storage_;
-
   if (join_translator_.needs_output_vector_) {
     // Use output vector for attribute access
     throw Exception{"Shouldn't need output"};
-  } else {
-    // LoadValues all the values from the hash entry
-    std::vector<codegen::Value> left_vals;
-    storage.LoadValues(codegen, data_area, left_vals);
-
-    // Put the values directly into the row
-    const auto &left_val_ais = join_translator_.left_val_ais_;
-    for (uint32_t i = 0; i < left_val_ais.size(); i++) {
-      row_.RegisterAttributeValue(left_val_ais[i], left_vals[i]);
-    }
+  }
 
-    const auto &left_key_exprs = join_translator_.left_key_exprs_;
-    for (uint32_t i = 0; i < left_key_exprs.size(); i++) {
-      const auto *exp = left_key_exprs[i];
-      if (exp->GetExpressionType() == ExpressionType::VALUE_TUPLE) {
-        auto *tve = static_cast<const expression::TupleValueExpression *>(exp);
-        codegen::Value v = key[i];
-        LOG_DEBUG("Putting AI %s (%p) into row",
-                  tve->GetAttributeRef()->name.c_str(), tve->GetAttributeRef());
-        row_.RegisterAttributeValue(tve->GetAttributeRef(), v);
-      }
+  // The build-side attributes are only valid for this entry. Register them in
+  // a copy of the row so they don't leak into code that runs after the probe.
+  RowBatch::Row row = row_;
+
+  if (!join_translator_.EmitsJoinedRows()) {
+    // Semi and anti joins only care whether a build-side tuple has any join
+    // partner, so we skip the entries that have already been matched
+    llvm::Value *flag = codegen->CreateLoad(data_area);
+    lang::If not_matched{codegen,
+                         codegen->CreateICmpEQ(flag, codegen.Const8(0))};
+    {
+      join_translator_.RegisterBuildAttributes(codegen, row, key, data_area);
+      ProcessMatch(codegen, row, data_area);
     }
+    not_matched.EndIf();
+  } else {
+    join_translator_.RegisterBuildAttributes(codegen, row, key, data_area);
+    ProcessMatch(codegen, row, data_area);
   }
+}
+
+void HashJoinTranslator::ProbeRight::ProcessMatch(
+    CodeGen &codegen, RowBatch::Row &row, llvm::Value *data_area) const {
+  auto on_match = [this, &codegen, &row, data_area]() {
+    // Concurrent probes may race setting the flag, but they all store the
+    // same value
+    if (join_translator_.TracksBuildMatches()) {
+      codegen->CreateStore(codegen.Const8(1), data_area);
+    }
+    if (probe_matched_ != nullptr) {
+      codegen->CreateStore(codegen.ConstBool(true), probe_matched_);
+    }
+    if (join_translator_.EmitsJoinedRows()) {
+      // Send row up to the parent
+      context_.Consume(row);
+    }
+  };
 
   // Check predicate if one exists
   auto *predicate = join_translator_.GetJoinPlan().GetPredicate();
   if (predicate != nullptr) {
     // Vectorize of TaaT filter?
-    auto valid_row = row_.DeriveValue(codegen, *predicate);
+    auto valid_row = row.DeriveValue(codegen, *predicate);
     lang::If is_valid_row{codegen, valid_row};
     {
-      // Send row up to the parent
-      context_.Consume(row_);
+      on_match();
     }
     is_valid_row.EndIf();
   } else {
-    // Send the row up to the parent
-    context_.Consume(row_);
+    on_match();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// ProduceLeft
+///
+////////////////////////////////////////////////////////////////////////////////
+
+void HashJoinTranslator::ProduceLeft::ProcessEntry(
+    CodeGen &codegen, const std::vector<codegen::Value> &key,
+    llvm::Value *data_area) const {
+  // Semi joins send up the matched tuples, outer and anti joins the others
+  auto join_type = join_translator_.GetJoinPlan().GetJoinType();
+  llvm::Value *flag = codegen->CreateLoad(data_area);
+  llvm::Value *send_up =
+      join_type == JoinType::SEMI
+          ? codegen->CreateICmpNE(flag, codegen.Const8(0))
+          : codegen->CreateICmpEQ(flag, codegen.Const8(0));
+
+  lang::If should_send{codegen, send_up};
+  {
+    // Create a batch of one row and place the build-side attributes into it
+    RowBatch batch{context_.GetCompilationContext(), codegen.Const32(0),
+                   codegen.Const32(1), selection_vector_, false};
+    RowBatch::Row row = batch.GetRowAt(codegen.Const32(0));
+    join_translator_.RegisterBuildAttributes(codegen, row, key, data_area);
+
+    // The probe-side attributes of unmatched outer join tuples are NULL
+    if (join_translator_.EmitsJoinedRows()) {
+      join_translator_.RegisterNullAttributes(
+          codegen, row, join_translator_.GetJoinPlan().GetRightAttributes());
+    }
+
+    context_.Consume(row);
   }
+  should_send.EndIf();
 }
 
 }  // namespace codegen
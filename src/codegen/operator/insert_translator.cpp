@@ -103,6 +103,10 @@ void InsertTranslator::Produce() const {
     /// Execute insertion in separate pipeline serially
     GetPipeline().RunSerial(producer);
   }
+
+  /// Complete the inserts the inserter still holds back for its last batch
+  auto *inserter = LoadStatePtr(inserter_state_id_);
+  GetCodeGen().Call(InserterProxy::Flush, {inserter});
 }
 
 void InsertTranslator::Consume(ConsumerContext &, RowBatch::Row &row) const {
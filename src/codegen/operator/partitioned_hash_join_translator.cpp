@@ -0,0 +1,520 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// partitioned_hash_join_translator.cpp
+//
+// Identification: src/codegen/operator/partitioned_hash_join_translator.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "codegen/operator/partitioned_hash_join_translator.h"
+
+#include "codegen/lang/if.h"
+#include "codegen/lang/loop.h"
+#include "codegen/proxy/hash_table_proxy.h"
+#include "codegen/proxy/radix_partitioner_proxy.h"
+#include "codegen/proxy/runtime_functions_proxy.h"
+#include "codegen/util/radix_partitioner.h"
+#include "codegen/vector.h"
+#include "expression/tuple_value_expression.h"
+#include "planner/hash_join_plan.h"
+
+namespace peloton {
+namespace codegen {
+
+/**
+ * The callback invoked for every probe-side tuple of the partition that is
+ * being joined. It probes the partition's hash table with the tuple's key.
+ */
+class PartitionedHashJoinTranslator::ProbePartition
+    : public HashTable::IterateCallback {
+ public:
+  /**
+   * Constructor.
+   *
+   * @param join_translator The translator reference
+   * @param context The context of the pipeline we're producing into
+   * @param ht_ptr The hash table built over the build side of the partition
+   * @param selection_vector The selection vector for single-row batches
+   */
+  ProbePartition(const PartitionedHashJoinTranslator &join_translator,
+                 ConsumerContext &context, llvm::Value *ht_ptr,
+                 Vector &selection_vector)
+      : join_translator_(join_translator),
+        context_(context),
+        ht_ptr_(ht_ptr),
+        selection_vector_(selection_vector) {}
+
+  /**
+   * Load the probe-side tuple and find all its join partners.
+   *
+   * @param codegen The codegen instance
+   * @param key The key stored in the partition
+   * @param data_area Memory space where the probe-side values are stored
+   */
+  void ProcessEntry(CodeGen &codegen, const std::vector<codegen::Value> &key,
+                    llvm::Value *data_area) const override;
+
+ private:
+  // The translator (we need lots of its state)
+  const PartitionedHashJoinTranslator &join_translator_;
+
+  // The context we send the joined tuples to
+  ConsumerContext &context_;
+
+  // The hash table of the partition
+  llvm::Value *ht_ptr_;
+
+  // The selection vector of the single-row batches we produce
+  Vector &selection_vector_;
+};
+
+/**
+ * The callback invoked for every build-side tuple that has the same key as the
+ * probe-side tuple being processed.
+ */
+class PartitionedHashJoinTranslator::ProbeMatch
+    : public HashTable::IterateCallback {
+ public:
+  /**
+   * Constructor.
+   *
+   * @param join_translator The translator reference
+   * @param context The context of the pipeline we're producing into
+   * @param row The row holding the probe-side attributes
+   */
+  ProbeMatch(const PartitionedHashJoinTranslator &join_translator,
+             ConsumerContext &context, RowBatch::Row &row)
+      : join_translator_(join_translator), context_(context), row_(row) {}
+
+  /**
+   * Check the join predicate and send the joined row up to the parent.
+   *
+   * @param codegen The codegen instance
+   * @param key The key used during the probe
+   * @param data_area Memory space where the build-side values are stored
+   */
+  void ProcessEntry(CodeGen &codegen, const std::vector<codegen::Value> &key,
+                    llvm::Value *data_area) const override;
+
+ private:
+  // The translator (we need lots of its state)
+  const PartitionedHashJoinTranslator &join_translator_;
+
+  // The context and the row holding the probe-side attributes
+  ConsumerContext &context_;
+  RowBatch::Row &row_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Partitioned Hash Join Translator
+///
+////////////////////////////////////////////////////////////////////////////////
+
+PartitionedHashJoinTranslator::PartitionedHashJoinTranslator(
+    const planner::HashJoinPlan &join, CompilationContext &context,
+    Pipeline &pipeline)
+    : OperatorTranslator(join, context, pipeline),
+      left_pipeline_(this, Pipeline::Parallelism::Flexible),
+      right_pipeline_(this, Pipeline::Parallelism::Flexible) {
+  PELOTON_ASSERT(join.GetJoinType() == JoinType::INNER);
+
+  CodeGen &codegen = GetCodeGen();
+  QueryState &query_state = context.GetQueryState();
+
+  // We produce the joined tuples partition by partition. Since partitions are
+  // independent, the parent pipeline may join them in parallel.
+  pipeline.MarkSource(this, Pipeline::Parallelism::Parallel);
+
+  // Allocate state for the partitioners and the hash table
+  left_partitioner_id_ = query_state.RegisterState(
+      "leftPartitioner", RadixPartitionerProxy::GetType(codegen));
+  right_partitioner_id_ = query_state.RegisterState(
+      "rightPartitioner", RadixPartitionerProxy::GetType(codegen));
+  hash_table_id_ = query_state.RegisterState("partitionHT",
+                                             HashTableProxy::GetType(codegen));
+
+  // Prepare translators for the left and right input operators
+  context.Prepare(*join.GetChild(0), left_pipeline_);
+  context.Prepare(*join.GetChild(1)->GetChild(0), right_pipeline_);
+
+  // Prepare the key expressions of both sides
+  join.GetLeftHashKeys(left_key_exprs_);
+  join.GetRightHashKeys(right_key_exprs_);
+  PELOTON_ASSERT(left_key_exprs_.size() == right_key_exprs_.size());
+
+  std::vector<type::Type> key_type;
+  for (const auto *left_key : left_key_exprs_) {
+    context.Prepare(*left_key);
+    key_type.push_back(left_key->ResultType());
+  }
+  for (const auto *right_key : right_key_exprs_) {
+    context.Prepare(*right_key);
+  }
+
+  // Prepare the predicate
+  auto *predicate = join.GetPredicate();
+  if (predicate != nullptr) {
+    context.Prepare(*predicate);
+  }
+
+  // Collect the (unique) non-key attributes materialized from each side
+  auto collect_values = [](
+      const std::vector<const expression::AbstractExpression *> &key_exprs,
+      const std::vector<const planner::AttributeInfo *> &ais,
+      std::vector<const planner::AttributeInfo *> &val_ais) {
+    std::unordered_set<const planner::AttributeInfo *> key_ais;
+    for (const auto *key_exp : key_exprs) {
+      if (key_exp->GetExpressionType() == ExpressionType::VALUE_TUPLE) {
+        auto *tve =
+            static_cast<const expression::TupleValueExpression *>(key_exp);
+        key_ais.insert(tve->GetAttributeRef());
+      }
+    }
+    for (const auto *ai : ais) {
+      if (key_ais.count(ai) == 0) {
+        val_ais.push_back(ai);
+      }
+    }
+  };
+  collect_values(left_key_exprs_, join.GetLeftAttributes(), left_val_ais_);
+  collect_values(right_key_exprs_, join.GetRightAttributes(), right_val_ais_);
+
+  // Construct the formats of the values of both sides
+  std::vector<type::Type> left_value_types, right_value_types;
+  for (const auto *ai : left_val_ais_) {
+    left_value_types.push_back(ai->type);
+  }
+  for (const auto *ai : right_val_ais_) {
+    right_value_types.push_back(ai->type);
+  }
+  left_value_storage_.Setup(codegen, left_value_types);
+  right_value_storage_.Setup(codegen, right_value_types);
+
+  // Choose the number of partitions so that the hash table of a single
+  // build-side partition fits into the cache
+  CompactStorage key_storage;
+  key_storage.Setup(codegen, key_type);
+  uint32_t build_tuple_size =
+      key_storage.MaxStorageSize() + left_value_storage_.MaxStorageSize();
+  int64_t build_cardinality = join.GetChild(0)->GetCardinality();
+  uint32_t num_radix_bits = util::RadixPartitioner::ChooseRadixBits(
+      static_cast<uint64_t>(std::max<int64_t>(build_cardinality, 0)),
+      build_tuple_size);
+  LOG_DEBUG("Partitioning hash join inputs with %u radix bits",
+            num_radix_bits);
+
+  // Both sides must be partitioned the same way
+  left_partitioner_ =
+      RadixPartitioner{codegen, key_type, left_value_storage_.MaxStorageSize(),
+                       num_radix_bits};
+  right_partitioner_ =
+      RadixPartitioner{codegen, key_type, right_value_storage_.MaxStorageSize(),
+                       num_radix_bits};
+  hash_table_ =
+      HashTable{codegen, key_type, left_value_storage_.MaxStorageSize()};
+}
+
+void PartitionedHashJoinTranslator::InitializeQueryState() {
+  CodeGen &codegen = GetCodeGen();
+  llvm::Value *exec_ctx = GetExecutorContextPtr();
+  left_partitioner_.Init(codegen, LoadStatePtr(left_partitioner_id_),
+                         exec_ctx);
+  right_partitioner_.Init(codegen, LoadStatePtr(right_partitioner_id_),
+                          exec_ctx);
+  hash_table_.Init(codegen, exec_ctx, LoadStatePtr(hash_table_id_));
+}
+
+void PartitionedHashJoinTranslator::Produce() const {
+  // Let both children produce their tuples, which we partition
+  GetCompilationContext().Produce(*GetJoinPlan().GetChild(0));
+  GetCompilationContext().Produce(*GetJoinPlan().GetChild(1)->GetChild(0));
+
+  // Now join the partitions
+  CodeGen &codegen = GetCodeGen();
+  auto &pipeline = GetPipeline();
+  uint32_t num_partitions = left_partitioner_.NumPartitions();
+  if (pipeline.IsParallel()) {
+    // We use RuntimeFunctions::ExecutePerPartition() to distribute ranges of
+    // partitions among the workers
+    auto *dispatcher =
+        RuntimeFunctionsProxy::ExecutePerPartition.GetFunction(codegen);
+    std::vector<llvm::Value *> dispatch_args = {
+        codegen.Const32(num_partitions)};
+    std::vector<llvm::Type *> pipeline_arg_types = {codegen.Int32Type(),
+                                                    codegen.Int32Type()};
+    auto producer = [this](ConsumerContext &ctx,
+                           const std::vector<llvm::Value *> params) {
+      PELOTON_ASSERT(params.size() == 2);
+      JoinPartitions(ctx, params[0], params[1]);
+    };
+    pipeline.RunParallel(dispatcher, dispatch_args, pipeline_arg_types,
+                         producer);
+  } else {
+    auto producer = [this, &codegen, num_partitions](ConsumerContext &ctx) {
+      JoinPartitions(ctx, codegen.Const32(0), codegen.Const32(num_partitions));
+    };
+    pipeline.RunSerial(producer);
+  }
+}
+
+void PartitionedHashJoinTranslator::JoinPartitions(ConsumerContext &context,
+                                                   llvm::Value *start,
+                                                   llvm::Value *end) const {
+  CodeGen &codegen = GetCodeGen();
+
+  // Parallel joins use a thread-local hash table
+  llvm::Value *ht_ptr = nullptr;
+  if (context.GetPipeline().IsParallel()) {
+    ht_ptr = context.GetPipelineContext()->LoadStatePtr(codegen,
+                                                        hash_table_tl_id_);
+  } else {
+    ht_ptr = LoadStatePtr(hash_table_id_);
+  }
+  llvm::Value *left_ptr = LoadStatePtr(left_partitioner_id_);
+  llvm::Value *right_ptr = LoadStatePtr(right_partitioner_id_);
+
+  // Every joined tuple is sent up in its own single-row batch
+  auto *raw_vec =
+      codegen.AllocateBuffer(codegen.Int32Type(), 1, "phjSelVector");
+  Vector selection_vector{raw_vec, 1, codegen.Int32Type()};
+  selection_vector.SetValue(codegen, codegen.Const32(0), codegen.Const32(0));
+
+  lang::Loop partition_loop{
+      codegen, codegen->CreateICmpULT(start, end), {{"partition", start}}};
+  {
+    llvm::Value *partition = partition_loop.GetLoopVar(0);
+
+    // Build a hash table over the build side of the partition, then probe it
+    // with every tuple from the probe side of the partition
+    left_partitioner_.BuildPartitionTable(codegen, left_ptr, partition,
+                                          ht_ptr);
+    ProbePartition probe_partition{*this, context, ht_ptr, selection_vector};
+    right_partitioner_.IteratePartition(codegen, right_ptr, partition,
+                                        probe_partition);
+
+    // Both sides of the partition are done, free them (and whatever we read
+    // back from disk) before moving on
+    left_partitioner_.ReleasePartition(codegen, left_ptr, partition);
+    right_partitioner_.ReleasePartition(codegen, right_ptr, partition);
+
+    partition = codegen->CreateAdd(partition, codegen.Const32(1));
+    partition_loop.LoopEnd(codegen->CreateICmpULT(partition, end),
+                           {partition});
+  }
+}
+
+void PartitionedHashJoinTranslator::Consume(ConsumerContext &context,
+                                            RowBatch::Row &row) const {
+  CodeGen &codegen = GetCodeGen();
+  const auto &pipeline = context.GetPipeline();
+
+  bool from_left = IsLeftPipeline(pipeline);
+  const auto &key_exprs = from_left ? left_key_exprs_ : right_key_exprs_;
+  const auto &val_ais = from_left ? left_val_ais_ : right_val_ais_;
+  const auto &val_storage =
+      from_left ? left_value_storage_ : right_value_storage_;
+  const auto &partitioner = from_left ? left_partitioner_ : right_partitioner_;
+
+  // Collect the key and the values of the row
+  std::vector<codegen::Value> key;
+  for (const auto *exp : key_exprs) {
+    key.push_back(row.DeriveValue(codegen, *exp));
+  }
+  std::vector<codegen::Value> vals;
+  for (const auto *ai : val_ais) {
+    vals.push_back(row.DeriveValue(codegen, ai));
+  }
+
+  // Parallel pipelines partition into thread-local partitioners
+  llvm::Value *partitioner_ptr = nullptr;
+  if (pipeline.IsParallel()) {
+    auto tl_id = from_left ? left_partitioner_tl_id_ : right_partitioner_tl_id_;
+    partitioner_ptr =
+        context.GetPipelineContext()->LoadStatePtr(codegen, tl_id);
+  } else {
+    partitioner_ptr = LoadStatePtr(from_left ? left_partitioner_id_
+                                             : right_partitioner_id_);
+  }
+
+  llvm::Value *data_area = partitioner.Insert(codegen, partitioner_ptr, key);
+  val_storage.StoreValues(codegen, data_area, vals);
+}
+
+void PartitionedHashJoinTranslator::RegisterPipelineState(
+    PipelineContext &pipeline_ctx) {
+  if (!pipeline_ctx.IsParallel()) {
+    return;
+  }
+  CodeGen &codegen = GetCodeGen();
+  const auto &pipeline = pipeline_ctx.GetPipeline();
+  if (IsLeftPipeline(pipeline)) {
+    left_partitioner_tl_id_ = pipeline_ctx.RegisterState(
+        "leftPartitioner", RadixPartitionerProxy::GetType(codegen));
+  } else if (IsRightPipeline(pipeline)) {
+    right_partitioner_tl_id_ = pipeline_ctx.RegisterState(
+        "rightPartitioner", RadixPartitionerProxy::GetType(codegen));
+  } else {
+    hash_table_tl_id_ = pipeline_ctx.RegisterState(
+        "partitionHT", HashTableProxy::GetType(codegen));
+  }
+}
+
+void PartitionedHashJoinTranslator::InitializePipelineState(
+    PipelineContext &pipeline_ctx) {
+  if (!pipeline_ctx.IsParallel()) {
+    return;
+  }
+  CodeGen &codegen = GetCodeGen();
+  llvm::Value *exec_ctx = GetExecutorContextPtr();
+  const auto &pipeline = pipeline_ctx.GetPipeline();
+  if (IsLeftPipeline(pipeline)) {
+    left_partitioner_.Init(
+        codegen, pipeline_ctx.LoadStatePtr(codegen, left_partitioner_tl_id_),
+        exec_ctx);
+  } else if (IsRightPipeline(pipeline)) {
+    right_partitioner_.Init(
+        codegen, pipeline_ctx.LoadStatePtr(codegen, right_partitioner_tl_id_),
+        exec_ctx);
+  } else {
+    hash_table_.Init(codegen, exec_ctx,
+                     pipeline_ctx.LoadStatePtr(codegen, hash_table_tl_id_));
+  }
+}
+
+void PartitionedHashJoinTranslator::FinishPipeline(
+    PipelineContext &pipeline_ctx) {
+  const auto &pipeline = pipeline_ctx.GetPipeline();
+  if (!IsLeftPipeline(pipeline) && !IsRightPipeline(pipeline)) {
+    return;
+  }
+
+  CodeGen &codegen = GetCodeGen();
+  bool left = IsLeftPipeline(pipeline);
+  const auto &partitioner = left ? left_partitioner_ : right_partitioner_;
+  llvm::Value *partitioner_ptr =
+      LoadStatePtr(left ? left_partitioner_id_ : right_partitioner_id_);
+  if (pipeline_ctx.IsParallel()) {
+    // Collect the partitions of all thread-local partitioners
+    auto tl_id = left ? left_partitioner_tl_id_ : right_partitioner_tl_id_;
+    partitioner.TransferPartitions(codegen, partitioner_ptr,
+                                   GetThreadStatesPtr(),
+                                   pipeline_ctx.GetEntryOffset(codegen, tl_id));
+  } else {
+    partitioner.FlushBuffers(codegen, partitioner_ptr);
+  }
+}
+
+void PartitionedHashJoinTranslator::TearDownPipelineState(
+    PipelineContext &pipeline_ctx) {
+  if (!pipeline_ctx.IsParallel()) {
+    return;
+  }
+  CodeGen &codegen = GetCodeGen();
+  const auto &pipeline = pipeline_ctx.GetPipeline();
+  if (IsLeftPipeline(pipeline)) {
+    left_partitioner_.Destroy(
+        codegen, pipeline_ctx.LoadStatePtr(codegen, left_partitioner_tl_id_));
+  } else if (IsRightPipeline(pipeline)) {
+    right_partitioner_.Destroy(
+        codegen, pipeline_ctx.LoadStatePtr(codegen, right_partitioner_tl_id_));
+  } else {
+    hash_table_.Destroy(codegen,
+                        pipeline_ctx.LoadStatePtr(codegen, hash_table_tl_id_));
+  }
+}
+
+void PartitionedHashJoinTranslator::TearDownQueryState() {
+  CodeGen &codegen = GetCodeGen();
+  left_partitioner_.Destroy(codegen, LoadStatePtr(left_partitioner_id_));
+  right_partitioner_.Destroy(codegen, LoadStatePtr(right_partitioner_id_));
+  hash_table_.Destroy(codegen, LoadStatePtr(hash_table_id_));
+}
+
+void PartitionedHashJoinTranslator::RegisterAttributes(
+    CodeGen &codegen, RowBatch::Row &row,
+    const std::vector<const expression::AbstractExpression *> &key_exprs,
+    const std::vector<codegen::Value> &key,
+    const std::vector<const planner::AttributeInfo *> &val_ais,
+    const CompactStorage &val_storage, llvm::Value *data_area) const {
+  std::vector<codegen::Value> vals;
+  val_storage.LoadValues(codegen, data_area, vals);
+  for (uint32_t i = 0; i < val_ais.size(); i++) {
+    row.RegisterAttributeValue(val_ais[i], vals[i]);
+  }
+
+  // Key columns aren't stored twice, their values come from the key
+  for (uint32_t i = 0; i < key_exprs.size(); i++) {
+    const auto *exp = key_exprs[i];
+    if (exp->GetExpressionType() == ExpressionType::VALUE_TUPLE) {
+      auto *tve = static_cast<const expression::TupleValueExpression *>(exp);
+      row.RegisterAttributeValue(tve->GetAttributeRef(), key[i]);
+    }
+  }
+}
+
+const planner::HashJoinPlan &PartitionedHashJoinTranslator::GetJoinPlan()
+    const {
+  return GetPlanAs<planner::HashJoinPlan>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// ProbePartition
+///
+////////////////////////////////////////////////////////////////////////////////
+
+void PartitionedHashJoinTranslator::ProbePartition::ProcessEntry(
+    CodeGen &codegen, const std::vector<codegen::Value> &key,
+    llvm::Value *data_area) const {
+  // Create a batch of one row and place the probe-side attributes into it
+  RowBatch batch{context_.GetCompilationContext(), codegen.Const32(0),
+                 codegen.Const32(1), selection_vector_, false};
+  RowBatch::Row row = batch.GetRowAt(codegen.Const32(0));
+  join_translator_.RegisterAttributes(
+      codegen, row, join_translator_.right_key_exprs_, key,
+      join_translator_.right_val_ais_, join_translator_.right_value_storage_,
+      data_area);
+
+  // Find all join partners
+  ProbeMatch probe_match{join_translator_, context_, row};
+  join_translator_.hash_table_.FindAll(codegen, ht_ptr_, key, probe_match);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// ProbeMatch
+///
+////////////////////////////////////////////////////////////////////////////////
+
+void PartitionedHashJoinTranslator::ProbeMatch::ProcessEntry(
+    CodeGen &codegen, const std::vector<codegen::Value> &key,
+    llvm::Value *data_area) const {
+  // The build-side attributes are only valid for this entry. Register them in
+  // a copy of the row so they don't leak into the next match.
+  RowBatch::Row row = row_;
+  join_translator_.RegisterAttributes(
+      codegen, row, join_translator_.left_key_exprs_, key,
+      join_translator_.left_val_ais_, join_translator_.left_value_storage_,
+      data_area);
+
+  // Check predicate if one exists
+  auto *predicate = join_translator_.GetJoinPlan().GetPredicate();
+  if (predicate != nullptr) {
+    auto valid_row = row.DeriveValue(codegen, *predicate);
+    lang::If is_valid_row{codegen, valid_row};
+    {
+      context_.Consume(row);
+    }
+    is_valid_row.EndIf();
+  } else {
+    context_.Consume(row);
+  }
+}
+
+}  // namespace codegen
+}  // namespace peloton
@@ -12,7 +12,9 @@
 
 #include "codegen/operator/table_scan_translator.h"
 
+#include "common/exception.h"
 #include "codegen/lang/if.h"
+#include "codegen/lang/loop.h"
 #include "codegen/proxy/executor_context_proxy.h"
 #include "codegen/proxy/runtime_functions_proxy.h"
 #include "codegen/proxy/storage_manager_proxy.h"
@@ -20,12 +22,120 @@
 #include "codegen/proxy/zone_map_proxy.h"
 #include "codegen/type/boolean_type.h"
 #include "codegen/vector.h"
+#include "expression/tuple_value_expression.h"
 #include "planner/seq_scan_plan.h"
 #include "storage/data_table.h"
 
 namespace peloton {
 namespace codegen {
 
+namespace {
+
+// The number of rows whose predicate results are computed in one SIMD step.
+// Eight results make up one byte of the bitmap of qualifying rows.
+constexpr uint32_t kSIMDWidth = 8;
+
+// Determine the type a column and a constant of the given types are compared
+// as. Neither side is ever narrowed. Returns INVALID if the pair of types can't
+// be compared with SIMD instructions.
+peloton::type::TypeId SIMDCompareType(peloton::type::TypeId col_type,
+                                      peloton::type::TypeId const_type) {
+  using TypeId = peloton::type::TypeId;
+  auto is_numeric = [](TypeId type_id) {
+    return type_id >= TypeId::TINYINT && type_id <= TypeId::DECIMAL;
+  };
+  if (is_numeric(col_type) && is_numeric(const_type)) {
+    // Integers widen to larger integers and to decimals
+    return std::max(col_type, const_type);
+  }
+  if (col_type == const_type &&
+      (col_type == TypeId::DATE || col_type == TypeId::TIMESTAMP)) {
+    return col_type;
+  }
+  return TypeId::INVALID;
+}
+
+// Swap the operands of the given comparison
+ExpressionType FlipComparison(ExpressionType cmp_type) {
+  switch (cmp_type) {
+    case ExpressionType::COMPARE_LESSTHAN:
+      return ExpressionType::COMPARE_GREATERTHAN;
+    case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+      return ExpressionType::COMPARE_GREATERTHANOREQUALTO;
+    case ExpressionType::COMPARE_GREATERTHAN:
+      return ExpressionType::COMPARE_LESSTHAN;
+    case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+      return ExpressionType::COMPARE_LESSTHANOREQUALTO;
+    default:
+      return cmp_type;
+  }
+}
+
+// Compare the raw values of a column, either a scalar or a vector of the given
+// size, with a constant. Rows where either side is NULL never qualify.
+llvm::Value *CompareColumn(CodeGen &codegen, ExpressionType cmp_type,
+                           llvm::Value *col_val, llvm::Value *col_is_null,
+                           const codegen::Value &constant,
+                           uint32_t vector_size) {
+  llvm::Value *rhs = constant.GetValue();
+  if (vector_size > 1) {
+    rhs = codegen->CreateVectorSplat(vector_size, rhs);
+  }
+
+  // Widen the column's values to the type they're compared as
+  llvm::Value *lhs = col_val;
+  bool is_fp = rhs->getType()->getScalarType()->isFloatingPointTy();
+  if (lhs->getType() != rhs->getType()) {
+    lhs = is_fp ? codegen->CreateSIToFP(lhs, rhs->getType())
+                : codegen->CreateSExt(lhs, rhs->getType());
+  }
+
+  llvm::Value *match = nullptr;
+  switch (cmp_type) {
+    case ExpressionType::COMPARE_EQUAL:
+      match = is_fp ? codegen->CreateFCmpUEQ(lhs, rhs)
+                    : codegen->CreateICmpEQ(lhs, rhs);
+      break;
+    case ExpressionType::COMPARE_NOTEQUAL:
+      match = is_fp ? codegen->CreateFCmpUNE(lhs, rhs)
+                    : codegen->CreateICmpNE(lhs, rhs);
+      break;
+    case ExpressionType::COMPARE_LESSTHAN:
+      match = is_fp ? codegen->CreateFCmpULT(lhs, rhs)
+                    : codegen->CreateICmpSLT(lhs, rhs);
+      break;
+    case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+      match = is_fp ? codegen->CreateFCmpULE(lhs, rhs)
+                    : codegen->CreateICmpSLE(lhs, rhs);
+      break;
+    case ExpressionType::COMPARE_GREATERTHAN:
+      match = is_fp ? codegen->CreateFCmpUGT(lhs, rhs)
+                    : codegen->CreateICmpSGT(lhs, rhs);
+      break;
+    case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+      match = is_fp ? codegen->CreateFCmpUGE(lhs, rhs)
+                    : codegen->CreateICmpSGE(lhs, rhs);
+      break;
+    default:
+      throw Exception{"Unsupported SIMD comparison: " +
+                      ExpressionTypeToString(cmp_type)};
+  }
+
+  if (col_is_null != nullptr) {
+    match = codegen->CreateAnd(match, codegen->CreateNot(col_is_null));
+  }
+  if (constant.IsNullable()) {
+    llvm::Value *not_null = constant.IsNotNull(codegen);
+    if (vector_size > 1) {
+      not_null = codegen->CreateVectorSplat(vector_size, not_null);
+    }
+    match = codegen->CreateAnd(match, not_null);
+  }
+  return match;
+}
+
+}  // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 /// AttributeAccess
@@ -74,18 +184,29 @@ class TableScanTranslator::ScanConsumer : public codegen::ScanCallback {
  public:
   // Constructor
   ScanConsumer(ConsumerContext &ctx, const planner::SeqScanPlan &plan,
+               const std::vector<SIMDPredicate> &simd_predicates,
+               const std::vector<const expression::AbstractExpression *>
+                   &residual_predicates,
+               const std::vector<DictionaryPredicate> &dictionary_predicates,
                Vector &selection_vector)
       : ctx_(ctx),
         plan_(plan),
+        simd_predicates_(simd_predicates),
+        residual_predicates_(residual_predicates),
+        dictionary_predicates_(dictionary_predicates),
         selection_vector_(selection_vector),
         tile_group_id_(nullptr),
-        tile_group_ptr_(nullptr) {}
+        tile_group_ptr_(nullptr),
+        all_encoded_(nullptr) {}
 
   // The callback when starting iteration over a new tile group
-  void TileGroupStart(CodeGen &, llvm::Value *tile_group_id,
+  void TileGroupStart(CodeGen &codegen, llvm::Value *tile_group_id,
                       llvm::Value *tile_group_ptr) override {
     tile_group_id_ = tile_group_id;
     tile_group_ptr_ = tile_group_ptr;
+    if (!dictionary_predicates_.empty()) {
+      LoadDictionaryRanges(codegen);
+    }
   }
 
   // The code that forms the body of the scan loop
@@ -107,6 +228,25 @@ class TableScanTranslator::ScanConsumer : public codegen::ScanCallback {
 
   void PerformReads(CodeGen &codegen, Vector &selection_vector) const;
 
+  // Find the range of dictionary entries that satisfy each dictionary
+  // predicate in the current tile group, if its column is encoded there
+  void LoadDictionaryRanges(CodeGen &codegen);
+
+  // Evaluate the dictionary predicates on the given row. If all of their
+  // columns are dictionary-encoded in this tile group, only the pointers to
+  // the values are compared.
+  llvm::Value *EvaluateDictionaryPredicates(
+      CodeGen &codegen, const TileGroup::TileGroupAccess &access,
+      RowBatch::Row &row) const;
+
+  // Evaluate the SIMD predicates over the column vectors of the rows in the
+  // range [tid_start, tid_end) and remove the rows that don't qualify from the
+  // selection vector
+  void FilterRowsBySIMDPredicates(CodeGen &codegen,
+                                  const TileGroup::TileGroupAccess &access,
+                                  llvm::Value *tid_start, llvm::Value *tid_end,
+                                  Vector &selection_vector) const;
+
   // Filter all the rows whose TIDs are in the range [tid_start, tid_end] and
   // store their TIDs in the output TID selection vector
   void FilterRowsByPredicate(CodeGen &codegen,
@@ -119,12 +259,23 @@ class TableScanTranslator::ScanConsumer : public codegen::ScanCallback {
   ConsumerContext &ctx_;
   // The plan node
   const planner::SeqScanPlan &plan_;
+  // The conjuncts of the predicate evaluated on column vectors
+  const std::vector<SIMDPredicate> &simd_predicates_;
+  // The conjuncts of the predicate evaluated row by row
+  const std::vector<const expression::AbstractExpression *>
+      &residual_predicates_;
+  // The conjuncts of the predicate on varlen columns
+  const std::vector<DictionaryPredicate> &dictionary_predicates_;
   // The selection vector used for vectorized scans
   Vector &selection_vector_;
   // The current tile group id we're scanning over
   llvm::Value *tile_group_id_;
   // The current tile group we're scanning over
   llvm::Value *tile_group_ptr_;
+  // Whether the columns of all dictionary predicates are encoded in the
+  // current tile group, and the range of entries each predicate accepts
+  llvm::Value *all_encoded_;
+  std::vector<std::pair<llvm::Value *, llvm::Value *>> entry_ranges_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -146,7 +297,62 @@ TableScanTranslator::TableScanTranslator(const planner::SeqScanPlan &scan,
   const auto *predicate = scan.GetPredicate();
   if (predicate != nullptr) {
     context.Prepare(*predicate);
+    ClassifyConjuncts(*predicate);
+  }
+}
+
+void TableScanTranslator::ClassifyConjuncts(
+    const expression::AbstractExpression &predicate) {
+  if (predicate.GetExpressionType() == ExpressionType::CONJUNCTION_AND) {
+    for (uint32_t i = 0; i < predicate.GetChildrenSize(); i++) {
+      ClassifyConjuncts(*predicate.GetChild(i));
+    }
+    return;
   }
+
+  auto is_constant = [](const expression::AbstractExpression *expr) {
+    return expr->GetExpressionType() == ExpressionType::VALUE_CONSTANT ||
+           expr->GetExpressionType() == ExpressionType::VALUE_PARAMETER;
+  };
+
+  // We're looking for comparisons between a column and a constant
+  auto cmp_type = predicate.GetExpressionType();
+  bool is_comparison = cmp_type >= ExpressionType::COMPARE_EQUAL &&
+                       cmp_type <= ExpressionType::COMPARE_GREATERTHANOREQUALTO;
+  if (is_comparison && predicate.GetChildrenSize() == 2) {
+    const auto *left = predicate.GetChild(0);
+    const auto *right = predicate.GetChild(1);
+    if (is_constant(left) &&
+        right->GetExpressionType() == ExpressionType::VALUE_TUPLE) {
+      std::swap(left, right);
+      cmp_type = FlipComparison(cmp_type);
+    }
+    if (left->GetExpressionType() == ExpressionType::VALUE_TUPLE &&
+        is_constant(right)) {
+      const auto *ai =
+          static_cast<const expression::TupleValueExpression *>(left)
+              ->GetAttributeRef();
+      auto compare_type =
+          SIMDCompareType(ai->type.type_id, right->GetValueType());
+      if (compare_type != peloton::type::TypeId::INVALID) {
+        simd_predicates_.push_back(
+            SIMDPredicate{ai, cmp_type, right, compare_type});
+        return;
+      }
+      auto col_type = ai->type.type_id;
+      bool is_varlen = col_type == peloton::type::TypeId::VARCHAR ||
+                       col_type == peloton::type::TypeId::VARBINARY;
+      if (is_varlen && right->GetValueType() == col_type &&
+          cmp_type != ExpressionType::COMPARE_NOTEQUAL) {
+        dictionary_predicates_.push_back(
+            DictionaryPredicate{ai, cmp_type, right, &predicate});
+        return;
+      }
+    }
+  }
+
+  // Everything else is evaluated one row at a time
+  residual_predicates_.push_back(&predicate);
 }
 
 // TODO merge serial and parallel since there is a lot of duplication
@@ -179,9 +385,8 @@ void TableScanTranslator::ProduceSerial() const {
 
     auto predicate = const_cast<expression::AbstractExpression *>(
         GetScanPlan().GetPredicate());
-    llvm::Value *predicate_ptr = codegen->CreateIntToPtr(
-        codegen.Const64((int64_t)predicate),
-        AbstractExpressionProxy::GetType(codegen)->getPointerTo());
+    llvm::Value *predicate_ptr = codegen.RelocatablePtr(
+        predicate, AbstractExpressionProxy::GetType(codegen)->getPointerTo());
     size_t num_preds = 0;
 
     auto *zone_map_manager = storage::ZoneMapManager::GetInstance();
@@ -191,7 +396,12 @@ void TableScanTranslator::ProduceSerial() const {
       }
     }
 
-    ScanConsumer scan_consumer{ctx, GetScanPlan(), position_list};
+    ScanConsumer scan_consumer{ctx,
+                               GetScanPlan(),
+                               simd_predicates_,
+                               residual_predicates_,
+                               dictionary_predicates_,
+                               position_list};
     table_.GenerateScan(codegen, table_ptr, nullptr, nullptr, vec_size,
                         predicate_ptr, num_preds, scan_consumer);
   };
@@ -236,9 +446,8 @@ void TableScanTranslator::ProduceParallel() const {
     // zonemap
     auto predicate = const_cast<expression::AbstractExpression *>(
         GetScanPlan().GetPredicate());
-    llvm::Value *predicate_ptr = codegen->CreateIntToPtr(
-        codegen.Const64((int64_t)predicate),
-        AbstractExpressionProxy::GetType(codegen)->getPointerTo());
+    llvm::Value *predicate_ptr = codegen.RelocatablePtr(
+        predicate, AbstractExpressionProxy::GetType(codegen)->getPointerTo());
     size_t num_preds = 0;
 
     auto *zone_map_manager = storage::ZoneMapManager::GetInstance();
@@ -249,7 +458,12 @@ void TableScanTranslator::ProduceParallel() const {
     }
 
     // Scan the given range of the table
-    ScanConsumer scan_consumer{ctx, GetScanPlan(), position_list};
+    ScanConsumer scan_consumer{ctx,
+                               GetScanPlan(),
+                               simd_predicates_,
+                               residual_predicates_,
+                               dictionary_predicates_,
+                               position_list};
     table_.GenerateScan(codegen, table_ptr, tilegroup_start, tilegroup_end,
                         vec_size, predicate_ptr, num_preds, scan_consumer);
   };
@@ -284,10 +498,14 @@ void TableScanTranslator::ScanConsumer::ProcessTuples(
   // 1. Filter the rows in the range [tid_start, tid_end) by txn visibility
   FilterRowsByVisibility(codegen, tid_start, tid_end, selection_vector_);
 
-  // 2. Filter rows by the given predicate (if one exists)
-  auto *predicate = plan_.GetPredicate();
-  if (predicate != nullptr) {
-    // First perform a vectorized filter, putting TIDs into the selection vector
+  // 2. Filter rows by the given predicate (if one exists). Comparisons of
+  //    fixed-width columns with constants are evaluated on column vectors
+  //    first, the rest of the predicate only on the rows they let through.
+  if (!simd_predicates_.empty()) {
+    FilterRowsBySIMDPredicates(codegen, tile_group_access, tid_start, tid_end,
+                               selection_vector_);
+  }
+  if (!residual_predicates_.empty() || !dictionary_predicates_.empty()) {
     FilterRowsByPredicate(codegen, tile_group_access, tid_start, tid_end,
                           selection_vector_);
   }
@@ -354,10 +572,13 @@ void TableScanTranslator::ScanConsumer::FilterRowsByPredicate(
                  tid_end, selection_vector, true};
 
   // Determine the attributes the predicate needs
-  const auto *predicate = plan_.GetPredicate();
-
   std::unordered_set<const planner::AttributeInfo *> used_attributes;
-  predicate->GetUsedAttributes(used_attributes);
+  for (const auto *predicate : residual_predicates_) {
+    predicate->GetUsedAttributes(used_attributes);
+  }
+  for (const auto &predicate : dictionary_predicates_) {
+    predicate.predicate->GetUsedAttributes(used_attributes);
+  }
 
   // Setup the row batch with attribute accessors for the predicate
   std::vector<AttributeAccess> attribute_accessors;
@@ -371,19 +592,246 @@ void TableScanTranslator::ScanConsumer::FilterRowsByPredicate(
 
   // Iterate over the batch using a scalar loop
   batch.Iterate(codegen, [&](RowBatch::Row &row) {
-    // Evaluate the predicate to determine row validity
-    codegen::Value valid_row = row.DeriveValue(codegen, *predicate);
-
-    // Reify the boolean value since it may be NULL
-    PELOTON_ASSERT(valid_row.GetType().GetSqlType() ==
-                   type::Boolean::Instance());
-    llvm::Value *bool_val = type::Boolean::Instance().Reify(codegen, valid_row);
+    // Evaluate the conjuncts to determine row validity
+    llvm::Value *bool_val = nullptr;
+    for (const auto *predicate : residual_predicates_) {
+      codegen::Value valid_row = row.DeriveValue(codegen, *predicate);
+
+      // Reify the boolean value since it may be NULL
+      PELOTON_ASSERT(valid_row.GetType().GetSqlType() ==
+                     type::Boolean::Instance());
+      llvm::Value *valid =
+          type::Boolean::Instance().Reify(codegen, valid_row);
+      bool_val =
+          bool_val == nullptr ? valid : codegen->CreateAnd(bool_val, valid);
+    }
+    if (!dictionary_predicates_.empty()) {
+      llvm::Value *valid = EvaluateDictionaryPredicates(codegen, access, row);
+      bool_val =
+          bool_val == nullptr ? valid : codegen->CreateAnd(bool_val, valid);
+    }
 
     // Set the validity of the row
     row.SetValidity(codegen, bool_val);
   });
 }
 
+void TableScanTranslator::ScanConsumer::FilterRowsBySIMDPredicates(
+    CodeGen &codegen, const TileGroup::TileGroupAccess &access,
+    llvm::Value *tid_start, llvm::Value *tid_end,
+    Vector &selection_vector) const {
+  // Load the constant side of every comparison once, as the compared type
+  auto &parameter_cache = ctx_.GetCompilationContext().GetParameterCache();
+  std::vector<codegen::Value> constants;
+  for (const auto &predicate : simd_predicates_) {
+    codegen::Value constant = parameter_cache.GetValue(predicate.constant);
+    type::Type compare_type{predicate.compare_type, constant.IsNullable()};
+    constants.push_back(constant.CastTo(codegen, compare_type));
+  }
+
+  // Compute the conjunction of all comparisons for a vector of rows
+  auto eval_predicates = [&](const std::function<llvm::Value *(
+                                 uint32_t, llvm::Value *&)> &load_column,
+                             uint32_t vector_size) {
+    llvm::Value *match = nullptr;
+    for (uint32_t i = 0; i < simd_predicates_.size(); i++) {
+      const auto &predicate = simd_predicates_[i];
+      llvm::Value *is_null = nullptr;
+      llvm::Value *col_val = load_column(predicate.ai->attribute_id, is_null);
+      llvm::Value *col_match =
+          CompareColumn(codegen, predicate.cmp_type, col_val, is_null,
+                        constants[i], vector_size);
+      match =
+          match == nullptr ? col_match : codegen->CreateAnd(match, col_match);
+    }
+    return match;
+  };
+
+  // The bitmap of qualifying rows in [tid_start, tid_end), one bit per row
+  uint32_t bitmap_size = selection_vector.GetCapacity() / kSIMDWidth + 1;
+  llvm::Value *bitmap =
+      codegen.AllocateBuffer(codegen.ByteType(), bitmap_size, "scanBitmap");
+  llvm::Value *num_rows = codegen->CreateSub(tid_end, tid_start);
+
+  // Column vectors can only be loaded if every column we need is stored in
+  // columnar form in this tile group. Otherwise, all rows take the slow path.
+  llvm::Value *all_columnar = codegen.ConstBool(true);
+  for (const auto &predicate : simd_predicates_) {
+    all_columnar = codegen->CreateAnd(
+        all_columnar, access.IsColumnar(predicate.ai->attribute_id));
+  }
+  llvm::Value *num_chunks = codegen->CreateSelect(
+      all_columnar, codegen->CreateUDiv(num_rows, codegen.Const32(kSIMDWidth)),
+      codegen.Const32(0));
+
+  // 1. Compare column vectors, kSIMDWidth rows at a time
+  lang::Loop chunk_loop{codegen,
+                        codegen->CreateICmpULT(codegen.Const32(0), num_chunks),
+                        {{"chunk", codegen.Const32(0)}}};
+  {
+    llvm::Value *chunk = chunk_loop.GetLoopVar(0);
+    llvm::Value *tid = codegen->CreateAdd(
+        tid_start, codegen->CreateMul(chunk, codegen.Const32(kSIMDWidth)));
+    llvm::Value *match = eval_predicates(
+        [&](uint32_t col_idx, llvm::Value *&is_null) {
+          return access.LoadColumnVector(codegen, col_idx, tid, kSIMDWidth,
+                                         is_null);
+        },
+        kSIMDWidth);
+
+    // The vector of match flags is exactly one byte of the bitmap
+    codegen->CreateStore(
+        codegen->CreateBitCast(match, codegen.ByteType()),
+        codegen->CreateInBoundsGEP(codegen.ByteType(), bitmap, chunk));
+
+    chunk = codegen->CreateAdd(chunk, codegen.Const32(1));
+    chunk_loop.LoopEnd(codegen->CreateICmpULT(chunk, num_chunks), {chunk});
+  }
+
+  // 2. Compare the remaining rows one at a time
+  llvm::Value *tail_start =
+      codegen->CreateMul(num_chunks, codegen.Const32(kSIMDWidth));
+  lang::Loop tail_loop{codegen, codegen->CreateICmpULT(tail_start, num_rows),
+                       {{"pos", tail_start}}};
+  {
+    llvm::Value *pos = tail_loop.GetLoopVar(0);
+    auto row = access.GetRow(codegen->CreateAdd(tid_start, pos));
+    llvm::Value *match = eval_predicates(
+        [&](uint32_t col_idx, llvm::Value *&is_null) {
+          codegen::Value val = row.LoadColumn(codegen, col_idx);
+          is_null = val.IsNullable() ? val.IsNull(codegen) : nullptr;
+          return val.GetValue();
+        },
+        1);
+
+    // Set the row's bit, clearing its byte when writing the first bit
+    llvm::Value *byte_ptr = codegen->CreateInBoundsGEP(
+        codegen.ByteType(), bitmap,
+        codegen->CreateLShr(pos, codegen.Const32(3)));
+    llvm::Value *bit_idx = codegen->CreateTrunc(
+        codegen->CreateAnd(pos, codegen.Const32(kSIMDWidth - 1)),
+        codegen.ByteType());
+    llvm::Value *byte = codegen->CreateSelect(
+        codegen->CreateICmpEQ(bit_idx, codegen.Const8(0)), codegen.Const8(0),
+        codegen->CreateLoad(byte_ptr));
+    llvm::Value *bit = codegen->CreateShl(
+        codegen->CreateZExt(match, codegen.ByteType()), bit_idx);
+    codegen->CreateStore(codegen->CreateOr(byte, bit), byte_ptr);
+
+    pos = codegen->CreateAdd(pos, codegen.Const32(1));
+    tail_loop.LoopEnd(codegen->CreateICmpULT(pos, num_rows), {pos});
+  }
+
+  // 3. Refine the selection vector without branching: every TID is written
+  //    out, but the write position only advances if the row's bit is set
+  llvm::Value *num_selected = selection_vector.GetNumElements();
+  lang::Loop refine_loop{
+      codegen, codegen->CreateICmpULT(codegen.Const32(0), num_selected),
+      {{"readIdx", codegen.Const32(0)}, {"writeIdx", codegen.Const32(0)}}};
+  {
+    llvm::Value *read_idx = refine_loop.GetLoopVar(0);
+    llvm::Value *write_idx = refine_loop.GetLoopVar(1);
+
+    llvm::Value *tid = selection_vector.GetValue(codegen, read_idx);
+    llvm::Value *pos = codegen->CreateSub(tid, tid_start);
+    llvm::Value *byte = codegen->CreateLoad(codegen->CreateInBoundsGEP(
+        codegen.ByteType(), bitmap,
+        codegen->CreateLShr(pos, codegen.Const32(3))));
+    llvm::Value *bit_idx = codegen->CreateTrunc(
+        codegen->CreateAnd(pos, codegen.Const32(kSIMDWidth - 1)),
+        codegen.ByteType());
+    llvm::Value *bit = codegen->CreateAnd(codegen->CreateLShr(byte, bit_idx),
+                                          codegen.Const8(1));
+    selection_vector.SetValue(codegen, write_idx, tid);
+
+    read_idx = codegen->CreateAdd(read_idx, codegen.Const32(1));
+    write_idx = codegen->CreateAdd(
+        write_idx, codegen->CreateZExt(bit, codegen.Int32Type()));
+    refine_loop.LoopEnd(codegen->CreateICmpULT(read_idx, num_selected),
+                        {read_idx, write_idx});
+  }
+
+  std::vector<llvm::Value *> final_vals;
+  refine_loop.CollectFinalLoopVariables(final_vals);
+  selection_vector.SetNumElements(final_vals[1]);
+}
+
+void TableScanTranslator::ScanConsumer::LoadDictionaryRanges(
+    CodeGen &codegen) {
+  auto &parameter_cache = ctx_.GetCompilationContext().GetParameterCache();
+  llvm::Value *range =
+      codegen.AllocateBuffer(codegen.CharPtrType(), 2, "dictRange");
+
+  all_encoded_ = codegen.ConstBool(true);
+  entry_ranges_.clear();
+  for (const auto &predicate : dictionary_predicates_) {
+    // A NULL constant matches no entry
+    codegen::Value constant = parameter_cache.GetValue(predicate.constant);
+    llvm::Value *str = constant.GetValue();
+    if (constant.IsNullable()) {
+      str = codegen->CreateSelect(constant.IsNull(codegen),
+                                  codegen.NullPtr(codegen.CharPtrType()), str);
+    }
+
+    llvm::Value *encoded = codegen.Call(
+        RuntimeFunctionsProxy::GetDictionaryRange,
+        {tile_group_ptr_, codegen.Const32(predicate.ai->attribute_id),
+         codegen.Const32(static_cast<uint32_t>(predicate.cmp_type)), str,
+         constant.GetLength(), range});
+    all_encoded_ = codegen->CreateAnd(all_encoded_, encoded);
+
+    // The bounds are only meaningful if the column is encoded
+    llvm::Value *begin = codegen->CreateLoad(range);
+    llvm::Value *end = codegen->CreateLoad(
+        codegen->CreateConstInBoundsGEP1_32(codegen.CharPtrType(), range, 1));
+    entry_ranges_.emplace_back(
+        codegen->CreatePtrToInt(begin, codegen.Int64Type()),
+        codegen->CreatePtrToInt(end, codegen.Int64Type()));
+  }
+}
+
+llvm::Value *TableScanTranslator::ScanConsumer::EvaluateDictionaryPredicates(
+    CodeGen &codegen, const TileGroup::TileGroupAccess &access,
+    RowBatch::Row &row) const {
+  // The branch goes the same way for every row of the tile group. Either way,
+  // all the predicates are evaluated in the same branch, so that the values
+  // the row caches while evaluating them are never used outside of it.
+  llvm::Value *in_range = nullptr;
+  llvm::Value *valid = nullptr;
+  lang::If all_encoded{codegen, all_encoded_, "dictEncoded"};
+  {
+    llvm::Value *tid = row.GetTID(codegen);
+    for (uint32_t i = 0; i < dictionary_predicates_.size(); i++) {
+      // The slot of the column holds the pointer to the value, i.e., to its
+      // dictionary entry. NULL values aren't in any range.
+      const auto &layout =
+          access.GetLayout(dictionary_predicates_[i].ai->attribute_id);
+      llvm::Value *slot = codegen->CreateInBoundsGEP(
+          codegen.ByteType(), layout.col_start_ptr,
+          codegen->CreateMul(tid, layout.col_stride));
+      llvm::Value *entry = codegen->CreateLoad(
+          codegen.Int64Type(),
+          codegen->CreateBitCast(slot, codegen.Int64Type()->getPointerTo()));
+      llvm::Value *match = codegen->CreateAnd(
+          codegen->CreateICmpUGE(entry, entry_ranges_[i].first),
+          codegen->CreateICmpULT(entry, entry_ranges_[i].second));
+      in_range = in_range == nullptr ? match
+                                     : codegen->CreateAnd(in_range, match);
+    }
+  }
+  all_encoded.ElseBlock("dictNotEncoded");
+  {
+    for (const auto &predicate : dictionary_predicates_) {
+      codegen::Value valid_row =
+          row.DeriveValue(codegen, *predicate.predicate);
+      llvm::Value *match = type::Boolean::Instance().Reify(codegen, valid_row);
+      valid = valid == nullptr ? match : codegen->CreateAnd(valid, match);
+    }
+  }
+  all_encoded.EndIf();
+  return all_encoded.BuildPHI(in_range, valid);
+}
+
 void TableScanTranslator::ScanConsumer::PerformReads(
     CodeGen &codegen, Vector &selection_vector) const {
   ExecutionConsumer &ec = ctx_.GetCompilationContext().GetExecutionConsumer();
@@ -71,9 +71,9 @@ void UpdateTranslator::InitializeQueryState() {
   // Get the target list's raw vectors and their sizes
   // : this is required when installing a new version at updater
   const auto *project_info = update_plan.GetProjectInfo();
-  llvm::Value *target_vector_ptr = codegen->CreateIntToPtr(
-      codegen.Const64((int64_t)project_info->GetTargetList().data()),
-      TargetProxy::GetType(codegen)->getPointerTo());
+  llvm::Value *target_vector_ptr =
+      codegen.RelocatablePtr(project_info->GetTargetList().data(),
+                             TargetProxy::GetType(codegen)->getPointerTo());
   llvm::Value *target_vector_size_ptr =
       codegen.Const32((int32_t)project_info->GetTargetList().size());
 
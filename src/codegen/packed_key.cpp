@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// packed_key.cpp
+//
+// Identification: src/codegen/packed_key.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "codegen/packed_key.h"
+
+#include "codegen/type/bigint_type.h"
+#include "codegen/type/integer_type.h"
+#include "codegen/type/sql_type.h"
+
+namespace peloton {
+namespace codegen {
+
+PackedKey::PackedKey() : num_bits_(0) {}
+
+bool PackedKey::Setup(CodeGen &codegen,
+                      const std::vector<type::Type> &key_type) {
+  columns_.clear();
+  num_bits_ = 0;
+
+  bool has_nullable = false;
+  for (const auto &col_type : key_type) {
+    switch (col_type.type_id) {
+      case peloton::type::TypeId::BOOLEAN:
+      case peloton::type::TypeId::TINYINT:
+      case peloton::type::TypeId::SMALLINT:
+      case peloton::type::TypeId::INTEGER:
+      case peloton::type::TypeId::BIGINT:
+      case peloton::type::TypeId::DATE:
+      case peloton::type::TypeId::TIMESTAMP: {
+        break;
+      }
+      default: {
+        // Not a fixed-width integral value
+        columns_.clear();
+        return false;
+      }
+    }
+
+    llvm::Type *val_type = nullptr, *len_type = nullptr;
+    col_type.GetSqlType().GetTypeForMaterialization(codegen, val_type,
+                                                    len_type);
+    uint32_t width = val_type->getIntegerBitWidth();
+    columns_.emplace_back(col_type, val_type, num_bits_, width);
+    num_bits_ += width + (col_type.nullable ? 1 : 0);
+    has_nullable = has_nullable || col_type.nullable;
+  }
+
+  // Keys that don't fit into 64 bits are stored column by column. So is a key
+  // of a single non-NULL column, which is its own packed form.
+  if (num_bits_ > 64 || (columns_.size() < 2 && !has_nullable)) {
+    columns_.clear();
+    return false;
+  }
+
+  if (num_bits_ <= 32) {
+    packed_type_ = type::Type{type::Integer::Instance()};
+  } else {
+    packed_type_ = type::Type{type::BigInt::Instance()};
+  }
+  return true;
+}
+
+codegen::Value PackedKey::Pack(CodeGen &codegen,
+                               const std::vector<codegen::Value> &key) const {
+  PELOTON_ASSERT(IsPacked() && key.size() == columns_.size());
+
+  llvm::Type *packed_llvm_type =
+      num_bits_ <= 32 ? codegen.Int32Type() : codegen.Int64Type();
+
+  llvm::Value *packed = llvm::ConstantInt::get(packed_llvm_type, 0);
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    const auto &col = columns_[i];
+    PELOTON_ASSERT(key[i].GetValue()->getType() == col.llvm_type);
+
+    llvm::Value *val =
+        codegen->CreateZExtOrBitCast(key[i].GetValue(), packed_llvm_type);
+    if (col.type.nullable) {
+      // A NULL column only sets its NULL bit, whatever its value is
+      llvm::Value *null_bit =
+          llvm::ConstantInt::get(packed_llvm_type, 1ull << col.width);
+      val = codegen->CreateSelect(key[i].IsNull(codegen), null_bit, val);
+    }
+    if (col.offset > 0) {
+      val = codegen->CreateShl(val, col.offset);
+    }
+    packed = codegen->CreateOr(packed, val);
+  }
+  return codegen::Value{packed_type_, packed};
+}
+
+void PackedKey::Unpack(CodeGen &codegen, const codegen::Value &packed,
+                       std::vector<codegen::Value> &key) const {
+  PELOTON_ASSERT(IsPacked());
+
+  llvm::Value *packed_val = packed.GetValue();
+  llvm::Type *packed_llvm_type = packed_val->getType();
+  for (const auto &col : columns_) {
+    llvm::Value *bits = packed_val;
+    if (col.offset > 0) {
+      bits = codegen->CreateLShr(bits, col.offset);
+    }
+    llvm::Value *val = codegen->CreateTruncOrBitCast(bits, col.llvm_type);
+
+    llvm::Value *is_null = nullptr;
+    if (col.type.nullable) {
+      llvm::Value *null_bit =
+          llvm::ConstantInt::get(packed_llvm_type, 1ull << col.width);
+      is_null = codegen->CreateICmpNE(codegen->CreateAnd(bits, null_bit),
+                                      llvm::ConstantInt::get(
+                                          packed_llvm_type, 0));
+    }
+    key.emplace_back(col.type, val, nullptr, is_null);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// UNPACKING ACCESS
+//===----------------------------------------------------------------------===//
+
+void PackedKey::UnpackingAccess::ExtractBucketKeys(
+    CodeGen &codegen, llvm::Value *index,
+    std::vector<codegen::Value> &keys) const {
+  std::vector<codegen::Value> packed;
+  access_.ExtractBucketKeys(codegen, index, packed);
+  PELOTON_ASSERT(packed.size() == 1);
+  packed_key_.Unpack(codegen, packed[0], keys);
+}
+
+}  // namespace codegen
+}  // namespace peloton
@@ -0,0 +1,33 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// radix_partitioner_proxy.cpp
+//
+// Identification: src/codegen/proxy/radix_partitioner_proxy.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "codegen/proxy/radix_partitioner_proxy.h"
+
+#include "codegen/proxy/executor_context_proxy.h"
+#include "codegen/proxy/hash_table_proxy.h"
+
+namespace peloton {
+namespace codegen {
+
+DEFINE_TYPE(RadixPartitioner, "peloton::util::RadixPartitioner", opaque);
+
+DEFINE_METHOD(peloton::codegen::util, RadixPartitioner, Init);
+DEFINE_METHOD(peloton::codegen::util, RadixPartitioner, Insert);
+DEFINE_METHOD(peloton::codegen::util, RadixPartitioner, FlushBuffers);
+DEFINE_METHOD(peloton::codegen::util, RadixPartitioner, TransferPartitions);
+DEFINE_METHOD(peloton::codegen::util, RadixPartitioner, LinkPartition);
+DEFINE_METHOD(peloton::codegen::util, RadixPartitioner, BuildPartitionTable);
+DEFINE_METHOD(peloton::codegen::util, RadixPartitioner, ReleasePartition);
+DEFINE_METHOD(peloton::codegen::util, RadixPartitioner, Destroy);
+
+}  // namespace codegen
+}  // namespace peloton
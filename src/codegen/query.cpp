@@ -20,27 +20,72 @@
 #include "executor/executor_context.h"
 #include "storage/storage_manager.h"
 #include "settings/settings_manager.h"
+#include "threadpool/mono_queue_pool.h"
 
 namespace peloton {
 namespace codegen {
 
+struct Query::BytecodeFunctions {
+  interpreter::BytecodeFunction init_func;
+  interpreter::BytecodeFunction plan_func;
+  interpreter::BytecodeFunction tear_down_func;
+};
+
+void Query::RecompilationTarget::Install(
+    std::unique_ptr<Query> &&recompiled,
+    std::shared_ptr<planner::AbstractPlan> plan) {
+  std::lock_guard<std::mutex> guard{lock_};
+  if (query_ == nullptr) {
+    LOG_DEBUG("Dropping the recompilation of an evicted query");
+    return;
+  }
+  PELOTON_ASSERT(query_->recompiled_ == nullptr);
+
+  // Keep the plan alive for as long as its code may run
+  query_->recompiled_plan_ = std::move(plan);
+  query_->recompiled_query_ = std::move(recompiled);
+  query_->recompiled_ = query_->recompiled_query_.get();
+}
+
 // Constructor
 Query::Query(const planner::AbstractPlan &query_plan)
-    : query_plan_(query_plan) {}
+    : query_plan_(query_plan),
+      parameter_size_(0),
+      is_compiled_(false),
+      cancelled_(false),
+      opt_level_(OptimizationLevel::Default),
+      num_executions_(0),
+      recompiling_(false),
+      recompiled_(nullptr),
+      recompilation_target_(std::make_shared<RecompilationTarget>(this)) {}
+
+Query::~Query() {
+  // The compiler threads must be done with the code before it goes away
+  if (compilation_.valid()) {
+    cancelled_ = true;
+    compilation_.wait();
+  }
+
+  // A recompilation that is still running has nowhere to go anymore
+  std::lock_guard<std::mutex> guard{recompilation_target_->lock_};
+  recompilation_target_->query_ = nullptr;
+}
 
 void Query::Execute(executor::ExecutorContext &executor_context,
                     ExecutionConsumer &consumer, RuntimeStats *stats) {
-  CodeGen codegen{code_context_};
+  num_executions_++;
 
-  llvm::Type *query_state_type = query_state_.GetType();
-  size_t parameter_size = codegen.SizeOf(query_state_type);
-  PELOTON_ASSERT((parameter_size % 8 == 0) &&
-      "parameter size not multiple of 8");
+  // Switch to the code of the recompilation, once it is ready
+  Query *recompiled = recompiled_.load();
+  if (recompiled != nullptr) {
+    recompiled->Execute(executor_context, consumer, stats);
+    return;
+  }
 
   // Allocate some space for the function arguments
-  std::unique_ptr<char[]> param_data{new char[parameter_size]};
+  std::unique_ptr<char[]> param_data{new char[parameter_size_]};
   char *param = param_data.get();
-  PELOTON_MEMSET(param, 0, parameter_size);
+  PELOTON_MEMSET(param, 0, parameter_size_);
 
   // Set up the function arguments
   auto *func_args = reinterpret_cast<FunctionArguments *>(param_data.get());
@@ -50,6 +95,13 @@ void Query::Execute(executor::ExecutorContext &executor_context,
   bool force_interpreter = settings::SettingsManager::GetBool(
       settings::SettingId::codegen_interpreter);
 
+  // Queries the interpreter cannot run wait for their native code
+  if (!is_compiled_ && !force_interpreter && compilation_.valid() &&
+      bytecode_ == nullptr) {
+    std::shared_future<void> compilation = compilation_;
+    compilation.get();
+  }
+
   if (is_compiled_ && !force_interpreter) {
     ExecuteNative(func_args, stats);
   } else {
@@ -69,15 +121,27 @@ void Query::Prepare(const LLVMFunctions &query_funcs) {
   // but we do not want to mix up the timings, so do it here
   code_context_.Verify();
 
-  // optimize the functions
-  // TODO(marcel): add switch to enable/disable optimization
-  // TODO(marcel): add timer to measure time used for optimization (see
-  // RuntimeStats)
-  code_context_.Optimize();
+  CodeGen codegen{code_context_};
+  parameter_size_ = codegen.SizeOf(query_state_.GetType());
+  PELOTON_ASSERT((parameter_size_ % 8 == 0) &&
+      "parameter size not multiple of 8");
 
   is_compiled_ = false;
 }
 
+bool Query::NeedsRecompilation() {
+  auto threshold = static_cast<uint64_t>(settings::SettingsManager::GetInt(
+      settings::SettingId::codegen_hot_query_executions));
+  if (threshold == 0 || !is_compiled_ ||
+      opt_level_ == OptimizationLevel::Aggressive ||
+      num_executions_ < threshold) {
+    return false;
+  }
+
+  // Only the first caller gets to recompile
+  return !recompiling_.exchange(true);
+}
+
 void Query::Compile(CompileStats *stats) {
   // Timer
   Timer<std::milli> timer;
@@ -85,6 +149,10 @@ void Query::Compile(CompileStats *stats) {
     timer.Start();
   }
 
+  // Optimize the functions. The optimization is part of the compilation, so
+  // that it happens on the compiler threads when compiling asynchronously.
+  code_context_.Optimize(opt_level_);
+
   // Compile all functions in context
   LOG_TRACE("Starting Query compilation ...");
   code_context_.Compile();
@@ -117,6 +185,43 @@ void Query::Compile(CompileStats *stats) {
   }
 }
 
+std::shared_future<void> Query::CompileAsync() {
+  PELOTON_ASSERT(!compilation_.valid());
+
+  // Translate the query to bytecode now, since compiling changes the IR
+  try {
+    bytecode_ = CreateBytecode();
+  } catch (interpreter::NotSupportedException &e) {
+    LOG_DEBUG("Query not supported by interpreter, executions wait for its "
+              "compilation: %s", e.what());
+  }
+
+  auto done = std::make_shared<std::promise<void>>();
+  compilation_ = done->get_future().share();
+  auto compile = [this, done]() {
+    try {
+      if (!cancelled_) {
+        Compile();
+      }
+      done->set_value();
+    } catch (...) {
+      done->set_exception(std::current_exception());
+    }
+  };
+  threadpool::MonoQueuePool::GetCompilationInstance().SubmitTask(compile);
+  return compilation_;
+}
+
+std::unique_ptr<Query::BytecodeFunctions> Query::CreateBytecode() const {
+  return std::unique_ptr<BytecodeFunctions>{new BytecodeFunctions{
+      interpreter::BytecodeBuilder::CreateBytecodeFunction(
+          code_context_, llvm_functions_.init_func),
+      interpreter::BytecodeBuilder::CreateBytecodeFunction(
+          code_context_, llvm_functions_.plan_func),
+      interpreter::BytecodeBuilder::CreateBytecodeFunction(
+          code_context_, llvm_functions_.tear_down_func)}};
+}
+
 void Query::ExecuteNative(FunctionArguments *function_arguments,
                           RuntimeStats *stats) {
   // Start timer
@@ -182,16 +287,16 @@ void Query::ExecuteInterpreter(FunctionArguments *function_arguments,
     timer.Start();
   }
 
-  // Create Bytecode
-  interpreter::BytecodeFunction init_bytecode =
-      interpreter::BytecodeBuilder::CreateBytecodeFunction(
-          code_context_, llvm_functions_.init_func);
-  interpreter::BytecodeFunction plan_bytecode =
-      interpreter::BytecodeBuilder::CreateBytecodeFunction(
-          code_context_, llvm_functions_.plan_func);
-  interpreter::BytecodeFunction tear_down_bytecode =
-      interpreter::BytecodeBuilder::CreateBytecodeFunction(
-          code_context_, llvm_functions_.tear_down_func);
+  // Create Bytecode, unless it was prepared for the asynchronous compilation
+  std::unique_ptr<BytecodeFunctions> created;
+  const BytecodeFunctions *bytecode = bytecode_.get();
+  if (bytecode == nullptr) {
+    created = CreateBytecode();
+    bytecode = created.get();
+  }
+  const auto &init_bytecode = bytecode->init_func;
+  const auto &plan_bytecode = bytecode->plan_func;
+  const auto &tear_down_bytecode = bytecode->tear_down_func;
 
   // Time initialization
   if (stats != nullptr) {
@@ -41,6 +41,52 @@ void QueryCache::Add(const std::shared_ptr<planner::AbstractPlan> &key,
   cache_lock_.Unlock();
 }
 
+Query *QueryCache::FindOrAdd(
+    const std::shared_ptr<planner::AbstractPlan> &key,
+    const std::function<std::unique_ptr<Query>()> &create) {
+  Query *query = Find(key);
+  if (query != nullptr) {
+    return query;
+  }
+
+  // Wait for another thread that creates the same query
+  std::promise<Query *> created;
+  std::shared_future<Query *> pending;
+  {
+    std::lock_guard<std::mutex> guard{pending_lock_};
+    auto iter = pending_.find(key);
+    if (iter != pending_.end()) {
+      pending = iter->second;
+    } else {
+      pending_.emplace(key, created.get_future().share());
+    }
+  }
+  if (pending.valid()) {
+    return pending.get();
+  }
+
+  // The query may have been added since we looked
+  auto remove_pending = [this, &key]() {
+    std::lock_guard<std::mutex> guard{pending_lock_};
+    pending_.erase(key);
+  };
+  try {
+    query = Find(key);
+    if (query == nullptr) {
+      auto new_query = create();
+      query = new_query.get();
+      Add(key, std::move(new_query));
+    }
+  } catch (...) {
+    created.set_exception(std::current_exception());
+    remove_pending();
+    throw;
+  }
+  created.set_value(query);
+  remove_pending();
+  return query;
+}
+
 void QueryCache::Clear() {
   cache_lock_.WriteLock();
   cache_map_.clear();
@@ -17,6 +17,7 @@
 #include "planner/hash_join_plan.h"
 #include "planner/projection_plan.h"
 #include "planner/seq_scan_plan.h"
+#include "settings/settings_manager.h"
 
 namespace peloton {
 namespace codegen {
@@ -27,9 +28,11 @@ QueryCompiler::QueryCompiler() : next_id_(0) {}
 // Compile the given query statement
 std::unique_ptr<Query> QueryCompiler::Compile(
     const planner::AbstractPlan &root, const QueryParametersMap &parameters_map,
-    ExecutionConsumer &result_consumer, CompileStats *stats) {
+    ExecutionConsumer &result_consumer, CompileStats *stats,
+    OptimizationLevel opt_level) {
   // The query statement we compile
   std::unique_ptr<Query> query{new Query(root)};
+  query->opt_level_ = opt_level;
 
   // Set up the compilation context
   CompilationContext context{query->GetCodeContext(), query->GetQueryState(),
@@ -42,6 +45,29 @@ std::unique_ptr<Query> QueryCompiler::Compile(
   return query;
 }
 
+OptimizationLevel QueryCompiler::ChooseOptimizationLevel(
+    const planner::AbstractPlan &plan) {
+  // The largest estimated cardinality of any operator in the plan
+  std::function<int64_t(const planner::AbstractPlan &)> max_rows = [&max_rows](
+      const planner::AbstractPlan &node) {
+    int64_t rows = node.GetCardinality();
+    for (const auto &child : node.GetChildren()) {
+      rows = std::max(rows, max_rows(*child));
+    }
+    return rows;
+  };
+  int64_t rows = max_rows(plan);
+
+  if (rows < settings::SettingsManager::GetInt(
+                 settings::SettingId::codegen_cold_query_rows)) {
+    return OptimizationLevel::None;
+  } else if (rows >= settings::SettingsManager::GetInt(
+                        settings::SettingId::codegen_hot_query_rows)) {
+    return OptimizationLevel::Aggressive;
+  }
+  return OptimizationLevel::Default;
+}
+
 // Check if the given query can be compiled. This search is not exhaustive ...
 bool QueryCompiler::IsSupported(const planner::AbstractPlan &plan) {
   switch (plan.GetPlanNodeType()) {
@@ -71,13 +97,27 @@ bool QueryCompiler::IsSupported(const planner::AbstractPlan &plan) {
       }
       break;
     }
-    case PlanNodeType::NESTLOOP:
+    case PlanNodeType::NESTLOOP: {
+      const auto &join = static_cast<const planner::AbstractJoinPlan &>(plan);
+      // Right now, only support inner nested-loop joins
+      if (join.GetJoinType() != JoinType::INNER) {
+        return false;
+      }
+      break;
+    }
     case PlanNodeType::HASHJOIN: {
       const auto &join = static_cast<const planner::AbstractJoinPlan &>(plan);
-      // Right now, only support inner joins
-      if (join.GetJoinType() == JoinType::INNER) {
-        break;
+      switch (join.GetJoinType()) {
+        case JoinType::INNER:
+        case JoinType::LEFT:
+        case JoinType::RIGHT:
+        case JoinType::OUTER:
+        case JoinType::SEMI:
+        case JoinType::ANTI:
+          break;
+        default: { return false; }
       }
+      break;
     }
     case PlanNodeType::HASH: {
       break;
@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// radix_partitioner.cpp
+//
+// Identification: src/codegen/radix_partitioner.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "codegen/radix_partitioner.h"
+
+#include "codegen/hash.h"
+#include "codegen/lang/loop.h"
+#include "codegen/proxy/hash_table_proxy.h"
+#include "codegen/proxy/radix_partitioner_proxy.h"
+
+namespace peloton {
+namespace codegen {
+
+RadixPartitioner::RadixPartitioner() {
+  // This constructor shouldn't generally be used at all, but there are
+  // cases when the key-type is not known at construction time.
+}
+
+RadixPartitioner::RadixPartitioner(CodeGen &codegen,
+                                   const std::vector<type::Type> &key_type,
+                                   uint32_t value_size, uint32_t num_radix_bits)
+    : value_size_(value_size), num_radix_bits_(num_radix_bits) {
+  key_storage_.Setup(codegen, key_type);
+}
+
+void RadixPartitioner::Init(CodeGen &codegen, llvm::Value *partitioner_ptr,
+                            llvm::Value *exec_ctx) const {
+  auto *tuple_size = codegen.Const32(TupleSize());
+  auto *num_radix_bits = codegen.Const32(num_radix_bits_);
+  codegen.Call(RadixPartitionerProxy::Init,
+               {partitioner_ptr, exec_ctx, tuple_size, num_radix_bits});
+}
+
+llvm::Value *RadixPartitioner::Insert(
+    CodeGen &codegen, llvm::Value *partitioner_ptr,
+    const std::vector<codegen::Value> &key) const {
+  // The hash picks the partition here and the bucket in the partition's hash
+  // table later on. It must be the one HashTable::FindAll() computes.
+  llvm::Value *hash = Hash::HashValues(codegen, key);
+  llvm::Value *space =
+      codegen.Call(RadixPartitionerProxy::Insert, {partitioner_ptr, hash});
+  return key_storage_.StoreValues(codegen, space, key);
+}
+
+void RadixPartitioner::FlushBuffers(CodeGen &codegen,
+                                    llvm::Value *partitioner_ptr) const {
+  codegen.Call(RadixPartitionerProxy::FlushBuffers, {partitioner_ptr});
+}
+
+void RadixPartitioner::TransferPartitions(CodeGen &codegen,
+                                          llvm::Value *partitioner_ptr,
+                                          llvm::Value *thread_states,
+                                          uint32_t partitioner_offset) const {
+  auto *offset = codegen.Const32(partitioner_offset);
+  codegen.Call(RadixPartitionerProxy::TransferPartitions,
+               {partitioner_ptr, thread_states, offset});
+}
+
+void RadixPartitioner::BuildPartitionTable(CodeGen &codegen,
+                                           llvm::Value *partitioner_ptr,
+                                           llvm::Value *partition,
+                                           llvm::Value *ht_ptr) const {
+  codegen.Call(RadixPartitionerProxy::BuildPartitionTable,
+               {partitioner_ptr, partition, ht_ptr});
+}
+
+void RadixPartitioner::ReleasePartition(CodeGen &codegen,
+                                        llvm::Value *partitioner_ptr,
+                                        llvm::Value *partition) const {
+  codegen.Call(RadixPartitionerProxy::ReleasePartition,
+               {partitioner_ptr, partition});
+}
+
+void RadixPartitioner::IteratePartition(
+    CodeGen &codegen, llvm::Value *partitioner_ptr, llvm::Value *partition,
+    HashTable::IterateCallback &callback) const {
+  llvm::Value *head = codegen.Call(RadixPartitionerProxy::LinkPartition,
+                                   {partitioner_ptr, partition});
+
+  llvm::Type *entry_type = EntryProxy::GetType(codegen);
+  llvm::Value *null = codegen.NullPtr(entry_type->getPointerTo());
+
+  lang::Loop entry_loop{
+      codegen, codegen->CreateICmpNE(head, null), {{"entry", head}}};
+  {
+    llvm::Value *entry = entry_loop.GetLoopVar(0);
+    llvm::Value *entry_keys =
+        codegen->CreateConstInBoundsGEP1_32(entry_type, entry, 1);
+
+    // Pull out keys and invoke callback
+    std::vector<codegen::Value> keys;
+    llvm::Value *data_area =
+        key_storage_.LoadValues(codegen, entry_keys, keys);
+    callback.ProcessEntry(codegen, keys, data_area);
+
+    entry = codegen.Load(EntryProxy::next, entry);
+    entry_loop.LoopEnd(codegen->CreateICmpNE(entry, null), {entry});
+  }
+}
+
+void RadixPartitioner::Destroy(CodeGen &codegen,
+                               llvm::Value *partitioner_ptr) const {
+  codegen.Call(RadixPartitionerProxy::Destroy, {partitioner_ptr});
+}
+
+}  // namespace codegen
+}  // namespace peloton
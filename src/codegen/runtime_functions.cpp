@@ -13,14 +13,20 @@
 #include "codegen/runtime_functions.h"
 
 #include <nmmintrin.h>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "murmur3/MurmurHash3.h"
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/numa_manager.h"
 #include "common/timer.h"
 #include "common/synchronization/count_down_latch.h"
 #include "expression/abstract_expression.h"
+#include "storage/compressed_column.h"
 #include "storage/data_table.h"
 #include "storage/layout.h"
 #include "storage/storage_manager.h"
@@ -70,15 +76,12 @@ uint64_t RuntimeFunctions::HashCrc64(const char *buf, uint64_t length,
 }
 
 //===----------------------------------------------------------------------===//
-// Get the tile group with the given index from the table.
-//
-// TODO: DataTable::GetTileGroup() returns a std::shared_ptr<> that we strip
-//       off. This means we could be touching free'd data. This must be fixed.
+// Get the tile group with the given index from the table. The tile group stays
+// valid while the query's transaction runs, even if it is dropped meanwhile.
 //===----------------------------------------------------------------------===//
 storage::TileGroup *RuntimeFunctions::GetTileGroup(storage::DataTable *table,
                                                    uint64_t tile_group_index) {
-  auto tile_group = table->GetTileGroup(tile_group_index);
-  return tile_group.get();
+  return table->GetTileGroupPtr(tile_group_index);
 }
 
 //===----------------------------------------------------------------------===//
@@ -104,6 +107,45 @@ void RuntimeFunctions::FillPredicateArray(
   temp_expr->ClearParsedPredicates();
 }
 
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Decode the integer column of a frozen tile into a buffer that lives until the
+// scan that asked for it moves on to its next tile group. Buffers are keyed by
+// the layout slot of the scan, so a scan reuses its buffer across tile groups.
+// Only the least recently used buffers are evicted, once a thread has more
+// than a handful of scans open at a time.
+//===----------------------------------------------------------------------===//
+char *DecodeColumn(const void *slot, const storage::CompressedColumn &column) {
+  static constexpr size_t kMaxDecodeBuffers = 64;
+
+  struct DecodeBuffer {
+    uint64_t last_use;
+    std::vector<char> data;
+  };
+  thread_local std::unordered_map<const void *, DecodeBuffer> buffers;
+  thread_local uint64_t use_counter = 0;
+
+  if (buffers.size() >= kMaxDecodeBuffers && buffers.count(slot) == 0) {
+    auto lru = buffers.begin();
+    for (auto iter = buffers.begin(); iter != buffers.end(); ++iter) {
+      if (iter->second.last_use < lru->second.last_use) {
+        lru = iter;
+      }
+    }
+    buffers.erase(lru);
+  }
+
+  auto &buffer = buffers[slot];
+  buffer.last_use = ++use_counter;
+  buffer.data.resize(column.GetTupleCount() *
+                     peloton::type::Type::GetTypeSize(column.GetTypeId()));
+  column.Decode(buffer.data.data());
+  return buffer.data.data();
+}
+
+}  // namespace
+
 //===----------------------------------------------------------------------===//
 // For every column in the tile group, fill out the layout information for the
 // column in the provided 'infos' array.  Specifically, we need a pointer to
@@ -130,6 +172,18 @@ void RuntimeFunctions::GetTileGroupLayout(const storage::TileGroup *tile_group,
       oid_t tile_col_offset = column_entry.second;
       // Ensure that the col_idx is within the num_cols range
       PELOTON_ASSERT(col_idx < num_cols);
+      const auto *compressed = tile->GetCompressedColumn();
+      if (compressed != nullptr &&
+          compressed->GetEncoding() !=
+              storage::CompressedColumn::Encoding::Dictionary) {
+        // Integer encodings replace the data of the tile, scans see the
+        // decoded values. Dictionary-encoded columns keep their pointers.
+        infos[col_idx].column = DecodeColumn(&infos[col_idx], *compressed);
+        infos[col_idx].stride = tile_schema->GetLength();
+        infos[col_idx].is_columnar = true;
+        last_col_idx = col_idx;
+        continue;
+      }
       infos[col_idx].column =
           tile->GetTupleLocation(0) + tile_schema->GetOffset(tile_col_offset);
       infos[col_idx].stride = tile_schema->GetLength();
@@ -145,6 +199,30 @@ void RuntimeFunctions::GetTileGroupLayout(const storage::TileGroup *tile_group,
                  (last_col_idx == (num_cols - 1)));
 }
 
+//===----------------------------------------------------------------------===//
+// If the given column of the tile group is dictionary-encoded, find the range
+// of dictionary entries that satisfy 'column <cmp_type> str', and store its
+// bounds in range[0] and range[1]. A value of the column then satisfies the
+// comparison iff its pointer is in the range.
+//===----------------------------------------------------------------------===//
+bool RuntimeFunctions::GetDictionaryRange(const storage::TileGroup *tile_group,
+                                          uint32_t col_id, uint32_t cmp_type,
+                                          const char *str, uint32_t len,
+                                          const char **range) {
+  oid_t tile_id, tile_col_id;
+  tile_group->GetLayout().LocateTileAndColumn(col_id, tile_id, tile_col_id);
+  const auto *compressed =
+      tile_group->GetTile(tile_id)->GetCompressedColumn();
+  if (compressed == nullptr ||
+      compressed->GetEncoding() !=
+          storage::CompressedColumn::Encoding::Dictionary) {
+    return false;
+  }
+  compressed->GetEntryRange(static_cast<ExpressionType>(cmp_type), str, len,
+                            &range[0], &range[1]);
+  return true;
+}
+
 void RuntimeFunctions::ExecuteTableScan(
     void *query_state, executor::ExecutorContext::ThreadStates &thread_states,
     uint32_t db_oid, uint32_t table_oid, void *func) {
@@ -160,10 +238,44 @@ void RuntimeFunctions::ExecuteTableScan(
   auto *table = sm->GetTableWithOid(db_oid, table_oid);
   auto num_tilegroups = static_cast<uint32_t>(table->GetTileGroupCount());
 
-  // Determine the number of tasks to generate. In this case, we use:
-  // num_tasks := num_tile_groups / num_workers
-  uint32_t num_tasks = std::min(worker_pool.NumWorkers(), num_tilegroups);
-  uint32_t num_tilegroups_per_task = num_tilegroups / num_tasks;
+  // Each task scans a range of about num_tile_groups / num_workers tile
+  // groups. When the tile groups are spread over NUMA nodes, the ranges are
+  // also cut where the node changes, so that every range is on one node.
+  uint32_t num_workers = std::min(worker_pool.NumWorkers(), num_tilegroups);
+  uint32_t num_tilegroups_per_task =
+      (num_tilegroups + num_workers - 1) / num_workers;
+  auto &numa_manager = NumaManager::GetInstance();
+  uint32_t num_nodes = numa_manager.GetNumNodes();
+
+  // The ranges on each node, and the ones that are on no node in particular
+  struct ScanRange {
+    uint32_t start, stop;
+  };
+  std::vector<std::vector<ScanRange>> node_ranges(num_nodes + 1);
+  uint32_t num_tasks = 0;
+  for (uint32_t start = 0; start < num_tilegroups; num_tasks++) {
+    int node = num_nodes > 1 ? table->GetTileGroupNumaNode(start)
+                             : NumaManager::kAnyNode;
+    uint32_t stop = start + 1;
+    while (stop < num_tilegroups && stop - start < num_tilegroups_per_task &&
+           (num_nodes < 2 || table->GetTileGroupNumaNode(stop) == node)) {
+      stop++;
+    }
+    node_ranges[node == NumaManager::kAnyNode ? num_nodes : node].push_back(
+        ScanRange{start, stop});
+    start = stop;
+  }
+
+  // Each range gets the thread state after the ranges before it
+  std::vector<uint32_t> first_task(num_nodes + 1, 0);
+  for (uint32_t node = 1; node <= num_nodes; node++) {
+    first_task[node] = first_task[node - 1] + node_ranges[node - 1].size();
+  }
+  std::unique_ptr<std::atomic<uint32_t>[]> next_range{
+      new std::atomic<uint32_t>[num_nodes + 1]};
+  for (uint32_t node = 0; node <= num_nodes; node++) {
+    next_range[node].store(0);
+  }
 
   // Allocate states for each task
   thread_states.Allocate(num_tasks);
@@ -171,16 +283,28 @@ void RuntimeFunctions::ExecuteTableScan(
   // Create count down latch
   common::synchronization::CountDownLatch latch{num_tasks};
 
-  // Now, submit the tasks
-  for (uint32_t task_id = 0; task_id < num_tasks; task_id++) {
-    bool last_task = (task_id == num_tasks - 1);
-    auto tilegroup_start = task_id * num_tilegroups_per_task;
-    auto tilegroup_stop =
-        last_task ? num_tilegroups : tilegroup_start + num_tilegroups_per_task;
-    auto work = [&query_state, &thread_states, &scanner, &latch, task_id,
-                 tilegroup_start, tilegroup_stop]() {
-      LOG_DEBUG("Task-%u scanning tile groups [%u-%u)", task_id,
-                tilegroup_start, tilegroup_stop);
+  // Now, submit the tasks. Every task scans one of the ranges, taking one on
+  // the node of the worker that runs it, while there are any left.
+  for (uint32_t i = 0; i < num_tasks; i++) {
+    auto work = [&query_state, &thread_states, &scanner, &latch, &numa_manager,
+                 &node_ranges, &first_task, &next_range, num_nodes]() {
+      uint32_t home_node = numa_manager.GetCurrentNode();
+      uint32_t task_id = 0, tilegroup_start = 0, tilegroup_stop = 0;
+      for (uint32_t j = 0; j <= num_nodes; j++) {
+        uint32_t node = (home_node + j) % (num_nodes + 1);
+        uint32_t range_id = next_range[node].fetch_add(1);
+        if (range_id < node_ranges[node].size()) {
+          task_id = first_task[node] + range_id;
+          tilegroup_start = node_ranges[node][range_id].start;
+          tilegroup_stop = node_ranges[node][range_id].stop;
+          break;
+        }
+      }
+      // There are as many tasks as ranges
+      PELOTON_ASSERT(tilegroup_start < tilegroup_stop);
+
+      LOG_DEBUG("Task-%u scanning tile groups [%u-%u) on node %u", task_id,
+                tilegroup_start, tilegroup_stop, home_node);
 
       // Time this
       Timer<std::milli> timer;
@@ -247,6 +371,52 @@ void RuntimeFunctions::ExecutePerState(
   latch.Await(0);
 }
 
+void RuntimeFunctions::ExecutePerPartition(
+    void *query_state, executor::ExecutorContext::ThreadStates &thread_states,
+    uint32_t num_partitions, void *func) {
+  using PartitionFunc = void (*)(void *, void *, uint32_t, uint32_t);
+  auto *joiner = reinterpret_cast<PartitionFunc>(func);
+
+  // The worker pool
+  auto &worker_pool = threadpool::MonoQueuePool::GetExecutionInstance();
+
+  // One task per worker, each processing a contiguous range of partitions
+  uint32_t num_tasks = std::min(worker_pool.NumWorkers(), num_partitions);
+  uint32_t num_partitions_per_task = num_partitions / num_tasks;
+
+  // Allocate states for each task
+  thread_states.Allocate(num_tasks);
+
+  // Create count down latch
+  common::synchronization::CountDownLatch latch{num_tasks};
+
+  // Now, submit the tasks
+  for (uint32_t task_id = 0; task_id < num_tasks; task_id++) {
+    bool last_task = (task_id == num_tasks - 1);
+    auto partition_start = task_id * num_partitions_per_task;
+    auto partition_stop = last_task ? num_partitions
+                                    : partition_start + num_partitions_per_task;
+    auto work = [&query_state, &thread_states, &joiner, &latch, task_id,
+                 partition_start, partition_stop]() {
+      LOG_DEBUG("Task-%u joining partitions [%u-%u)", task_id, partition_start,
+                partition_stop);
+
+      // Pull out this task's thread state
+      auto thread_state = thread_states.AccessThreadState(task_id);
+
+      // Invoke join function
+      joiner(query_state, thread_state, partition_start, partition_stop);
+
+      // Count down latch
+      latch.CountDown();
+    };
+    worker_pool.SubmitTask(work);
+  }
+
+  // Wait for everything to finish
+  latch.Await(0);
+}
+
 void RuntimeFunctions::ThrowDivideByZeroException() {
   throw DivideByZeroException("ERROR: division by zero");
 }
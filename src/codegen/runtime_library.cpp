@@ -0,0 +1,261 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// runtime_library.cpp
+//
+// Identification: src/codegen/runtime_library.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "codegen/runtime_library.h"
+
+#include <unordered_set>
+#include <vector>
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "common/logger.h"
+#include "common/macros.h"
+
+#if LLVM_VERSION_GE(4, 0)
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#else
+#include "llvm/Bitcode/ReaderWriter.h"
+#endif
+
+// The embedded bitcode (see cmake/Templates/runtime_bitcode.cpp.in)
+extern "C" const char peloton_runtime_bitcode[];
+extern "C" const char peloton_runtime_bitcode_end[];
+
+namespace peloton {
+namespace codegen {
+
+namespace {
+
+// The size of the largest function, in instructions, that is worth inlining
+constexpr uint32_t kMaxInlineInstructions = 64;
+
+#if LLVM_VERSION_GE(3, 9)
+std::unique_ptr<llvm::Module> ParseBitcode(llvm::StringRef bitcode,
+                                           llvm::LLVMContext &context,
+                                           bool lazy) {
+  llvm::MemoryBufferRef buffer{bitcode, "runtime"};
+#if LLVM_VERSION_GE(4, 0)
+  auto module = lazy ? llvm::getLazyBitcodeModule(buffer, context)
+                     : llvm::parseBitcodeFile(buffer, context);
+  if (!module) {
+    LOG_ERROR("Cannot read the runtime bitcode: %s",
+              llvm::toString(module.takeError()).c_str());
+    return nullptr;
+  }
+#else
+  auto module =
+      lazy ? llvm::getLazyBitcodeModule(
+                 llvm::MemoryBuffer::getMemBuffer(buffer, false), context)
+           : llvm::parseBitcodeFile(buffer, context);
+  if (!module) {
+    LOG_ERROR("Cannot read the runtime bitcode: %s",
+              module.getError().message().c_str());
+    return nullptr;
+  }
+#endif
+  return std::move(module.get());
+}
+#endif
+
+uint32_t CountInstructions(const llvm::Function &func) {
+  uint32_t count = 0;
+  for (const auto &block : func) {
+    count += block.size();
+  }
+  return count;
+}
+
+}  // namespace
+
+RuntimeLibrary::RuntimeLibrary() {
+#if LLVM_VERSION_GE(3, 9)
+  llvm::StringRef embedded{
+      peloton_runtime_bitcode,
+      static_cast<size_t>(peloton_runtime_bitcode_end -
+                          peloton_runtime_bitcode)};
+  if (embedded.empty()) {
+    LOG_DEBUG("No runtime bitcode, runtime functions will not be inlined");
+    return;
+  }
+
+  llvm::LLVMContext context;
+  auto module = ParseBitcode(embedded, context, false);
+  if (module != nullptr) {
+    Prepare(*module);
+  }
+  LOG_INFO("Runtime bitcode with %zu inlinable functions", functions_.size());
+#endif
+}
+
+const std::string *RuntimeLibrary::LookupFunction(
+    const void *func_impl) const {
+  auto iter = functions_.find(func_impl);
+  return iter == functions_.end() ? nullptr : &iter->second;
+}
+
+std::unique_ptr<llvm::Module> RuntimeLibrary::LoadModule(
+    UNUSED_ATTRIBUTE llvm::LLVMContext &context) const {
+#if LLVM_VERSION_GE(3, 9)
+  if (IsAvailable()) {
+    return ParseBitcode(bitcode_, context, true);
+  }
+#endif
+  return nullptr;
+}
+
+void RuntimeLibrary::Prepare(llvm::Module &module) {
+  // Static constructors and the like have run in the runtime already
+  std::vector<llvm::GlobalVariable *> appending;
+  for (auto &global : module.globals()) {
+    if (global.hasAppendingLinkage()) {
+      appending.push_back(&global);
+    }
+  }
+  for (auto *global : appending) {
+    global->eraseFromParent();
+  }
+
+  // Queries use the runtime's globals, not copies of them
+  for (auto &global : module.globals()) {
+    if (!global.isDeclaration() && global.hasExternalLinkage()) {
+      global.setInitializer(nullptr);
+      global.setComdat(nullptr);
+    }
+  }
+
+  // The remaining mutable globals would be copied into every query that uses
+  // them. Find all functions that do, directly or through their callees.
+  std::unordered_set<const llvm::Value *> private_state_users;
+  std::vector<const llvm::Value *> worklist;
+  for (const auto &global : module.globals()) {
+    if (global.isThreadLocal() ||
+        (!global.isDeclaration() && !global.isConstant())) {
+      private_state_users.insert(&global);
+      worklist.push_back(&global);
+    }
+  }
+  while (!worklist.empty()) {
+    const llvm::Value *value = worklist.back();
+    worklist.pop_back();
+    for (const auto *user : value->users()) {
+      const llvm::Value *state_user = user;
+      if (auto *inst = llvm::dyn_cast<llvm::Instruction>(user)) {
+        state_user = inst->getParent()->getParent();
+      } else if (!llvm::isa<llvm::Constant>(user)) {
+        continue;
+      }
+      if (private_state_users.insert(state_user).second) {
+        worklist.push_back(state_user);
+      }
+    }
+  }
+
+  // Pick the small functions that the runtime exports
+  llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+  std::unordered_set<const llvm::Function *> inlinable;
+  for (const auto &func : module) {
+    if (func.isDeclaration() || func.hasLocalLinkage() ||
+        private_state_users.count(&func) != 0 ||
+        CountInstructions(func) > kMaxInlineInstructions) {
+      continue;
+    }
+    std::string symbol = func.getName().str();
+    void *func_impl =
+        llvm::sys::DynamicLibrary::SearchForAddressOfSymbol(symbol);
+    if (func_impl != nullptr) {
+      functions_.emplace(func_impl, symbol);
+      inlinable.insert(&func);
+    }
+  }
+
+  // Other exported functions are called in the runtime. Inline functions and
+  // templates may not have been emitted there, so their code stays.
+  for (auto &func : module) {
+    if (!func.isDeclaration() && !func.hasLocalLinkage() &&
+        !func.hasLinkOnceLinkage() && inlinable.count(&func) == 0) {
+      func.deleteBody();
+      func.setComdat(nullptr);
+    }
+  }
+
+  // Aliases must refer to definitions. Replace those of the functions we just
+  // dropped with declarations.
+  std::vector<llvm::GlobalAlias *> dangling_aliases;
+  for (auto &alias : module.aliases()) {
+    const auto *aliasee = alias.getBaseObject();
+    if (aliasee == nullptr || aliasee->isDeclaration()) {
+      dangling_aliases.push_back(&alias);
+    }
+  }
+  for (auto *alias : dangling_aliases) {
+    auto *func_type = llvm::dyn_cast<llvm::FunctionType>(alias->getValueType());
+    llvm::GlobalValue *decl;
+    if (func_type != nullptr) {
+      decl = llvm::Function::Create(
+          func_type, llvm::GlobalValue::ExternalLinkage, "", &module);
+    } else {
+      decl = new llvm::GlobalVariable(module, alias->getValueType(), false,
+                                      llvm::GlobalValue::ExternalLinkage,
+                                      nullptr, "");
+    }
+    decl->takeName(alias);
+    alias->replaceAllUsesWith(
+        llvm::ConstantExpr::getBitCast(decl, alias->getType()));
+    alias->eraseFromParent();
+  }
+
+  // Drop everything the inlinable functions don't need
+  bool erased = true;
+  while (erased) {
+    erased = false;
+    for (auto iter = module.begin(); iter != module.end();) {
+      llvm::Function &func = *iter++;
+      func.removeDeadConstantUsers();
+      if (func.use_empty() && inlinable.count(&func) == 0) {
+        func.eraseFromParent();
+        erased = true;
+      }
+    }
+    for (auto iter = module.alias_begin(); iter != module.alias_end();) {
+      llvm::GlobalAlias &alias = *iter++;
+      alias.removeDeadConstantUsers();
+      if (alias.use_empty()) {
+        alias.eraseFromParent();
+        erased = true;
+      }
+    }
+    for (auto iter = module.global_begin(); iter != module.global_end();) {
+      llvm::GlobalVariable &global = *iter++;
+      global.removeDeadConstantUsers();
+      if (global.use_empty()) {
+        global.eraseFromParent();
+        erased = true;
+      }
+    }
+  }
+
+  llvm::raw_string_ostream out{bitcode_};
+#if LLVM_VERSION_GE(7, 0)
+  llvm::WriteBitcodeToFile(module, out);
+#else
+  llvm::WriteBitcodeToFile(&module, out);
+#endif
+  out.flush();
+}
+
+}  // namespace codegen
+}  // namespace peloton
@@ -178,6 +178,47 @@ codegen::Value TileGroup::LoadColumn(
   return codegen::Value{type, val, length, is_null};
 }
 
+// Load the raw values of a column for the vector of rows starting at the TID
+llvm::Value *TileGroup::LoadColumnVector(CodeGen &codegen, llvm::Value *tid,
+                                         const TileGroup::ColumnLayout &layout,
+                                         uint32_t vector_size,
+                                         llvm::Value *&is_null) const {
+  const auto &column = schema_.GetColumn(layout.col_id);
+  const auto &sql_type = type::SqlType::LookupType(column.GetType());
+  PELOTON_ASSERT(!sql_type.IsVariableLength() &&
+                 sql_type.TypeId() != peloton::type::TypeId::BOOLEAN);
+
+  llvm::Type *col_type = nullptr, *col_len_type = nullptr;
+  sql_type.GetTypeForMaterialization(codegen, col_type, col_len_type);
+  PELOTON_ASSERT(col_type != nullptr && col_len_type == nullptr);
+
+  // In a columnar tile, the values of consecutive rows are adjacent, so the
+  // vector starts at: col_start + (tid * col_stride)
+  llvm::Value *col_address =
+      codegen->CreateInBoundsGEP(codegen.ByteType(), layout.col_start_ptr,
+                                 codegen->CreateMul(tid, layout.col_stride));
+
+  // Values are only aligned to the size of the column's type
+  auto *vector_type = llvm::VectorType::get(col_type, vector_size);
+  auto *vector_ptr =
+      codegen->CreateBitCast(col_address, vector_type->getPointerTo());
+  uint32_t alignment = col_type->getPrimitiveSizeInBits() / 8;
+  llvm::Value *val = codegen->CreateAlignedLoad(vector_ptr, alignment);
+  val->setName(column.GetName() + ".vec");
+
+  // NULLs are stored as the type's NULL sentinel
+  is_null = nullptr;
+  if (schema_.AllowNull(layout.col_id)) {
+    auto *null_val = codegen->CreateVectorSplat(
+        vector_size, sql_type.GetNullValue(codegen).GetValue());
+    is_null = col_type->isFloatingPointTy()
+                  ? codegen->CreateFCmpUEQ(val, null_val)
+                  : codegen->CreateICmpEQ(val, null_val);
+    is_null->setName(column.GetName() + ".vec.null");
+  }
+  return val;
+}
+
 //===----------------------------------------------------------------------===//
 // TILE GROUP ROW
 //===----------------------------------------------------------------------===//
@@ -207,5 +248,13 @@ TileGroup::TileGroupAccess::Row TileGroup::TileGroupAccess::GetRow(
   return TileGroup::TileGroupAccess::Row{tile_group_, layout_, tid};
 }
 
+llvm::Value *TileGroup::TileGroupAccess::LoadColumnVector(
+    CodeGen &codegen, uint32_t col_idx, llvm::Value *tid, uint32_t vector_size,
+    llvm::Value *&is_null) const {
+  PELOTON_ASSERT(col_idx < layout_.size());
+  return tile_group_.LoadColumnVector(codegen, tid, layout_[col_idx],
+                                      vector_size, is_null);
+}
+
 }  // namespace codegen
 }  // namespace peloton
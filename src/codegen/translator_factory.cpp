@@ -31,6 +31,7 @@
 #include "codegen/operator/hash_translator.h"
 #include "codegen/operator/insert_translator.h"
 #include "codegen/operator/order_by_translator.h"
+#include "codegen/operator/partitioned_hash_join_translator.h"
 #include "codegen/operator/projection_translator.h"
 #include "codegen/operator/table_scan_translator.h"
 #include "codegen/operator/update_translator.h"
@@ -53,6 +54,7 @@
 #include "planner/projection_plan.h"
 #include "planner/seq_scan_plan.h"
 #include "planner/update_plan.h"
+#include "settings/settings_manager.h"
 
 namespace peloton {
 namespace codegen {
@@ -83,7 +85,16 @@ std::unique_ptr<OperatorTranslator> TranslatorFactory::CreateTranslator(
     }
     case PlanNodeType::HASHJOIN: {
       auto &join = static_cast<const planner::HashJoinPlan &>(plan_node);
-      translator = new HashJoinTranslator(join, context, pipeline);
+      // Only the partitioned join can spill, so it is also used whenever
+      // queries run under a memory budget
+      bool partitioned = join.IsPartitioned() ||
+                         settings::SettingsManager::GetInt(
+                             settings::SettingId::query_memory_budget) != 0;
+      if (partitioned && join.GetJoinType() == JoinType::INNER) {
+        translator = new PartitionedHashJoinTranslator(join, context, pipeline);
+      } else {
+        translator = new HashJoinTranslator(join, context, pipeline);
+      }
       break;
     }
     case PlanNodeType::NESTLOOP: {
@@ -12,10 +12,18 @@
 
 #include "codegen/util/csv_scanner.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include <boost/filesystem.hpp>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 #include "common/exception.h"
+#include "common/synchronization/count_down_latch.h"
 #include "executor/executor_context.h"
+#include "threadpool/mono_queue_pool.h"
 #include "type/abstract_pool.h"
 #include "util/string_util.h"
 
@@ -23,6 +31,129 @@ namespace peloton {
 namespace codegen {
 namespace util {
 
+namespace {
+
+// Where a position in the CSV is with respect to quoted sections
+enum class QuoteState : uint8_t { Unquoted = 0, Quoted = 1, QuotedEscape = 2 };
+
+constexpr uint32_t kNumQuoteStates = 3;
+
+// Move the quoting state past the given character
+QuoteState NextQuoteState(QuoteState state, char c, char quote, char escape) {
+  bool in_quote = (state != QuoteState::Unquoted);
+  bool last_was_escape = (state == QuoteState::QuotedEscape);
+  if (in_quote && c == escape) {
+    last_was_escape = !last_was_escape;
+  }
+  if (c == quote && !last_was_escape) {
+    in_quote = !in_quote;
+  }
+  if (c != escape) {
+    last_was_escape = false;
+  }
+  if (!in_quote) {
+    return QuoteState::Unquoted;
+  }
+  return last_was_escape ? QuoteState::QuotedEscape : QuoteState::Quoted;
+}
+
+// Move the quoting state past a character that is neither a quote nor escape
+QuoteState SkipQuoteState(QuoteState state) {
+  return state == QuoteState::QuotedEscape ? QuoteState::Quoted : state;
+}
+
+// Find the first of the three characters in [pos, end), or end if there is
+// none. The characters are compared a vector at a time, and the bitmask of the
+// matches gives the position of the first one.
+char *FindAny(char *pos, const char *end, char c1, char c2, char c3) {
+#if defined(__AVX2__)
+  const __m256i v1 = _mm256_set1_epi8(c1);
+  const __m256i v2 = _mm256_set1_epi8(c2);
+  const __m256i v3 = _mm256_set1_epi8(c3);
+  for (; end - pos >= 32; pos += 32) {
+    auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pos));
+    auto matches = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, v1),
+                        _mm256_cmpeq_epi8(block, v2)),
+        _mm256_cmpeq_epi8(block, v3));
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i w1 = _mm_set1_epi8(c1);
+  const __m128i w2 = _mm_set1_epi8(c2);
+  const __m128i w3 = _mm_set1_epi8(c3);
+  for (; end - pos >= 16; pos += 16) {
+    auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos));
+    auto matches = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, w1), _mm_cmpeq_epi8(block, w2)),
+        _mm_cmpeq_epi8(block, w3));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+#endif
+  for (; pos < end; pos++) {
+    char c = *pos;
+    if (c == c1 || c == c2 || c == c3) {
+      return pos;
+    }
+  }
+  return pos;
+}
+
+// Run the task for every chunk, on the execution pool if there are several
+template <typename Task>
+void RunTasks(uint32_t num_tasks, const Task &task) {
+  if (num_tasks == 1) {
+    task(0);
+    return;
+  }
+  auto &worker_pool = threadpool::MonoQueuePool::GetExecutionInstance();
+  common::synchronization::CountDownLatch latch{num_tasks};
+  for (uint32_t i = 0; i < num_tasks; i++) {
+    worker_pool.SubmitTask([&task, &latch, i] {
+      task(i);
+      latch.CountDown();
+    });
+  }
+  latch.Await(0);
+}
+
+}  // namespace
+
+struct CSVScanner::Chunk {
+  // The bytes of the segment in the chunk
+  char *begin;
+  char *end;
+
+  // The quoting state at the end of the chunk for every state at its beginning
+  QuoteState end_states[kNumQuoteStates];
+
+  // The quoting state at the beginning of the chunk
+  QuoteState start_state;
+
+  // The beginnings of the rows beginning in the chunk, and where the row after
+  // the last of them begins
+  std::vector<char *> rows;
+  char *rows_end;
+
+  // The line number of the first row
+  uint32_t first_line;
+
+  // The columns of the rows, one after the other
+  std::vector<Column> cols;
+
+  // The number of rows split into columns. If it falls short of the rows, the
+  // next row is ill-formatted and this is the error.
+  uint32_t num_parsed;
+  std::string error;
+};
+
 CSVScanner::CSVScanner(peloton::type::AbstractPool &pool,
                        const std::string &file_path,
                        const codegen::type::Type *col_types, uint32_t num_cols,
@@ -32,11 +163,8 @@ CSVScanner::CSVScanner(peloton::type::AbstractPool &pool,
       file_path_(file_path),
       file_(),
       buffer_(nullptr),
-      buffer_pos_(0),
+      buffer_size_(0),
       buffer_end_(0),
-      line_(nullptr),
-      line_len_(0),
-      line_maxlen_(0),
       line_number_(0),
       delimiter_(delimiter),
       quote_(quote),
@@ -62,11 +190,6 @@ CSVScanner::~CSVScanner() {
     buffer_ = nullptr;
   }
 
-  if (line_ != nullptr) {
-    memory_.Free(line_);
-    line_ = nullptr;
-  }
-
   if (cols_ != nullptr) {
     memory_.Free(cols_);
     cols_ = nullptr;
@@ -94,9 +217,27 @@ void CSVScanner::Produce() {
   // Initialize
   Initialize();
 
-  // Loop lines
-  while (char *line = NextLine()) {
-    ProduceCSV(line);
+  // Loop segments
+  uint64_t num_carried = 0;
+  while (true) {
+    bool at_eof = !NextBuffer(num_carried);
+    if (buffer_end_ == 0) {
+      break;
+    }
+
+    uint64_t num_produced = ProduceSegment(at_eof);
+    if (at_eof) {
+      break;
+    }
+
+    // Carry the incomplete last row over to the next segment
+    num_carried = buffer_end_ - num_produced;
+    if (num_produced == 0) {
+      GrowBuffer();
+    } else if (num_carried > 0) {
+      std::memmove(buffer_, buffer_ + num_produced, num_carried);
+      stats_.num_copies++;
+    }
   }
 }
 
@@ -116,258 +257,309 @@ void CSVScanner::Initialize() {
   // The path looks okay, let's try opening it
   file_.Open(file_path_, peloton::util::File::AccessMode::ReadOnly);
 
-  // Allocate buffer space
-  buffer_ = static_cast<char *>(memory_.Allocate(kDefaultBufferSize));
-
-  // Fill read-buffer
-  NextBuffer();
-
-  // Allocate space for the full line, if it doesn't fit into the buffer. We
-  // reserve the last byte for the null-byte terminator.
-  line_ = static_cast<char *>(memory_.Allocate(kDefaultBufferSize));
-  line_len_ = 0;
-  line_maxlen_ = kDefaultBufferSize - 1;
+  // Allocate buffer space. Small files don't need a full segment.
+  buffer_size_ = std::min(static_cast<uint64_t>(kSegmentSize), file_.Size());
+  buffer_size_ =
+      std::max(buffer_size_, static_cast<uint64_t>(kDefaultBufferSize));
+  buffer_ = static_cast<char *>(memory_.Allocate(buffer_size_));
+  buffer_end_ = 0;
 }
 
-bool CSVScanner::NextBuffer() {
-  // Do read
-  buffer_pos_ = 0;
-  buffer_end_ = static_cast<uint32_t>(file_.Read(buffer_, kDefaultBufferSize));
+bool CSVScanner::NextBuffer(uint64_t num_carried) {
+  buffer_end_ = num_carried;
+  while (buffer_end_ < buffer_size_) {
+    // Do read
+    uint64_t num_read =
+        file_.Read(buffer_ + buffer_end_, buffer_size_ - buffer_end_);
 
-  // Update stats
-  stats_.num_reads++;
+    // Update stats
+    stats_.num_reads++;
 
-  return (buffer_end_ != 0);
+    if (num_read == 0) {
+      // We hit en EOF
+      return false;
+    }
+    buffer_end_ += num_read;
+  }
+  return true;
 }
 
-void CSVScanner::AppendToLineBuffer(const char *data, uint32_t len) {
-  PELOTON_ASSERT(len > 0);
-
-  // Short-circuit if we're not appending any data
-  if (len == 0) {
-    return;
+void CSVScanner::GrowBuffer() {
+  // Check if we can even allocate any more bytes
+  if (buffer_size_ >= kMaxAllocSize) {
+    const auto msg = StringUtil::Format(
+        "Line %u in file '%s' exceeds maximum line length: %lu",
+        line_number_ + 1, file_path_.c_str(), kMaxAllocSize);
+    throw Exception(msg);
   }
 
-  if (line_len_ + len > line_maxlen_) {
-    // Check if we can even allocate any more bytes
-    if (static_cast<uint64_t>(len) > kMaxAllocSize - line_len_) {
-      const auto msg = StringUtil::Format(
-          "Line %u in file '%s' exceeds maximum line length: %lu",
-          line_number_ + 1, file_path_.c_str(), kMaxAllocSize);
-      throw Exception(msg);
-    }
+  // Clamp
+  uint64_t new_size =
+      std::min(buffer_size_ * 2, static_cast<uint64_t>(kMaxAllocSize));
+  auto *new_buffer = static_cast<char *>(memory_.Allocate(new_size));
 
-    // The current line buffer isn't large enough to store the new bytes, so we
-    // need to resize it. Let's find an allocation size large enough to fit the
-    // new bytes.
-    uint32_t new_maxlen = line_maxlen_ * 2;
-    while (new_maxlen < len) {
-      new_maxlen *= 2;
-    }
+  // Copy the old data
+  PELOTON_MEMCPY(new_buffer, buffer_, buffer_end_);
 
-    // Clamp
-    new_maxlen = std::min(new_maxlen, static_cast<uint32_t>(kMaxAllocSize));
+  // Free old buffer
+  memory_.Free(buffer_);
 
-    auto *new_line = static_cast<char *>(memory_.Allocate(new_maxlen));
+  buffer_ = new_buffer;
+  buffer_size_ = new_size;
 
-    // Copy the old data
-    PELOTON_MEMCPY(new_line, line_, line_len_);
+  stats_.num_reallocs++;
+}
 
-    // Free old old
-    memory_.Free(line_);
+uint64_t CSVScanner::ProduceSegment(bool at_eof) {
+  char *segment_end = buffer_ + buffer_end_;
+
+  // Split the segment into one chunk per worker, but keep chunks large enough
+  // to be worth handing to a worker
+  auto &worker_pool = threadpool::MonoQueuePool::GetExecutionInstance();
+  uint64_t num_chunks = std::min<uint64_t>(worker_pool.NumWorkers(),
+                                           buffer_end_ / kDefaultBufferSize);
+  num_chunks = std::max<uint64_t>(num_chunks, 1);
+  uint64_t chunk_size = (buffer_end_ + num_chunks - 1) / num_chunks;
+
+  std::vector<Chunk> chunks(num_chunks);
+  for (uint64_t i = 0; i < num_chunks; i++) {
+    chunks[i].begin = buffer_ + std::min(i * chunk_size, buffer_end_);
+    chunks[i].end = buffer_ + std::min((i + 1) * chunk_size, buffer_end_);
+  }
+  const auto num_tasks = static_cast<uint32_t>(num_chunks);
+
+  // A chunk may begin inside a quoted section, which only the chunks before it
+  // can tell. Each chunk works out where every starting state takes it, and
+  // the actual starting states follow from chaining them together.
+  RunTasks(num_tasks, [this, &chunks](uint32_t i) {
+    FindQuoteStates(chunks[i]);
+  });
+  QuoteState state = QuoteState::Unquoted;
+  for (auto &chunk : chunks) {
+    chunk.start_state = state;
+    state = chunk.end_states[static_cast<uint32_t>(state)];
+  }
 
-    // Setup pointers and sizes
-    line_ = new_line;
-    line_maxlen_ = new_maxlen - 1;
+  // Find the rows of the chunks
+  RunTasks(num_tasks, [this, &chunks](uint32_t i) { FindRows(chunks[i]); });
+
+  // The last row may continue in the next segment, unless this is the end of
+  // the file
+  char *produced_end = segment_end;
+  if (!at_eof) {
+    for (auto iter = chunks.rbegin(); iter != chunks.rend(); ++iter) {
+      if (!iter->rows.empty()) {
+        produced_end = iter->rows.back();
+        iter->rows.pop_back();
+        break;
+      }
+    }
+  }
 
-    stats_.num_reallocs++;
+  // Number the rows, and link each chunk to the row after its last one
+  uint32_t line_number = line_number_;
+  char *rows_end = produced_end;
+  for (auto iter = chunks.rbegin(); iter != chunks.rend(); ++iter) {
+    iter->rows_end = rows_end;
+    if (!iter->rows.empty()) {
+      rows_end = iter->rows.front();
+    }
+  }
+  for (auto &chunk : chunks) {
+    chunk.first_line = line_number;
+    line_number += static_cast<uint32_t>(chunk.rows.size());
   }
 
-  // Copy provided data into the line buffer, ensuring null-byte termination.
-  PELOTON_MEMCPY(line_ + line_len_, data, len);
-  line_[line_len_ + len] = '\0';
+  // Split the rows into columns
+  RunTasks(num_tasks, [this, &chunks](uint32_t i) { ParseRows(chunks[i]); });
+
+  // Produce the rows in order
+  for (const auto &chunk : chunks) {
+    const Column *row_cols = chunk.cols.data();
+    for (uint32_t row = 0; row < chunk.num_parsed; row++) {
+      for (uint32_t col_idx = 0; col_idx < num_cols_; col_idx++) {
+        cols_[col_idx].ptr = row_cols[col_idx].ptr;
+        cols_[col_idx].len = row_cols[col_idx].len;
+        cols_[col_idx].is_null = row_cols[col_idx].is_null;
+      }
+      row_cols += num_cols_;
 
-  // Increase the length of the line
-  line_len_ += len;
+      // Invoke callback
+      line_number_++;
+      func_(opaque_state_);
+    }
+    if (chunk.num_parsed < chunk.rows.size()) {
+      throw Exception(chunk.error);
+    }
+  }
 
-  // Track copy stats
-  stats_.num_copies++;
+  return static_cast<uint64_t>(produced_end - buffer_);
 }
 
-// The objective of this function is to find a complete line in the CSV file.
-// The returned value will be a valid pointer to a null-terminated string that
-// is the next line in the CSV to be processed.
-char *CSVScanner::NextLine() {
-  line_len_ = 0;
-
+void CSVScanner::FindQuoteStates(Chunk &chunk) const {
   const char quote = quote_;
   const char escape = (quote_ == escape_ ? static_cast<char>('\0') : escape_);
 
-  bool in_quote = false;
-  bool last_was_escape = false;
-
-  const char *buf = buffer_;
-  uint32_t curr_buffer_pos = buffer_pos_;
+  QuoteState states[kNumQuoteStates] = {
+      QuoteState::Unquoted, QuoteState::Quoted, QuoteState::QuotedEscape};
 
+  // Only quotes and escapes change the state, so skip to them
+  char *pos = chunk.begin;
   while (true) {
-    if (curr_buffer_pos == buffer_end_) {
-      // We need to read more data from the CSV file. But first, we need to copy
-      // all the data in the read-buffer (i.e., [buffer_begin_, buffer_end_] to
-      // the line-buffer.
-      if (buffer_pos_ < curr_buffer_pos) {
-        AppendToLineBuffer(buffer_ + buffer_pos_,
-                           curr_buffer_pos - buffer_pos_);
-        buffer_pos_ = curr_buffer_pos;
+    char *next = FindAny(pos, chunk.end, quote, escape, quote);
+    if (next != pos) {
+      for (auto &state : states) {
+        state = SkipQuoteState(state);
       }
+    }
+    if (next == chunk.end) {
+      break;
+    }
+    for (auto &state : states) {
+      state = NextQuoteState(state, *next, quote, escape);
+    }
+    pos = next + 1;
+  }
 
-      // Reset positions
-      curr_buffer_pos = 0;
+  std::copy(states, states + kNumQuoteStates, chunk.end_states);
+}
 
-      // Now, read more data
-      if (!NextBuffer()) {
-        // We hit en EOF
-        break;
-      }
-    }
+void CSVScanner::FindRows(Chunk &chunk) const {
+  const char quote = quote_;
+  const char escape = (quote_ == escape_ ? static_cast<char>('\0') : escape_);
 
-    // Read character
-    char c = buf[curr_buffer_pos++];
+  // A row begins after a new-line character outside a quoted section. The
+  // segment always begins with a row.
+  QuoteState state = chunk.start_state;
+  char *pos = chunk.begin;
+  if (pos != chunk.end && state == QuoteState::Unquoted &&
+      (pos == buffer_ || pos[-1] == '\n')) {
+    chunk.rows.push_back(pos);
+  }
 
-    if (in_quote && c == escape) {
-      last_was_escape = !last_was_escape;
-    }
-    if (c == quote && !last_was_escape) {
-      in_quote = !in_quote;
-    }
-    if (c != escape) {
-      last_was_escape = false;
+  while (true) {
+    char *next = FindAny(pos, chunk.end, '\n', quote, escape);
+    if (next != pos) {
+      state = SkipQuoteState(state);
     }
-
-    // Process the new-line character. If we a new-line and we're not currently
-    // in a quoted section, we're done.
-    if (c == '\n' && !in_quote) {
+    if (next == chunk.end) {
       break;
     }
+    char c = *next;
+    pos = next + 1;
+    state = NextQuoteState(state, c, quote, escape);
+    if (c == '\n' && state == QuoteState::Unquoted && pos != chunk.end) {
+      chunk.rows.push_back(pos);
+    }
   }
+}
 
-  // Flush remaining valid bytes
-  if (buffer_pos_ < curr_buffer_pos) {
-    AppendToLineBuffer(buffer_ + buffer_pos_, curr_buffer_pos - buffer_pos_);
-    buffer_pos_ = curr_buffer_pos;
-  }
-
-  // Increment line number
-  line_number_++;
+void CSVScanner::ParseRows(Chunk &chunk) const {
+  chunk.cols.resize(chunk.rows.size() * num_cols_);
+  chunk.num_parsed = 0;
 
-  // If we didn't transfer any bytes to the line buffer, we must have reached an
-  // EOF. If so, return null indicating there are no more lines.
-  if (line_len_ == 0) {
-    return nullptr;
-  }
+  // Tasks can't throw, so hold on to the error until the rows before the
+  // ill-formatted row are produced
+  try {
+    for (uint32_t row = 0; row < chunk.rows.size(); row++) {
+      char *row_end =
+          (row + 1 < chunk.rows.size() ? chunk.rows[row + 1] : chunk.rows_end);
 
-  // A full line has been transferred to the line buffer, but we also copied the
-  // newline character. Strip it off now.
-  line_len_--;
-  line_[line_len_] = '\0';
+      // Strip off the new-line character
+      if (row_end != chunk.rows[row] && row_end[-1] == '\n') {
+        row_end--;
+      }
 
-  // Done
-  return line_;
+      ParseRow(chunk.rows[row], row_end, chunk.first_line + row + 1,
+               &chunk.cols[row * num_cols_]);
+      chunk.num_parsed++;
+    }
+  } catch (const Exception &e) {
+    chunk.error = e.what();
+  }
 }
 
-void CSVScanner::ProduceCSV(char *line) {
+void CSVScanner::ParseRow(char *iter, char *end, uint32_t line_number,
+                          Column *cols) const {
   const char delimiter = delimiter_;
   const char quote = quote_;
   const char escape = escape_;
 
-  // The iterator over characters in the line
-  char *iter = line;
-
   for (uint32_t col_idx = 0; col_idx < num_cols_; col_idx++) {
     char *col_begin = iter;
-    char *col_end = nullptr;
 
-    // We need to move col_end to the end of the column's data. Along the way,
-    // we may need to shift data down due to quotes and escapes. Inspired by
+    // We need to move out to the end of the column's data. Along the way, we
+    // may need to shift data down due to quotes and escapes. Inspired by
     // Postgres.
-    {
-      char *out = col_begin;
-      while (true) {
-        // This first loop looks for either the delimiter character or the end
-        // of the line, indicating the end of a columns data. It breaks out of
-        // the loop if a quote character is found. It flows into a second loop
-        // whose only purpose is to find the end of the quoted section.
-        while (true) {
-          char c = *iter++;
-
-          // If we see the delimiter character, or the end of the string,
-          // finish
-          if (c == delimiter || c == '\0') {
-            col_end = out;
-            iter--;
-            goto colend;
-          }
+    char *out = col_begin;
+    while (true) {
+      // Look for either the delimiter character or the end of the line,
+      // indicating the end of a columns data, or a quote character, which
+      // starts a quoted section.
+      char *next = FindAny(iter, end, delimiter, quote, delimiter);
+      if (out != iter) {
+        std::memmove(out, iter, next - iter);
+      }
+      out += next - iter;
+      iter = next;
 
-          // If we see a quote character, move to the second loop to find the
-          // closing quote.
-          if (c == quote) {
-            break;
-          }
+      if (iter == end || *iter == delimiter) {
+        break;
+      }
 
-          *out++ = c;
+      // Find the closing quote
+      iter++;
+      while (true) {
+        next = FindAny(iter, end, quote, escape, quote);
+        std::memmove(out, iter, next - iter);
+        out += next - iter;
+        iter = next;
+
+        // If we see the end of the line *within* a quoted section, throw
+        // error
+        if (iter == end) {
+          throw Exception(StringUtil::Format(
+              "unterminated CSV quoted field at %u", col_idx));
         }
 
-        while (true) {
-          char c = *iter++;
-
-          // If we see the end of the line *within* a quoted section, throw
-          // error
-          if (c == '\0') {
-            throw Exception(StringUtil::Format(
-                "unterminated CSV quoted field at %u", col_idx));
-          }
-
-          // If we see an escape character within a quoted section, we need to
-          // check if the following character is a quote. If so, we must
-          // escape it
-          if (c == escape) {
-            char next = *iter;
-            if (next == quote || next == escape) {
-              *out++ = next;
-              iter++;
-              continue;
-            }
-          }
-
-          // If we see the closing quote, we're done.
-          if (c == quote) {
-            break;
+        char c = *iter++;
+
+        // If we see an escape character within a quoted section, we need to
+        // check if the following character is a quote. If so, we must
+        // escape it
+        if (c == escape && iter != end) {
+          char next_char = *iter;
+          if (next_char == quote || next_char == escape) {
+            *out++ = next_char;
+            iter++;
+            continue;
           }
+        }
 
-          *out++ = c;
+        // If we see the closing quote, we're done.
+        if (c == quote) {
+          break;
         }
+
+        *out++ = c;
       }
     }
 
-  colend:
     // If we've reached the of the line, but haven't setup all the columns, then
     // we're missing data for the remaining columns and should throw an error.
-    if (*iter == '\0' && col_idx != (num_cols_ - 1)) {
-      throw Exception(
-          StringUtil::Format("missing data for column %u on line %u",
-                             (col_idx + 2), line_number_));
+    if (iter == end && col_idx != (num_cols_ - 1)) {
+      throw Exception(StringUtil::Format(
+          "missing data for column %u on line %u", (col_idx + 2), line_number));
     }
 
     // Let's setup the columns
-    cols_[col_idx].ptr = col_begin;
-    cols_[col_idx].len = static_cast<uint32_t>(col_end - col_begin);
-    cols_[col_idx].is_null = (cols_[col_idx].len == 0);
+    cols[col_idx].ptr = col_begin;
+    cols[col_idx].len = static_cast<uint32_t>(out - col_begin);
+    cols[col_idx].is_null = (cols[col_idx].len == 0);
 
     // Eat delimiter, moving to next column
     iter++;
   }
-
-  // Invoke callback
-  func_(opaque_state_);
 }
 
 }  // namespace util
@@ -12,6 +12,8 @@
 
 #include "codegen/util/hash_table.h"
 
+#include <algorithm>
+
 #include "common/platform.h"
 #include "type/abstract_pool.h"
 
@@ -279,6 +281,33 @@ void HashTable::MergeLazyUnfinished(HashTable &other) {
   other.entry_buffer_.TransferMemoryBlocks(entry_buffer_);
 }
 
+void HashTable::BuildFromEntries(Entry *head, uint64_t num_elems) {
+  // Size the directory for a 50% load factor, reusing the current one if it
+  // already has the right size
+  uint64_t dir_size =
+      NextPowerOf2(std::max<uint64_t>(kDefaultNumElements, num_elems)) * 2;
+  uint64_t alloc_size = sizeof(Entry *) * dir_size;
+  if (dir_size != directory_size_) {
+    memory_.Free(directory_);
+    directory_ = static_cast<Entry **>(memory_.Allocate(alloc_size));
+    directory_size_ = dir_size;
+    directory_mask_ = directory_size_ - 1;
+  }
+  PELOTON_MEMSET(directory_, 0, alloc_size);
+
+  num_elems_ = num_elems;
+  capacity_ = directory_size_ / 2;
+
+  // Now insert all elements into the directory
+  while (head != nullptr) {
+    uint64_t index = head->hash & directory_mask_;
+    Entry *next = head->next;
+    head->next = directory_[index];
+    directory_[index] = head;
+    head = next;
+  }
+}
+
 void HashTable::Resize() {
   // Sanity check
   PELOTON_ASSERT(NeedsResize());
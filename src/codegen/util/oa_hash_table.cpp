@@ -14,6 +14,7 @@
 
 #include "common/logger.h"
 #include "common/platform.h"
+#include "storage/backend_manager.h"
 
 namespace peloton {
 namespace codegen {
@@ -43,7 +44,9 @@ OAHashTable::OAHashTable(uint64_t key_size, uint64_t value_size,
 
   // Create bucket array
   entry_size_ = sizeof(HashEntry) + key_size_ + value_size_;
-  buckets_ = static_cast<HashEntry *>(malloc(entry_size_ * num_buckets_));
+  buckets_ = static_cast<HashEntry *>(
+      storage::BackendManager::GetInstance().AllocateTransient(entry_size_ *
+                                                               num_buckets_));
 
   // Set status code of all buckets to FREE
   InitializeArray(buckets_);
@@ -70,7 +73,8 @@ OAHashTable::~OAHashTable() {
   }
 
   // Free main buckets array
-  free(buckets_);
+  storage::BackendManager::GetInstance().ReleaseTransient(
+      buckets_, entry_size_ * num_buckets_);
 }
 
 void OAHashTable::Init(OAHashTable &table, uint64_t key_size,
@@ -301,7 +305,9 @@ void OAHashTable::Resize(HashEntry **entry_p_p) {
   resize_threshold_ <<= 1;
 
   // Allocate the new array
-  char *new_buckets = static_cast<char *>(malloc(entry_size_ * num_buckets_));
+  auto &backend_manager = storage::BackendManager::GetInstance();
+  char *new_buckets = static_cast<char *>(
+      backend_manager.AllocateTransient(entry_size_ * num_buckets_));
 
   // Set it all to status code FREE
   InitializeArray(reinterpret_cast<HashEntry *>(new_buckets));
@@ -367,7 +373,8 @@ void OAHashTable::Resize(HashEntry **entry_p_p) {
   }
 
   // Free the old array after probing of all elements, and then update
-  free(buckets_);
+  backend_manager.ReleaseTransient(buckets_,
+                                   entry_size_ * (num_buckets_ >> 1));
   buckets_ = reinterpret_cast<HashEntry *>(new_buckets);
 }
 
@@ -0,0 +1,323 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// radix_partitioner.cpp
+//
+// Identification: src/codegen/util/radix_partitioner.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "codegen/util/radix_partitioner.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "common/platform.h"
+#include "type/abstract_pool.h"
+
+namespace peloton {
+namespace codegen {
+namespace util {
+
+static const uint32_t kBlockSize = 16 * 1024;
+
+RadixPartitioner::RadixPartitioner(::peloton::type::AbstractPool &memory,
+                                   uint32_t tuple_size, uint32_t num_radix_bits,
+                                   executor::ExecutorContext *exec_ctx)
+    : memory_(memory),
+      entry_size_(HashTable::Entry::Size(tuple_size, 0)),
+      num_partitions_(1u << num_radix_bits),
+      radix_shift_(64 - num_radix_bits),
+      num_elems_(0),
+      exec_ctx_(exec_ctx),
+      num_spilled_(0) {
+  PELOTON_ASSERT(num_radix_bits > 0 && num_radix_bits <= kMaxRadixBits);
+
+  // Each block and each write-combine buffer holds at least one entry
+  block_entries_ = std::max(1u, kBlockSize / entry_size_);
+  buffer_entries_ = std::max(1u, kWriteCombineSize / entry_size_);
+
+  uint64_t partitions_size = sizeof(Partition) * num_partitions_;
+  partitions_ = static_cast<Partition *>(memory_.Allocate(partitions_size));
+  PELOTON_MEMSET(partitions_, 0, partitions_size);
+
+  uint64_t buffers_size =
+      static_cast<uint64_t>(num_partitions_) * buffer_entries_ * entry_size_;
+  buffers_ = static_cast<char *>(memory_.Allocate(buffers_size));
+}
+
+RadixPartitioner::~RadixPartitioner() {
+  for (uint32_t i = 0; i < num_partitions_; i++) {
+    ReleasePartition(i);
+  }
+  memory_.Free(partitions_);
+  memory_.Free(buffers_);
+}
+
+void RadixPartitioner::Init(RadixPartitioner &partitioner,
+                            executor::ExecutorContext &exec_ctx,
+                            uint32_t tuple_size, uint32_t num_radix_bits) {
+  new (&partitioner) RadixPartitioner(*exec_ctx.GetPool(), tuple_size,
+                                      num_radix_bits, &exec_ctx);
+}
+
+void RadixPartitioner::Destroy(RadixPartitioner &partitioner) {
+  partitioner.~RadixPartitioner();
+}
+
+char *RadixPartitioner::Insert(uint64_t hash) {
+  uint32_t partition = PartitionOf(hash);
+  auto &part = partitions_[partition];
+
+  // Make room in the write-combine buffer, if needed
+  if (part.num_buffered == buffer_entries_) {
+    FlushBuffer(partition);
+  }
+
+  char *slot = buffers_ +
+               (static_cast<uint64_t>(partition) * buffer_entries_ +
+                part.num_buffered) *
+                   entry_size_;
+  part.num_buffered++;
+  part.num_elems++;
+  num_elems_++;
+
+  auto *entry = reinterpret_cast<HashTable::Entry *>(slot);
+  entry->hash = hash;
+  entry->next = nullptr;
+  return entry->data;
+}
+
+void RadixPartitioner::FlushBuffer(uint32_t partition) {
+  auto &part = partitions_[partition];
+  const char *buffer = buffers_ + static_cast<uint64_t>(partition) *
+                                      buffer_entries_ * entry_size_;
+
+  uint32_t flushed = 0;
+  while (flushed < part.num_buffered) {
+    // Allocate a new block if the current one is full
+    if (part.head == nullptr || part.head->num_entries == block_entries_) {
+      // Make room on disk if the query exceeds its memory budget
+      if (exec_ctx_ != nullptr && part.head != nullptr &&
+          exec_ctx_->ExceedsMemoryBudget()) {
+        SpillPartition(partition);
+      }
+
+      uint64_t block_size =
+          sizeof(Block) + static_cast<uint64_t>(block_entries_) * entry_size_;
+      auto *block = static_cast<Block *>(memory_.Allocate(block_size));
+      block->next = part.head;
+      block->num_entries = 0;
+      part.head = block;
+      if (part.tail == nullptr) {
+        part.tail = block;
+      }
+    }
+
+    // Copy as many entries as fit into the block
+    Block *block = part.head;
+    uint32_t n = std::min(part.num_buffered - flushed,
+                          block_entries_ - block->num_entries);
+    PELOTON_MEMCPY(block->data + block->num_entries * entry_size_,
+                   buffer + flushed * entry_size_, n * entry_size_);
+    block->num_entries += n;
+    flushed += n;
+  }
+  part.num_buffered = 0;
+}
+
+void RadixPartitioner::SpillPartition(uint32_t partition) {
+  auto &part = partitions_[partition];
+
+  // All partitions spill into the same file
+  if (spill_files_.empty()) {
+    spill_files_.emplace_back(
+        new ::peloton::util::SpillFile(exec_ctx_->GetSpillDirectory()));
+    spilled_.resize(num_partitions_);
+  }
+  auto *file = spill_files_.front().get();
+
+  // The blocks are appended back to back, forming a single segment
+  Segment segment{file, file->Size(), 0};
+  Block *block = part.head;
+  while (block != nullptr) {
+    Block *next = block->next;
+    file->Append(block->data,
+                 static_cast<uint64_t>(block->num_entries) * entry_size_);
+    segment.num_entries += block->num_entries;
+    memory_.Free(block);
+    block = next;
+  }
+  part.head = part.tail = nullptr;
+
+  spilled_[partition].push_back(segment);
+  num_spilled_ += segment.num_entries;
+  exec_ctx_->RecordSpill(segment.num_entries * entry_size_);
+}
+
+void RadixPartitioner::LoadPartition(uint32_t partition) {
+  auto &segments = spilled_[partition];
+
+  uint64_t num_entries = 0;
+  for (const auto &segment : segments) {
+    num_entries += segment.num_entries;
+  }
+  PELOTON_ASSERT(num_entries <= std::numeric_limits<uint32_t>::max());
+
+  // Read all segments into a single block
+  uint64_t block_size = sizeof(Block) + num_entries * entry_size_;
+  auto *block = static_cast<Block *>(memory_.Allocate(block_size));
+  block->num_entries = 0;
+  for (const auto &segment : segments) {
+    segment.file->Read(segment.offset,
+                       block->data + block->num_entries * entry_size_,
+                       segment.num_entries * entry_size_);
+    block->num_entries += static_cast<uint32_t>(segment.num_entries);
+  }
+
+  auto &part = partitions_[partition];
+  block->next = part.head;
+  part.head = block;
+  if (part.tail == nullptr) {
+    part.tail = block;
+  }
+
+  segments.clear();
+}
+
+void RadixPartitioner::FlushBuffers() {
+  for (uint32_t i = 0; i < num_partitions_; i++) {
+    if (partitions_[i].num_buffered > 0) {
+      FlushBuffer(i);
+    }
+  }
+}
+
+void RadixPartitioner::TransferPartitions(
+    const executor::ExecutorContext::ThreadStates &thread_states,
+    uint32_t partitioner_offset) {
+  for (uint32_t i = 0; i < thread_states.NumThreads(); i++) {
+    auto *partitioner = reinterpret_cast<RadixPartitioner *>(
+        thread_states.AccessThreadState(i) + partitioner_offset);
+    partitioner->FlushBuffers();
+    StealPartitions(*partitioner);
+  }
+}
+
+void RadixPartitioner::StealPartitions(RadixPartitioner &other) {
+  PELOTON_ASSERT(other.num_partitions_ == num_partitions_);
+  PELOTON_ASSERT(other.entry_size_ == entry_size_);
+  for (uint32_t i = 0; i < num_partitions_; i++) {
+    auto &part = partitions_[i];
+    auto &other_part = other.partitions_[i];
+
+    // The segments the other partitioner spilled become ours
+    if (!other.spilled_.empty() && !other.spilled_[i].empty()) {
+      if (spilled_.empty()) {
+        spilled_.resize(num_partitions_);
+      }
+      auto &segments = other.spilled_[i];
+      spilled_[i].insert(spilled_[i].end(), segments.begin(), segments.end());
+      part.num_elems += other_part.num_elems;
+      other_part.num_elems = 0;
+      segments.clear();
+    }
+
+    if (other_part.head == nullptr) {
+      continue;
+    }
+
+    // Append our blocks to the chain of the other partition. Its (possibly
+    // partially filled) head block becomes ours.
+    other_part.tail->next = part.head;
+    if (part.tail == nullptr) {
+      part.tail = other_part.tail;
+    }
+    part.head = other_part.head;
+    part.num_elems += other_part.num_elems;
+
+    other_part.head = other_part.tail = nullptr;
+    other_part.num_elems = 0;
+  }
+  num_elems_ += other.num_elems_;
+  other.num_elems_ = 0;
+
+  // Take over the files the segments are stored in
+  for (auto &file : other.spill_files_) {
+    spill_files_.emplace_back(std::move(file));
+  }
+  other.spill_files_.clear();
+  num_spilled_ += other.num_spilled_;
+  other.num_spilled_ = 0;
+}
+
+HashTable::Entry *RadixPartitioner::LinkPartition(uint32_t partition) {
+  PELOTON_ASSERT(partitions_[partition].num_buffered == 0);
+
+  // Bring back what we've spilled
+  if (!spilled_.empty() && !spilled_[partition].empty()) {
+    LoadPartition(partition);
+  }
+
+  HashTable::Entry *head = nullptr;
+  for (Block *block = partitions_[partition].head; block != nullptr;
+       block = block->next) {
+    // Link the entries of the block back to front, so the list ends up in
+    // storage order within each block
+    for (uint32_t i = block->num_entries; i > 0; i--) {
+      auto *entry = reinterpret_cast<HashTable::Entry *>(
+          block->data + static_cast<uint64_t>(i - 1) * entry_size_);
+      entry->next = head;
+      head = entry;
+    }
+  }
+  return head;
+}
+
+void RadixPartitioner::BuildPartitionTable(uint32_t partition,
+                                           HashTable &table) {
+  table.BuildFromEntries(LinkPartition(partition), PartitionSize(partition));
+}
+
+void RadixPartitioner::ReleasePartition(uint32_t partition) {
+  auto &part = partitions_[partition];
+  Block *block = part.head;
+  while (block != nullptr) {
+    Block *next = block->next;
+    memory_.Free(block);
+    block = next;
+  }
+  part.head = part.tail = nullptr;
+  part.num_buffered = 0;
+
+  // Forget about the entries on disk, too
+  if (!spilled_.empty()) {
+    spilled_[partition].clear();
+  }
+
+  // Partitions are released concurrently by parallel joins, so the total
+  // number of elements is left alone
+  part.num_elems = 0;
+}
+
+uint32_t RadixPartitioner::ChooseRadixBits(uint64_t num_tuples,
+                                           uint32_t tuple_size) {
+  // A partition's hash table holds its entries plus a directory with two
+  // slots per entry
+  uint64_t input_size =
+      num_tuples *
+      (HashTable::Entry::Size(tuple_size, 0) + 2 * sizeof(HashTable::Entry *));
+  uint32_t bits = 1;
+  while (bits < kMaxRadixBits &&
+         (input_size >> bits) > kTargetPartitionSize) {
+    bits++;
+  }
+  return bits;
+}
+
+}  // namespace util
+}  // namespace codegen
+}  // namespace peloton
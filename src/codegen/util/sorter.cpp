@@ -24,7 +24,7 @@ namespace codegen {
 namespace util {
 
 Sorter::Sorter(::peloton::type::AbstractPool &memory, ComparisonFunction func,
-               uint32_t tuple_size)
+               uint32_t tuple_size, executor::ExecutorContext *exec_ctx)
     : memory_(memory),
       cmp_func_(func),
       tuple_size_(tuple_size),
@@ -32,30 +32,23 @@ Sorter::Sorter(::peloton::type::AbstractPool &memory, ComparisonFunction func,
       buffer_end_(nullptr),
       next_alloc_size_(kInitialBufferSize),
       tuples_start_(nullptr),
-      tuples_end_(nullptr) {
+      tuples_end_(nullptr),
+      exec_ctx_(exec_ctx) {
   // No memory allocation
   LOG_DEBUG("Initialized Sorter for tuples of size %u bytes", tuple_size_);
 }
 
 Sorter::~Sorter() {
-  uint64_t total_alloc = 0;
-  for (const auto &iter : blocks_) {
-    void *block = iter.first;
-    total_alloc += iter.second;
-    PELOTON_ASSERT(block != nullptr);
-    memory_.Free(block);
-  }
-  buffer_pos_ = buffer_end_ = nullptr;
+  LOG_DEBUG("Cleaning up %zu tuples from %zu blocks of memory", tuples_.size(),
+            blocks_.size());
+  FreeMemoryBlocks();
   tuples_start_ = tuples_end_ = nullptr;
   next_alloc_size_ = 0;
-
-  LOG_DEBUG("Cleaned up %zu tuples from %zu blocks of memory (%.2lf KB)",
-            tuples_.size(), blocks_.size(), total_alloc / 1024.0);
 }
 
 void Sorter::Init(Sorter &sorter, executor::ExecutorContext &exec_ctx,
                   ComparisonFunction func, uint32_t tuple_size) {
-  new (&sorter) Sorter(*exec_ctx.GetPool(), func, tuple_size);
+  new (&sorter) Sorter(*exec_ctx.GetPool(), func, tuple_size, &exec_ctx);
 }
 
 void Sorter::Destroy(Sorter &sorter) { sorter.~Sorter(); }
@@ -76,6 +69,15 @@ char *Sorter::StoreInputTuple() {
 }
 
 void Sorter::Sort() {
+  // If we've spilled before, the remaining tuples become the last run
+  if (!runs_.empty()) {
+    if (!tuples_.empty()) {
+      SpillRun();
+    }
+    MergeRuns();
+    return;
+  }
+
   // Short-circuit
   if (tuples_.empty()) {
     return;
@@ -131,12 +133,31 @@ void Sorter::SortParallel(
     uint32_t sorter_offset) {
   // Collect all sorter instances
   uint64_t num_tuples = 0;
+  bool spilled = false;
   std::vector<Sorter *> sorters;
-  thread_states.ForEach<Sorter>(sorter_offset,
-                                [&num_tuples, &sorters](Sorter *sorter) {
-                                  sorters.push_back(sorter);
-                                  num_tuples += sorter->NumTuples();
-                                });
+  thread_states.ForEach<Sorter>(
+      sorter_offset, [this, &num_tuples, &spilled, &sorters](Sorter *sorter) {
+        sorters.push_back(sorter);
+        num_tuples += sorter->NumTuples();
+        if (sorter->NumRuns() > 0) {
+          spilled = true;
+          exec_ctx_ = (exec_ctx_ != nullptr ? exec_ctx_ : sorter->exec_ctx_);
+        }
+      });
+
+  // If any thread-local sorter exceeded the memory budget, the input doesn't
+  // fit into memory. Write out everything as sorted runs and merge them here.
+  if (spilled) {
+    for (auto *sorter : sorters) {
+      if (sorter->NumTuples() > 0) {
+        sorter->exec_ctx_ = exec_ctx_;
+        sorter->SpillRun();
+      }
+      sorter->TransferRuns(*this);
+    }
+    MergeRuns();
+    return;
+  }
 
   // The worker pool we use to execute parallel work
   auto &work_pool = threadpool::MonoQueuePool::GetExecutionInstance();
@@ -314,6 +335,13 @@ void Sorter::MakeRoomForNewTuple() {
     return;
   }
 
+  // If the query exceeds its memory budget, free up our blocks by writing
+  // the tuples collected so far to disk
+  if (exec_ctx_ != nullptr && !tuples_.empty() &&
+      exec_ctx_->ExceedsMemoryBudget()) {
+    SpillRun();
+  }
+
   PELOTON_ASSERT(next_alloc_size_ >= tuple_size_);
 
   LOG_TRACE("Allocating block of size %.2lf KB ...", next_alloc_size_ / 1024.0);
@@ -339,6 +367,192 @@ void Sorter::TransferMemoryBlocks(Sorter &target) {
   blocks_.clear();
 }
 
+void Sorter::FreeMemoryBlocks() {
+  for (const auto &iter : blocks_) {
+    void *block = iter.first;
+    PELOTON_ASSERT(block != nullptr);
+    memory_.Free(block);
+  }
+  blocks_.clear();
+  buffer_pos_ = buffer_end_ = nullptr;
+}
+
+void Sorter::SpillRun() {
+  PELOTON_ASSERT(!tuples_.empty());
+
+  Timer<std::milli> timer;
+  timer.Start();
+
+  // Sort the tuples we have in memory
+  auto cmp = [this](char *l, char *r) { return cmp_func_(l, r) < 0; };
+  std::sort(tuples_.begin(), tuples_.end(), cmp);
+
+  // All runs of a sorter go into the same file
+  if (run_files_.empty()) {
+    run_files_.emplace_back(
+        new ::peloton::util::SpillFile(exec_ctx_->GetSpillDirectory()));
+  }
+  auto *file = run_files_.front().get();
+
+  // Write the tuples out in sorted order, a buffer at a time
+  uint64_t tuples_per_buffer =
+      std::max<uint64_t>(1, kSpillBufferSize / tuple_size_);
+  std::vector<char> buffer(tuples_per_buffer * tuple_size_);
+  uint64_t run_offset = file->Size();
+  for (uint64_t i = 0; i < tuples_.size(); i += tuples_per_buffer) {
+    uint64_t n = std::min<uint64_t>(tuples_per_buffer, tuples_.size() - i);
+    for (uint64_t j = 0; j < n; j++) {
+      PELOTON_MEMCPY(buffer.data() + j * tuple_size_, tuples_[i + j],
+                     tuple_size_);
+    }
+    file->Append(buffer.data(), n * tuple_size_);
+  }
+  runs_.push_back(Run{file, run_offset, tuples_.size()});
+
+  uint64_t run_size = tuples_.size() * tuple_size_;
+  exec_ctx_->RecordSpill(run_size);
+
+  // Release the memory, and start over with small blocks
+  tuples_.clear();
+  FreeMemoryBlocks();
+  next_alloc_size_ = kInitialBufferSize;
+
+  timer.Stop();
+  LOG_DEBUG("Spilled run #%zu of %.2lf KB in %.2f ms", runs_.size(),
+            run_size / 1024.0, timer.GetDuration());
+}
+
+namespace {
+
+// Reads the tuples of a sorted run sequentially, a buffer at a time
+class RunReader {
+ public:
+  RunReader(const Sorter::Run &run, uint32_t tuple_size, uint64_t buffer_size)
+      : run_(run),
+        tuple_size_(tuple_size),
+        buffer_(std::max<uint64_t>(1, buffer_size / tuple_size) * tuple_size),
+        next_tuple_(0),
+        buffer_pos_(nullptr),
+        buffer_end_(nullptr) {
+    Advance();
+  }
+
+  // The current tuple, NULL if the run is exhausted
+  const char *Current() const { return buffer_pos_; }
+
+  // Move to the next tuple in the run
+  void Advance() {
+    if (buffer_pos_ != nullptr) {
+      buffer_pos_ += tuple_size_;
+      if (buffer_pos_ != buffer_end_) {
+        return;
+      }
+    }
+
+    // Refill the buffer
+    uint64_t remaining = run_.num_tuples - next_tuple_;
+    if (remaining == 0) {
+      buffer_pos_ = buffer_end_ = nullptr;
+      return;
+    }
+    uint64_t n = std::min<uint64_t>(remaining, buffer_.size() / tuple_size_);
+    run_.file->Read(run_.offset + next_tuple_ * tuple_size_, buffer_.data(),
+                    n * tuple_size_);
+    next_tuple_ += n;
+    buffer_pos_ = buffer_.data();
+    buffer_end_ = buffer_pos_ + n * tuple_size_;
+  }
+
+ private:
+  const Sorter::Run run_;
+  const uint32_t tuple_size_;
+  std::vector<char> buffer_;
+  uint64_t next_tuple_;
+  char *buffer_pos_;
+  char *buffer_end_;
+};
+
+}  // namespace
+
+void Sorter::MergeRuns() {
+  PELOTON_ASSERT(tuples_.empty());
+
+  Timer<std::milli> timer;
+  timer.Start();
+
+  // Open all runs
+  uint64_t num_tuples = 0;
+  std::vector<std::unique_ptr<RunReader>> readers;
+  for (const auto &run : runs_) {
+    readers.emplace_back(new RunReader(run, tuple_size_, kSpillBufferSize));
+    num_tuples += run.num_tuples;
+  }
+
+  // The heap yields the reader with the smallest current tuple
+  auto heap_cmp = [this](const RunReader *l, const RunReader *r) {
+    return cmp_func_(l->Current(), r->Current()) > 0;
+  };
+  std::priority_queue<RunReader *, std::vector<RunReader *>,
+                      decltype(heap_cmp)> heap(heap_cmp);
+  for (auto &reader : readers) {
+    if (reader->Current() != nullptr) {
+      heap.push(reader.get());
+    }
+  }
+
+  // Merge into the output file
+  output_file_.reset(
+      new ::peloton::util::SpillFile(exec_ctx_->GetSpillDirectory()));
+  std::vector<char> buffer(
+      std::max<uint64_t>(1, kSpillBufferSize / tuple_size_) * tuple_size_);
+  uint64_t buffer_pos = 0;
+  while (!heap.empty()) {
+    RunReader *reader = heap.top();
+    heap.pop();
+    PELOTON_MEMCPY(buffer.data() + buffer_pos, reader->Current(), tuple_size_);
+    buffer_pos += tuple_size_;
+    if (buffer_pos == buffer.size()) {
+      output_file_->Append(buffer.data(), buffer_pos);
+      buffer_pos = 0;
+    }
+    reader->Advance();
+    if (reader->Current() != nullptr) {
+      heap.push(reader);
+    }
+  }
+  if (buffer_pos > 0) {
+    output_file_->Append(buffer.data(), buffer_pos);
+  }
+  exec_ctx_->RecordSpill(output_file_->Size());
+
+  // The runs aren't needed anymore
+  readers.clear();
+  runs_.clear();
+  run_files_.clear();
+
+  // Point the tuples into the mapped output
+  char *output = output_file_->Map();
+  tuples_.resize(num_tuples);
+  for (uint64_t i = 0; i < num_tuples; i++) {
+    tuples_[i] = output + i * tuple_size_;
+  }
+  tuples_start_ = tuples_.data();
+  tuples_end_ = tuples_start_ + tuples_.size();
+
+  timer.Stop();
+  LOG_DEBUG("Merged %zu tuples from sorted runs in %.2f ms", tuples_.size(),
+            timer.GetDuration());
+}
+
+void Sorter::TransferRuns(Sorter &target) {
+  for (auto &file : run_files_) {
+    target.run_files_.emplace_back(std::move(file));
+  }
+  target.runs_.insert(target.runs_.end(), runs_.begin(), runs_.end());
+  run_files_.clear();
+  runs_.clear();
+}
+
 }  // namespace util
 }  // namespace codegen
 }  // namespace peloton
@@ -16,11 +16,13 @@
 #include <google/protobuf/stubs/common.h>
 
 #include "catalog/catalog.h"
+#include "codegen/compiled_code_cache.h"
 #include "common/statement_cache_manager.h"
 #include "common/thread_pool.h"
 #include "concurrency/transaction_manager_factory.h"
 #include "gc/gc_manager_factory.h"
 #include "index/index.h"
+#include "storage/backend_manager.h"
 #include "settings/settings_manager.h"
 #include "threadpool/mono_queue_pool.h"
 #include "tuning/index_tuner.h"
@@ -40,6 +42,14 @@ void PelotonInit::Initialize() {
   // set max thread number.
   thread_pool.Initialize(0, CONNECTION_THREAD_COUNT + 3);
 
+  // fault in the huge pages for large allocations
+  auto huge_page_reserve_mb = settings::SettingsManager::GetInt(
+      settings::SettingId::huge_page_reserve_mb);
+  if (huge_page_reserve_mb > 0) {
+    storage::BackendManager::GetInstance().ReserveHugePages(
+        static_cast<size_t>(huge_page_reserve_mb) << 20);
+  }
+
   // start worker pool
   threadpool::MonoQueuePool::GetInstance().Startup();
 
@@ -93,9 +103,25 @@ void PelotonInit::Initialize() {
 
   // Initialize the Statement Cache Manager
   StatementCacheManager::Init();
+
+  // Open the persistent cache of compiled queries and load the hottest ones
+  auto code_cache_dir = settings::SettingsManager::GetString(
+      settings::SettingId::codegen_cache_directory);
+  if (!code_cache_dir.empty()) {
+    auto &code_cache = codegen::CompiledCodeCache::Instance();
+    code_cache.SetDirectory(code_cache_dir);
+    code_cache.Warmup(settings::SettingsManager::GetInt(
+        settings::SettingId::codegen_cache_warmup));
+  }
 }
 
 void PelotonInit::Shutdown() {
+  // persist the usage counts of cached compiled queries
+  auto &code_cache = codegen::CompiledCodeCache::Instance();
+  if (code_cache.IsEnabled()) {
+    code_cache.WriteIndex();
+  }
+
   // shut down index tuner
   if (settings::SettingsManager::GetBool(settings::SettingId::index_tuner)) {
     auto &index_tuner = tuning::IndexTuner::GetInstance();
@@ -1597,6 +1597,9 @@ std::string JoinTypeToString(JoinType type) {
     case JoinType::SEMI: {
       return "SEMI";
     }
+    case JoinType::ANTI: {
+      return "ANTI";
+    }
     default: {
       throw ConversionException(
           StringUtil::Format("No string conversion for JoinType value '%d'",
@@ -1620,6 +1623,8 @@ JoinType StringToJoinType(const std::string &str) {
     return JoinType::OUTER;
   } else if (upper_str == "SEMI") {
     return JoinType::SEMI;
+  } else if (upper_str == "ANTI") {
+    return JoinType::ANTI;
   } else {
     throw ConversionException(StringUtil::Format(
         "No JoinType conversion from string '%s'", upper_str.c_str()));
@@ -1888,6 +1893,8 @@ std::ostream &operator<<(std::ostream &os, const CopyType &type) {
 
 std::string ExternalFileFormatToString(ExternalFileFormat format) {
   switch (format) {
+    case ExternalFileFormat::ARROW:
+      return "ARROW";
     case ExternalFileFormat::CSV:
     default:
       return "CSV";
@@ -1898,6 +1905,8 @@ ExternalFileFormat StringToExternalFileFormat(const std::string &str) {
   auto upper = StringUtil::Upper(str);
   if (upper == "CSV") {
     return ExternalFileFormat::CSV;
+  } else if (upper == "ARROW") {
+    return ExternalFileFormat::ARROW;
   }
   throw ConversionException(StringUtil::Format(
       "No ExternalFileFormat for input '%s'", upper.c_str()));
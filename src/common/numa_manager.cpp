@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// numa_manager.cpp
+//
+// Identification: src/common/numa_manager.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/numa_manager.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "common/logger.h"
+#include "settings/settings_manager.h"
+
+namespace peloton {
+
+// From <numaif.h>, which comes with libnuma
+static constexpr int kMpolPreferred = 1;
+
+// The largest node ID that a node mask can hold
+static constexpr uint32_t kMaxNodeId = sizeof(unsigned long) * 8 - 1;
+
+static const char *const kNodeDirectory = "/sys/devices/system/node/";
+
+thread_local int NumaManager::bound_node_ = NumaManager::kAnyNode;
+
+NumaManager &NumaManager::GetInstance() {
+  static NumaManager numa_manager;
+  return numa_manager;
+}
+
+NumaManager::NumaManager() {
+  ReadTopology();
+  LOG_DEBUG("Found %u NUMA node(s)", GetNumNodes());
+}
+
+std::vector<uint32_t> NumaManager::ParseList(const std::string &list) {
+  std::vector<uint32_t> ids;
+  std::stringstream stream{list};
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty() || range[0] < '0' || range[0] > '9') {
+      continue;
+    }
+    auto dash = range.find('-');
+    uint32_t first = std::stoul(range.substr(0, dash));
+    uint32_t last =
+        dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+    for (uint32_t id = first; id <= last; id++) {
+      ids.push_back(id);
+    }
+  }
+  return ids;
+}
+
+void NumaManager::ReadTopology() {
+  std::string line;
+  std::ifstream online{std::string(kNodeDirectory) + "online"};
+  if (std::getline(online, line)) {
+    for (uint32_t node_id : ParseList(line)) {
+      std::ifstream cpu_list{std::string(kNodeDirectory) + "node" +
+                             std::to_string(node_id) + "/cpulist"};
+      std::string cpus;
+      if (node_id > kMaxNodeId || !std::getline(cpu_list, cpus)) {
+        continue;
+      }
+      auto node_cpus = ParseList(cpus);
+      if (node_cpus.empty()) {
+        // Nodes with memory only have nothing to run scans on
+        continue;
+      }
+      for (uint32_t cpu : node_cpus) {
+        if (cpu >= cpu_node_.size()) {
+          cpu_node_.resize(cpu + 1, 0);
+        }
+        cpu_node_[cpu] = static_cast<uint32_t>(node_ids_.size());
+      }
+      node_ids_.push_back(node_id);
+      node_cpus_.push_back(std::move(node_cpus));
+    }
+  }
+
+  if (node_ids_.empty()) {
+    // Everything is on one node
+    node_ids_.push_back(0);
+    node_cpus_.emplace_back();
+    cpu_node_.clear();
+  }
+}
+
+uint32_t NumaManager::GetCurrentNode() const {
+  if (bound_node_ != kAnyNode) {
+    return static_cast<uint32_t>(bound_node_);
+  }
+  int cpu = sched_getcpu();
+  if (cpu < 0 || static_cast<size_t>(cpu) >= cpu_node_.size()) {
+    return 0;
+  }
+  return cpu_node_[cpu];
+}
+
+bool NumaManager::BindCurrentThread(uint32_t node) {
+  PELOTON_ASSERT(node < GetNumNodes());
+  if (node_cpus_[node].empty()) {
+    return false;
+  }
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (uint32_t cpu : node_cpus_[node]) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpu_set);
+    }
+  }
+  int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  if (ret != 0) {
+    LOG_WARN("Could not bind thread to NUMA node %u: %s", node_ids_[node],
+             strerror(ret));
+    return false;
+  }
+  bound_node_ = static_cast<int>(node);
+  return true;
+}
+
+int NumaManager::ChooseTileGroupNode(size_t tile_group_offset) const {
+  if (GetNumNodes() < 2) {
+    return kAnyNode;
+  }
+  std::string placement =
+      settings::SettingsManager::GetString(settings::SettingId::numa_placement);
+  if (placement == "interleave") {
+    return static_cast<int>((tile_group_offset / kInterleaveStripe) %
+                            GetNumNodes());
+  } else if (placement == "local") {
+    return static_cast<int>(GetCurrentNode());
+  }
+  return kAnyNode;
+}
+
+void NumaManager::BindMemory(void *address, size_t length, uint32_t node) {
+  PELOTON_ASSERT(node < GetNumNodes());
+
+  // Preferring the node rather than binding to it lets the pages go elsewhere
+  // once it is full
+  unsigned long node_mask = 1ul << node_ids_[node];
+  if (syscall(SYS_mbind, address, length, kMpolPreferred, &node_mask,
+              kMaxNodeId + 1, 0) != 0) {
+    LOG_TRACE("Could not place memory on NUMA node %u: %s", node_ids_[node],
+              strerror(errno));
+  }
+}
+
+}  // namespace peloton
@@ -0,0 +1,236 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_cache.cpp
+//
+// Identification: src/common/plan_cache.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/plan_cache.h"
+
+#include <cctype>
+
+#include "common/logger.h"
+#include "planner/abstract_plan.h"
+#include "planner/plan_util.h"
+
+namespace peloton {
+
+PlanCache &PlanCache::GetInstance() {
+  static PlanCache plan_cache;
+  return plan_cache;
+}
+
+std::string PlanCache::MakeKey(const std::string &database_name,
+                               const std::string &query_string,
+                               const std::vector<int32_t> &param_types) {
+  std::string key = NormalizeQueryString(query_string);
+  key.push_back('\0');
+  key.append(database_name);
+  for (auto param_type : param_types) {
+    key.push_back('\0');
+    key.append(std::to_string(param_type));
+  }
+  return key;
+}
+
+std::string PlanCache::NormalizeQueryString(const std::string &query_string) {
+  std::string normalized;
+  normalized.reserve(query_string.size());
+
+  // The quote character we are currently inside of, or 0 if none
+  char quote = 0;
+  bool pending_space = false;
+  for (char c : query_string) {
+    if (quote != 0) {
+      normalized.push_back(c);
+      if (c == quote) quote = 0;
+      continue;
+    }
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      pending_space = !normalized.empty();
+      continue;
+    }
+    if (pending_space) {
+      normalized.push_back(' ');
+      pending_space = false;
+    }
+    if (c == '\'' || c == '"') {
+      quote = c;
+    }
+    normalized.push_back(c);
+  }
+
+  // Drop trailing semicolons (and the whitespace between them)
+  while (!normalized.empty() &&
+         (normalized.back() == ';' || normalized.back() == ' ') &&
+         quote == 0) {
+    normalized.pop_back();
+  }
+  return normalized;
+}
+
+bool PlanCache::IsCacheable(const planner::AbstractPlan *plan) {
+  if (plan == nullptr) {
+    return false;
+  }
+  // Only the plan nodes whose Copy() preserves everything that matters for
+  // execution are allowed to be shared. INSERT is left out: InsertPlan::Copy()
+  // is not implemented, as its values, tuples and attribute infos are built
+  // from the statement while planning.
+  switch (plan->GetPlanNodeType()) {
+    case PlanNodeType::SEQSCAN:
+    case PlanNodeType::INDEXSCAN:
+    case PlanNodeType::PROJECTION:
+    case PlanNodeType::ORDERBY:
+    case PlanNodeType::LIMIT:
+    case PlanNodeType::AGGREGATE_V2:
+    case PlanNodeType::HASHJOIN:
+    case PlanNodeType::HASH:
+    case PlanNodeType::NESTLOOP:
+    case PlanNodeType::UPDATE:
+    case PlanNodeType::DELETE:
+      break;
+    default:
+      return false;
+  }
+  for (const auto &child : plan->GetChildren()) {
+    if (!IsCacheable(child.get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PlanCache::Find(const std::string &key, CachedPlan &result) {
+  std::shared_ptr<const planner::AbstractPlan> plan_tree;
+  {
+    std::lock_guard<std::mutex> lock(cache_lock_);
+    auto itr = entry_map_.find(key);
+    if (itr == entry_map_.end()) {
+      miss_count_++;
+      return false;
+    }
+    // Move the entry to the front of the LRU list
+    entries_.splice(entries_.begin(), entries_, itr->second);
+    const auto &entry = *itr->second;
+    plan_tree = entry.plan_tree;
+    result.tuple_descriptor = entry.tuple_descriptor;
+    result.table_ids = entry.table_ids;
+    result.parameter_predicates = entry.parameter_predicates;
+  }
+
+  // The cached plan tree is never modified, so it is safe to copy it without
+  // holding the lock
+  result.plan_tree = planner::PlanUtil::CopyPlanTree(plan_tree.get());
+  if (result.plan_tree == nullptr) {
+    miss_count_++;
+    return false;
+  }
+  hit_count_++;
+  return true;
+}
+
+void PlanCache::Add(
+    const std::string &key, const planner::AbstractPlan *plan,
+    const std::vector<FieldInfo> &tuple_descriptor,
+    const std::set<oid_t> &table_ids,
+    const std::vector<optimizer::ParameterPredicate> &predicates,
+    uint64_t version) {
+  if (capacity_ == 0 || !IsCacheable(plan)) {
+    return;
+  }
+
+  Entry entry;
+  entry.key = key;
+  entry.plan_tree = planner::PlanUtil::CopyPlanTree(plan);
+  entry.tuple_descriptor = tuple_descriptor;
+  entry.table_ids = table_ids;
+  entry.parameter_predicates = predicates;
+  if (entry.plan_tree == nullptr) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(cache_lock_);
+  if (version != version_.load()) {
+    // DDL committed while the plan was made, it may be stale
+    LOG_TRACE("Skipped adding a plan made before an invalidation");
+    return;
+  }
+  auto itr = entry_map_.find(key);
+  if (itr != entry_map_.end()) {
+    EraseEntry(itr->second);
+  }
+  entries_.push_front(std::move(entry));
+  entry_map_[key] = entries_.begin();
+  for (auto table_id : table_ids) {
+    table_ref_[table_id].insert(key);
+  }
+  Evict();
+  LOG_TRACE("Added plan to the plan cache (%lu entries)", entries_.size());
+}
+
+void PlanCache::InvalidateTableOid(oid_t table_id) {
+  std::lock_guard<std::mutex> lock(cache_lock_);
+  version_++;
+  auto ref_itr = table_ref_.find(table_id);
+  if (ref_itr == table_ref_.end()) {
+    return;
+  }
+  // Copy the keys since erasing an entry modifies the table references
+  std::vector<std::string> keys(ref_itr->second.begin(),
+                                ref_itr->second.end());
+  for (const auto &key : keys) {
+    auto itr = entry_map_.find(key);
+    if (itr != entry_map_.end()) {
+      EraseEntry(itr->second);
+    }
+  }
+  table_ref_.erase(table_id);
+}
+
+void PlanCache::Clear() {
+  std::lock_guard<std::mutex> lock(cache_lock_);
+  version_++;
+  entries_.clear();
+  entry_map_.clear();
+  table_ref_.clear();
+}
+
+void PlanCache::SetCapacity(size_t capacity) {
+  std::lock_guard<std::mutex> lock(cache_lock_);
+  capacity_ = capacity;
+  Evict();
+}
+
+size_t PlanCache::GetCount() const {
+  std::lock_guard<std::mutex> lock(cache_lock_);
+  return entries_.size();
+}
+
+void PlanCache::EraseEntry(EntryList::iterator entry_itr) {
+  for (auto table_id : entry_itr->table_ids) {
+    auto ref_itr = table_ref_.find(table_id);
+    if (ref_itr == table_ref_.end()) continue;
+    ref_itr->second.erase(entry_itr->key);
+    if (ref_itr->second.empty()) {
+      table_ref_.erase(ref_itr);
+    }
+  }
+  entry_map_.erase(entry_itr->key);
+  entries_.erase(entry_itr);
+}
+
+void PlanCache::Evict() {
+  while (entries_.size() > capacity_) {
+    auto last = entries_.end();
+    --last;
+    EraseEntry(last);
+  }
+}
+
+}  // namespace peloton
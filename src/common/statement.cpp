@@ -97,6 +97,31 @@ const std::shared_ptr<planner::AbstractPlan>& Statement::GetPlanTree() const {
   return plan_tree_;
 }
 
+void Statement::SetParameterPredicates(
+    std::vector<optimizer::ParameterPredicate> parameter_predicates) {
+  parameter_predicates_ = std::move(parameter_predicates);
+}
+
+std::shared_ptr<planner::AbstractPlan> Statement::GetPlanVariant(
+    const std::vector<int>& buckets) const {
+  auto itr = plan_variants_.find(buckets);
+  if (itr == plan_variants_.end()) {
+    return nullptr;
+  }
+  return itr->second;
+}
+
+void Statement::AddPlanVariant(
+    const std::vector<int>& buckets,
+    std::shared_ptr<planner::AbstractPlan> plan_tree) {
+  plan_variants_[buckets] = std::move(plan_tree);
+}
+
+void Statement::ClearPlanVariants() {
+  plan_variants_.clear();
+  plan_buckets_.clear();
+}
+
 const std::string Statement::GetInfo() const {
   std::ostringstream os;
   os << "Statement[";
@@ -120,6 +145,11 @@ const std::string Statement::GetInfo() const {
   // Replan Flag
   os << ", ReplanNeeded=" << needs_replan_;
 
+  // Plan Variants
+  if (!plan_variants_.empty()) {
+    os << ", PlanVariants=" << plan_variants_.size();
+  }
+
   // Query Type
   os << ", QueryType=" << query_type_string_;
 
@@ -12,8 +12,14 @@
 
 #include "common/statement_cache_manager.h"
 
+#include "common/plan_cache.h"
+#include "concurrency/transaction_context.h"
+
 namespace peloton {
 
+std::shared_ptr<StatementCacheManager>
+    StatementCacheManager::statement_cache_manager_;
+
 void StatementCacheManager::RegisterStatementCache(StatementCache *stmt_cache) {
   statement_caches_.Insert(stmt_cache, stmt_cache);
 }
@@ -22,7 +28,16 @@ void StatementCacheManager::UnRegisterStatementCache(StatementCache *stmt_cache)
   statement_caches_.Erase(stmt_cache);
 }
 
-void StatementCacheManager::InvalidateTableOid(oid_t table_id) {
+void StatementCacheManager::InvalidateTableOid(
+    oid_t table_id, concurrency::TransactionContext *txn) {
+  // The shared plans must go regardless of any connection being registered
+  if (txn != nullptr) {
+    txn->AddOnCommitCallback(
+        [table_id] { PlanCache::GetInstance().InvalidateTableOid(table_id); });
+  } else {
+    PlanCache::GetInstance().InvalidateTableOid(table_id);
+  }
+
   if (statement_caches_.IsEmpty()) 
     return;
 
@@ -37,7 +52,20 @@ void StatementCacheManager::InvalidateTableOid(oid_t table_id) {
   // Automatically release the table;
 }
 
-void StatementCacheManager::InvalidateTableOids(std::set<oid_t> &table_ids) {
+void StatementCacheManager::InvalidateTableOids(
+    std::set<oid_t> &table_ids, concurrency::TransactionContext *txn) {
+  if (txn != nullptr) {
+    txn->AddOnCommitCallback([table_ids] {
+      for (auto table_id : table_ids) {
+        PlanCache::GetInstance().InvalidateTableOid(table_id);
+      }
+    });
+  } else {
+    for (auto &table_id : table_ids) {
+      PlanCache::GetInstance().InvalidateTableOid(table_id);
+    }
+  }
+
   if (table_ids.empty() || statement_caches_.IsEmpty())
     return;
 
@@ -347,7 +347,8 @@ void TimestampOrderingTransactionManager::PerformInsert(
   oid_t tuple_id = location.offset;
 
   auto storage_manager = storage::StorageManager::GetInstance();
-  auto tile_group_header = storage_manager->GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group_header =
+      storage_manager->LookupTileGroupPtr(tile_group_id)->GetHeader();
   auto transaction_id = current_txn->GetTransactionId();
 
   // check MVCC info
@@ -370,6 +371,43 @@ void TimestampOrderingTransactionManager::PerformInsert(
   tile_group_header->SetIndirection(tuple_id, index_entry_ptr);
 }
 
+void TimestampOrderingTransactionManager::PerformInserts(
+    TransactionContext *const current_txn,
+    const std::vector<ItemPointer> &locations,
+    const std::vector<ItemPointer *> &index_entry_ptrs) {
+  PELOTON_ASSERT(!current_txn->IsReadOnly());
+  PELOTON_ASSERT(locations.size() == index_entry_ptrs.size());
+
+  auto storage_manager = storage::StorageManager::GetInstance();
+  auto transaction_id = current_txn->GetTransactionId();
+  auto commit_id = current_txn->GetCommitId();
+
+  oid_t tile_group_id = INVALID_OID;
+  storage::TileGroupHeader *tile_group_header = nullptr;
+  for (size_t insert_itr = 0; insert_itr < locations.size(); insert_itr++) {
+    if (locations[insert_itr].block != tile_group_id) {
+      tile_group_id = locations[insert_itr].block;
+      tile_group_header =
+          storage_manager->LookupTileGroupPtr(tile_group_id)->GetHeader();
+    }
+    oid_t tuple_id = locations[insert_itr].offset;
+
+    // check MVCC info
+    // the tuple slot must be empty.
+    PELOTON_ASSERT(tile_group_header->GetTransactionId(tuple_id) ==
+                   INVALID_TXN_ID);
+    PELOTON_ASSERT(tile_group_header->GetBeginCommitId(tuple_id) == MAX_CID);
+    PELOTON_ASSERT(tile_group_header->GetEndCommitId(tuple_id) == MAX_CID);
+
+    tile_group_header->SetTransactionId(tuple_id, transaction_id);
+    tile_group_header->SetLastReaderCommitId(tuple_id, commit_id);
+    tile_group_header->SetIndirection(tuple_id, index_entry_ptrs[insert_itr]);
+  }
+
+  // Add the new tuples into the insert set
+  current_txn->RecordInserts(locations);
+}
+
 void TimestampOrderingTransactionManager::PerformUpdate(
     TransactionContext *const current_txn, const ItemPointer &location,
     const ItemPointer &new_location) {
@@ -384,9 +422,9 @@ void TimestampOrderingTransactionManager::PerformUpdate(
 
   auto storage_manager = storage::StorageManager::GetInstance();
   auto tile_group_header =
-      storage_manager->GetTileGroup(old_location.block)->GetHeader();
+      storage_manager->LookupTileGroupPtr(old_location.block)->GetHeader();
   auto new_tile_group_header =
-      storage_manager->GetTileGroup(new_location.block)->GetHeader();
+      storage_manager->LookupTileGroupPtr(new_location.block)->GetHeader();
 
   auto transaction_id = current_txn->GetTransactionId();
   // if we can perform update, then we must have already locked the older
@@ -456,7 +494,7 @@ void TimestampOrderingTransactionManager::PerformUpdate(
 
   auto storage_manager = storage::StorageManager::GetInstance();
   UNUSED_ATTRIBUTE auto tile_group_header =
-      storage_manager->GetTileGroup(tile_group_id)->GetHeader();
+      storage_manager->LookupTileGroupPtr(tile_group_id)->GetHeader();
 
   PELOTON_ASSERT(tile_group_header->GetTransactionId(tuple_id) ==
                  current_txn->GetTransactionId());
@@ -487,9 +525,9 @@ void TimestampOrderingTransactionManager::PerformDelete(
   auto storage_manager = storage::StorageManager::GetInstance();
 
   auto tile_group_header =
-      storage_manager->GetTileGroup(old_location.block)->GetHeader();
+      storage_manager->LookupTileGroupPtr(old_location.block)->GetHeader();
   auto new_tile_group_header =
-      storage_manager->GetTileGroup(new_location.block)->GetHeader();
+      storage_manager->LookupTileGroupPtr(new_location.block)->GetHeader();
 
   auto transaction_id = current_txn->GetTransactionId();
 
@@ -560,7 +598,8 @@ void TimestampOrderingTransactionManager::PerformDelete(
   oid_t tuple_id = location.offset;
 
   auto storage_manager = storage::StorageManager::GetInstance();
-  auto tile_group_header = storage_manager->GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group_header =
+      storage_manager->LookupTileGroupPtr(tile_group_id)->GetHeader();
 
   PELOTON_ASSERT(tile_group_header->GetTransactionId(tuple_id) ==
                  current_txn->GetTransactionId());
@@ -635,7 +674,7 @@ ResultType TimestampOrderingTransactionManager::CommitTransaction(
 
     if (tile_group_id != last_tile_group_id) {
       tile_group_header =
-          storage_manager->GetTileGroup(tile_group_id)->GetHeader();
+          storage_manager->LookupTileGroupPtr(tile_group_id)->GetHeader();
       last_tile_group_id = tile_group_id;
     }
 
@@ -655,7 +694,7 @@ ResultType TimestampOrderingTransactionManager::CommitTransaction(
       auto cid = tile_group_header->GetEndCommitId(tuple_slot);
       PELOTON_ASSERT(cid > end_commit_id);
       auto new_tile_group_header =
-          storage_manager->GetTileGroup(new_version.block)->GetHeader();
+          storage_manager->LookupTileGroupPtr(new_version.block)->GetHeader();
       new_tile_group_header->SetBeginCommitId(new_version.offset,
                                               end_commit_id);
       new_tile_group_header->SetEndCommitId(new_version.offset, cid);
@@ -685,7 +724,7 @@ ResultType TimestampOrderingTransactionManager::CommitTransaction(
       auto cid = tile_group_header->GetEndCommitId(tuple_slot);
       PELOTON_ASSERT(cid > end_commit_id);
       auto new_tile_group_header =
-          storage_manager->GetTileGroup(new_version.block)->GetHeader();
+          storage_manager->LookupTileGroupPtr(new_version.block)->GetHeader();
       new_tile_group_header->SetBeginCommitId(new_version.offset,
                                               end_commit_id);
       new_tile_group_header->SetEndCommitId(new_version.offset, cid);
@@ -793,7 +832,7 @@ ResultType TimestampOrderingTransactionManager::AbortTransaction(
 
     if (tile_group_id != last_tile_group_id) {
       tile_group_header =
-          storage_manager->GetTileGroup(tile_group_id)->GetHeader();
+          storage_manager->LookupTileGroupPtr(tile_group_id)->GetHeader();
       last_tile_group_id = tile_group_id;
     }
 
@@ -806,7 +845,7 @@ ResultType TimestampOrderingTransactionManager::AbortTransaction(
       ItemPointer new_version =
           tile_group_header->GetPrevItemPointer(tuple_slot);
       auto new_tile_group_header =
-          storage_manager->GetTileGroup(new_version.block)->GetHeader();
+          storage_manager->LookupTileGroupPtr(new_version.block)->GetHeader();
       // these two fields can be set at any time.
       new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
       new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
@@ -855,7 +894,7 @@ ResultType TimestampOrderingTransactionManager::AbortTransaction(
       ItemPointer new_version =
           tile_group_header->GetPrevItemPointer(tuple_slot);
       auto new_tile_group_header =
-          storage_manager->GetTileGroup(new_version.block)->GetHeader();
+          storage_manager->LookupTileGroupPtr(new_version.block)->GetHeader();
 
       new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
       new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
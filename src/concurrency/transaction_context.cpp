@@ -84,6 +84,7 @@ void TransactionContext::Init(const size_t thread_id,
   gc_object_set_ = std::make_shared<GCObjectSet>();
 
   on_commit_triggers_.reset();
+  on_commit_callbacks_.clear();
 }
 
 RWType TransactionContext::GetRWType(const ItemPointer &location) {
@@ -116,6 +117,15 @@ void TransactionContext::RecordInsert(const ItemPointer &location) {
   is_written_ = true;
 }
 
+void TransactionContext::RecordInserts(
+    const std::vector<ItemPointer> &locations) {
+  for (auto &location : locations) {
+    PELOTON_ASSERT(rw_set_.find(location) == rw_set_.end());
+    rw_set_[location] = RWType::INSERT;
+  }
+  is_written_ = true;
+}
+
 bool TransactionContext::RecordDelete(const ItemPointer &location) {
   PELOTON_ASSERT(rw_set_.find(location) == rw_set_.end() ||
                  (rw_set_[location] != RWType::DELETE &&
@@ -157,5 +167,16 @@ void TransactionContext::ExecOnCommitTriggers() {
   }
 }
 
+void TransactionContext::AddOnCommitCallback(std::function<void()> callback) {
+  on_commit_callbacks_.push_back(std::move(callback));
+}
+
+void TransactionContext::ExecOnCommitCallbacks() {
+  for (auto &callback : on_commit_callbacks_) {
+    callback();
+  }
+  on_commit_callbacks_.clear();
+}
+
 }  // namespace concurrency
 }  // namespace peloton
@@ -71,9 +71,10 @@ TransactionContext *TransactionManager::BeginTransaction(
 }
 
 void TransactionManager::EndTransaction(TransactionContext *current_txn) {
-  // fire all on commit triggers
+  // fire all on commit triggers and callbacks
   if (current_txn->GetResult() == ResultType::SUCCESS) {
     current_txn->ExecOnCommitTriggers();
+    current_txn->ExecOnCommitCallbacks();
   }
 
   // log RWSet and result stats
@@ -102,8 +103,9 @@ bool TransactionManager::IsOccupied(TransactionContext *const current_txn,
                                     const void *position_ptr) {
   ItemPointer &position = *((ItemPointer *)position_ptr);
 
-  auto tile_group_header =
-      storage::StorageManager::GetInstance()->GetTileGroup(position.block)->GetHeader();
+  auto tile_group_header = storage::StorageManager::GetInstance()
+                               ->LookupTileGroupPtr(position.block)
+                               ->GetHeader();
   auto tuple_id = position.offset;
 
   txn_id_t tuple_txn_id = tile_group_header->GetTransactionId(tuple_id);
@@ -291,7 +293,7 @@ void TransactionManager::RecordTransactionStats(
     // and initilaize the iterator
     const auto &tile_group_id = tuple_entry.first.block;
     database_id = storage::StorageManager::GetInstance()
-                      ->GetTileGroup(tile_group_id)
+                      ->LookupTileGroupPtr(tile_group_id)
                       ->GetDatabaseId();
     if (database_id != CATALOG_DATABASE_OID) {
       break;
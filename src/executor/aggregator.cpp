@@ -154,23 +154,28 @@ HashAggregator::HashAggregator(const planner::AggregatePlan *node,
                                executor::ExecutorContext *econtext,
                                size_t num_input_columns)
     : AbstractAggregator(node, output_table, econtext),
-      num_input_columns(num_input_columns) {}
+      num_input_columns(num_input_columns) {
+  // A group holds its key in the hash table, a copy of its first tuple and
+  // an aggregator per aggregate. Out-of-line data of values isn't counted.
+  size_t num_values = num_input_columns + node->GetGroupbyColIds().size();
+  size_t num_aggs = node->GetUniqueAggTerms().size();
+  group_size_ = sizeof(AggregateList) + num_values * sizeof(type::Value) +
+                num_aggs * (sizeof(AbstractAttributeAggregator *) +
+                            sizeof(AbstractAttributeAggregator)) +
+                sizeof(HashAggregateMapType::value_type);
+}
 //  group_by_key_values.resize(node->GetGroupbyColIds().size(),
 //      type::ValueFactory::GetNullValueByType(type::TypeId::INTEGER));
 //}
 
-HashAggregator::~HashAggregator() {
-  for (auto entry : aggregates_map) {
-    // Clean up allocated storage
-    for (size_t aggno = 0; aggno < node->GetUniqueAggTerms().size(); aggno++) {
-      delete entry.second->aggregates[aggno];
-    }
-    delete[] entry.second->aggregates;
-    delete entry.second;
-  }
-}
+HashAggregator::~HashAggregator() { ClearGroups(); }
 
 bool HashAggregator::Advance(AbstractTuple *cur_tuple) {
+  Aggregate(cur_tuple, true);
+  return true;
+}
+
+void HashAggregator::Aggregate(AbstractTuple *cur_tuple, bool may_spill) {
   AggregateList *aggregate_list;
 
   // Configure a group-by-key and search for the required group.
@@ -186,6 +191,19 @@ bool HashAggregator::Advance(AbstractTuple *cur_tuple) {
 
   // Group not found. Make a new entry in the hash for this new group.
   if (map_itr == aggregates_map.end()) {
+    // Once we've exceeded the memory budget, new groups go to disk
+    if (may_spill && !spilling_ && executor_context != nullptr &&
+        executor_context->ExceedsMemoryBudget()) {
+      LOG_DEBUG("Hash aggregation exceeded the memory budget with %zu groups",
+                aggregates_map.size());
+      spilling_ = true;
+      spill_partitions_.reset(new SpillPartition[kNumSpillPartitions]);
+    }
+    if (may_spill && spilling_) {
+      SpillTuple(cur_tuple);
+      return;
+    }
+
     LOG_TRACE("Group-by key not found. Start a new group.");
     // Allocate new aggregate list
     aggregate_list = new AggregateList();
@@ -206,6 +224,11 @@ bool HashAggregator::Advance(AbstractTuple *cur_tuple) {
 
     aggregates_map.insert(
         HashAggregateMapType::value_type(group_by_key_values, aggregate_list));
+
+    // The groups aren't allocated from the query's pool, account for them
+    if (executor_context != nullptr) {
+      executor_context->ChargeMemory(group_size_);
+    }
   }
   // Otherwise, the list is the second item of the pair.
   else {
@@ -223,11 +246,79 @@ bool HashAggregator::Advance(AbstractTuple *cur_tuple) {
 
     aggregate_list->aggregates[aggno]->Advance(value);
   }
+}
+
+void HashAggregator::SpillTuple(AbstractTuple *cur_tuple) {
+  // Scramble the hash, the hash table uses its low bits already
+  uint64_t hash = ValueVectorHasher()(group_by_key_values);
+  uint64_t part_idx = (hash * 0x9E3779B97F4A7C15ull) % kNumSpillPartitions;
+  auto &partition = spill_partitions_[part_idx];
+
+  // Values are stored along with their type
+  for (size_t col_id = 0; col_id < num_input_columns; col_id++) {
+    type::Value value = cur_tuple->GetValue(col_id);
+    partition.buffer.WriteByte(static_cast<int8_t>(value.GetTypeId()));
+    value.SerializeTo(partition.buffer);
+  }
+  partition.num_tuples++;
+  num_spilled_tuples_++;
 
-  return true;
+  if (partition.buffer.Size() >= kSpillBufferSize) {
+    FlushSpillPartition(partition);
+  }
 }
 
-bool HashAggregator::Finalize() {
+void HashAggregator::FlushSpillPartition(SpillPartition &partition) {
+  if (partition.buffer.Size() == 0) {
+    return;
+  }
+  if (partition.file == nullptr) {
+    partition.file.reset(
+        new util::SpillFile(executor_context->GetSpillDirectory()));
+  }
+  partition.file->Append(partition.buffer.Data(), partition.buffer.Size());
+  executor_context->RecordSpill(partition.buffer.Size());
+  partition.buffer.Reset();
+}
+
+void HashAggregator::AggregateSpillPartition(SpillPartition &partition) {
+  FlushSpillPartition(partition);
+  if (partition.num_tuples == 0) {
+    return;
+  }
+
+  // Read the whole partition back
+  std::vector<char> data(partition.file->Size());
+  partition.file->Read(0, data.data(), data.size());
+  partition.file.reset();
+
+  ReferenceSerializeInput input{data.data(), data.size()};
+  std::vector<type::Value> values(num_input_columns);
+  ContainerTuple<std::vector<type::Value>> tuple(&values);
+  for (uint64_t i = 0; i < partition.num_tuples; i++) {
+    for (size_t col_id = 0; col_id < num_input_columns; col_id++) {
+      auto type_id = static_cast<type::TypeId>(input.ReadByte());
+      type::Value value = type::Value::DeserializeFrom(input, type_id);
+
+      // Varlen values point into the buffer, but groups outlive it
+      if (value.IsNull()) {
+        values[col_id] = value;
+      } else if (type_id == type::TypeId::VARCHAR) {
+        values[col_id] = type::ValueFactory::GetVarcharValue(
+            value.GetData(), value.GetLength(), true);
+      } else if (type_id == type::TypeId::VARBINARY) {
+        values[col_id] = type::ValueFactory::GetVarbinaryValue(
+            reinterpret_cast<const unsigned char *>(value.GetData()),
+            value.GetLength(), true);
+      } else {
+        values[col_id] = value;
+      }
+    }
+    Aggregate(&tuple, false);
+  }
+}
+
+bool HashAggregator::EmitGroups() {
   for (auto entry : aggregates_map) {
     // Construct a container for the first tuple
     ContainerTuple<std::vector<type::Value>> first_tuple(
@@ -240,6 +331,44 @@ bool HashAggregator::Finalize() {
   return true;
 }
 
+void HashAggregator::ClearGroups() {
+  for (auto entry : aggregates_map) {
+    // Clean up allocated storage
+    for (size_t aggno = 0; aggno < node->GetUniqueAggTerms().size(); aggno++) {
+      delete entry.second->aggregates[aggno];
+    }
+    delete[] entry.second->aggregates;
+    delete entry.second;
+  }
+  if (executor_context != nullptr) {
+    executor_context->ChargeMemory(
+        -static_cast<int64_t>(aggregates_map.size() * group_size_));
+  }
+  aggregates_map.clear();
+}
+
+bool HashAggregator::Finalize() {
+  if (EmitGroups() == false) {
+    return false;
+  }
+  if (!spilling_) {
+    return true;
+  }
+
+  // Each spill partition is aggregated on its own. Its groups are disjoint
+  // from the ones emitted so far.
+  LOG_DEBUG("Aggregating %lu spilled tuples",
+            static_cast<unsigned long>(num_spilled_tuples_));
+  for (uint32_t i = 0; i < kNumSpillPartitions; i++) {
+    ClearGroups();
+    AggregateSpillPartition(spill_partitions_[i]);
+    if (EmitGroups() == false) {
+      return false;
+    }
+  }
+  return true;
+}
+
 //===--------------------------------------------------------------------===//
 // Sort Aggregator
 //===--------------------------------------------------------------------===//
@@ -20,7 +20,10 @@
 #include "concurrency/transaction_manager_factory.h"
 #include "executor/executor_context.h"
 #include "executor/logical_tile_factory.h"
+#include "concurrency/transaction_context.h"
 #include "planner/export_external_file_plan.h"
+#include "planner/seq_scan_plan.h"
+#include "storage/arrow_exporter.h"
 #include "storage/table_factory.h"
 #include "network/postgres_protocol_handler.h"
 #include "common/exception.h"
@@ -146,6 +149,28 @@ void CopyExecutor::Copy(const char *data, int len, bool end_of_line) {
   PELOTON_ASSERT(buff_size <= COPY_BUFFER_SIZE);
 }
 
+void CopyExecutor::ExportArrow() {
+  // Only whole tables are exported, since the values come from their tiles
+  const auto &node = GetPlanNode<planner::ExportExternalFilePlan>();
+  const auto *scan_plan = node.GetChild(0);
+  if (scan_plan->GetPlanNodeType() != PlanNodeType::SEQSCAN ||
+      static_cast<const planner::SeqScanPlan *>(scan_plan)->GetPredicate() !=
+          nullptr) {
+    throw NotImplementedException(
+        "COPY TO in the Arrow format only supports whole tables");
+  }
+  const auto *seq_scan_plan =
+      static_cast<const planner::SeqScanPlan *>(scan_plan);
+
+  auto *txn = executor_context_->GetTransaction();
+  storage::ArrowExporter exporter(seq_scan_plan->GetTable(),
+                                  seq_scan_plan->GetColumnIds(),
+                                  txn->GetReadId());
+  size_t num_rows = exporter.Export(file_handle_.file);
+  total_bytes_written = ftell(file_handle_.file);
+  LOG_DEBUG("Exported %lu rows to %s", num_rows, node.GetFileName().c_str());
+}
+
 /**
  * @return true on success, false otherwise.
  */
@@ -155,6 +180,15 @@ bool CopyExecutor::DExecute() {
     return false;
   }
 
+  if (GetPlanNode<planner::ExportExternalFilePlan>().GetFormat() ==
+      ExternalFileFormat::ARROW) {
+    ExportArrow();
+    FFlushFsync();
+    fclose(file_handle_.file);
+    done = true;
+    return true;
+  }
+
   while (children_[0]->Execute() == true) {
     // Get input a tile
     std::unique_ptr<LogicalTile> logical_tile(children_[0]->GetOutput());
@@ -14,6 +14,7 @@
 
 #include "catalog/catalog.h"
 #include "catalog/system_catalogs.h"
+#include "common/statement_cache_manager.h"
 #include "concurrency/transaction_context.h"
 #include "executor/executor_context.h"
 #include "planner/create_plan.h"
@@ -286,6 +287,17 @@ bool CreateExecutor::CreateIndex(const planner::CreatePlan &node) {
 
   if (txn->GetResult() == ResultType::SUCCESS) {
     LOG_TRACE("Creating table succeeded!");
+
+    // The plans made before the index existed can't use it
+    if (StatementCacheManager::GetStmtCacheManager().get()) {
+      oid_t table_id =
+          catalog::Catalog::GetInstance()
+              ->GetTableCatalogEntry(txn, database_name, schema_name,
+                                     table_name)
+              ->GetTableOid();
+      StatementCacheManager::GetStmtCacheManager()->InvalidateTableOid(
+          table_id, txn);
+    }
   } else if (txn->GetResult() == ResultType::FAILURE) {
     LOG_TRACE("Creating table failed!");
   } else {
@@ -107,7 +107,7 @@ bool DropExecutor::DropDatabase(const planner::DropPlan &node,
         table_ids.insert(it.second->GetTableOid());
       }
       StatementCacheManager::GetStmtCacheManager()->InvalidateTableOids(
-          table_ids);
+          table_ids, txn);
     }
   } else {
     LOG_TRACE("Result is: %s", ResultTypeToString(txn->GetResult()).c_str());
@@ -138,7 +138,7 @@ bool DropExecutor::DropSchema(const planner::DropPlan &node,
         table_ids.insert(table_objects[i]->GetTableOid());
       }
       StatementCacheManager::GetStmtCacheManager()->InvalidateTableOids(
-          table_ids);
+          table_ids, txn);
     }
   } else {
     LOG_DEBUG("Result is: %s", ResultTypeToString(txn->GetResult()).c_str());
@@ -183,7 +183,7 @@ bool DropExecutor::DropTable(const planner::DropPlan &node,
                                      table_name)
               ->GetTableOid();
       StatementCacheManager::GetStmtCacheManager()->InvalidateTableOid(
-          table_id);
+          table_id, txn);
     }
   } else {
     LOG_TRACE("Result is: %s", ResultTypeToString(txn->GetResult()).c_str());
@@ -218,7 +218,7 @@ bool DropExecutor::DropTrigger(const planner::DropPlan &node,
     if (StatementCacheManager::GetStmtCacheManager().get()) {
       oid_t table_id = table_object->GetTableOid();
       StatementCacheManager::GetStmtCacheManager()->InvalidateTableOid(
-          table_id);
+          table_id, txn);
     }
   } else if (txn->GetResult() == ResultType::FAILURE && node.IsMissing()) {
     txn->SetResult(ResultType::SUCCESS);
@@ -264,7 +264,7 @@ bool DropExecutor::DropIndex(const planner::DropPlan &node,
     if (StatementCacheManager::GetStmtCacheManager().get()) {
       oid_t table_id = index_object->GetTableOid();
       StatementCacheManager::GetStmtCacheManager()->InvalidateTableOid(
-          table_id);
+          table_id, txn);
     }
   } else {
     LOG_TRACE("Dropping Index Failed!");
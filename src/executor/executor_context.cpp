@@ -12,6 +12,9 @@
 
 #include "executor/executor_context.h"
 
+#include <algorithm>
+
+#include "settings/settings_manager.h"
 #include "storage/storage_manager.h"
 
 namespace peloton {
@@ -28,7 +31,15 @@ ExecutorContext::ExecutorContext(concurrency::TransactionContext *transaction,
     : transaction_(transaction),
       parameters_(std::move(parameters)),
       storage_manager_(storage::StorageManager::GetInstance()),
-      thread_states_(pool_) {}
+      thread_states_(pool_),
+      memory_budget_(static_cast<uint64_t>(settings::SettingsManager::GetInt(
+                         settings::SettingId::query_memory_budget)) *
+                     1024 * 1024),
+      spill_directory_(settings::SettingsManager::GetString(
+          settings::SettingId::spill_directory)),
+      charged_bytes_(0),
+      spilled_bytes_(0),
+      num_spills_(0) {}
 
 concurrency::TransactionContext *ExecutorContext::GetTransaction() const {
   return transaction_;
@@ -50,6 +61,21 @@ ExecutorContext::ThreadStates &ExecutorContext::GetThreadStates() {
   return thread_states_;
 }
 
+uint64_t ExecutorContext::GetUsedMemory() const {
+  int64_t used = static_cast<int64_t>(pool_.GetAllocatedBytes()) +
+                 charged_bytes_.load();
+  return static_cast<uint64_t>(std::max<int64_t>(used, 0));
+}
+
+bool ExecutorContext::ExceedsMemoryBudget() const {
+  return memory_budget_ != 0 && GetUsedMemory() > memory_budget_;
+}
+
+void ExecutorContext::RecordSpill(uint64_t bytes) {
+  spilled_bytes_ += bytes;
+  num_spills_++;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 /// ThreadStates
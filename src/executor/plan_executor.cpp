@@ -22,6 +22,7 @@
 #include "executor/executors.h"
 #include "settings/settings_manager.h"
 #include "storage/tuple_iterator.h"
+#include "threadpool/mono_queue_pool.h"
 
 namespace peloton {
 namespace executor {
@@ -32,6 +33,44 @@ executor::AbstractExecutor *BuildExecutorTree(
 
 void CleanExecutorTree(executor::AbstractExecutor *root);
 
+static void LogSpills(const executor::ExecutionResult &result) {
+  if (result.m_num_spills > 0) {
+    LOG_DEBUG("Query exceeded its memory budget, spilled %.2lf MB in %lu runs",
+              result.m_spilled_bytes / (1024.0 * 1024.0),
+              static_cast<unsigned long>(result.m_num_spills));
+  }
+}
+
+// Recompile a query that runs often with all optimizations, in the background.
+// The query switches to the new code once it is ready.
+static void RecompileInBackground(codegen::Query &query,
+                                  const planner::AbstractPlan &plan,
+                                  const std::vector<type::Value> &params) {
+  // Every execution binds the plan again, so compile a copy of it
+  std::shared_ptr<planner::AbstractPlan> plan_copy{plan.Copy()};
+  auto target = query.GetRecompilationTarget();
+  auto recompile = [plan_copy, params, target]() {
+    try {
+      planner::BindingContext context;
+      plan_copy->PerformBinding(context);
+      std::vector<oid_t> columns;
+      plan_copy->GetOutputColumns(columns);
+      codegen::BufferingConsumer consumer{columns, context};
+      codegen::QueryParameters parameters{*plan_copy, params};
+
+      codegen::QueryCompiler compiler;
+      auto recompiled = compiler.Compile(
+          *plan_copy, parameters.GetQueryParametersMap(), consumer, nullptr,
+          codegen::OptimizationLevel::Aggressive);
+      recompiled->Compile();
+      target->Install(std::move(recompiled), plan_copy);
+    } catch (const std::exception &e) {
+      LOG_ERROR("Recompiling a hot query failed: %s", e.what());
+    }
+  };
+  threadpool::MonoQueuePool::GetCompilationInstance().SubmitTask(recompile);
+}
+
 static void CompileAndExecutePlan(
     std::shared_ptr<planner::AbstractPlan> plan,
     concurrency::TransactionContext *txn,
@@ -53,28 +92,40 @@ static void CompileAndExecutePlan(
   executor::ExecutorContext executor_context{
       txn, codegen::QueryParameters(*plan, params)};
 
-  // Check if we have a cached compiled plan already
-  codegen::Query *query = codegen::QueryCache::Instance().Find(plan);
-  if (query == nullptr) {
+  // Check if we have a cached compiled plan already. Otherwise, generate the
+  // query and insert it into the cache. New queries are compiled on the
+  // compiler threads, so that this worker can go on with interpreting them.
+  auto compile = [&plan, &executor_context, &consumer]() {
     codegen::QueryCompiler compiler;
     auto compiled_query = compiler.Compile(
-        *plan, executor_context.GetParams().GetQueryParametersMap(), consumer);
-    compiled_query->Compile();
-
-    // Grab an instance to the plan
-    query = compiled_query.get();
-
-    // Insert the compiled plan into the cache
-    codegen::QueryCache::Instance().Add(plan, std::move(compiled_query));
-  }
+        *plan, executor_context.GetParams().GetQueryParametersMap(), consumer,
+        nullptr, codegen::QueryCompiler::ChooseOptimizationLevel(*plan));
+    if (settings::SettingsManager::GetBool(
+            settings::SettingId::codegen_async_compilation)) {
+      compiled_query->CompileAsync();
+    } else {
+      compiled_query->Compile();
+    }
+    return compiled_query;
+  };
+  codegen::Query *query =
+      codegen::QueryCache::Instance().FindOrAdd(plan, compile);
 
   // Execute the query!
   query->Execute(executor_context, consumer);
 
+  // Hot queries get better code
+  if (query->NeedsRecompilation()) {
+    RecompileInBackground(*query, *plan, params);
+  }
+
   // Execution complete, setup the results
   executor::ExecutionResult result;
   result.m_processed = executor_context.num_processed;
+  result.m_spilled_bytes = executor_context.GetSpilledBytes();
+  result.m_num_spills = executor_context.GetNumSpills();
   result.m_result = ResultType::SUCCESS;
+  LogSpills(result);
 
   // Iterate over results
   std::vector<ResultValue> values;
@@ -142,7 +193,10 @@ static void InterpretPlan(
   }
 
   result.m_processed = executor_context->num_processed;
+  result.m_spilled_bytes = executor_context->GetSpilledBytes();
+  result.m_num_spills = executor_context->GetNumSpills();
   result.m_result = ResultType::SUCCESS;
+  LogSpills(result);
   CleanExecutorTree(executor_tree.get());
   plan->ClearParameterValues();
   on_complete(result, std::move(values));
@@ -14,10 +14,14 @@
 #include "catalog/schema.h"
 #include "common/internal_types.h"
 #include "concurrency/transaction_context.h"
+#include "concurrency/epoch_manager_factory.h"
 #include "type/value.h"
-#include "type/abstract_pool.h"
+#include "type/arena_pool.h"
+#include "settings/settings_manager.h"
+#include "storage/storage_manager.h"
 #include "storage/tile.h"
 #include "storage/tile_group.h"
+#include "storage/tiering_manager.h"
 
 namespace peloton {
 namespace gc {
@@ -26,38 +30,148 @@ namespace gc {
 void GCManager::CheckAndReclaimVarlenColumns(storage::TileGroup *tile_group,
                                              oid_t tuple_id) {
   uint32_t tile_count = tile_group->tile_count_;
-  uint32_t tile_col_count;
-  type::TypeId type_id;
-  char *tuple_location;
-  char *field_location;
-  char *varlen_ptr;
+  bool needs_compaction = false;
 
   for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
     storage::Tile *tile = tile_group->GetTile(tile_itr);
     PELOTON_ASSERT(tile);
-    const catalog::Schema *schema = tile->GetSchema();
-    tile_col_count = schema->GetColumnCount();
-    for (oid_t tile_col_itr = 0; tile_col_itr < tile_col_count;
-         ++tile_col_itr) {
-      type_id = schema->GetType(tile_col_itr);
-
-      if ((type_id != type::TypeId::VARCHAR &&
-           type_id != type::TypeId::VARBINARY) ||
-          (schema->IsInlined(tile_col_itr) == true)) {
-        // Not of varlen type, or is inlined, skip
+    tile->ReclaimVarlenColumns(tuple_id);
+    needs_compaction = needs_compaction || tile->pool->NeedsCompaction();
+  }
+
+  if (needs_compaction) {
+    std::lock_guard<std::mutex> guard{candidates_lock_};
+    compaction_candidates_.insert(tile_group->GetTileGroupId());
+  }
+}
+
+void GCManager::AddFreezeCandidate(oid_t tile_group_id) {
+  if (!is_running_ || !settings::SettingsManager::GetBool(
+                          settings::SettingId::tile_group_compression)) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard{candidates_lock_};
+  freeze_candidates_.insert(tile_group_id);
+}
+
+size_t GCManager::CompactVarlenPools() {
+  std::unordered_set<oid_t> candidates;
+  {
+    std::lock_guard<std::mutex> guard{candidates_lock_};
+    candidates.swap(compaction_candidates_);
+  }
+
+  auto *storage_manager = storage::StorageManager::GetInstance();
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+
+  // Evacuate the fragmented chunks of the candidates. Readers that started
+  // before the evacuation may still see the old copies, so the chunks are
+  // retired with the current epoch.
+  size_t num_compacted = 0;
+  for (oid_t tile_group_id : candidates) {
+    auto tile_group = storage_manager->GetTileGroup(tile_group_id);
+    if (tile_group == nullptr) {
+      continue;
+    }
+    for (oid_t tile_itr = 0; tile_itr < tile_group->tile_count_; tile_itr++) {
+      storage::Tile *tile = tile_group->GetTile(tile_itr);
+      if (tile->pool->BeginCompaction() == 0) {
         continue;
       }
-      // Get the raw varlen pointer
-      tuple_location = tile->GetTupleLocation(tuple_id);
-      field_location = tuple_location + schema->GetOffset(tile_col_itr);
-      varlen_ptr = type::Value::GetDataFromStorage(type_id, field_location);
-      // Call the corresponding varlen pool free
-      if (varlen_ptr != nullptr) {
-        tile->pool->Free(varlen_ptr);
-      }
+      UNUSED_ATTRIBUTE size_t num_moved = tile->EvacuateVarlenColumns();
+      tile->pool->EndCompaction(epoch_manager.GetCurrentEpochId());
+      LOG_TRACE("Moved %zu varlen values of tile group %u", num_moved,
+                tile_group_id);
+      num_compacted++;
     }
+    retiring_tile_groups_.insert(tile_group_id);
+  }
+  return num_compacted;
+}
+
+size_t GCManager::FreezeColdTileGroups() {
+  std::unordered_set<oid_t> candidates;
+  {
+    std::lock_guard<std::mutex> guard{candidates_lock_};
+    candidates.swap(freeze_candidates_);
   }
+  if (candidates.empty()) {
+    return 0;
   }
 
+  auto *storage_manager = storage::StorageManager::GetInstance();
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+  cid_t expired_cid = epoch_manager.GetExpiredCid();
+
+  // Like evacuated chunks, the memory compression replaces is retired with
+  // the current epoch
+  size_t num_frozen = 0;
+  std::vector<oid_t> not_cold;
+  for (oid_t tile_group_id : candidates) {
+    auto tile_group = storage_manager->GetTileGroup(tile_group_id);
+    if (tile_group == nullptr) {
+      continue;
+    }
+    switch (tile_group->Freeze(expired_cid,
+                               epoch_manager.GetCurrentEpochId())) {
+      case ResultType::SUCCESS:
+        retiring_tile_groups_.insert(tile_group_id);
+        num_frozen++;
+        break;
+      case ResultType::QUEUING:
+        not_cold.push_back(tile_group_id);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Try again later
+  std::lock_guard<std::mutex> guard{candidates_lock_};
+  freeze_candidates_.insert(not_cold.begin(), not_cold.end());
+  return num_frozen;
+}
+
+size_t GCManager::ReleaseRetiredMemory(eid_t expired_eid) {
+  auto *storage_manager = storage::StorageManager::GetInstance();
+
+  // Release the memory that no reader can see anymore
+  size_t num_released = 0;
+  for (auto iter = retiring_tile_groups_.begin();
+       iter != retiring_tile_groups_.end();) {
+    auto tile_group = storage_manager->GetTileGroup(*iter);
+    bool retiring = false;
+    if (tile_group != nullptr) {
+      for (oid_t tile_itr = 0; tile_itr < tile_group->tile_count_;
+           tile_itr++) {
+        storage::Tile *tile = tile_group->GetTile(tile_itr);
+        retiring = tile->ReleaseRetiredMemory(expired_eid) || retiring;
+      }
+    }
+    if (!retiring) {
+      // Only tile groups without retired memory can be evicted
+      if (tile_group != nullptr &&
+          settings::SettingsManager::GetBool(
+              settings::SettingId::tile_group_tiering)) {
+        storage::TieringManager::GetInstance().AddCandidate(tile_group);
+      }
+      iter = retiring_tile_groups_.erase(iter);
+      num_released++;
+    } else {
+      ++iter;
+    }
+  }
+  return num_released;
 }
+
+size_t GCManager::EvictColdTileGroups(eid_t expired_eid) {
+  if (!settings::SettingsManager::GetBool(
+          settings::SettingId::tile_group_tiering)) {
+    return 0;
+  }
+  return storage::TieringManager::GetInstance().EvictColdTileGroups(
+      expired_eid);
 }
+
+}  // namespace gc
+}  // namespace peloton
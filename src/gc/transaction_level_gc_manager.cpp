@@ -30,7 +30,7 @@ namespace gc {
 
 bool TransactionLevelGCManager::ResetTuple(const ItemPointer &location) {
   auto storage_manager = storage::StorageManager::GetInstance();
-  auto tile_group = storage_manager->GetTileGroup(location.block).get();
+  auto tile_group = storage_manager->LookupTileGroupPtr(location.block);
 
   auto tile_group_header = tile_group->GetHeader();
 
@@ -43,7 +43,10 @@ bool TransactionLevelGCManager::ResetTuple(const ItemPointer &location) {
   tile_group_header->SetPrevItemPointer(location.offset, INVALID_ITEMPOINTER);
   tile_group_header->SetIndirection(location.offset, nullptr);
 
-  // Reclaim the varlen pool
+  // Reclaim the varlen pool of the tile group that is in place now that the
+  // slot is reset. A layout transformation may have swapped in a copy of the
+  // tile group meanwhile, along with a copy of the values.
+  tile_group = storage_manager->LookupTileGroupPtr(location.block);
   CheckAndReclaimVarlenColumns(tile_group, location.offset);
 
   LOG_TRACE("Garbage tuple(%u, %u) is reset", location.block, location.offset);
@@ -67,6 +70,17 @@ void TransactionLevelGCManager::Running(const int &thread_id) {
     int reclaimed_count = Reclaim(thread_id, expired_eid);
     int unlinked_count = Unlink(thread_id, expired_eid);
 
+    // One thread compacts, freezes and evicts tile groups, and releases the
+    // memory that replaced once no reader can see it anymore, along with the
+    // dropped tile groups
+    if (thread_id == 0) {
+      reclaimed_count += CompactVarlenPools() + FreezeColdTileGroups() +
+                         ReleaseRetiredMemory(expired_eid) +
+                         EvictColdTileGroups(expired_eid) +
+                         storage::StorageManager::GetInstance()
+                             ->ReleaseDroppedTileGroups(expired_eid);
+    }
+
     if (is_running_ == false) {
       return;
     }
@@ -215,7 +229,7 @@ void TransactionLevelGCManager::AddToRecycleMap(
     concurrency::TransactionContext *txn_ctx) {
   for (auto &entry : *(txn_ctx->GetGCSetPtr().get())) {
     auto storage_manager = storage::StorageManager::GetInstance();
-    auto tile_group = storage_manager->GetTileGroup(entry.first);
+    auto tile_group = storage_manager->LookupTileGroupPtr(entry.first);
 
     // During the resetting, a table may be deconstructed because of the DROP
     // TABLE request
@@ -290,10 +304,30 @@ ItemPointer TransactionLevelGCManager::ReturnFreeSlot(const oid_t &table_id) {
   ItemPointer location;
   PELOTON_ASSERT(recycle_queue_map_.find(table_id) != recycle_queue_map_.end());
   auto recycle_queue = recycle_queue_map_[table_id];
+  auto storage_manager = storage::StorageManager::GetInstance();
 
-  if (recycle_queue->Dequeue(location) == true) {
+  // The slots of a tile group that is being transformed or frozen must not be
+  // written, so they wait in the queue until it is mutable again
+  for (size_t attempt = 0; attempt < MAX_RECYCLE_ATTEMPT_COUNT; attempt++) {
+    if (recycle_queue->Dequeue(location) == false) {
+      break;
+    }
+    auto tile_group = storage_manager->LookupTileGroupPtr(location.block);
+    if (tile_group == nullptr) {
+      continue;
+    }
+    if (tile_group->GetHeader()->GetImmutability()) {
+      recycle_queue->Enqueue(location);
+      continue;
+    }
     LOG_TRACE("Reuse tuple(%u, %u) in table %u", location.block,
               location.offset, table_id);
+    // A full tile group was dropped from the freeze candidates because of
+    // this slot, so it gets another chance once the new tuple is cold
+    if (tile_group->GetNextTupleSlot() >=
+        tile_group->GetAllocatedTupleCount()) {
+      AddFreezeCandidate(location.block);
+    }
     return location;
   }
   return INVALID_ITEMPOINTER;
@@ -335,7 +369,7 @@ void TransactionLevelGCManager::UnlinkVersion(const ItemPointer location,
                                               GCVersionType type) {
   // get indirection from the indirection array.
   auto tile_group =
-      storage::StorageManager::GetInstance()->GetTileGroup(location.block);
+      storage::StorageManager::GetInstance()->GetTileGroupPtr(location.block);
 
   // if the corresponding tile group is deconstructed,
   // then do nothing.
@@ -343,8 +377,7 @@ void TransactionLevelGCManager::UnlinkVersion(const ItemPointer location,
     return;
   }
 
-  auto tile_group_header =
-      storage::StorageManager::GetInstance()->GetTileGroup(location.block)->GetHeader();
+  auto tile_group_header = tile_group->GetHeader();
 
   ItemPointer *indirection = tile_group_header->GetIndirection(location.offset);
 
@@ -353,8 +386,7 @@ void TransactionLevelGCManager::UnlinkVersion(const ItemPointer location,
     return;
   }
 
-  ContainerTuple<storage::TileGroup> current_tuple(tile_group.get(),
-                                                   location.offset);
+  ContainerTuple<storage::TileGroup> current_tuple(tile_group, location.offset);
 
   storage::DataTable *table =
       dynamic_cast<storage::DataTable *>(tile_group->GetAbstractTable());
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <deque>
 #include <string>
 #include <unordered_map>
 
@@ -21,6 +22,7 @@
 
 namespace llvm {
 class ExecutionEngine;
+class GlobalVariable;
 class LLVMContext;
 class Module;
 
@@ -38,6 +40,19 @@ namespace interpreter {
 class BytecodeBuilder;
 }  // namespace interpreter
 
+//===----------------------------------------------------------------------===//
+// How much work the optimizer puts into the code of a query
+//===----------------------------------------------------------------------===//
+enum class OptimizationLevel : uint8_t {
+  // No optimization passes, for cold queries that touch little data
+  None = 0,
+  // A handful of cheap scalar passes
+  Default = 1,
+  // Loop optimizations, unrolling and vectorization, for hot or expensive
+  // queries
+  Aggressive = 2,
+};
+
 //===----------------------------------------------------------------------===//
 // The context where all generated LLVM query code resides. We create a context
 // instance for every query we see.  We keep instances of these around in the
@@ -70,6 +85,13 @@ class CodeContext {
   /// Lookup a builtin function that has been registered in this context
   std::pair<llvm::Function *, FuncPtr> LookupBuiltin(const std::string &name) const;
 
+  /// Register a pointer to an object in memory that generated code uses. The
+  /// returned global holds the pointer once the code has been loaded.
+  llvm::GlobalVariable *RegisterExternalPointer(const void *ptr);
+
+  /// Lookup the storage of an external pointer registered with the given name
+  const void *LookupExternalPointer(const std::string &name) const;
+
   /// Return the LLVM function for UDF that has been registered in this context
   llvm::Function *GetUDF() const { return udf_func_ptr_; }
 
@@ -80,7 +102,7 @@ class CodeContext {
   void Verify();
 
   /// Optimize all the code contained in this context
-  void Optimize();
+  void Optimize(OptimizationLevel level = OptimizationLevel::Default);
 
   /// Compile all the code contained in this context
   void Compile();
@@ -124,6 +146,9 @@ class CodeContext {
   /// Get the module
   llvm::Module &GetModule() const { return *module_; }
 
+  /// Get the level the code has been optimized at
+  OptimizationLevel GetOptimizationLevel() const { return opt_level_; }
+
  private:
   // Get the raw IR in text form
   std::string GetIR() const;
@@ -134,6 +159,17 @@ class CodeContext {
   // Get the data layout
   const llvm::DataLayout &GetDataLayout() const;
 
+  // Get the key of the code in the CompiledCodeCache. It is computed from the
+  // code's IR the first time it is requested.
+  const std::string &GetCacheKey();
+
+  // Link the bitcode of the runtime functions this code calls into the module
+  // and inline the calls (see RuntimeLibrary)
+  void LinkRuntimeLibrary();
+
+  // Add the passes of the given optimization level to the pass manager
+  void AddOptimizationPasses(OptimizationLevel level);
+
   // Set the current function we're building
   void SetCurrentFunction(FunctionBuilder *func) { func_ = func; }
 
@@ -182,6 +218,17 @@ class CodeContext {
   std::unordered_map<std::string, std::pair<llvm::Function *, FuncPtr>>
       builtins_;
 
+  // The values of all external pointers and the names of the globals that
+  // hold them. A deque, so that the address of a value never changes.
+  std::deque<const void *> external_ptrs_;
+  std::unordered_map<std::string, const void *> external_ptr_slots_;
+
+  // The key of this code in the CompiledCodeCache (empty until computed)
+  std::string cache_key_;
+
+  // The level the code is optimized at
+  OptimizationLevel opt_level_;
+
   // The functions needed in this module, and their implementations. If the
   // function has not been compiled yet, the function pointer will be NULL. The
   // function pointers are populated in Compile()
@@ -105,6 +105,12 @@ class CodeGen {
   llvm::Constant *Null(llvm::Type *type) const;
   llvm::Constant *NullPtr(llvm::PointerType *type) const;
 
+  /// Return a pointer of the given type to an object in memory. The address is
+  /// not baked into the code, but loaded from a slot that is bound when the
+  /// code is loaded. Hence, the code can be cached and reused by a later
+  /// process (see CompiledCodeCache).
+  llvm::Value *RelocatablePtr(const void *ptr, llvm::PointerType *type) const;
+
   llvm::Value *AllocateVariable(llvm::Type *type, const std::string &name);
   llvm::Value *AllocateBuffer(llvm::Type *element_type, uint32_t num_elems,
                               const std::string &name);
@@ -0,0 +1,202 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// compiled_code_cache.h
+//
+// Identification: src/include/codegen/compiled_code_cache.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "llvm/ExecutionEngine/ObjectCache.h"
+
+#include "common/singleton.h"
+
+namespace peloton {
+namespace codegen {
+
+//===----------------------------------------------------------------------===//
+// A persistent cache of the machine code of compiled queries. Unlike the
+// QueryCache, which keeps whole compiled queries in memory, this cache keeps
+// the object code MCJIT generates for a query module in a directory on disk,
+// so that it survives restarts.
+//
+// Modules are keyed by a fingerprint of their IR, the build ID of the running
+// binary and the host CPU (see CodeContext::Compile()). Generated code never
+// embeds constants or addresses of objects in memory: constants are read from
+// the ParameterCache at runtime, and pointers are resolved when the object is
+// loaded (see CodeGen::RelocatablePtr()). Hence, the same plan yields the same
+// fingerprint in every process of the same build.
+//
+// The index file in the directory tracks how often each entry was used. At
+// startup, Warmup() loads the hottest entries into memory, so that the first
+// executions of popular queries after a restart neither compile nor wait for
+// the disk. New entries are appended to the index, which is rewritten only
+// once most of its records are stale.
+//
+// The cache is bounded: beyond a maximum number of entries, the least recently
+// used ones are removed from disk, and beyond a memory budget, the least
+// recently used object code is dropped from memory (but stays on disk).
+//===----------------------------------------------------------------------===//
+class CompiledCodeCache : public Singleton<CompiledCodeCache>,
+                          public llvm::ObjectCache {
+ public:
+  /// Use the given directory for cached code. An empty path disables the
+  /// cache. Entries that are indexed in the directory become visible.
+  void SetDirectory(const std::string &directory);
+
+  /// Is the cache enabled?
+  bool IsEnabled() const { return enabled_; }
+
+  /// Limit the number of entries and the bytes of object code kept in memory,
+  /// evicting least recently used entries as needed
+  void SetCapacity(uint32_t max_entries, uint64_t max_memory_size);
+
+  /// Does the cache hold object code for the module with the given key? Only
+  /// true if the code is in memory or its object file is still on disk.
+  bool Contains(const std::string &key);
+
+  /// Load the object code of the given number of most frequently used entries
+  /// into memory. Returns the number of entries loaded.
+  uint32_t Warmup(uint32_t num_entries);
+
+  /// Drop all entries, in memory and on disk
+  void Clear();
+
+  /// Write the index of entries and their usage counts to disk
+  void WriteIndex();
+
+  /// Compute the identifier of the running build
+  static std::string GetBuildId();
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///
+  /// llvm::ObjectCache interface. The module identifier is the cache key.
+  ///
+  //////////////////////////////////////////////////////////////////////////////
+
+  void notifyObjectCompiled(const llvm::Module *module,
+                            llvm::MemoryBufferRef object) override;
+
+  std::unique_ptr<llvm::MemoryBuffer> getObject(
+      const llvm::Module *module) override;
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///
+  /// Accessors
+  ///
+  //////////////////////////////////////////////////////////////////////////////
+
+  const std::string &GetDirectory() const { return directory_; }
+
+  size_t GetNumEntries();
+
+  uint64_t GetMemorySize();
+
+  uint64_t GetNumHits() const { return num_hits_; }
+
+  uint64_t GetNumMisses() const { return num_misses_; }
+
+ private:
+  friend class Singleton<CompiledCodeCache>;
+
+  CompiledCodeCache();
+  ~CompiledCodeCache();
+
+  // A cached module
+  struct Entry {
+    // The number of times the code was used
+    uint64_t num_uses = 0;
+    // The object code, if it has been loaded into memory
+    std::unique_ptr<llvm::MemoryBuffer> object;
+    // The position of the entry in the LRU list of all entries
+    std::list<std::string>::iterator lru_pos;
+    // The position of the entry in the LRU list of loaded entries, if loaded
+    std::list<std::string>::iterator loaded_pos;
+  };
+
+  // The path of the object file and the index file in the directory
+  std::string ObjectPath(const std::string &key) const;
+  std::string IndexPath() const;
+
+  // Does the object file of the given entry exist?
+  bool ObjectExists(const std::string &key) const;
+
+  // Read the index of the directory. Must hold the lock.
+  void ReadIndex();
+
+  // Load the object code of the given entry from disk. Must hold the lock.
+  bool LoadObject(const std::string &key, Entry &entry);
+
+  // Write the index. Must hold the lock.
+  void WriteIndexLocked();
+
+  // Append the usage count of an entry to the index. Must hold the lock.
+  void AppendIndexLocked(const std::string &key, const Entry &entry);
+
+  // Find or create the entry with the given key and make it the most recently
+  // used one. Must hold the lock.
+  Entry &UseEntry(const std::string &key);
+
+  // Keep the given object code of the entry in memory. Must hold the lock.
+  void SetObject(const std::string &key, Entry &entry,
+                 std::unique_ptr<llvm::MemoryBuffer> object);
+
+  // Drop the object code of the entry from memory. Must hold the lock.
+  void DropObject(Entry &entry);
+
+  // Remove the entry and its object file. Must hold the lock.
+  void RemoveEntry(const std::string &key);
+
+  // Forget all entries, without touching the disk. Must hold the lock.
+  void ResetLocked();
+
+  // Evict entries until the cache is within its capacity. Must hold the lock.
+  void EvictLocked();
+
+ private:
+  // The directory the object files live in
+  std::string directory_;
+
+  // Whether a directory has been configured
+  std::atomic<bool> enabled_;
+
+  // All known entries, keyed by their fingerprint
+  std::unordered_map<std::string, Entry> entries_;
+
+  // The keys of all entries, and of the entries whose object code is in
+  // memory, from the most to the least recently used
+  std::list<std::string> lru_;
+  std::list<std::string> loaded_;
+
+  // The bytes of object code in memory
+  uint64_t memory_size_;
+
+  // The capacity of the cache
+  uint32_t max_entries_;
+  uint64_t max_memory_size_;
+
+  // The number of records in the index file
+  uint64_t num_index_records_;
+
+  // Protects the entries and the files in the directory
+  std::mutex lock_;
+
+  // Statistics
+  std::atomic<uint64_t> num_hits_;
+  std::atomic<uint64_t> num_misses_;
+};
+
+}  // namespace codegen
+}  // namespace peloton
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// direct_mapped_table.h
+//
+// Identification: src/include/codegen/direct_mapped_table.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "codegen/codegen.h"
+#include "codegen/hash_table.h"
+#include "codegen/value.h"
+#include "codegen/vector.h"
+
+namespace peloton {
+namespace codegen {
+
+/**
+ * A table of aggregates for keys of integral columns with a small domain. The
+ * table is an array with one slot for every possible key, so the position of
+ * a key's slot is computed from the key itself, without hashing, probing or
+ * comparing keys. Each slot has an eight byte header that marks it occupied,
+ * followed by the opaque value area.
+ *
+ * The domain of each key column is given as a range of values, e.g., from the
+ * column's statistics. Since statistics may be stale, keys outside the ranges
+ * (and keys with NULL columns) are not stored in the table. The caller handles
+ * them, e.g., in a hash table.
+ *
+ * The table lives in the query state, which is allocated per execution.
+ */
+class DirectMappedTable {
+ public:
+  /// The (inclusive) range of values of one key column
+  struct KeyRange {
+    int64_t min;
+    int64_t max;
+  };
+
+  DirectMappedTable();
+  DirectMappedTable(const std::vector<type::Type> &key_type,
+                    const std::vector<KeyRange> &key_ranges,
+                    uint64_t value_size);
+
+  /**
+   * @brief The number of slots needed for keys in the given ranges. Returns
+   * UINT64_MAX if the number doesn't fit into 64 bits.
+   */
+  static uint64_t NumSlots(const std::vector<KeyRange> &key_ranges);
+
+  /**
+   * @brief The type of the table in the query state
+   */
+  llvm::Type *GetStateType(CodeGen &codegen) const;
+
+  /**
+   * @brief Mark all slots of the table free
+   */
+  void Init(CodeGen &codegen, llvm::Value *table_ptr) const;
+
+  /**
+   * @brief Generate code that finds the slot of the given key. The probe
+   * callback is invoked on the value of occupied slots, the insert callback
+   * on the value of free ones. Keys that have no slot are passed to the
+   * no_slot function.
+   */
+  void ProbeOrInsert(CodeGen &codegen, llvm::Value *table_ptr,
+                     const std::vector<codegen::Value> &key,
+                     HashTable::ProbeCallback &probe_callback,
+                     HashTable::InsertCallback &insert_callback,
+                     const std::function<void()> &no_slot) const;
+
+  /**
+   * @brief Generate code to iterate over the occupied slots in vectorized
+   * fashion
+   */
+  void VectorizedIterate(
+      CodeGen &codegen, llvm::Value *table_ptr, Vector &selection_vector,
+      HashTable::VectorizedIterateCallback &callback) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///
+  /// Accessors
+  ///
+  //////////////////////////////////////////////////////////////////////////////
+
+  uint64_t GetNumSlots() const { return num_slots_; }
+
+  uint64_t GetSlotSize() const { return slot_size_; }
+
+  /**
+   * A random-access interface over the slots of the table. The key of a slot
+   * is computed from its position.
+   */
+  class DirectMappedTableAccess : public HashTable::HashTableAccess {
+   public:
+    DirectMappedTableAccess(const DirectMappedTable &table,
+                            llvm::Value *table_ptr)
+        : table_(table), table_ptr_(table_ptr) {}
+
+    void ExtractBucketKeys(CodeGen &codegen, llvm::Value *index,
+                           std::vector<codegen::Value> &keys) const override;
+
+    llvm::Value *BucketValue(CodeGen &codegen,
+                             llvm::Value *index) const override;
+
+   private:
+    // The table
+    const DirectMappedTable &table_;
+    // The pointer to the table in the query state
+    llvm::Value *table_ptr_;
+  };
+
+ private:
+  // Return a pointer to the slot at the given position
+  llvm::Value *GetSlot(CodeGen &codegen, llvm::Value *table_ptr,
+                       llvm::Value *index) const;
+
+  // Return a pointer to the header of the given slot
+  llvm::Value *GetSlotHeader(CodeGen &codegen, llvm::Value *slot_ptr) const;
+
+  // Return a pointer to the value area of the given slot
+  llvm::Value *GetSlotValue(CodeGen &codegen, llvm::Value *slot_ptr) const;
+
+ private:
+  // The type and range of each key column
+  std::vector<type::Type> key_type_;
+  std::vector<KeyRange> key_ranges_;
+
+  // The number of slots, and the size of each of them
+  uint64_t num_slots_;
+  uint64_t slot_size_;
+};
+
+}  // namespace codegen
+}  // namespace peloton
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "codegen/compilation_context.h"
 #include "codegen/consumer_context.h"
 #include "common/item_pointer.h"
@@ -43,6 +45,9 @@ namespace codegen {
 // through its Init() outside the main loop
 class Inserter {
  public:
+  // The number of inserts completed together
+  static constexpr size_t kBatchSize = 256;
+
   // Initializes the instance
   void Init(storage::DataTable *table,
             executor::ExecutorContext *executor_context);
@@ -53,15 +58,23 @@ class Inserter {
   // Get the pool address
   peloton::type::AbstractPool *GetPool();
 
-  // Insert a tuple
+  // Insert a tuple. The inserts are completed in batches, the last of which
+  // is completed by Flush().
   void Insert();
 
+  // Complete the inserts that are still pending
+  void Flush();
+
   // Finalize the instance
   void TearDown();
 
  private:
   // No external constructor
-  Inserter(): table_(nullptr), executor_context_(nullptr), tile_(nullptr) {}
+  Inserter()
+      : table_(nullptr),
+        executor_context_(nullptr),
+        tile_(nullptr),
+        pending_(nullptr) {}
 
  private:
   // Provided by its insert translator
@@ -72,6 +85,9 @@ class Inserter {
   std::shared_ptr<storage::Tile> tile_;
   ItemPointer location_;
 
+  // The locations of the tuples whose inserts are pending
+  std::vector<ItemPointer> *pending_;
+
  private:
   DISALLOW_COPY_AND_MOVE(Inserter);
 };
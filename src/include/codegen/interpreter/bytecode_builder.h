@@ -108,6 +108,30 @@ class BytecodeBuilder {
    */
   void TranslateFunction();
 
+  /**
+   * Replaces common sequences of instructions with superinstructions. Only
+   * instructions within a basic block are fused.
+   * @param bb_mapping the start index of every basic block in the bytecode
+   */
+  void FuseInstructions(
+      const std::unordered_map<const llvm::BasicBlock *, index_t> &bb_mapping);
+
+  /**
+   * Fuses a compare and the conditional branch on its result
+   * @param first the compare instruction
+   * @param second the following instruction
+   * @return true, if the instructions were fused
+   */
+  bool FuseCompareAndBranch(Instruction *first, const Instruction *second);
+
+  /**
+   * Fuses a struct member access and a load of the member
+   * @param first the GEP instruction
+   * @param second the following instruction
+   * @return true, if the instructions were fused
+   */
+  bool FuseGEPAndLoad(Instruction *first, const Instruction *second);
+
   /**
    * Do some final conversations to make the created BytecodeFunction usable.
    */
@@ -192,6 +216,14 @@ class BytecodeBuilder {
    */
   ffi_type *GetFFIType(llvm::Type *type) const;
 
+  /**
+   * Checks if the interpreter can call the given external function directly,
+   * instead of through libffi
+   * @param call_instruction LLVM call instruction
+   * @return true, if the function can be called directly
+   */
+  bool IsNativeCall(const llvm::CallInst *call_instruction) const;
+
   /**
    * Checks if a LLVM Value is a constant
    * @param value LLVM Value
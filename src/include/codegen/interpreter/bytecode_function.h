@@ -119,8 +119,16 @@ struct ExternalCallContext {
   ffi_type *dest_type;
   std::vector<index_t> args;
   std::vector<ffi_type *> arg_types;
+  // Whether the function is called directly instead of through libffi, which
+  // is possible if all arguments and the return value are integers or pointers
+  // (see BytecodeInterpreter::CallNative())
+  bool native_call;
 };
 
+// The largest number of arguments of an external function that is called
+// directly. All of them are passed in registers on the supported platforms.
+constexpr size_t kMaxNativeCallArgs = 6;
+
 /**
  * A BytecodeFunction contains all information necessary to run a LLVM
  * function in the interpreter and is completely independent from the
@@ -14,6 +14,7 @@
 
 #include "codegen/interpreter/bytecode_function.h"
 
+#include <functional>
 #include <type_traits>
 
 #include "codegen/query.h"
@@ -879,9 +880,17 @@ class BytecodeInterpreter {
         call_activations_[call_instruction->external_call_context];
 
     // call external function
-    ffi_call(&call_activation.call_interface, call_instruction->function,
-             call_activation.return_pointer,
-             reinterpret_cast<void **>(call_activation.value_pointers.data()));
+    const ExternalCallContext &call_context =
+        bytecode_function_
+            .external_call_contexts_[call_instruction->external_call_context];
+    if (call_context.native_call) {
+      CallNative(call_context, call_instruction->function);
+    } else {
+      ffi_call(&call_activation.call_interface, call_instruction->function,
+               call_activation.return_pointer,
+               reinterpret_cast<void **>(
+                   call_activation.value_pointers.data()));
+    }
 
     if (bytecode_function_
             .external_call_contexts_[call_instruction->external_call_context]
@@ -895,6 +904,67 @@ class BytecodeInterpreter {
     return AdvanceIP<2>(instruction);  // bigger slot size!
   }
 
+  /**
+   * Calls an external function whose arguments and return value are integers
+   * or pointers directly, instead of through libffi. Arguments are passed
+   * zero-extended to 64 bit, the way libffi passes them.
+   */
+  ALWAYS_INLINE inline void CallNative(const ExternalCallContext &call_context,
+                                       void (*function)(void)) {
+    value_t args[kMaxNativeCallArgs] = {0};
+    for (size_t i = 0; i < call_context.args.size(); i++) {
+      args[i] = GetValue<value_t>(call_context.args[i]) &
+                TypeMask(call_context.arg_types[i]);
+    }
+
+    value_t result;
+    switch (call_context.args.size()) {
+      case 0:
+        result = reinterpret_cast<value_t (*)()>(function)();
+        break;
+      case 1:
+        result = reinterpret_cast<value_t (*)(value_t)>(function)(args[0]);
+        break;
+      case 2:
+        result = reinterpret_cast<value_t (*)(value_t, value_t)>(function)(
+            args[0], args[1]);
+        break;
+      case 3:
+        result = reinterpret_cast<value_t (*)(value_t, value_t, value_t)>(
+            function)(args[0], args[1], args[2]);
+        break;
+      case 4:
+        result =
+            reinterpret_cast<value_t (*)(value_t, value_t, value_t, value_t)>(
+                function)(args[0], args[1], args[2], args[3]);
+        break;
+      case 5:
+        result = reinterpret_cast<value_t (*)(value_t, value_t, value_t,
+                                               value_t, value_t)>(function)(
+            args[0], args[1], args[2], args[3], args[4]);
+        break;
+      default:
+        result = reinterpret_cast<value_t (*)(value_t, value_t, value_t,
+                                               value_t, value_t, value_t)>(
+            function)(args[0], args[1], args[2], args[3], args[4], args[5]);
+        break;
+    }
+
+    if (call_context.dest_type != &ffi_type_void) {
+      SetValue<value_t>(call_context.dest_slot,
+                        result & TypeMask(call_context.dest_type));
+    }
+  }
+
+  /**
+   * Returns the mask of the bits an integer of the given type occupies
+   */
+  static ALWAYS_INLINE inline value_t TypeMask(const ffi_type *type) {
+    return type->size >= sizeof(value_t)
+               ? ~static_cast<value_t>(0)
+               : (static_cast<value_t>(1) << (type->size * 8)) - 1;
+  }
+
   ALWAYS_INLINE inline const Instruction *call_internalHandler(
       const Instruction *instruction) {
     const InternalCallInstruction *call_instruction =
@@ -1081,6 +1151,98 @@ class BytecodeInterpreter {
     return AdvanceIP<1>(instruction);
   }
 
+  // Superinstructions. A fused compare and branch still writes the result of
+  // the compare, since other instructions may use it as well.
+
+  template <typename type_t, typename compare_t>
+  ALWAYS_INLINE inline const Instruction *CompareAndBranch(
+      const Instruction *instruction) {
+    bool result = compare_t()(GetValue<type_t>(instruction->args[1]),
+                              GetValue<type_t>(instruction->args[2]));
+    SetValue<value_t>(instruction->args[0], static_cast<value_t>(result));
+    return bytecode_function_.GetIPFromIndex(
+        result ? instruction->args[3] : instruction->args[4]);
+  }
+
+  template <typename type_t>
+  ALWAYS_INLINE inline const Instruction *cmp_eq_branchHandler(
+      const Instruction *instruction) {
+    return CompareAndBranch<type_t, std::equal_to<type_t>>(instruction);
+  }
+
+  template <typename type_t>
+  ALWAYS_INLINE inline const Instruction *cmp_ne_branchHandler(
+      const Instruction *instruction) {
+    return CompareAndBranch<type_t, std::not_equal_to<type_t>>(instruction);
+  }
+
+  template <typename type_t>
+  ALWAYS_INLINE inline const Instruction *cmp_gt_branchHandler(
+      const Instruction *instruction) {
+    return CompareAndBranch<type_t, std::greater<type_t>>(instruction);
+  }
+
+  template <typename type_t>
+  ALWAYS_INLINE inline const Instruction *cmp_lt_branchHandler(
+      const Instruction *instruction) {
+    return CompareAndBranch<type_t, std::less<type_t>>(instruction);
+  }
+
+  template <typename type_t>
+  ALWAYS_INLINE inline const Instruction *cmp_ge_branchHandler(
+      const Instruction *instruction) {
+    return CompareAndBranch<type_t, std::greater_equal<type_t>>(instruction);
+  }
+
+  template <typename type_t>
+  ALWAYS_INLINE inline const Instruction *cmp_le_branchHandler(
+      const Instruction *instruction) {
+    return CompareAndBranch<type_t, std::less_equal<type_t>>(instruction);
+  }
+
+  template <typename type_t>
+  ALWAYS_INLINE inline const Instruction *cmp_sgt_branchHandler(
+      const Instruction *instruction) {
+    using type_signed_t = typename std::make_signed<type_t>::type;
+    return CompareAndBranch<type_signed_t, std::greater<type_signed_t>>(
+        instruction);
+  }
+
+  template <typename type_t>
+  ALWAYS_INLINE inline const Instruction *cmp_slt_branchHandler(
+      const Instruction *instruction) {
+    using type_signed_t = typename std::make_signed<type_t>::type;
+    return CompareAndBranch<type_signed_t, std::less<type_signed_t>>(
+        instruction);
+  }
+
+  template <typename type_t>
+  ALWAYS_INLINE inline const Instruction *cmp_sge_branchHandler(
+      const Instruction *instruction) {
+    using type_signed_t = typename std::make_signed<type_t>::type;
+    return CompareAndBranch<type_signed_t, std::greater_equal<type_signed_t>>(
+        instruction);
+  }
+
+  template <typename type_t>
+  ALWAYS_INLINE inline const Instruction *cmp_sle_branchHandler(
+      const Instruction *instruction) {
+    using type_signed_t = typename std::make_signed<type_t>::type;
+    return CompareAndBranch<type_signed_t, std::less_equal<type_signed_t>>(
+        instruction);
+  }
+
+  template <typename type_t>
+  ALWAYS_INLINE inline const Instruction *gep_offset_loadHandler(
+      const Instruction *instruction) {
+    uintptr_t address = GetValue<uintptr_t>(instruction->args[1]) +
+                        static_cast<uintptr_t>(instruction->args[2]);
+    SetValue<uintptr_t>(instruction->args[3], address);
+    SetValue<type_t>(instruction->args[0],
+                     *reinterpret_cast<type_t *>(address));
+    return AdvanceIP<2>(instruction);
+  }
+
   // The handlers for explicit calls are generated using templates.
   //
   // The call arrives in explicit_callHandler(...), which is overloaded for
@@ -13,8 +13,10 @@
 #pragma once
 
 #include "codegen/aggregation.h"
+#include "codegen/direct_mapped_table.h"
 #include "codegen/oa_hash_table.h"
 #include "codegen/operator/operator_translator.h"
+#include "codegen/packed_key.h"
 #include "codegen/updateable_storage.h"
 
 namespace peloton {
@@ -61,7 +63,8 @@ class HashGroupByTranslator : public OperatorTranslator {
    public:
     // Constructor
     ProduceResults(ConsumerContext &ctx, const planner::AggregatePlan &plan,
-                   const Aggregation &aggregation);
+                   const Aggregation &aggregation,
+                   const PackedKey *packed_key);
 
     // The callback
     void ProcessEntries(CodeGen &codegen, llvm::Value *start, llvm::Value *end,
@@ -72,6 +75,8 @@ class HashGroupByTranslator : public OperatorTranslator {
     ConsumerContext &ctx_;
     const planner::AggregatePlan &plan_;
     const Aggregation &aggregation_;
+    // The layout of the keys in the table, if they are packed
+    const PackedKey *packed_key_;
   };
 
   //===--------------------------------------------------------------------===//
@@ -169,6 +174,17 @@ class HashGroupByTranslator : public OperatorTranslator {
   void CollectHashKeys(RowBatch::Row &row,
                        std::vector<codegen::Value> &key) const;
 
+  // Convert the grouping key into the key of the hash table
+  std::vector<codegen::Value> GetHashTableKey(
+      CodeGen &codegen, const std::vector<codegen::Value> &key) const;
+
+  // Find the value ranges of the grouping columns for a direct-mapped table
+  bool CollectKeyRanges(
+      std::vector<DirectMappedTable::KeyRange> &key_ranges) const;
+
+  // Should groups be stored in a direct-mapped table?
+  bool UseDirectMapping() const { return direct_map_.GetNumSlots() > 0; }
+
   // Estimate the size of the constructed hash table
   uint64_t EstimateHashTableSize() const;
 
@@ -185,6 +201,14 @@ class HashGroupByTranslator : public OperatorTranslator {
   // The hash table
   OAHashTable hash_table_;
 
+  // The packed layout of the keys in the hash table, if they can be packed
+  PackedKey packed_key_;
+
+  // The table of groups whose keys are in the direct-mapped domain, if any,
+  // and its ID in the runtime state
+  DirectMappedTable direct_map_;
+  QueryState::Id direct_map_id_;
+
   // The aggregation handler
   Aggregation aggregation_;
 };
@@ -80,6 +80,37 @@ class HashJoinTranslator : public OperatorTranslator {
   void CodegenHashProbe(ConsumerContext &context, RowBatch::Row &row,
                         std::vector<codegen::Value> &key) const;
 
+  /// Send a probe-side row without a join partner up to the parent
+  void ConsumeUnmatchedProbe(ConsumerContext &context,
+                             RowBatch::Row &row) const;
+
+  /// Scan the hash table after the probe and send up the build-side tuples
+  /// whose output depends on whether they found a join partner
+  void ProduceBuildTuples(ConsumerContext &context) const;
+
+  /// Load the build-side attributes stored in a hash table entry into the row
+  void RegisterBuildAttributes(CodeGen &codegen, RowBatch::Row &row,
+                               const std::vector<codegen::Value> &key,
+                               llvm::Value *data_area) const;
+
+  /// Register a NULL value for each of the given attributes in the row
+  void RegisterNullAttributes(
+      CodeGen &codegen, RowBatch::Row &row,
+      const std::vector<const planner::AttributeInfo *> &ais) const;
+
+  /// Does the join keep a match flag in every hash table entry? This is true
+  /// for joins whose output includes build-side tuples without a partner
+  /// (LEFT, OUTER) and for joins that only output build-side tuples (SEMI,
+  /// ANTI).
+  bool TracksBuildMatches() const;
+
+  /// Does the join output probe-side tuples without a partner (RIGHT, OUTER)?
+  bool EmitsUnmatchedProbes() const;
+
+  /// Does the probe output joined pairs of tuples? Semi and anti joins only
+  /// mark the matching build-side tuples.
+  bool EmitsJoinedRows() const;
+
   /// Estimate the size of the constructed hash table
   uint64_t EstimateHashTableSize() const;
 
@@ -100,6 +131,10 @@ class HashJoinTranslator : public OperatorTranslator {
   /// Callback used when inserting a tuple in the hash table during build
   class InsertLeft;
 
+  /// Callback used when scanning the hash table for build-side tuples once
+  /// the probe is over
+  class ProduceLeft;
+
  private:
   // The build-side pipeline
   Pipeline left_pipeline_;
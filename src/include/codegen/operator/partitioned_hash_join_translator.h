@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// partitioned_hash_join_translator.h
+//
+// Identification:
+// src/include/codegen/operator/partitioned_hash_join_translator.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "codegen/compilation_context.h"
+#include "codegen/consumer_context.h"
+#include "codegen/hash_table.h"
+#include "codegen/operator/operator_translator.h"
+#include "codegen/radix_partitioner.h"
+
+namespace peloton {
+
+namespace planner {
+class HashJoinPlan;
+}  // namespace planner
+
+namespace codegen {
+
+//===----------------------------------------------------------------------===//
+// The translator for a radix-partitioned inner hash join.
+//
+// Both inputs are materialized and scattered into the same number of
+// partitions by the high bits of the join key's hash. Once both sides have
+// been partitioned, the join becomes the source of its parent pipeline: for
+// each partition, a hash table is built over the build-side tuples and probed
+// with the probe-side tuples of the same partition. The number of partitions
+// is chosen such that every such hash table fits into the cache. Partitions
+// are independent of each other, so they are joined in parallel when the
+// parent pipeline allows it.
+//===----------------------------------------------------------------------===//
+class PartitionedHashJoinTranslator : public OperatorTranslator {
+ public:
+  PartitionedHashJoinTranslator(const planner::HashJoinPlan &join,
+                                CompilationContext &context,
+                                Pipeline &pipeline);
+
+  void InitializeQueryState() override;
+
+  void DefineAuxiliaryFunctions() override {}
+
+  void Produce() const override;
+
+  void Consume(ConsumerContext &context, RowBatch::Row &row) const override;
+
+  void RegisterPipelineState(PipelineContext &pipeline_ctx) override;
+  void InitializePipelineState(PipelineContext &pipeline_ctx) override;
+  void TearDownPipelineState(PipelineContext &pipeline_ctx) override;
+  void FinishPipeline(PipelineContext &pipeline_ctx) override;
+
+  void TearDownQueryState() override;
+
+ private:
+  /// Join the partitions in the range [start, end)
+  void JoinPartitions(ConsumerContext &context, llvm::Value *start,
+                      llvm::Value *end) const;
+
+  /// Is the given pipeline one of the two partitioning pipelines?
+  bool IsLeftPipeline(const Pipeline &pipeline) const {
+    return pipeline == left_pipeline_;
+  }
+
+  bool IsRightPipeline(const Pipeline &pipeline) const {
+    return pipeline == right_pipeline_;
+  }
+
+  /// Register the values of the given attributes and of the column keys
+  void RegisterAttributes(
+      CodeGen &codegen, RowBatch::Row &row,
+      const std::vector<const expression::AbstractExpression *> &key_exprs,
+      const std::vector<codegen::Value> &key,
+      const std::vector<const planner::AttributeInfo *> &val_ais,
+      const CompactStorage &val_storage, llvm::Value *data_area) const;
+
+  const planner::HashJoinPlan &GetJoinPlan() const;
+
+ private:
+  /// Callback used for each probe-side tuple of a partition
+  class ProbePartition;
+
+  /// Callback used for each build-side tuple matching a probe-side tuple
+  class ProbeMatch;
+
+ private:
+  // The pipelines partitioning the build and the probe side
+  Pipeline left_pipeline_;
+  Pipeline right_pipeline_;
+
+  // The global partitioners and the hash table used by serial joins
+  QueryState::Id left_partitioner_id_;
+  QueryState::Id right_partitioner_id_;
+  QueryState::Id hash_table_id_;
+
+  // The thread-local partitioners and the thread-local hash table
+  PipelineContext::Id left_partitioner_tl_id_;
+  PipelineContext::Id right_partitioner_tl_id_;
+  PipelineContext::Id hash_table_tl_id_;
+
+  // The partitioners of both sides
+  RadixPartitioner left_partitioner_;
+  RadixPartitioner right_partitioner_;
+
+  // The hash table built over each partition of the build side
+  HashTable hash_table_;
+
+  // The left and right hash key expressions
+  std::vector<const expression::AbstractExpression *> left_key_exprs_;
+  std::vector<const expression::AbstractExpression *> right_key_exprs_;
+
+  // The (unique) set of non-key attributes materialized from each side
+  std::vector<const planner::AttributeInfo *> left_val_ais_;
+  std::vector<const planner::AttributeInfo *> right_val_ais_;
+
+  // The storage format of the non-key attributes of each side
+  CompactStorage left_value_storage_;
+  CompactStorage right_value_storage_;
+};
+
+}  // namespace codegen
+}  // namespace peloton
@@ -20,7 +20,12 @@
 
 namespace peloton {
 
+namespace expression {
+class AbstractExpression;
+}  // namespace expression
+
 namespace planner {
+class AttributeInfo;
 class SeqScanPlan;
 }  // namespace planner
 
@@ -63,6 +68,10 @@ class TableScanTranslator : public OperatorTranslator {
   void ProduceSerial() const;
   void ProduceParallel() const;
 
+  // Split the scan predicate into the conjuncts we evaluate with SIMD
+  // instructions and the ones we evaluate row by row
+  void ClassifyConjuncts(const expression::AbstractExpression &predicate);
+
   // Plan accessor
   const planner::SeqScanPlan &GetScanPlan() const;
 
@@ -71,9 +80,47 @@ class TableScanTranslator : public OperatorTranslator {
   class AttributeAccess;
   class ScanConsumer;
 
+  // A conjunct of the scan predicate that compares a fixed-width column with
+  // a constant or query parameter
+  struct SIMDPredicate {
+    // The column being compared
+    const planner::AttributeInfo *ai;
+    // The comparison, with the column on the left-hand side
+    ExpressionType cmp_type;
+    // The constant or parameter on the right-hand side
+    const expression::AbstractExpression *constant;
+    // The type both sides are compared as
+    peloton::type::TypeId compare_type;
+  };
+
+  // A conjunct of the scan predicate that compares a varlen column with a
+  // constant or query parameter. In tile groups where the column is
+  // dictionary-encoded, it is evaluated by comparing the pointers to the
+  // column's values with the range of dictionary entries that qualify.
+  struct DictionaryPredicate {
+    // The column being compared
+    const planner::AttributeInfo *ai;
+    // The comparison, with the column on the left-hand side
+    ExpressionType cmp_type;
+    // The constant or parameter on the right-hand side
+    const expression::AbstractExpression *constant;
+    // The conjunct, evaluated as usual where the column isn't encoded
+    const expression::AbstractExpression *predicate;
+  };
+
  private:
   // The code-generating table instance
   codegen::Table table_;
+
+  // The conjuncts of the predicate evaluated on column vectors
+  std::vector<SIMDPredicate> simd_predicates_;
+
+  // The remaining conjuncts, evaluated on each row that passed the former
+  std::vector<const expression::AbstractExpression *> residual_predicates_;
+
+  // The conjuncts evaluated on each row after the residual ones, using the
+  // dictionary of the column where there is one
+  std::vector<DictionaryPredicate> dictionary_predicates_;
 };
 
 }  // namespace codegen
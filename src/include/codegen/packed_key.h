@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// packed_key.h
+//
+// Identification: src/include/codegen/packed_key.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "codegen/codegen.h"
+#include "codegen/hash_table.h"
+#include "codegen/value.h"
+#include "codegen/type/type.h"
+
+namespace peloton {
+namespace codegen {
+
+/**
+ * A normalized form of a multi-column key made of small fixed-width values,
+ * e.g., booleans, integers and dates. The columns are packed into a single
+ * 32- or 64-bit integer, each column in its own bit range followed by a bit
+ * that is set when the column is NULL. Hence, a hash table keyed on the packed
+ * form hashes one value and compares keys with one integer comparison instead
+ * of column by column. It also doesn't need the NULL bitmap of CompactStorage.
+ *
+ * Two keys pack to the same integer if and only if all their columns are equal
+ * or NULL in both keys, which is exactly the grouping semantics of SQL.
+ */
+class PackedKey {
+ public:
+  PackedKey();
+
+  /**
+   * @brief Set up the layout for keys of the given types
+   *
+   * @return True if the key can be packed and packing is worth it
+   */
+  bool Setup(CodeGen &codegen, const std::vector<type::Type> &key_type);
+
+  /**
+   * @brief Pack the given key into a single (non-NULL) value
+   */
+  codegen::Value Pack(CodeGen &codegen,
+                      const std::vector<codegen::Value> &key) const;
+
+  /**
+   * @brief Restore the columns of a key from its packed form
+   */
+  void Unpack(CodeGen &codegen, const codegen::Value &packed,
+              std::vector<codegen::Value> &key) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///
+  /// Accessors
+  ///
+  //////////////////////////////////////////////////////////////////////////////
+
+  bool IsPacked() const { return !columns_.empty(); }
+
+  const type::Type &GetPackedType() const { return packed_type_; }
+
+  uint32_t GetNumBits() const { return num_bits_; }
+
+  /**
+   * A random-access interface over a hash table keyed on packed keys that
+   * exposes the original key columns
+   */
+  class UnpackingAccess : public HashTable::HashTableAccess {
+   public:
+    UnpackingAccess(const PackedKey &packed_key,
+                    HashTable::HashTableAccess &access)
+        : packed_key_(packed_key), access_(access) {}
+
+    void ExtractBucketKeys(CodeGen &codegen, llvm::Value *index,
+                           std::vector<codegen::Value> &keys) const override;
+
+    llvm::Value *BucketValue(CodeGen &codegen,
+                             llvm::Value *index) const override {
+      return access_.BucketValue(codegen, index);
+    }
+
+   private:
+    // The layout of keys
+    const PackedKey &packed_key_;
+    // The access over the packed entries
+    HashTable::HashTableAccess &access_;
+  };
+
+ private:
+  // The placement of one column in the packed form
+  struct Column {
+    // The type of the column
+    type::Type type;
+    // The LLVM type the column is materialized as
+    llvm::Type *llvm_type;
+    // The position of the lowest bit of the column's value
+    uint32_t offset;
+    // The number of bits of the value. The NULL bit of nullable columns
+    // follows them.
+    uint32_t width;
+
+    Column(const type::Type &_type, llvm::Type *_llvm_type, uint32_t _offset,
+           uint32_t _width)
+        : type(_type), llvm_type(_llvm_type), offset(_offset), width(_width) {}
+  };
+
+  // The columns of the key
+  std::vector<Column> columns_;
+
+  // The number of bits used, and the type of the packed form
+  uint32_t num_bits_;
+  type::Type packed_type_;
+};
+
+}  // namespace codegen
+}  // namespace peloton
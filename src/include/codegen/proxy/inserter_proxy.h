@@ -27,6 +27,7 @@ PROXY(Inserter) {
   DECLARE_METHOD(AllocateTupleStorage);
   DECLARE_METHOD(GetPool);
   DECLARE_METHOD(Insert);
+  DECLARE_METHOD(Flush);
   DECLARE_METHOD(TearDown);
 };
 
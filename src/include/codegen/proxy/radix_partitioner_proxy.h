@@ -0,0 +1,39 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// radix_partitioner_proxy.h
+//
+// Identification: src/include/codegen/proxy/radix_partitioner_proxy.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "codegen/proxy/proxy.h"
+#include "codegen/util/radix_partitioner.h"
+
+namespace peloton {
+namespace codegen {
+
+PROXY(RadixPartitioner) {
+  DECLARE_MEMBER(0, char[sizeof(util::RadixPartitioner)], opaque);
+  DECLARE_TYPE;
+
+  // Proxy all methods that will be called from codegen
+  DECLARE_METHOD(Init);
+  DECLARE_METHOD(Insert);
+  DECLARE_METHOD(FlushBuffers);
+  DECLARE_METHOD(TransferPartitions);
+  DECLARE_METHOD(LinkPartition);
+  DECLARE_METHOD(BuildPartitionTable);
+  DECLARE_METHOD(ReleasePartition);
+  DECLARE_METHOD(Destroy);
+};
+
+TYPE_BUILDER(RadixPartitioner, util::RadixPartitioner);
+
+}  // namespace codegen
+}  // namespace peloton
@@ -31,7 +31,14 @@ PROXY(Sorter) {
                  opaque1);
   DECLARE_MEMBER(1, char **, tuples_start);
   DECLARE_MEMBER(2, char **, tuples_end);
-  DECLARE_MEMBER(3, char[sizeof(std::vector<std::pair<void *, uint64_t>>)],
+  DECLARE_MEMBER(3,
+                 char[sizeof(std::vector<std::pair<void *, uint64_t>>) +
+                      sizeof(void *) +               // executor context
+                      sizeof(std::vector<std::unique_ptr<
+                          ::peloton::util::SpillFile>>) +  // run files
+                      sizeof(std::vector<util::Sorter::Run>) +  // runs
+                      sizeof(std::unique_ptr<
+                          ::peloton::util::SpillFile>)],   // output file
                  opaque2);
   DECLARE_TYPE;
   // clang-format on
@@ -12,6 +12,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+
 #include "codegen/code_context.h"
 #include "codegen/parameter_cache.h"
 #include "codegen/query_parameters.h"
@@ -38,6 +43,9 @@ class ExecutionConsumer;
 // of by codegen::QueryCompiler::Compile(). The former method is purely for
 // testing purposes. The system uses QueryCompiler to generate compiled query
 // objects.
+//
+// A query can be compiled on the compiler threads (see CompileAsync()). Until
+// its native code is ready, executions interpret the query's bytecode.
 //===----------------------------------------------------------------------===//
 class Query {
  public:
@@ -68,6 +76,31 @@ class Query {
 
   using compiled_function_t = void (*)(FunctionArguments *);
 
+  //===--------------------------------------------------------------------===//
+  // Where the result of recompiling a query in the background goes. The
+  // target may outlive its query: if the query has been evicted from the
+  // cache by the time the recompilation is done, the result is dropped.
+  //===--------------------------------------------------------------------===//
+  class RecompilationTarget {
+   public:
+    explicit RecompilationTarget(Query *query) : query_(query) {}
+
+    /// Hand over the recompiled query, along with the plan it was compiled
+    /// from. The recompiled code may refer to the plan, so the two are kept
+    /// together.
+    void Install(std::unique_ptr<Query> &&recompiled,
+                 std::shared_ptr<planner::AbstractPlan> plan);
+
+   private:
+    friend class Query;
+
+    // Protects the query pointer
+    std::mutex lock_;
+
+    // The query that is recompiled, or NULL if it has been destroyed
+    Query *query_;
+  };
+
   struct CompiledFunctions {
     compiled_function_t init_func;
     compiled_function_t plan_func;
@@ -77,6 +110,9 @@ class Query {
   /// This class cannot be copy or move-constructed
   DISALLOW_COPY_AND_MOVE(Query);
 
+  /// Destructor
+  ~Query();
+
   /**
    * @brief Setup this query with the given JITed function components
    *
@@ -84,9 +120,19 @@ class Query {
    */
   void Prepare(const LLVMFunctions &funcs);
 
-  // Compiles the function in this query to native code
+  // Optimizes and compiles the function in this query to native code
   void Compile(CompileStats *stats = nullptr);
 
+  /**
+   * @brief Compile the query on the compiler threads. Executions interpret the
+   * query until the native code is ready, or wait for it if the interpreter
+   * cannot run the query.
+   *
+   * @return A future that is ready once the query is compiled. Compilation
+   * errors are reported through it.
+   */
+  std::shared_future<void> CompileAsync();
+
   /**
    * @brief Executes the compiled query.
    *
@@ -112,12 +158,40 @@ class Query {
   /// The class tracking all the state needed by this query
   QueryState &GetQueryState() { return query_state_; }
 
+  /// Is the native code of the query ready?
+  bool IsCompiled() const { return is_compiled_; }
+
+  /// The level the code of the query was optimized at
+  OptimizationLevel GetOptimizationLevel() const { return opt_level_; }
+
+  /// The number of times the query has been executed
+  uint64_t GetNumExecutions() const { return num_executions_; }
+
+  /// Check if the query has run often enough to be worth recompiling at the
+  /// aggressive optimization level. Returns true at most once per query. The
+  /// caller then recompiles the query and hands the result to the target.
+  bool NeedsRecompilation();
+
+  /// Get the target for the result of recompiling this query
+  std::shared_ptr<RecompilationTarget> GetRecompilationTarget() const {
+    return recompilation_target_;
+  }
+
+  /// Do executions of this query run the code of a recompilation?
+  bool IsRecompiled() const { return recompiled_ != nullptr; }
+
  private:
   friend class QueryCompiler;
 
+  // The bytecode of the query functions
+  struct BytecodeFunctions;
+
   /// Constructor. Private so callers use the QueryCompiler class.
   explicit Query(const planner::AbstractPlan &query_plan);
 
+  // Translate the query functions to bytecode
+  std::unique_ptr<BytecodeFunctions> CreateBytecode() const;
+
   // Execute the query as native code (must already be compiled)
   void ExecuteNative(FunctionArguments *function_arguments,
                      RuntimeStats *stats);
@@ -142,8 +216,39 @@ class Query {
   // Pointers to the compiled query functions
   CompiledFunctions compiled_functions_;
 
+  // The size of the arguments the query functions take
+  size_t parameter_size_;
+
   // Shows if the query has been compiled to native code
-  bool is_compiled_;
+  std::atomic<bool> is_compiled_;
+
+  // The bytecode that is interpreted while the query compiles in the
+  // background, if the interpreter supports the query
+  std::unique_ptr<BytecodeFunctions> bytecode_;
+
+  // The pending compilation on the compiler threads, and whether it should be
+  // skipped because the query is being destroyed
+  std::shared_future<void> compilation_;
+  std::atomic<bool> cancelled_;
+
+  // The level the code is optimized at
+  OptimizationLevel opt_level_;
+
+  // The number of executions
+  std::atomic<uint64_t> num_executions_;
+
+  // Whether a recompilation has been requested
+  std::atomic<bool> recompiling_;
+
+  // The result of the recompilation, and the plan copy it was compiled from
+  std::shared_ptr<planner::AbstractPlan> recompiled_plan_;
+  std::unique_ptr<Query> recompiled_query_;
+
+  // The recompiled query, once executions should use it
+  std::atomic<Query *> recompiled_;
+
+  // Where the recompiled query is delivered
+  std::shared_ptr<RecompilationTarget> recompilation_target_;
 };
 
 }  // namespace codegen
@@ -12,7 +12,10 @@
 
 #pragma once
 
+#include <functional>
+#include <future>
 #include <list>
+#include <mutex>
 
 #include "codegen/query.h"
 #include "common/synchronization/readwrite_latch.h"
@@ -24,11 +27,12 @@ namespace codegen {
 
 // Query cache implementation that maps an AbstractPlan with a CodeGen query
 // using LRU eviction policy. The cache is implemented as a singleton.
+// The machine code of compiled queries is also kept on disk by the
+// CompiledCodeCache, so that it survives restarts.
 // Potential enhancements (major):
-//   1) Persistency may increase the performance when rebooted
-//   2) Apply other eviction policies
+//   1) Apply other eviction policies
 //     e.g. Keep some heavy compilation workloads by mixing policies
-//   3) Have a cache per table
+//   2) Have a cache per table
 // Potential enhancements (minor):
 //   1) Manually keep some of the compiled results in the cache
 //   2) Configure the cache size
@@ -41,6 +45,12 @@ class QueryCache : public Singleton<QueryCache> {
   void Add(const std::shared_ptr<planner::AbstractPlan> &key,
            std::unique_ptr<Query> &&val);
 
+  // Find the cached query object with the given plan, or create it with the
+  // given function and add it. If several threads miss on equal plans at the
+  // same time, only one of them creates the query, and the others wait for it.
+  Query *FindOrAdd(const std::shared_ptr<planner::AbstractPlan> &key,
+                   const std::function<std::unique_ptr<Query>()> &create);
+
   // Remove all the items in the cache
   void Clear();
 
@@ -77,6 +87,14 @@ class QueryCache : public Singleton<QueryCache> {
 
   common::synchronization::ReadWriteLatch cache_lock_;
 
+  // The queries that are being created, by their plan
+  std::unordered_map<std::shared_ptr<planner::AbstractPlan>,
+                     std::shared_future<Query *>, planner::Hash,
+                     planner::Equal> pending_;
+
+  // Protects the pending queries
+  std::mutex pending_lock_;
+
   size_t capacity_ = 0;
 };
 
@@ -53,11 +53,17 @@ class QueryCompiler {
   // Compile the provided query, returning the compiled plan that can be invoked
   // to return results. Callers can also pass in an (optional) CompileStats
   // object pointer if they want to collect statistics on the compilation
-  // process.
-  std::unique_ptr<Query> Compile(const planner::AbstractPlan &query_plan,
-                                 const QueryParametersMap &parameters_map,
-                                 ExecutionConsumer &consumer,
-                                 CompileStats *stats = nullptr);
+  // process, and the level to optimize the generated code at.
+  std::unique_ptr<Query> Compile(
+      const planner::AbstractPlan &query_plan,
+      const QueryParametersMap &parameters_map, ExecutionConsumer &consumer,
+      CompileStats *stats = nullptr,
+      OptimizationLevel opt_level = OptimizationLevel::Default);
+
+  // Pick the optimization level for a query, based on the number of rows the
+  // optimizer estimates its plan to process
+  static OptimizationLevel ChooseOptimizationLevel(
+      const planner::AbstractPlan &plan);
 
   // Get the next available query plan ID
   uint64_t NextId() { return next_id_++; }
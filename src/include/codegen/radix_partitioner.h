@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// radix_partitioner.h
+//
+// Identification: src/include/codegen/radix_partitioner.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "codegen/compact_storage.h"
+#include "codegen/hash_table.h"
+
+namespace peloton {
+namespace codegen {
+
+/**
+ * This class simplifies interaction with a codegen::util::RadixPartitioner
+ * instance from generated code.
+ *
+ * Partitioned tuples are stored in the entry format of codegen::HashTable: the
+ * key columns (in compact form) are followed by an opaque value area. Hence, a
+ * partition can be turned into a HashTable with BuildPartitionTable() and be
+ * probed with HashTable::FindAll().
+ */
+class RadixPartitioner {
+ public:
+  RadixPartitioner();
+  RadixPartitioner(CodeGen &codegen, const std::vector<type::Type> &key_type,
+                   uint32_t value_size, uint32_t num_radix_bits);
+
+  /**
+   * @brief Initialize the given partitioner instance
+   */
+  void Init(CodeGen &codegen, llvm::Value *partitioner_ptr,
+            llvm::Value *exec_ctx) const;
+
+  /**
+   * @brief Hash the given key, store it in its partition and return a pointer
+   * to the value area of the new entry. The caller serializes the value there.
+   */
+  llvm::Value *Insert(CodeGen &codegen, llvm::Value *partitioner_ptr,
+                      const std::vector<codegen::Value> &key) const;
+
+  /**
+   * @brief Flush all write-combine buffers after the last insertion
+   */
+  void FlushBuffers(CodeGen &codegen, llvm::Value *partitioner_ptr) const;
+
+  /**
+   * @brief Move the partitions of all thread-local partitioners stored in the
+   * provided thread states into the given partitioner
+   */
+  void TransferPartitions(CodeGen &codegen, llvm::Value *partitioner_ptr,
+                          llvm::Value *thread_states,
+                          uint32_t partitioner_offset) const;
+
+  /**
+   * @brief Build the given hash table over the entries of one partition
+   */
+  void BuildPartitionTable(CodeGen &codegen, llvm::Value *partitioner_ptr,
+                           llvm::Value *partition, llvm::Value *ht_ptr) const;
+
+  /**
+   * @brief Release the memory of one partition once it has been processed
+   */
+  void ReleasePartition(CodeGen &codegen, llvm::Value *partitioner_ptr,
+                        llvm::Value *partition) const;
+
+  /**
+   * @brief Invoke the callback for every entry in one partition
+   */
+  void IteratePartition(CodeGen &codegen, llvm::Value *partitioner_ptr,
+                        llvm::Value *partition,
+                        HashTable::IterateCallback &callback) const;
+
+  /**
+   * @brief Destroy all resources managed by this partitioner
+   */
+  void Destroy(CodeGen &codegen, llvm::Value *partitioner_ptr) const;
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///
+  /// Accessors
+  ///
+  //////////////////////////////////////////////////////////////////////////////
+
+  uint32_t NumPartitions() const { return 1u << num_radix_bits_; }
+
+  uint32_t TupleSize() const {
+    return key_storage_.MaxStorageSize() + value_size_;
+  }
+
+ private:
+  // The size of the value area of each entry
+  uint32_t value_size_;
+
+  // The number of hash bits selecting the partition
+  uint32_t num_radix_bits_;
+
+  // The storage strategy we use to store the keys inside every entry. This
+  // matches the one of HashTable, so partitions can be probed in place.
+  CompactStorage key_storage_;
+};
+
+}  // namespace codegen
+}  // namespace peloton
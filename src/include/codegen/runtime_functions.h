@@ -78,6 +78,23 @@ class RuntimeFunctions {
   static void GetTileGroupLayout(const storage::TileGroup *tile_group,
                                  ColumnLayoutInfo *infos, uint32_t num_cols);
   
+  /**
+   * Check whether a column of the tile group is dictionary-encoded and, if so,
+   * find the entries of its dictionary that satisfy a comparison.
+   *
+   * @param tile_group The tile group that is scanned
+   * @param col_id The ID of the column in the table
+   * @param cmp_type The ExpressionType of the comparison 'column <cmp> str'
+   * @param str The string the column is compared with, or NULL
+   * @param len The length of the string
+   * @param[out] range The bounds of the entries that satisfy the comparison
+   * @return True if the column is dictionary-encoded
+   */
+  static bool GetDictionaryRange(const storage::TileGroup *tile_group,
+                                 uint32_t col_id, uint32_t cmp_type,
+                                 const char *str, uint32_t len,
+                                 const char **range);
+
   /**
    * Execute a parallel scan over the given table in the given database.
    *
@@ -106,6 +123,21 @@ class RuntimeFunctions {
       void *query_state, executor::ExecutorContext::ThreadStates &thread_states,
       void (*work_func)(void *, void *));
 
+  /**
+   * Process the partitions of a partitioned join in parallel. The partitions
+   * are split into contiguous ranges, one for each worker thread.
+   *
+   * @param query_state An opaque (but usually a JITed struct) state used during
+   * query execution.
+   * @param thread_states The set of all thread states.
+   * @param num_partitions The number of partitions to process.
+   * @param func The callback function that is provided a range of partitions
+   * to process.
+   */
+  static void ExecutePerPartition(
+      void *query_state, executor::ExecutorContext::ThreadStates &thread_states,
+      uint32_t num_partitions, void *func);
+
   //////////////////////////////////////////////////////////////////////////////
   ///
   /// Exception related functions
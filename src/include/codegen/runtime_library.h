@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// runtime_library.h
+//
+// Identification: src/include/codegen/runtime_library.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "common/singleton.h"
+
+namespace llvm {
+class LLVMContext;
+class Module;
+}  // namespace llvm
+
+namespace peloton {
+namespace codegen {
+
+//===----------------------------------------------------------------------===//
+// The LLVM bitcode of the runtime functions generated code calls, e.g., those
+// in RuntimeFunctions, ValuesRuntime, the SQL functions and the hash table.
+// The build compiles their sources with clang and embeds the bitcode into the
+// binary (see peloton_embed_runtime_bitcode() in cmake/Targets.cmake).
+//
+// Only small functions that are worth inlining are kept. Functions that touch
+// state that must exist once per process (e.g., function-local statics) are
+// left out, since linking them into a query would give it a private copy. The
+// runtime's global variables are declarations in the bitcode, which resolve to
+// the runtime's own globals when a query is loaded.
+//
+// A builtin is matched to its bitcode by the address of its implementation,
+// which is the address of the symbol the bitcode defines.
+//===----------------------------------------------------------------------===//
+class RuntimeLibrary : public Singleton<RuntimeLibrary> {
+ public:
+  /// Is there bitcode of any runtime function?
+  bool IsAvailable() const { return !functions_.empty(); }
+
+  /// Get the symbol of the function with the given address in the bitcode, or
+  /// NULL if the bitcode has no such function
+  const std::string *LookupFunction(const void *func_impl) const;
+
+  /// Load the bitcode into the given context. Function bodies are loaded
+  /// lazily, when they are linked into a query module.
+  std::unique_ptr<llvm::Module> LoadModule(llvm::LLVMContext &context) const;
+
+  /// The number of functions in the bitcode that can be inlined
+  size_t GetNumFunctions() const { return functions_.size(); }
+
+ private:
+  friend class Singleton<RuntimeLibrary>;
+
+  RuntimeLibrary();
+
+  // Reduce the embedded bitcode to the functions worth inlining
+  void Prepare(llvm::Module &module);
+
+ private:
+  // The symbols of the inlinable functions, by their address in the process
+  std::unordered_map<const void *, std::string> functions_;
+
+  // The reduced bitcode
+  std::string bitcode_;
+};
+
+}  // namespace codegen
+}  // namespace peloton
@@ -97,6 +97,13 @@ class TileGroup {
   codegen::Value LoadColumn(CodeGen &codegen, llvm::Value *tid,
                             const TileGroup::ColumnLayout &layout) const;
 
+  // Load the raw values of a fixed-width column for the vector of consecutive
+  // rows starting at the given tid. The column must be stored in columnar form.
+  llvm::Value *LoadColumnVector(CodeGen &codegen, llvm::Value *tid,
+                                const TileGroup::ColumnLayout &layout,
+                                uint32_t vector_size,
+                                llvm::Value *&is_null) const;
+
  public:
   //===--------------------------------------------------------------------===//
   // A convenience class that allows generic access (i.e., either row-oriented
@@ -134,6 +141,19 @@ class TileGroup {
     // Load a specific row from the batch
     Row GetRow(llvm::Value *tid) const;
 
+    // Load the raw values of the fixed-width column at the given index for the
+    // rows [tid, tid + vector_size). If the column is nullable, a vector of
+    // NULL flags is returned through 'is_null', otherwise it is set to null.
+    llvm::Value *LoadColumnVector(CodeGen &codegen, uint32_t col_idx,
+                                  llvm::Value *tid, uint32_t vector_size,
+                                  llvm::Value *&is_null) const;
+
+    // Is the column at the given index stored in columnar form in this tile
+    // group? Only then can it be loaded as a vector.
+    llvm::Value *IsColumnar(uint32_t col_idx) const {
+      return layout_[col_idx].is_columnar;
+    }
+
     //===------------------------------------------------------------------===//
     // ACCESSORS
     //===------------------------------------------------------------------===//
@@ -39,17 +39,28 @@ namespace util {
  * quoting character, and escape characters can also be configured through the
  * constructor.
  *
+ * The file is read in large segments that are parsed in parallel. Every
+ * segment is split into one chunk per worker of the execution pool. The chunks
+ * are first scanned for quotes to learn whether each begins inside a quoted
+ * section, then for the rows beginning in them, and finally the rows are split
+ * into columns. The structural characters are found with SIMD compares.  The
+ * callback is still invoked on the calling thread, one row at a time and in the
+ * order of the file.
+ *
  * This scanner class is fail-fast. If it finds an ill-formatted row, it will
- * immediately throw an error.
+ * throw an error after all the rows before it were produced.
  *
  * TODO: implement a more generous parser that is best-effort.
  */
 class CSVScanner {
  public:
-  // 64K buffer size
+  // 64K buffer size, which is also the smallest chunk parsed by a worker
   static constexpr uint32_t kDefaultBufferSize = (1ul << 16ul);
 
-  // We allocate a maximum of 1GB for the line buffer
+  // 16M segments are read from the file and parsed at a time
+  static constexpr uint64_t kSegmentSize = (1ul << 24ul);
+
+  // We allocate a maximum of 1GB for the segment buffer
   static constexpr uint64_t kMaxAllocSize = (1ul << 30ul);
 
   // The signature of the callback function
@@ -76,11 +87,11 @@ class CSVScanner {
    * This structure tracks various statistics while we scan the CSV
    */
   struct Stats {
-    // The number of times the read-buffer was copied into the line-buffer
+    // The number of times an incomplete row at the end of a segment was copied
+    // to the front of the buffer to be completed by the next segment
     uint32_t num_copies = 0;
-    // The number of times we had to re-allocate the line-buffer to make room
-    // for new data (i.e., to handle really long lines that don't fit into the
-    // read-buffer)
+    // The number of times we had to re-allocate the buffer to make room for new
+    // data (i.e., to handle really long lines that don't fit into a segment)
     uint32_t num_reallocs = 0;
     // The number of times we had to call Read() from the file
     uint32_t num_reads = 0;
@@ -155,20 +166,37 @@ class CSVScanner {
   const Column *GetColumns() const { return cols_; }
 
  private:
+  // A part of a segment that is parsed by one worker
+  struct Chunk;
+
   // Initialize the scan
   void Initialize();
 
-  // Append bytes to the end of the line buffer
-  void AppendToLineBuffer(const char *data, uint32_t len);
+  // Read the rest of the segment from the CSV file after the given number of
+  // bytes carried over from the last one. Returns false at the end of the file.
+  bool NextBuffer(uint64_t num_carried);
+
+  // Double the size of the buffer to fit a row longer than a segment
+  void GrowBuffer();
 
-  // Read the next line from the CSV file
-  char *NextLine();
+  // Produce the rows of the segment in the buffer. The last row is produced
+  // only at the end of the file, as it may continue in the next segment.
+  // Returns the number of bytes of the rows produced.
+  uint64_t ProduceSegment(bool at_eof);
 
-  // Read a buffer's worth of data from the CSV file
-  bool NextBuffer();
+  // Find the quoting state at the end of the chunk for every quoting state it
+  // could begin with
+  void FindQuoteStates(Chunk &chunk) const;
 
-  // Produce CSV data stored in the provided line
-  void ProduceCSV(char *line);
+  // Find the rows beginning in the chunk
+  void FindRows(Chunk &chunk) const;
+
+  // Split the rows beginning in the chunk into columns
+  void ParseRows(Chunk &chunk) const;
+
+  // Split the row in [iter, end) into columns, unescaping them in place
+  void ParseRow(char *iter, char *end, uint32_t line_number,
+                Column *cols) const;
 
  private:
   // All memory allocations happen from this pool
@@ -180,16 +208,11 @@ class CSVScanner {
   // The CSV file handle
   peloton::util::File file_;
 
-  // The temporary read-buffer where raw file contents are first read into
-  // TODO: make these unique_ptr's with a customer deleter
+  // The buffer where segments of the file are read into and parsed in place
+  // TODO: make this a unique_ptr with a customer deleter
   char *buffer_;
-  uint32_t buffer_pos_;
-  uint32_t buffer_end_;
-
-  // A pointer to the start of a line in the CSV file
-  char *line_;
-  uint32_t line_len_;
-  uint32_t line_maxlen_;
+  uint64_t buffer_size_;
+  uint64_t buffer_end_;
 
   // Line number
   uint32_t line_number_;
@@ -269,6 +269,19 @@ class HashTable {
     uint64_t available_bytes_;
   };
 
+  /**
+   * Rebuild the directory of this hash table over a linked list of entries
+   * that live outside of this table, e.g., a partition of a RadixPartitioner.
+   * Any previous contents of the directory are dropped, so a single table can
+   * be reused to build over many partitions one after another. The entries
+   * remain owned by the caller.
+   *
+   * @param head The head of the list of entries, linked through their next
+   * pointers
+   * @param num_elems The number of entries in the list
+   */
+  void BuildFromEntries(Entry *head, uint64_t num_elems);
+
  private:
   // Does the hash table need resizing?
   bool NeedsResize() const { return num_elems_ == capacity_; }
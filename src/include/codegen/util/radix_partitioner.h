@@ -0,0 +1,271 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// radix_partitioner.h
+//
+// Identification: src/include/codegen/util/radix_partitioner.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "codegen/util/hash_table.h"
+#include "executor/executor_context.h"
+#include "util/spill_file.h"
+
+namespace peloton {
+
+namespace type {
+class AbstractPool;
+}  // namespace type
+
+namespace codegen {
+namespace util {
+
+/**
+ * A RadixPartitioner scatters fixed-size tuples into 2^k partitions using the
+ * k most significant bits of their hash values. It is the building block of
+ * the partitioned hash join: both join inputs are partitioned with the same
+ * number of bits, after which each pair of partitions can be joined on its
+ * own with a hash table that fits into the cache.
+ *
+ * Tuples are stored in the same format as the entries of util::HashTable, so
+ * a partition of the build side can be turned into a hash table without
+ * copying (see BuildPartitionTable()).
+ *
+ * Scattering tuples to many partitions thrashes the TLB and the cache. To
+ * avoid this, insertions go into a small software write-combine buffer per
+ * partition, which is only copied to the partition's memory once it is full.
+ * Like Sorter, the partitioner hands out space for a tuple and relies on the
+ * caller to serialize the tuple into it. A slot stays valid until the next
+ * call to Insert(), FlushBuffers() or TransferPartitions().
+ *
+ * For parallel partitioning, every thread fills its own partitioner. The
+ * partitions of all thread-local partitioners are then moved into a global one
+ * with TransferPartitions().
+ *
+ * A partitioner bound to an executor context with a memory budget turns into
+ * the partitioning phase of a grace hash join once the query exceeds the
+ * budget: whenever a partition needs a new block, its full blocks are written
+ * to a spill file and released. LinkPartition() reads the spilled entries of
+ * a partition back, and ReleasePartition() frees them again once the
+ * partition has been joined, so only one pair of partitions has to be in
+ * memory at a time.
+ */
+class RadixPartitioner {
+ public:
+  /// The number of bytes in each write-combine buffer
+  static constexpr uint32_t kWriteCombineSize = 256;
+
+  /// The partition size we aim for when choosing the number of radix bits
+  static constexpr uint64_t kTargetPartitionSize = 256 * 1024;
+
+  /// The maximum number of radix bits, bounding the fan-out of a single pass
+  static constexpr uint32_t kMaxRadixBits = 10;
+
+  /**
+   * Constructor.
+   *
+   * @param memory The memory pool all allocations are sourced from
+   * @param tuple_size The size of the tuples (without the entry header)
+   * @param num_radix_bits The number of hash bits used to pick a partition
+   * @param exec_ctx The context whose memory budget the partitioner obeys.
+   * Without one, the partitioner never spills to disk.
+   */
+  RadixPartitioner(::peloton::type::AbstractPool &memory, uint32_t tuple_size,
+                   uint32_t num_radix_bits,
+                   executor::ExecutorContext *exec_ctx = nullptr);
+
+  /**
+   * Destructor. Returns all memory back to the pool.
+   */
+  ~RadixPartitioner();
+
+  /**
+   * Initialize the given partitioner instance. This is called from codegen to
+   * invoke the constructor.
+   *
+   * @param partitioner The partitioner we're setting up
+   * @param exec_ctx The executor context providing the memory pool
+   * @param tuple_size The size of the tuples in bytes
+   * @param num_radix_bits The number of hash bits used to pick a partition
+   */
+  static void Init(RadixPartitioner &partitioner,
+                   executor::ExecutorContext &exec_ctx, uint32_t tuple_size,
+                   uint32_t num_radix_bits);
+
+  /**
+   * Clean up all resources allocated by the given partitioner
+   *
+   * @param partitioner The partitioner we're cleaning up
+   */
+  static void Destroy(RadixPartitioner &partitioner);
+
+  /**
+   * Make room for a tuple with the given hash value in its partition.
+   *
+   * @param hash The hash value of the tuple
+   * @return A memory region where the tuple can be serialized into
+   */
+  char *Insert(uint64_t hash);
+
+  /**
+   * Copy the contents of all write-combine buffers to the partitions. This
+   * must be called after the last insertion.
+   */
+  void FlushBuffers();
+
+  /**
+   * Move the partitions of each thread-local partitioner in the given thread
+   * states into this partitioner. The thread-local partitioners are flushed
+   * first and are empty afterwards.
+   *
+   * @param thread_states Where the thread-local partitioners are located
+   * @param partitioner_offset The offset into each state where the
+   * thread-local partitioner can be found
+   */
+  void TransferPartitions(
+      const executor::ExecutorContext::ThreadStates &thread_states,
+      uint32_t partitioner_offset);
+
+  /**
+   * Link the tuples of the given partition into a list through the next
+   * pointers of their entries. Spilled tuples are read back into memory.
+   *
+   * @param partition The partition
+   * @return The head of the list, or NULL if the partition is empty
+   */
+  HashTable::Entry *LinkPartition(uint32_t partition);
+
+  /**
+   * Build the directory of the given hash table over the tuples of the given
+   * partition. The tuples remain owned by this partitioner, and the hash table
+   * can be reused for every partition.
+   *
+   * @param partition The partition
+   * @param table The hash table that is rebuilt
+   */
+  void BuildPartitionTable(uint32_t partition, HashTable &table);
+
+  /**
+   * Release the memory held by the given partition once it is not needed
+   * anymore. The partition is empty afterwards. Different partitions can be
+   * released concurrently; NumElements() does not change.
+   *
+   * @param partition The partition
+   */
+  void ReleasePartition(uint32_t partition);
+
+  /**
+   * Choose the number of radix bits so that the partitions of an input with
+   * the given size fit into the cache.
+   *
+   * @param num_tuples The (estimated) number of tuples
+   * @param tuple_size The size of the tuples in bytes
+   * @return The number of radix bits, at least one
+   */
+  static uint32_t ChooseRadixBits(uint64_t num_tuples, uint32_t tuple_size);
+
+  //////////////////////////////////////////////////////////////////////////////
+  ///
+  /// Accessors
+  ///
+  //////////////////////////////////////////////////////////////////////////////
+
+  uint32_t NumPartitions() const { return num_partitions_; }
+
+  uint64_t NumElements() const { return num_elems_; }
+
+  uint64_t NumSpilledElements() const { return num_spilled_; }
+
+  uint64_t PartitionSize(uint32_t partition) const {
+    return partitions_[partition].num_elems;
+  }
+
+  uint32_t PartitionOf(uint64_t hash) const {
+    return static_cast<uint32_t>(hash >> radix_shift_);
+  }
+
+ private:
+  // A chunk of memory holding tuples of a single partition
+  struct Block {
+    Block *next;
+    uint32_t num_entries;
+    char data[0];
+  };
+
+  // The state of a single partition
+  struct Partition {
+    // The blocks holding the flushed entries, most recent first
+    Block *head;
+    Block *tail;
+
+    // The number of entries stored in the partition (including buffered ones)
+    uint64_t num_elems;
+
+    // The number of entries in the write-combine buffer
+    uint32_t num_buffered;
+  };
+
+  // Entries of a partition written to a spill file
+  struct Segment {
+    ::peloton::util::SpillFile *file;
+    uint64_t offset;
+    uint64_t num_entries;
+  };
+
+  // Copy the write-combine buffer of the given partition to its blocks
+  void FlushBuffer(uint32_t partition);
+
+  // Write the blocks of the given partition to disk and free them
+  void SpillPartition(uint32_t partition);
+
+  // Read the spilled entries of the given partition back into a new block
+  void LoadPartition(uint32_t partition);
+
+  // Move all blocks of the given partitioner into this one
+  void StealPartitions(RadixPartitioner &other);
+
+ private:
+  // The memory allocator used for all allocations
+  ::peloton::type::AbstractPool &memory_;
+
+  // The size of each entry (header and tuple)
+  uint32_t entry_size_;
+
+  // The number of entries per block and per write-combine buffer
+  uint32_t block_entries_;
+  uint32_t buffer_entries_;
+
+  // The number of partitions and the shift selecting the radix bits
+  uint32_t num_partitions_;
+  uint32_t radix_shift_;
+
+  // The partitions and their write-combine buffers
+  Partition *partitions_;
+  char *buffers_;
+
+  // The total number of entries
+  uint64_t num_elems_;
+
+  // The context whose memory budget we obey, NULL if there is none
+  executor::ExecutorContext *exec_ctx_;
+
+  // The spill files, and the spilled segments of each partition
+  std::vector<std::unique_ptr<::peloton::util::SpillFile>> spill_files_;
+  std::vector<std::vector<Segment>> spilled_;
+
+  // The number of entries written to disk
+  uint64_t num_spilled_;
+};
+
+}  // namespace util
+}  // namespace codegen
+}  // namespace peloton
@@ -13,9 +13,11 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "executor/executor_context.h"
+#include "util/spill_file.h"
 
 namespace peloton {
 namespace codegen {
@@ -33,12 +35,21 @@ namespace util {
  * Additionally, Sorter does not serialize elements into its memory space.
  * Instead, it allocates space for incoming tuples on demand and returns a
  * pointer to the call, relying on her to serialize into the space.
+ *
+ * If the sorter is bound to an executor context with a memory budget, it
+ * performs an external merge sort once the query exceeds the budget: the
+ * tuples collected so far are sorted and written out as a run to a spill
+ * file, and their memory is released. Sort() then merges all runs into a
+ * single sorted file, which is mapped into memory for iteration.
  */
 class Sorter {
  private:
   // We allocate 4KB of buffer space upon initialization
   static constexpr uint64_t kInitialBufferSize = 4 * 1024;
 
+  // The size of the I/O buffers used to write and merge sorted runs
+  static constexpr uint64_t kSpillBufferSize = 64 * 1024;
+
  public:
   using ComparisonFunction = int (*)(const char *left_tuple,
                                      const char *right_tuple);
@@ -55,9 +66,11 @@ class Sorter {
    * @param func The comparison function used to compare two tuples stored in
    * this sorter
    * @param tuple_size The size of the tuples stored in this sorter
+   * @param exec_ctx The context whose memory budget the sorter obeys. Without
+   * one, the sorter never spills to disk.
    */
   Sorter(::peloton::type::AbstractPool &memory, ComparisonFunction func,
-         uint32_t tuple_size);
+         uint32_t tuple_size, executor::ExecutorContext *exec_ctx = nullptr);
 
   /**
    * Destructor. This destructor cleans up returns all memory it has allocated
@@ -123,6 +136,9 @@ class Sorter {
   /** Return the number tuples stored in this sorter instance */
   uint64_t NumTuples() const { return tuples_.size(); }
 
+  /** Return the number of sorted runs spilled to disk */
+  uint64_t NumRuns() const { return runs_.size(); }
+
   /** Iterators */
   std::vector<char *>::iterator begin() { return tuples_.begin(); }
   std::vector<char *>::iterator end() { return tuples_.end(); }
@@ -143,6 +159,34 @@ class Sorter {
    */
   void TransferMemoryBlocks(Sorter &target);
 
+  /**
+   * Sort the tuples in memory, write them as a new run to disk and release
+   * their memory.
+   */
+  void SpillRun();
+
+  /**
+   * Merge all sorted runs into a single sorted file and point the tuples into
+   * its mapping.
+   */
+  void MergeRuns();
+
+  /**
+   * Transfer ownership of all spilled runs to the provided sorter instance.
+   */
+  void TransferRuns(Sorter &target);
+
+  /** Release all memory blocks back to the memory pool */
+  void FreeMemoryBlocks();
+
+ public:
+  /** A sorted run of tuples in a spill file */
+  struct Run {
+    ::peloton::util::SpillFile *file;
+    uint64_t offset;
+    uint64_t num_tuples;
+  };
+
  private:
   // The memory pool where this sorter sources memory from
   ::peloton::type::AbstractPool &memory_;
@@ -169,6 +213,16 @@ class Sorter {
 
   // The memory blocks we've allocated and their sizes
   std::vector<std::pair<void *, uint64_t>> blocks_;
+
+  // The context whose memory budget we obey, NULL if there is none
+  executor::ExecutorContext *exec_ctx_;
+
+  // The files holding the spilled runs and the runs themselves
+  std::vector<std::unique_ptr<::peloton::util::SpillFile>> run_files_;
+  std::vector<Run> runs_;
+
+  // The file holding the merged runs, which the tuples point into
+  std::unique_ptr<::peloton::util::SpillFile> output_file_;
 };
 
 }  // namespace util
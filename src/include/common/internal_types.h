@@ -742,7 +742,8 @@ enum class JoinType {
   RIGHT = 2,                  // right
   INNER = 3,                  // inner
   OUTER = 4,                  // outer
-  SEMI = 5                    // IN+Subquery is SEMI
+  SEMI = 5,                   // IN+Subquery is SEMI
+  ANTI = 6                    // NOT IN+Subquery is ANTI
 };
 std::string JoinTypeToString(JoinType type);
 JoinType StringToJoinType(const std::string &str);
@@ -820,6 +821,7 @@ std::ostream &operator<<(std::ostream &os, const CopyType &type);
 
 enum class ExternalFileFormat {
   CSV,
+  ARROW,
 };
 std::string ExternalFileFormatToString(ExternalFileFormat format);
 ExternalFileFormat StringToExternalFileFormat(const std::string &str);
@@ -1354,6 +1356,8 @@ enum class RuleType : uint32_t {
   AGGREGATE_TO_PLAIN_AGGREGATE,
   INNER_JOIN_TO_NL_JOIN,
   INNER_JOIN_TO_HASH_JOIN,
+  SEMI_JOIN_TO_HASH_JOIN,
+  MARK_JOIN_TO_HASH_JOIN,
   IMPLEMENT_DISTINCT,
   IMPLEMENT_LIMIT,
   EXPORT_EXTERNAL_FILE_TO_PHYSICAL,
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// numa_manager.h
+//
+// Identification: src/include/common/numa_manager.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace peloton {
+
+//===----------------------------------------------------------------------===//
+//
+// The NUMA nodes of the machine, read from sysfs at startup, and the means to
+// place memory and threads on them.
+//
+// Tile groups pick their node when they are created, following the
+// numa_placement setting:
+//
+// - none: the tiles come from the default allocator
+// - interleave: consecutive stripes of a table's tile groups go to the nodes
+//   in turn
+// - local: the tiles go to the node of the thread creating the tile group
+//
+// On a machine with a single node, or without sysfs, everything is on node 0
+// and nothing is bound. The tiles are allocated by the BackendManager.
+//
+//===----------------------------------------------------------------------===//
+class NumaManager {
+ public:
+  // No node in particular
+  static constexpr int kAnyNode = -1;
+
+  // The number of consecutive tile groups of a table that interleaving puts
+  // on the same node, so that scan ranges stay on one node
+  static constexpr size_t kInterleaveStripe = 8;
+
+  // Global Singleton
+  static NumaManager &GetInstance();
+
+  DISALLOW_COPY_AND_MOVE(NumaManager);
+
+  uint32_t GetNumNodes() const {
+    return static_cast<uint32_t>(node_cpus_.size());
+  }
+
+  // The node the calling thread is bound to, or else the node of the CPU it
+  // is running on
+  uint32_t GetCurrentNode() const;
+
+  // Restrict the calling thread to the CPUs of the given node
+  bool BindCurrentThread(uint32_t node);
+
+  /**
+   * Choose the node for a new tile group of a table, following the
+   * numa_placement setting.
+   *
+   * @param tile_group_offset The offset of the tile group in its table
+   * @return The node, or kAnyNode if the tiles should come from the default
+   * allocator
+   */
+  int ChooseTileGroupNode(size_t tile_group_offset) const;
+
+  // Place the pages of a mapped region on the given node, as they are first
+  // touched. See BackendManager::AllocatePages().
+  void BindMemory(void *address, size_t length, uint32_t node);
+
+ private:
+  NumaManager();
+
+  // Read the nodes and their CPUs from sysfs
+  void ReadTopology();
+
+  // Parse a sysfs CPU or node list, such as "0-3,8-11"
+  static std::vector<uint32_t> ParseList(const std::string &list);
+
+ private:
+  // The operating system's ID and the CPUs of each node
+  std::vector<uint32_t> node_ids_;
+  std::vector<std::vector<uint32_t>> node_cpus_;
+
+  // The node of each CPU
+  std::vector<uint32_t> cpu_node_;
+
+  // The node the thread is bound to, if any
+  static thread_local int bound_node_;
+};
+
+}  // namespace peloton
@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_cache.h
+//
+// Identification: src/include/common/plan_cache.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/internal_types.h"
+#include "common/macros.h"
+#include "common/statement.h"
+
+#define DEFAULT_PLAN_CACHE_SIZE 1024
+
+namespace peloton {
+
+namespace planner {
+class AbstractPlan;
+}  // namespace planner
+
+/**
+ * The result of a successful plan cache lookup. The plan tree is a private
+ * copy owned by the caller, so it can be bound to parameters without
+ * interfering with other connections.
+ */
+struct CachedPlan {
+  std::shared_ptr<planner::AbstractPlan> plan_tree;
+  std::vector<FieldInfo> tuple_descriptor;
+  std::set<oid_t> table_ids;
+  // The parameter predicates that pick the plan variants of the statement
+  std::vector<optimizer::ParameterPredicate> parameter_predicates;
+};
+
+/**
+ * Process-wide cache of optimized plans, shared across all connections.
+ *
+ * Unlike StatementCache, which maps statement names to statements within a
+ * single connection, this cache is keyed by the normalized query text, the
+ * database and the parameter types. A new connection preparing a statement
+ * that any other connection has already prepared skips the binder and the
+ * optimizer. Since the copied plan is equal to the cached one, it also finds
+ * the compiled query in codegen::QueryCache.
+ *
+ * Entries are dropped in LRU order once the capacity is exceeded, and are
+ * invalidated through StatementCacheManager when DDL that touches a table
+ * they reference (DROP, CREATE INDEX) commits. Every invalidation bumps the
+ * cache version, and a plan is only added if the version did not change while
+ * it was planned, so a plan built against the catalog before the DDL can't
+ * slip back in. The parameter predicates of the statement are kept with the
+ * plan, so connections served from the cache still pick plan variants.
+ */
+class PlanCache {
+ public:
+  PlanCache() : capacity_(DEFAULT_PLAN_CACHE_SIZE) {}
+
+  DISALLOW_COPY_AND_MOVE(PlanCache);
+
+  /**
+   * @brief Get the process-wide plan cache instance
+   */
+  static PlanCache &GetInstance();
+
+  /**
+   * @brief Build the cache key of a query
+   * @param database_name the database the query is bound against
+   * @param query_string the raw query text
+   * @param param_types the parameter type oids sent by the client
+   * @return the key under which the plan of the query is cached
+   */
+  static std::string MakeKey(const std::string &database_name,
+                             const std::string &query_string,
+                             const std::vector<int32_t> &param_types);
+
+  /**
+   * @brief Normalize a query string so that textual variations of the same
+   *  query map to the same key. Whitespace runs outside of quotes collapse
+   *  into a single space and trailing semicolons are dropped. Case is kept
+   *  since it shows up in the column names sent back to the client.
+   */
+  static std::string NormalizeQueryString(const std::string &query_string);
+
+  /**
+   * @brief Check whether every node in the plan tree can be faithfully
+   *  copied, which is required for the plan to be shared. INSERT plans are
+   *  not, since InsertPlan::Copy() is not implemented.
+   */
+  static bool IsCacheable(const planner::AbstractPlan *plan);
+
+  /**
+   * @brief Look up a plan
+   * @param key the key built by MakeKey()
+   * @param result filled with a private copy of the cached plan on a hit
+   * @return true if the plan was found
+   */
+  bool Find(const std::string &key, CachedPlan &result);
+
+  /**
+   * @brief Insert a plan. The cache keeps its own copy of the plan tree, so
+   *  the caller is free to bind parameters into the plan it passes in.
+   * @param predicates the parameter predicates of the statement, handed out
+   *  with the plan so that SelectPlanForParams() works on cache hits too
+   * @param version the cache version from before the transaction that planned
+   *  the query began. The plan is dropped if anything was invalidated since.
+   */
+  void Add(const std::string &key, const planner::AbstractPlan *plan,
+           const std::vector<FieldInfo> &tuple_descriptor,
+           const std::set<oid_t> &table_ids,
+           const std::vector<optimizer::ParameterPredicate> &predicates,
+           uint64_t version);
+
+  /**
+   * @brief Drop every plan that references the given table. Called once the
+   *  DDL that changed the table has committed.
+   */
+  void InvalidateTableOid(oid_t table_id);
+
+  // Remove all the plans in the cache
+  void Clear();
+
+  // Set the maximum number of plans to cache
+  void SetCapacity(size_t capacity);
+
+  size_t GetCapacity() const { return capacity_; }
+
+  size_t GetCount() const;
+
+  uint64_t GetVersion() const { return version_.load(); }
+
+  size_t GetHitCount() const { return hit_count_.load(); }
+
+  size_t GetMissCount() const { return miss_count_.load(); }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const planner::AbstractPlan> plan_tree;
+    std::vector<FieldInfo> tuple_descriptor;
+    std::set<oid_t> table_ids;
+    std::vector<optimizer::ParameterPredicate> parameter_predicates;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  // Remove one entry, the caller must hold the cache lock
+  void EraseEntry(EntryList::iterator entry_itr);
+
+  // Evict entries until the cache fits into the capacity,
+  // the caller must hold the cache lock
+  void Evict();
+
+  // Entries in LRU order, most recently used first
+  EntryList entries_;
+
+  // Key -> Entry
+  std::unordered_map<std::string, EntryList::iterator> entry_map_;
+
+  // TableOid -> Keys of the plans referencing the table
+  std::unordered_map<oid_t, std::unordered_set<std::string>> table_ref_;
+
+  size_t capacity_;
+
+  // Bumped on every invalidation, under the cache lock
+  std::atomic<uint64_t> version_{0};
+
+  mutable std::mutex cache_lock_;
+
+  std::atomic<size_t> hit_count_{0};
+
+  std::atomic<size_t> miss_count_{0};
+};
+
+}  // namespace peloton
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -19,6 +20,7 @@
 
 #include "common/printable.h"
 #include "internal_types.h"
+#include "optimizer/stats/parameter_selectivity.h"
 #include "parser/sql_statement.h"
 
 namespace peloton {
@@ -87,6 +89,35 @@ class Statement : public Printable {
     return std::move(sql_stmt_list_);
   }
 
+  void SetParameterPredicates(
+      std::vector<optimizer::ParameterPredicate> parameter_predicates);
+
+  const std::vector<optimizer::ParameterPredicate> &GetParameterPredicates()
+      const {
+    return parameter_predicates_;
+  }
+
+  // Selectivity buckets of the parameters the current plan was built for.
+  // Empty for the generic plan.
+  const std::vector<int> &GetPlanBuckets() const { return plan_buckets_; }
+
+  void SetPlanBuckets(const std::vector<int> &plan_buckets) {
+    plan_buckets_ = plan_buckets;
+  }
+
+  // Look up the plan variant built for the given selectivity buckets.
+  // Returns nullptr if there is none.
+  std::shared_ptr<planner::AbstractPlan> GetPlanVariant(
+      const std::vector<int> &buckets) const;
+
+  void AddPlanVariant(const std::vector<int> &buckets,
+                      std::shared_ptr<planner::AbstractPlan> plan_tree);
+
+  size_t GetPlanVariantCount() const { return plan_variants_.size(); }
+
+  // Drop all the plan variants, e.g. when the statement is replanned
+  void ClearPlanVariants();
+
   inline bool GetNeedsReplan() const { return (needs_replan_); }
 
   inline void SetNeedsReplan(bool replan) { needs_replan_ = replan; }
@@ -121,6 +152,16 @@ class Statement : public Printable {
   // cached plan tree
   std::shared_ptr<planner::AbstractPlan> plan_tree_;
 
+  // comparisons between columns and parameters in the WHERE clause
+  std::vector<optimizer::ParameterPredicate> parameter_predicates_;
+
+  // selectivity buckets the cached plan tree was built for
+  std::vector<int> plan_buckets_;
+
+  // plans built for specific selectivity buckets of the parameters
+  std::map<std::vector<int>, std::shared_ptr<planner::AbstractPlan>>
+      plan_variants_;
+
   // the oids of the tables referenced by this statement
   // this may be empty
   std::set<oid_t> table_ids_;
@@ -17,10 +17,9 @@
 
 namespace peloton {
 
-// TODO(Tianyi) remove this singleton
-class StatementCacheManager;
-// Singleton statement_cache_manager
-static std::shared_ptr<StatementCacheManager> statement_cache_manager;
+namespace concurrency {
+class TransactionContext;
+}  // namespace concurrency
 
 /**
  * The manager that stores all the registered statement caches.
@@ -59,23 +58,29 @@ class StatementCacheManager {
    * valid now
    * 
    * @param table_id The table that is no longer valid
+   * @param txn The DDL transaction. The shared plans are only dropped once it
+   *  commits, since other connections keep planning against the old catalog
+   *  until then.
    */
-  void InvalidateTableOid(oid_t table_id);
+  void InvalidateTableOid(oid_t table_id,
+                          concurrency::TransactionContext *txn = nullptr);
 
   /**
    * @brief Notify the manager that the statements with table ids is no longer
    * valid now
    * 
    * @param table_ids The tables that are no longer valid
+   * @param txn The DDL transaction, see InvalidateTableOid()
    */
-  void InvalidateTableOids(std::set<oid_t> &table_ids);
+  void InvalidateTableOids(std::set<oid_t> &table_ids,
+                           concurrency::TransactionContext *txn = nullptr);
 
   // TODO (Tianyi) : remove this singleton to peloton instance
   /**
    *  Initialize an statement cache manager instance
    */
   inline static void Init() {
-    statement_cache_manager = std::make_shared<StatementCacheManager>();
+    statement_cache_manager_ = std::make_shared<StatementCacheManager>();
   }
 
   // TODO (Tianyi) : move this singleton to peloton instance
@@ -84,10 +89,14 @@ class StatementCacheManager {
    * @return the statement cache manager instance
    */
   inline static std::shared_ptr<StatementCacheManager> GetStmtCacheManager() {
-    return statement_cache_manager;
+    return statement_cache_manager_;
   }
 
  private:
+  // Singleton statement cache manager. It used to be a namespace-level
+  // static in this header, which gave every translation unit its own copy.
+  static std::shared_ptr<StatementCacheManager> statement_cache_manager_;
+
   /**
    * The registered statement caches
    */
@@ -165,6 +165,19 @@ class TimestampOrderingTransactionManager : public TransactionManager {
                              const ItemPointer &location,
                              ItemPointer *index_entry_ptr = nullptr);
 
+  /**
+   * Perform the inserts of a batch of tuples, looking up the header of each
+   * tile group once for the consecutive tuples in it.
+   *
+   * @param      current_txn       The current transaction
+   * @param[in]  locations         The locations
+   * @param[in]  index_entry_ptrs  The index entry pointers
+   */
+  virtual void PerformInserts(
+      TransactionContext *const current_txn,
+      const std::vector<ItemPointer> &locations,
+      const std::vector<ItemPointer *> &index_entry_ptrs);
+
   /**
    * @brief      Perform a read operation
    *
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <map>
 #include <unordered_map>
 #include <unordered_set>
@@ -165,6 +166,8 @@ class TransactionContext : public Printable {
 
   void RecordInsert(const ItemPointer &);
 
+  void RecordInserts(const std::vector<ItemPointer> &);
+
   /**
    * @brief      Delete the record.
    *
@@ -184,6 +187,16 @@ class TransactionContext : public Printable {
 
   void ExecOnCommitTriggers();
 
+  /**
+   * @brief      Adds a callback to run once the transaction has committed,
+   *             e.g. to drop state derived from the catalog it changed.
+   *
+   * @param      callback  The callback
+   */
+  void AddOnCommitCallback(std::function<void()> callback);
+
+  void ExecOnCommitCallbacks();
+
   /**
    * @brief      Determines if in rw set.
    *
@@ -340,6 +353,8 @@ class TransactionContext : public Printable {
 
   std::unique_ptr<trigger::TriggerSet> on_commit_triggers_;
 
+  std::vector<std::function<void()>> on_commit_callbacks_;
+
   /** one default transaction is NOT 'read only' unless it is marked 'read only' explicitly*/
   bool read_only_ = false;
 };
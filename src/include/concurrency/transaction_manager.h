@@ -17,6 +17,7 @@
 #include <unordered_map>
 #include <list>
 #include <utility>
+#include <vector>
 
 #include "storage/tile_group_header.h"
 #include "concurrency/transaction_context.h"
@@ -189,6 +190,19 @@ class TransactionManager {
                              const ItemPointer &location, 
                              ItemPointer *index_entry_ptr = nullptr) = 0;
 
+  /**
+   * Perform the inserts of a batch of tuples. DataTable::InsertTuples()
+   * does so before it adds the tuples to the indexes.
+   *
+   * @param      current_txn       The current transaction
+   * @param[in]  locations         The locations
+   * @param[in]  index_entry_ptrs  The index entry pointers
+   */
+  virtual void PerformInserts(
+      TransactionContext *const current_txn,
+      const std::vector<ItemPointer> &locations,
+      const std::vector<ItemPointer *> &index_entry_ptrs) = 0;
+
   virtual bool PerformRead(TransactionContext *const current_txn,
                              const ItemPointer &location,
                              storage::TileGroupHeader *tile_group_header,
@@ -18,8 +18,10 @@
 #include "common/container_tuple.h"
 #include "executor/abstract_executor.h"
 #include "planner/aggregate_plan.h"
+#include "type/serializeio.h"
 #include "type/value_factory.h"
 #include "type/value_peeker.h"
+#include "util/spill_file.h"
 
 //===--------------------------------------------------------------------===//
 // Aggregate
@@ -263,6 +265,13 @@ class AbstractAggregator {
 /**
  * @brief Used when input is NOT sorted.
  * Will maintain an internal hash table.
+ *
+ * Once the query exceeds its memory budget, the aggregator turns into a hybrid
+ * hash aggregation: groups already in the hash table keep being updated in
+ * memory, while tuples of new groups are written to one of several spill
+ * partitions on disk, chosen by the hash of their group-by key. Finalize()
+ * emits the in-memory groups first and then aggregates each spill partition
+ * on its own.
  */
 class HashAggregator : public AbstractAggregator {
  public:
@@ -276,9 +285,57 @@ class HashAggregator : public AbstractAggregator {
 
   ~HashAggregator();
 
+  /** @brief Return the number of tuples written to disk */
+  uint64_t GetNumSpilledTuples() const { return num_spilled_tuples_; }
+
  private:
+  /** @brief The number of spill partitions */
+  static constexpr uint32_t kNumSpillPartitions = 16;
+
+  /** @brief The size at which a spill partition's buffer is written out */
+  static constexpr size_t kSpillBufferSize = 64 * 1024;
+
+  /** @brief A partition of the tuples spilled to disk */
+  struct SpillPartition {
+    std::unique_ptr<util::SpillFile> file;
+    CopySerializeOutput buffer;
+    uint64_t num_tuples = 0;
+  };
+
+  /**
+   * @brief Update the group of the given tuple, creating it if needed. If
+   * spilling is allowed and the query exceeds its memory budget, the tuples of
+   * new groups are written to disk instead.
+   */
+  void Aggregate(AbstractTuple *cur_tuple, bool may_spill);
+
+  /** @brief Write the given tuple to its spill partition */
+  void SpillTuple(AbstractTuple *cur_tuple);
+
+  /** @brief Write the buffered tuples of the given partition to disk */
+  void FlushSpillPartition(SpillPartition &partition);
+
+  /** @brief Aggregate all tuples of a spill partition in memory */
+  void AggregateSpillPartition(SpillPartition &partition);
+
+  /** @brief Output all groups in the hash table */
+  bool EmitGroups();
+
+  /** @brief Delete all groups in the hash table */
+  void ClearGroups();
+
   const size_t num_input_columns;
 
+  /** @brief The estimated memory footprint of a single group */
+  size_t group_size_;
+
+  /** @brief Have we exceeded the memory budget? */
+  bool spilling_ = false;
+
+  /** @brief The spill partitions, NULL unless we're spilling */
+  std::unique_ptr<SpillPartition[]> spill_partitions_;
+  uint64_t num_spilled_tuples_ = 0;
+
   /** List of aggregates for a specific group. */
   struct AggregateList {
     // Keep a deep copy of the first tuple we met of this group
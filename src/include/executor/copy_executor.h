@@ -50,6 +50,10 @@ class CopyExecutor : public AbstractExecutor {
   // Copy and escape the content of column to local buffer
   void Copy(const char *data, int len, bool end_of_line);
 
+  // Write the table scanned by the child to the file in the Arrow format,
+  // straight from its tile groups
+  void ExportArrow();
+
   //===--------------------------------------------------------------------===//
   // Executor State
   //===--------------------------------------------------------------------===//
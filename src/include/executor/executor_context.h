@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "codegen/query_parameters.h"
 #include "type/ephemeral_pool.h"
 #include "type/value.h"
@@ -91,6 +93,40 @@ class ExecutorContext {
 
   ThreadStates &GetThreadStates();
 
+  //////////////////////////////////////////////////////////////////////////////
+  ///
+  /// Memory budget
+  ///
+  //////////////////////////////////////////////////////////////////////////////
+
+  /// Return the memory budget of this query in bytes, 0 if unlimited
+  uint64_t GetMemoryBudget() const { return memory_budget_; }
+
+  /// Set the memory budget of this query in bytes, 0 for unlimited
+  void SetMemoryBudget(uint64_t budget) { memory_budget_ = budget; }
+
+  /// Account for memory the query allocated outside of the pool. Negative
+  /// amounts release previously charged memory.
+  void ChargeMemory(int64_t bytes) { charged_bytes_ += bytes; }
+
+  /// Return the number of bytes the query currently holds
+  uint64_t GetUsedMemory() const;
+
+  /// Does the memory held by this query exceed its budget?
+  bool ExceedsMemoryBudget() const;
+
+  /// Return the directory where operators create their spill files
+  const std::string &GetSpillDirectory() const { return spill_directory_; }
+
+  /// Record that an operator wrote the given number of bytes to disk
+  void RecordSpill(uint64_t bytes);
+
+  /// Return the total number of bytes spilled to disk
+  uint64_t GetSpilledBytes() const { return spilled_bytes_.load(); }
+
+  /// Return the number of times an operator spilled to disk
+  uint64_t GetNumSpills() const { return num_spills_.load(); }
+
   /// Number of processed tuples during execution
   uint32_t num_processed = 0;
 
@@ -105,6 +141,15 @@ class ExecutorContext {
   type::EphemeralPool pool_;
   // Container for all states of all thread participating in this execution
   ThreadStates thread_states_;
+  // The memory budget of the query in bytes, 0 if unlimited
+  uint64_t memory_budget_;
+  // The directory spill files are created in
+  std::string spill_directory_;
+  // Memory held by the query that was not allocated from the pool
+  std::atomic<int64_t> charged_bytes_;
+  // Spilling statistics
+  std::atomic<uint64_t> spilled_bytes_;
+  std::atomic<uint64_t> num_spills_;
 };
 
 template <typename T>
@@ -40,8 +40,14 @@ struct ExecutionResult {
   // string of error message
   std::string m_error_message;
 
+  // number of bytes operators spilled to disk, and how often they did
+  uint64_t m_spilled_bytes;
+  uint64_t m_num_spills;
+
   ExecutionResult() {
     m_processed = 0;
+    m_spilled_bytes = 0;
+    m_num_spills = 0;
     m_result = ResultType::SUCCESS;
     m_error_message = "";
   }
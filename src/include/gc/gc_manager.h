@@ -13,7 +13,9 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 
 #include "common/item_pointer.h"
@@ -78,12 +80,48 @@ class GCManager {
   virtual void RecycleTransaction(
                       concurrency::TransactionContext *txn UNUSED_ATTRIBUTE) {}
 
+  // Remember a tile group that has filled up or had a slot reused, to freeze
+  // it once it is cold (see storage::TileGroup::Freeze())
+  void AddFreezeCandidate(oid_t tile_group_id);
+
  protected:
+  // Free the varlen values of a tuple. Remembers the tile group if its pools
+  // have become fragmented.
   void CheckAndReclaimVarlenColumns(storage::TileGroup *tile_group,
                                     oid_t tuple_id);
 
+  // Compact the varlen pools of the fragmented tile groups. Returns the number
+  // of tiles compacted.
+  size_t CompactVarlenPools();
+
+  // Freeze the candidate tile groups that have become cold. Returns the
+  // number of tile groups frozen.
+  size_t FreezeColdTileGroups();
+
+  // Release the memory that compaction and freezing retired before the given
+  // epoch. Returns the number of tile groups without retired memory left.
+  size_t ReleaseRetiredMemory(eid_t expired_eid);
+
+  // Evict the frozen tile groups that nobody has accessed for a while, if
+  // tiering is enabled. Returns the number of tile groups evicted.
+  size_t EvictColdTileGroups(eid_t expired_eid);
+
  protected:
   volatile bool is_running_;
+
+ private:
+  // Protects the candidates
+  std::mutex candidates_lock_;
+
+  // The tile groups whose varlen pools are fragmented
+  std::unordered_set<oid_t> compaction_candidates_;
+
+  // The full tile groups that have not been frozen yet
+  std::unordered_set<oid_t> freeze_candidates_;
+
+  // The tile groups with retired memory. Only accessed by the thread that
+  // compacts and freezes tile groups.
+  std::unordered_set<oid_t> retiring_tile_groups_;
 };
 
 }  // namespace gc
@@ -32,6 +32,8 @@ namespace gc {
 
 #define MAX_QUEUE_LENGTH 100000
 #define MAX_ATTEMPT_COUNT 100000
+// the number of recycled slots looked at before giving up on them
+#define MAX_RECYCLE_ATTEMPT_COUNT 8
 
 class TransactionLevelGCManager : public GCManager {
  public:
@@ -14,6 +14,7 @@
 
 #include "common/macros.h"
 #include "common/internal_types.h"
+#include "storage/backend_manager.h"
 
 namespace peloton {
 namespace logging {
@@ -32,11 +33,14 @@ private:
 public:
   LogBuffer(const size_t thread_id, const size_t eid) : 
       thread_id_(thread_id), eid_(eid), size_(0){
-    data_ = new char[log_buffer_capacity_];
+    data_ = reinterpret_cast<char *>(
+        storage::BackendManager::GetInstance().AllocatePages(
+            log_buffer_capacity_));
     PELOTON_MEMSET(data_, 0, log_buffer_capacity_);
   }
   ~LogBuffer() {
-    delete[] data_;
+    storage::BackendManager::GetInstance().ReleasePages(data_,
+                                                        log_buffer_capacity_);
     data_ = nullptr;
   }
 
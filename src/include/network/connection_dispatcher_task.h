@@ -42,8 +42,8 @@ class ConnectionDispatcherTask : public NotifiableTask {
 
   /**
    * @brief Dispatches the client connection at fd to a handler.
-   * Currently, the dispatch uses round-robin, and thread communication is
-   * achieved
+   * The connection goes to the least loaded handler, and thread communication
+   * is achieved
    * through channels. The dispatch writes a symbol to the fd that the handler
    * is configured
    * to receive updates on.
@@ -54,15 +54,64 @@ class ConnectionDispatcherTask : public NotifiableTask {
    */
   void DispatchConnection(int fd, short flags);
 
+  /**
+   * @brief Samples the load of every handler and, if one of them is much
+   * busier than another, asks it to migrate a connection to the colder one.
+   *
+   * @param fd Unused. This is here to conform to libevent callback function
+   * signature.
+   * @param flags Unused.
+   */
+  void RebalanceConnections(int fd, short flags);
+
   /**
    * Breaks the dispatcher and managed handlers from their event loops.
    */
   void ExitLoop() override;
 
+  /**
+   * @brief Pick the handler for a new connection. The score of a handler is
+   * its recent load plus its number of connections, ties are broken
+   * round-robin starting at start.
+   *
+   * @param loads the load of each handler during the last interval
+   * @param connection_counts the number of connections of each handler
+   * @param start the handler to start the search from
+   * @return the index of the chosen handler
+   */
+  static size_t ChooseHandler(const std::vector<uint64_t> &loads,
+                              const std::vector<size_t> &connection_counts,
+                              size_t start);
+
+  /**
+   * @brief Decide whether a connection should move between handlers.
+   *
+   * @param loads the load of each handler during the last interval
+   * @param connection_counts the number of connections of each handler
+   * @param from set to the index of the overloaded handler
+   * @param to set to the index of the handler to move a connection to
+   * @return true if a connection should be migrated
+   */
+  static bool ChooseRebalance(const std::vector<uint64_t> &loads,
+                              const std::vector<size_t> &connection_counts,
+                              size_t &from, size_t &to);
+
+  inline size_t GetHandlerCount() const { return handlers_.size(); }
+
+  inline ConnectionHandlerTask *GetHandler(size_t handler_id) const {
+    return handlers_[handler_id].get();
+  }
+
  private:
   std::vector<std::shared_ptr<ConnectionHandlerTask>> handlers_;
-  // TODO: have a smarter dispatch scheduler, we currently use round-robin
-  std::atomic<int> next_handler_;
+
+  // Load of each handler during the last rebalance interval. Only touched on
+  // the dispatcher thread.
+  std::vector<uint64_t> handler_loads_;
+
+  // Where the search for the least loaded handler starts, so that ties are
+  // spread round-robin
+  size_t next_handler_;
 };
 
 }  // namespace network
@@ -94,6 +94,7 @@ class ConnectionHandle {
   /* State Machine Actions */
   // TODO(Tianyu): Write some documentation when feeling like it
   inline Transition TryRead() { return io_wrapper_->FillReadBuffer(); }
+  Transition WaitForRequest();
   Transition TryWrite();
   Transition Process();
   Transition GetResult();
@@ -175,14 +176,24 @@ class ConnectionHandle {
   friend class StateMachine;
   friend class NetworkIoWrapperFactory;
 
+  /**
+   * @brief Hand this connection over to another handler if the current one
+   * asked for it. Only connections that are idle between two requests, with
+   * no open transaction and no buffered bytes, can move.
+   * @return true if the connection was migrated, in which case it must not be
+   * touched any more on this thread
+   */
+  bool TryMigrate();
+
   /**
    * @brief: Determine if there is still responses in the buffer
-   * @return true if there is still responses to flush out in either wbuf or
-   * responses
+   * @return true if there is still responses to flush out in either wbuf,
+   * the chunks pending in the io wrapper or responses
    */
   inline bool HasResponse() {
     return (protocol_handler_->responses_.size() != 0) ||
-           (io_wrapper_->wbuf_->size_ != 0);
+           (io_wrapper_->wbuf_->size_ != 0) ||
+           io_wrapper_->HasPendingChunks();
   }
 
   ConnectionHandlerTask *conn_handler_;
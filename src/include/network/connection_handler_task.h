@@ -19,6 +19,8 @@
 
 #include <unistd.h>
 
+#include <atomic>
+
 #include "common/container/lock_free_queue.h"
 #include "common/exception.h"
 #include "common/logger.h"
@@ -27,15 +29,18 @@
 namespace peloton {
 namespace network {
 
+class ConnectionHandle;
+
 /**
  * A ConnectionHandlerTask is responsible for interacting with a client
  * connection.
  *
  * A client connection, once taken by the dispatch, is sent to a handler. Then
  * all related
- * client events are registered in the handler task. All client interaction
- * happens on the
- * same ConnectionHandlerTask thread for the enitre lifetime of the connection.
+ * client events are registered in the handler task. A connection stays on the
+ * same ConnectionHandlerTask thread until the dispatcher finds this thread
+ * overloaded, at which point an idle connection is migrated to a colder
+ * handler between two requests.
  */
 class ConnectionHandlerTask : public NotifiableTask {
  public:
@@ -57,6 +62,17 @@ class ConnectionHandlerTask : public NotifiableTask {
    */
   void Notify(int conn_fd);
 
+  /**
+   * @brief Notifies this ConnectionHandlerTask that an existing connection is
+   * handed over from another handler.
+   *
+   * The caller must have unregistered all the events of the connection from
+   * its previous handler.
+   *
+   * @param conn the connection being migrated
+   */
+  void NotifyMigration(ConnectionHandle *conn);
+
   /**
    * @brief Handles a new client assigned to this handler by the dispatcher.
    *
@@ -69,9 +85,67 @@ class ConnectionHandlerTask : public NotifiableTask {
    */
   void HandleDispatch(int new_conn_recv_fd, short flags);
 
+  /* Load accounting, used by the dispatcher to balance handlers */
+
+  inline void ConnectionOpened() { num_connections_++; }
+
+  inline void ConnectionClosed() { num_connections_--; }
+
+  inline size_t GetConnectionCount() const { return num_connections_.load(); }
+
+  /**
+   * @brief Record work done on this handler, one unit per client request
+   */
+  inline void AddLoad(uint64_t units) {
+    load_.fetch_add(units, std::memory_order_relaxed);
+  }
+
+  /**
+   * @return the load recorded since the last call, resetting it to zero
+   */
+  inline uint64_t ResetLoad() { return load_.exchange(0); }
+
+  /**
+   * @brief Ask this handler to hand its next idle connection over to target
+   */
+  inline void RequestMigration(ConnectionHandlerTask *target) {
+    migration_target_.store(target);
+  }
+
+  /**
+   * @return the handler a connection should migrate to, or nullptr. The
+   * request is consumed, so only one connection moves per request.
+   */
+  inline ConnectionHandlerTask *TakeMigrationTarget() {
+    return migration_target_.exchange(nullptr);
+  }
+
+  /**
+   * @brief Put back a migration request that could not be served
+   */
+  inline void RestoreMigrationTarget(ConnectionHandlerTask *target) {
+    ConnectionHandlerTask *expected = nullptr;
+    migration_target_.compare_exchange_strong(expected, target);
+  }
+
  private:
+  // Message sent through the notify pipe. Either a new socket fd, or a
+  // connection migrated from another handler.
+  struct DispatchMessage {
+    int conn_fd;
+    ConnectionHandle *conn;
+  };
+
+  void SendDispatchMessage(const DispatchMessage &message);
+
   // Notify new connection pipe(send end)
   int new_conn_send_fd_;
+
+  std::atomic<size_t> num_connections_{0};
+
+  std::atomic<uint64_t> load_{0};
+
+  std::atomic<ConnectionHandlerTask *> migration_target_{nullptr};
 };
 
 }  // namespace network
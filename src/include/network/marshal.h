@@ -12,9 +12,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <sys/uio.h>
+
 #include <openssl/err.h>
 #include <openssl/ssl.h>
 #include "common/internal_types.h"
@@ -24,6 +28,20 @@
 
 #define BUFFER_INIT_SIZE 100
 
+// Size of the first chunk of an OutputChunkBuffer. Every further chunk is
+// twice as large as the one before, up to OUTPUT_CHUNK_SIZE.
+#define OUTPUT_CHUNK_INIT_SIZE 1024
+
+// Maximum size of each chunk of an OutputChunkBuffer
+#define OUTPUT_CHUNK_SIZE (64 * 1024)
+
+// Batches of messages smaller than this are copied into the write buffer
+// instead of being sent with writev
+#define OUTPUT_WRITEV_THRESHOLD (SOCKET_BUFFER_SIZE / 2)
+
+// Maximum number of iovecs handed to a single writev call
+#define OUTPUT_MAX_IOVECS 64
+
 namespace peloton {
 namespace network {
 
@@ -286,6 +304,102 @@ class InputPacket {
   ByteBuf::const_iterator End() { return end; }
 };
 
+/**
+ * A growable list of fixed size chunks that protocol messages are serialized
+ * into in place, framing included.
+ *
+ * Large responses (e.g. the data rows of a result set) are written here
+ * instead of into one OutputPacket per message. That saves an allocation per
+ * message, and the chunks can be handed to writev directly instead of being
+ * copied into the WriteBuffer first. Chunks start small and grow, so a result
+ * of a single row does not cost a full size chunk.
+ */
+class OutputChunkBuffer {
+ public:
+  explicit OutputChunkBuffer(size_t chunk_size = OUTPUT_CHUNK_SIZE)
+      : chunk_size_(chunk_size),
+        next_chunk_size_(
+            std::min<size_t>(OUTPUT_CHUNK_INIT_SIZE, chunk_size)) {}
+
+  DISALLOW_COPY_AND_MOVE(OutputChunkBuffer);
+
+  /**
+   * Start a new message, writing its type and reserving its length field.
+   * Messages must be closed with EndMessage() before the next one starts.
+   * @param type the message type
+   */
+  void BeginMessage(NetworkMessageType type);
+
+  /**
+   * Close the current message, filling in its length
+   */
+  void EndMessage();
+
+  /**
+   * Append an integer in network byte order
+   * @param n the value
+   * @param base the number of bytes to write, 2 or 4
+   */
+  void AppendInt(int n, int base);
+
+  /**
+   * Append raw bytes, spilling into new chunks as needed
+   */
+  void AppendBytes(const void *data, size_t len);
+
+  /**
+   * @return the number of bytes not yet consumed
+   */
+  inline size_t Size() const { return total_size_ - consumed_size_; }
+
+  inline bool Empty() const { return Size() == 0; }
+
+  /**
+   * @return the number of chunks allocated so far
+   */
+  inline size_t ChunkCount() const { return chunks_.size(); }
+
+  /**
+   * Describe the unconsumed bytes as a list of iovecs
+   * @param iov the array to fill
+   * @param max_iov the capacity of iov
+   * @return the number of iovecs filled
+   */
+  size_t GetIovecs(struct iovec *iov, size_t max_iov);
+
+  /**
+   * Mark bytes at the head of the buffer as written out
+   */
+  void Consume(size_t bytes);
+
+ private:
+  struct Chunk {
+    std::unique_ptr<uchar[]> data;
+    size_t size;
+    size_t capacity;
+  };
+
+  // Make sure the last chunk has room for bytes contiguous bytes
+  Chunk &Reserve(size_t bytes);
+
+  // The maximum size of a chunk, and the size of the next one
+  const size_t chunk_size_;
+  size_t next_chunk_size_;
+
+  std::vector<Chunk> chunks_;
+
+  size_t total_size_ = 0;
+
+  // Read cursor, advanced by Consume()
+  size_t consumed_size_ = 0;
+  size_t head_chunk_ = 0;
+  size_t head_offset_ = 0;
+
+  // Location of the length field of the open message, and its length so far
+  uchar *msg_len_field_ = nullptr;
+  size_t msg_len_ = 0;
+};
+
 struct OutputPacket {
   ByteBuf buf;                  // stores packet contents
   size_t len;                   // size of packet
@@ -297,11 +411,16 @@ struct OutputPacket {
   bool skip_header_write;  // whether we should write header to soc ket wbuf
   size_t write_ptr;        // cursor used to write packet content to socket wbuf
 
+  // If set, the packet carries a batch of already framed messages instead of
+  // a single message in buf
+  std::unique_ptr<OutputChunkBuffer> chunks;
+
   // TODO could packet be reused?
   inline void Reset() {
     buf.resize(BUFFER_INIT_SIZE);
     buf.shrink_to_fit();
     buf.clear();
+    chunks.reset();
     single_type_pkt = false;
     len = ptr = write_ptr = 0;
     msg_type = NetworkMessageType::NULL_COMMAND;
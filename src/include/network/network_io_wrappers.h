@@ -46,6 +46,19 @@ class NetworkIoWrapper {
 
   inline int GetSocketFd() { return sock_fd_; }
   Transition WritePacket(OutputPacket *pkt);
+
+  /**
+   * Write out a batch of framed messages. By default they are copied through
+   * the write buffer. Wrappers that can do scatter-gather IO override this,
+   * and may take ownership of the chunks to send them at the next flush.
+   * @param chunks the messages, consumed as they are written
+   */
+  virtual Transition WriteChunks(std::unique_ptr<OutputChunkBuffer> &chunks);
+
+  /**
+   * @return whether chunks taken by WriteChunks still wait for a flush
+   */
+  virtual bool HasPendingChunks() const { return false; }
   // TODO(Tianyu): Make these protected when protocol handler refactor is
   // complete
   NetworkIoWrapper(int sock_fd, std::shared_ptr<ReadBuffer> &rbuf,
@@ -77,11 +90,25 @@ class PosixSocketIoWrapper : public NetworkIoWrapper {
 
   inline bool SslAble() const override { return false; }
   Transition FillReadBuffer() override;
+  // Sends the write buffer, along with the pending chunks, with writev
   Transition FlushWriteBuffer() override;
+  // Copies small batches into the write buffer. Large ones are held until the
+  // next flush, so that the messages written after them (CommandComplete,
+  // ReadyForQuery) go out in the same writev.
+  Transition WriteChunks(std::unique_ptr<OutputChunkBuffer> &chunks) override;
+  inline bool HasPendingChunks() const override {
+    return pending_chunks_ != nullptr;
+  }
   inline Transition Close() override {
     peloton_close(sock_fd_);
     return Transition::PROCEED;
   }
+
+ private:
+  // The chunks waiting for the next flush, and the offset in the write buffer
+  // of the bytes that follow them
+  std::unique_ptr<OutputChunkBuffer> pending_chunks_;
+  size_t pending_chunks_offset_ = 0;
 };
 
 /**
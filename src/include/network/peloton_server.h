@@ -115,6 +115,11 @@ class PelotonServer : public DedicatedThreadOwner {
 
   static int SSLMutexCleanup(void);
 
+  // For testing purposes
+  inline ConnectionDispatcherTask *GetDispatcherTask() {
+    return dispatcher_task_.get();
+  }
+
   static int recent_connfd;
   static SSL_CTX *ssl_context;
   static std::string private_key_file_;
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "common/internal_types.h"
 
@@ -34,6 +35,10 @@ namespace catalog {
 class Catalog;
 }
 
+namespace type {
+class Value;
+}
+
 namespace optimizer {
 
 //===--------------------------------------------------------------------===//
@@ -54,6 +59,12 @@ class AbstractOptimizer {
       concurrency::TransactionContext *txn) = 0;
 
   virtual void Reset(){};
+
+  // Provide the values bound to the parameters of the next statement so that
+  // cardinality estimation can use them instead of default selectivities.
+  // An empty vector restores generic planning.
+  virtual void SetParameterValues(
+      const std::vector<type::Value> &parameter_values UNUSED_ATTRIBUTE){};
 };
 
 }  // namespace optimizer
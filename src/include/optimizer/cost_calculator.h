@@ -39,6 +39,7 @@ class CostCalculator : public OperatorVisitor {
   void Visit(const PhysicalLeftHashJoin *) override;
   void Visit(const PhysicalRightHashJoin *) override;
   void Visit(const PhysicalOuterHashJoin *) override;
+  void Visit(const PhysicalSemiHashJoin *) override;
   void Visit(const PhysicalInsert *) override;
   void Visit(const PhysicalInsertSelect *) override;
   void Visit(const PhysicalDelete *) override;
@@ -48,6 +49,23 @@ class CostCalculator : public OperatorVisitor {
   void Visit(const PhysicalDistinct *) override;
   void Visit(const PhysicalAggregate *) override;
 
+  /**
+   * @brief Estimate the cost of a hash join
+   * @param build_rows the number of rows in the build (left) input
+   * @param probe_rows the number of rows in the probe (right) input
+   * @param partitioned whether both inputs are radix-partitioned first, so
+   *  that every partition's hash table fits into the cache
+   */
+  static double HashJoinCost(double build_rows, double probe_rows,
+                             bool partitioned);
+
+  /**
+   * @brief Check whether partitioning the inputs of a hash join is cheaper
+   *  than probing one large hash table. Returns false if the sizes of the
+   *  inputs are unknown, or if partitioned hash joins are disabled.
+   */
+  static bool UsePartitionedHashJoin(double build_rows, double probe_rows);
+
  private:
   double HashCost();
   double SortCost();
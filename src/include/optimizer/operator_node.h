@@ -66,6 +66,7 @@ enum class OpType {
   LeftHashJoin,
   RightHashJoin,
   OuterHashJoin,
+  SemiHashJoin,
   Insert,
   InsertSelect,
   Delete,
@@ -82,6 +82,11 @@ class Optimizer : public AbstractOptimizer {
 
   void Reset() override;
 
+  void SetParameterValues(
+      const std::vector<type::Value> &parameter_values) override {
+    parameter_values_ = parameter_values;
+  }
+
   OptimizerMetadata &GetMetadata() { return metadata_; }
 
   /* For test purposes only */
@@ -157,6 +162,9 @@ class Optimizer : public AbstractOptimizer {
   //////////////////////////////////////////////////////////////////////////////
   /// Metadata
   OptimizerMetadata metadata_;
+
+  // Parameter values used for cardinality estimation of the next plan
+  std::vector<type::Value> parameter_values_;
 };
 
 }  // namespace optimizer
@@ -42,6 +42,8 @@ class OptimizerMetadata {
   unsigned int timeout_limit;
   Timer<std::milli> timer;
   concurrency::TransactionContext* txn;
+  // Parameter values to use for cardinality estimation, may be empty
+  std::vector<type::Value> parameter_values;
 
   void SetTaskPool(OptimizerTaskPool *task_pool) {
     this->task_pool = task_pool;
@@ -78,6 +78,8 @@ class PlanGenerator : public OperatorVisitor {
 
   void Visit(const PhysicalOuterHashJoin *) override;
 
+  void Visit(const PhysicalSemiHashJoin *) override;
+
   void Visit(const PhysicalInsert *) override;
 
   void Visit(const PhysicalInsertSelect *) override;
@@ -149,6 +151,19 @@ class PlanGenerator : public OperatorVisitor {
    *  the output plan produciing output columns is generated
    */
   void BuildProjectionPlan();
+
+  /**
+   * @brief Generate a hash join plan. The hash table is built on the left
+   *  child, and semi and anti joins only output columns of the left child
+   */
+  void BuildHashJoinPlan(
+      JoinType join_type,
+      const std::vector<AnnotatedExpression> &join_predicates,
+      const std::vector<std::unique_ptr<expression::AbstractExpression>>
+          &join_left_keys,
+      const std::vector<std::unique_ptr<expression::AbstractExpression>>
+          &join_right_keys);
+
   void BuildAggregatePlan(
       AggregateType aggr_type,
       const std::vector<std::shared_ptr<expression::AbstractExpression>>
@@ -36,6 +36,20 @@ static constexpr double DEFAULT_INDEX_TUPLE_COST = 0.005;
 // query.
 static constexpr double DEFAULT_OPERATOR_COST = 0.0025;
 
+// Estimate the size of the cache in bytes. Hash tables larger than this incur
+// cache misses on most accesses.
+static constexpr double DEFAULT_CACHE_SIZE = 2 * 1024 * 1024;
+
+// Estimate the size of each hash table entry in bytes, including its share of
+// the directory.
+static constexpr double DEFAULT_HASH_ENTRY_SIZE = 64;
+
+// Estimate the cost of a cache miss when accessing a hash table.
+static constexpr double DEFAULT_CACHE_MISS_COST = 0.02;
+
+// Estimate the cost of scattering each row into its partition.
+static constexpr double DEFAULT_PARTITION_TUPLE_COST = 0.005;
+
 //===----------------------------------------------------------------------===//
 // Cost
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// parameter_selectivity.h
+//
+// Identification: src/include/optimizer/stats/parameter_selectivity.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/internal_types.h"
+
+namespace peloton {
+
+namespace parser {
+class SQLStatement;
+}  // namespace parser
+
+namespace type {
+class Value;
+}  // namespace type
+
+namespace optimizer {
+
+class ColumnStats;
+
+//===--------------------------------------------------------------------===//
+// ParameterPredicate
+// SELECT * FROM table WHERE [tenant_id = $1] <- ParameterPredicate
+//===--------------------------------------------------------------------===//
+struct ParameterPredicate {
+  // Comparison type, normalized so that the column is on the left side
+  ExpressionType type;
+
+  // Index of the parameter in the statement
+  int param_idx;
+
+  // Stats of the column the parameter is compared against
+  std::shared_ptr<ColumnStats> column_stats;
+};
+
+//===--------------------------------------------------------------------===//
+// ParameterSelectivity
+//
+// Maps the values bound to the parameters of a prepared statement to coarse
+// selectivity buckets. Two sets of parameter values that fall into the same
+// buckets are expected to share the same best plan, so the buckets are used
+// to key the plan variants of a statement.
+//===--------------------------------------------------------------------===//
+class ParameterSelectivity {
+ public:
+  // Bucket used when the selectivity of a predicate cannot be estimated
+  static constexpr int UNKNOWN_BUCKET = -1;
+
+  /**
+   * @brief Collect the column-parameter comparisons in the WHERE clause of a
+   *  bound statement. Predicates on columns without stats are skipped.
+   */
+  static std::vector<ParameterPredicate> GetParameterPredicates(
+      const parser::SQLStatement *sql_stmt);
+
+  /**
+   * @brief Estimate the selectivity of a predicate for a parameter value
+   *  using the histogram and most common values of the column
+   */
+  static double ComputeSelectivity(const ParameterPredicate &predicate,
+                                   const type::Value &value);
+
+  /**
+   * @brief Map a selectivity into its bucket. Buckets grow by an order of
+   *  magnitude each, so a tiny tenant and a giant one end up apart.
+   */
+  static int GetBucket(double selectivity);
+
+  /**
+   * @brief Compute the bucket of every predicate for the given parameters
+   */
+  static std::vector<int> ComputeBuckets(
+      const std::vector<ParameterPredicate> &predicates,
+      const std::vector<type::Value> &param_values);
+};
+
+}  // namespace optimizer
+}  // namespace peloton
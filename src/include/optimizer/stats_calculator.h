@@ -26,8 +26,10 @@ class TableStats;
  */
 class StatsCalculator : public OperatorVisitor {
  public:
-  void CalculateStats(GroupExpression *gexpr, ExprSet required_cols,
-                      Memo *memo, concurrency::TransactionContext* txn);
+  void CalculateStats(
+      GroupExpression *gexpr, ExprSet required_cols, Memo *memo,
+      concurrency::TransactionContext *txn,
+      const std::vector<type::Value> *parameter_values = nullptr);
 
   void Visit(const LogicalGet *) override;
   void Visit(const LogicalQueryDerivedGet *) override;
@@ -76,6 +78,8 @@ class StatsCalculator : public OperatorVisitor {
   ExprSet required_cols_;
   Memo *memo_;
   concurrency::TransactionContext* txn_;
+  // Values of the query parameters, if they are known at planning time
+  const std::vector<type::Value> *parameter_values_;
 };
 
 }  // namespace optimizer
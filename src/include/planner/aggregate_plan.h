@@ -129,9 +129,10 @@ class AggregatePlan : public AbstractPlan {
     AggregatePlan *new_plan = new AggregatePlan(
         project_info_->Copy(),
         std::unique_ptr<const expression::AbstractExpression>(
-            predicate_->Copy()),
+            predicate_ != nullptr ? predicate_->Copy() : nullptr),
         std::move(copied_agg_terms), std::move(copied_groupby_col_ids),
         output_schema_copy, agg_strategy_);
+    new_plan->SetCardinality(GetCardinality());
     return std::unique_ptr<AbstractPlan>(new_plan);
   }
 
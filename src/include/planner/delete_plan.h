@@ -40,7 +40,9 @@ class DeletePlan : public AbstractPlan {
   void SetParameterValues(std::vector<type::Value> *values) override;
 
   std::unique_ptr<AbstractPlan> Copy() const override {
-    return std::unique_ptr<AbstractPlan>(new DeletePlan(target_table_));
+    auto *new_plan = new DeletePlan(target_table_);
+    new_plan->SetCardinality(GetCardinality());
+    return std::unique_ptr<AbstractPlan>(new_plan);
   }
 
   hash_t Hash() const override;
@@ -23,13 +23,16 @@ namespace planner {
 
 /**
  * This is the plan node when exporting data from the database into an external
- * file. It is configured with the name of the file to write content into, and
- * the delimiter, quote, and escape characters to use when writing content.
+ * file. It is configured with the name of the file to write content into, its
+ * format, and the delimiter, quote, and escape characters to use when writing
+ * CSV content.
  */
 class ExportExternalFilePlan : public AbstractPlan {
  public:
-  ExportExternalFilePlan(std::string file_name, char delimiter = ',',
-                         char quote = '"', char escape = '\"');
+  ExportExternalFilePlan(std::string file_name,
+                         ExternalFileFormat format = ExternalFileFormat::CSV,
+                         char delimiter = ',', char quote = '"',
+                         char escape = '\"');
 
   //////////////////////////////////////////////////////////////////////////////
   ///
@@ -41,6 +44,8 @@ class ExportExternalFilePlan : public AbstractPlan {
 
   const std::string &GetFileName() const { return file_name_; }
 
+  ExternalFileFormat GetFormat() const { return format_; }
+
   char GetDelimiterChar() const { return delimiter_; }
   char GetQuoteChar() const { return quote_; }
   char GetEscapeChar() const { return escape_; }
@@ -64,6 +69,8 @@ class ExportExternalFilePlan : public AbstractPlan {
 
   std::string file_name_;
 
+  ExternalFileFormat format_;
+
   char delimiter_;
   char quote_;
   char escape_;
@@ -55,6 +55,12 @@ class HashJoinPlan : public AbstractJoinPlan {
 
   void SetBloomFilterFlag(bool flag) { build_bloomfilter_ = flag; }
 
+  /// Should both inputs be radix-partitioned and joined partition by
+  /// partition? This is chosen when the build side does not fit into cache.
+  bool IsPartitioned() const { return partitioned_; }
+
+  void SetPartitioned(bool partitioned) { partitioned_ = partitioned; }
+
   const std::string GetInfo() const override { return "HashJoin"; }
 
   void GetLeftHashKeys(
@@ -87,6 +93,9 @@ class HashJoinPlan : public AbstractJoinPlan {
 
   // Flag indicating whether we build a bloom filter
   bool build_bloomfilter_;
+
+  // Flag indicating whether the join is radix-partitioned
+  bool partitioned_ = false;
 };
 
 }  // namespace planner
@@ -49,7 +49,9 @@ class HashPlan : public AbstractPlan {
     for (const auto &key : hash_keys_) {
       copied_hash_keys.push_back(std::unique_ptr<HashKeyType>(key->Copy()));
     }
-    return std::unique_ptr<AbstractPlan>(new HashPlan(copied_hash_keys));
+    auto *new_plan = new HashPlan(copied_hash_keys);
+    new_plan->SetCardinality(GetCardinality());
+    return std::unique_ptr<AbstractPlan>(new_plan);
   }
 
   hash_t Hash() const override;
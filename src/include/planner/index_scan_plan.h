@@ -163,10 +163,19 @@ class IndexScanPlan : public AbstractScan {
       new_runtime_keys.push_back(key->Copy());
     }
 
-    IndexScanDesc desc(index_id_, key_column_ids_, expr_types_, values_,
-                       new_runtime_keys);
+    // Copy the values before parameter binding so the new plan can be bound
+    // to a different set of parameters
+    IndexScanDesc desc(index_id_, key_column_ids_, expr_types_,
+                       values_with_params_, new_runtime_keys);
+    auto *predicate = GetPredicate();
     IndexScanPlan *new_plan = new IndexScanPlan(
-        GetTable(), GetPredicate()->Copy(), GetColumnIds(), desc, false);
+        GetTable(), predicate != nullptr ? predicate->Copy() : nullptr,
+        GetColumnIds(), desc, IsForUpdate());
+    new_plan->SetLimit(limit_);
+    new_plan->SetLimitNumber(limit_number_);
+    new_plan->SetLimitOffset(limit_offset_);
+    new_plan->SetDescend(descend_);
+    new_plan->SetCardinality(GetCardinality());
     return std::unique_ptr<AbstractPlan>(new_plan);
   }
 
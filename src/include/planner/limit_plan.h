@@ -41,7 +41,9 @@ class LimitPlan : public AbstractPlan {
   const std::string GetInfo() const { return "Limit"; }
 
   std::unique_ptr<AbstractPlan> Copy() const {
-    return std::unique_ptr<AbstractPlan>(new LimitPlan(limit_, offset_));
+    auto *new_plan = new LimitPlan(limit_, offset_);
+    new_plan->SetCardinality(GetCardinality());
+    return std::unique_ptr<AbstractPlan>(new_plan);
   }
 
  private:
@@ -55,6 +55,15 @@ class PlanUtil {
   static const std::set<oid_t> GetTablesReferenced(
       const planner::AbstractPlan *plan);
 
+  /**
+   * @brief Deep copy a plan tree, including all of its children
+   * @param The plan tree
+   * @return The copied plan tree, or nullptr if any node in the tree
+   *   does not support copying
+   */
+  static std::unique_ptr<planner::AbstractPlan> CopyPlanTree(
+      const planner::AbstractPlan *plan);
+
   /**
    * @brief Get the indexes affected by a given query
    * @param CatalogCache
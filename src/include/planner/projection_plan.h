@@ -68,6 +68,7 @@ class ProjectionPlan : public AbstractPlan {
     ProjectionPlan *new_plan =
         new ProjectionPlan(project_info_->Copy(), schema_copy);
     new_plan->column_ids_ = column_ids_;
+    new_plan->SetCardinality(GetCardinality());
     return std::unique_ptr<AbstractPlan>(new_plan);
   }
 
@@ -58,8 +58,11 @@ class SeqScanPlan : public AbstractScan {
   int SerializeSize() const override;
 
   std::unique_ptr<AbstractPlan> Copy() const override {
-    auto *new_plan =
-        new SeqScanPlan(GetTable(), GetPredicate()->Copy(), GetColumnIds());
+    auto *predicate = GetPredicate();
+    auto *new_plan = new SeqScanPlan(
+        GetTable(), predicate != nullptr ? predicate->Copy() : nullptr,
+        GetColumnIds(), IsForUpdate(), IsParallel());
+    new_plan->SetCardinality(GetCardinality());
     return std::unique_ptr<AbstractPlan>(new_plan);
   }
 
@@ -50,8 +50,9 @@ class UpdatePlan : public AbstractPlan {
   const std::string GetInfo() const override { return "UpdatePlan"; }
 
   std::unique_ptr<AbstractPlan> Copy() const override {
-    return std::unique_ptr<AbstractPlan>(
-        new UpdatePlan(target_table_, project_info_->Copy()));
+    auto *new_plan = new UpdatePlan(target_table_, project_info_->Copy());
+    new_plan->SetCardinality(GetCardinality());
+    return std::unique_ptr<AbstractPlan>(new_plan);
   }
 
   void PerformBinding(BindingContext &binding_context) override;
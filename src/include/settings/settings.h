@@ -103,6 +103,35 @@ SETTING_int(monoqueue_worker_pool_size,
             1, 32,
             false, false)
 
+// Share of the main pool workers given to short transactional queries
+SETTING_int(scheduler_oltp_weight,
+            "Scheduling weight of OLTP queries (default: 8)",
+            8,
+            1, 1024,
+            false, false)
+
+// Share of the main pool workers given to analytical queries
+SETTING_int(scheduler_olap_weight,
+            "Scheduling weight of OLAP queries (default: 1)",
+            1,
+            1, 1024,
+            false, false)
+
+// Analytical queries beyond this limit wait in the queue
+SETTING_int(scheduler_max_olap_tasks,
+            "Maximum number of concurrently running OLAP queries, "
+                "0 for no limit (default: 2)",
+            2,
+            0, 32,
+            false, false)
+
+// Plans estimated to produce fewer rows than this are scheduled as OLTP
+SETTING_int(scheduler_olap_min_rows,
+            "Minimum estimated cardinality of an OLAP plan (default: 10000)",
+            10000,
+            0, 1000000000,
+            false, false)
+
 // Number of connection threads used by peloton
 SETTING_int(connection_thread_count,
             "Number of connection threads (default: std::hardware_concurrency())",
@@ -110,12 +139,75 @@ SETTING_int(connection_thread_count,
             1, 64,
             false, false)
 
+// How often the dispatcher moves busy connections off overloaded threads
+SETTING_int(connection_rebalance_interval,
+            "Interval (in ms) between rebalancing connections across "
+                "connection threads, 0 disables rebalancing (default: 1000)",
+            1000,
+            0, 60000,
+            false, false)
+
 SETTING_int(gc_num_threads,
             "The number of Garbage collection threads to run",
             1,
             1, 128,
             true, true)
 
+// Compress tile groups once nothing changes in them anymore
+SETTING_bool(tile_group_compression,
+             "Freeze and compress cold column-layout tile groups "
+                 "(default: false)",
+             false,
+             true, true)
+
+// Evict frozen tile groups nobody accesses to a file on local storage
+SETTING_bool(tile_group_tiering,
+             "Evict the tiles of cold frozen tile groups to a file "
+                 "(default: false)",
+             false,
+             true, true)
+
+SETTING_int(tiering_cold_seconds,
+            "The number of seconds a frozen tile group must not have been "
+                "accessed for to be evicted (default: 60)",
+            60,
+            1, 86400,
+            true, true)
+
+SETTING_string(tiering_file,
+               "The file that evicted tile groups are written to",
+               "/tmp/peloton_tile_groups.dat",
+               false, false)
+
+// Which NUMA nodes the tiles of new tile groups are allocated on
+SETTING_string(numa_placement,
+               "Placement of tile groups on NUMA nodes: none, interleave or "
+               "local (default: none)",
+               "none",
+               true, true)
+
+// Back tiles, hash tables and log buffers with huge pages
+SETTING_string(huge_pages,
+               "Huge pages for large allocations: off, transparent or "
+               "explicit, which falls back to transparent (default: "
+               "transparent)",
+               "transparent",
+               false, false)
+
+SETTING_int(huge_page_reserve_mb,
+            "Megabytes of huge pages to fault in at startup for large "
+                "allocations, 0 for none (default: 0)",
+            0,
+            0, 1024 * 1024,
+            false, false)
+
+// Pin each execution worker to the CPUs of one NUMA node
+SETTING_bool(numa_worker_affinity,
+             "Bind the execution workers to NUMA nodes in turn, so that "
+                 "parallel scans read local tile groups (default: false)",
+             false,
+             false, false)
+
 SETTING_bool(parallel_execution,
              "Enable parallel execution of queries (default: true)",
              true,
@@ -214,6 +306,107 @@ SETTING_bool(dump_ir,
              false,
              true, true)
 
+SETTING_bool(codegen_inline_runtime,
+             "Link the bitcode of runtime functions into generated code, so "
+                 "that they can be inlined (default: true)",
+             true,
+             true, true)
+
+// Persistent cache of compiled query code
+SETTING_string(codegen_cache_directory,
+               "Directory of the persistent cache of compiled queries, "
+               "empty disables the cache (default: empty)",
+               "",
+               false, false)
+
+SETTING_int(codegen_cache_warmup,
+            "Number of most frequently used compiled queries preloaded from "
+                "the persistent cache at startup (default: 500)",
+            500,
+            0, 1000000,
+            false, false)
+
+SETTING_int(codegen_cache_max_entries,
+            "Maximum number of compiled queries kept in the persistent cache, "
+                "least recently used ones are evicted (default: 10000)",
+            10000,
+            1, 1000000,
+            false, false)
+
+SETTING_int(codegen_cache_memory_size,
+            "Memory (in MB) of compiled query code the persistent cache keeps "
+                "loaded (default: 64)",
+            64,
+            0, 1048576,
+            false, false)
+
+// Tiered optimization of generated code
+SETTING_int(codegen_cold_query_rows,
+            "Queries estimated to process fewer rows are compiled without "
+                "optimization (default: 1000)",
+            1000,
+            0, 1000000000,
+            true, true)
+
+SETTING_int(codegen_hot_query_rows,
+            "Queries estimated to process at least this many rows are compiled "
+                "with loop optimizations and vectorization (default: 10000000)",
+            10000000,
+            0, 1000000000,
+            true, true)
+
+SETTING_int(codegen_hot_query_executions,
+            "Number of executions after which a cached query is recompiled "
+                "with loop optimizations and vectorization in the background, "
+                "0 disables recompilation (default: 100)",
+            100,
+            0, 1000000000,
+            true, true)
+
+// Compilation of generated code in the background
+SETTING_bool(codegen_async_compilation,
+             "Compile new queries on the compiler threads, and interpret them "
+                 "until their native code is ready (default: true)",
+             true,
+             true, true)
+
+SETTING_int(codegen_compiler_threads,
+            "Number of threads compiling generated code (default: 2)",
+            2,
+            1, 32,
+            false, false)
+
+SETTING_int(codegen_compile_queue_size,
+            "Size of the queue of pending compilations (default: 64)",
+            64,
+            8, 1024,
+            false, false)
+
+// Aggregation on keys with a small domain
+SETTING_int(codegen_direct_map_slots,
+            "Largest number of slots of the array that replaces the hash table "
+                "of aggregations whose grouping columns have a small range of "
+                "values, 0 disables it (default: 4096)",
+            4096,
+            0, 1048576,
+            true, true)
+
+// Memory budget of a single query
+SETTING_int(query_memory_budget,
+            "Memory budget (in MB) of a single query. Hash joins, sorts and "
+                "aggregations exceeding it spill to disk, "
+                "0 disables the budget (default: 0)",
+            0,
+            0, 1048576,
+            true, true)
+
+// Where operators write their spill files
+SETTING_string(spill_directory,
+               "Directory for temporary files of operators exceeding the "
+               "query memory budget (default: /tmp)",
+               "/tmp",
+               true, true)
+
 //===----------------------------------------------------------------------===//
 // Optimizer
 //===----------------------------------------------------------------------===//
@@ -227,6 +420,29 @@ SETTING_bool(hash_join_bloom_filter,
              false,
              true, true)
 
+SETTING_bool(hash_join_partitioning,
+             "Let the optimizer choose radix-partitioned hash joins when the "
+             "build side does not fit into the cache (default: true)",
+             true,
+             true, true)
+
+// Size of the plan cache shared by all connections
+SETTING_int(plan_cache_size,
+            "Maximum number of optimized plans shared across connections, "
+                "0 disables the cache (default: 1024)",
+            1024,
+            0, 65536,
+            true, true)
+
+// Number of parameter-sensitive plan variants kept per prepared statement
+SETTING_int(plan_variants_max,
+            "Maximum number of plans kept per prepared statement for "
+                "parameter values with different selectivities, "
+                "0 always uses the generic plan (default: 4)",
+            4,
+            0, 64,
+            true, true)
+
 SETTING_int(task_execution_timeout,
             "Maximum allowed length of time (in ms) for task "
                 "execution step of optimizer, "
@@ -98,7 +98,10 @@ class LatencyMetric : public AbstractMetric {
   void Aggregate(AbstractMetric &source);
 
   // Returns a string representation of this latency metric
-  const std::string GetInfo() const;
+  const std::string GetInfo() const { return GetInfo("TXN LATENCY"); }
+
+  // Returns a string representation of this latency metric with a label
+  const std::string GetInfo(const std::string &label) const;
 
   // Returns a copy of the latencies collected
   CircularBuffer<double> Copy();
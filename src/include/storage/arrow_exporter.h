@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// arrow_exporter.h
+//
+// Identification: src/include/storage/arrow_exporter.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include "common/internal_types.h"
+#include "common/macros.h"
+
+namespace peloton {
+namespace storage {
+
+class DataTable;
+class TileGroup;
+
+//===----------------------------------------------------------------------===//
+//
+// Writes a snapshot of a table in the Apache Arrow IPC file format, which
+// analytics tools map into memory instead of parsing it.
+//
+// Every tile group becomes a record batch of the versions that were committed
+// at the read timestamp. A fixed-width column that a tile stores on its own is
+// written straight from the tile when every slot of the tile group is
+// visible. Other columns are gathered value by value.
+//
+// The column types map to Arrow types as follows:
+//
+// - BOOLEAN: Bool
+// - TINYINT, SMALLINT, INTEGER, BIGINT: signed Int of the same width
+// - DECIMAL: FloatingPoint (double)
+// - DATE: Date (days)
+// - TIMESTAMP: Timestamp (microseconds, UTC)
+// - VARCHAR: Utf8
+// - VARBINARY: Binary
+//
+//===----------------------------------------------------------------------===//
+class ArrowExporter {
+ public:
+  /**
+   * @param table The table to export
+   * @param column_ids The columns to export, in order
+   * @param read_cid The read timestamp of the snapshot
+   */
+  ArrowExporter(DataTable *table, std::vector<oid_t> column_ids,
+                cid_t read_cid);
+
+  DISALLOW_COPY_AND_MOVE(ArrowExporter);
+
+  /**
+   * Write the snapshot to the given file.
+   *
+   * @param file The file, positioned at its beginning
+   * @return The number of rows written
+   */
+  size_t Export(FILE *file);
+
+ private:
+  // The buffers and field nodes of a record batch being built
+  struct RecordBatch;
+
+  // A block of the file holding an encapsulated message
+  struct Block {
+    int64_t offset;
+    int32_t metadata_length;
+    int32_t padding;
+    int64_t body_length;
+  };
+
+  // Add the buffers of a column of the visible slots of a tile group to the
+  // record batch
+  void AddColumn(TileGroup &tile_group, oid_t column_id,
+                 const std::vector<oid_t> &slots, bool all_visible,
+                 RecordBatch &batch) const;
+
+  // Write the record batch of a tile group. Returns the number of rows.
+  size_t WriteRecordBatch(TileGroup &tile_group);
+
+  // Write a message with the given flatbuffer metadata and body
+  Block WriteMessage(const std::vector<uint8_t> &metadata,
+                     const RecordBatch *body);
+
+  void Write(const void *data, size_t length);
+
+  void WritePadding(size_t length);
+
+ private:
+  DataTable *table_;
+
+  std::vector<oid_t> column_ids_;
+
+  cid_t read_cid_;
+
+  // The file being written and the number of bytes written so far
+  FILE *file_;
+  size_t file_offset_;
+
+  // The blocks of the record batches written so far, for the footer
+  std::vector<Block> record_batches_;
+};
+
+}  // namespace storage
+}  // namespace peloton
@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
 #include <mutex>
 
+#include "common/numa_manager.h"
 #include "common/synchronization/spin_latch.h"
 #include "common/internal_types.h"
 
@@ -56,7 +59,94 @@ class BackendManager {
 
   size_t GetAllocationCount() const { return allocation_count; }
 
+  //===--------------------------------------------------------------------===//
+  // Page-backed allocations
+  //===--------------------------------------------------------------------===//
+
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+  // Allocations smaller than this are never backed by huge pages
+  static constexpr size_t kHugePageThreshold = kHugePageSize;
+
+  /**
+   * Allocate memory for a large structure that is scanned or probed often.
+   * Following the huge_pages setting, allocations of kHugePageThreshold bytes
+   * or more are rounded up to whole huge pages, as long as that wastes little
+   * memory. The huge pages come from the reserve, from the explicit huge page
+   * pool, or from transparent huge pages, in that order. Other allocations
+   * come from the default allocator, unless they are placed on a NUMA node.
+   * The memory is not zeroed.
+   *
+   * @param size The number of bytes
+   * @param numa_node The NUMA node to place the memory on, if any
+   * @return The memory, to be released with ReleasePages()
+   */
+  void *AllocatePages(size_t size, int numa_node = NumaManager::kAnyNode);
+
+  // Release memory from AllocatePages(), given the same size and node
+  void ReleasePages(void *address, size_t size,
+                    int numa_node = NumaManager::kAnyNode);
+
+  /**
+   * Allocate short-lived memory, such as the hash tables and pools of a
+   * query. Mapping fresh huge pages costs more system calls and page faults
+   * than such memory gains from them, so only the reserve provides huge pages
+   * here. Everything else comes from the default allocator.
+   *
+   * @param size The number of bytes
+   * @return The memory, to be released with ReleaseTransient()
+   */
+  void *AllocateTransient(size_t size);
+
+  // Release memory from AllocateTransient(), given the same size
+  void ReleaseTransient(void *address, size_t size);
+
+  /**
+   * Map and fault in huge pages up front, for AllocatePages() to hand out
+   * without taking page faults later. Done once at startup.
+   *
+   * @param size The number of bytes to reserve
+   * @return Whether the reserve is in place
+   */
+  bool ReserveHugePages(size_t size);
+
+  // The number of allocations that were backed by huge pages
+  size_t GetHugePageAllocationCount() const {
+    return huge_page_allocation_count_.load();
+  }
+
  private:
+  // How huge pages are used
+  enum class HugePageMode { Off, Transparent, Explicit };
+
+  // Should an allocation of the given size be backed by huge pages?
+  bool UseHugePages(size_t size) const;
+
+  // The number of bytes mapped for an allocation, or 0 if it came from the
+  // default allocator
+  size_t GetMappedLength(size_t size, int numa_node) const;
+
+  // Map huge pages, or return nullptr if there are none
+  void *MapHugePages(size_t length);
+
+  // Take a region from the reserve, or return nullptr if none is left
+  void *TakeFromReserve(size_t length);
+
+  // Give a region back to the reserve
+  void ReturnToReserve(char *address, size_t length);
+
+ private:
+  HugePageMode huge_page_mode_;
+
+  // The reserve of pre-faulted huge pages, and the free regions in it by
+  // their offset
+  std::mutex reserve_lock_;
+  char *reserve_;
+  size_t reserve_size_;
+  std::map<size_t, size_t> reserve_free_;
+
+  std::atomic<size_t> huge_page_allocation_count_;
+
   // data file address
   void *data_file_address;
 
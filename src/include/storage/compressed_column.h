@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// compressed_column.h
+//
+// Identification: src/include/storage/compressed_column.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/internal_types.h"
+#include "common/macros.h"
+#include "type/value.h"
+
+namespace peloton {
+namespace storage {
+
+class Tile;
+
+//===----------------------------------------------------------------------===//
+//
+// The compressed form of the single column of a frozen tile (see
+// TileGroup::Freeze()). Frozen tiles never change, so their values can be
+// encoded to suit their contents:
+//
+// - Dictionary: the distinct strings of a VARCHAR/VARBINARY column are kept
+//   once, in sorted order, in one buffer. The tile's slots keep pointing to
+//   their value, which now is an entry of the dictionary. Since the entries
+//   are sorted, comparing a value with a constant amounts to comparing its
+//   pointer with the bounds of the entries that qualify (see GetEntryRange()).
+//
+// - Run-length: runs of equal integer values are stored as (value, end) pairs.
+//
+// - Frame-of-reference: integer values are stored as 1, 2 or 4 byte offsets
+//   from the smallest value.
+//
+// Integer encodings replace the tile's data. Scans decode the values of a
+// tile group into a buffer (see Decode()), random accesses use GetValue().
+//
+//===----------------------------------------------------------------------===//
+class CompressedColumn {
+ public:
+  enum class Encoding : uint32_t { Dictionary, RunLength, FrameOfReference };
+
+  /**
+   * Encode the first num_tuples values of the column of the given tile.
+   *
+   * @return The encoded column, or NULL if the column can't be encoded, or if
+   * encoding it would not save memory
+   */
+  static std::unique_ptr<CompressedColumn> Encode(const Tile &tile,
+                                                  oid_t num_tuples);
+
+  DISALLOW_COPY_AND_MOVE(CompressedColumn);
+
+  Encoding GetEncoding() const { return encoding_; }
+
+  type::TypeId GetTypeId() const { return type_id_; }
+
+  oid_t GetTupleCount() const { return num_tuples_; }
+
+  // The number of bytes the encoded column takes
+  size_t GetFootprint() const;
+
+  //===--------------------------------------------------------------------===//
+  // Integer encodings
+  //===--------------------------------------------------------------------===//
+
+  // Get the value of the tuple at the given offset
+  type::Value GetValue(oid_t tuple_offset) const;
+
+  // Write the raw, fixed-width values of all tuples to the given buffer
+  void Decode(char *dest) const;
+
+  //===--------------------------------------------------------------------===//
+  // Dictionary encoding
+  //===--------------------------------------------------------------------===//
+
+  // Get the entry of the dictionary equal to the given string, or NULL if there
+  // is none. Like all varlen values, entries are prefixed with their length.
+  const char *LookupEntry(const char *str, uint32_t len) const;
+
+  /**
+   * Find the entries of the dictionary that satisfy the comparison
+   * 'entry <cmp_type> str'. They are those in the range [*begin, *end) of the
+   * dictionary buffer, so a value qualifies iff its pointer is in the range.
+   */
+  void GetEntryRange(ExpressionType cmp_type, const char *str, uint32_t len,
+                     const char **begin, const char **end) const;
+
+  // The number of distinct values in the dictionary
+  size_t GetNumEntries() const { return entries_.size(); }
+
+ private:
+  CompressedColumn(Encoding encoding, type::TypeId type_id, oid_t num_tuples);
+
+  // Try the integer encodings
+  static std::unique_ptr<CompressedColumn> EncodeIntegers(const Tile &tile,
+                                                          oid_t num_tuples);
+
+  // Build the dictionary of a varlen column
+  static std::unique_ptr<CompressedColumn> EncodeStrings(const Tile &tile,
+                                                         oid_t num_tuples);
+
+  // The integer value of the tuple at the given offset
+  int64_t GetRawValue(oid_t tuple_offset) const;
+
+  // Find the first entry that is not less than (or, if upper is set, that is
+  // greater than) the given string
+  const char *FindEntry(const char *str, uint32_t len, bool upper) const;
+
+ private:
+  // How the column is encoded
+  Encoding encoding_;
+
+  // The type of the column, and the size of its raw values
+  type::TypeId type_id_;
+  size_t value_size_;
+
+  // The number of tuples
+  oid_t num_tuples_;
+
+  // Run-length: the value of each run, and the offset after its last tuple
+  std::vector<int64_t> run_values_;
+  std::vector<oid_t> run_ends_;
+
+  // Frame-of-reference: the smallest value, the size of each offset from it,
+  // and the offsets
+  int64_t base_;
+  uint32_t offset_size_;
+  std::unique_ptr<char[]> offsets_;
+
+  // Dictionary: the sorted entries, laid out one after the other in a buffer
+  std::unique_ptr<char[]> dictionary_;
+  size_t dictionary_size_;
+  std::vector<const char *> entries_;
+};
+
+}  // namespace storage
+}  // namespace peloton
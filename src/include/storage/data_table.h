@@ -17,6 +17,7 @@
 #include <mutex>
 #include <queue>
 #include <set>
+#include <vector>
 
 #include "common/container/lock_free_array.h"
 #include "common/item_pointer.h"
@@ -137,6 +138,24 @@ class DataTable : public AbstractTable {
                    concurrency::TransactionContext *transaction,
                    ItemPointer **index_entry_ptr, bool check_fk = true);
 
+  // insert a batch of tuples in table, in consecutive slots where possible.
+  // the tuples are performed as inserts of the transaction before they are
+  // added to the indexes, and their locations and the pointers to their index
+  // entries are returned. returns false if any of the tuples violates a
+  // constraint, in which case the transaction must abort.
+  bool InsertTuples(const std::vector<const AbstractTuple *> &tuples,
+                    concurrency::TransactionContext *transaction,
+                    std::vector<ItemPointer> &locations,
+                    std::vector<ItemPointer *> &index_entry_ptrs,
+                    bool check_fk = true);
+
+  // Insert a batch of tuples with ItemPointers provided explicitly
+  bool InsertTuples(const std::vector<const AbstractTuple *> &tuples,
+                    const std::vector<ItemPointer> &locations,
+                    concurrency::TransactionContext *transaction,
+                    std::vector<ItemPointer *> &index_entry_ptrs,
+                    bool check_fk = true);
+
   //===--------------------------------------------------------------------===//
   // TILE GROUP
   //===--------------------------------------------------------------------===//
@@ -154,6 +173,15 @@ class DataTable : public AbstractTable {
   std::shared_ptr<storage::TileGroup> GetTileGroupById(
       const oid_t &tile_group_id) const;
 
+  // Like GetTileGroup(), without taking a reference to the tile group. See
+  // StorageManager::GetTileGroupPtr().
+  storage::TileGroup *GetTileGroupPtr(
+      const std::size_t &tile_group_offset) const;
+
+  // The NUMA node of the tile group at the given offset, without accessing
+  // its tiles
+  int GetTileGroupNumaNode(const std::size_t &tile_group_offset) const;
+
   size_t GetTileGroupCount() const;
 
   // Get a tile group with given layout
@@ -211,8 +239,33 @@ class DataTable : public AbstractTable {
   // TRANSFORMERS
   //===--------------------------------------------------------------------===//
 
-  storage::TileGroup *TransformTileGroup(const oid_t &tile_group_offset,
-                                         const double &theta);
+  // A tile group is moved into the default layout in two steps, so that
+  // concurrent transactions keep working on it:
+  //
+  // 1. Once it is full, it becomes immutable, so that its slots are not
+  //    recycled, and nothing writes its tiles after the current epoch.
+  // 2. Once that epoch has expired, the visible values are copied into a tile
+  //    group in the new layout. It shares the header of the old one, so the
+  //    version chains and the index entries stay as they are, and it takes
+  //    the place of the old one under the same ID. The old one is retired
+  //    until no reader can be looking at it anymore.
+
+  /**
+   * Start moving the tile group at the given offset into the default layout,
+   * if the layouts differ by at least theta.
+   *
+   * @return Whether the transformation started
+   */
+  bool BeginTransformTileGroup(const oid_t &tile_group_offset,
+                               const double &theta);
+
+  /**
+   * Finish the transformations that started in an expired epoch.
+   *
+   * @param expired_eid The latest epoch that has expired
+   * @return The number of tile groups transformed
+   */
+  size_t FinishTransformTileGroups(eid_t expired_eid);
 
   //===--------------------------------------------------------------------===//
   // STATS
@@ -282,6 +335,15 @@ class DataTable : public AbstractTable {
                        concurrency::TransactionContext *transaction,
                        ItemPointer **index_entry_ptr);
 
+  // allocate the index entries of a batch of tuples.
+  void AllocateIndirections(const std::vector<ItemPointer> &locations,
+                            std::vector<ItemPointer *> &index_entry_ptrs);
+
+  // insert a batch of tuples into all indexes, one index at a time.
+  bool InsertInIndexes(const std::vector<const AbstractTuple *> &tuples,
+                       concurrency::TransactionContext *transaction,
+                       const std::vector<ItemPointer *> &index_entry_ptrs);
+
   inline static size_t GetActiveTileGroupCount() {
     return default_active_tilegroup_count_;
   }
@@ -302,6 +364,10 @@ class DataTable : public AbstractTable {
   // Claim a tuple slot in a tile group
   ItemPointer GetEmptyTupleSlot(const storage::Tuple *tuple);
 
+  // Claim tuple slots for a batch of tuples, and copy them in
+  void GetEmptyTupleSlots(const std::vector<const AbstractTuple *> &tuples,
+                          std::vector<ItemPointer> &locations);
+
   hash_t Hash() const;
 
   bool Equals(const storage::DataTable &other) const;
@@ -336,6 +402,10 @@ class DataTable : public AbstractTable {
   // Drop all tile groups of the table. Used by recovery
   void DropTileGroups();
 
+  // Find the ID of the tile group at the given offset, fetching the evicted
+  // tile groups after it
+  oid_t FindTileGroupId(const std::size_t &tile_group_offset) const;
+
   //===--------------------------------------------------------------------===//
   // INDEX HELPERS
   //===--------------------------------------------------------------------===//
@@ -434,6 +504,12 @@ class DataTable : public AbstractTable {
   // index samples mutex
   std::mutex index_samples_mutex_;
 
+  // the tile groups being transformed, with the epoch they started in
+  std::vector<std::pair<oid_t, eid_t>> transforming_tile_groups_;
+
+  // transforming tile groups mutex
+  std::mutex transform_mutex_;
+
   static oid_t invalid_tile_group_id;
 
   // trigger list
@@ -14,9 +14,11 @@
 
 #include <vector>
 #include <atomic>
+#include <mutex>
 #include "common/container/cuckoo_map.h"
 #include "common/internal_types.h"
 #include "storage/tile_group.h"
+#include "storage/tiering_manager.h"
 
 namespace peloton {
 
@@ -113,6 +115,37 @@ class StorageManager {
 
   std::shared_ptr<storage::TileGroup> GetTileGroup(const oid_t oid);
 
+  /**
+   * Find a tile group without taking a reference to it, or nullptr if there
+   * is none. Dropped tile groups are only destroyed once the epoch they were
+   * dropped in has expired, so the pointer stays valid for as long as the
+   * transaction of the caller runs.
+   */
+  inline storage::TileGroup *GetTileGroupPtr(const oid_t oid) {
+    auto *tile_group = LookupTileGroupPtr(oid);
+    if (tile_group != nullptr) {
+      // Bring the tiles back in if they were evicted
+      TieringManager::GetInstance().Access(*tile_group);
+    }
+    return tile_group;
+  }
+
+  // Like GetTileGroupPtr(), without counting as an access to the tile group,
+  // for looking at its metadata only
+  inline storage::TileGroup *LookupTileGroupPtr(const oid_t oid) const {
+    auto *chunk = tile_group_chunks_[oid >> kTileGroupChunkBits].load(
+        std::memory_order_acquire);
+    if (chunk == nullptr) {
+      return nullptr;
+    }
+    return chunk[oid & (kTileGroupChunkSize - 1)].load(
+        std::memory_order_acquire);
+  }
+
+  // Destroy the dropped tile groups that no transaction can see anymore.
+  // Returns the number of tile groups destroyed.
+  size_t ReleaseDroppedTileGroups(eid_t expired_eid);
+
   void ClearTileGroup(void);
 
  private:
@@ -134,6 +167,32 @@ class StorageManager {
 
   CuckooMap<oid_t, std::shared_ptr<storage::TileGroup>> tile_group_locator_;
   static std::shared_ptr<storage::TileGroup> empty_tile_group_;
+
+  //===--------------------------------------------------------------------===//
+  // Data members for the direct tile group lookup
+  //===--------------------------------------------------------------------===//
+
+  // The tile groups are in a flat array indexed by their ID, which is split
+  // into chunks that are allocated as the IDs grow
+  static constexpr uint32_t kTileGroupChunkBits = 16;
+  static constexpr uint32_t kTileGroupChunkSize = 1u << kTileGroupChunkBits;
+  static constexpr uint32_t kTileGroupChunkCount =
+      1u << (sizeof(oid_t) * 8 - kTileGroupChunkBits);
+
+  // Set the entry of the tile group with the given ID, returning the old one
+  storage::TileGroup *SetTileGroupPtr(const oid_t oid,
+                                      storage::TileGroup *tile_group);
+
+  // Keep a dropped or replaced tile group until its epoch has expired
+  void RetireTileGroup(std::shared_ptr<storage::TileGroup> tile_group);
+
+  std::atomic<std::atomic<storage::TileGroup *> *>
+      tile_group_chunks_[kTileGroupChunkCount];
+
+  // Protects the dropped tile groups
+  std::mutex dropped_lock_;
+  std::vector<std::pair<eid_t, std::shared_ptr<storage::TileGroup>>>
+      dropped_tile_groups_;
 };
 
 }  // namespace
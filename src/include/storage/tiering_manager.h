@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tiering_manager.h
+//
+// Identification: src/include/storage/tiering_manager.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "common/internal_types.h"
+#include "common/macros.h"
+#include "storage/tile_group.h"
+
+namespace peloton {
+namespace storage {
+
+//===----------------------------------------------------------------------===//
+//
+// Moves the tiles of cold frozen tile groups (see TileGroup::Freeze()) to a
+// file on local storage, and brings them back when they are accessed again.
+//
+// Every access through StorageManager::GetTileGroup() records the time on the
+// tiering clock, which the GC advances. The GC evicts the frozen tile groups
+// that haven't been accessed for tiering_cold_seconds in two steps:
+//
+// 1. The values of the tiles are appended to the file, and the tile group
+//    becomes Evicting. Accessing it in this state cancels the eviction.
+// 2. Once the epoch that was current when it became Evicting has expired,
+//    nobody who found the tile group Resident can still be reading its
+//    tiles. If it is still Evicting, the memory of the tiles is freed, and it
+//    becomes Evicted.
+//
+// The header of an evicted tile group stays in memory, so visibility checks,
+// updates and deletes work as before, and so does every pointer to it. The
+// first access to it reads the tiles back in, and scans fetch the tile groups
+// ahead of them in the background.
+//
+//===----------------------------------------------------------------------===//
+class TieringManager {
+ public:
+  // The number of tile groups a scan fetches ahead of the one it is reading
+  static constexpr size_t kPrefetchDistance = 2;
+
+  // Global Singleton
+  static TieringManager &GetInstance();
+
+  DISALLOW_COPY_AND_MOVE(TieringManager);
+
+  ~TieringManager();
+
+  // Record an access to the tile group, bringing its tiles back in if they
+  // have been evicted
+  void Access(TileGroup &tile_group) {
+    tile_group.Touch(clock_.load(std::memory_order_relaxed));
+    if (tile_group.GetResidency() != TileGroup::Residency::Resident) {
+      FaultIn(tile_group);
+    }
+  }
+
+  // Read the tiles of the given tile group back in, if they were evicted, or
+  // cancel their eviction
+  void FaultIn(TileGroup &tile_group);
+
+  // Start reading the tiles of the tile group with the given ID back in, in
+  // the background, if they were evicted
+  void Prefetch(oid_t tile_group_id);
+
+  // Let the given frozen tile group be evicted once it is cold
+  void AddCandidate(const std::shared_ptr<TileGroup> &tile_group);
+
+  /**
+   * Advance the tiering clock, start evicting the candidates that have gone
+   * cold, and finish the evictions that started in an expired epoch.
+   *
+   * @param expired_eid The latest epoch that has expired
+   * @return The number of tile groups evicted
+   */
+  size_t EvictColdTileGroups(eid_t expired_eid);
+
+  // The number of tile groups whose tiles are on file
+  size_t GetNumEvicted() const { return num_evicted_.load(); }
+
+ private:
+  TieringManager();
+
+  // A frozen tile group, where its tiles are in the file once it is evicting,
+  // and the epoch its eviction started in
+  struct Candidate {
+    std::weak_ptr<TileGroup> tile_group;
+    off_t offset;
+    size_t size;
+    eid_t epoch_id;
+    // Whether its tiles have been freed, and whether they are being fetched
+    bool evicted;
+    bool prefetching;
+  };
+
+  // Write the tiles of a resident tile group to the file, and make it
+  // Evicting in the current epoch
+  bool BeginEviction(TileGroup &tile_group);
+
+  // Free the tiles of a tile group that is still evicting
+  bool FinishEviction(TileGroup &tile_group);
+
+  // Give the space of the candidate's tiles in the file back. The caller
+  // holds the lock.
+  void ReleaseRegion(Candidate &candidate);
+
+  // Open the file on first use
+  bool OpenFile();
+
+ private:
+  // Protects the candidates and the end of the file
+  std::mutex lock_;
+  std::unordered_map<oid_t, Candidate> candidates_;
+
+  // The file, and where the next tiles go in it
+  int fd_;
+  off_t file_end_;
+
+  // The number of seconds since startup, as of the last GC run
+  std::chrono::steady_clock::time_point start_time_;
+  std::atomic<uint64_t> clock_;
+
+  std::atomic<size_t> num_evicted_;
+};
+
+}  // namespace storage
+}  // namespace peloton
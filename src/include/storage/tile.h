@@ -12,13 +12,15 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
 
 #include "catalog/manager.h"
 #include "catalog/schema.h"
 #include "common/item_pointer.h"
 #include "common/printable.h"
-#include "type/abstract_pool.h"
+#include "common/synchronization/spin_latch.h"
+#include "type/arena_pool.h"
 #include "type/serializeio.h"
 #include "type/serializer.h"
 
@@ -38,6 +40,7 @@ class Tuple;
 class TileGroup;
 class TileGroupHeader;
 class TupleIterator;
+class CompressedColumn;
 
 /**
  * Represents a Tile.
@@ -170,13 +173,77 @@ class Tile : public Printable {
   void DeserializeTuplesFromWithoutHeader(SerializeInput &input,
                                           type::AbstractPool *pool = nullptr);
 
-  type::AbstractPool *GetPool() { return (pool); }
+  type::ArenaPool *GetPool() { return (pool); }
+
+  //===--------------------------------------------------------------------===//
+  // Variable-length data
+  //===--------------------------------------------------------------------===//
+
+  // Free the uninlined values of the tuple in the given slot
+  void ReclaimVarlenColumns(oid_t tuple_offset);
+
+  // Move the uninlined values that live in chunks of the pool being evacuated
+  // to fresh memory. Returns the number of values moved.
+  size_t EvacuateVarlenColumns();
+
+  // Copy a value into another tile, unless the GC has reset its slot. The
+  // value can't be reclaimed while it is copied. Returns false if the slot
+  // was reset.
+  bool CopyLiveValue(oid_t tuple_offset, oid_t column_id, Tile *dest_tile,
+                     oid_t dest_column_id);
+
+  //===--------------------------------------------------------------------===//
+  // Compression
+  //===--------------------------------------------------------------------===//
+
+  /**
+   * Encode the column of this tile, if that saves memory. The tile must have a
+   * single column, and its first num_tuples tuples must never change again.
+   * Readers may still be looking at the memory that the encoding replaces, so
+   * it is retired with the given epoch. If the epoch is INVALID_EID, the tile
+   * isn't shared yet, and that memory is freed right away.
+   *
+   * @return True if the tile was compressed
+   */
+  bool Compress(oid_t num_tuples, eid_t epoch_id);
+
+  // Get the compressed form of the tile's column, or NULL if it has none
+  const CompressedColumn *GetCompressedColumn() const {
+    return compressed_column_.load();
+  }
+
+  // Release the memory that was retired in an epoch that has expired. Returns
+  // true if retired memory remains.
+  bool ReleaseRetiredMemory(eid_t expired_epoch_id);
+
+  //===--------------------------------------------------------------------===//
+  // Tiering
+  //===--------------------------------------------------------------------===//
+
+  // Write whether the tile is compressed, and the values of all its slots, in
+  // the format that Restore() reads
+  void SerializeValuesTo(SerializeOutput &output);
+
+  // Free the data, the uninlined values and the compressed column of the
+  // tile. Nobody may be looking at them anymore.
+  void Evict();
+
+  // Rebuild an evicted tile from what SerializeValuesTo() wrote
+  void Restore(SerializeInput &input);
+
+  bool IsEvicted() const {
+    return data == nullptr && GetCompressedColumn() == nullptr;
+  }
 
   char *GetTupleLocation(const oid_t tuple_offset) const;
 
   // Sync the contents
   void Sync();
 
+ private:
+  // Free the memory that compression replaced
+  void FreeRetiredMemory();
+
  protected:
   //===--------------------------------------------------------------------===//
   // Data members
@@ -197,11 +264,26 @@ class Tile : public Printable {
   // set of fixed-length tuple slots
   char *data;
 
+  // The NUMA node the tuple slots are allocated on
+  int numa_node_;
+
   // relevant tile group
   TileGroup *tile_group;
 
   // storage pool for uninlined data
-  type::AbstractPool *pool;
+  type::ArenaPool *pool;
+
+  // Serializes the reclamation and the evacuation of uninlined values
+  common::synchronization::SpinLatch varlen_latch_;
+
+  // The compressed form of the tile's column, once it has been compressed
+  std::atomic<CompressedColumn *> compressed_column_;
+
+  // The data and the pool that compression replaced, and the epoch they were
+  // retired in
+  char *retired_data_;
+  type::ArenaPool *retired_pool_;
+  eid_t retired_epoch_;
 
   // number of tuple slots allocated
   oid_t num_tuple_slots;
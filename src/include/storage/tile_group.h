@@ -28,6 +28,8 @@
 
 namespace peloton {
 
+class AbstractTuple;
+
 namespace catalog {
 class Manager;
 class Schema;
@@ -67,13 +69,16 @@ class TileGroup : public Printable {
   friend class Tile;
   friend class TileGroupFactory;
   friend class gc::GCManager;
+  friend class TieringManager;
 
   TileGroup() = delete;
   TileGroup(TileGroup const &) = delete;
 
  public:
-  // Tile group constructor
-  TileGroup(BackendType backend_type, TileGroupHeader *tile_group_header,
+  // Tile group constructor. A tile group in a new layout shares the header of
+  // the one it replaces.
+  TileGroup(BackendType backend_type,
+            std::shared_ptr<TileGroupHeader> tile_group_header,
             AbstractTable *table, const std::vector<catalog::Schema> &schemas,
             std::shared_ptr<const Layout> layout, int tuple_count);
 
@@ -84,11 +89,17 @@ class TileGroup : public Printable {
   //===--------------------------------------------------------------------===//
 
   // copy tuple in place.
-  void CopyTuple(const Tuple *tuple, const oid_t &tuple_slot_id);
+  void CopyTuple(const AbstractTuple *tuple, const oid_t &tuple_slot_id);
 
   // insert tuple at next available slot in tile if a slot exists
   oid_t InsertTuple(const Tuple *tuple);
 
+  // insert as many of the count tuples starting at tuples[begin] as there are
+  // consecutive slots left, copying them column by column. returns the number
+  // inserted, and the slot of the first one in first_slot
+  oid_t InsertTuples(const std::vector<const AbstractTuple *> &tuples,
+                     size_t begin, oid_t count, oid_t &first_slot);
+
   // insert tuple at specific tuple slot
   // used by recovery mode
   oid_t InsertTupleFromRecovery(cid_t commit_id, oid_t tuple_slot_id,
@@ -124,6 +135,11 @@ class TileGroup : public Printable {
 
   TileGroupHeader *GetHeader() const { return tile_group_header; }
 
+  // Get a reference to the header, for a tile group that replaces this one
+  std::shared_ptr<TileGroupHeader> GetHeaderReference() const {
+    return tile_group_header_ref_;
+  }
+
   void SetHeader(TileGroupHeader *header) { tile_group_header = header; }
 
   unsigned int NumTiles() const { return tiles.size(); }
@@ -164,6 +180,46 @@ class TileGroup : public Printable {
   // Get the layout of the TileGroup. Used to locate columns.
   const storage::Layout &GetLayout() const { return *tile_group_layout_; }
 
+  /**
+   * Freeze the tile group once it is cold, compressing its tiles. It must have
+   * the column layout and be full, and all of its tuples must have been
+   * committed before the given commit ID and not have been updated or deleted
+   * since. Frozen tile groups are immutable, so their slots are never reused.
+   *
+   * @param expired_cid Commit ID that all tuples must be older than
+   * @param epoch_id The epoch to retire the memory that compression replaces in
+   * @return SUCCESS if the tile group was frozen, QUEUING if it is not cold
+   * yet, and FAILURE if it can't be frozen until one of its free or superseded
+   * slots is reused
+   */
+  ResultType Freeze(cid_t expired_cid, eid_t epoch_id);
+
+  //===--------------------------------------------------------------------===//
+  // Tiering (see TieringManager)
+  //===--------------------------------------------------------------------===//
+
+  // Whether the tiles of a frozen tile group are in memory. The header always
+  // is. Evicting tile groups are still in memory, until the readers that may
+  // be looking at their tiles are gone.
+  enum class Residency : uint32_t { Resident, Evicting, Evicted };
+
+  Residency GetResidency() const { return residency_.load(); }
+
+  // Record an access at the given time of the tiering clock. The time is only
+  // written when it changes, to keep accesses from contending on the line.
+  void Touch(uint64_t clock) {
+    if (last_access_.load(std::memory_order_relaxed) != clock) {
+      last_access_.store(clock, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t GetLastAccess() const {
+    return last_access_.load(std::memory_order_relaxed);
+  }
+
+  // The NUMA node the tiles are allocated on, or NumaManager::kAnyNode
+  int GetNumaNode() const { return numa_node_; }
+
  protected:
   //===--------------------------------------------------------------------===//
   // Data members
@@ -182,6 +238,7 @@ class TileGroup : public Printable {
 
   // associated tile group
   TileGroupHeader *tile_group_header;
+  std::shared_ptr<TileGroupHeader> tile_group_header_ref_;
 
   // associated table
   AbstractTable *table;  // this design is fantastic!!!
@@ -196,6 +253,14 @@ class TileGroup : public Printable {
 
   // Refernce to the layout of the TileGroup
   std::shared_ptr<const Layout> tile_group_layout_;
+
+  // Where the tiles are, and when the tile group was last accessed. Changes of
+  // residency happen under the tile_group_mutex.
+  std::atomic<Residency> residency_;
+  std::atomic<uint64_t> last_access_;
+
+  // The NUMA node of the tiles, chosen when the tile group is created
+  int numa_node_;
 };
 
 }  // namespace storage
@@ -34,6 +34,12 @@ class TileGroupFactory {
                                  const std::vector<catalog::Schema> &schemas,
                                  std::shared_ptr<const Layout> layout,
                                  int tuple_count);
+
+  // Get a tile group in the given layout that replaces the given one, sharing
+  // its header. The tiles are empty.
+  static TileGroup *GetTransformedTileGroup(
+      const TileGroup &tile_group, const std::vector<catalog::Schema> &schemas,
+      std::shared_ptr<const Layout> layout);
 };
 
 }  // namespace storage
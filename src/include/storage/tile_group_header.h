@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 
@@ -124,6 +125,27 @@ class TileGroupHeader : public Printable {
     }
   }
 
+  /**
+   * Claim up to count consecutive empty tuple slots.
+   *
+   * @param count The number of slots wanted
+   * @param first_slot Set to the first slot claimed
+   * @return The number of slots claimed, which is 0 once the tile group is full
+   */
+  oid_t GetNextEmptyTupleSlots(oid_t count, oid_t &first_slot) {
+    oid_t next = next_tuple_slot.load(std::memory_order_relaxed);
+    oid_t claimed;
+    do {
+      if (next >= num_tuple_slots) {
+        return 0;
+      }
+      claimed = std::min(count, static_cast<oid_t>(num_tuple_slots - next));
+    } while (!next_tuple_slot.compare_exchange_weak(
+        next, next + claimed, std::memory_order_relaxed));
+    first_slot = next;
+    return claimed;
+  }
+
   /**
    * Used by logging
    */
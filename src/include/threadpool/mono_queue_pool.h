@@ -24,7 +24,9 @@ namespace threadpool {
 class MonoQueuePool {
  public:
   MonoQueuePool(const std::string &name, uint32_t task_queue_size,
-                uint32_t worker_pool_size);
+                uint32_t worker_pool_size,
+                const TaskSchedulerConfig &config = TaskSchedulerConfig(),
+                bool numa_affinity = false);
 
   ~MonoQueuePool();
 
@@ -33,15 +35,18 @@ class MonoQueuePool {
   void Shutdown();
 
   template <typename F>
-  void SubmitTask(const F &func);
+  void SubmitTask(const F &func, TaskClass task_class = TaskClass::OLTP);
 
   uint32_t NumWorkers() const { return worker_pool_.NumWorkers(); }
 
+  TaskQueue &GetTaskQueue() { return task_queue_; }
+
   /// Instances for various components
   static MonoQueuePool &GetInstance();
   // TODO(Tianyu): Rename to (Brain)QueryHistoryLog or something
   static MonoQueuePool &GetBrainInstance();
   static MonoQueuePool &GetExecutionInstance();
+  static MonoQueuePool &GetCompilationInstance();
 
  private:
   TaskQueue task_queue_;
@@ -57,9 +62,11 @@ class MonoQueuePool {
 
 inline MonoQueuePool::MonoQueuePool(const std::string &name,
                                     uint32_t task_queue_size,
-                                    uint32_t worker_pool_size)
-    : task_queue_(task_queue_size),
-      worker_pool_(name, worker_pool_size, task_queue_),
+                                    uint32_t worker_pool_size,
+                                    const TaskSchedulerConfig &config,
+                                    bool numa_affinity)
+    : task_queue_(task_queue_size, config),
+      worker_pool_(name, worker_pool_size, task_queue_, numa_affinity),
       is_running_(false) {}
 
 inline MonoQueuePool::~MonoQueuePool() {
@@ -79,11 +86,11 @@ inline void MonoQueuePool::Shutdown() {
 }
 
 template <typename F>
-inline void MonoQueuePool::SubmitTask(const F &func) {
+inline void MonoQueuePool::SubmitTask(const F &func, TaskClass task_class) {
   if (!is_running_) {
     Startup();
   }
-  task_queue_.Enqueue(std::move(func));
+  task_queue_.Enqueue(std::function<void()>(func), task_class);
 }
 
 inline MonoQueuePool &MonoQueuePool::GetInstance() {
@@ -97,9 +104,23 @@ inline MonoQueuePool &MonoQueuePool::GetInstance() {
 
   std::string name = "main-pool";
 
-  static MonoQueuePool mono_queue_pool(name,
-                                       static_cast<uint32_t>(task_queue_size),
-                                       static_cast<uint32_t>(worker_pool_size));
+  // Client queries are scheduled by workload class, so that reports cannot
+  // take every worker away from short statements
+  TaskSchedulerConfig config;
+  config.weights[static_cast<int>(TaskClass::OLTP)] =
+      static_cast<uint32_t>(settings::SettingsManager::GetInt(
+          settings::SettingId::scheduler_oltp_weight));
+  config.weights[static_cast<int>(TaskClass::OLAP)] =
+      static_cast<uint32_t>(settings::SettingsManager::GetInt(
+          settings::SettingId::scheduler_olap_weight));
+  config.max_running[static_cast<int>(TaskClass::OLAP)] =
+      static_cast<uint32_t>(settings::SettingsManager::GetInt(
+          settings::SettingId::scheduler_max_olap_tasks));
+  config.max_running[static_cast<int>(TaskClass::MAINTENANCE)] = 1;
+
+  static MonoQueuePool mono_queue_pool(
+      name, static_cast<uint32_t>(task_queue_size),
+      static_cast<uint32_t>(worker_pool_size), config);
   return mono_queue_pool;
 }
 
@@ -131,11 +152,33 @@ inline MonoQueuePool &MonoQueuePool::GetExecutionInstance() {
 
   std::string name = "executor-pool";
 
+  // Parallel scans hand the workers the tile groups on their own node first
+  bool numa_affinity = settings::SettingsManager::GetBool(
+      settings::SettingId::numa_worker_affinity);
+
   static MonoQueuePool brain_queue_pool(
       name, static_cast<uint32_t>(task_queue_size),
-      static_cast<uint32_t>(worker_pool_size));
+      static_cast<uint32_t>(worker_pool_size), TaskSchedulerConfig(),
+      numa_affinity);
   return brain_queue_pool;
 }
 
+inline MonoQueuePool &MonoQueuePool::GetCompilationInstance() {
+  int32_t task_queue_size = settings::SettingsManager::GetInt(
+      settings::SettingId::codegen_compile_queue_size);
+  int32_t worker_pool_size = settings::SettingsManager::GetInt(
+      settings::SettingId::codegen_compiler_threads);
+
+  PELOTON_ASSERT(task_queue_size > 0);
+  PELOTON_ASSERT(worker_pool_size > 0);
+
+  std::string name = "compiler-pool";
+
+  static MonoQueuePool compilation_queue_pool(
+      name, static_cast<uint32_t>(task_queue_size),
+      static_cast<uint32_t>(worker_pool_size));
+  return compilation_queue_pool;
+}
+
 }  // namespace threadpool
 }  // namespace peloton
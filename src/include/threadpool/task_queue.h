@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// task_queue.h
+//
+// Identification: src/include/threadpool/task_queue.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "common/container/lock_free_queue.h"
+#include "common/macros.h"
+#include "statistics/latency_metric.h"
+
+// Number of queries whose queue time is kept per task class
+#define TASK_QUEUE_LATENCY_HISTORY 1000
+
+namespace peloton {
+namespace threadpool {
+
+/**
+ * The workload class of a task. Each class has its own queue.
+ */
+enum class TaskClass {
+  // Short transactional statements, e.g. point lookups and updates
+  OLTP = 0,
+  // Long running analytical queries
+  OLAP = 1,
+  // Background work such as ANALYZE and index builds
+  MAINTENANCE = 2,
+};
+
+#define NUM_TASK_CLASSES 3
+
+/**
+ * How the TaskQueue shares the workers between task classes
+ */
+struct TaskSchedulerConfig {
+  // Relative share of dequeues each class gets while all of them are busy
+  uint32_t weights[NUM_TASK_CLASSES] = {1, 1, 1};
+  // Maximum number of tasks of each class running at once, 0 for no limit
+  uint32_t max_running[NUM_TASK_CLASSES] = {0, 0, 0};
+};
+
+/**
+ * @brief A multi-producer multi-consumer task queue with one lock-free queue
+ * per TaskClass.
+ *
+ * Workers dequeue with stride scheduling: each class advances a virtual
+ * clock by the inverse of its weight on every dequeue, and the non-empty
+ * class with the smallest clock goes next. A burst of analytical queries
+ * thus cannot starve short statements. A class that reached its running
+ * limit is skipped until one of its tasks finishes. Without any weights or
+ * limits configured the classes are simply visited in turn, without taking
+ * a lock.
+ *
+ * The time every task spends in the queue is recorded per class.
+ */
+class TaskQueue {
+ public:
+  explicit TaskQueue(size_t size,
+                     const TaskSchedulerConfig &config = TaskSchedulerConfig());
+
+  DISALLOW_COPY(TaskQueue);
+
+  /**
+   * @brief Enqueue a task
+   * @param task the task
+   * @param task_class the workload class of the task
+   */
+  void Enqueue(std::function<void()> &&task,
+               TaskClass task_class = TaskClass::OLTP);
+
+  /**
+   * @brief Dequeue the task that should run next. The caller must call
+   * Finish() with the class of the task once the task is done.
+   * @param[out] task the task
+   * @param[out] task_class the class of the task
+   * @return false if no task may run right now
+   */
+  bool Dequeue(std::function<void()> &task, TaskClass &task_class);
+
+  /**
+   * @brief Signal that a task obtained from Dequeue() is done
+   */
+  void Finish(TaskClass task_class);
+
+  /**
+   * @return whether all the queues are empty
+   */
+  bool IsEmpty() const { return queued_count_.load() == 0; }
+
+  void SetConfig(const TaskSchedulerConfig &config);
+
+  size_t GetRunningCount(TaskClass task_class) const {
+    return running_count_[static_cast<int>(task_class)].load();
+  }
+
+  size_t GetQueuedCount(TaskClass task_class) const {
+    return class_queued_count_[static_cast<int>(task_class)].load();
+  }
+
+  /**
+   * @return the queue time (in ms) of the latest tasks of the given class
+   */
+  stats::LatencyMetric &GetQueueLatencyMetric(TaskClass task_class) {
+    return *queue_latencies_[static_cast<int>(task_class)];
+  }
+
+ private:
+  struct Entry {
+    std::function<void()> task;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  // Amount of virtual time a dequeue of a weight 1 class costs
+  static constexpr uint64_t kStride = 1 << 20;
+
+  // Pick the next task by stride scheduling, return its class or -1
+  int DequeueScheduled(Entry &entry);
+
+  // Pick the next task from the classes in turn, return its class or -1
+  int DequeueRoundRobin(Entry &entry);
+
+  static bool NeedsScheduling(const TaskSchedulerConfig &config);
+
+  std::unique_ptr<LockFreeQueue<Entry>> queues_[NUM_TASK_CLASSES];
+
+  std::atomic<size_t> queued_count_{0};
+  std::atomic<size_t> class_queued_count_[NUM_TASK_CLASSES];
+  std::atomic<size_t> running_count_[NUM_TASK_CLASSES];
+
+  std::unique_ptr<stats::LatencyMetric> queue_latencies_[NUM_TASK_CLASSES];
+
+  // Whether the config has weights or limits that need stride scheduling
+  std::atomic<bool> scheduled_;
+  // The class the round robin dequeue visits first
+  std::atomic<uint32_t> next_class_{0};
+
+  // Scheduling state, protected by schedule_lock_
+  std::mutex schedule_lock_;
+  TaskSchedulerConfig config_;
+  uint64_t pass_[NUM_TASK_CLASSES];
+};
+
+}  // namespace threadpool
+}  // namespace peloton
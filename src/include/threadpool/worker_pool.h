@@ -18,22 +18,22 @@
 #include <thread>
 #include <vector>
 
-#include "common/container/lock_free_queue.h"
+#include "threadpool/task_queue.h"
 
 namespace peloton {
 namespace threadpool {
 
-using TaskQueue = peloton::LockFreeQueue<std::function<void()>>;
-
 /**
  * @brief A worker pool that maintains a group of worker threads. This pool is
  * restartable, meaning it can be started again after it has been shutdown.
  * Calls to Startup() and Shutdown() are thread-safe and idempotent.
+ *
+ * With NUMA affinity, the workers are bound to the NUMA nodes in turn.
  */
 class WorkerPool {
  public:
   WorkerPool(const std::string &pool_name, uint32_t num_workers,
-             TaskQueue &task_queue);
+             TaskQueue &task_queue, bool numa_affinity = false);
 
   /**
    * @brief Start this worker pool. Thread-safe and idempotent.
@@ -63,6 +63,8 @@ class WorkerPool {
   std::atomic_bool is_running_;
   // The queue where workers pick up tasks
   TaskQueue &task_queue_;
+  // Whether the workers are bound to NUMA nodes
+  bool numa_affinity_;
 };
 
 }  // namespace threadpool
@@ -26,6 +26,7 @@
 #include "executor/plan_executor.h"
 #include "optimizer/abstract_optimizer.h"
 #include "parser/sql_statement.h"
+#include "threadpool/task_queue.h"
 #include "type/type.h"
 
 namespace peloton {
@@ -72,18 +73,34 @@ class TrafficCop {
       const std::vector<int> &result_format, std::vector<ResultValue> &result,
       size_t thread_id = 0);
 
+  // Decide which workload class the execution of a plan belongs to.
+  // Scans, joins and aggregates whose estimated cardinality reaches
+  // scheduler_olap_min_rows are analytical, ANALYZE and bulk loads are
+  // maintenance, everything else is transactional.
+  static threadpool::TaskClass ClassifyPlan(const planner::AbstractPlan *plan);
+
   // Helper to handle txn-specifics for the plan-tree of a statement.
   executor::ExecutionResult ExecuteHelper(
       std::shared_ptr<planner::AbstractPlan> plan,
       const std::vector<type::Value> &params, std::vector<ResultValue> &result,
       const std::vector<int> &result_format, size_t thread_id = 0);
 
-  // Prepare a statement using the parse tree
+  // Prepare a statement using the parse tree. The optimized plan is looked
+  // up in (and added to) the plan cache shared by all connections.
   std::shared_ptr<Statement> PrepareStatement(
       const std::string &statement_name, const std::string &query_string,
       std::unique_ptr<parser::SQLStatementList> sql_stmt_list,
+      const std::vector<int32_t> &param_types = std::vector<int32_t>(),
       size_t thread_id = 0);
 
+  // Switch the plan of a prepared statement to the variant built for the
+  // selectivities of the given parameter values, planning a new variant if
+  // there is none yet. Keeps the current plan if the parameters are not
+  // selective enough to matter.
+  void SelectPlanForParams(const std::shared_ptr<Statement> &statement,
+                           const std::vector<type::Value> &param_values,
+                           size_t thread_id = 0);
+
   bool BindParamsForCachePlan(
       const std::vector<std::unique_ptr<expression::AbstractExpression>> &,
       const size_t thread_id = 0);
@@ -139,6 +156,9 @@ class TrafficCop {
 
   bool GetQueuing() { return is_queuing_; }
 
+  // Whether a transaction is open on this connection
+  bool IsInTransaction() const { return !tcop_txn_state_.empty(); }
+
   executor::ExecutionResult p_status_;
 
   void SetDefaultDatabaseName(std::string default_database_name) {
@@ -118,8 +118,8 @@ class LayoutTuner {
    * the difference between the schema of a existing tilegroup and the desired
    * schema, and normalizes this difference with respect to the column count, so
    * that it falls within [0, 1] Theta should not be set to zero, otherwise it
-   * will always trigger DataTable::TransformTileGroup, even if the schema is
-   * the same. 
+   * will always trigger DataTable::BeginTransformTileGroup, even if the schema
+   * is the same. 
    */
   double theta = 0.0001;
 
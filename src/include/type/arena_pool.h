@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// arena_pool.h
+//
+// Identification: src/include/type/arena_pool.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/internal_types.h"
+#include "common/macros.h"
+#include "common/synchronization/spin_latch.h"
+#include "type/abstract_pool.h"
+
+namespace peloton {
+namespace type {
+
+//===----------------------------------------------------------------------===//
+//
+// A memory pool for the variable-length data of a tile. Memory is carved out
+// of large chunks by bumping a pointer, so an allocation costs neither a
+// malloc nor a hash table insert. Each allocation is preceded by a small
+// header naming its chunk and size. A chunk is released once all of its
+// allocations have been freed.
+//
+// Values that are freed in random order leave chunks sparsely used. Such
+// fragmented chunks can be evacuated: the owner of the pool moves the values
+// still living in them into fresh memory (see Tile::EvacuateVarlenColumns()).
+// Since concurrent readers may still be looking at the old copies, evacuated
+// chunks are retired with the current epoch and only released once the epoch
+// has expired (see gc::GCManager::CompactVarlenPools()).
+//
+//===----------------------------------------------------------------------===//
+class ArenaPool : public AbstractPool {
+ public:
+  // The size of a regular chunk
+  static constexpr size_t kChunkSize = 64 * 1024;
+
+  // Allocations larger than this get a chunk of their own
+  static constexpr size_t kMaxSmallAllocation = kChunkSize / 8;
+
+  // A pool is compacted once it holds at least this many chunks, less than
+  // half of whose space is used
+  static constexpr size_t kMinChunksToCompact = 4;
+
+  ArenaPool();
+
+  ~ArenaPool();
+
+  void *Allocate(size_t size) override;
+
+  void Free(void *ptr) override;
+
+  // Return the size of the given allocation
+  size_t GetAllocationSize(const void *ptr) const;
+
+  //===--------------------------------------------------------------------===//
+  // Compaction
+  //===--------------------------------------------------------------------===//
+
+  // Is the pool fragmented enough to be worth compacting?
+  bool NeedsCompaction() const;
+
+  // Select the sparsely used chunks for evacuation. Returns the number of
+  // chunks selected.
+  size_t BeginCompaction();
+
+  // Is the given allocation in a chunk that is being evacuated?
+  bool IsEvacuating(const void *ptr);
+
+  // Finish the evacuation. Chunks without live allocations are retired with
+  // the given epoch, the others become regular chunks again.
+  void EndCompaction(eid_t epoch_id);
+
+  // Release the chunks that were retired in an epoch that has expired.
+  // Returns the number of chunks released.
+  size_t ReleaseRetiredChunks(eid_t expired_epoch_id);
+
+  //===--------------------------------------------------------------------===//
+  // Statistics
+  //===--------------------------------------------------------------------===//
+
+  // Return the number of bytes currently allocated from this pool
+  size_t GetAllocatedBytes() const { return allocated_bytes_.load(); }
+
+  // Return the number of bytes of all chunks
+  size_t GetReservedBytes() const { return reserved_bytes_.load(); }
+
+  // Return the number of chunks, including the retired ones
+  size_t GetNumChunks();
+
+  // Return the number of retired chunks
+  size_t GetNumRetiredChunks();
+
+ private:
+  // The header preceding every allocation
+  struct AllocationHeader {
+    // The ID of the chunk the allocation lives in
+    uint32_t chunk_id;
+    // The size the client asked for
+    uint32_t size;
+  };
+
+  enum class ChunkState : uint32_t { Active, Evacuating, Retired };
+
+  struct Chunk {
+    // The memory of the chunk
+    std::unique_ptr<char[]> data;
+    // The size of the memory, and the number of bytes handed out
+    size_t size;
+    size_t used;
+    // The number of bytes handed out that have not been freed
+    size_t live;
+    // The state of the chunk, and the epoch it was retired in
+    ChunkState state;
+    eid_t retired_epoch;
+
+    explicit Chunk(size_t _size)
+        : data(new char[_size]),
+          size(_size),
+          used(0),
+          live(0),
+          state(ChunkState::Active),
+          retired_epoch(INVALID_EID) {}
+  };
+
+  // The number of bytes an allocation of the given size takes in a chunk
+  static size_t FootprintOf(size_t size);
+
+  // Look up the chunk of the given allocation. Must hold the latch. Returns
+  // NULL if the allocation doesn't come from this pool.
+  Chunk *LookupChunk(const void *ptr) const;
+
+  // Add a chunk of the given size and return its ID. Must hold the latch.
+  uint32_t AddChunk(size_t size);
+
+  // Release the chunk with the given ID. Must hold the latch.
+  void ReleaseChunk(uint32_t chunk_id);
+
+ private:
+  // All chunks, indexed by their ID. Released chunks leave a hole, whose ID
+  // is reused.
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+  std::vector<uint32_t> free_chunk_ids_;
+
+  // The chunk small allocations are currently carved from
+  uint32_t current_chunk_id_;
+
+  // Total size of all live allocations, and of all chunks
+  std::atomic<size_t> allocated_bytes_;
+  std::atomic<size_t> reserved_bytes_;
+
+  // Spin lock protecting the chunks
+  common::synchronization::SpinLatch pool_lock_;
+};
+
+}  // namespace type
+}  // namespace peloton
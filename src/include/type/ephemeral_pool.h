@@ -12,12 +12,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
-#include <unordered_set>
+#include <unordered_map>
 
 #include "common/macros.h"
 #include "common/synchronization/spin_latch.h"
+#include "storage/backend_manager.h"
 #include "type/abstract_pool.h"
 
 namespace peloton {
@@ -25,7 +27,9 @@ namespace type {
 
 //===----------------------------------------------------------------------===//
 //
-// A memory pool that can quickly allocate chunks of memory to clients.
+// A memory pool that can quickly allocate chunks of memory to clients. Large
+// chunks, such as the directories of hash tables, may come from the reserve
+// of huge pages (see BackendManager::AllocateTransient()).
 //
 //===----------------------------------------------------------------------===//
 class EphemeralPool : public AbstractPool {
@@ -38,9 +42,18 @@ class EphemeralPool : public AbstractPool {
 
   void Free(void *ptr) override;
 
+  // Return the number of bytes currently allocated from this pool
+  size_t GetAllocatedBytes() const { return allocated_bytes_.load(); }
+
+ private:
+  static void FreeChunk(char *location, size_t size);
+
  public:
-  // Location list
-  std::unordered_set<char *> locations_;
+  // Location list, along with the size of each allocation
+  std::unordered_map<char *, size_t> locations_;
+
+  // Total size of all live allocations
+  std::atomic<size_t> allocated_bytes_{0};
 
   // Spin lock protecting location list
   common::synchronization::SpinLatch pool_lock_;
@@ -55,27 +68,48 @@ class EphemeralPool : public AbstractPool {
 inline EphemeralPool::~EphemeralPool() {
   pool_lock_.Lock();
   for (auto location : locations_) {
-    delete[] location;
+    FreeChunk(location.first, location.second);
   }
   pool_lock_.Unlock();
 }
 
+inline void EphemeralPool::FreeChunk(char *location, size_t size) {
+  if (size >= storage::BackendManager::kHugePageThreshold) {
+    storage::BackendManager::GetInstance().ReleaseTransient(location, size);
+  } else {
+    delete[] location;
+  }
+}
+
 inline void *EphemeralPool::Allocate(size_t size) {
-  auto location = new char[size];
+  char *location;
+  if (size >= storage::BackendManager::kHugePageThreshold) {
+    location = reinterpret_cast<char *>(
+        storage::BackendManager::GetInstance().AllocateTransient(size));
+  } else {
+    location = new char[size];
+  }
 
   pool_lock_.Lock();
-  locations_.insert(location);
+  locations_.emplace(location, size);
   pool_lock_.Unlock();
+  allocated_bytes_ += size;
 
   return location;
 }
 
 inline void EphemeralPool::Free(void *ptr) {
   auto *cptr = (char *)ptr;
+  size_t size = 0;
   pool_lock_.Lock();
-  locations_.erase(cptr);
+  auto iter = locations_.find(cptr);
+  if (iter != locations_.end()) {
+    size = iter->second;
+    allocated_bytes_ -= size;
+    locations_.erase(iter);
+  }
   pool_lock_.Unlock();
-  delete[] cptr;
+  FreeChunk(cptr, size);
 }
 
 }  // namespace type
@@ -48,14 +48,25 @@ class File {
 
   void Create(const std::string &name);
 
-  void CreateTemp();
+  // Create an anonymous temporary file in the given directory. The file is
+  // removed from the directory right away, and its space is reclaimed once
+  // it is closed.
+  void CreateTemp(const std::string &directory);
 
   uint64_t Read(void *data, uint64_t len) const;
 
+  // Read from the given offset without moving the file position
+  uint64_t ReadAt(void *data, uint64_t len, uint64_t offset) const;
+
   uint64_t Write(void *data, uint64_t len) const;
 
   uint64_t Size() const;
 
+  // Map the first len bytes of the file into memory, copy-on-write
+  void *Map(uint64_t len) const;
+
+  static void Unmap(void *addr, uint64_t len);
+
   bool IsOpen() const { return fd_ != kInvalid; }
 
   void Close();
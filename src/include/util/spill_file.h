@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// spill_file.h
+//
+// Identification: src/include/util/spill_file.h
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+
+#include "util/file.h"
+
+namespace peloton {
+namespace util {
+
+/**
+ * A SpillFile is an anonymous, append-only temporary file that operators
+ * write their data to once they exceed the memory budget of their query. The
+ * file never shows up in the spill directory and its space is returned to the
+ * file system when the SpillFile is destroyed.
+ *
+ * Data is appended with Append() and read back at the offset Append()
+ * returned. Alternatively, the whole file can be mapped into memory.
+ */
+class SpillFile {
+ public:
+  /**
+   * Create a new, empty spill file in the given directory
+   *
+   * @param directory The directory where the file is created
+   */
+  explicit SpillFile(const std::string &directory);
+
+  /**
+   * Destructor. Unmaps and removes the file.
+   */
+  ~SpillFile();
+
+  /**
+   * Append the given data to the end of the file
+   *
+   * @param data The data to write
+   * @param len The number of bytes to write
+   * @return The offset in the file where the data was written to
+   */
+  uint64_t Append(const void *data, uint64_t len);
+
+  /**
+   * Read data that was previously appended to the file
+   *
+   * @param offset The offset in the file to read from
+   * @param data Where the data is copied to
+   * @param len The number of bytes to read
+   */
+  void Read(uint64_t offset, void *data, uint64_t len) const;
+
+  /**
+   * Map the contents of the file into memory. The mapping is private, changes
+   * are not written back. It stays valid until the file is destroyed and must
+   * not be used after further appends.
+   *
+   * @return A pointer to the contents of the file
+   */
+  char *Map();
+
+  /** Return the number of bytes written to this file */
+  uint64_t Size() const { return size_; }
+
+ private:
+  // The underlying file
+  File file_;
+
+  // The number of bytes written so far
+  uint64_t size_;
+
+  // The mapping of the file contents, if any
+  char *mapping_;
+  uint64_t mapping_size_;
+
+ private:
+  DISALLOW_COPY_AND_MOVE(SpillFile);
+};
+
+}  // namespace util
+}  // namespace peloton
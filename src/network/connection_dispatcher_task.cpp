@@ -12,20 +12,43 @@
 
 #include "network/connection_dispatcher_task.h"
 
+#include "settings/settings_manager.h"
+
 #define MASTER_THREAD_ID (-1)
 
+// A handler is overloaded if its load is more than this factor times the load
+// of the coldest handler
+#define REBALANCE_LOAD_FACTOR 2
+
+// Handlers below this many requests per interval are never rebalanced, moving
+// connections around costs more than it saves
+#define REBALANCE_MIN_LOAD 64
+
 namespace peloton {
 namespace network {
 
 ConnectionDispatcherTask::ConnectionDispatcherTask(int num_handlers,
                                                    int listen_fd)
-    : NotifiableTask(MASTER_THREAD_ID), next_handler_(0) {
+    : NotifiableTask(MASTER_THREAD_ID),
+      handler_loads_(num_handlers, 0),
+      next_handler_(0) {
   RegisterEvent(
       listen_fd, EV_READ | EV_PERSIST,
       METHOD_AS_CALLBACK(ConnectionDispatcherTask, DispatchConnection), this);
   RegisterSignalEvent(SIGHUP, METHOD_AS_CALLBACK(NotifiableTask, ExitLoop),
                       this);
 
+  auto rebalance_interval = settings::SettingsManager::GetInt(
+      settings::SettingId::connection_rebalance_interval);
+  if (rebalance_interval > 0 && num_handlers > 1) {
+    struct timeval interval = {rebalance_interval / 1000,
+                               (rebalance_interval % 1000) * 1000};
+    RegisterPeriodicEvent(
+        &interval,
+        METHOD_AS_CALLBACK(ConnectionDispatcherTask, RebalanceConnections),
+        this);
+  }
+
   // TODO(tianyu) Figure out what this initialization logic is doing and
   // potentially rewrite
   // register thread to epoch manager.
@@ -51,20 +74,86 @@ void ConnectionDispatcherTask::DispatchConnection(int fd, short) {
   int new_conn_fd = accept(fd, (struct sockaddr *)&addr, &addrlen);
   if (new_conn_fd == -1) {
     LOG_ERROR("Failed to accept");
+    return;
   }
 
-  // Dispatch by rand number
-  int handler_id = next_handler_;
+  std::vector<size_t> connection_counts;
+  connection_counts.reserve(handlers_.size());
+  for (auto &handler : handlers_) {
+    connection_counts.push_back(handler->GetConnectionCount());
+  }
+  size_t handler_id =
+      ChooseHandler(handler_loads_, connection_counts, next_handler_);
 
   // update next threadID
-  next_handler_ = (next_handler_ + 1) % handlers_.size();
+  next_handler_ = (handler_id + 1) % handlers_.size();
 
   std::shared_ptr<ConnectionHandlerTask> handler = handlers_[handler_id];
-  LOG_DEBUG("Dispatching connection to worker %d", handler_id);
+  LOG_DEBUG("Dispatching connection to worker %lu", handler_id);
 
+  // Count the connection right away, so that a burst of connections does not
+  // all land on the same handler
+  handler->ConnectionOpened();
   handler->Notify(new_conn_fd);
 }
 
+void ConnectionDispatcherTask::RebalanceConnections(int, short) {
+  std::vector<size_t> connection_counts;
+  connection_counts.reserve(handlers_.size());
+  for (size_t i = 0; i < handlers_.size(); i++) {
+    handler_loads_[i] = handlers_[i]->ResetLoad();
+    connection_counts.push_back(handlers_[i]->GetConnectionCount());
+  }
+
+  size_t from, to;
+  if (ChooseRebalance(handler_loads_, connection_counts, from, to)) {
+    LOG_DEBUG("Migrating a connection from worker %lu (load %lu) to %lu "
+              "(load %lu)",
+              from, handler_loads_[from], to, handler_loads_[to]);
+    handlers_[from]->RequestMigration(handlers_[to].get());
+  }
+}
+
+size_t ConnectionDispatcherTask::ChooseHandler(
+    const std::vector<uint64_t> &loads,
+    const std::vector<size_t> &connection_counts, size_t start) {
+  PELOTON_ASSERT(loads.size() == connection_counts.size());
+  size_t num_handlers = loads.size();
+  size_t best = start % num_handlers;
+  uint64_t best_score = loads[best] + connection_counts[best];
+  for (size_t i = 1; i < num_handlers; i++) {
+    size_t candidate = (start + i) % num_handlers;
+    uint64_t score = loads[candidate] + connection_counts[candidate];
+    if (score < best_score) {
+      best = candidate;
+      best_score = score;
+    }
+  }
+  return best;
+}
+
+bool ConnectionDispatcherTask::ChooseRebalance(
+    const std::vector<uint64_t> &loads,
+    const std::vector<size_t> &connection_counts, size_t &from, size_t &to) {
+  PELOTON_ASSERT(loads.size() == connection_counts.size());
+  if (loads.size() < 2) return false;
+
+  size_t hottest = 0, coldest = 0;
+  for (size_t i = 1; i < loads.size(); i++) {
+    if (loads[i] > loads[hottest]) hottest = i;
+    if (loads[i] < loads[coldest]) coldest = i;
+  }
+
+  // Moving the only connection of a handler just moves the hot spot
+  if (connection_counts[hottest] < 2) return false;
+  if (loads[hottest] < REBALANCE_MIN_LOAD) return false;
+  if (loads[hottest] <= REBALANCE_LOAD_FACTOR * loads[coldest]) return false;
+
+  from = hottest;
+  to = coldest;
+  return true;
+}
+
 void ConnectionDispatcherTask::ExitLoop() {
   NotifiableTask::ExitLoop();
   for (auto &handler : handlers_) handler->ExitLoop();
@@ -111,7 +111,7 @@ DEF_TRANSITION_GRAPH
     DEFINE_STATE(READ)
         ON(WAKEUP) SET_STATE_TO(READ) AND_INVOKE(TryRead)
         ON(PROCEED) SET_STATE_TO(PROCESS) AND_INVOKE(Process)
-        ON(NEED_READ) SET_STATE_TO(READ) AND_WAIT_ON_READ
+        ON(NEED_READ) SET_STATE_TO(READ) AND_INVOKE(WaitForRequest)
           // This case happens only when we use SSL and are blocked on a write
           // during handshake. From peloton's perspective we are still waiting
           // for reads.
@@ -171,6 +171,41 @@ ConnectionHandle::ConnectionHandle(int sock_fd, ConnectionHandlerTask *handler)
     : conn_handler_(handler),
       io_wrapper_(NetworkIoWrapperFactory::GetInstance().NewNetworkIoWrapper(sock_fd)) {}
 
+Transition ConnectionHandle::WaitForRequest() {
+  // The client has nothing more to say for now, which makes this the one
+  // point where the connection can safely change threads
+  if (TryMigrate()) return Transition::NONE;
+  UpdateEventFlags(EV_READ | EV_PERSIST);
+  return Transition::NONE;
+}
+
+bool ConnectionHandle::TryMigrate() {
+  ConnectionHandlerTask *target = conn_handler_->TakeMigrationTarget();
+  if (target == nullptr) return false;
+  // SSL may hold decrypted bytes that we cannot see, and an open transaction
+  // is registered with the epoch of the current thread
+  if (target == conn_handler_ || io_wrapper_->SslAble() ||
+      io_wrapper_->rbuf_->HasMore() || HasResponse() ||
+      tcop_.IsInTransaction()) {
+    // Let another connection of this handler serve the request
+    conn_handler_->RestoreMigrationTarget(target);
+    return false;
+  }
+
+  LOG_DEBUG("Migrating connection %d from worker %d to %d",
+            io_wrapper_->GetSocketFd(), conn_handler_->Id(), target->Id());
+  conn_handler_->UnregisterEvent(network_event_);
+  conn_handler_->UnregisterEvent(workpool_event_);
+  network_event_ = nullptr;
+  workpool_event_ = nullptr;
+  conn_handler_->ConnectionClosed();
+  target->ConnectionOpened();
+  conn_handler_ = target;
+  // From here on the target thread owns this object
+  target->NotifyMigration(this);
+  return true;
+}
+
 Transition ConnectionHandle::TryWrite() {
   for (; next_response_ < protocol_handler_->responses_.size();
        next_response_++) {
@@ -194,6 +229,7 @@ Transition ConnectionHandle::Process() {
     protocol_handler_ = ProtocolHandlerFactory::CreateProtocolHandler(
         ProtocolHandlerType::Postgres, &tcop_);
 
+  conn_handler_->AddLoad(1);
   ProcessResult status = protocol_handler_->Process(
       *(io_wrapper_->rbuf_), (size_t)conn_handler_->Id());
 
@@ -242,6 +278,7 @@ Transition ConnectionHandle::TryCloseConnection() {
   // connection handle and we will need to destruct and exit.
   conn_handler_->UnregisterEvent(network_event_);
   conn_handler_->UnregisterEvent(workpool_event_);
+  conn_handler_->ConnectionClosed();
   // This object is essentially managed by libevent (which unfortunately does
   // not accept shared_ptrs.) and thus as we shut down we need to manually
   // deallocate this object.
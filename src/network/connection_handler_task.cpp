@@ -31,36 +31,55 @@ ConnectionHandlerTask::ConnectionHandlerTask(const int task_id)
 }
 
 void ConnectionHandlerTask::Notify(int conn_fd) {
-  int buf[1];
-  buf[0] = conn_fd;
-  if (write(new_conn_send_fd_, buf, sizeof(int)) != sizeof(int)) {
+  SendDispatchMessage({conn_fd, nullptr});
+}
+
+void ConnectionHandlerTask::NotifyMigration(ConnectionHandle *conn) {
+  SendDispatchMessage({-1, conn});
+}
+
+void ConnectionHandlerTask::SendDispatchMessage(
+    const DispatchMessage &message) {
+  // Messages are smaller than PIPE_BUF, so the write is atomic even with
+  // several threads notifying the same handler
+  if (write(new_conn_send_fd_, &message, sizeof(message)) !=
+      sizeof(message)) {
     LOG_ERROR("Failed to write to thread notify pipe");
   }
 }
 
 void ConnectionHandlerTask::HandleDispatch(int new_conn_recv_fd, short) {
   // buffer used to receive messages from the main thread
-  char client_fd[sizeof(int)];
+  char buf[sizeof(DispatchMessage)];
   size_t bytes_read = 0;
 
   // read fully
-  while (bytes_read < sizeof(int)) {
-    ssize_t result = read(new_conn_recv_fd, client_fd + bytes_read,
-                          sizeof(int) - bytes_read);
+  while (bytes_read < sizeof(DispatchMessage)) {
+    ssize_t result = read(new_conn_recv_fd, buf + bytes_read,
+                          sizeof(DispatchMessage) - bytes_read);
     if (result < 0) {
+      if (errno == EINTR) continue;
       LOG_ERROR("Error when reading from dispatch");
+      return;
     }
     bytes_read += (size_t)result;
   }
+  auto message = reinterpret_cast<DispatchMessage *>(buf);
+
+  if (message->conn != nullptr) {
+    // A migrated connection already points to this handler, it only needs
+    // its events registered with our event base
+    message->conn->RegisterToReceiveEvents();
+    return;
+  }
 
   // Smart pointers are not used here because libevent does not take smart
   // pointers. During the life time of this object, the pointer to it will be
   // maintained by libevent rather than by our own code. The object will have to
   // be cleaned up by one of its methods (i.e. we call a method with "delete
   // this" and have the object commit suicide from libevent. )
-  (new ConnectionHandle(*reinterpret_cast<int *>(client_fd), this))
-      ->RegisterToReceiveEvents();
+  (new ConnectionHandle(message->conn_fd, this))->RegisterToReceiveEvents();
 }
 
 }  // namespace network
-}  // namespace peloton
\ No newline at end of file
+}  // namespace peloton
@@ -162,5 +162,108 @@ void PacketPutCbytes(OutputPacket *pkt, const uchar *b, int len) {
   pkt->len += len;
 }
 
+OutputChunkBuffer::Chunk &OutputChunkBuffer::Reserve(size_t bytes) {
+  PELOTON_ASSERT(bytes <= chunk_size_);
+  if (chunks_.empty() ||
+      chunks_.back().size + bytes > chunks_.back().capacity) {
+    size_t capacity = std::max(bytes, next_chunk_size_);
+    next_chunk_size_ = std::min(next_chunk_size_ * 2, chunk_size_);
+    chunks_.push_back(
+        {std::unique_ptr<uchar[]>(new uchar[capacity]), 0, capacity});
+  }
+  return chunks_.back();
+}
+
+void OutputChunkBuffer::BeginMessage(NetworkMessageType type) {
+  PELOTON_ASSERT(msg_len_field_ == nullptr);
+  // The header is kept contiguous so that the length can be patched in place
+  auto &chunk = Reserve(1 + sizeof(int32_t));
+  chunk.data[chunk.size] = static_cast<uchar>(type);
+  msg_len_field_ = &chunk.data[chunk.size + 1];
+  chunk.size += 1 + sizeof(int32_t);
+  total_size_ += 1 + sizeof(int32_t);
+  msg_len_ = sizeof(int32_t);
+}
+
+void OutputChunkBuffer::EndMessage() {
+  PELOTON_ASSERT(msg_len_field_ != nullptr);
+  uint32_t len = htonl(static_cast<uint32_t>(msg_len_));
+  PELOTON_MEMCPY(msg_len_field_, &len, sizeof(len));
+  msg_len_field_ = nullptr;
+}
+
+void OutputChunkBuffer::AppendInt(int n, int base) {
+  switch (base) {
+    case 2: {
+      uint16_t value = htons(static_cast<uint16_t>(n));
+      AppendBytes(&value, sizeof(value));
+      break;
+    }
+    case 4: {
+      uint32_t value = htonl(static_cast<uint32_t>(n));
+      AppendBytes(&value, sizeof(value));
+      break;
+    }
+    default:
+      LOG_ERROR("Parsing error: Invalid base for int");
+      exit(EXIT_FAILURE);
+  }
+}
+
+void OutputChunkBuffer::AppendBytes(const void *data, size_t len) {
+  auto src = reinterpret_cast<const uchar *>(data);
+  total_size_ += len;
+  msg_len_ += len;
+  while (len > 0) {
+    if (chunks_.empty() || chunks_.back().size == chunks_.back().capacity) {
+      Reserve(1);
+    }
+    auto &chunk = chunks_.back();
+    size_t copy_len = std::min(len, chunk.capacity - chunk.size);
+    PELOTON_MEMCPY(&chunk.data[chunk.size], src, copy_len);
+    chunk.size += copy_len;
+    src += copy_len;
+    len -= copy_len;
+  }
+}
+
+size_t OutputChunkBuffer::GetIovecs(struct iovec *iov, size_t max_iov) {
+  size_t count = 0;
+  size_t offset = head_offset_;
+  for (size_t i = head_chunk_; i < chunks_.size() && count < max_iov; i++) {
+    auto &chunk = chunks_[i];
+    if (chunk.size > offset) {
+      iov[count].iov_base = &chunk.data[offset];
+      iov[count].iov_len = chunk.size - offset;
+      count++;
+    }
+    offset = 0;
+  }
+  return count;
+}
+
+void OutputChunkBuffer::Consume(size_t bytes) {
+  PELOTON_ASSERT(bytes <= Size());
+  consumed_size_ += bytes;
+  while (bytes > 0) {
+    auto &chunk = chunks_[head_chunk_];
+    size_t available = chunk.size - head_offset_;
+    if (bytes < available) {
+      head_offset_ += bytes;
+      return;
+    }
+    bytes -= available;
+    // Written out chunks are released early, a large result set does not
+    // have to stay in memory until the last byte is sent
+    if (head_chunk_ + 1 < chunks_.size()) {
+      chunk.data.reset();
+      head_chunk_++;
+      head_offset_ = 0;
+    } else {
+      head_offset_ = chunk.size;
+    }
+  }
+}
+
 }  // namespace network
 }  // namespace peloton
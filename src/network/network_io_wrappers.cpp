@@ -15,16 +15,19 @@
 #include <netinet/tcp.h>
 #include <openssl/err.h>
 #include <sys/file.h>
+#include <sys/uio.h>
 #include "network/peloton_server.h"
 
 namespace peloton {
 namespace network {
 Transition NetworkIoWrapper::WritePacket(OutputPacket *pkt) {
+  if (pkt->chunks != nullptr) return WriteChunks(pkt->chunks);
+
   // Write Packet Header
   if (!pkt->skip_header_write) {
     if (!wbuf_->HasSpaceFor(1 + sizeof(int32_t))) {
       auto result = FlushWriteBuffer();
-      if (FlushWriteBuffer() != Transition::PROCEED)
+      if (result != Transition::PROCEED)
         // Unable to flush buffer, socket presumably not ready for write
         return result;
     }
@@ -47,10 +50,29 @@ Transition NetworkIoWrapper::WritePacket(OutputPacket *pkt) {
       len -= write_size;
       pkt->write_ptr += write_size;
       auto result = FlushWriteBuffer();
-      if (FlushWriteBuffer() != Transition::PROCEED)
+      if (result != Transition::PROCEED)
+        // Unable to flush buffer, socket presumably not ready for write
+        return result;
+    }
+  }
+  return Transition::PROCEED;
+}
+
+Transition NetworkIoWrapper::WriteChunks(
+    std::unique_ptr<OutputChunkBuffer> &chunk_buffer) {
+  auto &chunks = *chunk_buffer;
+  while (!chunks.Empty()) {
+    if (wbuf_->RemainingCapacity() == 0) {
+      auto result = FlushWriteBuffer();
+      if (result != Transition::PROCEED)
         // Unable to flush buffer, socket presumably not ready for write
         return result;
     }
+    struct iovec iov;
+    chunks.GetIovecs(&iov, 1);
+    auto len = std::min(iov.iov_len, wbuf_->RemainingCapacity());
+    wbuf_->Append(reinterpret_cast<uchar *>(iov.iov_base), len);
+    chunks.Consume(len);
   }
   return Transition::PROCEED;
 }
@@ -76,10 +98,14 @@ Transition PosixSocketIoWrapper::FillReadBuffer() {
   Transition result = Transition::NEED_READ;
   // Normal mode
   while (!rbuf_->Full()) {
+    auto requested = rbuf_->Capacity() - rbuf_->size_;
     auto bytes_read = rbuf_->FillBufferFrom(sock_fd_);
-    if (bytes_read > 0)
+    if (bytes_read > 0) {
       result = Transition::PROCEED;
-    else if (bytes_read == 0)
+      // A short read means the socket is drained. The event loop is level
+      // triggered, so skip the extra read() that would only hit EAGAIN.
+      if ((size_t)bytes_read < requested) return result;
+    } else if (bytes_read == 0)
       return Transition::TERMINATE;
     else
       switch (errno) {
@@ -98,6 +124,57 @@ Transition PosixSocketIoWrapper::FillReadBuffer() {
 }
 
 Transition PosixSocketIoWrapper::FlushWriteBuffer() {
+  // The bytes of the write buffer up to pending_chunks_offset_ precede the
+  // pending chunks, the rest follow them
+  while (pending_chunks_ != nullptr) {
+    struct iovec iov[OUTPUT_MAX_IOVECS];
+    size_t iov_count = 0;
+    size_t head_len = 0;
+    if (wbuf_->offset_ < pending_chunks_offset_) {
+      head_len = pending_chunks_offset_ - wbuf_->offset_;
+      iov[iov_count].iov_base = &wbuf_->buf_[wbuf_->offset_];
+      iov[iov_count].iov_len = head_len;
+      iov_count++;
+    }
+    size_t chunks_count = pending_chunks_->GetIovecs(
+        iov + iov_count, OUTPUT_MAX_IOVECS - 1 - iov_count);
+    size_t chunks_len = 0;
+    for (size_t i = iov_count; i < iov_count + chunks_count; i++) {
+      chunks_len += iov[i].iov_len;
+    }
+    iov_count += chunks_count;
+    // The tail can only follow once all of the chunks are described
+    size_t tail_offset = std::max(wbuf_->offset_, pending_chunks_offset_);
+    if (chunks_len == pending_chunks_->Size() && tail_offset < wbuf_->size_) {
+      iov[iov_count].iov_base = &wbuf_->buf_[tail_offset];
+      iov[iov_count].iov_len = wbuf_->size_ - tail_offset;
+      iov_count++;
+    }
+
+    ssize_t bytes_written = writev(sock_fd_, iov, (int)iov_count);
+    if (bytes_written < 0) switch (errno) {
+        case EINTR:
+          continue;
+        case EAGAIN:
+          return Transition::NEED_WRITE;
+        default:
+          LOG_ERROR("Error writing: %s", strerror(errno));
+          throw NetworkProcessException("Fatal error during write");
+      }
+
+    size_t written = (size_t)bytes_written;
+    size_t from_head = std::min(written, head_len);
+    wbuf_->offset_ += from_head;
+    written -= from_head;
+    size_t from_chunks = std::min(written, chunks_len);
+    pending_chunks_->Consume(from_chunks);
+    written -= from_chunks;
+    if (pending_chunks_->Empty()) {
+      pending_chunks_.reset();
+      wbuf_->offset_ = tail_offset + written;
+    }
+  }
+
   while (wbuf_->HasMore()) {
     auto bytes_written = wbuf_->WriteOutTo(sock_fd_);
     if (bytes_written < 0) switch (errno) {
@@ -114,6 +191,22 @@ Transition PosixSocketIoWrapper::FlushWriteBuffer() {
   return Transition::PROCEED;
 }
 
+Transition PosixSocketIoWrapper::WriteChunks(
+    std::unique_ptr<OutputChunkBuffer> &chunks) {
+  // Small batches are cheaper to copy than to send on their own
+  if (chunks->Size() < OUTPUT_WRITEV_THRESHOLD)
+    return NetworkIoWrapper::WriteChunks(chunks);
+
+  // Only one batch can wait for the flush at a time
+  if (pending_chunks_ != nullptr) {
+    auto result = FlushWriteBuffer();
+    if (result != Transition::PROCEED) return result;
+  }
+  pending_chunks_ = std::move(chunks);
+  pending_chunks_offset_ = wbuf_->size_;
+  return Transition::PROCEED;
+}
+
 Transition SslSocketIoWrapper::FillReadBuffer() {
   if (!rbuf_->HasMore()) rbuf_->Reset();
   if (rbuf_->HasMore() && rbuf_->Full()) rbuf_->MoveContentToHead();
@@ -356,11 +356,20 @@ void PostgresProtocolHandler::ExecParseMessage(InputPacket *pkt) {
     return;
   }
 
+  // Read number of params
+  int num_params = PacketGetInt(pkt, 2);
+
+  // Read param types. They are part of the plan cache key, so they have to be
+  // known before the statement is prepared.
+  std::vector<int32_t> param_types(num_params);
+  auto type_buf_begin = pkt->Begin() + pkt->ptr;
+  auto type_buf_len = ReadParamType(pkt, num_params, param_types);
+
   // Prepare statement
   std::shared_ptr<Statement> statement(nullptr);
 
-  statement = traffic_cop_->PrepareStatement(statement_name, query,
-                                             std::move(sql_stmt_list));
+  statement = traffic_cop_->PrepareStatement(
+      statement_name, query, std::move(sql_stmt_list), param_types);
   if (statement.get() == nullptr) {
     traffic_cop_->ProcessInvalidStatement();
     skipped_stmt_ = true;
@@ -370,13 +379,6 @@ void PostgresProtocolHandler::ExecParseMessage(InputPacket *pkt) {
   }
   LOG_TRACE("PrepareStatement[%s] => %s", statement_name.c_str(),
             query.c_str());
-  // Read number of params
-  int num_params = PacketGetInt(pkt, 2);
-
-  // Read param types
-  std::vector<int32_t> param_types(num_params);
-  auto type_buf_begin = pkt->Begin() + pkt->ptr;
-  auto type_buf_len = ReadParamType(pkt, num_params, param_types);
 
   // Cache the received query
   bool unnamed_query = statement_name.empty();
@@ -523,6 +525,8 @@ void PostgresProtocolHandler::ExecBindMessage(InputPacket *pkt) {
   }
 
   if (param_values.size() > 0) {
+    // Pick the plan suited to the selectivity of these values
+    traffic_cop_->SelectPlanForParams(statement, param_values);
     statement->GetPlanTree()->SetParameterValues(&param_values);
     // Instead of tree traversal, we should put param values in the
     // executor context.
@@ -1153,27 +1157,32 @@ void PostgresProtocolHandler::SendDataRows(std::vector<ResultValue> &results,
   if (results.empty() || colcount == 0) return;
 
   size_t numrows = results.size() / colcount;
+  if (numrows == 0) return;
 
-  // 1 packet per row
+  // All the rows are serialized in place into one chunked packet, which
+  // the io wrapper can hand to writev without copying it again
+  std::unique_ptr<OutputPacket> pkt(new OutputPacket());
+  pkt->chunks.reset(new OutputChunkBuffer());
+  auto &chunks = *pkt->chunks;
   for (size_t i = 0; i < numrows; i++) {
-    std::unique_ptr<OutputPacket> pkt(new OutputPacket());
-    pkt->msg_type = NetworkMessageType::DATA_ROW;
-    PacketPutInt(pkt.get(), colcount, 2);
+    chunks.BeginMessage(NetworkMessageType::DATA_ROW);
+    chunks.AppendInt(colcount, 2);
     for (int j = 0; j < colcount; j++) {
-      auto content = results[i * colcount + j];
+      const auto &content = results[i * colcount + j];
       if (content.size() == 0) {
         // content is NULL
-        PacketPutInt(pkt.get(), NULL_CONTENT_SIZE, 4);
+        chunks.AppendInt(NULL_CONTENT_SIZE, 4);
         // no value bytes follow
       } else {
         // length of the row attribute
-        PacketPutInt(pkt.get(), content.size(), 4);
+        chunks.AppendInt(content.size(), 4);
         // contents of the row attribute
-        PacketPutString(pkt.get(), content);
+        chunks.AppendBytes(content.data(), content.size());
       }
     }
-    responses_.push_back(std::move(pkt));
+    chunks.EndMessage();
   }
+  responses_.push_back(std::move(pkt));
   traffic_cop_->setRowsAffected(numrows);
 }
 
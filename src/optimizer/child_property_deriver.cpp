@@ -169,6 +169,13 @@ void ChildPropertyDeriver::Visit(const PhysicalInnerHashJoin *) {
 void ChildPropertyDeriver::Visit(const PhysicalLeftHashJoin *) {}
 void ChildPropertyDeriver::Visit(const PhysicalRightHashJoin *) {}
 void ChildPropertyDeriver::Visit(const PhysicalOuterHashJoin *) {}
+void ChildPropertyDeriver::Visit(const PhysicalSemiHashJoin *) {
+  // The output comes from a scan of the hash table after the probe, so no
+  // order of the children survives the join
+  output_.push_back(make_pair(
+      make_shared<PropertySet>(),
+      vector<shared_ptr<PropertySet>>(2, make_shared<PropertySet>())));
+}
 void ChildPropertyDeriver::Visit(const PhysicalInsert *) {
   vector<shared_ptr<PropertySet>> child_input_properties;
 
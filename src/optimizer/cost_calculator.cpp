@@ -20,6 +20,7 @@
 #include "optimizer/stats/cost.h"
 #include "optimizer/stats/stats_storage.h"
 #include "optimizer/stats/table_stats.h"
+#include "settings/settings_manager.h"
 
 namespace peloton {
 namespace optimizer {
@@ -94,11 +95,22 @@ void CostCalculator::Visit(UNUSED_ATTRIBUTE const PhysicalInnerHashJoin *op) {
   auto right_child_rows =
       memo_->GetGroupByID(gexpr_->GetChildGroupId(1))->GetNumRows();
   // TODO(boweic): Build (left) table should have different cost to probe table
-  output_cost_ = (left_child_rows + right_child_rows) * DEFAULT_TUPLE_COST;
+  output_cost_ = HashJoinCost(
+      left_child_rows, right_child_rows,
+      UsePartitionedHashJoin(left_child_rows, right_child_rows));
 }
 void CostCalculator::Visit(UNUSED_ATTRIBUTE const PhysicalLeftHashJoin *op) {}
 void CostCalculator::Visit(UNUSED_ATTRIBUTE const PhysicalRightHashJoin *op) {}
 void CostCalculator::Visit(UNUSED_ATTRIBUTE const PhysicalOuterHashJoin *op) {}
+void CostCalculator::Visit(UNUSED_ATTRIBUTE const PhysicalSemiHashJoin *op) {
+  auto left_child_rows =
+      memo_->GetGroupByID(gexpr_->GetChildGroupId(0))->GetNumRows();
+  auto right_child_rows =
+      memo_->GetGroupByID(gexpr_->GetChildGroupId(1))->GetNumRows();
+  output_cost_ = HashJoinCost(
+      left_child_rows, right_child_rows,
+      UsePartitionedHashJoin(left_child_rows, right_child_rows));
+}
 void CostCalculator::Visit(UNUSED_ATTRIBUTE const PhysicalInsert *op) {}
 void CostCalculator::Visit(UNUSED_ATTRIBUTE const PhysicalInsertSelect *op) {}
 void CostCalculator::Visit(UNUSED_ATTRIBUTE const PhysicalDelete *op) {}
@@ -141,6 +153,36 @@ double CostCalculator::SortCost() {
   return child_num_rows * std::log2(child_num_rows) * DEFAULT_TUPLE_COST;
 }
 
+double CostCalculator::HashJoinCost(double build_rows, double probe_rows,
+                                    bool partitioned) {
+  double num_rows = build_rows + probe_rows;
+  if (partitioned) {
+    // Every row is scattered once, after which all hash table accesses hit
+    // the cache
+    return num_rows * (DEFAULT_TUPLE_COST + DEFAULT_PARTITION_TUPLE_COST);
+  }
+  // O(tuple), plus a cache miss for the fraction of the hash table that
+  // doesn't fit into the cache
+  double table_size = build_rows * DEFAULT_HASH_ENTRY_SIZE;
+  double miss_rate =
+      table_size > DEFAULT_CACHE_SIZE ? 1.0 - DEFAULT_CACHE_SIZE / table_size
+                                      : 0.0;
+  return num_rows * (DEFAULT_TUPLE_COST + miss_rate * DEFAULT_CACHE_MISS_COST);
+}
+
+bool CostCalculator::UsePartitionedHashJoin(double build_rows,
+                                            double probe_rows) {
+  if (!settings::SettingsManager::GetBool(
+          settings::SettingId::hash_join_partitioning)) {
+    return false;
+  }
+  if (build_rows <= 0 || probe_rows < 0) {
+    return false;
+  }
+  return HashJoinCost(build_rows, probe_rows, true) <
+         HashJoinCost(build_rows, probe_rows, false);
+}
+
 double CostCalculator::GroupByCost() {
   auto child_num_rows =
       memo_->GetGroupByID(gexpr_->GetChildGroupId(0))->GetNumRows();
@@ -21,6 +21,7 @@
 #include "common/exception.h"
 
 #include "optimizer/binding.h"
+#include "optimizer/cost_calculator.h"
 #include "optimizer/input_column_deriver.h"
 #include "optimizer/operator_visitor.h"
 #include "optimizer/optimize_context.h"
@@ -37,6 +38,7 @@
 #include "planner/create_function_plan.h"
 #include "planner/create_plan.h"
 #include "planner/drop_plan.h"
+#include "planner/hash_join_plan.h"
 #include "planner/order_by_plan.h"
 #include "planner/populate_index_plan.h"
 #include "planner/projection_plan.h"
@@ -110,6 +112,7 @@ shared_ptr<planner::AbstractPlan> Optimizer::BuildPelotonPlanTree(
   }
 
   metadata_.txn = txn;
+  metadata_.parameter_values = parameter_values_;
   // Generate initial operator tree from query tree
   shared_ptr<GroupExpression> gexpr = InsertQueryTree(parse_tree, txn);
   GroupID root_id = gexpr->GetGroupID();
@@ -342,6 +345,23 @@ unique_ptr<planner::AbstractPlan> Optimizer::ChooseBestPlan(
                                             output_cols, children_plans,
                                             children_expr_map);
 
+  // Pass the estimated number of rows on to the executor, which sizes its data
+  // structures with it
+  if (plan != nullptr && group->GetNumRows() > 0) {
+    plan->SetCardinality(group->GetNumRows());
+  }
+
+  // Partition the inputs of a hash join if its hash table wouldn't fit into
+  // the cache. We only do so if the sizes of both inputs are estimated.
+  if (plan != nullptr && plan->GetPlanNodeType() == PlanNodeType::HASHJOIN) {
+    auto &memo = metadata_.memo;
+    auto build_rows = memo.GetGroupByID(child_groups[0])->GetNumRows();
+    auto probe_rows = memo.GetGroupByID(child_groups[1])->GetNumRows();
+    auto *join_plan = static_cast<planner::HashJoinPlan *>(plan.get());
+    join_plan->SetPartitioned(
+        CostCalculator::UsePartitionedHashJoin(build_rows, probe_rows));
+  }
+
   LOG_TRACE("Finish Choosing best plan for group %d", id);
   return plan;
 }
@@ -254,7 +254,8 @@ void DeriveStats::execute() {
 
   StatsCalculator calculator;
   calculator.CalculateStats(gexpr_, required_cols_, &context_->metadata->memo,
-                            context_->metadata->txn);
+                            context_->metadata->txn,
+                            &context_->metadata->parameter_values);
   gexpr_->SetDerivedStats();
 }
 //===--------------------------------------------------------------------===//
@@ -147,6 +147,10 @@ void PlanGenerator::Visit(const ExternalFileScan *op) {
                                    op->delimiter, op->quote, op->escape));
       break;
     }
+    case ExternalFileFormat::ARROW: {
+      throw NotImplementedException(
+          "COPY FROM does not read files in the Arrow format");
+    }
   }
 }
 
@@ -288,50 +292,8 @@ void PlanGenerator::Visit(const PhysicalRightNLJoin *) {}
 void PlanGenerator::Visit(const PhysicalOuterNLJoin *) {}
 
 void PlanGenerator::Visit(const PhysicalInnerHashJoin *op) {
-  std::unique_ptr<const planner::ProjectInfo> proj_info;
-  std::shared_ptr<const catalog::Schema> proj_schema;
-  GenerateProjectionForJoin(proj_info, proj_schema);
-
-  auto join_predicate =
-      expression::ExpressionUtil::JoinAnnotatedExprs(op->join_predicates);
-  expression::ExpressionUtil::EvaluateExpression(children_expr_map_,
-                                                 join_predicate.get());
-  expression::ExpressionUtil::ConvertToTvExpr(join_predicate.get(),
-                                              children_expr_map_);
-
-  vector<unique_ptr<const expression::AbstractExpression>> left_keys;
-  vector<unique_ptr<const expression::AbstractExpression>> right_keys;
-  vector<ExprMap> l_child_map{move(children_expr_map_[0])};
-  vector<ExprMap> r_child_map{move(children_expr_map_[1])};
-  for (auto &expr : op->left_keys) {
-    auto left_key = expr->Copy();
-    expression::ExpressionUtil::EvaluateExpression(l_child_map, left_key);
-    left_keys.emplace_back(left_key);
-  }
-  for (auto &expr : op->right_keys) {
-    auto right_key = expr->Copy();
-    expression::ExpressionUtil::EvaluateExpression(r_child_map, right_key);
-    right_keys.emplace_back(right_key);
-  }
-  // Evaluate Expr for hash plan
-  vector<unique_ptr<const expression::AbstractExpression>> hash_keys;
-  for (auto &expr : op->right_keys) {
-    auto hash_key = expr->Copy();
-    expression::ExpressionUtil::EvaluateExpression(r_child_map, hash_key);
-    hash_keys.emplace_back(hash_key);
-  }
-
-  unique_ptr<planner::HashPlan> hash_plan(new planner::HashPlan(hash_keys));
-  hash_plan->AddChild(move(children_plans_[1]));
-
-  auto join_plan = unique_ptr<planner::AbstractPlan>(new planner::HashJoinPlan(
-      JoinType::INNER, move(join_predicate), move(proj_info), proj_schema,
-      left_keys, right_keys, settings::SettingsManager::GetBool(
-                                 settings::SettingId::hash_join_bloom_filter)));
-
-  join_plan->AddChild(move(children_plans_[0]));
-  join_plan->AddChild(move(hash_plan));
-  output_plan_ = move(join_plan);
+  BuildHashJoinPlan(JoinType::INNER, op->join_predicates, op->left_keys,
+                    op->right_keys);
 }
 
 void PlanGenerator::Visit(const PhysicalLeftHashJoin *) {}
@@ -340,6 +302,11 @@ void PlanGenerator::Visit(const PhysicalRightHashJoin *) {}
 
 void PlanGenerator::Visit(const PhysicalOuterHashJoin *) {}
 
+void PlanGenerator::Visit(const PhysicalSemiHashJoin *op) {
+  BuildHashJoinPlan(op->join_type, op->join_predicates, op->left_keys,
+                    op->right_keys);
+}
+
 void PlanGenerator::Visit(const PhysicalInsert *op) {
   unique_ptr<planner::AbstractPlan> insert_plan(new planner::InsertPlan(
       storage::StorageManager::GetInstance()->GetTableWithOid(
@@ -414,8 +381,9 @@ void PlanGenerator::Visit(const PhysicalUpdate *op) {
 
 void PlanGenerator::Visit(const PhysicalExportExternalFile *op) {
   unique_ptr<planner::AbstractPlan> export_plan{
-      new planner::ExportExternalFilePlan(op->file_name, op->delimiter,
-                                          op->quote, op->escape)};
+      new planner::ExportExternalFilePlan(op->file_name, op->format,
+                                          op->delimiter, op->quote,
+                                          op->escape)};
   export_plan->AddChild(move(children_plans_[0]));
   output_plan_ = move(export_plan);
 }
@@ -599,6 +567,58 @@ void PlanGenerator::BuildAggregatePlan(
   output_plan_.reset(agg_plan);
 }
 
+void PlanGenerator::BuildHashJoinPlan(
+    JoinType join_type, const std::vector<AnnotatedExpression> &join_predicates,
+    const std::vector<std::unique_ptr<expression::AbstractExpression>>
+        &join_left_keys,
+    const std::vector<std::unique_ptr<expression::AbstractExpression>>
+        &join_right_keys) {
+  std::unique_ptr<const planner::ProjectInfo> proj_info;
+  std::shared_ptr<const catalog::Schema> proj_schema;
+  GenerateProjectionForJoin(proj_info, proj_schema);
+
+  auto join_predicate =
+      expression::ExpressionUtil::JoinAnnotatedExprs(join_predicates);
+  expression::ExpressionUtil::EvaluateExpression(children_expr_map_,
+                                                 join_predicate.get());
+  expression::ExpressionUtil::ConvertToTvExpr(join_predicate.get(),
+                                              children_expr_map_);
+
+  vector<unique_ptr<const expression::AbstractExpression>> left_keys;
+  vector<unique_ptr<const expression::AbstractExpression>> right_keys;
+  vector<ExprMap> l_child_map{move(children_expr_map_[0])};
+  vector<ExprMap> r_child_map{move(children_expr_map_[1])};
+  for (auto &expr : join_left_keys) {
+    auto left_key = expr->Copy();
+    expression::ExpressionUtil::EvaluateExpression(l_child_map, left_key);
+    left_keys.emplace_back(left_key);
+  }
+  for (auto &expr : join_right_keys) {
+    auto right_key = expr->Copy();
+    expression::ExpressionUtil::EvaluateExpression(r_child_map, right_key);
+    right_keys.emplace_back(right_key);
+  }
+  // Evaluate Expr for hash plan
+  vector<unique_ptr<const expression::AbstractExpression>> hash_keys;
+  for (auto &expr : join_right_keys) {
+    auto hash_key = expr->Copy();
+    expression::ExpressionUtil::EvaluateExpression(r_child_map, hash_key);
+    hash_keys.emplace_back(hash_key);
+  }
+
+  unique_ptr<planner::HashPlan> hash_plan(new planner::HashPlan(hash_keys));
+  hash_plan->AddChild(move(children_plans_[1]));
+
+  auto join_plan = unique_ptr<planner::AbstractPlan>(new planner::HashJoinPlan(
+      join_type, move(join_predicate), move(proj_info), proj_schema,
+      left_keys, right_keys, settings::SettingsManager::GetBool(
+                                 settings::SettingId::hash_join_bloom_filter)));
+
+  join_plan->AddChild(move(children_plans_[0]));
+  join_plan->AddChild(move(hash_plan));
+  output_plan_ = move(join_plan);
+}
+
 void PlanGenerator::GenerateProjectionForJoin(
     std::unique_ptr<const planner::ProjectInfo> &proj_info,
     std::shared_ptr<const catalog::Schema> &proj_schema) {
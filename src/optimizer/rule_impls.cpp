@@ -756,6 +756,114 @@ void InnerJoinToInnerHashJoin::Transform(
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// SemiJoinToSemiHashJoin
+SemiJoinToSemiHashJoin::SemiJoinToSemiHashJoin() {
+  type_ = RuleType::SEMI_JOIN_TO_HASH_JOIN;
+
+  // The left child is the relation whose tuples the semi join keeps
+  match_pattern = std::make_shared<Pattern>(OpType::SemiJoin);
+  match_pattern->AddChild(std::make_shared<Pattern>(OpType::Leaf));
+  match_pattern->AddChild(std::make_shared<Pattern>(OpType::Leaf));
+}
+
+bool SemiJoinToSemiHashJoin::Check(std::shared_ptr<OperatorExpression> plan,
+                                   OptimizeContext *context) const {
+  (void)context;
+  (void)plan;
+  return true;
+}
+
+void SemiJoinToSemiHashJoin::Transform(
+    std::shared_ptr<OperatorExpression> input,
+    std::vector<std::shared_ptr<OperatorExpression>> &transformed,
+    UNUSED_ATTRIBUTE OptimizeContext *context) const {
+  const LogicalSemiJoin *semi_join = input->Op().As<LogicalSemiJoin>();
+
+  auto children = input->Children();
+  PELOTON_ASSERT(children.size() == 2);
+  auto left_group_id = children[0]->Op().As<LeafOperator>()->origin_group;
+  auto right_group_id = children[1]->Op().As<LeafOperator>()->origin_group;
+  auto &left_group_alias =
+      context->metadata->memo.GetGroupByID(left_group_id)->GetTableAliases();
+  auto &right_group_alias =
+      context->metadata->memo.GetGroupByID(right_group_id)->GetTableAliases();
+
+  std::vector<AnnotatedExpression> join_predicates;
+  if (semi_join->join_predicate != nullptr) {
+    join_predicates = util::ExtractPredicates(semi_join->join_predicate.get());
+  }
+  std::vector<std::unique_ptr<expression::AbstractExpression>> left_keys;
+  std::vector<std::unique_ptr<expression::AbstractExpression>> right_keys;
+  util::ExtractEquiJoinKeys(join_predicates, left_keys, right_keys,
+                            left_group_alias, right_group_alias);
+
+  PELOTON_ASSERT(right_keys.size() == left_keys.size());
+  if (!left_keys.empty()) {
+    auto result_plan =
+        std::make_shared<OperatorExpression>(PhysicalSemiHashJoin::make(
+            JoinType::SEMI, join_predicates, left_keys, right_keys));
+
+    result_plan->PushChild(children[0]);
+    result_plan->PushChild(children[1]);
+
+    transformed.push_back(result_plan);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// MarkJoinToSemiHashJoin
+MarkJoinToSemiHashJoin::MarkJoinToSemiHashJoin() {
+  type_ = RuleType::MARK_JOIN_TO_HASH_JOIN;
+
+  // The left child is the outer query, the right one the subquery
+  match_pattern = std::make_shared<Pattern>(OpType::LogicalMarkJoin);
+  match_pattern->AddChild(std::make_shared<Pattern>(OpType::Leaf));
+  match_pattern->AddChild(std::make_shared<Pattern>(OpType::Leaf));
+}
+
+bool MarkJoinToSemiHashJoin::Check(std::shared_ptr<OperatorExpression> plan,
+                                   OptimizeContext *context) const {
+  (void)context;
+  (void)plan;
+  return true;
+}
+
+void MarkJoinToSemiHashJoin::Transform(
+    std::shared_ptr<OperatorExpression> input,
+    std::vector<std::shared_ptr<OperatorExpression>> &transformed,
+    UNUSED_ATTRIBUTE OptimizeContext *context) const {
+  const LogicalMarkJoin *mark_join = input->Op().As<LogicalMarkJoin>();
+
+  auto children = input->Children();
+  PELOTON_ASSERT(children.size() == 2);
+  auto left_group_id = children[0]->Op().As<LeafOperator>()->origin_group;
+  auto right_group_id = children[1]->Op().As<LeafOperator>()->origin_group;
+  auto &left_group_alias =
+      context->metadata->memo.GetGroupByID(left_group_id)->GetTableAliases();
+  auto &right_group_alias =
+      context->metadata->memo.GetGroupByID(right_group_id)->GetTableAliases();
+  std::vector<std::unique_ptr<expression::AbstractExpression>> left_keys;
+  std::vector<std::unique_ptr<expression::AbstractExpression>> right_keys;
+
+  util::ExtractEquiJoinKeys(mark_join->join_predicates, left_keys, right_keys,
+                            left_group_alias, right_group_alias);
+
+  // An outer tuple qualifies as soon as one subquery tuple matches it, which
+  // is exactly what a semi join produces
+  PELOTON_ASSERT(right_keys.size() == left_keys.size());
+  if (!left_keys.empty()) {
+    auto result_plan =
+        std::make_shared<OperatorExpression>(PhysicalSemiHashJoin::make(
+            JoinType::SEMI, mark_join->join_predicates, left_keys, right_keys));
+
+    result_plan->PushChild(children[0]);
+    result_plan->PushChild(children[1]);
+
+    transformed.push_back(result_plan);
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// ImplementDistinct
 ImplementDistinct::ImplementDistinct() {
@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// parameter_selectivity.cpp
+//
+// Identification: src/optimizer/stats/parameter_selectivity.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "optimizer/stats/parameter_selectivity.h"
+
+#include "common/exception.h"
+#include "expression/abstract_expression.h"
+#include "expression/parameter_value_expression.h"
+#include "expression/tuple_value_expression.h"
+#include "optimizer/stats/column_stats.h"
+#include "optimizer/stats/selectivity.h"
+#include "optimizer/stats/stats_storage.h"
+#include "optimizer/stats/table_stats.h"
+#include "optimizer/stats/value_condition.h"
+#include "parser/delete_statement.h"
+#include "parser/select_statement.h"
+#include "parser/update_statement.h"
+
+namespace peloton {
+namespace optimizer {
+
+constexpr int ParameterSelectivity::UNKNOWN_BUCKET;
+
+// Upper bounds (exclusive) of the selectivity buckets
+static const double kBucketBounds[] = {0.001, 0.01, 0.1, 0.3};
+
+static ExpressionType FlipComparison(ExpressionType type) {
+  switch (type) {
+    case ExpressionType::COMPARE_LESSTHAN:
+      return ExpressionType::COMPARE_GREATERTHAN;
+    case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+      return ExpressionType::COMPARE_GREATERTHANOREQUALTO;
+    case ExpressionType::COMPARE_GREATERTHAN:
+      return ExpressionType::COMPARE_LESSTHAN;
+    case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+      return ExpressionType::COMPARE_LESSTHANOREQUALTO;
+    default:
+      return type;
+  }
+}
+
+static void CollectParameterPredicates(
+    const expression::AbstractExpression *expr,
+    std::vector<ParameterPredicate> &predicates) {
+  if (expr == nullptr) return;
+
+  switch (expr->GetExpressionType()) {
+    case ExpressionType::COMPARE_EQUAL:
+    case ExpressionType::COMPARE_NOTEQUAL:
+    case ExpressionType::COMPARE_LESSTHAN:
+    case ExpressionType::COMPARE_GREATERTHAN:
+    case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+    case ExpressionType::COMPARE_GREATERTHANOREQUALTO: {
+      if (expr->GetChildrenSize() != 2) break;
+      auto *left = expr->GetChild(0);
+      auto *right = expr->GetChild(1);
+      auto type = expr->GetExpressionType();
+      if (left->GetExpressionType() == ExpressionType::VALUE_PARAMETER) {
+        std::swap(left, right);
+        type = FlipComparison(type);
+      }
+      if (left->GetExpressionType() != ExpressionType::VALUE_TUPLE ||
+          right->GetExpressionType() != ExpressionType::VALUE_PARAMETER) {
+        break;
+      }
+      auto *tv_expr =
+          static_cast<const expression::TupleValueExpression *>(left);
+      if (!tv_expr->GetIsBound()) break;
+      const auto &bound_oid = tv_expr->GetBoundOid();
+      auto column_stats = StatsStorage::GetInstance()->GetColumnStatsByID(
+          std::get<0>(bound_oid), std::get<1>(bound_oid),
+          std::get<2>(bound_oid));
+      if (column_stats == nullptr) break;
+
+      ParameterPredicate predicate;
+      predicate.type = type;
+      predicate.param_idx =
+          static_cast<const expression::ParameterValueExpression *>(right)
+              ->GetValueIdx();
+      predicate.column_stats = column_stats;
+      predicates.push_back(std::move(predicate));
+      return;
+    }
+    default:
+      break;
+  }
+
+  for (size_t i = 0; i < expr->GetChildrenSize(); i++) {
+    CollectParameterPredicates(expr->GetChild(i), predicates);
+  }
+}
+
+std::vector<ParameterPredicate> ParameterSelectivity::GetParameterPredicates(
+    const parser::SQLStatement *sql_stmt) {
+  std::vector<ParameterPredicate> predicates;
+  if (sql_stmt == nullptr) return predicates;
+
+  const expression::AbstractExpression *where = nullptr;
+  switch (sql_stmt->GetType()) {
+    case StatementType::SELECT:
+      where = static_cast<const parser::SelectStatement *>(sql_stmt)
+                  ->where_clause.get();
+      break;
+    case StatementType::UPDATE:
+      where =
+          static_cast<const parser::UpdateStatement *>(sql_stmt)->where.get();
+      break;
+    case StatementType::DELETE:
+      where =
+          static_cast<const parser::DeleteStatement *>(sql_stmt)->expr.get();
+      break;
+    default:
+      break;
+  }
+  CollectParameterPredicates(where, predicates);
+  return predicates;
+}
+
+double ParameterSelectivity::ComputeSelectivity(
+    const ParameterPredicate &predicate, const type::Value &value) {
+  // Stats are kept as doubles, so text parameters have to be converted first
+  type::Value numeric_value = value;
+  if (value.GetTypeId() == type::TypeId::VARCHAR) {
+    try {
+      numeric_value = value.CastAs(type::TypeId::DECIMAL);
+    } catch (Exception &e) {
+      return DEFAULT_SELECTIVITY;
+    }
+  }
+
+  std::vector<std::shared_ptr<ColumnStats>> column_stats{
+      predicate.column_stats};
+  auto table_stats = std::make_shared<TableStats>(column_stats);
+  ValueCondition condition(predicate.column_stats->column_name,
+                           predicate.type, numeric_value);
+  return Selectivity::ComputeSelectivity(table_stats, condition);
+}
+
+int ParameterSelectivity::GetBucket(double selectivity) {
+  int bucket = 0;
+  for (double bound : kBucketBounds) {
+    if (selectivity < bound) return bucket;
+    bucket++;
+  }
+  return bucket;
+}
+
+std::vector<int> ParameterSelectivity::ComputeBuckets(
+    const std::vector<ParameterPredicate> &predicates,
+    const std::vector<type::Value> &param_values) {
+  std::vector<int> buckets;
+  buckets.reserve(predicates.size());
+  for (const auto &predicate : predicates) {
+    if (predicate.param_idx < 0 ||
+        static_cast<size_t>(predicate.param_idx) >= param_values.size() ||
+        param_values[predicate.param_idx].IsNull()) {
+      buckets.push_back(UNKNOWN_BUCKET);
+      continue;
+    }
+    buckets.push_back(GetBucket(
+        ComputeSelectivity(predicate, param_values[predicate.param_idx])));
+  }
+  return buckets;
+}
+
+}  // namespace optimizer
+}  // namespace peloton
@@ -26,13 +26,15 @@
 namespace peloton {
 namespace optimizer {
 
-void StatsCalculator::CalculateStats(GroupExpression *gexpr,
-                                     ExprSet required_cols, Memo *memo,
-                                     concurrency::TransactionContext *txn) {
+void StatsCalculator::CalculateStats(
+    GroupExpression *gexpr, ExprSet required_cols, Memo *memo,
+    concurrency::TransactionContext *txn,
+    const std::vector<type::Value> *parameter_values) {
   gexpr_ = gexpr;
   memo_ = memo;
   required_cols_ = required_cols;
   txn_ = txn;
+  parameter_values_ = parameter_values;
   gexpr->Op().Accept(this);
 }
 
@@ -317,11 +319,17 @@ double StatsCalculator::CalculateSelectivityForPredicate(
                   expr->GetModifiableChild(right_index))
                   ->GetValue();
     } else {
-      value = type::ValueFactory::GetParameterOffsetValue(
-                  reinterpret_cast<expression::ParameterValueExpression *>(
-                      expr->GetModifiableChild(right_index))
-                      ->GetValueIdx())
-                  .Copy();
+      auto value_idx =
+          reinterpret_cast<expression::ParameterValueExpression *>(
+              expr->GetModifiableChild(right_index))
+              ->GetValueIdx();
+      if (parameter_values_ != nullptr && value_idx >= 0 &&
+          static_cast<size_t>(value_idx) < parameter_values_->size()) {
+        // Peek at the value bound to the parameter
+        value = parameter_values_->at(value_idx).Copy();
+      } else {
+        value = type::ValueFactory::GetParameterOffsetValue(value_idx).Copy();
+      }
     }
     ValueCondition condition(col_name, expr_type, value);
     selectivity =
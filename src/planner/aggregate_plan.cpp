@@ -71,7 +71,9 @@ void AggregatePlan::AggTerm::PerformBinding(bool is_global,
 }
 
 AggregatePlan::AggTerm AggregatePlan::AggTerm::Copy() const {
-  return AggTerm(aggtype, expression->Copy(), distinct);
+  return AggTerm(aggtype,
+                 expression != nullptr ? expression->Copy() : nullptr,
+                 distinct);
 }
 
 void AggregatePlan::PerformBinding(BindingContext &binding_context) {
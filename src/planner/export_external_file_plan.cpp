@@ -20,9 +20,11 @@ namespace peloton {
 namespace planner {
 
 ExportExternalFilePlan::ExportExternalFilePlan(std::string file_name,
+                                               ExternalFileFormat format,
                                                char delimiter, char quote,
                                                char escape)
     : file_name_(file_name),
+      format_(format),
       delimiter_(delimiter),
       quote_(quote),
       escape_(escape) {}
@@ -33,6 +35,7 @@ PlanNodeType ExportExternalFilePlan::GetPlanNodeType() const {
 
 hash_t ExportExternalFilePlan::Hash() const {
   hash_t hash = HashUtil::HashBytes(file_name_.data(), file_name_.length());
+  hash = HashUtil::CombineHashes(hash, HashUtil::Hash(&format_));
   hash = HashUtil::CombineHashes(hash, HashUtil::Hash(&delimiter_));
   hash = HashUtil::CombineHashes(hash, HashUtil::Hash(&quote_));
   hash = HashUtil::CombineHashes(hash, HashUtil::Hash(&escape_));
@@ -44,13 +47,14 @@ bool ExportExternalFilePlan::operator==(const AbstractPlan &rhs) const {
   const auto &other = static_cast<const ExportExternalFilePlan &>(rhs);
   return (
       (StringUtil::Upper(file_name_) == StringUtil::Upper(other.file_name_)) &&
-      delimiter_ == other.delimiter_ && quote_ == other.quote_ &&
-      escape_ == other.escape_);
+      format_ == other.format_ && delimiter_ == other.delimiter_ &&
+      quote_ == other.quote_ && escape_ == other.escape_);
 }
 
 std::unique_ptr<AbstractPlan> ExportExternalFilePlan::Copy() const {
   return std::unique_ptr<AbstractPlan>{
-      new ExportExternalFilePlan(file_name_, delimiter_, quote_, escape_)};
+      new ExportExternalFilePlan(file_name_, format_, delimiter_, quote_,
+                                 escape_)};
 }
 
 void ExportExternalFilePlan::PerformBinding(BindingContext &binding_context) {
@@ -76,11 +76,18 @@ std::unique_ptr<AbstractPlan> HashJoinPlan::Copy() const {
     right_hash_keys_copy.emplace_back(right_hash_key->Copy());
   }
 
+  // Projection
+  std::unique_ptr<const ProjectInfo> proj_info_copy(
+      GetProjInfo() != nullptr ? GetProjInfo()->Copy() : nullptr);
+
   // Create plan copy
   auto *new_plan =
       new HashJoinPlan(GetJoinType(), std::move(predicate_copy),
-                       GetProjInfo()->Copy(), schema_copy, left_hash_keys_copy,
-                       right_hash_keys_copy, build_bloomfilter_);
+                       std::move(proj_info_copy), schema_copy,
+                       left_hash_keys_copy, right_hash_keys_copy,
+                       build_bloomfilter_);
+  new_plan->SetPartitioned(partitioned_);
+  new_plan->SetCardinality(GetCardinality());
   return std::unique_ptr<AbstractPlan>(new_plan);
 }
 
@@ -99,6 +106,8 @@ hash_t HashJoinPlan::Hash() const {
     hash = HashUtil::CombineHashes(hash, keys[i]->Hash());
   }
 
+  hash = HashUtil::CombineHashes(hash, HashUtil::Hash(&partitioned_));
+
   return HashUtil::CombineHashes(hash, AbstractPlan::Hash());
 }
 
@@ -108,6 +117,9 @@ bool HashJoinPlan::operator==(const AbstractPlan &rhs) const {
   }
 
   const auto &other = static_cast<const HashJoinPlan &>(rhs);
+  if (IsPartitioned() != other.IsPartitioned()) {
+    return false;
+  }
 
   std::vector<const expression::AbstractExpression *> keys, other_keys;
 
@@ -50,14 +50,18 @@ void NestedLoopJoinPlan::HandleSubplanBinding(bool from_left,
 
 std::unique_ptr<AbstractPlan> NestedLoopJoinPlan::Copy() const {
   std::unique_ptr<const expression::AbstractExpression> predicate_copy(
-      GetPredicate()->Copy());
+      GetPredicate() != nullptr ? GetPredicate()->Copy() : nullptr);
 
   std::shared_ptr<const catalog::Schema> schema_copy(
       catalog::Schema::CopySchema(GetSchema()));
 
+  std::unique_ptr<const ProjectInfo> proj_info_copy(
+      GetProjInfo() != nullptr ? GetProjInfo()->Copy() : nullptr);
+
   NestedLoopJoinPlan *new_plan = new NestedLoopJoinPlan(
-      GetJoinType(), std::move(predicate_copy), GetProjInfo()->Copy(),
+      GetJoinType(), std::move(predicate_copy), std::move(proj_info_copy),
       schema_copy, join_column_ids_left_, join_column_ids_right_);
+  new_plan->SetCardinality(GetCardinality());
 
   return std::unique_ptr<AbstractPlan>(new_plan);
 }
@@ -33,6 +33,26 @@
 namespace peloton {
 namespace planner {
 
+std::unique_ptr<planner::AbstractPlan> PlanUtil::CopyPlanTree(
+    const planner::AbstractPlan *plan) {
+  if (plan == nullptr) {
+    return nullptr;
+  }
+  // Copy() only copies the node itself, so the children are attached here
+  auto copy = plan->Copy();
+  if (copy == nullptr) {
+    return nullptr;
+  }
+  for (const auto &child : plan->GetChildren()) {
+    auto child_copy = CopyPlanTree(child.get());
+    if (child_copy == nullptr) {
+      return nullptr;
+    }
+    copy->AddChild(std::move(child_copy));
+  }
+  return copy;
+}
+
 const std::set<oid_t> PlanUtil::GetAffectedIndexes(
     catalog::CatalogCache &catalog_cache,
     const parser::SQLStatement &sql_stmt) {
@@ -52,9 +52,9 @@ CircularBuffer<double> LatencyMetric::Copy() {
   return new_buffer;
 }
 
-const std::string LatencyMetric::GetInfo() const {
+const std::string LatencyMetric::GetInfo(const std::string &label) const {
   std::stringstream ss;
-  ss << "TXN LATENCY (ms): [ ";
+  ss << label << " (ms): [ ";
   ss << "average=" << latency_measurements_.average_;
   ss << ", min=" << latency_measurements_.min_;
   ss << ", 25th-%-tile=" << latency_measurements_.perc_25th_;
@@ -19,6 +19,7 @@
 #include "concurrency/transaction_manager_factory.h"
 #include "index/index.h"
 #include "storage/storage_manager.h"
+#include "threadpool/mono_queue_pool.h"
 #include "type/ephemeral_pool.h"
 
 namespace peloton {
@@ -111,6 +112,23 @@ void StatsAggregator::Aggregate(int64_t &interval_cnt, double &alpha,
   LOG_TRACE("Moving avg. throughput: %lf txn/s", weighted_avg_throughput);
   LOG_TRACE("Current throughput:     %lf txn/s", throughput_);
 
+  // Time the queries spent waiting in the execution queue, per task class
+  static const char *task_class_names[NUM_TASK_CLASSES] = {"OLTP", "OLAP",
+                                                           "MAINTENANCE"};
+  std::stringstream queue_latencies;
+  auto &task_queue = threadpool::MonoQueuePool::GetInstance().GetTaskQueue();
+  for (int i = 0; i < NUM_TASK_CLASSES; i++) {
+    LatencyMetric queue_latency(MetricType::LATENCY,
+                                TASK_QUEUE_LATENCY_HISTORY);
+    queue_latency.Aggregate(task_queue.GetQueueLatencyMetric(
+        static_cast<threadpool::TaskClass>(i)));
+    queue_latency.ComputeLatencies();
+    queue_latencies << queue_latency.GetInfo(std::string(task_class_names[i]) +
+                                             " QUEUE LATENCY")
+                    << std::endl;
+  }
+  LOG_TRACE("%s", queue_latencies.str().c_str());
+
   // Write the stats to metric tables
   UpdateMetrics();
 
@@ -118,6 +136,7 @@ void StatsAggregator::Aggregate(int64_t &interval_cnt, double &alpha,
     try {
       ofs_ << "At interval: " << interval_cnt << std::endl;
       ofs_ << aggregated_stats_.ToString();
+      ofs_ << queue_latencies.str();
       ofs_ << "Weighted avg. throughput=" << weighted_avg_throughput
            << std::endl;
       ofs_ << "Average throughput=" << avg_throughput_ << std::endl;
@@ -0,0 +1,667 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// arrow_exporter.cpp
+//
+// Identification: src/storage/arrow_exporter.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/arrow_exporter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <string>
+
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "common/logger.h"
+#include "function/date_functions.h"
+#include "storage/data_table.h"
+#include "storage/layout.h"
+#include "storage/tile.h"
+#include "storage/tile_group.h"
+#include "storage/tile_group_header.h"
+#include "type/type.h"
+#include "type/value_factory.h"
+#include "util/string_util.h"
+
+namespace peloton {
+namespace storage {
+
+namespace {
+
+// The magic string at the beginning and at the end of an Arrow file
+constexpr char kArrowMagic[] = "ARROW1";
+constexpr size_t kArrowMagicSize = sizeof(kArrowMagic) - 1;
+
+// Messages and buffers start at multiples of this
+constexpr size_t kArrowAlignment = 8;
+
+// Marks the start of an encapsulated message
+constexpr uint32_t kContinuationMarker = 0xFFFFFFFF;
+
+// The Julian day of 1970-01-01, where Arrow counts dates and timestamps from
+constexpr int64_t kUnixEpochJulianDay = 2440588;
+
+// From Schema.fbs and Message.fbs of the Arrow format
+constexpr int16_t kMetadataVersionV5 = 4;
+constexpr int16_t kLittleEndian = 0;
+constexpr int16_t kPrecisionDouble = 2;
+constexpr int16_t kDateUnitDay = 0;
+constexpr int16_t kTimeUnitMicrosecond = 2;
+
+enum class ArrowType : uint8_t {
+  Int = 2,
+  FloatingPoint = 3,
+  Binary = 4,
+  Utf8 = 5,
+  Bool = 6,
+  Date = 8,
+  Timestamp = 10,
+};
+
+enum class MessageHeader : uint8_t {
+  Schema = 1,
+  RecordBatch = 3,
+};
+
+// The structs of Message.fbs, which are laid out like their flatbuffer form
+struct FieldNode {
+  int64_t length;
+  int64_t null_count;
+};
+
+struct Buffer {
+  int64_t offset;
+  int64_t length;
+};
+
+size_t PadToAlignment(size_t length) {
+  return (length + kArrowAlignment - 1) / kArrowAlignment * kArrowAlignment;
+}
+
+/**
+ * Builds a flatbuffer, the encoding of Arrow's metadata, back to front like
+ * the flatbuffers library does. Objects are referred to by their distance
+ * from the end of the buffer, and a table must be built after the objects it
+ * refers to, one table at a time.
+ */
+class FlatBufferBuilder {
+ public:
+  using Offset = uint32_t;
+
+  void StartTable() {
+    PELOTON_ASSERT(fields_.empty());
+    table_start_ = Size();
+  }
+
+  template <typename T>
+  void AddScalar(uint16_t field_id, T value) {
+    Push(value);
+    fields_.emplace_back(field_id, Size());
+  }
+
+  void AddOffset(uint16_t field_id, Offset offset) {
+    PushOffset(offset);
+    fields_.emplace_back(field_id, Size());
+  }
+
+  Offset EndTable() {
+    // The table starts with the offset of its vtable, which comes right
+    // before it
+    Push<int32_t>(0);
+    Offset table = Size();
+
+    uint16_t num_fields = 0;
+    for (const auto &field : fields_) {
+      num_fields = std::max<uint16_t>(num_fields, field.first + 1);
+    }
+    std::vector<uint16_t> field_offsets(num_fields, 0);
+    for (const auto &field : fields_) {
+      field_offsets[field.first] = static_cast<uint16_t>(table - field.second);
+    }
+    for (size_t field_id = num_fields; field_id > 0; field_id--) {
+      Push(field_offsets[field_id - 1]);
+    }
+    Push(static_cast<uint16_t>(table - table_start_));
+    Push(static_cast<uint16_t>((num_fields + 2) * sizeof(uint16_t)));
+
+    Patch(table, static_cast<int32_t>(Size() - table));
+    fields_.clear();
+    return table;
+  }
+
+  Offset CreateString(const std::string &str) {
+    Align(sizeof(uint32_t), str.size() + 1);
+    buffer_.push_back(0);
+    PushBytes(str.data(), str.size());
+    Push(static_cast<uint32_t>(str.size()));
+    return Size();
+  }
+
+  // A vector of the given structs, whose fields are at most 8 bytes wide
+  Offset CreateStructVector(const void *structs, size_t count,
+                            size_t struct_size) {
+    Align(sizeof(uint32_t), count * struct_size);
+    Align(sizeof(int64_t), count * struct_size);
+    PushBytes(structs, count * struct_size);
+    Push(static_cast<uint32_t>(count));
+    return Size();
+  }
+
+  Offset CreateOffsetVector(const std::vector<Offset> &offsets) {
+    Align(sizeof(uint32_t), offsets.size() * sizeof(Offset));
+    for (size_t i = offsets.size(); i > 0; i--) {
+      PushOffset(offsets[i - 1]);
+    }
+    Push(static_cast<uint32_t>(offsets.size()));
+    return Size();
+  }
+
+  // Get the flatbuffer with the given root table, padded to the alignment of
+  // Arrow messages
+  std::vector<uint8_t> Finish(Offset root) {
+    Align(max_alignment_, sizeof(Offset));
+    PushOffset(root);
+    std::vector<uint8_t> result(buffer_.rbegin(), buffer_.rend());
+    result.resize(PadToAlignment(result.size()), 0);
+    return result;
+  }
+
+ private:
+  Offset Size() const { return static_cast<Offset>(buffer_.size()); }
+
+  // Pad the buffer so that an object of the given size that is pushed next
+  // ends up aligned
+  void Align(size_t alignment, size_t object_size = 0) {
+    max_alignment_ = std::max(max_alignment_, alignment);
+    while ((buffer_.size() + object_size) % alignment != 0) {
+      buffer_.push_back(0);
+    }
+  }
+
+  void PushBytes(const void *data, size_t length) {
+    auto *bytes = reinterpret_cast<const uint8_t *>(data);
+    for (size_t i = length; i > 0; i--) {
+      buffer_.push_back(bytes[i - 1]);
+    }
+  }
+
+  template <typename T>
+  void Push(T value) {
+    Align(sizeof(T));
+    PushBytes(&value, sizeof(T));
+  }
+
+  // Offsets point forward, from where they are stored
+  void PushOffset(Offset offset) {
+    Align(sizeof(Offset));
+    Push(static_cast<Offset>(Size() + sizeof(Offset) - offset));
+  }
+
+  // Overwrite the object that was pushed at the given position
+  template <typename T>
+  void Patch(Offset position, T value) {
+    auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+    for (size_t i = 0; i < sizeof(T); i++) {
+      buffer_[position - 1 - i] = bytes[i];
+    }
+  }
+
+ private:
+  // The bytes, last one first
+  std::vector<uint8_t> buffer_;
+
+  size_t max_alignment_ = 1;
+
+  // The table being built, and the positions of its fields
+  Offset table_start_ = 0;
+  std::vector<std::pair<uint16_t, Offset>> fields_;
+};
+
+using Offset = FlatBufferBuilder::Offset;
+
+Offset BuildType(FlatBufferBuilder &builder, type::TypeId type_id,
+                 ArrowType &arrow_type) {
+  Offset time_zone = 0;
+  switch (type_id) {
+    case type::TypeId::BOOLEAN:
+      arrow_type = ArrowType::Bool;
+      builder.StartTable();
+      break;
+    case type::TypeId::TINYINT:
+    case type::TypeId::SMALLINT:
+    case type::TypeId::INTEGER:
+    case type::TypeId::BIGINT:
+      arrow_type = ArrowType::Int;
+      builder.StartTable();
+      builder.AddScalar<int32_t>(
+          0, static_cast<int32_t>(type::Type::GetTypeSize(type_id) * 8));
+      builder.AddScalar<uint8_t>(1, true);
+      break;
+    case type::TypeId::DECIMAL:
+      arrow_type = ArrowType::FloatingPoint;
+      builder.StartTable();
+      builder.AddScalar(0, kPrecisionDouble);
+      break;
+    case type::TypeId::DATE:
+      arrow_type = ArrowType::Date;
+      builder.StartTable();
+      builder.AddScalar(0, kDateUnitDay);
+      break;
+    case type::TypeId::TIMESTAMP:
+      arrow_type = ArrowType::Timestamp;
+      time_zone = builder.CreateString("UTC");
+      builder.StartTable();
+      builder.AddScalar(0, kTimeUnitMicrosecond);
+      builder.AddOffset(1, time_zone);
+      break;
+    case type::TypeId::VARCHAR:
+      arrow_type = ArrowType::Utf8;
+      builder.StartTable();
+      break;
+    case type::TypeId::VARBINARY:
+      arrow_type = ArrowType::Binary;
+      builder.StartTable();
+      break;
+    default:
+      throw NotImplementedException(
+          StringUtil::Format("Cannot export %s columns to Arrow",
+                             TypeIdToString(type_id).c_str()));
+  }
+  return builder.EndTable();
+}
+
+Offset BuildSchema(FlatBufferBuilder &builder, const catalog::Schema &schema,
+                   const std::vector<oid_t> &column_ids) {
+  std::vector<Offset> fields;
+  for (oid_t column_id : column_ids) {
+    const auto &column = schema.GetColumn(column_id);
+    ArrowType arrow_type;
+    Offset type = BuildType(builder, column.GetType(), arrow_type);
+    Offset name = builder.CreateString(column.GetName());
+    Offset children = builder.CreateOffsetVector({});
+
+    builder.StartTable();
+    builder.AddOffset(0, name);
+    builder.AddScalar<uint8_t>(1, true);
+    builder.AddScalar(2, static_cast<uint8_t>(arrow_type));
+    builder.AddOffset(3, type);
+    builder.AddOffset(5, children);
+    fields.push_back(builder.EndTable());
+  }
+  Offset field_vector = builder.CreateOffsetVector(fields);
+
+  builder.StartTable();
+  builder.AddScalar(0, kLittleEndian);
+  builder.AddOffset(1, field_vector);
+  return builder.EndTable();
+}
+
+std::vector<uint8_t> BuildMessage(FlatBufferBuilder &builder,
+                                  MessageHeader header_type, Offset header,
+                                  int64_t body_length) {
+  builder.StartTable();
+  builder.AddScalar(3, body_length);
+  builder.AddOffset(2, header);
+  builder.AddScalar(0, kMetadataVersionV5);
+  builder.AddScalar(1, static_cast<uint8_t>(header_type));
+  return builder.Finish(builder.EndTable());
+}
+
+// Peloton packs the microseconds, the seconds of the day, the year, the time
+// zone, the day and the month of a timestamp into decimal digits
+int64_t TimestampToUnixMicros(uint64_t timestamp) {
+  int64_t micros = timestamp % 1000000;
+  timestamp /= 1000000;
+  int64_t seconds = timestamp % 100000;
+  timestamp /= 100000;
+  int32_t year = timestamp % 10000;
+  timestamp /= 10000;
+  int64_t time_zone = static_cast<int64_t>(timestamp % 27) - 12;
+  timestamp /= 27;
+  int32_t day = timestamp % 32;
+  timestamp /= 32;
+  int32_t month = timestamp;
+
+  int64_t days = function::DateFunctions::DateToJulian(year, month, day) -
+                 kUnixEpochJulianDay;
+  return (days * 86400 + seconds - time_zone * 3600) * 1000000 + micros;
+}
+
+}  // namespace
+
+struct ArrowExporter::RecordBatch {
+  std::vector<FieldNode> nodes;
+  std::vector<Buffer> buffers;
+
+  // Where the data of each buffer is
+  std::vector<const char *> data;
+
+  // The buffers that were gathered rather than pointing into tiles
+  std::deque<std::string> gathered;
+
+  int64_t body_length = 0;
+
+  void AddBuffer(const char *buffer_data, size_t length) {
+    buffers.push_back({body_length, static_cast<int64_t>(length)});
+    data.push_back(buffer_data);
+    body_length += PadToAlignment(length);
+  }
+
+  void AddBuffer(std::string &&buffer) {
+    gathered.push_back(std::move(buffer));
+    AddBuffer(gathered.back().data(), gathered.back().size());
+  }
+
+  // Arrow leaves out the validity bitmap of a column without nulls
+  void AddValidity(std::string &&validity, size_t length, size_t null_count) {
+    nodes.push_back(
+        {static_cast<int64_t>(length), static_cast<int64_t>(null_count)});
+    if (null_count == 0) {
+      AddBuffer(nullptr, 0);
+    } else {
+      AddBuffer(std::move(validity));
+    }
+  }
+};
+
+ArrowExporter::ArrowExporter(DataTable *table, std::vector<oid_t> column_ids,
+                             cid_t read_cid)
+    : table_(table),
+      column_ids_(std::move(column_ids)),
+      read_cid_(read_cid),
+      file_(nullptr),
+      file_offset_(0) {}
+
+size_t ArrowExporter::Export(FILE *file) {
+  file_ = file;
+  file_offset_ = 0;
+  record_batches_.clear();
+
+  Write(kArrowMagic, kArrowMagicSize);
+  WritePadding(PadToAlignment(kArrowMagicSize) - kArrowMagicSize);
+
+  {
+    FlatBufferBuilder builder;
+    Offset schema = BuildSchema(builder, *table_->GetSchema(), column_ids_);
+    WriteMessage(BuildMessage(builder, MessageHeader::Schema, schema, 0),
+                 nullptr);
+  }
+
+  size_t num_rows = 0;
+  size_t tile_group_count = table_->GetTileGroupCount();
+  for (size_t offset = 0; offset < tile_group_count; offset++) {
+    auto tile_group = table_->GetTileGroup(offset);
+    if (tile_group != nullptr) {
+      num_rows += WriteRecordBatch(*tile_group);
+    }
+  }
+
+  // The end of the stream
+  uint32_t end_of_stream[] = {kContinuationMarker, 0};
+  Write(end_of_stream, sizeof(end_of_stream));
+
+  // The footer lets readers find the record batches without reading the
+  // stream
+  FlatBufferBuilder builder;
+  Offset schema = BuildSchema(builder, *table_->GetSchema(), column_ids_);
+  Offset dictionaries = builder.CreateStructVector(nullptr, 0, sizeof(Block));
+  Offset record_batches = builder.CreateStructVector(
+      record_batches_.data(), record_batches_.size(), sizeof(Block));
+  builder.StartTable();
+  builder.AddOffset(1, schema);
+  builder.AddOffset(2, dictionaries);
+  builder.AddOffset(3, record_batches);
+  builder.AddScalar(0, kMetadataVersionV5);
+  auto footer = builder.Finish(builder.EndTable());
+
+  Write(footer.data(), footer.size());
+  int32_t footer_length = static_cast<int32_t>(footer.size());
+  Write(&footer_length, sizeof(footer_length));
+  Write(kArrowMagic, kArrowMagicSize);
+
+  LOG_DEBUG("Exported %lu rows in %lu record batches to Arrow", num_rows,
+            record_batches_.size());
+  return num_rows;
+}
+
+size_t ArrowExporter::WriteRecordBatch(TileGroup &tile_group) {
+  // The versions that were committed at the read timestamp
+  auto *header = tile_group.GetHeader();
+  oid_t num_slots = tile_group.GetNextTupleSlot();
+  std::vector<oid_t> slots;
+  for (oid_t slot = 0; slot < num_slots; slot++) {
+    if (header->GetBeginCommitId(slot) <= read_cid_ &&
+        read_cid_ < header->GetEndCommitId(slot)) {
+      slots.push_back(slot);
+    }
+  }
+  if (slots.empty()) {
+    return 0;
+  }
+
+  RecordBatch batch;
+  for (oid_t column_id : column_ids_) {
+    AddColumn(tile_group, column_id, slots, slots.size() == num_slots, batch);
+  }
+
+  FlatBufferBuilder builder;
+  Offset nodes = builder.CreateStructVector(
+      batch.nodes.data(), batch.nodes.size(), sizeof(FieldNode));
+  Offset buffers = builder.CreateStructVector(
+      batch.buffers.data(), batch.buffers.size(), sizeof(Buffer));
+  builder.StartTable();
+  builder.AddScalar(0, static_cast<int64_t>(slots.size()));
+  builder.AddOffset(1, nodes);
+  builder.AddOffset(2, buffers);
+  Offset record_batch = builder.EndTable();
+
+  record_batches_.push_back(WriteMessage(
+      BuildMessage(builder, MessageHeader::RecordBatch, record_batch,
+                   batch.body_length),
+      &batch));
+  return slots.size();
+}
+
+void ArrowExporter::AddColumn(TileGroup &tile_group, oid_t column_id,
+                              const std::vector<oid_t> &slots,
+                              bool all_visible, RecordBatch &batch) const {
+  oid_t tile_offset, tile_column_id;
+  tile_group.GetLayout().LocateTileAndColumn(column_id, tile_offset,
+                                             tile_column_id);
+  Tile *tile = tile_group.GetTile(tile_offset);
+  const catalog::Schema *tile_schema = tile->GetSchema();
+  type::TypeId type_id = tile_schema->GetType(tile_column_id);
+  size_t column_offset = tile_schema->GetOffset(tile_column_id);
+  size_t num_rows = slots.size();
+
+  std::string validity((num_rows + 7) / 8, 0);
+  size_t null_count = 0;
+  auto set_valid = [&validity](size_t row) {
+    validity[row / 8] |= static_cast<char>(1 << (row % 8));
+  };
+
+  if (type_id == type::TypeId::VARCHAR || type_id == type::TypeId::VARBINARY) {
+    std::string offsets((num_rows + 1) * sizeof(int32_t), 0);
+    std::string values;
+    auto *value_offsets = reinterpret_cast<int32_t *>(&offsets[0]);
+    for (size_t row = 0; row < num_rows; row++) {
+      value_offsets[row] = static_cast<int32_t>(values.size());
+      auto value = tile->GetValue(slots[row], tile_column_id);
+      if (value.IsNull()) {
+        null_count++;
+        continue;
+      }
+      set_valid(row);
+      size_t length = value.GetLength();
+      // Varchars keep their terminating NUL
+      if (type_id == type::TypeId::VARCHAR && length > 0) {
+        length--;
+      }
+      values.append(value.GetData(), length);
+    }
+    value_offsets[num_rows] = static_cast<int32_t>(values.size());
+    batch.AddValidity(std::move(validity), num_rows, null_count);
+    batch.AddBuffer(std::move(offsets));
+    batch.AddBuffer(std::move(values));
+    return;
+  }
+
+  // The inlined value in a slot, as a compressed tile decodes it if needed
+  size_t width = type::Type::GetTypeSize(type_id);
+  bool has_data = tile->GetCompressedColumn() == nullptr;
+  auto read_value = [&](oid_t slot, char *value) {
+    if (has_data) {
+      PELOTON_MEMCPY(value, tile->GetTupleLocation(slot) + column_offset,
+                     width);
+    } else {
+      tile->GetValue(slot, tile_column_id).SerializeTo(value, true, nullptr);
+    }
+  };
+  std::string null_value(width, 0);
+  type::ValueFactory::GetNullValueByType(type_id).SerializeTo(
+      &null_value[0], true, nullptr);
+
+  switch (type_id) {
+    case type::TypeId::TINYINT:
+    case type::TypeId::SMALLINT:
+    case type::TypeId::INTEGER:
+    case type::TypeId::BIGINT:
+    case type::TypeId::DECIMAL: {
+      // The values are laid out like Arrow's in a tile of this column alone
+      const char *values;
+      std::string gathered;
+      if (has_data && all_visible && tile_schema->GetColumnCount() == 1) {
+        values = tile->GetTupleLocation(0);
+      } else {
+        gathered.resize(num_rows * width);
+        for (size_t row = 0; row < num_rows; row++) {
+          read_value(slots[row], &gathered[row * width]);
+        }
+        values = gathered.data();
+      }
+      for (size_t row = 0; row < num_rows; row++) {
+        if (memcmp(values + row * width, null_value.data(), width) == 0) {
+          null_count++;
+        } else {
+          set_valid(row);
+        }
+      }
+      batch.AddValidity(std::move(validity), num_rows, null_count);
+      if (gathered.empty()) {
+        batch.AddBuffer(values, num_rows * width);
+      } else {
+        batch.AddBuffer(std::move(gathered));
+      }
+      break;
+    }
+    case type::TypeId::BOOLEAN: {
+      std::string bits((num_rows + 7) / 8, 0);
+      for (size_t row = 0; row < num_rows; row++) {
+        int8_t value;
+        read_value(slots[row], reinterpret_cast<char *>(&value));
+        if (value == type::PELOTON_BOOLEAN_NULL) {
+          null_count++;
+          continue;
+        }
+        set_valid(row);
+        if (value != 0) {
+          bits[row / 8] |= static_cast<char>(1 << (row % 8));
+        }
+      }
+      batch.AddValidity(std::move(validity), num_rows, null_count);
+      batch.AddBuffer(std::move(bits));
+      break;
+    }
+    case type::TypeId::DATE: {
+      std::string days(num_rows * sizeof(int32_t), 0);
+      auto *day_values = reinterpret_cast<int32_t *>(&days[0]);
+      for (size_t row = 0; row < num_rows; row++) {
+        int32_t value;
+        read_value(slots[row], reinterpret_cast<char *>(&value));
+        if (value == type::PELOTON_DATE_NULL) {
+          null_count++;
+          continue;
+        }
+        set_valid(row);
+        day_values[row] = static_cast<int32_t>(value - kUnixEpochJulianDay);
+      }
+      batch.AddValidity(std::move(validity), num_rows, null_count);
+      batch.AddBuffer(std::move(days));
+      break;
+    }
+    case type::TypeId::TIMESTAMP: {
+      std::string micros(num_rows * sizeof(int64_t), 0);
+      auto *micro_values = reinterpret_cast<int64_t *>(&micros[0]);
+      for (size_t row = 0; row < num_rows; row++) {
+        uint64_t value;
+        read_value(slots[row], reinterpret_cast<char *>(&value));
+        if (value == type::PELOTON_TIMESTAMP_NULL) {
+          null_count++;
+          continue;
+        }
+        set_valid(row);
+        micro_values[row] = TimestampToUnixMicros(value);
+      }
+      batch.AddValidity(std::move(validity), num_rows, null_count);
+      batch.AddBuffer(std::move(micros));
+      break;
+    }
+    default:
+      throw NotImplementedException(
+          StringUtil::Format("Cannot export %s columns to Arrow",
+                             TypeIdToString(type_id).c_str()));
+  }
+}
+
+ArrowExporter::Block ArrowExporter::WriteMessage(
+    const std::vector<uint8_t> &metadata, const RecordBatch *body) {
+  Block block;
+  block.offset = static_cast<int64_t>(file_offset_);
+  block.padding = 0;
+
+  uint32_t prefix[] = {kContinuationMarker,
+                       static_cast<uint32_t>(metadata.size())};
+  Write(prefix, sizeof(prefix));
+  Write(metadata.data(), metadata.size());
+  block.metadata_length = static_cast<int32_t>(sizeof(prefix) + metadata.size());
+
+  block.body_length = 0;
+  if (body != nullptr) {
+    for (size_t i = 0; i < body->buffers.size(); i++) {
+      size_t length = body->buffers[i].length;
+      Write(body->data[i], length);
+      WritePadding(PadToAlignment(length) - length);
+    }
+    block.body_length = body->body_length;
+  }
+  return block;
+}
+
+void ArrowExporter::Write(const void *data, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  if (fwrite(data, 1, length, file_) != length) {
+    throw SerializationException(
+        StringUtil::Format("Failed to write the Arrow file: %s",
+                           strerror(errno)));
+  }
+  file_offset_ += length;
+}
+
+void ArrowExporter::WritePadding(size_t length) {
+  static const char kZeros[kArrowAlignment] = {0};
+  PELOTON_ASSERT(length <= kArrowAlignment);
+  Write(kZeros, length);
+}
+
+}  // namespace storage
+}  // namespace peloton
@@ -23,12 +23,15 @@
 #include <unistd.h>
 
 #include <iostream>
+#include <iterator>
+#include <new>
 #include <string>
 
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/macros.h"
 #include "common/internal_types.h"
+#include "settings/settings_manager.h"
 
 //===--------------------------------------------------------------------===//
 // GUC Variables
@@ -311,7 +314,24 @@ BackendManager &BackendManager::GetInstance(void) {
 }
 
 BackendManager::BackendManager()
-    : data_file_address(nullptr), data_file_len(0), data_file_offset(0) {
+    : huge_page_mode_(HugePageMode::Transparent),
+      reserve_(nullptr),
+      reserve_size_(0),
+      huge_page_allocation_count_(0),
+      data_file_address(nullptr),
+      data_file_len(0),
+      data_file_offset(0) {
+  std::string huge_pages =
+      settings::SettingsManager::GetString(settings::SettingId::huge_pages);
+  if (huge_pages == "off") {
+    huge_page_mode_ = HugePageMode::Off;
+  } else if (huge_pages == "explicit") {
+    huge_page_mode_ = HugePageMode::Explicit;
+  } else if (huge_pages != "transparent") {
+    LOG_WARN("Unknown huge_pages setting %s, using transparent huge pages",
+             huge_pages.c_str());
+  }
+
   // // Check if we need a data pool
   // if (logging::LoggingUtil::IsBasedOnWriteAheadLogging(peloton_logging_mode)
   // ==
@@ -423,6 +443,10 @@ BackendManager::BackendManager()
 BackendManager::~BackendManager() {
   LOG_TRACE("Allocation count : %ld \n", allocation_count);
 
+  if (reserve_ != nullptr) {
+    munmap(reserve_, reserve_size_);
+  }
+
   // // Check if we need a PMEM pool
   // if (peloton_logging_mode != LoggingType::NVM_WBL) return;
 
@@ -512,6 +536,212 @@ void BackendManager::Release(BackendType type, void *address) {
   }
 }
 
+//===--------------------------------------------------------------------===//
+// PAGE-BACKED ALLOCATIONS
+//===--------------------------------------------------------------------===//
+
+// Rounding up to whole huge pages may waste at most this fraction of the size
+static constexpr size_t kHugePageMaxWasteRatio = 8;
+
+static inline size_t RoundUp(size_t size, size_t unit) {
+  return (size + unit - 1) / unit * unit;
+}
+
+bool BackendManager::UseHugePages(size_t size) const {
+  return huge_page_mode_ != HugePageMode::Off && size >= kHugePageThreshold &&
+         RoundUp(size, kHugePageSize) - size <= size / kHugePageMaxWasteRatio;
+}
+
+size_t BackendManager::GetMappedLength(size_t size, int numa_node) const {
+  if (UseHugePages(size)) {
+    return RoundUp(size, kHugePageSize);
+  } else if (numa_node != NumaManager::kAnyNode) {
+    return RoundUp(size, sysconf(_SC_PAGESIZE));
+  }
+  return 0;
+}
+
+void *BackendManager::MapHugePages(size_t length) {
+  PELOTON_ASSERT(length % kHugePageSize == 0);
+  if (huge_page_mode_ == HugePageMode::Explicit) {
+    void *address = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (address != MAP_FAILED) {
+      return address;
+    }
+    // The pool of explicit huge pages is empty, or there is none
+    LOG_TRACE("Could not map %zu bytes of explicit huge pages: %s", length,
+              strerror(errno));
+  }
+
+  // Transparent huge pages only back aligned huge page ranges, so map one
+  // more than needed and trim the ends
+  size_t mapped_length = length + kHugePageSize;
+  void *mapped = mmap(nullptr, mapped_length, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+  char *start = reinterpret_cast<char *>(mapped);
+  char *address = reinterpret_cast<char *>(
+      RoundUp(reinterpret_cast<uintptr_t>(start), kHugePageSize));
+  if (address != start) {
+    munmap(start, address - start);
+  }
+  size_t tail = (start + mapped_length) - (address + length);
+  if (tail > 0) {
+    munmap(address + length, tail);
+  }
+
+  // Without transparent huge pages, this is backed by small pages
+  if (madvise(address, length, MADV_HUGEPAGE) != 0) {
+    LOG_TRACE("Could not use transparent huge pages: %s", strerror(errno));
+  }
+  return address;
+}
+
+void *BackendManager::AllocatePages(size_t size, int numa_node) {
+  allocation_count++;
+
+  size_t length = GetMappedLength(size, numa_node);
+  if (length == 0) {
+    return ::operator new(size);
+  }
+
+  void *address = nullptr;
+  if (UseHugePages(size)) {
+    // The reserve is on no node in particular
+    if (numa_node == NumaManager::kAnyNode) {
+      address = TakeFromReserve(length);
+    }
+    if (address == nullptr) {
+      address = MapHugePages(length);
+    }
+    if (address != nullptr) {
+      huge_page_allocation_count_++;
+    }
+  } else {
+    address = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (address == MAP_FAILED) {
+      address = nullptr;
+    }
+  }
+  if (address == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  if (numa_node != NumaManager::kAnyNode) {
+    NumaManager::GetInstance().BindMemory(address, length,
+                                          static_cast<uint32_t>(numa_node));
+  }
+  return address;
+}
+
+void *BackendManager::AllocateTransient(size_t size) {
+  allocation_count++;
+
+  if (UseHugePages(size)) {
+    void *address = TakeFromReserve(RoundUp(size, kHugePageSize));
+    if (address != nullptr) {
+      huge_page_allocation_count_++;
+      return address;
+    }
+  }
+  return ::operator new(size);
+}
+
+void BackendManager::ReleaseTransient(void *address, size_t size) {
+  char *start = reinterpret_cast<char *>(address);
+  if (start >= reserve_ && start < reserve_ + reserve_size_) {
+    ReturnToReserve(start, RoundUp(size, kHugePageSize));
+  } else {
+    ::operator delete(address);
+  }
+}
+
+void BackendManager::ReleasePages(void *address, size_t size, int numa_node) {
+  if (address == nullptr) {
+    return;
+  }
+  size_t length = GetMappedLength(size, numa_node);
+  if (length == 0) {
+    ::operator delete(address);
+    return;
+  }
+
+  char *start = reinterpret_cast<char *>(address);
+  if (start >= reserve_ && start < reserve_ + reserve_size_) {
+    ReturnToReserve(start, length);
+  } else {
+    munmap(address, length);
+  }
+}
+
+bool BackendManager::ReserveHugePages(size_t size) {
+  PELOTON_ASSERT(reserve_ == nullptr);
+  if (huge_page_mode_ == HugePageMode::Off) {
+    return false;
+  }
+  size_t length = RoundUp(size, kHugePageSize);
+  auto *reserve = reinterpret_cast<char *>(MapHugePages(length));
+  if (reserve == nullptr) {
+    LOG_WARN("Could not reserve %zu MB of huge pages: %s", length >> 20,
+             strerror(errno));
+    return false;
+  }
+
+  // Fault in every page now
+  PELOTON_MEMSET(reserve, 0, length);
+
+  std::lock_guard<std::mutex> guard{reserve_lock_};
+  reserve_free_.emplace(0, length);
+  reserve_size_ = length;
+  reserve_ = reserve;
+  LOG_INFO("Reserved %zu MB of huge pages", length >> 20);
+  return true;
+}
+
+void *BackendManager::TakeFromReserve(size_t length) {
+  if (reserve_ == nullptr) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> guard{reserve_lock_};
+  for (auto iter = reserve_free_.begin(); iter != reserve_free_.end();
+       ++iter) {
+    if (iter->second >= length) {
+      size_t offset = iter->first;
+      size_t remaining = iter->second - length;
+      reserve_free_.erase(iter);
+      if (remaining > 0) {
+        reserve_free_.emplace(offset + length, remaining);
+      }
+      return reserve_ + offset;
+    }
+  }
+  return nullptr;
+}
+
+void BackendManager::ReturnToReserve(char *address, size_t length) {
+  std::lock_guard<std::mutex> guard{reserve_lock_};
+  size_t offset = address - reserve_;
+
+  // Merge the region with the free ones around it
+  auto next = reserve_free_.lower_bound(offset);
+  if (next != reserve_free_.end() && offset + length == next->first) {
+    length += next->second;
+    next = reserve_free_.erase(next);
+  }
+  if (next != reserve_free_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      prev->second += length;
+      return;
+    }
+  }
+  reserve_free_.emplace(offset, length);
+}
+
 void BackendManager::Sync(BackendType type, void *address, size_t length) {
   switch (type) {
     case BackendType::MM: {
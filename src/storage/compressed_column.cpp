@@ -0,0 +1,338 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// compressed_column.cpp
+//
+// Identification: src/storage/compressed_column.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/compressed_column.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "catalog/schema.h"
+#include "storage/tile.h"
+#include "type/type_util.h"
+
+namespace peloton {
+namespace storage {
+
+namespace {
+
+// The size of a dictionary entry with a string of the given length. Entries
+// are 4-byte aligned, like the length that precedes their string.
+size_t EntrySize(uint32_t len) {
+  return sizeof(uint32_t) + ((len + 3) & ~static_cast<size_t>(3));
+}
+
+// Read the length and the string of a varlen value
+uint32_t GetLength(const char *varlen) {
+  return *reinterpret_cast<const uint32_t *>(varlen);
+}
+
+const char *GetString(const char *varlen) { return varlen + sizeof(uint32_t); }
+
+// Compare the strings of two varlen values
+int CompareVarlens(const char *a, const char *b) {
+  return type::TypeUtil::CompareStrings(GetString(a), GetLength(a),
+                                        GetString(b), GetLength(b));
+}
+
+// Read the raw value of an integer column from the given storage
+bool ReadInteger(type::TypeId type_id, const char *storage, int64_t &val) {
+  switch (type_id) {
+    case type::TypeId::BOOLEAN:
+    case type::TypeId::TINYINT:
+      val = *reinterpret_cast<const int8_t *>(storage);
+      return true;
+    case type::TypeId::SMALLINT:
+      val = *reinterpret_cast<const int16_t *>(storage);
+      return true;
+    case type::TypeId::INTEGER:
+    case type::TypeId::DATE:
+      val = *reinterpret_cast<const int32_t *>(storage);
+      return true;
+    case type::TypeId::BIGINT:
+    case type::TypeId::TIMESTAMP:
+      val = *reinterpret_cast<const int64_t *>(storage);
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+CompressedColumn::CompressedColumn(Encoding encoding, type::TypeId type_id,
+                                   oid_t num_tuples)
+    : encoding_(encoding),
+      type_id_(type_id),
+      value_size_(type::Type::GetTypeSize(type_id)),
+      num_tuples_(num_tuples),
+      base_(0),
+      offset_size_(0),
+      dictionary_size_(0) {}
+
+std::unique_ptr<CompressedColumn> CompressedColumn::Encode(const Tile &tile,
+                                                           oid_t num_tuples) {
+  const catalog::Schema *schema = tile.GetSchema();
+  if (schema->GetColumnCount() != 1 || num_tuples == 0) {
+    return nullptr;
+  }
+
+  type::TypeId type_id = schema->GetType(0);
+  if (type_id == type::TypeId::VARCHAR || type_id == type::TypeId::VARBINARY) {
+    return schema->IsInlined(0) ? nullptr : EncodeStrings(tile, num_tuples);
+  }
+  return EncodeIntegers(tile, num_tuples);
+}
+
+std::unique_ptr<CompressedColumn> CompressedColumn::EncodeIntegers(
+    const Tile &tile, oid_t num_tuples) {
+  type::TypeId type_id = tile.GetSchema()->GetType(0);
+  int64_t val;
+  if (!ReadInteger(type_id, tile.GetTupleLocation(0), val)) {
+    return nullptr;
+  }
+
+  // Collect the runs, and the range of the values
+  std::vector<int64_t> run_values;
+  std::vector<oid_t> run_ends;
+  int64_t min = val, max = val;
+  for (oid_t tuple_itr = 0; tuple_itr < num_tuples; tuple_itr++) {
+    ReadInteger(type_id, tile.GetTupleLocation(tuple_itr), val);
+    if (run_values.empty() || run_values.back() != val) {
+      run_values.push_back(val);
+      run_ends.push_back(tuple_itr + 1);
+    } else {
+      run_ends.back() = tuple_itr + 1;
+    }
+    min = std::min(min, val);
+    max = std::max(max, val);
+  }
+
+  // Pick the smallest encoding
+  size_t raw_size = num_tuples * type::Type::GetTypeSize(type_id);
+  size_t rle_size = run_values.size() * (sizeof(int64_t) + sizeof(oid_t));
+
+  uint64_t range = static_cast<uint64_t>(max) - static_cast<uint64_t>(min);
+  uint32_t offset_size = 0;
+  if (range <= std::numeric_limits<uint8_t>::max()) {
+    offset_size = 1;
+  } else if (range <= std::numeric_limits<uint16_t>::max()) {
+    offset_size = 2;
+  } else if (range <= std::numeric_limits<uint32_t>::max()) {
+    offset_size = 4;
+  }
+  size_t for_size = offset_size != 0 ? num_tuples * offset_size : raw_size;
+
+  if (std::min(rle_size, for_size) >= raw_size) {
+    return nullptr;
+  }
+
+  std::unique_ptr<CompressedColumn> column;
+  if (rle_size <= for_size) {
+    column.reset(new CompressedColumn(Encoding::RunLength, type_id, num_tuples));
+    column->run_values_ = std::move(run_values);
+    column->run_ends_ = std::move(run_ends);
+  } else {
+    column.reset(
+        new CompressedColumn(Encoding::FrameOfReference, type_id, num_tuples));
+    column->base_ = min;
+    column->offset_size_ = offset_size;
+    column->offsets_.reset(new char[for_size]);
+    for (oid_t tuple_itr = 0; tuple_itr < num_tuples; tuple_itr++) {
+      ReadInteger(type_id, tile.GetTupleLocation(tuple_itr), val);
+      uint64_t offset =
+          static_cast<uint64_t>(val) - static_cast<uint64_t>(min);
+      // Offsets are stored little-endian, like the values they come from
+      PELOTON_MEMCPY(column->offsets_.get() + tuple_itr * offset_size,
+                     &offset, offset_size);
+    }
+  }
+  return column;
+}
+
+std::unique_ptr<CompressedColumn> CompressedColumn::EncodeStrings(
+    const Tile &tile, oid_t num_tuples) {
+  // Collect the values, and the memory they take in the tile's pool
+  std::vector<const char *> values;
+  size_t raw_size = 0;
+  for (oid_t tuple_itr = 0; tuple_itr < num_tuples; tuple_itr++) {
+    const char *varlen =
+        *reinterpret_cast<const char *const *>(tile.GetTupleLocation(tuple_itr));
+    if (varlen != nullptr) {
+      values.push_back(varlen);
+      raw_size += EntrySize(GetLength(varlen));
+    }
+  }
+
+  // Find the distinct values
+  std::sort(values.begin(), values.end(), [](const char *a, const char *b) {
+    return CompareVarlens(a, b) < 0;
+  });
+  auto last = std::unique(values.begin(), values.end(),
+                          [](const char *a, const char *b) {
+                            return CompareVarlens(a, b) == 0;
+                          });
+  values.erase(last, values.end());
+
+  size_t dictionary_size = 0;
+  for (const char *varlen : values) {
+    dictionary_size += EntrySize(GetLength(varlen));
+  }
+  if (values.empty() || dictionary_size >= raw_size) {
+    return nullptr;
+  }
+
+  // Lay out the entries in sorted order
+  type::TypeId type_id = tile.GetSchema()->GetType(0);
+  std::unique_ptr<CompressedColumn> column{
+      new CompressedColumn(Encoding::Dictionary, type_id, num_tuples)};
+  column->dictionary_.reset(new char[dictionary_size]);
+  column->dictionary_size_ = dictionary_size;
+  char *pos = column->dictionary_.get();
+  for (const char *varlen : values) {
+    uint32_t len = GetLength(varlen);
+    PELOTON_MEMCPY(pos, varlen, sizeof(uint32_t) + len);
+    column->entries_.push_back(pos);
+    pos += EntrySize(len);
+  }
+  return column;
+}
+
+size_t CompressedColumn::GetFootprint() const {
+  switch (encoding_) {
+    case Encoding::Dictionary:
+      return dictionary_size_ + entries_.size() * sizeof(const char *);
+    case Encoding::RunLength:
+      return run_values_.size() * (sizeof(int64_t) + sizeof(oid_t));
+    case Encoding::FrameOfReference:
+      return num_tuples_ * offset_size_;
+  }
+  return 0;
+}
+
+//===----------------------------------------------------------------------===//
+// Integer encodings
+//===----------------------------------------------------------------------===//
+
+int64_t CompressedColumn::GetRawValue(oid_t tuple_offset) const {
+  PELOTON_ASSERT(tuple_offset < num_tuples_);
+  if (encoding_ == Encoding::RunLength) {
+    auto run = std::upper_bound(run_ends_.begin(), run_ends_.end(),
+                                tuple_offset) -
+               run_ends_.begin();
+    return run_values_[run];
+  }
+
+  PELOTON_ASSERT(encoding_ == Encoding::FrameOfReference);
+  uint64_t offset = 0;
+  PELOTON_MEMCPY(&offset, offsets_.get() + tuple_offset * offset_size_,
+                 offset_size_);
+  return static_cast<int64_t>(static_cast<uint64_t>(base_) + offset);
+}
+
+type::Value CompressedColumn::GetValue(oid_t tuple_offset) const {
+  int64_t val = GetRawValue(tuple_offset);
+  return type::Value::DeserializeFrom(reinterpret_cast<const char *>(&val),
+                                      type_id_, true);
+}
+
+void CompressedColumn::Decode(char *dest) const {
+  PELOTON_ASSERT(encoding_ != Encoding::Dictionary);
+  if (encoding_ == Encoding::RunLength) {
+    oid_t tuple_itr = 0;
+    for (uint32_t run = 0; run < run_values_.size(); run++) {
+      for (; tuple_itr < run_ends_[run]; tuple_itr++) {
+        PELOTON_MEMCPY(dest + tuple_itr * value_size_, &run_values_[run],
+                       value_size_);
+      }
+    }
+    return;
+  }
+
+  for (oid_t tuple_itr = 0; tuple_itr < num_tuples_; tuple_itr++) {
+    uint64_t offset = 0;
+    PELOTON_MEMCPY(&offset, offsets_.get() + tuple_itr * offset_size_,
+                   offset_size_);
+    uint64_t val = static_cast<uint64_t>(base_) + offset;
+    PELOTON_MEMCPY(dest + tuple_itr * value_size_, &val, value_size_);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Dictionary encoding
+//===----------------------------------------------------------------------===//
+
+const char *CompressedColumn::FindEntry(const char *str, uint32_t len,
+                                        bool upper) const {
+  auto iter = std::lower_bound(
+      entries_.begin(), entries_.end(), str,
+      [len, upper](const char *entry, const char *s) {
+        int cmp = type::TypeUtil::CompareStrings(GetString(entry),
+                                                 GetLength(entry), s, len);
+        return upper ? cmp <= 0 : cmp < 0;
+      });
+  return iter == entries_.end() ? dictionary_.get() + dictionary_size_ : *iter;
+}
+
+const char *CompressedColumn::LookupEntry(const char *str,
+                                          uint32_t len) const {
+  PELOTON_ASSERT(encoding_ == Encoding::Dictionary);
+  const char *entry = FindEntry(str, len, false);
+  if (entry == dictionary_.get() + dictionary_size_ ||
+      type::TypeUtil::CompareStrings(GetString(entry), GetLength(entry), str,
+                                     len) != 0) {
+    return nullptr;
+  }
+  return entry;
+}
+
+void CompressedColumn::GetEntryRange(ExpressionType cmp_type, const char *str,
+                                     uint32_t len, const char **begin,
+                                     const char **end) const {
+  PELOTON_ASSERT(encoding_ == Encoding::Dictionary);
+
+  // Nothing compares with NULL
+  *begin = *end = nullptr;
+  if (str == nullptr) {
+    return;
+  }
+
+  const char *first = dictionary_.get();
+  const char *last = dictionary_.get() + dictionary_size_;
+  switch (cmp_type) {
+    case ExpressionType::COMPARE_EQUAL:
+      *begin = FindEntry(str, len, false);
+      *end = FindEntry(str, len, true);
+      break;
+    case ExpressionType::COMPARE_LESSTHAN:
+      *begin = first;
+      *end = FindEntry(str, len, false);
+      break;
+    case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+      *begin = first;
+      *end = FindEntry(str, len, true);
+      break;
+    case ExpressionType::COMPARE_GREATERTHAN:
+      *begin = FindEntry(str, len, true);
+      *end = last;
+      break;
+    case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+      *begin = FindEntry(str, len, false);
+      *end = last;
+      break;
+    default:
+      PELOTON_ASSERT(false);
+  }
+}
+
+}  // namespace storage
+}  // namespace peloton
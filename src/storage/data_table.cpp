@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <mutex>
+#include <unordered_set>
 #include <utility>
 
 #include "catalog/catalog.h"
@@ -20,7 +21,9 @@
 #include "common/container_tuple.h"
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/numa_manager.h"
 #include "common/platform.h"
+#include "concurrency/epoch_manager_factory.h"
 #include "concurrency/transaction_context.h"
 #include "concurrency/transaction_manager_factory.h"
 #include "executor/executor_context.h"
@@ -35,6 +38,7 @@
 #include "storage/tile_group.h"
 #include "storage/tile_group_factory.h"
 #include "storage/tile_group_header.h"
+#include "storage/tiering_manager.h"
 #include "storage/tuple.h"
 #include "tuning/clusterer.h"
 #include "tuning/sample.h"
@@ -257,6 +261,59 @@ ItemPointer DataTable::GetEmptyTupleSlot(const storage::Tuple *tuple) {
   return location;
 }
 
+// the batched version of GetEmptyTupleSlot(). the recycled slots are used up
+// first, and the rest of the tuples go into consecutive slots of the active
+// tile group, taking as many slots at once as the tile group has left.
+void DataTable::GetEmptyTupleSlots(
+    const std::vector<const AbstractTuple *> &tuples,
+    std::vector<ItemPointer> &locations) {
+  locations.clear();
+  locations.reserve(tuples.size());
+
+  //=============== garbage collection==================
+  // check if there are recycled tuple slots
+  auto &gc_manager = gc::GCManagerFactory::GetInstance();
+  size_t next = 0;
+  while (next < tuples.size()) {
+    auto free_item_pointer = gc_manager.ReturnFreeSlot(this->table_oid);
+    if (free_item_pointer.IsNull()) {
+      break;
+    }
+    auto tile_group = storage::StorageManager::GetInstance()->GetTileGroup(
+        free_item_pointer.block);
+    tile_group->CopyTuple(tuples[next++], free_item_pointer.offset);
+    locations.push_back(free_item_pointer);
+  }
+  //====================================================
+
+  size_t active_tile_group_id = number_of_tuples_ % active_tilegroup_count_;
+  while (next < tuples.size()) {
+    auto tile_group = active_tile_groups_[active_tile_group_id];
+
+    oid_t first_slot = INVALID_OID;
+    oid_t count = tile_group->InsertTuples(tuples, next, tuples.size() - next,
+                                           first_slot);
+    // the tile group is full, wait for the next one to be allocated
+    if (count == 0) {
+      continue;
+    }
+
+    oid_t tile_group_id = tile_group->GetTileGroupId();
+    for (oid_t slot_itr = 0; slot_itr < count; slot_itr++) {
+      locations.emplace_back(tile_group_id, first_slot + slot_itr);
+    }
+    next += count;
+
+    // if we got the last tuple slot, then create a new tile group
+    if (first_slot + count == tile_group->GetAllocatedTupleCount()) {
+      AddDefaultTileGroup(active_tile_group_id);
+    }
+
+    LOG_TRACE("tile group count: %lu, tile group id: %u, slots: %u + %u",
+              tile_group_count_.load(), tile_group_id, first_slot, count);
+  }
+}
+
 //===--------------------------------------------------------------------===//
 // INSERT
 //===--------------------------------------------------------------------===//
@@ -371,6 +428,62 @@ bool DataTable::InsertTuple(const AbstractTuple *tuple, ItemPointer location,
   return true;
 }
 
+bool DataTable::InsertTuples(const std::vector<const AbstractTuple *> &tuples,
+                             concurrency::TransactionContext *transaction,
+                             std::vector<ItemPointer> &locations,
+                             std::vector<ItemPointer *> &index_entry_ptrs,
+                             bool check_fk) {
+  GetEmptyTupleSlots(tuples, locations);
+  return InsertTuples(tuples, locations, transaction, index_entry_ptrs,
+                      check_fk);
+}
+
+bool DataTable::InsertTuples(const std::vector<const AbstractTuple *> &tuples,
+                             const std::vector<ItemPointer> &locations,
+                             concurrency::TransactionContext *transaction,
+                             std::vector<ItemPointer *> &index_entry_ptrs,
+                             bool check_fk) {
+  for (auto tuple : tuples) {
+    if (CheckConstraints(tuple) == false) {
+      LOG_TRACE("InsertTuples(): Constraint violated");
+      return false;
+    }
+  }
+
+  if (GetIndexCount() == 0) {
+    index_entry_ptrs.assign(tuples.size(), nullptr);
+  } else {
+    AllocateIndirections(locations, index_entry_ptrs);
+  }
+
+  // The tuples must belong to the transaction before their keys reach the
+  // indexes: that way a unique check sees them as taken, and if the batch
+  // fails half-way the abort cleans up the entries inserted so far
+  auto &transaction_manager =
+      concurrency::TransactionManagerFactory::GetInstance();
+  transaction_manager.PerformInserts(transaction, locations, index_entry_ptrs);
+
+  if (GetIndexCount() != 0 &&
+      InsertInIndexes(tuples, transaction, index_entry_ptrs) == false) {
+    LOG_TRACE("Index constraint violated");
+    return false;
+  }
+
+  // ForeignKey checks
+  if (check_fk) {
+    for (auto tuple : tuples) {
+      if (CheckForeignKeyConstraints(tuple, transaction) == false) {
+        LOG_TRACE("ForeignKey constraint violated");
+        return false;
+      }
+    }
+  }
+
+  // Increase the table's number of tuples by the size of the batch
+  IncreaseTupleCount(tuples.size());
+  return true;
+}
+
 // insert tuple into a table that is without index.
 ItemPointer DataTable::InsertTuple(const storage::Tuple *tuple) {
   ItemPointer location = GetEmptyTupleSlot(tuple);
@@ -477,6 +590,96 @@ bool DataTable::InsertInIndexes(const AbstractTuple *tuple,
   return true;
 }
 
+void DataTable::AllocateIndirections(
+    const std::vector<ItemPointer> &locations,
+    std::vector<ItemPointer *> &index_entry_ptrs) {
+  size_t active_indirection_array_id =
+      number_of_tuples_ % active_indirection_array_count_;
+
+  index_entry_ptrs.resize(locations.size());
+  for (size_t tuple_itr = 0; tuple_itr < locations.size(); tuple_itr++) {
+    size_t indirection_offset = INVALID_INDIRECTION_OFFSET;
+    std::shared_ptr<IndirectionArray> active_indirection_array;
+    while (true) {
+      active_indirection_array =
+          active_indirection_arrays_[active_indirection_array_id];
+      indirection_offset = active_indirection_array->AllocateIndirection();
+
+      if (indirection_offset != INVALID_INDIRECTION_OFFSET) {
+        break;
+      }
+    }
+
+    ItemPointer *index_entry_ptr =
+        active_indirection_array->GetIndirectionByOffset(indirection_offset);
+    index_entry_ptr->block = locations[tuple_itr].block;
+    index_entry_ptr->offset = locations[tuple_itr].offset;
+    index_entry_ptrs[tuple_itr] = index_entry_ptr;
+
+    if (indirection_offset == INDIRECTION_ARRAY_MAX_SIZE - 1) {
+      AddDefaultIndirectionArray(active_indirection_array_id);
+    }
+  }
+}
+
+/**
+ * @brief Insert a batch of tuples into all indexes, like InsertInIndexes(),
+ * but filling each index with all of the keys before moving on to the next.
+ * The tuples must already have been inserted by the transaction, so that
+ * duplicates within the batch are caught too.
+ *
+ * @returns True on success, false if a visible entry exists (in case of
+ *primary/unique).
+ */
+bool DataTable::InsertInIndexes(
+    const std::vector<const AbstractTuple *> &tuples,
+    concurrency::TransactionContext *transaction,
+    const std::vector<ItemPointer *> &index_entry_ptrs) {
+  PELOTON_ASSERT(tuples.size() == index_entry_ptrs.size());
+  int index_count = GetIndexCount();
+
+  auto &transaction_manager =
+      concurrency::TransactionManagerFactory::GetInstance();
+
+  std::function<bool(const void *)> fn =
+      std::bind(&concurrency::TransactionManager::IsOccupied,
+                &transaction_manager, transaction, std::placeholders::_1);
+
+  // Since this is NOT protected by a lock, concurrent insert may happen.
+  for (int index_itr = index_count - 1; index_itr >= 0; --index_itr) {
+    auto index = GetIndex(index_itr);
+    if (index == nullptr) continue;
+    auto index_schema = index->GetKeySchema();
+    auto indexed_columns = index_schema->GetIndexedColumns();
+    auto index_type = index->GetIndexType();
+    // the index keeps its own copy of the key, so one will do for the batch
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
+
+    for (size_t tuple_itr = 0; tuple_itr < tuples.size(); tuple_itr++) {
+      key->SetFromTuple(tuples[tuple_itr], indexed_columns, index->GetPool());
+
+      bool res = true;
+      if (index_type == IndexConstraintType::PRIMARY_KEY ||
+          index_type == IndexConstraintType::UNIQUE) {
+        res =
+            index->CondInsertEntry(key.get(), index_entry_ptrs[tuple_itr], fn);
+      } else {
+        index->InsertEntry(key.get(), index_entry_ptrs[tuple_itr]);
+      }
+
+      // Handle failure
+      if (res == false) {
+        // the index entries inserted so far are removed when the transaction
+        // aborts, like those of any other tuple it inserted
+        return false;
+      }
+    }
+    LOG_TRACE("Index constraint check on %s passed.", index->GetName().c_str());
+  }
+
+  return true;
+}
+
 bool DataTable::InsertInSecondaryIndexes(
     const AbstractTuple *tuple, const TargetList *targets_ptr,
     concurrency::TransactionContext *transaction,
@@ -883,6 +1086,13 @@ oid_t DataTable::AddDefaultTileGroup(const size_t &active_tile_group_id) {
 
   tile_group_id = tile_group->GetTileGroupId();
 
+  // The tile group it replaces is full, it may be frozen once it's cold
+  const auto &full_tile_group = active_tile_groups_[active_tile_group_id];
+  if (full_tile_group != nullptr) {
+    gc::GCManagerFactory::GetInstance().AddFreezeCandidate(
+        full_tile_group->GetTileGroupId());
+  }
+
   LOG_TRACE("Added a tile group ");
   tile_groups_.Append(tile_group_id);
 
@@ -974,12 +1184,44 @@ size_t DataTable::GetTileGroupCount() const { return tile_group_count_; }
 
 std::shared_ptr<storage::TileGroup> DataTable::GetTileGroup(
     const std::size_t &tile_group_offset) const {
+  return GetTileGroupById(FindTileGroupId(tile_group_offset));
+}
+
+storage::TileGroup *DataTable::GetTileGroupPtr(
+    const std::size_t &tile_group_offset) const {
+  auto storage_manager = storage::StorageManager::GetInstance();
+  return storage_manager->GetTileGroupPtr(FindTileGroupId(tile_group_offset));
+}
+
+int DataTable::GetTileGroupNumaNode(
+    const std::size_t &tile_group_offset) const {
+  auto storage_manager = storage::StorageManager::GetInstance();
+  auto *tile_group = storage_manager->LookupTileGroupPtr(
+      tile_groups_.FindValid(tile_group_offset, invalid_tile_group_id));
+  return tile_group != nullptr ? tile_group->GetNumaNode()
+                               : NumaManager::kAnyNode;
+}
+
+oid_t DataTable::FindTileGroupId(const std::size_t &tile_group_offset) const {
   PELOTON_ASSERT(tile_group_offset < GetTileGroupCount());
 
   auto tile_group_id =
       tile_groups_.FindValid(tile_group_offset, invalid_tile_group_id);
 
-  return GetTileGroupById(tile_group_id);
+  // Scans visit tile groups in order, fetch the evicted ones ahead of them
+  auto &tiering_manager = TieringManager::GetInstance();
+  if (tiering_manager.GetNumEvicted() > 0) {
+    size_t prefetch_end = std::min(
+        tile_group_offset + TieringManager::kPrefetchDistance + 1,
+        GetTileGroupCount());
+    for (size_t offset = tile_group_offset + 1; offset < prefetch_end;
+         offset++) {
+      tiering_manager.Prefetch(
+          tile_groups_.FindValid(offset, invalid_tile_group_id));
+    }
+  }
+
+  return tile_group_id;
 }
 
 std::shared_ptr<storage::TileGroup> DataTable::GetTileGroupById(
@@ -1154,7 +1396,7 @@ std::vector<catalog::Schema> TransformTileGroupSchema(
   return new_schema;
 }
 
-// Set the transformed tile group column-at-a-time
+// Set the transformed tile group column-at-a-time. The header is shared.
 void SetTransformedTileGroup(storage::TileGroup *orig_tile_group,
                              storage::TileGroup *new_tile_group) {
   auto new_layout = new_tile_group->GetLayout();
@@ -1166,6 +1408,7 @@ void SetTransformedTileGroup(storage::TileGroup *orig_tile_group,
   UNUSED_ATTRIBUTE auto new_column_count = new_layout.GetColumnCount();
   UNUSED_ATTRIBUTE auto orig_column_count = orig_layout.GetColumnCount();
   PELOTON_ASSERT(new_column_count == orig_column_count);
+  PELOTON_ASSERT(new_tile_group->GetHeader() == orig_tile_group->GetHeader());
 
   oid_t orig_tile_offset, orig_tile_column_offset;
   oid_t new_tile_offset, new_tile_column_offset;
@@ -1184,26 +1427,21 @@ void SetTransformedTileGroup(storage::TileGroup *orig_tile_group,
     auto orig_tile = orig_tile_group->GetTile(orig_tile_offset);
     auto new_tile = new_tile_group->GetTile(new_tile_offset);
 
-    // Copy the column over to the new tile group
+    // Copy the column over to the new tile group, leaving out the slots the
+    // GC has reset
     for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
-      type::Value val =
-          (orig_tile->GetValue(tuple_itr, orig_tile_column_offset));
-      new_tile->SetValue(val, tuple_itr, new_tile_column_offset);
+      orig_tile->CopyLiveValue(tuple_itr, orig_tile_column_offset, new_tile,
+                               new_tile_column_offset);
     }
   }
-
-  // Finally, copy over the tile header
-  auto header = orig_tile_group->GetHeader();
-  auto new_header = new_tile_group->GetHeader();
-  *new_header = *header;
 }
 
-storage::TileGroup *DataTable::TransformTileGroup(
-    const oid_t &tile_group_offset, const double &theta) {
+bool DataTable::BeginTransformTileGroup(const oid_t &tile_group_offset,
+                                        const double &theta) {
   // First, check if the tile group is in this table
   if (tile_group_offset >= tile_groups_.GetSize()) {
     LOG_ERROR("Tile group offset not found in table : %u ", tile_group_offset);
-    return nullptr;
+    return false;
   }
 
   auto tile_group_id =
@@ -1212,34 +1450,94 @@ storage::TileGroup *DataTable::TransformTileGroup(
   // Get orig tile group from catalog
   auto storage_tilegroup = storage::StorageManager::GetInstance();
   auto tile_group = storage_tilegroup->GetTileGroup(tile_group_id);
+  if (tile_group == nullptr) {
+    return false;
+  }
   auto diff = tile_group->GetLayout().GetLayoutDifference(*default_layout_);
 
   // Check threshold for transformation
   if (diff < theta) {
-    return nullptr;
+    return false;
+  }
+
+  // Inserts may still be writing the tiles of a tile group that has free
+  // slots, and frozen tile groups stay as they are
+  if (tile_group->GetNextTupleSlot() < tile_group->GetAllocatedTupleCount() ||
+      !tile_group->GetHeader()->SetImmutability()) {
+    return false;
   }
 
   LOG_TRACE("Transforming tile group : %u", tile_group_offset);
 
-  // Get the schema for the new transformed tile group
-  auto new_schema =
-      TransformTileGroupSchema(tile_group.get(), *default_layout_);
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+  std::lock_guard<std::mutex> lock(transform_mutex_);
+  transforming_tile_groups_.emplace_back(tile_group_id,
+                                         epoch_manager.GetCurrentEpochId());
+  return true;
+}
 
-  // Allocate space for the transformed tile group
-  std::shared_ptr<storage::TileGroup> new_tile_group(
-      TileGroupFactory::GetTileGroup(
-          tile_group->GetDatabaseId(), tile_group->GetTableId(),
-          tile_group->GetTileGroupId(), tile_group->GetAbstractTable(),
-          new_schema, default_layout_, tile_group->GetAllocatedTupleCount()));
+size_t DataTable::FinishTransformTileGroups(eid_t expired_eid) {
+  // Take the transformations that nobody can interfere with anymore
+  std::vector<oid_t> tile_group_ids;
+  {
+    std::lock_guard<std::mutex> lock(transform_mutex_);
+    auto iter = transforming_tile_groups_.begin();
+    while (iter != transforming_tile_groups_.end()) {
+      if (iter->second <= expired_eid) {
+        tile_group_ids.push_back(iter->first);
+        iter = transforming_tile_groups_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+  size_t num_transformed = 0;
+  auto storage_tilegroup = storage::StorageManager::GetInstance();
+  for (auto tile_group_id : tile_group_ids) {
+    auto tile_group = storage_tilegroup->GetTileGroup(tile_group_id);
+    if (tile_group == nullptr) {
+      // The table was dropped meanwhile
+      continue;
+    }
+
+    // Get the schema for the new transformed tile group
+    auto new_schema =
+        TransformTileGroupSchema(tile_group.get(), *default_layout_);
 
-  // Set the transformed tile group column-at-a-time
-  SetTransformedTileGroup(tile_group.get(), new_tile_group.get());
+    // Allocate space for the transformed tile group
+    std::shared_ptr<storage::TileGroup> new_tile_group(
+        TileGroupFactory::GetTransformedTileGroup(*tile_group, new_schema,
+                                                  default_layout_));
 
-  // Set the location of the new tile group
-  // and clean up the orig tile group
-  storage_tilegroup->AddTileGroup(tile_group_id, new_tile_group);
+    // Set the transformed tile group column-at-a-time
+    SetTransformedTileGroup(tile_group.get(), new_tile_group.get());
+
+    // Set the location of the new tile group, and retire the orig tile group
+    storage_tilegroup->AddTileGroup(tile_group_id, new_tile_group);
+    auto header = new_tile_group->GetHeader();
+    header->SetTileGroup(new_tile_group.get());
+
+    // The GC reclaims the values of the tile group it finds once it has reset
+    // a slot. Slots reset after their values were copied, but before the new
+    // tile group was in place, leave the copies to us.
+    auto tuple_count = new_tile_group->GetAllocatedTupleCount();
+    for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      if (header->GetTransactionId(tuple_itr) != INVALID_TXN_ID) {
+        continue;
+      }
+      for (oid_t tile_itr = 0; tile_itr < new_tile_group->GetTileCount();
+           tile_itr++) {
+        new_tile_group->GetTile(tile_itr)->ReclaimVarlenColumns(tuple_itr);
+      }
+    }
+
+    // Its slots can be recycled again
+    header->ResetImmutability();
+    num_transformed++;
+  }
 
-  return new_tile_group.get();
+  return num_transformed;
 }
 
 void DataTable::RecordLayoutSample(const tuning::Sample &sample) {
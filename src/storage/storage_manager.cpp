@@ -12,18 +12,29 @@
 
 #include "storage/storage_manager.h"
 
+#include "concurrency/epoch_manager_factory.h"
+#include "gc/gc_manager_factory.h"
 #include "storage/database.h"
 #include "storage/data_table.h"
 #include "storage/tile_group.h"
+#include "storage/tiering_manager.h"
 
 namespace peloton {
 namespace storage {
 
 std::shared_ptr<storage::TileGroup> StorageManager::empty_tile_group_;
 
-StorageManager::StorageManager() = default;
+StorageManager::StorageManager() {
+  for (auto &chunk : tile_group_chunks_) {
+    chunk.store(nullptr);
+  }
+}
 
-StorageManager::~StorageManager() = default;
+StorageManager::~StorageManager() {
+  for (auto &chunk : tile_group_chunks_) {
+    delete[] chunk.load();
+  }
+}
 
 // Get instance of the global catalog storage manager
 StorageManager *StorageManager::GetInstance() {
@@ -123,25 +134,107 @@ bool StorageManager::RemoveDatabaseFromStorageManager(oid_t database_oid) {
 
 void StorageManager::AddTileGroup(const oid_t oid,
                            std::shared_ptr<storage::TileGroup> location) {
+  // Readers may still be looking at a tile group that is replaced
+  std::shared_ptr<storage::TileGroup> old_location;
+  if (tile_group_locator_.Find(oid, old_location) &&
+      old_location != location) {
+    RetireTileGroup(old_location);
+  }
+
   // add/update the catalog reference to the tile group
   tile_group_locator_.Upsert(oid, location);
+  SetTileGroupPtr(oid, location.get());
 }
 
 void StorageManager::DropTileGroup(const oid_t oid) {
+  std::shared_ptr<storage::TileGroup> location;
+  if (tile_group_locator_.Find(oid, location)) {
+    SetTileGroupPtr(oid, nullptr);
+    RetireTileGroup(location);
+  }
+
   // drop the catalog reference to the tile group
   tile_group_locator_.Erase(oid);
 }
 
+storage::TileGroup *StorageManager::SetTileGroupPtr(
+    const oid_t oid, storage::TileGroup *tile_group) {
+  auto &chunk_ptr = tile_group_chunks_[oid >> kTileGroupChunkBits];
+  auto *chunk = chunk_ptr.load(std::memory_order_acquire);
+  if (chunk == nullptr) {
+    if (tile_group == nullptr) {
+      return nullptr;
+    }
+    // Whoever installs the chunk first wins
+    auto *new_chunk =
+        new std::atomic<storage::TileGroup *>[kTileGroupChunkSize];
+    for (uint32_t slot = 0; slot < kTileGroupChunkSize; slot++) {
+      new_chunk[slot].store(nullptr, std::memory_order_relaxed);
+    }
+    if (chunk_ptr.compare_exchange_strong(chunk, new_chunk,
+                                          std::memory_order_acq_rel)) {
+      chunk = new_chunk;
+    } else {
+      delete[] new_chunk;
+    }
+  }
+  return chunk[oid & (kTileGroupChunkSize - 1)].exchange(
+      tile_group, std::memory_order_acq_rel);
+}
+
+void StorageManager::RetireTileGroup(
+    std::shared_ptr<storage::TileGroup> tile_group) {
+  // Readers may still hold a raw pointer to the tile group, so it has to
+  // outlive the current epoch whether or not a garbage collector is running
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+  eid_t current_eid = epoch_manager.GetCurrentEpochId();
+  {
+    std::lock_guard<std::mutex> guard{dropped_lock_};
+    dropped_tile_groups_.emplace_back(current_eid, std::move(tile_group));
+  }
+
+  // The garbage collector releases the retired tile groups as their epochs
+  // expire. Without one, each retirement releases the expired ones instead.
+  if (!gc::GCManagerFactory::GetInstance().GetStatus()) {
+    ReleaseDroppedTileGroups(epoch_manager.GetExpiredEpochId());
+  }
+}
+
+size_t StorageManager::ReleaseDroppedTileGroups(eid_t expired_eid) {
+  // Destroy the tile groups outside of the lock
+  std::vector<std::shared_ptr<storage::TileGroup>> released;
+  {
+    std::lock_guard<std::mutex> guard{dropped_lock_};
+    size_t num_kept = 0;
+    for (auto &entry : dropped_tile_groups_) {
+      if (entry.first <= expired_eid) {
+        released.push_back(std::move(entry.second));
+      } else {
+        dropped_tile_groups_[num_kept++] = std::move(entry);
+      }
+    }
+    dropped_tile_groups_.resize(num_kept);
+  }
+  return released.size();
+}
+
 std::shared_ptr<storage::TileGroup> StorageManager::GetTileGroup(const oid_t oid) {
   std::shared_ptr<storage::TileGroup> location;
   if (tile_group_locator_.Find(oid, location)) {
+    // Bring the tiles back in if they were evicted
+    TieringManager::GetInstance().Access(*location);
     return location;
   }
   return empty_tile_group_;
 }
 
 // used for logging test
-void StorageManager::ClearTileGroup() { tile_group_locator_.Clear(); }
+void StorageManager::ClearTileGroup() {
+  tile_group_locator_.Clear();
+  for (auto &chunk : tile_group_chunks_) {
+    delete[] chunk.exchange(nullptr);
+  }
+}
 
 }  // namespace storage
 }  // namespace peloton
@@ -0,0 +1,295 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tiering_manager.cpp
+//
+// Identification: src/storage/tiering_manager.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/tiering_manager.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "concurrency/epoch_manager_factory.h"
+#include "settings/settings_manager.h"
+#include "storage/tile.h"
+#include "threadpool/mono_queue_pool.h"
+#include "type/serializeio.h"
+
+namespace peloton {
+namespace storage {
+
+// The offset of a candidate that isn't on file
+static constexpr off_t kNotOnFile = -1;
+
+TieringManager &TieringManager::GetInstance() {
+  static TieringManager tiering_manager;
+  return tiering_manager;
+}
+
+TieringManager::TieringManager()
+    : fd_(-1),
+      file_end_(0),
+      start_time_(std::chrono::steady_clock::now()),
+      clock_(0),
+      num_evicted_(0) {}
+
+TieringManager::~TieringManager() {
+  if (fd_ != -1) {
+    close(fd_);
+  }
+}
+
+bool TieringManager::OpenFile() {
+  if (fd_ != -1) {
+    return true;
+  }
+  std::string file_name =
+      settings::SettingsManager::GetString(settings::SettingId::tiering_file);
+  fd_ = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if (fd_ == -1) {
+    LOG_ERROR("Could not open tiering file %s: %s", file_name.c_str(),
+              strerror(errno));
+    return false;
+  }
+  LOG_INFO("Evicting cold tile groups to %s", file_name.c_str());
+  return true;
+}
+
+void TieringManager::AddCandidate(
+    const std::shared_ptr<TileGroup> &tile_group) {
+  std::lock_guard<std::mutex> guard{lock_};
+  candidates_.emplace(
+      tile_group->GetTileGroupId(),
+      Candidate{tile_group, kNotOnFile, 0, INVALID_EID, false, false});
+}
+
+//===----------------------------------------------------------------------===//
+// Eviction
+//===----------------------------------------------------------------------===//
+
+size_t TieringManager::EvictColdTileGroups(eid_t expired_eid) {
+  uint64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                     std::chrono::steady_clock::now() - start_time_)
+                     .count();
+  clock_.store(now);
+  if (!OpenFile()) {
+    return 0;
+  }
+  uint64_t cold_seconds = settings::SettingsManager::GetInt(
+      settings::SettingId::tiering_cold_seconds);
+
+  // Find the tile groups to work on, and forget the dropped ones
+  std::vector<std::shared_ptr<TileGroup>> cold, evicting;
+  {
+    std::lock_guard<std::mutex> guard{lock_};
+    for (auto iter = candidates_.begin(); iter != candidates_.end();) {
+      auto tile_group = iter->second.tile_group.lock();
+      if (tile_group == nullptr) {
+        if (iter->second.evicted) {
+          num_evicted_--;
+        }
+        ReleaseRegion(iter->second);
+        iter = candidates_.erase(iter);
+        continue;
+      }
+      auto residency = tile_group->GetResidency();
+      if (residency == TileGroup::Residency::Resident &&
+          now - std::min(now, tile_group->GetLastAccess()) >= cold_seconds) {
+        cold.push_back(tile_group);
+      } else if (residency == TileGroup::Residency::Evicting &&
+                 iter->second.epoch_id <= expired_eid) {
+        evicting.push_back(tile_group);
+      }
+      ++iter;
+    }
+  }
+
+  size_t num_evicted = 0;
+  for (auto &tile_group : evicting) {
+    if (FinishEviction(*tile_group)) {
+      num_evicted++;
+    }
+  }
+  for (auto &tile_group : cold) {
+    BeginEviction(*tile_group);
+  }
+  return num_evicted;
+}
+
+bool TieringManager::BeginEviction(TileGroup &tile_group) {
+  std::lock_guard<std::mutex> tile_group_guard{tile_group.tile_group_mutex};
+  if (tile_group.GetResidency() != TileGroup::Residency::Resident) {
+    return false;
+  }
+
+  CopySerializeOutput output;
+  for (oid_t tile_itr = 0; tile_itr < tile_group.GetTileCount(); tile_itr++) {
+    tile_group.GetTile(tile_itr)->SerializeValuesTo(output);
+  }
+
+  // Each tile group gets the next region of the file. The regions of the
+  // tile groups that come back are punched out of it.
+  off_t offset;
+  {
+    std::lock_guard<std::mutex> guard{lock_};
+    offset = file_end_;
+    file_end_ += output.Size();
+  }
+  size_t written = 0;
+  while (written < output.Size()) {
+    ssize_t ret = pwrite(fd_, output.Data() + written, output.Size() - written,
+                         offset + written);
+    if (ret <= 0) {
+      LOG_ERROR("Could not evict tile group %u: %s",
+                tile_group.GetTileGroupId(), strerror(errno));
+      return false;
+    }
+    written += ret;
+  }
+
+  // The epoch is read only once the tile group is Evicting. Every reader
+  // that found it Resident started in this epoch or before, so the tiles are
+  // freed only after all of them are gone.
+  tile_group.residency_.store(TileGroup::Residency::Evicting);
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+  eid_t epoch_id = epoch_manager.GetCurrentEpochId();
+  {
+    std::lock_guard<std::mutex> guard{lock_};
+    auto iter = candidates_.find(tile_group.GetTileGroupId());
+    PELOTON_ASSERT(iter != candidates_.end());
+    iter->second.offset = offset;
+    iter->second.size = output.Size();
+    iter->second.epoch_id = epoch_id;
+    iter->second.prefetching = false;
+  }
+  LOG_TRACE("Evicting tile group %u to [%zu, %zu)", tile_group.GetTileGroupId(),
+            static_cast<size_t>(offset), offset + output.Size());
+  return true;
+}
+
+bool TieringManager::FinishEviction(TileGroup &tile_group) {
+  std::lock_guard<std::mutex> tile_group_guard{tile_group.tile_group_mutex};
+  if (tile_group.GetResidency() != TileGroup::Residency::Evicting) {
+    // The tile group was accessed meanwhile
+    return false;
+  }
+  for (oid_t tile_itr = 0; tile_itr < tile_group.GetTileCount(); tile_itr++) {
+    tile_group.GetTile(tile_itr)->Evict();
+  }
+  tile_group.residency_.store(TileGroup::Residency::Evicted);
+  {
+    std::lock_guard<std::mutex> guard{lock_};
+    candidates_.at(tile_group.GetTileGroupId()).evicted = true;
+  }
+  num_evicted_++;
+  LOG_DEBUG("Evicted tile group %u", tile_group.GetTileGroupId());
+  return true;
+}
+
+void TieringManager::ReleaseRegion(Candidate &candidate) {
+  if (candidate.offset == kNotOnFile) {
+    return;
+  }
+  // Failing to punch the hole only wastes space
+  if (fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                candidate.offset, candidate.size) != 0) {
+    LOG_TRACE("Could not punch hole in tiering file: %s", strerror(errno));
+  }
+  candidate.offset = kNotOnFile;
+  candidate.size = 0;
+  candidate.epoch_id = INVALID_EID;
+}
+
+//===----------------------------------------------------------------------===//
+// Fault-in
+//===----------------------------------------------------------------------===//
+
+void TieringManager::FaultIn(TileGroup &tile_group) {
+  std::lock_guard<std::mutex> tile_group_guard{tile_group.tile_group_mutex};
+  auto residency = tile_group.GetResidency();
+  if (residency == TileGroup::Residency::Resident) {
+    // Somebody else brought it back
+    return;
+  }
+
+  off_t offset;
+  size_t size;
+  {
+    std::lock_guard<std::mutex> guard{lock_};
+    auto iter = candidates_.find(tile_group.GetTileGroupId());
+    PELOTON_ASSERT(iter != candidates_.end());
+    if (residency == TileGroup::Residency::Evicting) {
+      // The tiles are still in memory, the copy on file is not needed
+      ReleaseRegion(iter->second);
+      tile_group.residency_.store(TileGroup::Residency::Resident);
+      return;
+    }
+    offset = iter->second.offset;
+    size = iter->second.size;
+  }
+
+  std::unique_ptr<char[]> buffer{new char[size]};
+  size_t num_read = 0;
+  while (num_read < size) {
+    ssize_t ret =
+        pread(fd_, buffer.get() + num_read, size - num_read, offset + num_read);
+    if (ret <= 0) {
+      throw Exception("Could not read evicted tile group " +
+                      std::to_string(tile_group.GetTileGroupId()) + ": " +
+                      strerror(errno));
+    }
+    num_read += ret;
+  }
+
+  ReferenceSerializeInput input{buffer.get(), size};
+  for (oid_t tile_itr = 0; tile_itr < tile_group.GetTileCount(); tile_itr++) {
+    tile_group.GetTile(tile_itr)->Restore(input);
+  }
+  tile_group.residency_.store(TileGroup::Residency::Resident);
+  num_evicted_--;
+
+  {
+    std::lock_guard<std::mutex> guard{lock_};
+    auto &candidate = candidates_.at(tile_group.GetTileGroupId());
+    ReleaseRegion(candidate);
+    candidate.evicted = false;
+    candidate.prefetching = false;
+  }
+  LOG_DEBUG("Faulted in tile group %u", tile_group.GetTileGroupId());
+}
+
+void TieringManager::Prefetch(oid_t tile_group_id) {
+  std::shared_ptr<TileGroup> tile_group;
+  {
+    std::lock_guard<std::mutex> guard{lock_};
+    auto iter = candidates_.find(tile_group_id);
+    if (iter == candidates_.end() || iter->second.prefetching) {
+      return;
+    }
+    tile_group = iter->second.tile_group.lock();
+    if (tile_group == nullptr ||
+        tile_group->GetResidency() != TileGroup::Residency::Evicted) {
+      return;
+    }
+    iter->second.prefetching = true;
+  }
+
+  threadpool::MonoQueuePool::GetInstance().SubmitTask(
+      [tile_group] { TieringManager::GetInstance().FaultIn(*tile_group); },
+      threadpool::TaskClass::MAINTENANCE);
+}
+
+}  // namespace storage
+}  // namespace peloton
@@ -15,13 +15,16 @@
 
 #include "catalog/schema.h"
 #include "common/exception.h"
+#include "common/logger.h"
 #include "common/macros.h"
+#include "common/numa_manager.h"
 #include "type/serializer.h"
 #include "common/internal_types.h"
-#include "type/ephemeral_pool.h"
 #include "concurrency/transaction_manager_factory.h"
 #include "storage/backend_manager.h"
+#include "storage/compressed_column.h"
 #include "storage/tile.h"
+#include "storage/tile_group.h"
 #include "storage/tile_group_header.h"
 #include "storage/tuple.h"
 #include "storage/tuple_iterator.h"
@@ -39,8 +42,14 @@ Tile::Tile(BackendType backend_type, TileGroupHeader *tile_header,
       backend_type(backend_type),
       schema(tuple_schema),
       data(NULL),
+      numa_node_(tile_group != nullptr ? tile_group->GetNumaNode()
+                                       : NumaManager::kAnyNode),
       tile_group(tile_group),
       pool(NULL),
+      compressed_column_(nullptr),
+      retired_data_(nullptr),
+      retired_pool_(nullptr),
+      retired_epoch_(INVALID_EID),
       num_tuple_slots(tuple_count),
       column_count(tuple_schema.GetColumnCount()),
       tuple_length(tuple_schema.GetLength()),
@@ -57,7 +66,8 @@ Tile::Tile(BackendType backend_type, TileGroupHeader *tile_header,
   // data = reinterpret_cast<char *>(
   // storage_manager.Allocate(backend_type, tile_size));
 
-  data = new char[tile_size];
+  data = reinterpret_cast<char *>(
+      BackendManager::GetInstance().AllocatePages(tile_size, numa_node_));
   PELOTON_ASSERT(data != NULL);
 
   // zero out the data
@@ -65,7 +75,7 @@ Tile::Tile(BackendType backend_type, TileGroupHeader *tile_header,
 
   // allocate pool for blob storage if schema not inlined
   // if (schema.IsInlined() == false) {
-  pool = new type::EphemeralPool();
+  pool = new type::ArenaPool();
   //}
 }
 
@@ -74,7 +84,7 @@ Tile::~Tile() {
   // auto &storage_manager = storage::StorageManager::GetInstance();
   // storage_manager.Release(backend_type, data);
 
-  delete[] data;
+  BackendManager::GetInstance().ReleasePages(data, tile_size, numa_node_);
   data = NULL;
 
   // reclaim the tile memory (UNINLINED data)
@@ -83,6 +93,10 @@ Tile::~Tile() {
   //}
   pool = NULL;
 
+  // reclaim the compressed data, and what it replaced
+  delete compressed_column_.load();
+  delete retired_pool_;
+
   // clear any cached column headers
   if (column_header) delete column_header;
   column_header = NULL;
@@ -116,6 +130,13 @@ type::Value Tile::GetValue(const oid_t tuple_offset, const oid_t column_id) {
 
   const type::TypeId column_type = schema.GetType(column_id);
 
+  // Integer encodings replace the tile's data
+  const CompressedColumn *compressed = compressed_column_.load();
+  if (compressed != nullptr &&
+      compressed->GetEncoding() != CompressedColumn::Encoding::Dictionary) {
+    return compressed->GetValue(tuple_offset);
+  }
+
   const char *tuple_location = GetTupleLocation(tuple_offset);
   const char *field_location = tuple_location + schema.GetOffset(column_id);
   const bool is_inlined = schema.IsInlined(column_id);
@@ -135,6 +156,12 @@ type::Value Tile::GetValueFast(const oid_t tuple_offset,
   PELOTON_ASSERT(tuple_offset < GetAllocatedTupleCount());
   PELOTON_ASSERT(column_offset < schema.GetLength());
 
+  const CompressedColumn *compressed = compressed_column_.load();
+  if (compressed != nullptr &&
+      compressed->GetEncoding() != CompressedColumn::Encoding::Dictionary) {
+    return compressed->GetValue(tuple_offset);
+  }
+
   const char *tuple_location = GetTupleLocation(tuple_offset);
   const char *field_location = tuple_location + column_offset;
 
@@ -197,6 +224,16 @@ Tile *Tile::CopyTile(BackendType backend_type) {
       backend_type, INVALID_OID, INVALID_OID, INVALID_OID, INVALID_OID,
       new_header, *schema, tile_group, allocated_tuple_count);
 
+  // Compressed tiles have a single column, whose values are decoded
+  const CompressedColumn *compressed = GetCompressedColumn();
+  if (compressed != nullptr) {
+    for (oid_t tuple_itr = 0; tuple_itr < compressed->GetTupleCount();
+         tuple_itr++) {
+      new_tile->SetValue(GetValue(tuple_itr, 0), tuple_itr, 0);
+    }
+    return new_tile;
+  }
+
   PELOTON_MEMCPY(static_cast<void *>(new_tile->data), static_cast<void *>(data),
             tile_size);
 
@@ -221,6 +258,207 @@ Tile *Tile::CopyTile(BackendType backend_type) {
   return new_tile;
 }
 
+//===--------------------------------------------------------------------===//
+// Variable-length data
+//===--------------------------------------------------------------------===//
+
+void Tile::ReclaimVarlenColumns(oid_t tuple_offset) {
+  varlen_latch_.Lock();
+  if (data == nullptr || GetCompressedColumn() != nullptr) {
+    // The values of compressed and evicted tiles go with the whole tile
+    varlen_latch_.Unlock();
+    return;
+  }
+  char *tuple_location = GetTupleLocation(tuple_offset);
+  for (oid_t col_itr = 0; col_itr < column_count; col_itr++) {
+    type::TypeId type_id = schema.GetType(col_itr);
+    if ((type_id != type::TypeId::VARCHAR &&
+         type_id != type::TypeId::VARBINARY) ||
+        schema.IsInlined(col_itr)) {
+      // Not of varlen type, or is inlined, skip
+      continue;
+    }
+    // Get the raw varlen pointer
+    char *field_location = tuple_location + schema.GetOffset(col_itr);
+    char *varlen_ptr = type::Value::GetDataFromStorage(type_id, field_location);
+    // Call the corresponding varlen pool free, and forget the value, so that
+    // neither evacuation nor tiering touches the freed memory again
+    if (varlen_ptr != nullptr) {
+      pool->Free(varlen_ptr);
+      *reinterpret_cast<char **>(field_location) = nullptr;
+    }
+  }
+  varlen_latch_.Unlock();
+}
+
+size_t Tile::EvacuateVarlenColumns() {
+  size_t num_moved = 0;
+  oid_t num_tuples = GetAllocatedTupleCount();
+  for (oid_t tuple_itr = 0; tuple_itr < num_tuples; tuple_itr++) {
+    char *tuple_location = GetTupleLocation(tuple_itr);
+    varlen_latch_.Lock();
+    for (oid_t col_itr = 0; col_itr < column_count; col_itr++) {
+      type::TypeId type_id = schema.GetType(col_itr);
+      if ((type_id != type::TypeId::VARCHAR &&
+           type_id != type::TypeId::VARBINARY) ||
+          schema.IsInlined(col_itr)) {
+        continue;
+      }
+      auto **field =
+          reinterpret_cast<char **>(tuple_location + schema.GetOffset(col_itr));
+      char *old_ptr = *field;
+      if (old_ptr == nullptr || !pool->IsEvacuating(old_ptr)) {
+        continue;
+      }
+
+      // Readers may hold on to the old copy until the chunk it lives in is
+      // released, so copy the value and swing the pointer over. If a writer
+      // replaced the value meanwhile, the copy is not needed.
+      size_t size = pool->GetAllocationSize(old_ptr);
+      auto *new_ptr = static_cast<char *>(pool->Allocate(size));
+      PELOTON_MEMCPY(new_ptr, old_ptr, size);
+      if (__sync_bool_compare_and_swap(field, old_ptr, new_ptr)) {
+        pool->Free(old_ptr);
+        num_moved++;
+      } else {
+        pool->Free(new_ptr);
+      }
+    }
+    varlen_latch_.Unlock();
+  }
+  return num_moved;
+}
+
+bool Tile::CopyLiveValue(oid_t tuple_offset, oid_t column_id, Tile *dest_tile,
+                         oid_t dest_column_id) {
+  // The GC resets the header of a slot before it reclaims the values, so a
+  // slot that is still live under the latch keeps its values until we are
+  // done with them
+  varlen_latch_.Lock();
+  bool live = tile_group_header->GetTransactionId(tuple_offset) !=
+              INVALID_TXN_ID;
+  if (live) {
+    dest_tile->SetValue(GetValue(tuple_offset, column_id), tuple_offset,
+                        dest_column_id);
+  }
+  varlen_latch_.Unlock();
+  return live;
+}
+
+//===--------------------------------------------------------------------===//
+// Compression
+//===--------------------------------------------------------------------===//
+
+bool Tile::Compress(oid_t num_tuples, eid_t epoch_id) {
+  PELOTON_ASSERT(GetCompressedColumn() == nullptr);
+  PELOTON_ASSERT(num_tuples <= num_tuple_slots);
+  std::unique_ptr<CompressedColumn> column =
+      CompressedColumn::Encode(*this, num_tuples);
+  if (column == nullptr) {
+    return false;
+  }
+
+  if (column->GetEncoding() == CompressedColumn::Encoding::Dictionary) {
+    // Point every slot to its entry in the dictionary. The pool with the old
+    // copies of the values is retired as a whole.
+    varlen_latch_.Lock();
+    for (oid_t tuple_itr = 0; tuple_itr < num_tuples; tuple_itr++) {
+      auto **field =
+          reinterpret_cast<const char **>(GetTupleLocation(tuple_itr));
+      const char *varlen = *field;
+      if (varlen != nullptr) {
+        uint32_t len = *reinterpret_cast<const uint32_t *>(varlen);
+        *field = column->LookupEntry(varlen + sizeof(uint32_t), len);
+        PELOTON_ASSERT(*field != nullptr);
+      }
+    }
+    retired_pool_ = pool;
+    pool = new type::ArenaPool();
+    varlen_latch_.Unlock();
+  } else {
+    // The data stays until no reader can be looking at it anymore
+    retired_data_ = data;
+  }
+
+  retired_epoch_ = epoch_id;
+  LOG_TRACE("Compressed tile %u of tile group %u to %zu bytes", tile_id,
+            tile_group_id, column->GetFootprint());
+  compressed_column_.store(column.release());
+  if (epoch_id == INVALID_EID) {
+    FreeRetiredMemory();
+  }
+  return true;
+}
+
+bool Tile::ReleaseRetiredMemory(eid_t expired_epoch_id) {
+  pool->ReleaseRetiredChunks(expired_epoch_id);
+
+  if (retired_epoch_ != INVALID_EID && retired_epoch_ <= expired_epoch_id) {
+    FreeRetiredMemory();
+  }
+
+  return retired_epoch_ != INVALID_EID || pool->GetNumRetiredChunks() != 0;
+}
+
+void Tile::FreeRetiredMemory() {
+  if (retired_data_ != nullptr) {
+    data = nullptr;
+    BackendManager::GetInstance().ReleasePages(retired_data_, tile_size,
+                                               numa_node_);
+    retired_data_ = nullptr;
+  }
+  delete retired_pool_;
+  retired_pool_ = nullptr;
+  retired_epoch_ = INVALID_EID;
+}
+
+//===--------------------------------------------------------------------===//
+// Tiering
+//===--------------------------------------------------------------------===//
+
+void Tile::SerializeValuesTo(SerializeOutput &output) {
+  output.WriteBool(GetCompressedColumn() != nullptr);
+  for (oid_t tuple_itr = 0; tuple_itr < num_tuple_slots; tuple_itr++) {
+    for (oid_t col_itr = 0; col_itr < column_count; col_itr++) {
+      GetValue(tuple_itr, col_itr).SerializeTo(output);
+    }
+  }
+}
+
+void Tile::Evict() {
+  // Retired memory is released before a tile group can be evicted
+  PELOTON_ASSERT(retired_epoch_ == INVALID_EID);
+  varlen_latch_.Lock();
+  delete compressed_column_.exchange(nullptr);
+  BackendManager::GetInstance().ReleasePages(data, tile_size, numa_node_);
+  data = nullptr;
+  delete pool;
+  pool = new type::ArenaPool();
+  varlen_latch_.Unlock();
+}
+
+void Tile::Restore(SerializeInput &input) {
+  PELOTON_ASSERT(IsEvicted());
+  bool compressed = input.ReadBool();
+
+  varlen_latch_.Lock();
+  data = reinterpret_cast<char *>(
+      BackendManager::GetInstance().AllocatePages(tile_size, numa_node_));
+  PELOTON_MEMSET(data, 0, tile_size);
+  for (oid_t tuple_itr = 0; tuple_itr < num_tuple_slots; tuple_itr++) {
+    for (oid_t col_itr = 0; col_itr < column_count; col_itr++) {
+      SetValue(type::Value::DeserializeFrom(input, schema.GetType(col_itr)),
+               tuple_itr, col_itr);
+    }
+  }
+  varlen_latch_.Unlock();
+
+  // Nobody sees the tile until it has been restored
+  if (compressed) {
+    Compress(num_tuple_slots, INVALID_EID);
+  }
+}
+
 //===--------------------------------------------------------------------===//
 // Utilities
 //===--------------------------------------------------------------------===//
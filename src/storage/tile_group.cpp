@@ -18,6 +18,7 @@
 #include "common/container_tuple.h"
 #include "common/internal_types.h"
 #include "common/logger.h"
+#include "common/numa_manager.h"
 #include "common/platform.h"
 #include "storage/abstract_table.h"
 #include "storage/layout.h"
@@ -30,17 +31,23 @@ namespace peloton {
 namespace storage {
 
 TileGroup::TileGroup(BackendType backend_type,
-                     TileGroupHeader *tile_group_header, AbstractTable *table,
+                     std::shared_ptr<TileGroupHeader> tile_group_header,
+                     AbstractTable *table,
                      const std::vector<catalog::Schema> &schemas,
                      std::shared_ptr<const Layout> layout, int tuple_count)
     : database_id(INVALID_OID),
       table_id(INVALID_OID),
       tile_group_id(INVALID_OID),
       backend_type(backend_type),
-      tile_group_header(tile_group_header),
+      tile_group_header(tile_group_header.get()),
+      tile_group_header_ref_(tile_group_header),
       table(table),
       num_tuple_slots_(tuple_count),
-      tile_group_layout_(layout) {
+      tile_group_layout_(layout),
+      residency_(Residency::Resident),
+      last_access_(0),
+      numa_node_(NumaManager::GetInstance().ChooseTileGroupNode(
+          table != nullptr ? table->GetTileGroupCount() : 0)) {
   tile_count_ = schemas.size();
   for (oid_t tile_itr = 0; tile_itr < tile_count_; tile_itr++) {
     StorageManager *storage_manager = storage::StorageManager::GetInstance();
@@ -48,7 +55,7 @@ TileGroup::TileGroup(BackendType backend_type,
 
     std::shared_ptr<Tile> tile(storage::TileFactory::GetTile(
         backend_type, database_id, table_id, tile_group_id, tile_id,
-        tile_group_header, schemas[tile_itr], this, tuple_count));
+        this->tile_group_header, schemas[tile_itr], this, tuple_count));
 
     // Add a reference to the tile in the tile group
     tiles.push_back(tile);
@@ -56,10 +63,8 @@ TileGroup::TileGroup(BackendType backend_type,
 }
 
 TileGroup::~TileGroup() {
-  // Drop references on all tiles
-
-  // clean up tile group header
-  delete tile_group_header;
+  // Drop references on all tiles, and on the tile group header, which goes
+  // away with the last tile group using it
 }
 
 oid_t TileGroup::GetTileId(const oid_t tile_id) const {
@@ -100,7 +105,8 @@ oid_t TileGroup::GetActiveTupleCount() const {
 /**
  * Copy from tuple.
  */
-void TileGroup::CopyTuple(const Tuple *tuple, const oid_t &tuple_slot_id) {
+void TileGroup::CopyTuple(const AbstractTuple *tuple,
+                          const oid_t &tuple_slot_id) {
   LOG_TRACE("Tile Group Id :: %u status :: %u out of %u slots ", tile_group_id,
             tuple_slot_id, num_tuple_slots_);
 
@@ -162,6 +168,52 @@ oid_t TileGroup::InsertTuple(const Tuple *tuple) {
   return tuple_slot_id;
 }
 
+/**
+ * Grab a range of slots (thread-safe) and fill in the tuples, one column at a
+ * time, so that each tile is written front to back
+ *
+ * Returns the number of tuples inserted (0 if the tile group is full)
+ */
+oid_t TileGroup::InsertTuples(const std::vector<const AbstractTuple *> &tuples,
+                              size_t begin, oid_t count, oid_t &first_slot) {
+  oid_t num_inserted =
+      tile_group_header->GetNextEmptyTupleSlots(count, first_slot);
+
+  LOG_TRACE("Tile Group Id :: %u status :: %u + %u out of %u slots ",
+            tile_group_id, first_slot, num_inserted, num_tuple_slots_);
+
+  if (num_inserted == 0) {
+    LOG_TRACE("Failed to get next empty tuple slots within tile group.");
+    return 0;
+  }
+
+  oid_t column_itr = 0;
+  for (oid_t tile_itr = 0; tile_itr < tile_count_; tile_itr++) {
+    storage::Tile *tile = GetTile(tile_itr);
+    PELOTON_ASSERT(tile);
+    const catalog::Schema *schema = tile->GetSchema();
+    oid_t tile_column_count = schema->GetColumnCount();
+
+    for (oid_t tile_column_itr = 0; tile_column_itr < tile_column_count;
+         tile_column_itr++) {
+      size_t column_offset = schema->GetOffset(tile_column_itr);
+      bool is_inlined = schema->IsInlined(tile_column_itr);
+      size_t column_length = schema->GetAppropriateLength(tile_column_itr);
+      type::TypeId column_type = schema->GetType(tile_column_itr);
+      for (oid_t tuple_itr = 0; tuple_itr < num_inserted; tuple_itr++) {
+        type::Value val = tuples[begin + tuple_itr]->GetValue(column_itr);
+        if (val.GetTypeId() != column_type) {
+          val = val.CastAs(column_type);
+        }
+        tile->SetValueFast(val, first_slot + tuple_itr, column_offset,
+                           is_inlined, column_length);
+      }
+      column_itr++;
+    }
+  }
+  return num_inserted;
+}
+
 /**
  * Grab specific slot and fill in the tuple
  * Used by recovery
@@ -332,6 +384,49 @@ void TileGroup::SetValue(type::Value &value, oid_t tuple_id,
   GetTile(tile_offset)->SetValue(value, tuple_id, tile_column_id);
 }
 
+ResultType TileGroup::Freeze(cid_t expired_cid, eid_t epoch_id) {
+  if (!tile_group_layout_->IsColumnStore()) {
+    return ResultType::FAILURE;
+  }
+  if (GetNextTupleSlot() < num_tuple_slots_) {
+    return ResultType::QUEUING;
+  }
+
+  // Stop the slots from being recycled first. A tuple that is deleted after
+  // the check below is only recycled once its epoch has expired, by which time
+  // the GC sees that the tile group is immutable.
+  bool was_immutable = !tile_group_header->SetImmutability();
+
+  for (oid_t tuple_itr = 0; tuple_itr < num_tuple_slots_; tuple_itr++) {
+    // Superseded versions and aborted inserts are reclaimed, and their slots
+    // reused. The GC offers the tile group again once a slot is reused.
+    if (tile_group_header->GetEndCommitId(tuple_itr) != MAX_CID ||
+        tile_group_header->GetTransactionId(tuple_itr) == INVALID_TXN_ID) {
+      if (!was_immutable) {
+        tile_group_header->ResetImmutability();
+      }
+      return ResultType::FAILURE;
+    }
+    if (tile_group_header->GetTransactionId(tuple_itr) != INITIAL_TXN_ID ||
+        tile_group_header->GetBeginCommitId(tuple_itr) >= expired_cid) {
+      if (!was_immutable) {
+        tile_group_header->ResetImmutability();
+      }
+      return ResultType::QUEUING;
+    }
+  }
+
+  uint32_t num_compressed = 0;
+  for (oid_t tile_itr = 0; tile_itr < tile_count_; tile_itr++) {
+    if (GetTile(tile_itr)->Compress(num_tuple_slots_, epoch_id)) {
+      num_compressed++;
+    }
+  }
+  LOG_DEBUG("Froze tile group %u, compressing %u of %u tiles", tile_group_id,
+            num_compressed, tile_count_);
+  return ResultType::SUCCESS;
+}
+
 
 std::shared_ptr<Tile> TileGroup::GetTileReference(
     const oid_t tile_offset) const {
@@ -36,7 +36,8 @@ TileGroup *TileGroupFactory::GetTileGroup(
     throw NullPointerException("Layout of the TileGroup must be non-null.");
   }
 
-  TileGroupHeader *tile_header = new TileGroupHeader(backend_type, tuple_count);
+  std::shared_ptr<TileGroupHeader> tile_header(
+      new TileGroupHeader(backend_type, tuple_count));
   TileGroup *tile_group = new TileGroup(backend_type, tile_header, table,
                                         schemas, layout, tuple_count);
 
@@ -49,5 +50,25 @@ TileGroup *TileGroupFactory::GetTileGroup(
   return tile_group;
 }
 
+TileGroup *TileGroupFactory::GetTransformedTileGroup(
+    const TileGroup &tile_group, const std::vector<catalog::Schema> &schemas,
+    std::shared_ptr<const Layout> layout) {
+  if (layout == nullptr) {
+    throw NullPointerException("Layout of the TileGroup must be non-null.");
+  }
+
+  // The header keeps pointing to the tile group it belongs to until the new
+  // one takes its place
+  TileGroup *new_tile_group = new TileGroup(
+      tile_group.backend_type, tile_group.GetHeaderReference(),
+      tile_group.table, schemas, layout, tile_group.num_tuple_slots_);
+
+  new_tile_group->database_id = tile_group.database_id;
+  new_tile_group->tile_group_id = tile_group.tile_group_id;
+  new_tile_group->table_id = tile_group.table_id;
+
+  return new_tile_group;
+}
+
 }  // namespace storage
 }  // namespace peloton
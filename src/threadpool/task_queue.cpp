@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// task_queue.cpp
+//
+// Identification: src/threadpool/task_queue.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "threadpool/task_queue.h"
+
+#include <algorithm>
+
+namespace peloton {
+namespace threadpool {
+
+constexpr uint64_t TaskQueue::kStride;
+
+TaskQueue::TaskQueue(size_t size, const TaskSchedulerConfig &config)
+    : scheduled_(NeedsScheduling(config)), config_(config) {
+  for (int i = 0; i < NUM_TASK_CLASSES; i++) {
+    queues_[i].reset(new LockFreeQueue<Entry>(size));
+    class_queued_count_[i] = 0;
+    running_count_[i] = 0;
+    queue_latencies_[i].reset(new stats::LatencyMetric(
+        MetricType::LATENCY, TASK_QUEUE_LATENCY_HISTORY));
+    pass_[i] = 0;
+  }
+}
+
+void TaskQueue::SetConfig(const TaskSchedulerConfig &config) {
+  std::lock_guard<std::mutex> lock(schedule_lock_);
+  config_ = config;
+  scheduled_ = NeedsScheduling(config);
+}
+
+bool TaskQueue::NeedsScheduling(const TaskSchedulerConfig &config) {
+  for (int i = 0; i < NUM_TASK_CLASSES; i++) {
+    if (config.max_running[i] != 0) return true;
+    if (config.weights[i] != config.weights[0]) return true;
+  }
+  return false;
+}
+
+void TaskQueue::Enqueue(std::function<void()> &&task, TaskClass task_class) {
+  int class_id = static_cast<int>(task_class);
+  // Count the task before it becomes visible, so that a concurrent dequeue
+  // never decrements the counts below zero
+  class_queued_count_[class_id]++;
+  queued_count_++;
+  queues_[class_id]->Enqueue(
+      Entry{std::move(task), std::chrono::steady_clock::now()});
+}
+
+bool TaskQueue::Dequeue(std::function<void()> &task, TaskClass &task_class) {
+  if (IsEmpty()) return false;
+
+  Entry entry;
+  int chosen = scheduled_ ? DequeueScheduled(entry) : DequeueRoundRobin(entry);
+  if (chosen == -1) return false;
+
+  class_queued_count_[chosen]--;
+  queued_count_--;
+
+  double queue_time_ms =
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - entry.enqueue_time)
+          .count();
+  queue_latencies_[chosen]->RecordLatency(queue_time_ms);
+
+  task = std::move(entry.task);
+  task_class = static_cast<TaskClass>(chosen);
+  return true;
+}
+
+int TaskQueue::DequeueScheduled(Entry &entry) {
+  std::lock_guard<std::mutex> lock(schedule_lock_);
+
+  // Visit the classes in the order of their virtual clocks
+  int order[NUM_TASK_CLASSES];
+  for (int i = 0; i < NUM_TASK_CLASSES; i++) order[i] = i;
+  std::stable_sort(order, order + NUM_TASK_CLASSES,
+                   [this](int a, int b) { return pass_[a] < pass_[b]; });
+
+  int chosen = -1;
+  for (int class_id : order) {
+    uint32_t max_running = config_.max_running[class_id];
+    if (max_running != 0 && running_count_[class_id] >= max_running) {
+      continue;
+    }
+    if (!queues_[class_id]->Dequeue(entry)) continue;
+    chosen = class_id;
+    break;
+  }
+  if (chosen == -1) return -1;
+
+  // Classes that had nothing to run must not bank credit while idle,
+  // otherwise they would monopolize the workers once they wake up
+  uint64_t now = pass_[chosen];
+  for (int i = 0; i < NUM_TASK_CLASSES; i++) {
+    if (class_queued_count_[i] == 0) pass_[i] = std::max(pass_[i], now);
+  }
+  pass_[chosen] += kStride / std::max<uint32_t>(config_.weights[chosen], 1);
+  running_count_[chosen]++;
+  return chosen;
+}
+
+int TaskQueue::DequeueRoundRobin(Entry &entry) {
+  uint32_t first = next_class_.fetch_add(1);
+  for (int i = 0; i < NUM_TASK_CLASSES; i++) {
+    int class_id = static_cast<int>((first + i) % NUM_TASK_CLASSES);
+    if (queues_[class_id]->Dequeue(entry)) {
+      running_count_[class_id]++;
+      return class_id;
+    }
+  }
+  return -1;
+}
+
+void TaskQueue::Finish(TaskClass task_class) {
+  running_count_[static_cast<int>(task_class)]--;
+}
+
+}  // namespace threadpool
+}  // namespace peloton
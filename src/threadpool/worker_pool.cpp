@@ -13,6 +13,7 @@
 #include "threadpool/worker_pool.h"
 
 #include "common/logger.h"
+#include "common/numa_manager.h"
 
 namespace peloton {
 namespace threadpool {
@@ -20,21 +21,28 @@ namespace threadpool {
 namespace {
 
 void WorkerFunc(std::string thread_name, std::atomic_bool *is_running,
-                TaskQueue *task_queue) {
+                TaskQueue *task_queue, int numa_node) {
   constexpr auto kMinPauseTime = std::chrono::microseconds(1);
   constexpr auto kMaxPauseTime = std::chrono::microseconds(1000);
 
   LOG_INFO("Thread %s starting ...", thread_name.c_str());
 
+  if (numa_node != NumaManager::kAnyNode) {
+    NumaManager::GetInstance().BindCurrentThread(
+        static_cast<uint32_t>(numa_node));
+  }
+
   auto pause_time = kMinPauseTime;
   while (is_running->load() || !task_queue->IsEmpty()) {
     std::function<void()> task;
-    if (!task_queue->Dequeue(task)) {
+    TaskClass task_class;
+    if (!task_queue->Dequeue(task, task_class)) {
       // Polling with exponential back-off
       std::this_thread::sleep_for(pause_time);
       pause_time = std::min(pause_time * 2, kMaxPauseTime);
     } else {
       task();
+      task_queue->Finish(task_class);
       pause_time = kMinPauseTime;
     }
   }
@@ -45,18 +53,25 @@ void WorkerFunc(std::string thread_name, std::atomic_bool *is_running,
 }  // namespace
 
 WorkerPool::WorkerPool(const std::string &pool_name, uint32_t num_workers,
-                       TaskQueue &task_queue)
+                       TaskQueue &task_queue, bool numa_affinity)
     : pool_name_(pool_name),
       num_workers_(num_workers),
       is_running_(false),
-      task_queue_(task_queue) {}
+      task_queue_(task_queue),
+      numa_affinity_(numa_affinity) {}
 
 void WorkerPool::Startup() {
   bool running = false;
   if (is_running_.compare_exchange_strong(running, true)) {
+    uint32_t num_nodes = NumaManager::GetInstance().GetNumNodes();
     for (size_t i = 0; i < num_workers_; i++) {
       std::string name = pool_name_ + "-worker-" + std::to_string(i);
-      workers_.emplace_back(WorkerFunc, name, &is_running_, &task_queue_);
+      int numa_node = NumaManager::kAnyNode;
+      if (numa_affinity_ && num_nodes > 1) {
+        numa_node = static_cast<int>(i % num_nodes);
+      }
+      workers_.emplace_back(WorkerFunc, name, &is_running_, &task_queue_,
+                            numa_node);
     }
   }
 }
@@ -16,10 +16,12 @@
 
 #include "binder/bind_node_visitor.h"
 #include "common/internal_types.h"
+#include "common/plan_cache.h"
 #include "concurrency/transaction_context.h"
 #include "concurrency/transaction_manager_factory.h"
 #include "expression/expression_util.h"
 #include "optimizer/optimizer.h"
+#include "optimizer/stats/parameter_selectivity.h"
 #include "planner/plan_util.h"
 #include "settings/settings_manager.h"
 #include "threadpool/mono_queue_pool.h"
@@ -191,10 +193,12 @@ executor::ExecutionResult TrafficCop::ExecuteHelper(
   };
 
   auto &pool = threadpool::MonoQueuePool::GetInstance();
-  pool.SubmitTask([plan, txn, &params, &result_format, on_complete] {
-    executor::PlanExecutor::ExecutePlan(plan, txn, params, result_format,
-                                        on_complete);
-  });
+  pool.SubmitTask(
+      [plan, txn, &params, &result_format, on_complete] {
+        executor::PlanExecutor::ExecutePlan(plan, txn, params, result_format,
+                                            on_complete);
+      },
+      ClassifyPlan(plan.get()));
 
   is_queuing_ = true;
 
@@ -203,6 +207,49 @@ executor::ExecutionResult TrafficCop::ExecuteHelper(
   return p_status_;
 }
 
+threadpool::TaskClass TrafficCop::ClassifyPlan(
+    const planner::AbstractPlan *plan) {
+  if (plan == nullptr) return threadpool::TaskClass::OLTP;
+
+  switch (plan->GetPlanNodeType()) {
+    case PlanNodeType::ANALYZE:
+    case PlanNodeType::POPULATE_INDEX:
+    case PlanNodeType::CSVSCAN:
+    case PlanNodeType::EXPORT_EXTERNAL_FILE:
+      return threadpool::TaskClass::MAINTENANCE;
+    case PlanNodeType::SEQSCAN:
+    case PlanNodeType::NESTLOOP:
+    case PlanNodeType::MERGEJOIN:
+    case PlanNodeType::HASHJOIN:
+    case PlanNodeType::AGGREGATE:
+    case PlanNodeType::AGGREGATE_V2:
+    case PlanNodeType::ORDERBY:
+      // Use the optimizer's estimate so that small scans are not throttled
+      // together with the real analytical queries
+      if (plan->GetCardinality() >=
+          settings::SettingsManager::GetInt(
+              settings::SettingId::scheduler_olap_min_rows)) {
+        return threadpool::TaskClass::OLAP;
+      }
+      break;
+    default:
+      break;
+  }
+
+  // The heaviest child decides
+  auto task_class = threadpool::TaskClass::OLTP;
+  for (const auto &child : plan->GetChildren()) {
+    auto child_class = ClassifyPlan(child.get());
+    if (child_class == threadpool::TaskClass::MAINTENANCE) {
+      return child_class;
+    }
+    if (child_class == threadpool::TaskClass::OLAP) {
+      task_class = child_class;
+    }
+  }
+  return task_class;
+}
+
 void TrafficCop::ExecuteStatementPlanGetResult() {
   if (p_status_.m_result == ResultType::FAILURE) return;
 
@@ -248,6 +295,7 @@ void TrafficCop::ExecuteStatementPlanGetResult() {
 std::shared_ptr<Statement> TrafficCop::PrepareStatement(
     const std::string &stmt_name, const std::string &query_string,
     std::unique_ptr<parser::SQLStatementList> sql_stmt_list,
+    const std::vector<int32_t> &param_types,
     const size_t thread_id UNUSED_ATTRIBUTE) {
   LOG_TRACE("Prepare Statement query: %s", query_string.c_str());
 
@@ -272,6 +320,11 @@ std::shared_ptr<Statement> TrafficCop::PrepareStatement(
   // member variables, tcop_txn_state_. We can also get single-statement txn or
   // multi-statement txn from member variable single_statement_txn_
   auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+
+  // Taken before the transaction begins, so that a plan made against a catalog
+  // that DDL changed in the meantime is not shared
+  uint64_t plan_cache_version = PlanCache::GetInstance().GetVersion();
+
   // --multi-statements except BEGIN in a transaction
   if (!tcop_txn_state_.empty()) {
     single_statement_txn_ = false;
@@ -309,6 +362,36 @@ std::shared_ptr<Statement> TrafficCop::PrepareStatement(
     tcop_txn_state_.top().first->AddQueryString(query_string.c_str());
   }
 
+  // Only DML statements are worth sharing, everything else is either cheap to
+  // plan or has side effects in the binder. INSERT plans can't be copied (see
+  // PlanCache::IsCacheable()), so they are not looked up either.
+  bool use_plan_cache = false;
+  std::string plan_cache_key;
+  switch (query_type) {
+    case QueryType::QUERY_SELECT:
+    case QueryType::QUERY_UPDATE:
+    case QueryType::QUERY_DELETE:
+      use_plan_cache = settings::SettingsManager::GetInt(
+                           settings::SettingId::plan_cache_size) > 0;
+      break;
+    default:
+      break;
+  }
+  if (use_plan_cache) {
+    plan_cache_key =
+        PlanCache::MakeKey(default_database_name_, query_string, param_types);
+    CachedPlan cached_plan;
+    if (PlanCache::GetInstance().Find(plan_cache_key, cached_plan)) {
+      LOG_TRACE("Plan cache hit: %s", query_string.c_str());
+      statement->SetPlanTree(cached_plan.plan_tree);
+      statement->SetReferencedTables(cached_plan.table_ids);
+      statement->SetTupleDescriptor(cached_plan.tuple_descriptor);
+      statement->SetParameterPredicates(
+          std::move(cached_plan.parameter_predicates));
+      return statement;
+    }
+  }
+
   // TODO(Tianyi) Move Statement Planing into Statement's method
   // to increase coherence
   try {
@@ -332,6 +415,23 @@ std::shared_ptr<Statement> TrafficCop::PrepareStatement(
       statement->SetTupleDescriptor(tuple_descriptor);
       LOG_TRACE("select query, finish setting");
     }
+
+    // Remember the predicates whose selectivity depends on the parameters,
+    // they decide which plan variant to use at bind time
+    statement->SetParameterPredicates(
+        optimizer::ParameterSelectivity::GetParameterPredicates(
+            statement->GetStmtParseTreeList()->GetStatement(0)));
+
+    // Share the plan with other connections. Plans made inside of a
+    // multi-statement txn may depend on its uncommitted DDL, so skip them.
+    if (use_plan_cache && single_statement_txn_) {
+      auto &plan_cache = PlanCache::GetInstance();
+      plan_cache.SetCapacity(settings::SettingsManager::GetInt(
+          settings::SettingId::plan_cache_size));
+      plan_cache.Add(plan_cache_key, plan.get(),
+                     statement->GetTupleDescriptor(), table_oids,
+                     statement->GetParameterPredicates(), plan_cache_version);
+    }
   } catch (Exception &e) {
     error_message_ = e.what();
     ProcessInvalidStatement();
@@ -365,6 +465,89 @@ void TrafficCop::ProcessInvalidStatement() {
   }
 }
 
+void TrafficCop::SelectPlanForParams(
+    const std::shared_ptr<Statement> &statement,
+    const std::vector<type::Value> &param_values, size_t thread_id) {
+  auto max_variants = settings::SettingsManager::GetInt(
+      settings::SettingId::plan_variants_max);
+  const auto &predicates = statement->GetParameterPredicates();
+  if (max_variants <= 0 || predicates.empty() || param_values.empty() ||
+      statement->GetNeedsReplan()) {
+    return;
+  }
+
+  auto buckets = optimizer::ParameterSelectivity::ComputeBuckets(
+      predicates, param_values);
+  bool all_unknown = true;
+  for (auto bucket : buckets) {
+    if (bucket != optimizer::ParameterSelectivity::UNKNOWN_BUCKET) {
+      all_unknown = false;
+      break;
+    }
+  }
+  // Nothing to tell the optimizer that the generic plan did not know
+  if (all_unknown || buckets == statement->GetPlanBuckets()) {
+    return;
+  }
+
+  // Keep the plan we are switching away from around, the generic plan is
+  // stored under the empty bucket vector
+  if (statement->GetPlanVariant(statement->GetPlanBuckets()) == nullptr) {
+    statement->AddPlanVariant(statement->GetPlanBuckets(),
+                              statement->GetPlanTree());
+  }
+
+  auto plan = statement->GetPlanVariant(buckets);
+  if (plan == nullptr) {
+    // The generic plan does not count against the limit
+    if (statement->GetPlanVariantCount() >
+        static_cast<size_t>(max_variants)) {
+      LOG_TRACE("Too many plan variants for %s, keeping the current plan",
+                statement->GetQueryString().c_str());
+      return;
+    }
+
+    if (tcop_txn_state_.empty()) {
+      single_statement_txn_ = true;
+      auto &txn_manager =
+          concurrency::TransactionManagerFactory::GetInstance();
+      auto txn = txn_manager.BeginTransaction(thread_id);
+      // this shouldn't happen
+      if (txn == nullptr) {
+        LOG_ERROR("Begin txn failed");
+        return;
+      }
+      tcop_txn_state_.emplace(txn, ResultType::SUCCESS);
+    }
+    if (tcop_txn_state_.top().second == ResultType::ABORTED) {
+      return;
+    }
+
+    try {
+      auto bind_node_visitor = binder::BindNodeVisitor(
+          tcop_txn_state_.top().first, default_database_name_);
+      bind_node_visitor.BindNameToNode(
+          statement->GetStmtParseTreeList()->GetStatement(0));
+      optimizer_->SetParameterValues(param_values);
+      plan = optimizer_->BuildPelotonPlanTree(
+          statement->GetStmtParseTreeList(), tcop_txn_state_.top().first);
+      optimizer_->SetParameterValues(std::vector<type::Value>());
+    } catch (Exception &e) {
+      // Planning a variant is only an optimization, so fall back to the
+      // current plan rather than failing the statement
+      optimizer_->SetParameterValues(std::vector<type::Value>());
+      LOG_DEBUG("Failed to plan variant: %s", e.what());
+      return;
+    }
+    statement->AddPlanVariant(buckets, plan);
+    LOG_TRACE("Planned variant %lu of %s", statement->GetPlanVariantCount(),
+              statement->GetQueryString().c_str());
+  }
+
+  statement->SetPlanTree(plan);
+  statement->SetPlanBuckets(buckets);
+}
+
 bool TrafficCop::BindParamsForCachePlan(
     const std::vector<std::unique_ptr<expression::AbstractExpression>>
         &parameters,
@@ -396,6 +579,7 @@ bool TrafficCop::BindParamsForCachePlan(
     param_values.push_back(param->Evaluate(nullptr, nullptr, nullptr));
   }
   if (param_values.size() > 0) {
+    SelectPlanForParams(statement_, param_values, thread_id);
     statement_->GetPlanTree()->SetParameterValues(&param_values);
   }
   SetParamVal(param_values);
@@ -598,6 +782,7 @@ ResultType TrafficCop::ExecuteStatement(
           auto plan = optimizer_->BuildPelotonPlanTree(
               statement->GetStmtParseTreeList(), tcop_txn_state_.top().first);
           statement->SetPlanTree(plan);
+          statement->ClearPlanVariants();
           statement->SetNeedsReplan(true);
         }
 
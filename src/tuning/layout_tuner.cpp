@@ -20,6 +20,7 @@
 #include "catalog/schema.h"
 #include "common/logger.h"
 #include "common/timer.h"
+#include "concurrency/epoch_manager_factory.h"
 #include "concurrency/transaction_manager_factory.h"
 #include "storage/data_table.h"
 
@@ -137,12 +138,16 @@ void LayoutTuner::Tune() {
   while (layout_tuning_stop == false) {
     // Go over all tables
     for (auto table : tables) {
+      // Finish the transformations nobody can interfere with anymore
+      auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+      table->FinishTransformTileGroups(epoch_manager.GetExpiredEpochId());
+
       // Transform
       auto tile_group_count = table->GetTileGroupCount();
       auto tile_group_offset = rand() % tile_group_count;
 
       LOG_TRACE("Transforming tile group at offset: %lu", tile_group_offset);
-      table->TransformTileGroup(tile_group_offset, theta);
+      table->BeginTransformTileGroup(tile_group_offset, theta);
 
       // Update partitioning periodically
       // TODO Lin/Tianyu - Add Failure Handling/Retry logic.
@@ -0,0 +1,240 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// arena_pool.cpp
+//
+// Identification: src/type/arena_pool.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "type/arena_pool.h"
+
+#include <limits>
+
+#include "common/logger.h"
+
+namespace peloton {
+namespace type {
+
+// The ID of no chunk
+static constexpr uint32_t kInvalidChunkId =
+    std::numeric_limits<uint32_t>::max();
+
+ArenaPool::ArenaPool()
+    : current_chunk_id_(kInvalidChunkId),
+      allocated_bytes_(0),
+      reserved_bytes_(0) {}
+
+ArenaPool::~ArenaPool() {
+  // The chunks free their memory
+}
+
+size_t ArenaPool::FootprintOf(size_t size) {
+  // Keep allocations (and their headers) 8-byte aligned
+  return sizeof(AllocationHeader) + ((size + 7) & ~static_cast<size_t>(7));
+}
+
+void *ArenaPool::Allocate(size_t size) {
+  PELOTON_ASSERT(size <= std::numeric_limits<uint32_t>::max());
+  size_t footprint = FootprintOf(size);
+
+  pool_lock_.Lock();
+  uint32_t chunk_id;
+  if (footprint > kMaxSmallAllocation) {
+    chunk_id = AddChunk(footprint);
+  } else {
+    if (current_chunk_id_ == kInvalidChunkId ||
+        chunks_[current_chunk_id_]->used + footprint > kChunkSize) {
+      // The current chunk is full, the frees of its allocations release it
+      uint32_t prev_chunk_id = current_chunk_id_;
+      current_chunk_id_ = AddChunk(kChunkSize);
+      if (prev_chunk_id != kInvalidChunkId &&
+          chunks_[prev_chunk_id]->live == 0) {
+        ReleaseChunk(prev_chunk_id);
+      }
+    }
+    chunk_id = current_chunk_id_;
+  }
+  Chunk &chunk = *chunks_[chunk_id];
+  char *location = chunk.data.get() + chunk.used;
+  chunk.used += footprint;
+  chunk.live += footprint;
+  pool_lock_.Unlock();
+
+  auto *header = reinterpret_cast<AllocationHeader *>(location);
+  header->chunk_id = chunk_id;
+  header->size = static_cast<uint32_t>(size);
+  allocated_bytes_ += size;
+
+  return location + sizeof(AllocationHeader);
+}
+
+void ArenaPool::Free(void *ptr) {
+  pool_lock_.Lock();
+  Chunk *chunk = LookupChunk(ptr);
+  if (chunk == nullptr) {
+    pool_lock_.Unlock();
+    LOG_TRACE("Ignoring free of %p, which is not from this pool", ptr);
+    return;
+  }
+
+  const auto *header = reinterpret_cast<const AllocationHeader *>(
+      static_cast<char *>(ptr) - sizeof(AllocationHeader));
+  uint32_t chunk_id = header->chunk_id;
+  size_t size = header->size;
+  chunk->live -= FootprintOf(size);
+
+  if (chunk->live == 0 && chunk->state == ChunkState::Active) {
+    if (chunk_id == current_chunk_id_) {
+      // Start over at the beginning of the current chunk
+      chunk->used = 0;
+    } else {
+      ReleaseChunk(chunk_id);
+    }
+  }
+  pool_lock_.Unlock();
+
+  allocated_bytes_ -= size;
+}
+
+size_t ArenaPool::GetAllocationSize(const void *ptr) const {
+  const auto *header = reinterpret_cast<const AllocationHeader *>(
+      static_cast<const char *>(ptr) - sizeof(AllocationHeader));
+  return header->size;
+}
+
+ArenaPool::Chunk *ArenaPool::LookupChunk(const void *ptr) const {
+  const auto *location = static_cast<const char *>(ptr);
+  const auto *header = reinterpret_cast<const AllocationHeader *>(
+      location - sizeof(AllocationHeader));
+  if (header->chunk_id >= chunks_.size()) {
+    return nullptr;
+  }
+  Chunk *chunk = chunks_[header->chunk_id].get();
+  if (chunk == nullptr ||
+      location < chunk->data.get() + sizeof(AllocationHeader) ||
+      location >= chunk->data.get() + chunk->used) {
+    return nullptr;
+  }
+  return chunk;
+}
+
+uint32_t ArenaPool::AddChunk(size_t size) {
+  uint32_t chunk_id;
+  if (!free_chunk_ids_.empty()) {
+    chunk_id = free_chunk_ids_.back();
+    free_chunk_ids_.pop_back();
+  } else {
+    chunk_id = static_cast<uint32_t>(chunks_.size());
+    chunks_.emplace_back();
+  }
+  chunks_[chunk_id].reset(new Chunk(size));
+  reserved_bytes_ += size;
+  return chunk_id;
+}
+
+void ArenaPool::ReleaseChunk(uint32_t chunk_id) {
+  reserved_bytes_ -= chunks_[chunk_id]->size;
+  chunks_[chunk_id].reset();
+  free_chunk_ids_.push_back(chunk_id);
+}
+
+//===----------------------------------------------------------------------===//
+// Compaction
+//===----------------------------------------------------------------------===//
+
+bool ArenaPool::NeedsCompaction() const {
+  size_t reserved_bytes = reserved_bytes_.load();
+  return reserved_bytes >= kMinChunksToCompact * kChunkSize &&
+         allocated_bytes_.load() * 2 < reserved_bytes;
+}
+
+size_t ArenaPool::BeginCompaction() {
+  size_t num_evacuating = 0;
+  pool_lock_.Lock();
+  for (uint32_t chunk_id = 0; chunk_id < chunks_.size(); chunk_id++) {
+    Chunk *chunk = chunks_[chunk_id].get();
+    // Allocations with a chunk of their own are never fragmented
+    if (chunk == nullptr || chunk_id == current_chunk_id_ ||
+        chunk->state != ChunkState::Active || chunk->size != kChunkSize) {
+      continue;
+    }
+    if (chunk->live * 2 < chunk->used) {
+      chunk->state = ChunkState::Evacuating;
+      num_evacuating++;
+    }
+  }
+  pool_lock_.Unlock();
+  return num_evacuating;
+}
+
+bool ArenaPool::IsEvacuating(const void *ptr) {
+  pool_lock_.Lock();
+  Chunk *chunk = LookupChunk(ptr);
+  bool evacuating =
+      chunk != nullptr && chunk->state == ChunkState::Evacuating;
+  pool_lock_.Unlock();
+  return evacuating;
+}
+
+void ArenaPool::EndCompaction(eid_t epoch_id) {
+  pool_lock_.Lock();
+  for (auto &chunk : chunks_) {
+    if (chunk == nullptr || chunk->state != ChunkState::Evacuating) {
+      continue;
+    }
+    if (chunk->live == 0) {
+      chunk->state = ChunkState::Retired;
+      chunk->retired_epoch = epoch_id;
+    } else {
+      // Some values could not be moved, e.g., because they were overwritten
+      // meanwhile. The chunk is released once they have been freed.
+      chunk->state = ChunkState::Active;
+    }
+  }
+  pool_lock_.Unlock();
+}
+
+size_t ArenaPool::ReleaseRetiredChunks(eid_t expired_epoch_id) {
+  size_t num_released = 0;
+  pool_lock_.Lock();
+  for (uint32_t chunk_id = 0; chunk_id < chunks_.size(); chunk_id++) {
+    Chunk *chunk = chunks_[chunk_id].get();
+    if (chunk != nullptr && chunk->state == ChunkState::Retired &&
+        chunk->retired_epoch <= expired_epoch_id) {
+      ReleaseChunk(chunk_id);
+      num_released++;
+    }
+  }
+  pool_lock_.Unlock();
+  return num_released;
+}
+
+//===----------------------------------------------------------------------===//
+// Statistics
+//===----------------------------------------------------------------------===//
+
+size_t ArenaPool::GetNumChunks() {
+  pool_lock_.Lock();
+  size_t num_chunks = chunks_.size() - free_chunk_ids_.size();
+  pool_lock_.Unlock();
+  return num_chunks;
+}
+
+size_t ArenaPool::GetNumRetiredChunks() {
+  size_t num_retired = 0;
+  pool_lock_.Lock();
+  for (const auto &chunk : chunks_) {
+    if (chunk != nullptr && chunk->state == ChunkState::Retired) {
+      num_retired++;
+    }
+  }
+  pool_lock_.Unlock();
+  return num_retired;
+}
+
+}  // namespace type
+}  // namespace peloton
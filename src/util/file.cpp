@@ -12,6 +12,9 @@
 
 #include "util/file.h"
 
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include "util/string_util.h"
 
 namespace peloton {
@@ -50,6 +53,28 @@ void File::Open(const std::string &name, File::AccessMode access_mode) {
   fd_ = fd;
 }
 
+void File::CreateTemp(const std::string &directory) {
+  // Close the existing file if it's open
+  Close();
+
+  // mkstemp() replaces the trailing X's in place
+  std::string name = directory + "/peloton_XXXXXX";
+  int fd = mkstemp(&name[0]);
+
+  // Check error
+  if (fd == -1) {
+    throw Exception(StringUtil::Format(
+        "unable to create temporary file in '%s': %s", directory.c_str(),
+        strerror(errno)));
+  }
+
+  // Nobody else needs to find the file, remove it from the directory
+  unlink(name.c_str());
+
+  // Done
+  fd_ = fd;
+}
+
 uint64_t File::Read(void *data, uint64_t len) const {
   // Ensure open
   PELOTON_ASSERT(IsOpen());
@@ -67,6 +92,23 @@ uint64_t File::Read(void *data, uint64_t len) const {
   return static_cast<uint64_t>(bytes_read);
 }
 
+uint64_t File::ReadAt(void *data, uint64_t len, uint64_t offset) const {
+  // Ensure open
+  PELOTON_ASSERT(IsOpen());
+
+  // Perform read
+  ssize_t bytes_read = pread(fd_, data, len, static_cast<off_t>(offset));
+
+  // Check error
+  if (bytes_read == -1) {
+    throw Exception(
+        StringUtil::Format("error reading file: %s", strerror(errno)));
+  }
+
+  // Done
+  return static_cast<uint64_t>(bytes_read);
+}
+
 uint64_t File::Write(void *data, uint64_t len) const {
   // Ensure open
   PELOTON_ASSERT(IsOpen());
@@ -114,6 +156,24 @@ uint64_t File::Size() const {
   return static_cast<uint64_t>(off);
 }
 
+void *File::Map(uint64_t len) const {
+  // Ensure open
+  PELOTON_ASSERT(IsOpen());
+
+  void *addr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_, 0);
+
+  // Check error
+  if (addr == MAP_FAILED) {
+    throw Exception(
+        StringUtil::Format("unable to map file: %s", strerror(errno)));
+  }
+
+  // Done
+  return addr;
+}
+
+void File::Unmap(void *addr, uint64_t len) { munmap(addr, len); }
+
 void File::Close() {
   if (IsOpen()) {
     close(fd_);
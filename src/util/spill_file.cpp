@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// spill_file.cpp
+//
+// Identification: src/util/spill_file.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "util/spill_file.h"
+
+#include "util/string_util.h"
+
+namespace peloton {
+namespace util {
+
+SpillFile::SpillFile(const std::string &directory)
+    : size_(0), mapping_(nullptr), mapping_size_(0) {
+  file_.CreateTemp(directory);
+}
+
+SpillFile::~SpillFile() {
+  if (mapping_ != nullptr) {
+    File::Unmap(mapping_, mapping_size_);
+  }
+}
+
+uint64_t SpillFile::Append(const void *data, uint64_t len) {
+  PELOTON_ASSERT(mapping_ == nullptr);
+
+  // Writes to regular files can be short, e.g., when interrupted by a signal
+  auto *pos = static_cast<char *>(const_cast<void *>(data));
+  uint64_t written = 0;
+  while (written < len) {
+    uint64_t n = file_.Write(pos + written, len - written);
+    if (n == 0) {
+      throw Exception("unable to write to spill file, the disk is full");
+    }
+    written += n;
+  }
+
+  uint64_t offset = size_;
+  size_ += len;
+  return offset;
+}
+
+void SpillFile::Read(uint64_t offset, void *data, uint64_t len) const {
+  PELOTON_ASSERT(offset + len <= size_);
+
+  auto *pos = static_cast<char *>(data);
+  uint64_t read = 0;
+  while (read < len) {
+    uint64_t n = file_.ReadAt(pos + read, len - read, offset + read);
+    if (n == 0) {
+      throw Exception(StringUtil::Format(
+          "unexpected end of spill file at offset %lu",
+          static_cast<unsigned long>(offset + read)));
+    }
+    read += n;
+  }
+}
+
+char *SpillFile::Map() {
+  if (mapping_ == nullptr && size_ > 0) {
+    mapping_ = static_cast<char *>(file_.Map(size_));
+    mapping_size_ = size_;
+  }
+  return mapping_;
+}
+
+}  // namespace util
+}  // namespace peloton
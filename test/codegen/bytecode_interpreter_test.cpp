@@ -13,6 +13,7 @@
 #include "codegen/interpreter/bytecode_interpreter.h"
 #include "codegen/function_builder.h"
 #include "codegen/interpreter/bytecode_builder.h"
+#include "codegen/lang/if.h"
 #include "codegen/lang/loop.h"
 #include "codegen/proxy/runtime_functions_proxy.h"
 #include "common/harness.h"
@@ -195,6 +196,62 @@ TEST_F(BytecodeInterpreterTest, ExternalCallTest) {
   ASSERT_EQ(ret, 10);
 }
 
+struct Pair {
+  int32_t first;
+  int32_t second;
+};
+
+TEST_F(BytecodeInterpreterTest, SuperinstructionTest) {
+  // Load struct members and branch on a compare of them. The interpreter
+  // executes both with superinstructions.
+
+  codegen::CodeContext code_context;
+  codegen::CodeGen cg{code_context};
+  auto *pair_type = llvm::StructType::create(
+      cg.GetContext(), {cg.Int32Type(), cg.Int32Type()}, "Pair");
+
+  codegen::FunctionBuilder main{code_context,
+                                "main",
+                                cg.Int32Type(),
+                                {{"pair", pair_type->getPointerTo()}}};
+  {
+    auto *pair = main.GetArgumentByPosition(0);
+    auto *first =
+        cg->CreateLoad(cg->CreateConstInBoundsGEP2_32(pair_type, pair, 0, 0));
+    auto *second =
+        cg->CreateLoad(cg->CreateConstInBoundsGEP2_32(pair_type, pair, 0, 1));
+
+    llvm::Value *less, *greater;
+    codegen::lang::If first_is_less{cg, cg->CreateICmpSLT(first, second)};
+    {
+      less = cg->CreateSub(second, first);
+    }
+    first_is_less.ElseBlock();
+    {
+      greater = cg->CreateMul(cg->CreateSub(first, second), cg.Const32(2));
+    }
+    first_is_less.EndIf();
+
+    main.ReturnAndFinish(first_is_less.BuildPHI(less, greater));
+  }
+
+  // create Bytecode
+  auto bytecode = codegen::interpreter::BytecodeBuilder::CreateBytecodeFunction(
+      code_context, main.GetFunction());
+
+  // run Bytecode
+  Pair pair{-3, 4};
+  codegen::interpreter::value_t ret =
+      codegen::interpreter::BytecodeInterpreter::ExecuteFunction(
+          bytecode, {reinterpret_cast<codegen::interpreter::value_t>(&pair)});
+  ASSERT_EQ(7, static_cast<int32_t>(ret));
+
+  pair = {5, -1};
+  ret = codegen::interpreter::BytecodeInterpreter::ExecuteFunction(
+      bytecode, {reinterpret_cast<codegen::interpreter::value_t>(&pair)});
+  ASSERT_EQ(12, static_cast<int32_t>(ret));
+}
+
 TEST_F(BytecodeInterpreterTest, InternalCallTest) {
   // Call an internal function.
 
@@ -157,6 +157,30 @@ TEST_F(CSVScanTest, MixedStringTest) {
   EXPECT_EQ(rows.size(), rows_read);
 }
 
+TEST_F(CSVScanTest, ChunkedScanTest) {
+  // Enough rows to split into several chunks, with quoted new-lines and quotes
+  // that straddle the chunk boundaries
+  std::vector<std::string> rows;
+  for (uint32_t i = 0; i < 50000; i++) {
+    rows.push_back(StringUtil::Format("%u,\"line\n\"\"%u\"\"\",%u", i, i, i));
+  }
+  std::vector<codegen::type::Type> types = {{type::TypeId::INTEGER, false},
+                                            {type::TypeId::VARCHAR, false},
+                                            {type::TypeId::INTEGER, false}};
+
+  // The rows are produced in the order of the file
+  uint32_t rows_read = 0;
+  IterateAsCSV(rows, types, [&rows_read](
+                                const codegen::util::CSVScanner::Column *cols) {
+    auto row = std::to_string(rows_read++);
+    EXPECT_EQ(row, std::string(cols[0].ptr, cols[0].len));
+    EXPECT_EQ("line\n\"" + row + "\"", std::string(cols[1].ptr, cols[1].len));
+    EXPECT_EQ(row, std::string(cols[2].ptr, cols[2].len));
+  });
+
+  EXPECT_EQ(rows.size(), rows_read);
+}
+
 TEST_F(CSVScanTest, CatchErrorsTest) {
   ////////////////////////////////////////////////////////////////////
   ///
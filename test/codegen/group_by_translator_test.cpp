@@ -10,13 +10,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <set>
+
 #include "catalog/catalog.h"
 #include "codegen/proxy/runtime_functions_proxy.h"
 #include "codegen/query_compiler.h"
 #include "common/harness.h"
+#include "concurrency/transaction_manager_factory.h"
 #include "expression/comparison_expression.h"
 #include "expression/conjunction_expression.h"
 #include "expression/tuple_value_expression.h"
+#include "optimizer/stats/stats_storage.h"
 #include "planner/aggregate_plan.h"
 #include "planner/seq_scan_plan.h"
 
@@ -455,5 +459,144 @@ TEST_F(GroupByTranslatorTest, MinAndMax) {
               CmpBool::CmpTrue);
 }
 
+TEST_F(GroupByTranslatorTest, DirectMappedGrouping) {
+  //
+  // SELECT a, count(*) FROM table GROUP BY a;
+  //
+  // The statistics of column 'a' cover the first ten rows, so the aggregation
+  // keeps their groups in a direct-mapped table. The groups of the rows loaded
+  // afterwards are outside the range and go to the hash table.
+  //
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto *txn = txn_manager.BeginTransaction();
+  optimizer::StatsStorage::GetInstance()->AnalyzeStatsForTable(
+      &GetTestTable(TestTableId()), txn);
+  txn_manager.CommitTransaction(txn);
+  LoadTestTable(TestTableId(), 10);
+
+  // 1) Set up projection (just a direct map)
+  DirectMapList direct_map_list = {{0, {0, 0}}, {1, {1, 0}}};
+  std::unique_ptr<planner::ProjectInfo> proj_info{
+      new planner::ProjectInfo(TargetList{}, std::move(direct_map_list))};
+
+  // 2) Setup the aggregations
+  auto *tve_expr =
+      new expression::TupleValueExpression(type::TypeId::INTEGER, 0, 0);
+  std::vector<planner::AggregatePlan::AggTerm> agg_terms = {
+      {ExpressionType::AGGREGATE_COUNT_STAR, tve_expr}};
+
+  // 3) The grouping column
+  std::vector<oid_t> gb_cols = {0};
+
+  // 4) The output schema
+  std::shared_ptr<const catalog::Schema> output_schema{
+      new catalog::Schema({{type::TypeId::INTEGER, 4, "COL_A"},
+                           {type::TypeId::BIGINT, 8, "COUNT_A"}})};
+
+  // 5) Finally, the aggregation node
+  std::unique_ptr<planner::AbstractPlan> agg_plan{new planner::AggregatePlan(
+      std::move(proj_info), nullptr, std::move(agg_terms), std::move(gb_cols),
+      output_schema, AggregateType::HASH)};
+
+  // 6) The scan that feeds the aggregation
+  std::unique_ptr<planner::AbstractPlan> scan_plan{
+      new planner::SeqScanPlan(&GetTestTable(TestTableId()), nullptr, {0})};
+
+  agg_plan->AddChild(std::move(scan_plan));
+
+  // Do binding
+  planner::BindingContext context;
+  agg_plan->PerformBinding(context);
+
+  // We collect the results of the query into an in-memory buffer
+  codegen::BufferingConsumer buffer{{0, 1}, context};
+
+  // Compile and run
+  CompileAndExecute(*agg_plan, buffer);
+
+  // Every row is its own group, no matter where the group was kept
+  const auto &results = buffer.GetOutputTuples();
+  EXPECT_EQ(20u, results.size());
+
+  std::set<int32_t> keys;
+  type::Value const_one = type::ValueFactory::GetIntegerValue(1);
+  for (const auto &tuple : results) {
+    keys.insert(tuple.GetValue(0).GetAs<int32_t>());
+    EXPECT_TRUE(tuple.GetValue(1).CompareEquals(const_one) ==
+                CmpBool::CmpTrue);
+  }
+  EXPECT_EQ(20u, keys.size());
+  EXPECT_EQ(0, *keys.begin());
+  EXPECT_EQ(190, *keys.rbegin());
+}
+
+TEST_F(GroupByTranslatorTest, NullGroupingKey) {
+  //
+  // SELECT b, count(*) FROM table GROUP BY b;
+  //
+  // The nullable grouping column is packed into an integer with a NULL bit.
+  // All rows with a NULL 'b' form one group.
+  //
+
+  LoadTestTable(TestTableId(), 5, true);
+
+  // 1) Set up projection (just a direct map)
+  DirectMapList direct_map_list = {{0, {0, 0}}, {1, {1, 0}}};
+  std::unique_ptr<planner::ProjectInfo> proj_info{
+      new planner::ProjectInfo(TargetList{}, std::move(direct_map_list))};
+
+  // 2) Setup the aggregations
+  auto *tve_expr =
+      new expression::TupleValueExpression(type::TypeId::INTEGER, 0, 1);
+  std::vector<planner::AggregatePlan::AggTerm> agg_terms = {
+      {ExpressionType::AGGREGATE_COUNT_STAR, tve_expr}};
+
+  // 3) The grouping column
+  std::vector<oid_t> gb_cols = {1};
+
+  // 4) The output schema
+  std::shared_ptr<const catalog::Schema> output_schema{
+      new catalog::Schema({{type::TypeId::INTEGER, 4, "COL_B"},
+                           {type::TypeId::BIGINT, 8, "COUNT_B"}})};
+
+  // 5) Finally, the aggregation node
+  std::unique_ptr<planner::AbstractPlan> agg_plan{new planner::AggregatePlan(
+      std::move(proj_info), nullptr, std::move(agg_terms), std::move(gb_cols),
+      output_schema, AggregateType::HASH)};
+
+  // 6) The scan that feeds the aggregation
+  std::unique_ptr<planner::AbstractPlan> scan_plan{
+      new planner::SeqScanPlan(&GetTestTable(TestTableId()), nullptr, {1})};
+
+  agg_plan->AddChild(std::move(scan_plan));
+
+  // Do binding
+  planner::BindingContext context;
+  agg_plan->PerformBinding(context);
+
+  // We collect the results of the query into an in-memory buffer
+  codegen::BufferingConsumer buffer{{0, 1}, context};
+
+  // Compile and run
+  CompileAndExecute(*agg_plan, buffer);
+
+  // Ten groups of a single row, and the group of the five NULLs
+  const auto &results = buffer.GetOutputTuples();
+  EXPECT_EQ(11u, results.size());
+
+  uint32_t num_null_groups = 0;
+  for (const auto &tuple : results) {
+    int64_t expected_count = 1;
+    if (tuple.GetValue(0).IsNull()) {
+      num_null_groups++;
+      expected_count = 5;
+    }
+    type::Value count = type::ValueFactory::GetBigIntValue(expected_count);
+    EXPECT_TRUE(tuple.GetValue(1).CompareEquals(count) == CmpBool::CmpTrue);
+  }
+  EXPECT_EQ(1u, num_null_groups);
+}
+
 }  // namespace test
 }  // namespace peloton
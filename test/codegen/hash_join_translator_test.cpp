@@ -19,6 +19,8 @@
 #include "planner/hash_join_plan.h"
 #include "planner/hash_plan.h"
 #include "planner/seq_scan_plan.h"
+#include "settings/settings_manager.h"
+#include "type/value_factory.h"
 
 #include "codegen/testing_codegen_util.h"
 
@@ -45,6 +47,65 @@ class HashJoinTranslatorTest : public PelotonCodeGenTest {
   storage::DataTable &GetRightTable() const {
     return GetTestTable(RightTableId());
   }
+
+  // Join the build table with the probe table on column a. The output has the
+  // 'a' column of the build side followed by the 'a' column of the probe side,
+  // or only the 'a' column of the build side for semi and anti joins.
+  std::vector<codegen::WrappedTuple> JoinOnA(JoinType join_type,
+                                             storage::DataTable &build_table,
+                                             storage::DataTable &probe_table,
+                                             bool partitioned = false) {
+    bool probe_output =
+        join_type != JoinType::SEMI && join_type != JoinType::ANTI;
+
+    DirectMapList direct_map_list = {std::make_pair(0, std::make_pair(0, 0))};
+    std::vector<catalog::Column> columns = {
+        TestingExecutorUtil::GetColumnInfo(0)};
+    if (probe_output) {
+      direct_map_list.push_back(std::make_pair(1, std::make_pair(1, 0)));
+      columns.push_back(TestingExecutorUtil::GetColumnInfo(0));
+    }
+    std::unique_ptr<planner::ProjectInfo> projection{
+        new planner::ProjectInfo(TargetList{}, std::move(direct_map_list))};
+    auto schema = std::shared_ptr<const catalog::Schema>(
+        new catalog::Schema(columns));
+
+    std::vector<ConstExpressionPtr> left_hash_keys;
+    left_hash_keys.emplace_back(ColRefExpr(type::TypeId::INTEGER, 0));
+    std::vector<ConstExpressionPtr> right_hash_keys;
+    right_hash_keys.emplace_back(ColRefExpr(type::TypeId::INTEGER, 0));
+    std::vector<ConstExpressionPtr> hash_keys;
+    hash_keys.emplace_back(ColRefExpr(type::TypeId::INTEGER, 0));
+
+    std::unique_ptr<planner::HashJoinPlan> hj_plan{new planner::HashJoinPlan(
+        join_type, nullptr, std::move(projection), schema, left_hash_keys,
+        right_hash_keys, false)};
+    hj_plan->SetPartitioned(partitioned);
+    std::unique_ptr<planner::HashPlan> hash_plan{
+        new planner::HashPlan(hash_keys)};
+
+    std::unique_ptr<planner::AbstractPlan> build_scan{
+        new planner::SeqScanPlan(&build_table, nullptr, {0, 1, 2})};
+    std::unique_ptr<planner::AbstractPlan> probe_scan{
+        new planner::SeqScanPlan(&probe_table, nullptr, {0, 1, 2})};
+
+    hash_plan->AddChild(std::move(probe_scan));
+    hj_plan->AddChild(std::move(build_scan));
+    hj_plan->AddChild(std::move(hash_plan));
+
+    EXPECT_TRUE(codegen::QueryCompiler::IsSupported(*hj_plan));
+
+    planner::BindingContext context;
+    hj_plan->PerformBinding(context);
+
+    std::vector<oid_t> output_cols = {0};
+    if (probe_output) {
+      output_cols.push_back(1);
+    }
+    codegen::BufferingConsumer buffer{output_cols, context};
+    CompileAndExecute(*hj_plan, buffer);
+    return buffer.GetOutputTuples();
+  }
 };
 
 TEST_F(HashJoinTranslatorTest, SingleHashJoinColumnTest) {
@@ -127,5 +188,116 @@ TEST_F(HashJoinTranslatorTest, SingleHashJoinColumnTest) {
   }
 }
 
+TEST_F(HashJoinTranslatorTest, LeftOuterHashJoinTest) {
+  // Build on the right table, so 60 of its 80 rows have no join partner
+  auto results = JoinOnA(JoinType::LEFT, GetRightTable(), GetLeftTable());
+  EXPECT_EQ(80, results.size());
+
+  uint32_t num_null = 0;
+  for (const auto &tuple : results) {
+    EXPECT_FALSE(tuple.GetValue(0).IsNull());
+    if (tuple.GetValue(1).IsNull()) {
+      num_null++;
+    } else {
+      EXPECT_EQ(CmpBool::CmpTrue,
+                tuple.GetValue(0).CompareEquals(tuple.GetValue(1)));
+    }
+  }
+  EXPECT_EQ(60, num_null);
+
+  // When every build tuple finds a partner, it's just an inner join
+  results = JoinOnA(JoinType::LEFT, GetLeftTable(), GetRightTable());
+  EXPECT_EQ(20, results.size());
+  for (const auto &tuple : results) {
+    EXPECT_FALSE(tuple.GetValue(1).IsNull());
+  }
+}
+
+TEST_F(HashJoinTranslatorTest, RightOuterHashJoinTest) {
+  // Probe with the right table, so 60 of its 80 rows have no join partner
+  auto results = JoinOnA(JoinType::RIGHT, GetLeftTable(), GetRightTable());
+  EXPECT_EQ(80, results.size());
+
+  uint32_t num_null = 0;
+  for (const auto &tuple : results) {
+    EXPECT_FALSE(tuple.GetValue(1).IsNull());
+    if (tuple.GetValue(0).IsNull()) {
+      num_null++;
+    } else {
+      EXPECT_EQ(CmpBool::CmpTrue,
+                tuple.GetValue(0).CompareEquals(tuple.GetValue(1)));
+    }
+  }
+  EXPECT_EQ(60, num_null);
+}
+
+TEST_F(HashJoinTranslatorTest, FullOuterHashJoinTest) {
+  // Only one side has unmatched tuples, whichever side it is on
+  auto results = JoinOnA(JoinType::OUTER, GetRightTable(), GetLeftTable());
+  EXPECT_EQ(80, results.size());
+  results = JoinOnA(JoinType::OUTER, GetLeftTable(), GetRightTable());
+  EXPECT_EQ(80, results.size());
+
+  uint32_t num_null = 0;
+  for (const auto &tuple : results) {
+    if (tuple.GetValue(0).IsNull()) num_null++;
+  }
+  EXPECT_EQ(60, num_null);
+}
+
+TEST_F(HashJoinTranslatorTest, SemiAndAntiHashJoinTest) {
+  // Each of the 20 build tuples with a partner is produced exactly once
+  auto results = JoinOnA(JoinType::SEMI, GetRightTable(), GetLeftTable());
+  EXPECT_EQ(20, results.size());
+  for (const auto &tuple : results) {
+    EXPECT_EQ(CmpBool::CmpTrue,
+              tuple.GetValue(0).CompareLessThan(
+                  type::ValueFactory::GetIntegerValue(200)));
+  }
+
+  // The anti join produces the other 60
+  results = JoinOnA(JoinType::ANTI, GetRightTable(), GetLeftTable());
+  EXPECT_EQ(60, results.size());
+  for (const auto &tuple : results) {
+    EXPECT_EQ(CmpBool::CmpTrue,
+              tuple.GetValue(0).CompareGreaterThanEquals(
+                  type::ValueFactory::GetIntegerValue(200)));
+  }
+}
+
+TEST_F(HashJoinTranslatorTest, PartitionedHashJoinTest) {
+  // Each left tuple has exactly one partner in the right table, no matter
+  // which side we build the partitioned hash tables on
+  auto results =
+      JoinOnA(JoinType::INNER, GetLeftTable(), GetRightTable(), true);
+  EXPECT_EQ(20, results.size());
+  for (const auto &tuple : results) {
+    EXPECT_EQ(CmpBool::CmpTrue,
+              tuple.GetValue(0).CompareEquals(tuple.GetValue(1)));
+  }
+
+  results = JoinOnA(JoinType::INNER, GetRightTable(), GetLeftTable(), true);
+  EXPECT_EQ(20, results.size());
+  for (const auto &tuple : results) {
+    EXPECT_EQ(CmpBool::CmpTrue,
+              tuple.GetValue(0).CompareEquals(tuple.GetValue(1)));
+  }
+}
+
+TEST_F(HashJoinTranslatorTest, HashJoinWithoutInlinedRuntimeTest) {
+  // The hash table and hashing functions are called, not inlined
+  settings::SettingsManager::SetBool(
+      settings::SettingId::codegen_inline_runtime, false);
+  auto results = JoinOnA(JoinType::INNER, GetLeftTable(), GetRightTable());
+  settings::SettingsManager::SetBool(
+      settings::SettingId::codegen_inline_runtime, true);
+
+  EXPECT_EQ(20u, results.size());
+  for (const auto &tuple : results) {
+    EXPECT_EQ(CmpBool::CmpTrue,
+              tuple.GetValue(0).CompareEquals(tuple.GetValue(1)));
+  }
+}
+
 }  // namespace test
 }  // namespace peloton
@@ -12,10 +12,15 @@
 
 #include "codegen/testing_codegen_util.h"
 
+#include <dirent.h>
+#include <cstdlib>
+
 #include "catalog/catalog.h"
+#include "codegen/compiled_code_cache.h"
 #include "codegen/query_cache.h"
 #include "codegen/testing_codegen_util.h"
 #include "codegen/type/decimal_type.h"
+#include "codegen/query_compiler.h"
 #include "common/timer.h"
 #include "expression/conjunction_expression.h"
 #include "expression/operator_expression.h"
@@ -25,6 +30,7 @@
 #include "planner/nested_loop_join_plan.h"
 #include "planner/order_by_plan.h"
 #include "planner/seq_scan_plan.h"
+#include "settings/settings_manager.h"
 
 namespace peloton {
 namespace test {
@@ -652,6 +658,252 @@ TEST_F(QueryCacheTest, CacheNestedLoopJoinPlan) {
   EXPECT_FALSE(found);
 }
 
+TEST_F(QueryCacheTest, PersistentCodeCache) {
+  auto &code_cache = codegen::CompiledCodeCache::Instance();
+  char dir_template[] = "/tmp/peloton_code_cache_XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir_template));
+  code_cache.SetDirectory(dir_template);
+  ASSERT_TRUE(code_cache.IsEnabled());
+
+  // SELECT a, b, c FROM table where a >= 20 and b = 21, compiled from scratch
+  // every time, with plans that are equal but live in different places
+  auto execute = [this]() {
+    auto scan = GetSeqScanPlanWithPredicate();
+    planner::BindingContext context;
+    scan->PerformBinding(context);
+    codegen::BufferingConsumer buffer{{0, 1, 2}, context};
+    CompileAndExecute(*scan, buffer);
+    return buffer.GetOutputTuples().size();
+  };
+
+  // The first compilation generates code, the second one reuses it
+  EXPECT_EQ(1u, execute());
+  EXPECT_EQ(0u, code_cache.GetNumHits());
+  EXPECT_EQ(1u, code_cache.GetNumMisses());
+  EXPECT_EQ(1u, code_cache.GetNumEntries());
+
+  EXPECT_EQ(1u, execute());
+  EXPECT_EQ(1u, code_cache.GetNumHits());
+  EXPECT_EQ(1u, code_cache.GetNumEntries());
+
+  // After a restart, the entry is found in the directory and can be preloaded
+  code_cache.SetDirectory("");
+  EXPECT_FALSE(code_cache.IsEnabled());
+  code_cache.SetDirectory(dir_template);
+  EXPECT_EQ(1u, code_cache.GetNumEntries());
+  EXPECT_EQ(1u, code_cache.Warmup(10));
+
+  EXPECT_EQ(1u, execute());
+  EXPECT_EQ(2u, code_cache.GetNumHits());
+  EXPECT_EQ(1u, code_cache.GetNumMisses());
+
+  code_cache.Clear();
+  EXPECT_EQ(0u, code_cache.GetNumEntries());
+  code_cache.SetDirectory("");
+  std::remove((std::string{dir_template} + "/index").c_str());
+  rmdir(dir_template);
+}
+
+TEST_F(QueryCacheTest, PersistentCodeCacheCapacity) {
+  auto &code_cache = codegen::CompiledCodeCache::Instance();
+  char dir_template[] = "/tmp/peloton_code_cache_XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir_template));
+  code_cache.SetDirectory(dir_template);
+  ASSERT_TRUE(code_cache.IsEnabled());
+
+  // Keep a single entry, and no object code in memory
+  code_cache.SetCapacity(1, 0);
+
+  auto execute = [this](std::shared_ptr<planner::SeqScanPlan> scan) {
+    planner::BindingContext context;
+    scan->PerformBinding(context);
+    codegen::BufferingConsumer buffer{{0, 1}, context};
+    CompileAndExecute(*scan, buffer);
+    return buffer.GetOutputTuples().size();
+  };
+
+  // The second plan evicts the first one
+  uint64_t num_hits = code_cache.GetNumHits();
+  uint64_t num_misses = code_cache.GetNumMisses();
+  auto num_rows = execute(GetSeqScanPlan());
+  execute(GetSeqScanPlanWithPredicate());
+  EXPECT_EQ(num_misses + 2, code_cache.GetNumMisses());
+  EXPECT_EQ(1u, code_cache.GetNumEntries());
+  EXPECT_EQ(0u, code_cache.GetMemorySize());
+
+  // The first plan is compiled again, and then its code is read from disk
+  EXPECT_EQ(num_rows, execute(GetSeqScanPlan()));
+  EXPECT_EQ(num_misses + 3, code_cache.GetNumMisses());
+  EXPECT_EQ(num_rows, execute(GetSeqScanPlan()));
+  EXPECT_EQ(num_hits + 1, code_cache.GetNumHits());
+
+  // Once the object file is gone, the entry no longer counts as cached and
+  // the plan is compiled (and optimized) again
+  DIR *dir = opendir(dir_template);
+  ASSERT_NE(nullptr, dir);
+  while (struct dirent *file = readdir(dir)) {
+    std::string name{file->d_name};
+    if (name.size() > 2 && name.substr(name.size() - 2) == ".o") {
+      std::remove((std::string{dir_template} + "/" + name).c_str());
+    }
+  }
+  closedir(dir);
+  EXPECT_EQ(num_rows, execute(GetSeqScanPlan()));
+  EXPECT_EQ(num_hits + 1, code_cache.GetNumHits());
+  EXPECT_EQ(num_misses + 4, code_cache.GetNumMisses());
+  EXPECT_EQ(1u, code_cache.GetNumEntries());
+
+  code_cache.SetCapacity(
+      settings::SettingsManager::GetInt(
+          settings::SettingId::codegen_cache_max_entries),
+      static_cast<uint64_t>(settings::SettingsManager::GetInt(
+          settings::SettingId::codegen_cache_memory_size))
+          << 20);
+  code_cache.Clear();
+  code_cache.SetDirectory("");
+  std::remove((std::string{dir_template} + "/index").c_str());
+  rmdir(dir_template);
+}
+
+TEST_F(QueryCacheTest, TieredOptimization) {
+  // The hash join produces the same result at every optimization level
+  for (auto opt_level : {codegen::OptimizationLevel::None,
+                         codegen::OptimizationLevel::Default,
+                         codegen::OptimizationLevel::Aggressive}) {
+    auto plan = GetHashJoinPlan();
+    planner::BindingContext context;
+    plan->PerformBinding(context);
+    codegen::BufferingConsumer buffer{{0, 1, 2, 3}, context};
+    CompileAndExecute(*plan, buffer, opt_level);
+    EXPECT_EQ(64u, buffer.GetOutputTuples().size());
+  }
+
+  // The level follows the estimated size of the query
+  std::function<void(planner::AbstractPlan &, int)> set_cardinality = [&](
+      planner::AbstractPlan &plan, int cardinality) {
+    plan.SetCardinality(cardinality);
+    for (const auto &child : plan.GetChildren()) {
+      set_cardinality(*child, cardinality);
+    }
+  };
+  auto plan = GetHashJoinPlan();
+  set_cardinality(*plan, 10);
+  EXPECT_EQ(codegen::OptimizationLevel::None,
+            codegen::QueryCompiler::ChooseOptimizationLevel(*plan));
+  set_cardinality(*plan, 50000);
+  EXPECT_EQ(codegen::OptimizationLevel::Default,
+            codegen::QueryCompiler::ChooseOptimizationLevel(*plan));
+  plan->SetCardinality(100000000);
+  EXPECT_EQ(codegen::OptimizationLevel::Aggressive,
+            codegen::QueryCompiler::ChooseOptimizationLevel(*plan));
+
+  // A cached query asks to be recompiled once, after it has run often enough
+  codegen::QueryCache::Instance().Clear();
+  settings::SettingsManager::SetInt(
+      settings::SettingId::codegen_hot_query_executions, 2);
+  plan = GetHashJoinPlan();
+  bool cached;
+  for (uint32_t i = 0; i < 2; i++) {
+    planner::BindingContext context;
+    plan->PerformBinding(context);
+    codegen::BufferingConsumer buffer{{0, 1, 2, 3}, context};
+    CompileAndExecuteCache(plan, buffer, cached);
+  }
+  codegen::Query *query = codegen::QueryCache::Instance().Find(plan);
+  ASSERT_NE(nullptr, query);
+  EXPECT_EQ(2u, query->GetNumExecutions());
+  EXPECT_TRUE(query->NeedsRecompilation());
+  EXPECT_FALSE(query->NeedsRecompilation());
+
+  // Recompile a copy of the plan, and install the result
+  std::shared_ptr<planner::AbstractPlan> plan_copy{plan->Copy()};
+  planner::BindingContext copy_context;
+  plan_copy->PerformBinding(copy_context);
+  codegen::BufferingConsumer copy_buffer{{0, 1, 2, 3}, copy_context};
+  codegen::QueryParameters parameters{*plan_copy, {}};
+  auto recompiled = codegen::QueryCompiler().Compile(
+      *plan_copy, parameters.GetQueryParametersMap(), copy_buffer, nullptr,
+      codegen::OptimizationLevel::Aggressive);
+  recompiled->Compile();
+  query->GetRecompilationTarget()->Install(std::move(recompiled), plan_copy);
+  EXPECT_TRUE(query->IsRecompiled());
+
+  // Further executions run the recompiled code
+  planner::BindingContext context;
+  plan->PerformBinding(context);
+  codegen::BufferingConsumer buffer{{0, 1, 2, 3}, context};
+  CompileAndExecuteCache(plan, buffer, cached);
+  EXPECT_TRUE(cached);
+  EXPECT_EQ(64u, buffer.GetOutputTuples().size());
+
+  // A recompilation that finishes after its query is gone is dropped
+  auto target = query->GetRecompilationTarget();
+  codegen::QueryCache::Instance().Clear();
+  target->Install(nullptr, nullptr);
+
+  settings::SettingsManager::SetInt(
+      settings::SettingId::codegen_hot_query_executions, 100);
+}
+
+TEST_F(QueryCacheTest, AsyncCompilation) {
+  codegen::QueryCache::Instance().Clear();
+
+  // Threads that miss on equal plans at the same time share one query
+  constexpr uint32_t num_threads = 4;
+  std::vector<std::shared_ptr<planner::AbstractPlan>> plans;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    plans.push_back(GetHashJoinPlan());
+  }
+  std::vector<codegen::Query *> queries(num_threads);
+  std::atomic<uint32_t> num_created{0};
+  std::shared_future<void> compilation;
+  auto find_or_add = [&](uint64_t tid) {
+    auto &plan = plans[tid];
+    planner::BindingContext context;
+    plan->PerformBinding(context);
+    codegen::BufferingConsumer buffer{{0, 1, 2, 3}, context};
+    codegen::QueryParameters parameters{*plan, {}};
+    queries[tid] = codegen::QueryCache::Instance().FindOrAdd(plan, [&]() {
+      num_created++;
+      auto query = codegen::QueryCompiler().Compile(
+          *plan, parameters.GetQueryParametersMap(), buffer);
+      compilation = query->CompileAsync();
+      return query;
+    });
+  };
+  LaunchParallelTest(num_threads, find_or_add);
+  EXPECT_EQ(1u, num_created.load());
+  EXPECT_EQ(1u, codegen::QueryCache::Instance().GetCount());
+  for (uint32_t i = 1; i < num_threads; i++) {
+    EXPECT_EQ(queries[0], queries[i]);
+  }
+
+  // The query runs whether or not its native code is ready yet
+  bool cached;
+  {
+    planner::BindingContext context;
+    plans[0]->PerformBinding(context);
+    codegen::BufferingConsumer buffer{{0, 1, 2, 3}, context};
+    CompileAndExecuteCache(plans[0], buffer, cached);
+    EXPECT_TRUE(cached);
+    EXPECT_EQ(64u, buffer.GetOutputTuples().size());
+  }
+
+  // And once it is
+  compilation.get();
+  EXPECT_TRUE(queries[0]->IsCompiled());
+  {
+    planner::BindingContext context;
+    plans[1]->PerformBinding(context);
+    codegen::BufferingConsumer buffer{{0, 1, 2, 3}, context};
+    CompileAndExecuteCache(plans[1], buffer, cached);
+    EXPECT_TRUE(cached);
+    EXPECT_EQ(64u, buffer.GetOutputTuples().size());
+  }
+
+  codegen::QueryCache::Instance().Clear();
+}
+
 TEST_F(QueryCacheTest, PerformanceBenchmark) {
   codegen::QueryCache::Instance().Clear();
   Timer<std::ratio<1, 1000>> timer1, timer2;
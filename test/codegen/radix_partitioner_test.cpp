@@ -0,0 +1,255 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// radix_partitioner_test.cpp
+//
+// Identification: test/codegen/radix_partitioner_test.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <set>
+
+#include "common/harness.h"
+#include "codegen/util/hash_table.h"
+#include "codegen/util/radix_partitioner.h"
+#include "executor/executor_context.h"
+
+namespace peloton {
+namespace test {
+
+/**
+ * The tuples we partition. The key comes first, so that partitions can be
+ * turned into hash tables keyed on it.
+ */
+struct Tuple {
+  uint32_t key;
+  uint32_t val;
+};
+
+/**
+ * The base radix partitioner test class
+ */
+class RadixPartitionerTest : public PelotonTest {
+ public:
+  RadixPartitionerTest() : pool_(new ::peloton::type::EphemeralPool()) {}
+
+  type::AbstractPool &GetMemPool() const { return *pool_; }
+
+  // The partitioner uses the high bits of the hash, so mix all the key's bits
+  // into them (Murmur3's 64-bit finalizer)
+  static uint64_t Hash(uint32_t key) {
+    uint64_t h = key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdLLU;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53LLU;
+    h ^= h >> 33;
+    return h;
+  }
+
+  static void Insert(codegen::util::RadixPartitioner &partitioner,
+                     uint32_t key) {
+    auto *tuple = reinterpret_cast<Tuple *>(partitioner.Insert(Hash(key)));
+    tuple->key = key;
+    tuple->val = key * 2;
+  }
+
+ private:
+  std::unique_ptr<::peloton::type::AbstractPool> pool_;
+};
+
+TEST_F(RadixPartitionerTest, PartitionByHashBits) {
+  constexpr uint32_t num_radix_bits = 4;
+  constexpr uint32_t to_insert = 10000;
+
+  codegen::util::RadixPartitioner partitioner{GetMemPool(), sizeof(Tuple),
+                                              num_radix_bits};
+  EXPECT_EQ(1u << num_radix_bits, partitioner.NumPartitions());
+
+  for (uint32_t i = 0; i < to_insert; i++) {
+    Insert(partitioner, i);
+  }
+  partitioner.FlushBuffers();
+  EXPECT_EQ(to_insert, partitioner.NumElements());
+
+  // Every tuple must show up exactly once, in the partition its hash selects
+  std::set<uint32_t> seen;
+  uint64_t total = 0;
+  for (uint32_t p = 0; p < partitioner.NumPartitions(); p++) {
+    uint64_t count = 0;
+    for (auto *entry = partitioner.LinkPartition(p); entry != nullptr;
+         entry = entry->next) {
+      auto *tuple = reinterpret_cast<const Tuple *>(entry->data);
+      EXPECT_EQ(Hash(tuple->key), entry->hash);
+      EXPECT_EQ(p, partitioner.PartitionOf(entry->hash));
+      EXPECT_EQ(tuple->key * 2, tuple->val);
+      EXPECT_TRUE(seen.insert(tuple->key).second);
+      count++;
+    }
+    EXPECT_EQ(partitioner.PartitionSize(p), count);
+    // With a decent hash, no partition should be empty
+    EXPECT_GT(count, 0u);
+    total += count;
+  }
+  EXPECT_EQ(to_insert, total);
+}
+
+TEST_F(RadixPartitionerTest, BuildPartitionTable) {
+  constexpr uint32_t num_radix_bits = 3;
+  constexpr uint32_t to_insert = 5000;
+
+  codegen::util::RadixPartitioner partitioner{GetMemPool(), sizeof(Tuple),
+                                              num_radix_bits};
+
+  // Insert every key twice
+  for (uint32_t i = 0; i < to_insert; i++) {
+    Insert(partitioner, i);
+    Insert(partitioner, i);
+  }
+  partitioner.FlushBuffers();
+
+  // The same hash table is reused for all partitions
+  codegen::util::HashTable table{GetMemPool(), sizeof(uint32_t),
+                                 sizeof(uint32_t)};
+  for (uint32_t p = 0; p < partitioner.NumPartitions(); p++) {
+    partitioner.BuildPartitionTable(p, table);
+    EXPECT_EQ(partitioner.PartitionSize(p), table.NumElements());
+
+    for (uint32_t i = 0; i < to_insert; i++) {
+      uint64_t hash = Hash(i);
+      uint32_t count = 0;
+      std::function<void(const uint32_t &)> f = [&count, i](
+          const uint32_t &val) {
+        EXPECT_EQ(i * 2, val);
+        count++;
+      };
+      table.TypedProbe(hash, i, f);
+
+      // Only the keys of this partition are found
+      uint32_t expected = partitioner.PartitionOf(hash) == p ? 2 : 0;
+      EXPECT_EQ(expected, count) << "Key " << i << " in partition " << p;
+    }
+  }
+}
+
+TEST_F(RadixPartitionerTest, TransferPartitions) {
+  constexpr uint32_t num_threads = 4;
+  constexpr uint32_t num_radix_bits = 5;
+  constexpr uint32_t to_insert = 20000;
+
+  executor::ExecutorContext exec_ctx{nullptr};
+
+  // Allocate partitioners for each thread
+  auto &thread_states = exec_ctx.GetThreadStates();
+  thread_states.Reset(sizeof(codegen::util::RadixPartitioner));
+  thread_states.Allocate(num_threads);
+
+  // Partition disjoint key ranges in parallel
+  auto partition_fn = [&exec_ctx](uint64_t tid) {
+    auto *partitioner = reinterpret_cast<codegen::util::RadixPartitioner *>(
+        exec_ctx.GetThreadStates().AccessThreadState(tid));
+    codegen::util::RadixPartitioner::Init(*partitioner, exec_ctx,
+                                          sizeof(Tuple), num_radix_bits);
+    for (uint32_t i = tid * to_insert, end = i + to_insert; i != end; i++) {
+      Insert(*partitioner, i);
+    }
+  };
+  LaunchParallelTest(num_threads, partition_fn);
+
+  // Move everything into the global partitioner
+  codegen::util::RadixPartitioner global{*exec_ctx.GetPool(), sizeof(Tuple),
+                                         num_radix_bits};
+  global.TransferPartitions(thread_states, 0);
+  EXPECT_EQ(to_insert * num_threads, global.NumElements());
+
+  // The thread-local partitioners are empty now
+  for (uint32_t tid = 0; tid < num_threads; tid++) {
+    auto *partitioner = reinterpret_cast<codegen::util::RadixPartitioner *>(
+        thread_states.AccessThreadState(tid));
+    EXPECT_EQ(0u, partitioner->NumElements());
+    codegen::util::RadixPartitioner::Destroy(*partitioner);
+  }
+
+  // Check that all tuples arrived in the right partition
+  std::set<uint32_t> seen;
+  for (uint32_t p = 0; p < global.NumPartitions(); p++) {
+    for (auto *entry = global.LinkPartition(p); entry != nullptr;
+         entry = entry->next) {
+      auto *tuple = reinterpret_cast<const Tuple *>(entry->data);
+      EXPECT_EQ(p, global.PartitionOf(entry->hash));
+      EXPECT_TRUE(seen.insert(tuple->key).second);
+    }
+  }
+  EXPECT_EQ(to_insert * num_threads, seen.size());
+}
+
+TEST_F(RadixPartitionerTest, SpillPartitions) {
+  constexpr uint32_t num_radix_bits = 3;
+  constexpr uint32_t to_insert = 50000;
+
+  // A query with a tiny memory budget
+  executor::ExecutorContext exec_ctx{nullptr};
+  exec_ctx.SetMemoryBudget(64 * 1024);
+
+  auto *partitioner = reinterpret_cast<codegen::util::RadixPartitioner *>(
+      exec_ctx.GetPool()->Allocate(sizeof(codegen::util::RadixPartitioner)));
+  codegen::util::RadixPartitioner::Init(*partitioner, exec_ctx, sizeof(Tuple),
+                                        num_radix_bits);
+  for (uint32_t i = 0; i < to_insert; i++) {
+    Insert(*partitioner, i);
+  }
+  partitioner->FlushBuffers();
+  EXPECT_EQ(to_insert, partitioner->NumElements());
+
+  // Most of the input must have gone to disk
+  EXPECT_GT(partitioner->NumSpilledElements(), to_insert / 2);
+  EXPECT_GT(exec_ctx.GetSpilledBytes(), 0u);
+
+  // Spilled tuples are read back, one partition at a time
+  std::set<uint32_t> seen;
+  for (uint32_t p = 0; p < partitioner->NumPartitions(); p++) {
+    uint64_t count = 0;
+    for (auto *entry = partitioner->LinkPartition(p); entry != nullptr;
+         entry = entry->next) {
+      auto *tuple = reinterpret_cast<const Tuple *>(entry->data);
+      EXPECT_EQ(Hash(tuple->key), entry->hash);
+      EXPECT_EQ(p, partitioner->PartitionOf(entry->hash));
+      EXPECT_EQ(tuple->key * 2, tuple->val);
+      EXPECT_TRUE(seen.insert(tuple->key).second);
+      count++;
+    }
+    EXPECT_EQ(partitioner->PartitionSize(p), count);
+
+    // Releasing the partition frees its memory again
+    partitioner->ReleasePartition(p);
+    EXPECT_EQ(0u, partitioner->PartitionSize(p));
+    EXPECT_EQ(nullptr, partitioner->LinkPartition(p));
+  }
+  EXPECT_EQ(to_insert, seen.size());
+
+  codegen::util::RadixPartitioner::Destroy(*partitioner);
+}
+
+TEST_F(RadixPartitionerTest, ChooseRadixBits) {
+  using RadixPartitioner = codegen::util::RadixPartitioner;
+
+  // Small inputs still need a partition per side
+  EXPECT_EQ(1u, RadixPartitioner::ChooseRadixBits(0, sizeof(Tuple)));
+  EXPECT_EQ(1u, RadixPartitioner::ChooseRadixBits(100, sizeof(Tuple)));
+
+  // The fan-out grows with the input, up to the maximum
+  uint32_t prev_bits = 1;
+  for (uint64_t num_tuples = 1000; num_tuples < 100000000; num_tuples *= 10) {
+    uint32_t bits = RadixPartitioner::ChooseRadixBits(num_tuples, 64);
+    EXPECT_GE(bits, prev_bits);
+    prev_bits = bits;
+  }
+  EXPECT_EQ(RadixPartitioner::kMaxRadixBits,
+            RadixPartitioner::ChooseRadixBits(1ull << 40, 64));
+}
+
+}  // namespace test
+}  // namespace peloton
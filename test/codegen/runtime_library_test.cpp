@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// runtime_library_test.cpp
+//
+// Identification: test/codegen/runtime_library_test.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+
+#include "codegen/codegen.h"
+#include "codegen/function_builder.h"
+#include "codegen/proxy/runtime_functions_proxy.h"
+#include "codegen/runtime_functions.h"
+#include "codegen/runtime_library.h"
+#include "common/harness.h"
+#include "settings/settings_manager.h"
+
+namespace peloton {
+namespace test {
+
+class RuntimeLibraryTest : public PelotonTest {};
+
+TEST_F(RuntimeLibraryTest, InlineRuntimeFunctions) {
+  // The bitcode is empty if the build found no clang matching our LLVM
+  auto &runtime = codegen::RuntimeLibrary::Instance();
+  const std::string *crc_symbol = runtime.LookupFunction(
+      reinterpret_cast<const void *>(&codegen::RuntimeFunctions::HashCrc64));
+  const std::string *murmur_symbol = runtime.LookupFunction(
+      reinterpret_cast<const void *>(&codegen::RuntimeFunctions::HashMurmur3));
+  if (crc_symbol == nullptr && murmur_symbol == nullptr) {
+    LOG_INFO("No runtime bitcode to inline, skipping");
+    return;
+  }
+  ASSERT_TRUE(settings::SettingsManager::GetBool(
+      settings::SettingId::codegen_inline_runtime));
+
+  // Generate a function like so:
+  // define i64 @test(i8* %buf, i64 %len) {
+  //   %crc = call i64 @HashCrc64(i8* %buf, i64 %len, i64 0)
+  //   %hash = call i64 @HashMurmur3(i8* %buf, i64 %len, i64 %crc)
+  //   ret i64 %hash
+  // }
+  codegen::CodeContext code_context;
+  codegen::CodeGen cg{code_context};
+  codegen::FunctionBuilder func{code_context,
+                                "test",
+                                cg.Int64Type(),
+                                {{"buf", cg.CharPtrType()},
+                                 {"len", cg.Int64Type()}}};
+  {
+    auto *buf = func.GetArgumentByPosition(0);
+    auto *len = func.GetArgumentByPosition(1);
+    auto *crc = cg.Call(codegen::RuntimeFunctionsProxy::HashCrc64,
+                        {buf, len, cg.Const64(0)});
+    auto *hash =
+        cg.Call(codegen::RuntimeFunctionsProxy::HashMurmur3, {buf, len, crc});
+    func.ReturnAndFinish(hash);
+  }
+
+  code_context.Optimize();
+
+  // The runtime functions with bitcode are no longer called, their code is
+  // part of the query function now
+  for (auto &block : *func.GetFunction()) {
+    for (auto &inst : block) {
+      auto *call = llvm::dyn_cast<llvm::CallInst>(&inst);
+      if (call == nullptr) {
+        continue;
+      }
+      auto *callee = llvm::dyn_cast<llvm::Function>(
+          call->getCalledValue()->stripPointerCasts());
+      ASSERT_NE(nullptr, callee);
+      std::string name = callee->getName().str();
+      EXPECT_TRUE(crc_symbol == nullptr || name != *crc_symbol) << name;
+      EXPECT_TRUE(murmur_symbol == nullptr || name != *murmur_symbol) << name;
+    }
+  }
+  for (const auto *symbol : {crc_symbol, murmur_symbol}) {
+    if (symbol != nullptr) {
+      auto *linked = code_context.GetModule().getFunction(*symbol);
+      EXPECT_TRUE(linked == nullptr || !linked->isDeclaration()) << *symbol;
+    }
+  }
+
+  // The inlined code computes what the runtime does
+  code_context.Compile();
+
+  typedef uint64_t (*func_t)(const char *, uint64_t);
+  func_t fn = (func_t)code_context.GetRawFunctionPointer(func.GetFunction());
+  const char data[] = "runtime functions inlined into the query";
+  uint64_t len = std::strlen(data);
+  uint64_t crc = codegen::RuntimeFunctions::HashCrc64(data, len, 0);
+  EXPECT_EQ(codegen::RuntimeFunctions::HashMurmur3(data, len, crc),
+            fn(data, len));
+}
+
+}  // namespace test
+}  // namespace peloton
@@ -162,5 +162,72 @@ TEST_F(SorterTest, ParallelSortTest) {
   }
 }
 
+TEST_F(SorterTest, ExternalSortTest) {
+  // A query with a tiny memory budget
+  executor::ExecutorContext ctx(nullptr);
+  ctx.SetMemoryBudget(64 * 1024);
+
+  uint32_t num_tuples = 100000;
+
+  auto *sorter = reinterpret_cast<codegen::util::Sorter *>(
+      ctx.GetPool()->Allocate(sizeof(codegen::util::Sorter)));
+  codegen::util::Sorter::Init(*sorter, ctx, CompareTuplesForAscending,
+                              sizeof(TestTuple));
+  LoadSorter(*sorter, num_tuples);
+
+  // The input doesn't fit into the budget, so runs must have been spilled
+  EXPECT_GT(sorter->NumRuns(), 1u);
+  EXPECT_GT(ctx.GetNumSpills(), 0u);
+
+  sorter->Sort();
+
+  // All tuples come back sorted from the merged runs
+  CheckSorted(*sorter, true);
+  EXPECT_EQ(num_tuples, sorter->NumTuples());
+  EXPECT_EQ(0u, sorter->NumRuns());
+  EXPECT_GE(ctx.GetSpilledBytes(), 2 * num_tuples * sizeof(TestTuple));
+
+  codegen::util::Sorter::Destroy(*sorter);
+}
+
+TEST_F(SorterTest, ParallelExternalSortTest) {
+  executor::ExecutorContext ctx(nullptr);
+  ctx.SetMemoryBudget(256 * 1024);
+
+  uint32_t num_threads = 4;
+  uint32_t ntuples_per_sorter = 50000;
+
+  auto &thread_states = ctx.GetThreadStates();
+  thread_states.Reset(sizeof(codegen::util::Sorter));
+  thread_states.Allocate(num_threads);
+
+  for (uint32_t i = 0; i < num_threads; i++) {
+    auto *sorter = reinterpret_cast<codegen::util::Sorter *>(
+        thread_states.AccessThreadState(i));
+    codegen::util::Sorter::Init(*sorter, ctx, CompareTuplesForAscending,
+                                sizeof(TestTuple));
+    LoadSorter(*sorter, ntuples_per_sorter);
+  }
+
+  {
+    codegen::util::Sorter main_sorter{*ctx.GetPool(), CompareTuplesForAscending,
+                                      sizeof(TestTuple), &ctx};
+
+    // Since the thread-local sorters spilled, all runs are merged serially
+    main_sorter.SortParallel(thread_states, 0);
+
+    CheckSorted(main_sorter, true);
+    EXPECT_EQ(num_threads * ntuples_per_sorter, main_sorter.NumTuples());
+    EXPECT_GT(ctx.GetNumSpills(), 0u);
+
+    for (uint32_t i = 0; i < num_threads; i++) {
+      auto *sorter = reinterpret_cast<codegen::util::Sorter *>(
+          thread_states.AccessThreadState(i));
+      EXPECT_EQ(0u, sorter->NumRuns());
+      codegen::util::Sorter::Destroy(*sorter);
+    }
+  }
+}
+
 }  // namespace test
 }  // namespace peloton
\ No newline at end of file
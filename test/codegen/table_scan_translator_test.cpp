@@ -664,6 +664,70 @@ TEST_F(TableScanTranslatorTest, ScanColumnLayout) {
   ScanLayoutTable(tuples_per_tilegroup, tilegroup_count, column_count);
 }
 
+TEST_F(TableScanTranslatorTest, ScanColumnLayoutWithRangePredicate) {
+  //
+  // SELECT a, b FROM table
+  // WHERE a >= 37 AND 250 > b AND c <= 1000.5 AND a + c != 100;
+  //
+  // The first three conjuncts are evaluated on column vectors, the last one
+  // row by row. Tile groups hold 100 rows, so every tile group also has rows
+  // that don't fill a whole vector.
+  //
+  uint32_t tuples_per_tilegroup = 100;
+  uint32_t tilegroup_count = 5;
+  uint32_t column_count = 4;
+  bool is_inlined = true;
+  CreateAndLoadTableWithLayout(LayoutType::COLUMN, tuples_per_tilegroup,
+                               tilegroup_count, column_count, is_inlined);
+
+  // Column i of row r holds the value r + i
+  ExpressionPtr a_gte_37 =
+      CmpGteExpr(ColRefExpr(type::TypeId::INTEGER, 0), ConstIntExpr(37));
+  ExpressionPtr b_lt_250 =
+      CmpGtExpr(ConstIntExpr(250), ColRefExpr(type::TypeId::INTEGER, 1));
+  ExpressionPtr c_lte_1000 = CmpLteExpr(ColRefExpr(type::TypeId::INTEGER, 2),
+                                        ConstDecimalExpr(1000.5));
+  ExpressionPtr a_plus_c_ne_100 = CmpExpr(
+      ExpressionType::COMPARE_NOTEQUAL,
+      OpExpr(ExpressionType::OPERATOR_PLUS, type::TypeId::INTEGER,
+             ColRefExpr(type::TypeId::INTEGER, 0),
+             ColRefExpr(type::TypeId::INTEGER, 2)),
+      ConstIntExpr(100));
+
+  auto *predicate = new expression::ConjunctionExpression(
+      ExpressionType::CONJUNCTION_AND,
+      new expression::ConjunctionExpression(ExpressionType::CONJUNCTION_AND,
+                                            a_gte_37.release(),
+                                            b_lt_250.release()),
+      new expression::ConjunctionExpression(ExpressionType::CONJUNCTION_AND,
+                                            c_lte_1000.release(),
+                                            a_plus_c_ne_100.release()));
+
+  // Setup the scan plan node
+  planner::SeqScanPlan scan{GetLayoutTable(), predicate, {0, 1}};
+
+  // Do binding
+  planner::BindingContext context;
+  scan.PerformBinding(context);
+
+  // We collect the results of the query into an in-memory buffer
+  codegen::BufferingConsumer buffer{{0, 1}, context};
+
+  // COMPILE and execute
+  CompileAndExecute(scan, buffer);
+
+  // Rows 37 to 248 qualify, except for row 49 (49 + 51 = 100)
+  const auto &results = buffer.GetOutputTuples();
+  ASSERT_EQ(211u, results.size());
+  for (const auto &tuple : results) {
+    int32_t a = tuple.GetValue(0).GetAs<int32_t>();
+    EXPECT_GE(a, 37);
+    EXPECT_LE(a, 248);
+    EXPECT_NE(a, 49);
+    EXPECT_EQ(a + 1, tuple.GetValue(1).GetAs<int32_t>());
+  }
+}
+
 TEST_F(TableScanTranslatorTest, MultiLayoutScan) {
   //
   // Creates a table with LayoutType::ROW
@@ -272,7 +272,8 @@ void PelotonCodeGenTest::CreateAndLoadTableWithLayout(
 }
 
 PelotonCodeGenTest::CodeGenStats PelotonCodeGenTest::CompileAndExecute(
-    planner::AbstractPlan &plan, codegen::ExecutionConsumer &consumer) {
+    planner::AbstractPlan &plan, codegen::ExecutionConsumer &consumer,
+    codegen::OptimizationLevel opt_level) {
   codegen::QueryParameters parameters(plan, {});
 
   // Start a transaction.
@@ -282,7 +283,8 @@ PelotonCodeGenTest::CodeGenStats PelotonCodeGenTest::CompileAndExecute(
   // Compile the query.
   CodeGenStats stats;
   auto query = codegen::QueryCompiler().Compile(
-      plan, parameters.GetQueryParametersMap(), consumer, &stats.compile_stats);
+      plan, parameters.GetQueryParametersMap(), consumer, &stats.compile_stats,
+      opt_level);
 
   // Executor context
   executor::ExecutorContext exec_ctx{txn, std::move(parameters)};
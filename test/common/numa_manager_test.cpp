@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// numa_manager_test.cpp
+//
+// Identification: test/common/numa_manager_test.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/numa_manager.h"
+
+#include <thread>
+
+#include "common/harness.h"
+#include "settings/settings_manager.h"
+
+namespace peloton {
+namespace test {
+
+class NumaManagerTest : public PelotonTest {};
+
+TEST_F(NumaManagerTest, PlacementTest) {
+  auto &numa_manager = NumaManager::GetInstance();
+  uint32_t num_nodes = numa_manager.GetNumNodes();
+  EXPECT_LT(numa_manager.GetCurrentNode(), num_nodes);
+
+  // Nothing is placed by default
+  EXPECT_EQ(NumaManager::kAnyNode, numa_manager.ChooseTileGroupNode(0));
+
+  settings::SettingsManager::SetString(settings::SettingId::numa_placement,
+                                       "interleave");
+  if (num_nodes < 2) {
+    // There is nothing to spread
+    EXPECT_EQ(NumaManager::kAnyNode, numa_manager.ChooseTileGroupNode(0));
+  } else {
+    // Stripes of tile groups go to the nodes in turn
+    for (size_t offset = 0; offset < NumaManager::kInterleaveStripe; offset++) {
+      EXPECT_EQ(0, numa_manager.ChooseTileGroupNode(offset));
+      EXPECT_EQ(1, numa_manager.ChooseTileGroupNode(
+                       NumaManager::kInterleaveStripe + offset));
+    }
+  }
+  settings::SettingsManager::SetString(settings::SettingId::numa_placement,
+                                       "none");
+}
+
+TEST_F(NumaManagerTest, BindTest) {
+  auto &numa_manager = NumaManager::GetInstance();
+  uint32_t last_node = numa_manager.GetNumNodes() - 1;
+
+  // A thread bound to a node stays on it
+  std::thread thread{[&numa_manager, last_node] {
+    if (numa_manager.BindCurrentThread(last_node)) {
+      EXPECT_EQ(last_node, numa_manager.GetCurrentNode());
+    }
+  }};
+  thread.join();
+}
+
+}  // namespace test
+}  // namespace peloton
@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_cache_test.cpp
+//
+// Identification: test/common/plan_cache_test.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/plan_cache.h"
+
+#include "common/harness.h"
+#include "planner/limit_plan.h"
+#include "planner/mock_plan.h"
+#include "planner/seq_scan_plan.h"
+
+namespace peloton {
+namespace test {
+
+class PlanCacheTests : public PelotonTest {};
+
+static std::unique_ptr<planner::AbstractPlan> MakeLimitScanPlan() {
+  std::unique_ptr<planner::AbstractPlan> scan(
+      new planner::SeqScanPlan(nullptr, nullptr, {0, 1}));
+  scan->SetCardinality(1000);
+  std::unique_ptr<planner::AbstractPlan> limit(new planner::LimitPlan(10, 5));
+  limit->SetCardinality(10);
+  limit->AddChild(std::move(scan));
+  return limit;
+}
+
+TEST_F(PlanCacheTests, NormalizeTest) {
+  EXPECT_EQ("SELECT a FROM t",
+            PlanCache::NormalizeQueryString("  SELECT   a\n\tFROM t ;; "));
+  // Whitespace inside of quotes is kept as is
+  EXPECT_EQ("SELECT 'a  b' FROM \"T  1\"",
+            PlanCache::NormalizeQueryString("SELECT  'a  b' FROM  \"T  1\""));
+
+  std::vector<int32_t> no_params;
+  std::vector<int32_t> int_params = {23};
+  EXPECT_EQ(PlanCache::MakeKey("db", "SELECT * FROM t", no_params),
+            PlanCache::MakeKey("db", "SELECT *  FROM t;", no_params));
+  EXPECT_NE(PlanCache::MakeKey("db", "SELECT * FROM t", no_params),
+            PlanCache::MakeKey("db2", "SELECT * FROM t", no_params));
+  EXPECT_NE(PlanCache::MakeKey("db", "SELECT * FROM t", no_params),
+            PlanCache::MakeKey("db", "SELECT * FROM t", int_params));
+}
+
+TEST_F(PlanCacheTests, AddFindTest) {
+  PlanCache cache;
+  auto plan = MakeLimitScanPlan();
+  std::vector<FieldInfo> tuple_descriptor = {
+      std::make_tuple("a", 23, 4), std::make_tuple("b", 23, 4)};
+  std::set<oid_t> table_ids = {7};
+
+  auto key = PlanCache::MakeKey("db", "SELECT a, b FROM t LIMIT 10 OFFSET 5",
+                                std::vector<int32_t>());
+  CachedPlan result;
+  EXPECT_FALSE(cache.Find(key, result));
+  EXPECT_EQ(1, cache.GetMissCount());
+
+  cache.Add(key, plan.get(), tuple_descriptor, table_ids, {},
+            cache.GetVersion());
+  EXPECT_EQ(1, cache.GetCount());
+
+  EXPECT_TRUE(cache.Find(key, result));
+  EXPECT_EQ(1, cache.GetHitCount());
+  EXPECT_EQ(tuple_descriptor, result.tuple_descriptor);
+  EXPECT_EQ(table_ids, result.table_ids);
+
+  // The returned plan is a deep copy
+  ASSERT_NE(nullptr, result.plan_tree);
+  EXPECT_NE(plan.get(), result.plan_tree.get());
+  EXPECT_EQ(PlanNodeType::LIMIT, result.plan_tree->GetPlanNodeType());
+  ASSERT_EQ(1, result.plan_tree->GetChildren().size());
+  EXPECT_EQ(PlanNodeType::SEQSCAN,
+            result.plan_tree->GetChild(0)->GetPlanNodeType());
+  auto &limit = static_cast<const planner::LimitPlan &>(*result.plan_tree);
+  EXPECT_EQ(10, limit.GetLimit());
+  EXPECT_EQ(5, limit.GetOffset());
+
+  // The estimates the compiler relies on are kept
+  EXPECT_EQ(10, result.plan_tree->GetCardinality());
+  EXPECT_EQ(1000, result.plan_tree->GetChild(0)->GetCardinality());
+
+  // Each lookup hands out its own copy
+  CachedPlan other_result;
+  EXPECT_TRUE(cache.Find(key, other_result));
+  EXPECT_NE(result.plan_tree.get(), other_result.plan_tree.get());
+}
+
+TEST_F(PlanCacheTests, NotCacheableTest) {
+  PlanCache cache;
+  std::unique_ptr<planner::AbstractPlan> plan(new MockPlan());
+  EXPECT_FALSE(PlanCache::IsCacheable(plan.get()));
+  EXPECT_TRUE(PlanCache::IsCacheable(MakeLimitScanPlan().get()));
+
+  cache.Add("mock", plan.get(), {}, {}, {}, cache.GetVersion());
+  EXPECT_EQ(0, cache.GetCount());
+}
+
+TEST_F(PlanCacheTests, InvalidateTest) {
+  PlanCache cache;
+  auto plan = MakeLimitScanPlan();
+  cache.Add("q1", plan.get(), {}, {1, 2}, {}, cache.GetVersion());
+  cache.Add("q2", plan.get(), {}, {2}, {}, cache.GetVersion());
+  cache.Add("q3", plan.get(), {}, {3}, {}, cache.GetVersion());
+  EXPECT_EQ(3, cache.GetCount());
+
+  // Dropping table 2 must evict both plans referencing it
+  cache.InvalidateTableOid(2);
+  EXPECT_EQ(1, cache.GetCount());
+  CachedPlan result;
+  EXPECT_FALSE(cache.Find("q1", result));
+  EXPECT_FALSE(cache.Find("q2", result));
+  EXPECT_TRUE(cache.Find("q3", result));
+
+  // Invalidating an unknown table is a no-op
+  cache.InvalidateTableOid(1);
+  EXPECT_EQ(1, cache.GetCount());
+}
+
+TEST_F(PlanCacheTests, StaleAddTest) {
+  PlanCache cache;
+  auto plan = MakeLimitScanPlan();
+
+  // A plan made before DDL committed must not be added after it
+  uint64_t version = cache.GetVersion();
+  cache.InvalidateTableOid(1);
+  cache.Add("q1", plan.get(), {}, {1}, {}, version);
+  EXPECT_EQ(0, cache.GetCount());
+
+  cache.Add("q1", plan.get(), {}, {1}, {}, cache.GetVersion());
+  EXPECT_EQ(1, cache.GetCount());
+}
+
+TEST_F(PlanCacheTests, EvictionTest) {
+  PlanCache cache;
+  cache.SetCapacity(2);
+  auto plan = MakeLimitScanPlan();
+  cache.Add("q1", plan.get(), {}, {1}, {}, cache.GetVersion());
+  cache.Add("q2", plan.get(), {}, {1}, {}, cache.GetVersion());
+
+  // Touch q1 so that q2 becomes the least recently used entry
+  CachedPlan result;
+  EXPECT_TRUE(cache.Find("q1", result));
+  cache.Add("q3", plan.get(), {}, {1}, {}, cache.GetVersion());
+  EXPECT_EQ(2, cache.GetCount());
+  EXPECT_TRUE(cache.Find("q1", result));
+  EXPECT_FALSE(cache.Find("q2", result));
+  EXPECT_TRUE(cache.Find("q3", result));
+
+  // A capacity of zero disables the cache
+  cache.SetCapacity(0);
+  EXPECT_EQ(0, cache.GetCount());
+  cache.Add("q4", plan.get(), {}, {1}, {}, cache.GetVersion());
+  EXPECT_EQ(0, cache.GetCount());
+}
+
+}  // namespace test
+}  // namespace peloton
@@ -555,6 +555,97 @@ TEST_F(AggregateTests, HashDistinctTest) {
   //}
 }
 
+TEST_F(AggregateTests, HashSpillGroupByTest) {
+  // SELECT a, d FROM table GROUP BY a, d; with a tiny memory budget
+  const int tuple_count = TESTS_TUPLES_PER_TILEGROUP;
+
+  // Create a table and wrap it in logical tiles. Every tuple is its own group.
+  auto& txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<storage::DataTable> data_table(
+      TestingExecutorUtil::CreateTable(tuple_count, false));
+  TestingExecutorUtil::PopulateTable(data_table.get(), 2 * tuple_count, false,
+                                   false, false, txn);
+  txn_manager.CommitTransaction(txn);
+
+  std::unique_ptr<executor::LogicalTile> source_logical_tile1(
+      executor::LogicalTileFactory::WrapTileGroup(data_table->GetTileGroup(0)));
+
+  std::unique_ptr<executor::LogicalTile> source_logical_tile2(
+      executor::LogicalTileFactory::WrapTileGroup(data_table->GetTileGroup(1)));
+
+  // (1-5) Setup plan node
+
+  // 1) Set up group-by columns
+  std::vector<oid_t> group_by_columns = {0, 3};
+
+  // 2) Set up project info
+  DirectMapList direct_map_list = {{0, {0, 0}}, {1, {0, 3}}};
+  std::unique_ptr<const planner::ProjectInfo> proj_info(
+      new planner::ProjectInfo(TargetList(), std::move(direct_map_list)));
+
+  // 3) Set up unique aggregates (empty)
+  std::vector<planner::AggregatePlan::AggTerm> agg_terms;
+
+  // 4) Set up predicate (empty)
+  std::unique_ptr<const expression::AbstractExpression> predicate(nullptr);
+
+  // 5) Create output table schema
+  auto data_table_schema = data_table.get()->GetSchema();
+  std::vector<oid_t> set = {0, 3};
+  std::vector<catalog::Column> columns;
+  for (auto column_index : set) {
+    columns.push_back(data_table_schema->GetColumn(column_index));
+  }
+
+  std::shared_ptr<const catalog::Schema> output_table_schema(
+      new catalog::Schema(columns));
+
+  // OK) Create the plan node
+  planner::AggregatePlan node(std::move(proj_info), std::move(predicate),
+                              std::move(agg_terms), std::move(group_by_columns),
+                              output_table_schema, AggregateType::HASH);
+
+  // Create and set up executor. Only the first group fits into the budget.
+  txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+  context->SetMemoryBudget(1);
+
+  executor::AggregateExecutor executor(&node, context.get());
+  MockExecutor child_executor;
+  executor.AddChild(&child_executor);
+
+  EXPECT_CALL(child_executor, DInit()).WillOnce(Return(true));
+
+  EXPECT_CALL(child_executor, DExecute())
+      .WillOnce(Return(true))
+      .WillOnce(Return(true))
+      .WillOnce(Return(false));
+
+  EXPECT_CALL(child_executor, GetOutput())
+      .WillOnce(Return(source_logical_tile1.release()))
+      .WillOnce(Return(source_logical_tile2.release()));
+
+  EXPECT_TRUE(executor.Init());
+
+  // Every group shows up exactly once, whether it was spilled or not
+  std::set<int32_t> groups;
+  while (executor.Execute()) {
+    std::unique_ptr<executor::LogicalTile> result_tile(executor.GetOutput());
+    for (auto tuple_id : *result_tile) {
+      int32_t a =
+          type::ValuePeeker::PeekInteger(result_tile->GetValue(tuple_id, 0));
+      EXPECT_TRUE(groups.insert(a).second);
+    }
+  }
+  txn_manager.CommitTransaction(txn);
+
+  EXPECT_EQ(static_cast<size_t>(2 * tuple_count), groups.size());
+  EXPECT_GT(context->GetNumSpills(), 0u);
+  EXPECT_GT(context->GetSpilledBytes(), 0u);
+}
+
 TEST_F(AggregateTests, HashSumGroupByTest) {
   // SELECT b, SUM(c) from table GROUP BY b;
   const int tuple_count = TESTS_TUPLES_PER_TILEGROUP;
@@ -108,7 +108,9 @@ class PelotonCodeGenTest : public PelotonTest {
 
   // Compile and execute the given plan
   CodeGenStats CompileAndExecute(
-      planner::AbstractPlan &plan, codegen::ExecutionConsumer &consumer);
+      planner::AbstractPlan &plan, codegen::ExecutionConsumer &consumer,
+      codegen::OptimizationLevel opt_level =
+          codegen::OptimizationLevel::Default);
 
   CodeGenStats CompileAndExecuteCache(
       std::shared_ptr<planner::AbstractPlan> plan,
@@ -0,0 +1,274 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// connection_dispatcher_test.cpp
+//
+// Identification: test/network/connection_dispatcher_test.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "common/harness.h"
+#include "common/init.h"
+#include "network/connection_dispatcher_task.h"
+#include "network/connection_handler_task.h"
+#include "network/peloton_server.h"
+#include "settings/settings_manager.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Connection Dispatcher Test
+//===--------------------------------------------------------------------===//
+
+class ConnectionDispatcherTests : public PelotonTest {};
+
+TEST_F(ConnectionDispatcherTests, ChooseHandlerTest) {
+  using network::ConnectionDispatcherTask;
+
+  // Without any load the connections are spread round-robin
+  std::vector<uint64_t> loads = {0, 0, 0};
+  std::vector<size_t> counts = {0, 0, 0};
+  EXPECT_EQ(0, ConnectionDispatcherTask::ChooseHandler(loads, counts, 0));
+  EXPECT_EQ(1, ConnectionDispatcherTask::ChooseHandler(loads, counts, 1));
+  EXPECT_EQ(2, ConnectionDispatcherTask::ChooseHandler(loads, counts, 5));
+
+  // Idle connections still count
+  counts = {3, 1, 2};
+  EXPECT_EQ(1, ConnectionDispatcherTask::ChooseHandler(loads, counts, 0));
+
+  // A handler with few but chatty connections is avoided
+  loads = {0, 1000, 10};
+  counts = {30, 1, 2};
+  EXPECT_EQ(2, ConnectionDispatcherTask::ChooseHandler(loads, counts, 0));
+}
+
+TEST_F(ConnectionDispatcherTests, ChooseRebalanceTest) {
+  using network::ConnectionDispatcherTask;
+  size_t from = 0, to = 0;
+
+  // Balanced handlers are left alone
+  EXPECT_FALSE(ConnectionDispatcherTask::ChooseRebalance(
+      {1000, 900, 800}, {4, 4, 4}, from, to));
+
+  // Light load is not worth moving connections for
+  EXPECT_FALSE(ConnectionDispatcherTask::ChooseRebalance({10, 0}, {4, 4},
+                                                         from, to));
+
+  // A single hot connection cannot be split
+  EXPECT_FALSE(ConnectionDispatcherTask::ChooseRebalance({5000, 0}, {1, 4},
+                                                         from, to));
+
+  EXPECT_TRUE(ConnectionDispatcherTask::ChooseRebalance(
+      {100, 5000, 10}, {4, 2, 4}, from, to));
+  EXPECT_EQ(1, from);
+  EXPECT_EQ(2, to);
+
+  // A single handler has nobody to share with
+  EXPECT_FALSE(
+      ConnectionDispatcherTask::ChooseRebalance({5000}, {4}, from, to));
+}
+
+TEST_F(ConnectionDispatcherTests, MigrationRequestTest) {
+  network::ConnectionHandlerTask hot(0), cold(1);
+
+  hot.AddLoad(10);
+  hot.AddLoad(5);
+  EXPECT_EQ(15, hot.ResetLoad());
+  EXPECT_EQ(0, hot.ResetLoad());
+
+  // A request is consumed by the first connection taking it
+  EXPECT_EQ(nullptr, hot.TakeMigrationTarget());
+  hot.RequestMigration(&cold);
+  EXPECT_EQ(&cold, hot.TakeMigrationTarget());
+  EXPECT_EQ(nullptr, hot.TakeMigrationTarget());
+
+  // A restored request does not override a newer one
+  hot.RestoreMigrationTarget(&cold);
+  EXPECT_EQ(&cold, hot.TakeMigrationTarget());
+  hot.RequestMigration(&hot);
+  hot.RestoreMigrationTarget(&cold);
+  EXPECT_EQ(&hot, hot.TakeMigrationTarget());
+}
+
+// A bare bones postgres client, so that the test controls when the server
+// sees a Sync and flushes the result
+class RawClient {
+ public:
+  explicit RawClient(int port) {
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    connected_ = connect(fd_, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+  }
+
+  ~RawClient() { close(fd_); }
+
+  bool IsConnected() const { return connected_; }
+
+  void Startup() {
+    std::string body;
+    AppendInt(body, 196608);
+    for (const char *field :
+         {"user", "default_database", "database", "default_database", ""}) {
+      body += std::string(field) + '\0';
+    }
+    std::string packet;
+    AppendInt(packet, body.size() + 4);
+    Send(packet + body);
+  }
+
+  void SendMessage(char type, const std::string &body) {
+    std::string packet(1, type);
+    AppendInt(packet, body.size() + 4);
+    Send(packet + body);
+  }
+
+  // Read one message, return its type or 0 if the connection broke
+  char ReadMessage(std::string &body) {
+    char header[5];
+    if (!Receive(header, 5)) return 0;
+    uint32_t len;
+    memcpy(&len, header + 1, 4);
+    body.resize(ntohl(len) - 4);
+    if (!body.empty() && !Receive(&body[0], body.size())) return 0;
+    return header[0];
+  }
+
+  // Read messages up to the next ReadyForQuery, return the DataRow count
+  int ReadUntilReady() {
+    int rows = 0;
+    std::string body;
+    while (true) {
+      char type = ReadMessage(body);
+      if (type == 0 || type == 'Z') return rows;
+      if (type == 'D') rows++;
+    }
+  }
+
+  static void AppendInt(std::string &buf, uint32_t value) {
+    value = htonl(value);
+    buf.append(reinterpret_cast<char *>(&value), 4);
+  }
+
+ private:
+  void Send(const std::string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+      ssize_t result = write(fd_, data.data() + sent, data.size() - sent);
+      if (result <= 0) return;
+      sent += result;
+    }
+  }
+
+  bool Receive(char *buf, size_t len) {
+    size_t received = 0;
+    while (received < len) {
+      ssize_t result = read(fd_, buf + received, len - received);
+      if (result <= 0) return false;
+      received += result;
+    }
+    return true;
+  }
+
+  int fd_;
+  bool connected_;
+};
+
+// Wait up to a few seconds for the given handler to own count connections
+static bool WaitForConnections(network::ConnectionHandlerTask *handler,
+                               size_t count) {
+  for (int i = 0; i < 500; i++) {
+    if (handler->GetConnectionCount() == count) return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+TEST_F(ConnectionDispatcherTests, LiveMigrationTest) {
+  settings::SettingsManager::SetInt(
+      settings::SettingId::connection_thread_count, 2);
+  PelotonInit::Initialize();
+  network::PelotonServer server;
+  int port = 15721;
+  try {
+    server.SetPort(port);
+    server.SetupServer();
+  } catch (ConnectionException &exception) {
+    LOG_INFO("[LaunchServer] exception when launching server");
+  }
+  std::thread server_thread([&]() { server.ServerLoop(); });
+
+  auto dispatcher = server.GetDispatcherTask();
+  ASSERT_EQ(2, dispatcher->GetHandlerCount());
+  {
+    RawClient client(port);
+    ASSERT_TRUE(client.IsConnected());
+    client.Startup();
+    client.ReadUntilReady();
+
+    // The result must be larger than the write buffer, so that its rows wait
+    // in the io wrapper as chunks until the Sync
+    client.SendMessage(
+        'Q', std::string("CREATE TABLE migrate(a INT, b VARCHAR(128));") +
+                 '\0');
+    client.ReadUntilReady();
+    const std::string padding(100, 'x');
+    for (int i = 0; i < 200; i++) {
+      std::string query = "INSERT INTO migrate VALUES (" +
+                          std::to_string(i) + ", '" + padding + "');";
+      client.SendMessage('Q', query + '\0');
+      client.ReadUntilReady();
+    }
+
+    size_t source_id =
+        dispatcher->GetHandler(0)->GetConnectionCount() == 1 ? 0 : 1;
+    auto source = dispatcher->GetHandler(source_id);
+    auto target = dispatcher->GetHandler(1 - source_id);
+    ASSERT_TRUE(WaitForConnections(source, 1));
+    // Let the handler settle between the requests before asking it to move
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    source->RequestMigration(target);
+
+    // Parse, Bind and Execute without a Sync leave the result in flight
+    const std::string query = "SELECT * FROM migrate;";
+    // Unnamed statement, no parameter types
+    client.SendMessage('P', '\0' + query + std::string(3, '\0'));
+    // Unnamed portal and statement, no formats, parameters or result formats
+    client.SendMessage('B', std::string(8, '\0'));
+    std::string execute(1, '\0');
+    RawClient::AppendInt(execute, 0);
+    client.SendMessage('E', execute);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(1, source->GetConnectionCount());
+    EXPECT_EQ(0, target->GetConnectionCount());
+
+    // Once the result is out the connection moves, and keeps working
+    client.SendMessage('S', "");
+    EXPECT_EQ(200, client.ReadUntilReady());
+    EXPECT_TRUE(WaitForConnections(target, 1));
+    EXPECT_EQ(0, source->GetConnectionCount());
+    client.SendMessage('Q', query + '\0');
+    EXPECT_EQ(200, client.ReadUntilReady());
+  }
+
+  server.Close();
+  server_thread.join();
+  PelotonInit::Shutdown();
+}
+
+}  // namespace test
+}  // namespace peloton
@@ -0,0 +1,179 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// output_chunk_buffer_test.cpp
+//
+// Identification: test/network/output_chunk_buffer_test.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "common/harness.h"
+#include "network/marshal.h"
+#include "network/network_io_wrappers.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Output Chunk Buffer Test
+//===--------------------------------------------------------------------===//
+
+class OutputChunkBufferTests : public PelotonTest {};
+
+// Collect the unconsumed bytes of the buffer
+static std::string Drain(network::OutputChunkBuffer &chunks,
+                         size_t max_iov = OUTPUT_MAX_IOVECS) {
+  std::string result;
+  while (!chunks.Empty()) {
+    std::vector<struct iovec> iov(max_iov);
+    size_t count = chunks.GetIovecs(iov.data(), max_iov);
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+      result.append(reinterpret_cast<char *>(iov[i].iov_base),
+                    iov[i].iov_len);
+      total += iov[i].iov_len;
+    }
+    chunks.Consume(total);
+  }
+  return result;
+}
+
+TEST_F(OutputChunkBufferTests, FramingTest) {
+  network::OutputChunkBuffer chunks;
+  chunks.BeginMessage(NetworkMessageType::DATA_ROW);
+  chunks.AppendInt(1, 2);
+  chunks.AppendInt(3, 4);
+  chunks.AppendBytes("abc", 3);
+  chunks.EndMessage();
+
+  // type + length + 2 byte column count + 4 byte value length + value
+  EXPECT_EQ(1 + 4 + 2 + 4 + 3, chunks.Size());
+  auto bytes = Drain(chunks);
+  ASSERT_EQ(14, bytes.size());
+  EXPECT_EQ(static_cast<char>(NetworkMessageType::DATA_ROW), bytes[0]);
+  uint32_t len;
+  memcpy(&len, &bytes[1], sizeof(len));
+  // The length covers itself but not the type byte
+  EXPECT_EQ(13, ntohl(len));
+  uint16_t colcount;
+  memcpy(&colcount, &bytes[5], sizeof(colcount));
+  EXPECT_EQ(1, ntohs(colcount));
+  EXPECT_EQ("abc", bytes.substr(11));
+  EXPECT_TRUE(chunks.Empty());
+}
+
+TEST_F(OutputChunkBufferTests, SpanChunksTest) {
+  // Tiny chunks force values and headers across chunk boundaries
+  network::OutputChunkBuffer chunks(16);
+  std::string expected;
+  for (int i = 0; i < 10; i++) {
+    std::string value(i * 3, static_cast<char>('a' + i));
+    chunks.BeginMessage(NetworkMessageType::DATA_ROW);
+    chunks.AppendBytes(value.data(), value.size());
+    chunks.EndMessage();
+
+    uint32_t len = htonl(static_cast<uint32_t>(value.size() + 4));
+    expected.push_back(static_cast<char>(NetworkMessageType::DATA_ROW));
+    expected.append(reinterpret_cast<char *>(&len), sizeof(len));
+    expected.append(value);
+  }
+  EXPECT_LT(1, chunks.ChunkCount());
+  EXPECT_EQ(expected.size(), chunks.Size());
+  EXPECT_EQ(expected, Drain(chunks, 3));
+}
+
+TEST_F(OutputChunkBufferTests, PartialConsumeTest) {
+  network::OutputChunkBuffer chunks(8);
+  chunks.AppendBytes("0123456789abcdefghij", 20);
+
+  // Consume in odd sized steps, as a partial writev would
+  std::string result;
+  while (!chunks.Empty()) {
+    struct iovec iov[OUTPUT_MAX_IOVECS];
+    size_t count = chunks.GetIovecs(iov, OUTPUT_MAX_IOVECS);
+    ASSERT_LT(0, count);
+    size_t step = std::min<size_t>(3, iov[0].iov_len);
+    result.append(reinterpret_cast<char *>(iov[0].iov_base), step);
+    chunks.Consume(step);
+  }
+  EXPECT_EQ("0123456789abcdefghij", result);
+
+  // The buffer keeps accepting bytes after being drained
+  chunks.AppendBytes("xyz", 3);
+  EXPECT_EQ("xyz", Drain(chunks));
+}
+
+TEST_F(OutputChunkBufferTests, GrowTest) {
+  // A single small message does not cost a full size chunk
+  network::OutputChunkBuffer chunks;
+  chunks.AppendBytes("abc", 3);
+  EXPECT_EQ(1, chunks.ChunkCount());
+
+  // Chunks double in size as the buffer grows
+  std::string value(3000, 'x');
+  chunks.AppendBytes(value.data(), value.size());
+  EXPECT_EQ(2, chunks.ChunkCount());
+  EXPECT_EQ("abc" + value, Drain(chunks));
+}
+
+TEST_F(OutputChunkBufferTests, DeferredWriteTest) {
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  network::PosixSocketIoWrapper io_wrapper(
+      fds[0], std::make_shared<network::ReadBuffer>(),
+      std::make_shared<network::WriteBuffer>());
+
+  // A batch large enough to be sent with writev
+  std::string expected;
+  std::unique_ptr<network::OutputPacket> rows(new network::OutputPacket());
+  rows->chunks.reset(new network::OutputChunkBuffer());
+  std::string value(100, 'v');
+  while (rows->chunks->Size() < OUTPUT_WRITEV_THRESHOLD * 2) {
+    rows->chunks->BeginMessage(NetworkMessageType::DATA_ROW);
+    rows->chunks->AppendBytes(value.data(), value.size());
+    rows->chunks->EndMessage();
+    uint32_t len = htonl(static_cast<uint32_t>(value.size() + 4));
+    expected.push_back(static_cast<char>(NetworkMessageType::DATA_ROW));
+    expected.append(reinterpret_cast<char *>(&len), sizeof(len));
+    expected.append(value);
+  }
+  EXPECT_EQ(network::Transition::PROCEED, io_wrapper.WritePacket(rows.get()));
+
+  // The message after the batch joins it at the flush
+  std::unique_ptr<network::OutputPacket> done(new network::OutputPacket());
+  done->msg_type = NetworkMessageType::READY_FOR_QUERY;
+  network::PacketPutByte(done.get(), 'I');
+  EXPECT_EQ(network::Transition::PROCEED, io_wrapper.WritePacket(done.get()));
+  uint32_t len = htonl(static_cast<uint32_t>(1 + 4));
+  expected.push_back(static_cast<char>(NetworkMessageType::READY_FOR_QUERY));
+  expected.append(reinterpret_cast<char *>(&len), sizeof(len));
+  expected.push_back('I');
+
+  // Nothing is sent before the flush
+  char byte;
+  EXPECT_EQ(-1, recv(fds[1], &byte, 1, MSG_DONTWAIT));
+
+  EXPECT_EQ(network::Transition::PROCEED, io_wrapper.FlushWriteBuffer());
+  std::string received(expected.size(), 0);
+  size_t received_len = 0;
+  while (received_len < expected.size()) {
+    auto bytes = recv(fds[1], &received[received_len],
+                      expected.size() - received_len, 0);
+    ASSERT_LT(0, bytes);
+    received_len += bytes;
+  }
+  EXPECT_EQ(expected, received);
+  EXPECT_EQ(-1, recv(fds[1], &byte, 1, MSG_DONTWAIT));
+
+  close(fds[0]);
+  close(fds[1]);
+}
+
+}  // namespace test
+}  // namespace peloton
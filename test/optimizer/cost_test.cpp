@@ -25,6 +25,7 @@
 #include "expression/tuple_value_expression.h"
 #include "expression/expression_util.h"
 #include "expression/star_expression.h"
+#include "optimizer/cost_calculator.h"
 #include "optimizer/stats/cost.h"
 #include "optimizer/stats/stats_storage.h"
 #include "optimizer/stats/table_stats.h"
@@ -34,6 +35,7 @@
 #include "type/value.h"
 #include "type/value_factory.h"
 #include "optimizer/properties.h"
+#include "settings/settings_manager.h"
 
 namespace peloton {
 namespace test {
@@ -191,5 +193,30 @@ class CostTests : public PelotonTest {};
 //
 //
 // }
+
+TEST_F(CostTests, HashJoinPartitioningTest) {
+  // A build side that fits into the cache is joined directly
+  double small_build = DEFAULT_CACHE_SIZE / DEFAULT_HASH_ENTRY_SIZE / 2;
+  EXPECT_DOUBLE_EQ(CostCalculator::HashJoinCost(small_build, 100000, false),
+                   (small_build + 100000) * DEFAULT_TUPLE_COST);
+  EXPECT_FALSE(CostCalculator::UsePartitionedHashJoin(small_build, 100000));
+
+  // A build side far larger than the cache is partitioned first
+  double large_build = DEFAULT_CACHE_SIZE / DEFAULT_HASH_ENTRY_SIZE * 100;
+  EXPECT_LT(CostCalculator::HashJoinCost(large_build, 100000, true),
+            CostCalculator::HashJoinCost(large_build, 100000, false));
+  EXPECT_TRUE(CostCalculator::UsePartitionedHashJoin(large_build, 100000));
+
+  // Unknown input sizes never pick partitioning
+  EXPECT_FALSE(CostCalculator::UsePartitionedHashJoin(-1, -1));
+
+  // Neither does a disabled setting
+  settings::SettingsManager::SetBool(
+      settings::SettingId::hash_join_partitioning, false);
+  EXPECT_FALSE(CostCalculator::UsePartitionedHashJoin(large_build, 100000));
+  settings::SettingsManager::SetBool(
+      settings::SettingId::hash_join_partitioning, true);
+}
+
 }  // namespace test
 }  // namespace peloton
@@ -22,13 +22,16 @@
 #include "executor/plan_executor.h"
 #include "executor/update_executor.h"
 #include "expression/abstract_expression.h"
+#include "expression/comparison_expression.h"
 #include "expression/operator_expression.h"
+#include "expression/tuple_value_expression.h"
 
 #include "optimizer/operator_expression.h"
 #include "optimizer/operators.h"
 #include "optimizer/optimizer.h"
 #include "optimizer/rule.h"
 #include "optimizer/rule_impls.h"
+#include "optimizer/util.h"
 #include "parser/postgresparser.h"
 #include "planner/create_plan.h"
 #include "planner/delete_plan.h"
@@ -261,5 +264,83 @@ TEST_F(OptimizerRuleTests, SimpleAssociativeRuleTest2) {
   delete root_context;
 }
 
+TEST_F(OptimizerRuleTests, SemiJoinToSemiHashJoinTest) {
+  // Query: SELECT * FROM test1 WHERE test1.a IN (SELECT b FROM test2)
+  // Both the semi join and the mark join of the subquery become a semi hash
+  // join that builds on test1 and probes with test2
+  Optimizer optimizer;
+  auto &metadata = optimizer.GetMetadata();
+
+  auto left_get = std::make_shared<OperatorExpression>(
+      LogicalGet::make(0, {}, nullptr, "test1"));
+  auto right_get = std::make_shared<OperatorExpression>(
+      LogicalGet::make(1, {}, nullptr, "test2"));
+  auto left_group = metadata.memo.InsertExpression(
+      metadata.MakeGroupExpression(left_get), false);
+  auto right_group = metadata.memo.InsertExpression(
+      metadata.MakeGroupExpression(right_get), false);
+  auto left_leaf = std::make_shared<OperatorExpression>(
+      LeafOperator::make(left_group->GetGroupID()));
+  auto right_leaf = std::make_shared<OperatorExpression>(
+      LeafOperator::make(right_group->GetGroupID()));
+
+  // The subquery column is on the left of the predicate on purpose, the keys
+  // must still be assigned to the child they belong to
+  auto predicate = new expression::ComparisonExpression(
+      ExpressionType::COMPARE_EQUAL,
+      new expression::TupleValueExpression("b", "test2"),
+      new expression::TupleValueExpression("a", "test1"));
+  std::unique_ptr<OptimizeContext> context(
+      new OptimizeContext(&metadata, nullptr));
+
+  auto check_semi_hash_join = [&](
+      const std::vector<std::shared_ptr<OperatorExpression>> &outputs) {
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ(OpType::SemiHashJoin, outputs[0]->Op().GetType());
+    auto semi_join = outputs[0]->Op().As<PhysicalSemiHashJoin>();
+    EXPECT_EQ(JoinType::SEMI, semi_join->join_type);
+    ASSERT_EQ(1, semi_join->left_keys.size());
+    ASSERT_EQ(1, semi_join->right_keys.size());
+    EXPECT_EQ("test1", static_cast<expression::TupleValueExpression *>(
+                           semi_join->left_keys[0].get())->GetTableName());
+    EXPECT_EQ("test2", static_cast<expression::TupleValueExpression *>(
+                           semi_join->right_keys[0].get())->GetTableName());
+    EXPECT_EQ(1, semi_join->join_predicates.size());
+    EXPECT_EQ(left_leaf, outputs[0]->Children()[0]);
+    EXPECT_EQ(right_leaf, outputs[0]->Children()[1]);
+  };
+
+  auto semi_join =
+      std::make_shared<OperatorExpression>(LogicalSemiJoin::make(predicate));
+  semi_join->PushChild(left_leaf);
+  semi_join->PushChild(right_leaf);
+  SemiJoinToSemiHashJoin semi_rule;
+  EXPECT_TRUE(semi_rule.Check(semi_join, context.get()));
+  std::vector<std::shared_ptr<OperatorExpression>> outputs;
+  semi_rule.Transform(semi_join, outputs, context.get());
+  check_semi_hash_join(outputs);
+
+  std::vector<AnnotatedExpression> mark_predicates =
+      util::ExtractPredicates(predicate);
+  auto mark_join = std::make_shared<OperatorExpression>(
+      LogicalMarkJoin::make(mark_predicates));
+  mark_join->PushChild(left_leaf);
+  mark_join->PushChild(right_leaf);
+  MarkJoinToSemiHashJoin mark_rule;
+  EXPECT_TRUE(mark_rule.Check(mark_join, context.get()));
+  outputs.clear();
+  mark_rule.Transform(mark_join, outputs, context.get());
+  check_semi_hash_join(outputs);
+
+  // Without an equality between the two sides there is nothing to hash on
+  auto cross_join = std::make_shared<OperatorExpression>(
+      LogicalSemiJoin::make());
+  cross_join->PushChild(left_leaf);
+  cross_join->PushChild(right_leaf);
+  outputs.clear();
+  semi_rule.Transform(cross_join, outputs, context.get());
+  EXPECT_TRUE(outputs.empty());
+}
+
 }  // namespace test
 }  // namespace peloton
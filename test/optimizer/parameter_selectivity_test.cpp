@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// parameter_selectivity_test.cpp
+//
+// Identification: test/optimizer/parameter_selectivity_test.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "common/harness.h"
+#include "optimizer/stats/column_stats.h"
+#include "optimizer/stats/parameter_selectivity.h"
+#include "type/value.h"
+#include "type/value_factory.h"
+
+namespace peloton {
+namespace test {
+
+using namespace optimizer;
+
+class ParameterSelectivityTests : public PelotonTest {};
+
+// A skewed tenant column: tenant 1 owns half of the rows, tenant 2 only a
+// handful of them and the rest is spread over 998 other tenants
+static ParameterPredicate MakeTenantPredicate(ExpressionType type,
+                                              int param_idx) {
+  ParameterPredicate predicate;
+  predicate.type = type;
+  predicate.param_idx = param_idx;
+  predicate.column_stats = std::make_shared<ColumnStats>(
+      0, 0, 0, "tenant_id", false, 10000, 1000, 0.0,
+      std::vector<double>{1, 2}, std::vector<double>{5000, 3},
+      std::vector<double>{0, 250, 500, 750, 1000});
+  return predicate;
+}
+
+TEST_F(ParameterSelectivityTests, BucketTest) {
+  EXPECT_EQ(0, ParameterSelectivity::GetBucket(0.0));
+  EXPECT_EQ(0, ParameterSelectivity::GetBucket(0.0005));
+  EXPECT_EQ(1, ParameterSelectivity::GetBucket(0.001));
+  EXPECT_EQ(2, ParameterSelectivity::GetBucket(0.05));
+  EXPECT_EQ(3, ParameterSelectivity::GetBucket(0.2));
+  EXPECT_EQ(4, ParameterSelectivity::GetBucket(0.5));
+  EXPECT_EQ(4, ParameterSelectivity::GetBucket(1.0));
+}
+
+TEST_F(ParameterSelectivityTests, ComputeSelectivityTest) {
+  auto predicate = MakeTenantPredicate(ExpressionType::COMPARE_EQUAL, 0);
+
+  // Most common values use their own frequency
+  EXPECT_DOUBLE_EQ(0.5, ParameterSelectivity::ComputeSelectivity(
+                            predicate, type::ValueFactory::GetIntegerValue(1)));
+  EXPECT_DOUBLE_EQ(0.0003,
+                   ParameterSelectivity::ComputeSelectivity(
+                       predicate, type::ValueFactory::GetIntegerValue(2)));
+
+  // Text parameters are converted before looking at the stats
+  EXPECT_DOUBLE_EQ(0.5, ParameterSelectivity::ComputeSelectivity(
+                            predicate, type::ValueFactory::GetVarcharValue("1")));
+}
+
+TEST_F(ParameterSelectivityTests, ComputeBucketsTest) {
+  std::vector<ParameterPredicate> predicates = {
+      MakeTenantPredicate(ExpressionType::COMPARE_EQUAL, 0),
+      MakeTenantPredicate(ExpressionType::COMPARE_EQUAL, 1)};
+
+  // The giant tenant and the tiny one land in different buckets
+  std::vector<type::Value> params = {type::ValueFactory::GetIntegerValue(1),
+                                     type::ValueFactory::GetIntegerValue(2)};
+  auto buckets = ParameterSelectivity::ComputeBuckets(predicates, params);
+  EXPECT_EQ(std::vector<int>({4, 0}), buckets);
+
+  // Two tiny tenants share the same buckets, and thus the same plan
+  std::vector<type::Value> small_params = {
+      type::ValueFactory::GetIntegerValue(2),
+      type::ValueFactory::GetIntegerValue(7)};
+  std::vector<type::Value> other_small_params = {
+      type::ValueFactory::GetIntegerValue(7),
+      type::ValueFactory::GetIntegerValue(2)};
+  EXPECT_EQ(ParameterSelectivity::ComputeBuckets(predicates, small_params),
+            ParameterSelectivity::ComputeBuckets(predicates,
+                                                 other_small_params));
+
+  // Missing and NULL parameters cannot be estimated
+  std::vector<type::Value> partial_params = {
+      type::ValueFactory::GetNullValueByType(type::TypeId::INTEGER)};
+  buckets = ParameterSelectivity::ComputeBuckets(predicates, partial_params);
+  EXPECT_EQ(std::vector<int>({ParameterSelectivity::UNKNOWN_BUCKET,
+                              ParameterSelectivity::UNKNOWN_BUCKET}),
+            buckets);
+}
+
+}  // namespace test
+}  // namespace peloton
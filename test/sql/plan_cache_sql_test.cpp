@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_cache_sql_test.cpp
+//
+// Identification: test/sql/plan_cache_sql_test.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+
+#include "catalog/catalog.h"
+#include "common/harness.h"
+#include "common/plan_cache.h"
+#include "common/statement_cache_manager.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "parser/postgresparser.h"
+#include "sql/testing_sql_util.h"
+#include "traffic_cop/traffic_cop.h"
+#include "type/value_factory.h"
+
+namespace peloton {
+namespace test {
+
+class PlanCacheSQLTests : public PelotonTest {};
+
+// Prepare a query on the connection of the given traffic cop
+static std::shared_ptr<Statement> PrepareQuery(tcop::TrafficCop &traffic_cop,
+                                                const std::string &query) {
+  auto &peloton_parser = parser::PostgresParser::GetInstance();
+  auto statement = traffic_cop.PrepareStatement(
+      "", query, peloton_parser.BuildParseTree(query));
+  // Preparing leaves its transaction open for the execution
+  traffic_cop.CommitQueryHelper();
+  return statement;
+}
+
+TEST_F(PlanCacheSQLTests, SharedPlanVariantsTest) {
+  StatementCacheManager::Init();
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  catalog::Catalog::GetInstance()->CreateDatabase(txn, DEFAULT_DB_NAME);
+  txn_manager.CommitTransaction(txn);
+
+  // Tenant 1 owns most of the rows, every other tenant a single one
+  TestingSQLUtil::ExecuteSQLQuery(
+      "CREATE TABLE test(a INT PRIMARY KEY, b INT);");
+  for (int i = 0; i < 200; i++) {
+    int tenant = i < 150 ? 1 : i - 148;
+    TestingSQLUtil::ExecuteSQLQuery("INSERT INTO test VALUES (" +
+                                    std::to_string(i) + ", " +
+                                    std::to_string(tenant) + ");");
+  }
+  EXPECT_EQ(ResultType::SUCCESS,
+            TestingSQLUtil::ExecuteSQLQuery("ANALYZE test;"));
+
+  auto &plan_cache = PlanCache::GetInstance();
+  plan_cache.Clear();
+  const std::string query = "SELECT a FROM test WHERE b = $1;";
+
+  // The first connection plans the query and shares the plan
+  tcop::TrafficCop first_traffic_cop;
+  auto first = PrepareQuery(first_traffic_cop, query);
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(1, first->GetParameterPredicates().size());
+  EXPECT_EQ(1, plan_cache.GetCount());
+
+  // The second connection gets the plan from the cache, along with the
+  // predicates that pick its variants
+  tcop::TrafficCop second_traffic_cop;
+  size_t hit_count = plan_cache.GetHitCount();
+  auto second = PrepareQuery(second_traffic_cop, query);
+  ASSERT_NE(nullptr, second);
+  EXPECT_EQ(hit_count + 1, plan_cache.GetHitCount());
+  ASSERT_EQ(1, second->GetParameterPredicates().size());
+
+  // So it still switches plans between the giant tenant and a tiny one
+  second_traffic_cop.SelectPlanForParams(
+      second, {type::ValueFactory::GetIntegerValue(1)});
+  second_traffic_cop.CommitQueryHelper();
+  auto giant_buckets = second->GetPlanBuckets();
+  EXPECT_FALSE(giant_buckets.empty());
+  second_traffic_cop.SelectPlanForParams(
+      second, {type::ValueFactory::GetIntegerValue(2)});
+  second_traffic_cop.CommitQueryHelper();
+  EXPECT_FALSE(second->GetPlanBuckets().empty());
+  EXPECT_NE(giant_buckets, second->GetPlanBuckets());
+  // The generic plan and the two variants
+  EXPECT_EQ(3, second->GetPlanVariantCount());
+
+  // A plan made before an index existed can't use it, so it is dropped
+  uint64_t version = plan_cache.GetVersion();
+  EXPECT_EQ(ResultType::SUCCESS, TestingSQLUtil::ExecuteSQLQuery(
+                                     "CREATE INDEX test_b ON test(b);"));
+  EXPECT_LT(version, plan_cache.GetVersion());
+  EXPECT_EQ(0, plan_cache.GetCount());
+
+  // Free the database
+  txn = txn_manager.BeginTransaction();
+  catalog::Catalog::GetInstance()->DropDatabaseWithName(txn, DEFAULT_DB_NAME);
+  txn_manager.CommitTransaction(txn);
+}
+
+}  // namespace test
+}  // namespace peloton
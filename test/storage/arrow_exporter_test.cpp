@@ -0,0 +1,155 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// arrow_exporter_test.cpp
+//
+// Identification: test/storage/arrow_exporter_test.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "common/harness.h"
+
+#include "concurrency/transaction_manager_factory.h"
+#include "executor/testing_executor_util.h"
+#include "storage/arrow_exporter.h"
+#include "storage/data_table.h"
+#include "storage/tile_group.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Arrow Exporter Tests
+//===--------------------------------------------------------------------===//
+
+class ArrowExporterTests : public PelotonTest {};
+
+namespace {
+
+template <typename T>
+T Read(const std::string &buffer, size_t position) {
+  T value;
+  memcpy(&value, buffer.data() + position, sizeof(T));
+  return value;
+}
+
+// Get the position of the object that a field of a flatbuffer table refers to
+size_t GetField(const std::string &buffer, size_t table, uint16_t field_id) {
+  size_t vtable = table - Read<int32_t>(buffer, table);
+  auto field_offset =
+      Read<uint16_t>(buffer, vtable + (field_id + 2) * sizeof(uint16_t));
+  EXPECT_NE(0, field_offset);
+  size_t field = table + field_offset;
+  return field + Read<uint32_t>(buffer, field);
+}
+
+std::string ExportTable(storage::DataTable *table, cid_t read_cid,
+                        size_t &num_rows) {
+  FILE *file = tmpfile();
+  storage::ArrowExporter exporter(table, {0, 1, 2, 3}, read_cid);
+  num_rows = exporter.Export(file);
+
+  std::string contents(ftell(file), 0);
+  rewind(file);
+  EXPECT_EQ(contents.size(), fread(&contents[0], 1, contents.size(), file));
+  fclose(file);
+  return contents;
+}
+
+}  // namespace
+
+TEST_F(ArrowExporterTests, ExportTest) {
+  const int tuple_count = TESTS_TUPLES_PER_TILEGROUP;
+  const size_t num_rows = tuple_count * 3 + 1;
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<storage::DataTable> data_table(
+      TestingExecutorUtil::CreateTable(tuple_count, false));
+  TestingExecutorUtil::PopulateTable(data_table.get(), num_rows, false, false,
+                                     false, txn);
+  txn_manager.CommitTransaction(txn);
+
+  size_t num_tile_groups = 0;
+  for (size_t offset = 0; offset < data_table->GetTileGroupCount(); offset++) {
+    if (data_table->GetTileGroup(offset)->GetNextTupleSlot() > 0) {
+      num_tile_groups++;
+    }
+  }
+
+  txn = txn_manager.BeginTransaction();
+  size_t num_exported;
+  auto contents =
+      ExportTable(data_table.get(), txn->GetReadId(), num_exported);
+  txn_manager.CommitTransaction(txn);
+  EXPECT_EQ(num_rows, num_exported);
+
+  // The file starts and ends with the magic string
+  ASSERT_GT(contents.size(), 16u);
+  EXPECT_EQ("ARROW1", contents.substr(0, 6));
+  EXPECT_EQ("ARROW1", contents.substr(contents.size() - 6));
+
+  // The schema message comes first
+  EXPECT_EQ(0xFFFFFFFF, Read<uint32_t>(contents, 8));
+  EXPECT_EQ(0u, Read<uint32_t>(contents, 12) % 8);
+
+  // The footer holds the schema and a record batch for every tile group
+  auto footer_length = Read<int32_t>(contents, contents.size() - 10);
+  ASSERT_LT(static_cast<size_t>(footer_length), contents.size());
+  auto footer_start = contents.size() - 10 - footer_length;
+  std::string footer = contents.substr(footer_start, footer_length);
+  size_t root = Read<uint32_t>(footer, 0);
+
+  auto schema = GetField(footer, root, 1);
+  auto fields = GetField(footer, schema, 1);
+  EXPECT_EQ(4u, Read<uint32_t>(footer, fields));
+
+  auto record_batches = GetField(footer, root, 3);
+  ASSERT_EQ(num_tile_groups, Read<uint32_t>(footer, record_batches));
+
+  // The blocks point to messages in the file
+  for (size_t i = 0; i < num_tile_groups; i++) {
+    size_t block = record_batches + sizeof(uint32_t) + i * 24;
+    auto offset = Read<int64_t>(footer, block);
+    EXPECT_EQ(0, offset % 8);
+    EXPECT_EQ(0xFFFFFFFF, Read<uint32_t>(contents, offset));
+  }
+}
+
+TEST_F(ArrowExporterTests, SnapshotTest) {
+  const int tuple_count = TESTS_TUPLES_PER_TILEGROUP;
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<storage::DataTable> data_table(
+      TestingExecutorUtil::CreateTable(tuple_count, false));
+  TestingExecutorUtil::PopulateTable(data_table.get(), tuple_count, false,
+                                     false, false, txn);
+  txn_manager.CommitTransaction(txn);
+
+  // Nothing was committed before the table was populated
+  size_t num_exported;
+  auto contents = ExportTable(data_table.get(), INVALID_CID, num_exported);
+  EXPECT_EQ(0u, num_exported);
+  EXPECT_EQ("ARROW1", contents.substr(contents.size() - 6));
+
+  // Uncommitted versions are left out
+  txn = txn_manager.BeginTransaction();
+  TestingExecutorUtil::PopulateTable(data_table.get(), tuple_count, false,
+                                     false, false, txn);
+  auto read_txn = txn_manager.BeginTransaction();
+  ExportTable(data_table.get(), read_txn->GetReadId(), num_exported);
+  EXPECT_EQ(static_cast<size_t>(tuple_count), num_exported);
+  txn_manager.CommitTransaction(read_txn);
+  txn_manager.CommitTransaction(txn);
+}
+
+}  // namespace test
+}  // namespace peloton
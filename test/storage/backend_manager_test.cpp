@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <vector>
+
 #include "common/harness.h"
 
 #include "storage/backend_manager.h"
@@ -54,5 +56,81 @@ TEST_F(StorageManagerTests, BasicTest) {
   }
 }
 
+TEST_F(StorageManagerTests, AllocatePagesTest) {
+  peloton::storage::BackendManager backend_manager;
+  const size_t large = 8 * storage::BackendManager::kHugePageSize + 17;
+  const size_t small = 3 * 4096 + 17;
+
+  // Large allocations are backed by huge pages, small ones aren't
+  auto *location = backend_manager.AllocatePages(large);
+  PELOTON_MEMSET(location, '-', large);
+  backend_manager.ReleasePages(location, large);
+  EXPECT_EQ(1u, backend_manager.GetHugePageAllocationCount());
+
+  location = backend_manager.AllocatePages(small);
+  PELOTON_MEMSET(location, '-', small);
+  backend_manager.ReleasePages(location, small);
+  EXPECT_EQ(1u, backend_manager.GetHugePageAllocationCount());
+
+  // Neither are allocations that would waste most of their last huge page
+  const size_t odd = storage::BackendManager::kHugePageSize + 17;
+  location = backend_manager.AllocatePages(odd);
+  PELOTON_MEMSET(location, '-', odd);
+  backend_manager.ReleasePages(location, odd);
+  EXPECT_EQ(1u, backend_manager.GetHugePageAllocationCount());
+
+  // Without a reserve, short-lived memory comes from the default allocator
+  location = backend_manager.AllocateTransient(large);
+  PELOTON_MEMSET(location, '-', large);
+  backend_manager.ReleaseTransient(location, large);
+  EXPECT_EQ(1u, backend_manager.GetHugePageAllocationCount());
+
+  // Both can be placed on a NUMA node
+  auto &numa_manager = NumaManager::GetInstance();
+  for (uint32_t node = 0; node < numa_manager.GetNumNodes(); node++) {
+    for (size_t size : {small, large}) {
+      location = backend_manager.AllocatePages(size, node);
+      PELOTON_MEMSET(location, '-', size);
+      backend_manager.ReleasePages(location, size, node);
+    }
+  }
+}
+
+TEST_F(StorageManagerTests, ReserveHugePagesTest) {
+  peloton::storage::BackendManager backend_manager;
+  const size_t huge_page_size = storage::BackendManager::kHugePageSize;
+  ASSERT_TRUE(backend_manager.ReserveHugePages(4 * huge_page_size));
+
+  // Allocations are carved out of the reserve while it lasts
+  std::vector<char *> locations;
+  for (int i = 0; i < 4; i++) {
+    locations.push_back(reinterpret_cast<char *>(
+        backend_manager.AllocatePages(huge_page_size)));
+    PELOTON_MEMSET(locations.back(), '-', huge_page_size);
+  }
+  for (int i = 1; i < 4; i++) {
+    EXPECT_EQ(locations[0] + i * huge_page_size, locations[i]);
+  }
+
+  // Regions given back are merged again
+  backend_manager.ReleasePages(locations[1], huge_page_size);
+  backend_manager.ReleasePages(locations[2], huge_page_size);
+  auto *location = backend_manager.AllocatePages(2 * huge_page_size);
+  EXPECT_EQ(locations[1], location);
+  backend_manager.ReleasePages(location, 2 * huge_page_size);
+  backend_manager.ReleasePages(locations[0], huge_page_size);
+  backend_manager.ReleasePages(locations[3], huge_page_size);
+  location = reinterpret_cast<char *>(
+      backend_manager.AllocatePages(4 * huge_page_size));
+  EXPECT_EQ(locations[0], location);
+  backend_manager.ReleasePages(location, 4 * huge_page_size);
+
+  // Short-lived memory uses the reserve too
+  location = reinterpret_cast<char *>(
+      backend_manager.AllocateTransient(2 * huge_page_size));
+  EXPECT_EQ(locations[0], location);
+  backend_manager.ReleaseTransient(location, 2 * huge_page_size);
+}
+
 }  // namespace test
 }  // namespace peloton
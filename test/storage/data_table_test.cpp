@@ -19,6 +19,7 @@
 #include "storage/database.h"
 
 #include "concurrency/transaction_manager_factory.h"
+#include "type/value_factory.h"
 
 namespace peloton {
 namespace test {
@@ -41,35 +42,50 @@ TEST_F(DataTableTests, TransformTileGroupTest) {
                                    true, txn);
   txn_manager.CommitTransaction(txn);
 
-  // Create the new column map
-  column_map_type column_map;
-  column_map[0] = std::make_pair(0, 0);
-  column_map[1] = std::make_pair(0, 1);
-  column_map[2] = std::make_pair(1, 0);
-  column_map[3] = std::make_pair(1, 1);
-
   auto theta = 0.0;
-
-  // Transform the tile group
-  data_table->TransformTileGroup(0, theta);
-
-  // Create the another column map
-  column_map[0] = std::make_pair(0, 0);
-  column_map[1] = std::make_pair(0, 1);
-  column_map[2] = std::make_pair(0, 2);
-  column_map[3] = std::make_pair(1, 0);
-
-  // Transform the tile group
-  data_table->TransformTileGroup(0, theta);
-
-  // Create the another column map
-  column_map[0] = std::make_pair(0, 0);
-  column_map[1] = std::make_pair(1, 0);
-  column_map[2] = std::make_pair(1, 1);
-  column_map[3] = std::make_pair(1, 2);
-
-  // Transform the tile group
-  data_table->TransformTileGroup(0, theta);
+  auto tile_group = data_table->GetTileGroup(0);
+  auto tile_group_id = tile_group->GetTileGroupId();
+  auto header = tile_group->GetHeader();
+  auto column_count = tile_group->GetLayout().GetColumnCount();
+
+  // Start transforming the tile group, only once
+  EXPECT_TRUE(data_table->BeginTransformTileGroup(0, theta));
+  EXPECT_TRUE(header->GetImmutability());
+  EXPECT_FALSE(data_table->BeginTransformTileGroup(0, theta));
+
+  // Versions keep changing meanwhile, and the GC resets the last slot
+  header->SetLastReaderCommitId(0, 42);
+  oid_t reset_slot = tuple_count - 1;
+  header->SetTransactionId(reset_slot, INVALID_TXN_ID);
+
+  // Nothing is done until the epoch has expired
+  EXPECT_EQ(0u, data_table->FinishTransformTileGroups(INVALID_EID));
+  EXPECT_EQ(tile_group.get(), data_table->GetTileGroup(0).get());
+  EXPECT_EQ(1u, data_table->FinishTransformTileGroups(MAX_EID));
+
+  // The new tile group takes the place of the old one, with the same versions
+  auto new_tile_group = data_table->GetTileGroup(0);
+  EXPECT_NE(tile_group.get(), new_tile_group.get());
+  EXPECT_EQ(tile_group_id, new_tile_group->GetTileGroupId());
+  EXPECT_EQ(header, new_tile_group->GetHeader());
+  EXPECT_EQ(new_tile_group.get(), header->GetTileGroup());
+  EXPECT_FALSE(header->GetImmutability());
+  EXPECT_EQ(42u, header->GetLastReaderCommitId(0));
+
+  // and the same values, except for the slot that was reset
+  EXPECT_TRUE(new_tile_group->GetValue(reset_slot, 3).IsNull());
+  for (oid_t tuple_itr = 0; tuple_itr < reset_slot; tuple_itr++) {
+    for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+      EXPECT_EQ(CmpBool::CmpTrue,
+                tile_group->GetValue(tuple_itr, column_itr)
+                    .CompareEquals(
+                        new_tile_group->GetValue(tuple_itr, column_itr)));
+    }
+  }
+
+  // Transform the tile group again
+  EXPECT_TRUE(data_table->BeginTransformTileGroup(0, theta));
+  EXPECT_EQ(1u, data_table->FinishTransformTileGroups(MAX_EID));
 }
 
 
@@ -87,5 +103,89 @@ TEST_F(DataTableTests, GlobalTableTest) {
   txn_manager.CommitTransaction(txn);
 }
 
+TEST_F(DataTableTests, InsertTuplesTest) {
+  const oid_t tuples_per_tile_group = 10;
+  const oid_t tuple_count = 25;
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  std::unique_ptr<storage::DataTable> data_table(
+      TestingExecutorUtil::CreateTable(tuples_per_tile_group, true));
+  const catalog::Schema *schema = data_table->GetSchema();
+
+  // Tuples with distinct keys
+  std::vector<std::unique_ptr<storage::Tuple>> tuples;
+  std::vector<const AbstractTuple *> tuple_ptrs;
+  for (oid_t rowid = 0; rowid < tuple_count; rowid++) {
+    tuples.emplace_back(new storage::Tuple(schema, true));
+    auto &tuple = tuples.back();
+    tuple->SetValue(0, type::ValueFactory::GetIntegerValue(rowid),
+                    testing_pool);
+    tuple->SetValue(1, type::ValueFactory::GetIntegerValue(rowid * 10),
+                    testing_pool);
+    tuple->SetValue(2, type::ValueFactory::GetDecimalValue(rowid * 1.5),
+                    testing_pool);
+    tuple->SetValue(3, type::ValueFactory::GetVarcharValue(
+                           "value " + std::to_string(rowid)),
+                    testing_pool);
+    tuple_ptrs.push_back(tuple.get());
+  }
+
+  auto txn = txn_manager.BeginTransaction();
+  std::vector<ItemPointer> locations;
+  std::vector<ItemPointer *> index_entry_ptrs;
+  EXPECT_TRUE(
+      data_table->InsertTuples(tuple_ptrs, txn, locations, index_entry_ptrs));
+  ASSERT_EQ(tuple_count, locations.size());
+  ASSERT_EQ(tuple_count, index_entry_ptrs.size());
+  EXPECT_EQ(ResultType::SUCCESS, txn_manager.CommitTransaction(txn));
+  EXPECT_EQ(tuple_count, data_table->GetTupleCount());
+
+  // The tuples fill the tile groups one after the other
+  for (oid_t rowid = 0; rowid < tuple_count; rowid++) {
+    auto &location = locations[rowid];
+    EXPECT_EQ(rowid % tuples_per_tile_group, location.offset);
+    EXPECT_EQ(location, *index_entry_ptrs[rowid]);
+    if (rowid % tuples_per_tile_group != 0) {
+      EXPECT_EQ(locations[rowid - 1].block, location.block);
+    }
+
+    auto tile_group = data_table->GetTileGroupById(location.block);
+    for (oid_t column_itr = 0; column_itr < schema->GetColumnCount();
+         column_itr++) {
+      EXPECT_EQ(CmpBool::CmpTrue,
+                tile_group->GetValue(location.offset, column_itr)
+                    .CompareEquals(tuples[rowid]->GetValue(column_itr)));
+    }
+  }
+
+  // A key that is repeated within a batch violates the primary key
+  std::vector<const AbstractTuple *> duplicates = {tuple_ptrs[0],
+                                                   tuple_ptrs[0]};
+  tuples[0]->SetValue(0, type::ValueFactory::GetIntegerValue(tuple_count),
+                      testing_pool);
+  txn = txn_manager.BeginTransaction();
+  EXPECT_FALSE(
+      data_table->InsertTuples(duplicates, txn, locations, index_entry_ptrs));
+
+  // Both tuples belong to the transaction, so its abort cleans them up along
+  // with the index entry of the first one
+  auto &rw_set = txn->GetReadWriteSet();
+  ASSERT_EQ(2, locations.size());
+  for (auto &location : locations) {
+    ASSERT_EQ(1, rw_set.count(location));
+    EXPECT_EQ(RWType::INSERT, rw_set.at(location));
+  }
+  txn_manager.AbortTransaction(txn);
+  EXPECT_EQ(tuple_count, data_table->GetTupleCount());
+
+  // The key of the aborted batch is free again
+  txn = txn_manager.BeginTransaction();
+  EXPECT_TRUE(data_table->InsertTuples({tuple_ptrs[0]}, txn, locations,
+                                       index_entry_ptrs));
+  EXPECT_EQ(ResultType::SUCCESS, txn_manager.CommitTransaction(txn));
+  EXPECT_EQ(tuple_count + 1, data_table->GetTupleCount());
+}
+
 }  // namespace test
 }  // namespace peloton
@@ -15,8 +15,10 @@
 #include "common/harness.h"
 
 #include "type/value_factory.h"
+#include "concurrency/epoch_manager_factory.h"
 #include "concurrency/transaction_context.h"
 #include "concurrency/transaction_manager_factory.h"
+#include "gc/gc_manager_factory.h"
 #include "storage/tile_group.h"
 #include "storage/tile_group_factory.h"
 #include "storage/tile.h"
@@ -540,5 +542,119 @@ TEST_F(TileGroupTests, TileCopyTest) {
   EXPECT_TRUE(intended_behavior);
 }
 
+TEST_F(TileGroupTests, TileGroupPtrTest) {
+  catalog::Column column(type::TypeId::INTEGER,
+                         type::Type::GetTypeSize(type::TypeId::INTEGER), "A",
+                         true);
+  std::vector<catalog::Schema> schemas = {catalog::Schema({column})};
+  std::shared_ptr<const storage::Layout> layout =
+      std::make_shared<const storage::Layout>(1);
+
+  auto storage_manager = storage::StorageManager::GetInstance();
+  std::shared_ptr<storage::TileGroup> tile_group(
+      storage::TileGroupFactory::GetTileGroup(
+          INVALID_OID, INVALID_OID,
+          TestingHarness::GetInstance().GetNextTileGroupId(), nullptr, schemas,
+          layout, 4));
+  oid_t tile_group_id = tile_group->GetTileGroupId();
+  EXPECT_EQ(nullptr, storage_manager->GetTileGroupPtr(tile_group_id));
+
+  storage_manager->AddTileGroup(tile_group_id, tile_group);
+  EXPECT_EQ(tile_group.get(), storage_manager->GetTileGroupPtr(tile_group_id));
+
+  // A dropped tile group can't be found anymore, but lives on until the epoch
+  // it was dropped in has expired
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+  epoch_manager.Reset(1);
+  std::weak_ptr<storage::TileGroup> dropped = tile_group;
+  tile_group.reset();
+  storage_manager->DropTileGroup(tile_group_id);
+  EXPECT_EQ(nullptr, storage_manager->GetTileGroupPtr(tile_group_id));
+  EXPECT_FALSE(dropped.expired());
+
+  EXPECT_LE(1u, storage_manager->ReleaseDroppedTileGroups(MAX_EID));
+  EXPECT_TRUE(dropped.expired());
+
+  // Without a garbage collector, the next tile group to be dropped releases
+  // the ones whose epoch has expired
+  ASSERT_FALSE(gc::GCManagerFactory::GetInstance().GetStatus());
+  std::shared_ptr<storage::TileGroup> first(
+      storage::TileGroupFactory::GetTileGroup(
+          INVALID_OID, INVALID_OID,
+          TestingHarness::GetInstance().GetNextTileGroupId(), nullptr, schemas,
+          layout, 4));
+  std::shared_ptr<storage::TileGroup> second(
+      storage::TileGroupFactory::GetTileGroup(
+          INVALID_OID, INVALID_OID,
+          TestingHarness::GetInstance().GetNextTileGroupId(), nullptr, schemas,
+          layout, 4));
+  storage_manager->AddTileGroup(first->GetTileGroupId(), first);
+  storage_manager->AddTileGroup(second->GetTileGroupId(), second);
+  oid_t first_id = first->GetTileGroupId();
+  oid_t second_id = second->GetTileGroupId();
+  std::weak_ptr<storage::TileGroup> first_dropped = first;
+  std::weak_ptr<storage::TileGroup> second_dropped = second;
+  first.reset();
+  second.reset();
+
+  storage_manager->DropTileGroup(first_id);
+  EXPECT_FALSE(first_dropped.expired());
+  epoch_manager.Reset(3);
+  storage_manager->DropTileGroup(second_id);
+  EXPECT_TRUE(first_dropped.expired());
+  EXPECT_FALSE(second_dropped.expired());
+
+  EXPECT_LE(1u, storage_manager->ReleaseDroppedTileGroups(MAX_EID));
+  EXPECT_TRUE(second_dropped.expired());
+  epoch_manager.Reset();
+}
+
+TEST_F(TileGroupTests, FreezeTest) {
+  catalog::Column column(type::TypeId::INTEGER,
+                         type::Type::GetTypeSize(type::TypeId::INTEGER), "A",
+                         true);
+  std::vector<catalog::Schema> schemas = {catalog::Schema({column})};
+  std::shared_ptr<const storage::Layout> layout =
+      std::make_shared<const storage::Layout>(1, LayoutType::COLUMN);
+
+  const oid_t tuple_count = 4;
+  std::unique_ptr<storage::TileGroup> tile_group(
+      storage::TileGroupFactory::GetTileGroup(
+          INVALID_OID, INVALID_OID,
+          TestingHarness::GetInstance().GetNextTileGroupId(), nullptr, schemas,
+          layout, tuple_count));
+  auto *header = tile_group->GetHeader();
+
+  // Not full yet
+  EXPECT_EQ(ResultType::QUEUING, tile_group->Freeze(10, INVALID_EID));
+
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    EXPECT_EQ(tuple_itr, header->GetNextEmptyTupleSlot());
+    auto value = type::ValueFactory::GetIntegerValue(tuple_itr);
+    tile_group->SetValue(value, tuple_itr, 0);
+    header->SetTransactionId(tuple_itr, INITIAL_TXN_ID);
+    header->SetBeginCommitId(tuple_itr, 1);
+    header->SetEndCommitId(tuple_itr, MAX_CID);
+  }
+
+  // The slot of an aborted insert waits to be recycled, so the tile group
+  // can't be frozen until it is reused
+  header->SetBeginCommitId(2, MAX_CID);
+  header->SetTransactionId(2, INVALID_TXN_ID);
+  EXPECT_EQ(ResultType::FAILURE, tile_group->Freeze(10, INVALID_EID));
+  EXPECT_FALSE(header->GetImmutability());
+
+  // Once it is reused, the tile group waits for the new tuple to be cold
+  header->SetTransactionId(2, 100);
+  EXPECT_EQ(ResultType::QUEUING, tile_group->Freeze(10, INVALID_EID));
+  EXPECT_FALSE(header->GetImmutability());
+  header->SetTransactionId(2, INITIAL_TXN_ID);
+  header->SetBeginCommitId(2, 10);
+  EXPECT_EQ(ResultType::QUEUING, tile_group->Freeze(10, INVALID_EID));
+
+  EXPECT_EQ(ResultType::SUCCESS, tile_group->Freeze(11, INVALID_EID));
+  EXPECT_TRUE(header->GetImmutability());
+}
+
 }  // namespace test
 }  // namespace peloton
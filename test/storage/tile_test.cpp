@@ -12,9 +12,11 @@
 
 #include "common/harness.h"
 
+#include "storage/compressed_column.h"
 #include "storage/tile.h"
 #include "storage/tile_group.h"
 #include "storage/tuple_iterator.h"
+#include "type/serializeio.h"
 #include "type/value_factory.h"
 
 namespace peloton {
@@ -99,5 +101,215 @@ TEST_F(TileTests, BasicTest) {
   tile->InsertTuple(2, tuple3.get());
 }
 
+TEST_F(TileTests, CompressIntegerTest) {
+  std::vector<catalog::Column> columns = {catalog::Column(
+      type::TypeId::INTEGER, type::Type::GetTypeSize(type::TypeId::INTEGER),
+      "A", true)};
+  std::unique_ptr<catalog::Schema> schema(new catalog::Schema(columns));
+
+  const int tuple_count = 1000;
+  std::unique_ptr<storage::TileGroupHeader> header(
+      new storage::TileGroupHeader(BackendType::MM, tuple_count));
+
+  // Long runs of equal values are run-length encoded
+  std::unique_ptr<storage::Tile> rle_tile(storage::TileFactory::GetTile(
+      BackendType::MM, INVALID_OID, INVALID_OID, INVALID_OID, INVALID_OID,
+      header.get(), *schema, nullptr, tuple_count));
+  for (int i = 0; i < tuple_count; i++) {
+    rle_tile->SetValue(type::ValueFactory::GetIntegerValue(i / 100), i, 0);
+  }
+  EXPECT_TRUE(rle_tile->Compress(tuple_count, 1));
+  const auto *rle = rle_tile->GetCompressedColumn();
+  ASSERT_NE(nullptr, rle);
+  EXPECT_EQ(storage::CompressedColumn::Encoding::RunLength,
+            rle->GetEncoding());
+
+  // Distinct values in a small range are stored as offsets
+  std::unique_ptr<storage::Tile> for_tile(storage::TileFactory::GetTile(
+      BackendType::MM, INVALID_OID, INVALID_OID, INVALID_OID, INVALID_OID,
+      header.get(), *schema, nullptr, tuple_count));
+  for (int i = 0; i < tuple_count; i++) {
+    for_tile->SetValue(type::ValueFactory::GetIntegerValue(100000 + i), i, 0);
+  }
+  EXPECT_TRUE(for_tile->Compress(tuple_count, 1));
+  const auto *frame = for_tile->GetCompressedColumn();
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(storage::CompressedColumn::Encoding::FrameOfReference,
+            frame->GetEncoding());
+  EXPECT_LT(frame->GetFootprint(), tuple_count * sizeof(int32_t));
+
+  // The values survive the release of the raw data
+  EXPECT_TRUE(rle_tile->ReleaseRetiredMemory(0));
+  EXPECT_FALSE(rle_tile->ReleaseRetiredMemory(1));
+  EXPECT_FALSE(for_tile->ReleaseRetiredMemory(1));
+
+  std::vector<char> decoded(tuple_count * sizeof(int32_t));
+  frame->Decode(decoded.data());
+  for (int i = 0; i < tuple_count; i++) {
+    EXPECT_EQ(i / 100, rle_tile->GetValue(i, 0).GetAs<int32_t>());
+    EXPECT_EQ(100000 + i, for_tile->GetValue(i, 0).GetAs<int32_t>());
+    EXPECT_EQ(100000 + i,
+              reinterpret_cast<const int32_t *>(decoded.data())[i]);
+  }
+}
+
+TEST_F(TileTests, CompressStringTest) {
+  std::vector<catalog::Column> columns = {
+      catalog::Column(type::TypeId::VARCHAR, 25, "A", false)};
+  std::unique_ptr<catalog::Schema> schema(new catalog::Schema(columns));
+
+  const int tuple_count = 100;
+  std::unique_ptr<storage::TileGroupHeader> header(
+      new storage::TileGroupHeader(BackendType::MM, tuple_count));
+  std::unique_ptr<storage::Tile> tile(storage::TileFactory::GetTile(
+      BackendType::MM, INVALID_OID, INVALID_OID, INVALID_OID, INVALID_OID,
+      header.get(), *schema, nullptr, tuple_count));
+
+  std::vector<std::string> names = {"delta", "alpha", "charlie", "bravo"};
+  for (int i = 0; i < tuple_count; i++) {
+    tile->SetValue(type::ValueFactory::GetVarcharValue(names[i % 4]), i, 0);
+  }
+  EXPECT_TRUE(tile->Compress(tuple_count, 1));
+  const auto *dictionary = tile->GetCompressedColumn();
+  ASSERT_NE(nullptr, dictionary);
+  EXPECT_EQ(storage::CompressedColumn::Encoding::Dictionary,
+            dictionary->GetEncoding());
+  EXPECT_EQ(4u, dictionary->GetNumEntries());
+
+  // Equal values share their entry, and still read the same
+  for (int i = 0; i < tuple_count; i++) {
+    EXPECT_EQ(names[i % 4], tile->GetValue(i, 0).ToString());
+  }
+  auto *entry = *reinterpret_cast<const char **>(tile->GetTupleLocation(0));
+  EXPECT_EQ(entry, *reinterpret_cast<const char **>(tile->GetTupleLocation(4)));
+  EXPECT_EQ(nullptr, dictionary->LookupEntry("echo", 5));
+
+  // Comparisons become ranges of entries
+  auto count_matches = [&](ExpressionType cmp_type, const std::string &str) {
+    const char *begin, *end;
+    dictionary->GetEntryRange(cmp_type, str.c_str(), str.size() + 1, &begin,
+                              &end);
+    int matches = 0;
+    for (int i = 0; i < tuple_count; i++) {
+      auto *value =
+          *reinterpret_cast<const char **>(tile->GetTupleLocation(i));
+      matches += (value >= begin && value < end);
+    }
+    return matches;
+  };
+  EXPECT_EQ(25, count_matches(ExpressionType::COMPARE_EQUAL, "bravo"));
+  EXPECT_EQ(0, count_matches(ExpressionType::COMPARE_EQUAL, "beta"));
+  EXPECT_EQ(25, count_matches(ExpressionType::COMPARE_LESSTHAN, "bravo"));
+  EXPECT_EQ(50,
+            count_matches(ExpressionType::COMPARE_LESSTHANOREQUALTO, "bravo"));
+  EXPECT_EQ(50, count_matches(ExpressionType::COMPARE_GREATERTHAN, "bravo"));
+  EXPECT_EQ(75, count_matches(ExpressionType::COMPARE_GREATERTHANOREQUALTO,
+                              "bravo"));
+  EXPECT_EQ(100, count_matches(ExpressionType::COMPARE_GREATERTHAN, "a"));
+}
+
+TEST_F(TileTests, ReclaimEvacuateTest) {
+  std::vector<catalog::Column> columns = {
+      catalog::Column(type::TypeId::VARCHAR, 1024, "A", false)};
+  std::unique_ptr<catalog::Schema> schema(new catalog::Schema(columns));
+
+  const int tuple_count = 400;
+  std::unique_ptr<storage::TileGroupHeader> header(
+      new storage::TileGroupHeader(BackendType::MM, tuple_count));
+  std::unique_ptr<storage::Tile> tile(storage::TileFactory::GetTile(
+      BackendType::MM, INVALID_OID, INVALID_OID, INVALID_OID, INVALID_OID,
+      header.get(), *schema, nullptr, tuple_count));
+
+  // Fill a few chunks with values of equal size, then reclaim three out of
+  // four slots
+  auto make_value = [](int i) {
+    return std::to_string(1000 + i) + std::string(1000, 'x');
+  };
+  for (int i = 0; i < tuple_count; i++) {
+    tile->SetValue(type::ValueFactory::GetVarcharValue(make_value(i)), i, 0);
+  }
+  auto *pool = tile->GetPool();
+  size_t footprint = pool->GetAllocatedBytes() / tuple_count;
+  for (int i = 0; i < tuple_count; i++) {
+    if (i % 4 != 0) {
+      tile->ReclaimVarlenColumns(i);
+    }
+  }
+  EXPECT_EQ(footprint * tuple_count / 4, pool->GetAllocatedBytes());
+  ASSERT_TRUE(pool->NeedsCompaction());
+
+  // Evacuation only moves the live values, the reclaimed slots no longer
+  // point at their freed ones
+  EXPECT_LT(0, pool->BeginCompaction());
+  size_t num_moved = tile->EvacuateVarlenColumns();
+  EXPECT_LT(0, num_moved);
+  EXPECT_GE(tuple_count / 4, num_moved);
+  pool->EndCompaction(1);
+  EXPECT_LT(0, pool->ReleaseRetiredChunks(1));
+  EXPECT_EQ(footprint * tuple_count / 4, pool->GetAllocatedBytes());
+  for (int i = 0; i < tuple_count; i++) {
+    if (i % 4 != 0) {
+      EXPECT_EQ(nullptr,
+                *reinterpret_cast<char **>(tile->GetTupleLocation(i)));
+    } else {
+      EXPECT_EQ(make_value(i), tile->GetValue(i, 0).ToString());
+    }
+  }
+}
+
+TEST_F(TileTests, EvictRestoreTest) {
+  std::vector<catalog::Column> int_columns = {catalog::Column(
+      type::TypeId::INTEGER, type::Type::GetTypeSize(type::TypeId::INTEGER),
+      "A", true)};
+  std::vector<catalog::Column> varchar_columns = {
+      catalog::Column(type::TypeId::VARCHAR, 25, "B", false)};
+  std::unique_ptr<catalog::Schema> int_schema(
+      new catalog::Schema(int_columns));
+  std::unique_ptr<catalog::Schema> varchar_schema(
+      new catalog::Schema(varchar_columns));
+
+  const int tuple_count = 100;
+  std::unique_ptr<storage::TileGroupHeader> header(
+      new storage::TileGroupHeader(BackendType::MM, tuple_count));
+  std::unique_ptr<storage::Tile> int_tile(storage::TileFactory::GetTile(
+      BackendType::MM, INVALID_OID, INVALID_OID, INVALID_OID, INVALID_OID,
+      header.get(), *int_schema, nullptr, tuple_count));
+  std::unique_ptr<storage::Tile> varchar_tile(storage::TileFactory::GetTile(
+      BackendType::MM, INVALID_OID, INVALID_OID, INVALID_OID, INVALID_OID,
+      header.get(), *varchar_schema, nullptr, tuple_count));
+
+  // A compressed tile, and one with distinct strings that stays as it is
+  for (int i = 0; i < tuple_count; i++) {
+    int_tile->SetValue(type::ValueFactory::GetIntegerValue(i / 10), i, 0);
+    varchar_tile->SetValue(
+        type::ValueFactory::GetVarcharValue("value " + std::to_string(i)), i,
+        0);
+  }
+  EXPECT_TRUE(int_tile->Compress(tuple_count, INVALID_EID));
+  EXPECT_FALSE(varchar_tile->Compress(tuple_count, INVALID_EID));
+
+  CopySerializeOutput output;
+  int_tile->SerializeValuesTo(output);
+  varchar_tile->SerializeValuesTo(output);
+  int_tile->Evict();
+  varchar_tile->Evict();
+  EXPECT_TRUE(int_tile->IsEvicted());
+  EXPECT_TRUE(varchar_tile->IsEvicted());
+
+  ReferenceSerializeInput input{output.Data(), output.Size()};
+  int_tile->Restore(input);
+  varchar_tile->Restore(input);
+  EXPECT_FALSE(int_tile->IsEvicted());
+  ASSERT_NE(nullptr, int_tile->GetCompressedColumn());
+  EXPECT_EQ(storage::CompressedColumn::Encoding::RunLength,
+            int_tile->GetCompressedColumn()->GetEncoding());
+  EXPECT_EQ(nullptr, varchar_tile->GetCompressedColumn());
+  for (int i = 0; i < tuple_count; i++) {
+    EXPECT_EQ(i / 10, int_tile->GetValue(i, 0).GetAs<int32_t>());
+    EXPECT_EQ("value " + std::to_string(i),
+              varchar_tile->GetValue(i, 0).ToString());
+  }
+}
+
 }  // namespace test
 }  // namespace peloton
@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// task_queue_test.cpp
+//
+// Identification: test/threadpool/task_queue_test.cpp
+//
+// Copyright (c) 2015-2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>
+
+#include "common/harness.h"
+#include "planner/limit_plan.h"
+#include "planner/seq_scan_plan.h"
+#include "threadpool/task_queue.h"
+#include "threadpool/mono_queue_pool.h"
+#include "traffic_cop/traffic_cop.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Task Queue Test
+//===--------------------------------------------------------------------===//
+
+class TaskQueueTests : public PelotonTest {};
+
+using threadpool::TaskClass;
+
+TEST_F(TaskQueueTests, WeightedDequeueTest) {
+  threadpool::TaskSchedulerConfig config;
+  config.weights[static_cast<int>(TaskClass::OLTP)] = 4;
+  config.weights[static_cast<int>(TaskClass::OLAP)] = 1;
+  threadpool::TaskQueue queue(32, config);
+
+  std::vector<int> order;
+  for (int i = 0; i < 20; i++) {
+    queue.Enqueue([&order] { order.push_back(0); }, TaskClass::OLTP);
+    queue.Enqueue([&order] { order.push_back(1); }, TaskClass::OLAP);
+  }
+  EXPECT_EQ(20, queue.GetQueuedCount(TaskClass::OLAP));
+
+  // While both classes have work, OLTP gets four dequeues per OLAP dequeue
+  int oltp_count = 0;
+  for (int i = 0; i < 20; i++) {
+    std::function<void()> task;
+    TaskClass task_class;
+    ASSERT_TRUE(queue.Dequeue(task, task_class));
+    task();
+    queue.Finish(task_class);
+    if (task_class == TaskClass::OLTP) oltp_count++;
+  }
+  EXPECT_EQ(16, oltp_count);
+  EXPECT_EQ(20, order.size());
+
+  // The queue drains completely
+  std::function<void()> task;
+  TaskClass task_class;
+  while (queue.Dequeue(task, task_class)) queue.Finish(task_class);
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_FALSE(queue.Dequeue(task, task_class));
+}
+
+TEST_F(TaskQueueTests, RunningLimitTest) {
+  threadpool::TaskSchedulerConfig config;
+  config.max_running[static_cast<int>(TaskClass::OLAP)] = 1;
+  threadpool::TaskQueue queue(32, config);
+
+  queue.Enqueue([] {}, TaskClass::OLAP);
+  queue.Enqueue([] {}, TaskClass::OLAP);
+
+  std::function<void()> task;
+  TaskClass task_class;
+  ASSERT_TRUE(queue.Dequeue(task, task_class));
+  EXPECT_EQ(TaskClass::OLAP, task_class);
+  EXPECT_EQ(1, queue.GetRunningCount(TaskClass::OLAP));
+
+  // The second report waits for the first one, short statements do not
+  EXPECT_FALSE(queue.Dequeue(task, task_class));
+  queue.Enqueue([] {}, TaskClass::OLTP);
+  ASSERT_TRUE(queue.Dequeue(task, task_class));
+  EXPECT_EQ(TaskClass::OLTP, task_class);
+  queue.Finish(task_class);
+
+  queue.Finish(TaskClass::OLAP);
+  ASSERT_TRUE(queue.Dequeue(task, task_class));
+  EXPECT_EQ(TaskClass::OLAP, task_class);
+  queue.Finish(task_class);
+  EXPECT_TRUE(queue.IsEmpty());
+
+  // Every dequeue recorded its queue time
+  auto latencies = queue.GetQueueLatencyMetric(TaskClass::OLAP).Copy();
+  EXPECT_EQ(2, latencies.GetSize());
+}
+
+TEST_F(TaskQueueTests, RoundRobinDequeueTest) {
+  // Without weights or limits the classes take turns
+  threadpool::TaskQueue queue(1024);
+  for (int i = 0; i < 4; i++) {
+    queue.Enqueue([] {}, TaskClass::OLTP);
+    queue.Enqueue([] {}, TaskClass::OLAP);
+  }
+  int olap_count = 0;
+  for (int i = 0; i < 4; i++) {
+    std::function<void()> task;
+    TaskClass task_class;
+    ASSERT_TRUE(queue.Dequeue(task, task_class));
+    queue.Finish(task_class);
+    if (task_class == TaskClass::OLAP) olap_count++;
+  }
+  EXPECT_LE(1, olap_count);
+  EXPECT_GE(3, olap_count);
+
+  // Workers dequeuing while a producer enqueues never see a task before it
+  // is counted
+  std::atomic<bool> done(false);
+  std::atomic<int> dequeued(0);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < 4; i++) {
+    workers.emplace_back([&] {
+      std::function<void()> task;
+      TaskClass task_class;
+      while (!done || !queue.IsEmpty()) {
+        if (!queue.Dequeue(task, task_class)) continue;
+        EXPECT_GE(1000, queue.GetQueuedCount(task_class));
+        queue.Finish(task_class);
+        dequeued++;
+      }
+    });
+  }
+  for (int i = 0; i < 1000; i++) queue.Enqueue([] {}, TaskClass::OLAP);
+  done = true;
+  for (auto &worker : workers) worker.join();
+  EXPECT_EQ(1004, dequeued.load());
+  EXPECT_EQ(0, queue.GetQueuedCount(TaskClass::OLAP));
+  EXPECT_EQ(0, queue.GetQueuedCount(TaskClass::OLTP));
+}
+
+TEST_F(TaskQueueTests, PoolTest) {
+  threadpool::MonoQueuePool pool("test-pool", 32, 2);
+  pool.Startup();
+  std::atomic<int> counter(0);
+  for (int i = 0; i < 10; i++) {
+    pool.SubmitTask([&counter] { counter++; }, TaskClass::OLAP);
+    pool.SubmitTask([&counter] { counter++; });
+  }
+  // Shutdown drains the queue before the workers exit
+  pool.Shutdown();
+  EXPECT_EQ(20, counter.load());
+}
+
+TEST_F(TaskQueueTests, ClassifyPlanTest) {
+  // A scan the optimizer expects to return a handful of rows is transactional
+  planner::SeqScanPlan small_scan;
+  small_scan.SetCardinality(10);
+  EXPECT_EQ(TaskClass::OLTP, tcop::TrafficCop::ClassifyPlan(&small_scan));
+
+  // A large scan below a cheap operator still makes the plan analytical
+  std::unique_ptr<planner::AbstractPlan> large_scan(
+      new planner::SeqScanPlan());
+  large_scan->SetCardinality(1000000);
+  planner::LimitPlan limit(10, 0);
+  limit.SetCardinality(10);
+  limit.AddChild(std::move(large_scan));
+  EXPECT_EQ(TaskClass::OLAP, tcop::TrafficCop::ClassifyPlan(&limit));
+}
+
+}  // namespace test
+}  // namespace peloton
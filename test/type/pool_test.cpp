@@ -13,6 +13,7 @@
 #include <limits.h>
 #include <pthread.h>
 
+#include "type/arena_pool.h"
 #include "type/ephemeral_pool.h"
 #include "gtest/gtest.h"
 #include "common/harness.h"
@@ -63,5 +64,88 @@ TEST_F(PoolTests, AllocateOnceTest) {
   pool->Free(p);
 }
 
+// Chunks are released once all their allocations are freed
+TEST_F(PoolTests, ArenaAllocateFreeTest) {
+  std::unique_ptr<type::ArenaPool> pool(new type::ArenaPool());
+
+  // Fill a few chunks with small allocations
+  std::vector<char *> ptrs;
+  for (uint32_t i = 0; i < 3 * type::ArenaPool::kChunkSize / 64; i++) {
+    auto *p = static_cast<char *>(pool->Allocate(50));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p) % 8);
+    PELOTON_MEMSET(p, i & 0xff, 50);
+    ptrs.push_back(p);
+  }
+  EXPECT_EQ(50u, pool->GetAllocationSize(ptrs[0]));
+  EXPECT_EQ(50 * ptrs.size(), pool->GetAllocatedBytes());
+  EXPECT_EQ(3u, pool->GetNumChunks());
+
+  // Values don't overlap
+  for (uint32_t i = 0; i < ptrs.size(); i++) {
+    EXPECT_EQ(static_cast<char>(i & 0xff), ptrs[i][49]);
+  }
+
+  // Large allocations get a chunk of their own
+  void *large = pool->Allocate(type::ArenaPool::kChunkSize);
+  EXPECT_EQ(4u, pool->GetNumChunks());
+  pool->Free(large);
+  EXPECT_EQ(3u, pool->GetNumChunks());
+
+  // Memory that doesn't belong to the pool is ignored
+  char foreign[64] = {0};
+  pool->Free(foreign + 16);
+  EXPECT_EQ(50 * ptrs.size(), pool->GetAllocatedBytes());
+
+  for (auto *p : ptrs) {
+    pool->Free(p);
+  }
+  EXPECT_EQ(0u, pool->GetAllocatedBytes());
+  EXPECT_EQ(1u, pool->GetNumChunks());
+}
+
+// Fragmented chunks are evacuated and retired until their epoch expires
+TEST_F(PoolTests, ArenaCompactionTest) {
+  std::unique_ptr<type::ArenaPool> pool(new type::ArenaPool());
+
+  // Keep every eighth allocation
+  std::vector<void *> ptrs;
+  for (uint32_t i = 0; i < 8 * type::ArenaPool::kChunkSize / 64; i++) {
+    void *p = pool->Allocate(56);
+    if (i % 8 == 0) {
+      ptrs.push_back(p);
+    } else {
+      pool->Free(p);
+    }
+  }
+  EXPECT_TRUE(pool->NeedsCompaction());
+  size_t num_chunks = pool->GetNumChunks();
+  size_t num_evacuating = pool->BeginCompaction();
+  EXPECT_EQ(num_chunks - 1, num_evacuating);
+
+  // Move the values out of the evacuating chunks
+  for (auto &p : ptrs) {
+    if (pool->IsEvacuating(p)) {
+      void *new_p = pool->Allocate(pool->GetAllocationSize(p));
+      EXPECT_FALSE(pool->IsEvacuating(new_p));
+      pool->Free(p);
+      p = new_p;
+    }
+  }
+  EXPECT_EQ(56 * ptrs.size(), pool->GetAllocatedBytes());
+
+  // The chunks stay until their epoch has expired
+  pool->EndCompaction(10);
+  EXPECT_EQ(num_evacuating, pool->GetNumRetiredChunks());
+  EXPECT_EQ(0u, pool->ReleaseRetiredChunks(9));
+  EXPECT_EQ(num_evacuating, pool->ReleaseRetiredChunks(10));
+  EXPECT_EQ(0u, pool->GetNumRetiredChunks());
+  EXPECT_FALSE(pool->NeedsCompaction());
+
+  for (auto *p : ptrs) {
+    pool->Free(p);
+  }
+  EXPECT_EQ(0u, pool->GetAllocatedBytes());
+}
+
 }  // namespace test
 }  // namespace peloton